@@ -0,0 +1,335 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "mtproto/core_types.h"
+#include "mtproto/details/mtproto_dump_to_text.h"
+#include "mtproto/details/mtproto_serialized_request.h"
+#include "scheme.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// Usage: td_bench [-payloads <folder>]
+//
+// Each file in the payloads folder holds one serialized TL object, as raw
+// little-endian 32-bit words starting with the constructor id.
+
+namespace {
+
+using namespace MTP::details;
+
+constexpr auto kRuns = 7;
+constexpr auto kMessagesCount = 100;
+constexpr auto kUsersCount = 20;
+constexpr auto kContainerRequests = 16;
+constexpr auto kGeneratedIterations = 200;
+constexpr auto kRecordedIterations = 50;
+constexpr auto kRequestIterations = 100000;
+
+// Keeps the measured results alive, so that nothing is optimized out.
+volatile int64 Sink = 0;
+
+struct Result {
+	float64 nsPerOperation = 0.;
+	float64 bytesPerSecond = 0.;
+};
+
+// Same iteration count every time and the median of several runs,
+// so that the numbers can be compared between releases.
+template <typename Body>
+[[nodiscard]] Result Measure(int iterations, int64 bytes, Body &&body) {
+	using Clock = std::chrono::steady_clock;
+	using Nanoseconds = std::chrono::duration<float64, std::nano>;
+
+	auto runs = std::vector<float64>();
+	runs.reserve(kRuns);
+	for (auto run = 0; run != kRuns; ++run) {
+		const auto started = Clock::now();
+		for (auto i = 0; i != iterations; ++i) {
+			body();
+		}
+		const auto elapsed = Nanoseconds(Clock::now() - started);
+		runs.push_back(elapsed.count() / iterations);
+	}
+	ranges::sort(runs);
+	const auto median = runs[runs.size() / 2];
+	return {
+		.nsPerOperation = median,
+		.bytesPerSecond = (median > 0.) ? (bytes * 1e9 / median) : 0.,
+	};
+}
+
+void Print(const std::string &name, Result result) {
+	std::printf(
+		"%-48s %14.0f ns/op %10.2f MB/s\n",
+		name.c_str(),
+		result.nsPerOperation,
+		result.bytesPerSecond / (1024. * 1024.));
+}
+
+template <typename Type>
+[[nodiscard]] mtpBuffer Serialize(const Type &value) {
+	auto result = mtpBuffer();
+	result.reserve(tl::count_length(value) >> 2);
+	value.write(result);
+	return result;
+}
+
+template <typename Type>
+[[nodiscard]] bool Deserialize(const mtpBuffer &buffer, Type &to) {
+	auto from = buffer.constData();
+	return to.read(from, from + buffer.size());
+}
+
+[[nodiscard]] int64 Bytes(const mtpBuffer &buffer) {
+	return int64(buffer.size()) * sizeof(mtpPrime);
+}
+
+[[nodiscard]] MTPMessage GenerateMessage(int index) {
+	const auto text = QString("Benchmark message number %1. ").arg(index);
+	return MTP_message(
+		MTP_flags(MTPDmessage::Flag::f_from_id),
+		MTP_int(index + 1),
+		MTP_peerUser(MTP_long(1000 + (index % kUsersCount))),
+		MTP_peerUser(MTP_long(1)),
+		MTPMessageFwdHeader(),
+		MTPlong(), // via_bot_id
+		MTPMessageReplyHeader(),
+		MTP_int(1600000000 + index * 60),
+		MTP_string(text.repeated(1 + (index % 8))),
+		MTPMessageMedia(),
+		MTPReplyMarkup(),
+		MTPVector<MTPMessageEntity>(),
+		MTPint(), // views
+		MTPint(), // forwards
+		MTPMessageReplies(),
+		MTPint(), // edit_date
+		MTPstring(), // post_author
+		MTPlong(), // grouped_id
+		MTPMessageReactions(),
+		MTPVector<MTPRestrictionReason>(),
+		MTPint()); // ttl_period
+}
+
+[[nodiscard]] MTPUser GenerateUser(int index) {
+	return MTP_user(
+		MTP_flags(MTPDuser::Flag::f_access_hash
+			| MTPDuser::Flag::f_first_name
+			| MTPDuser::Flag::f_username),
+		MTP_long(1000 + index),
+		MTP_long(0x0123456789ABCDEFLL + index),
+		MTP_string(QString("User %1").arg(index)),
+		MTPstring(), // last_name
+		MTP_string(QString("bench_user_%1").arg(index)),
+		MTPstring(), // phone
+		MTPUserProfilePhoto(),
+		MTPUserStatus(),
+		MTPint(), // bot_info_version
+		MTPVector<MTPRestrictionReason>(),
+		MTPstring(), // bot_inline_placeholder
+		MTPstring()); // lang_code
+}
+
+[[nodiscard]] QVector<MTPMessage> GenerateMessages() {
+	auto result = QVector<MTPMessage>();
+	result.reserve(kMessagesCount);
+	for (auto i = 0; i != kMessagesCount; ++i) {
+		result.push_back(GenerateMessage(i));
+	}
+	return result;
+}
+
+[[nodiscard]] QVector<MTPUser> GenerateUsers() {
+	auto result = QVector<MTPUser>();
+	result.reserve(kUsersCount);
+	for (auto i = 0; i != kUsersCount; ++i) {
+		result.push_back(GenerateUser(i));
+	}
+	return result;
+}
+
+template <typename Type>
+void BenchType(
+		const std::string &name,
+		const mtpBuffer &buffer,
+		int iterations) {
+	auto parsed = Type();
+	if (!Deserialize(buffer, parsed)) {
+		std::printf("%s: could not parse the payload.\n", name.c_str());
+		return;
+	}
+	Print(name + " read", Measure(iterations, Bytes(buffer), [&] {
+		auto value = Type();
+		Sink = Sink + (Deserialize(buffer, value) ? 1 : 0);
+	}));
+	Print(name + " write", Measure(iterations, Bytes(buffer), [&] {
+		Sink = Sink + Serialize(parsed).size();
+	}));
+}
+
+void BenchDump(
+		const std::string &name,
+		const mtpBuffer &buffer,
+		int iterations) {
+	Print(name + " dump_to_text", Measure(iterations, Bytes(buffer), [&] {
+		auto from = buffer.constData();
+		const auto till = from + buffer.size();
+		Sink = Sink + DumpToText(from, till).size();
+	}));
+}
+
+void BenchGenerated() {
+	const auto messages = GenerateMessages();
+	const auto users = GenerateUsers();
+
+	const auto difference = Serialize(MTP_updates_difference(
+		MTP_vector<MTPMessage>(messages),
+		MTP_vector<MTPEncryptedMessage>(),
+		MTP_vector<MTPUpdate>(),
+		MTP_vector<MTPChat>(),
+		MTP_vector<MTPUser>(users),
+		MTP_updates_state(
+			MTP_int(100000),
+			MTP_int(0),
+			MTP_int(1600000000),
+			MTP_int(1000),
+			MTP_int(0))));
+	BenchType<MTPupdates_Difference>(
+		"updates.difference",
+		difference,
+		kGeneratedIterations);
+	BenchDump("updates.difference", difference, kGeneratedIterations);
+
+	const auto history = Serialize(MTP_messages_messages(
+		MTP_vector<MTPMessage>(messages),
+		MTP_vector<MTPChat>(),
+		MTP_vector<MTPUser>(users)));
+	BenchType<MTPmessages_Messages>(
+		"messages.messages",
+		history,
+		kGeneratedIterations);
+	BenchDump("messages.messages", history, kGeneratedIterations);
+}
+
+void BenchRequests() {
+	const auto request = MTPmessages_GetHistory(
+		MTP_inputPeerUser(MTP_long(1000), MTP_long(0x0123456789ABCDEFLL)),
+		MTP_int(0), // offset_id
+		MTP_int(0), // offset_date
+		MTP_int(0), // add_offset
+		MTP_int(100), // limit
+		MTP_int(0), // max_id
+		MTP_int(0), // min_id
+		MTP_long(0)); // hash
+	const auto requestBytes = int64(tl::count_length(request));
+	Print("SerializedRequest::Serialize", Measure(
+		kRequestIterations,
+		requestBytes,
+		[&] {
+			auto serialized = SerializedRequest::Serialize(request);
+			serialized.setMsgId(mtpMsgId(1) << 32);
+			serialized.setSeqNo(1);
+			Sink = Sink + serialized.messageSize();
+		}));
+
+	auto requests = std::vector<SerializedRequest>();
+	requests.reserve(kContainerRequests);
+	auto containerSize = uint32(1 + 1); // cons + vector size
+	for (auto i = 0; i != kContainerRequests; ++i) {
+		auto serialized = SerializedRequest::Serialize(request);
+		serialized.setMsgId((mtpMsgId(1) << 32) + (i << 2));
+		serialized.setSeqNo(i * 2 + 1);
+		containerSize += serialized.messageSize();
+		requests.push_back(std::move(serialized));
+	}
+
+	// Same layout as SessionPrivate::sendSecureRequest() builds.
+	Print("msg_container assembly", Measure(
+		kRequestIterations / kContainerRequests,
+		int64(containerSize) * sizeof(mtpPrime),
+		[&] {
+			auto container = SerializedRequest::Prepare(
+				containerSize,
+				containerSize + 3 * kContainerRequests);
+			container->push_back(mtpc_msg_container);
+			container->push_back(kContainerRequests);
+			for (const auto &request : requests) {
+				const auto from = uint32(container->size());
+				const auto length = request.messageSize();
+				container->resize(from + length);
+				memcpy(
+					container->data() + from,
+					request->constData() + 4,
+					length * sizeof(mtpPrime));
+			}
+			Sink = Sink + container->size();
+		}));
+}
+
+void BenchRecorded(const QString &folder) {
+	const auto files = QDir(folder).entryInfoList(QDir::Files, QDir::Name);
+	for (const auto &info : files) {
+		const auto name = info.fileName().toStdString();
+		auto file = QFile(info.absoluteFilePath());
+		if (!file.open(QIODevice::ReadOnly)) {
+			std::printf("%s: could not open.\n", name.c_str());
+			continue;
+		}
+		const auto bytes = file.readAll();
+		if (bytes.isEmpty() || (bytes.size() % sizeof(mtpPrime))) {
+			std::printf("%s: bad payload size.\n", name.c_str());
+			continue;
+		}
+		auto buffer = mtpBuffer(bytes.size() / sizeof(mtpPrime));
+		memcpy(buffer.data(), bytes.constData(), bytes.size());
+
+		switch (mtpTypeId(buffer[0])) {
+		case mtpc_updates_differenceEmpty:
+		case mtpc_updates_difference:
+		case mtpc_updates_differenceSlice:
+		case mtpc_updates_differenceTooLong:
+			BenchType<MTPupdates_Difference>(
+				name,
+				buffer,
+				kRecordedIterations);
+			break;
+		case mtpc_messages_messages:
+		case mtpc_messages_messagesSlice:
+		case mtpc_messages_channelMessages:
+		case mtpc_messages_messagesNotModified:
+			BenchType<MTPmessages_Messages>(
+				name,
+				buffer,
+				kRecordedIterations);
+			break;
+		}
+		BenchDump(name, buffer, kRecordedIterations);
+	}
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+	auto payloads = QString();
+	for (auto i = 1; i < argc; ++i) {
+		if (!std::strcmp(argv[i], "-payloads") && i + 1 < argc) {
+			payloads = QString::fromLocal8Bit(argv[++i]);
+		}
+	}
+
+	BenchGenerated();
+	BenchRequests();
+	if (!payloads.isEmpty()) {
+		BenchRecorded(payloads);
+	}
+	return 0;
+}
@@ -83,6 +83,31 @@ EntitiesInText EntitiesFromMTP(
 	return result;
 }
 
+void ResolveMentionNames(
+		not_null<Main::Session*> session,
+		EntitiesInText &entities) {
+	for (auto &entity : entities) {
+		if (entity.type() != EntityType::MentionName) {
+			continue;
+		}
+		const auto fields = MentionNameDataToFields(entity.data());
+		if (!fields.userId || fields.accessHash) {
+			continue;
+		}
+		const auto userId = UserId(fields.userId);
+		if (const auto user = session->data().userLoaded(userId)) {
+			entity = EntityInText(
+				EntityType::MentionName,
+				entity.offset(),
+				entity.length(),
+				MentionNameDataFromFields({
+					userId.bare,
+					user->accessHash()
+				}));
+		}
+	}
+}
+
 MTPVector<MTPMessageEntity> EntitiesToMTP(
 		not_null<Main::Session*> session,
 		const EntitiesInText &entities,
@@ -24,6 +24,11 @@ enum class ConvertOption {
 	Main::Session *session,
 	const QVector<MTPMessageEntity> &entities);
 
+// Adds access hashes to mention names parsed without a session.
+void ResolveMentionNames(
+	not_null<Main::Session*> session,
+	EntitiesInText &entities);
+
 [[nodiscard]] MTPVector<MTPMessageEntity> EntitiesToMTP(
 	not_null<Main::Session*> session,
 	const EntitiesInText &entities,
@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "api/api_authorizations.h"
 #include "api/api_chat_participants.h"
 #include "api/api_text_entities.h"
+#include "api/api_updates_replay.h"
 #include "api/api_user_privacy.h"
 #include "main/main_session.h"
 #include "main/main_account.h"
@@ -53,6 +54,9 @@ namespace {
 
 constexpr auto kChannelGetDifferenceLimit = 100;
 
+// Difference messages are applied by chunks, one chunk per event loop pass.
+constexpr auto kDifferenceMessagesChunk = 100;
+
 // 1s wait after show channel history before sending getChannelDifference.
 constexpr auto kWaitForChannelGetDifference = crl::time(1000);
 
@@ -116,6 +120,28 @@ bool HasForceLogoutNotification(const MTPUpdates &updates) {
 	return false;
 }
 
+// Types handled by Updates::applyUpdateNoPtsCheck().
+[[nodiscard]] bool CanApplyWithoutPtsCheck(const MTPUpdate &update) {
+	switch (update.type()) {
+	case mtpc_updateNewMessage:
+	case mtpc_updateReadMessagesContents:
+	case mtpc_updateReadHistoryInbox:
+	case mtpc_updateReadHistoryOutbox:
+	case mtpc_updateWebPage:
+	case mtpc_updateFolderPeers:
+	case mtpc_updateDeleteMessages:
+	case mtpc_updateNewChannelMessage:
+	case mtpc_updateEditChannelMessage:
+	case mtpc_updatePinnedChannelMessages:
+	case mtpc_updateEditMessage:
+	case mtpc_updateChannelWebPage:
+	case mtpc_updateDeleteChannelMessages:
+	case mtpc_updatePinnedMessages:
+		return true;
+	}
+	return false;
+}
+
 bool ForwardedInfoDataLoaded(
 		not_null<Main::Session*> session,
 		const MTPMessageFwdHeader &header) {
@@ -284,6 +310,7 @@ void Updates::checkLastUpdate(bool afterSleep) {
 void Updates::feedUpdateVector(
 		const MTPVector<MTPUpdate> &updates,
 		SkipUpdatePolicy policy) {
+	const auto task = Logs::TaskScope("Api::Updates::feedUpdateVector");
 	auto list = updates.v;
 	const auto hasGroupCallParticipantUpdates = ranges::contains(
 		list,
@@ -461,23 +488,25 @@ void Updates::differenceDone(const MTPupdates_Difference &result) {
 	} break;
 	case mtpc_updates_differenceSlice: {
 		auto &d = result.c_updates_differenceSlice();
-		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates());
-
-		auto &s = d.vintermediate_state().c_updates_state();
-		setState(s.vpts().v, s.vdate().v, s.vqts().v, s.vseq().v);
+		const auto state = d.vintermediate_state();
+		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates(), [=] {
+			auto &s = state.c_updates_state();
+			setState(s.vpts().v, s.vdate().v, s.vqts().v, s.vseq().v);
 
-		_ptsWaiter.setRequesting(false);
+			_ptsWaiter.setRequesting(false);
 
-		MTP_LOG(0, ("getDifference "
-			"{ good - after a slice of difference was received }%1"
-			).arg(_session->mtp().isTestMode() ? " TESTMODE" : ""));
-		getDifference();
+			MTP_LOG(0, ("getDifference "
+				"{ good - after a slice of difference was received }%1"
+				).arg(_session->mtp().isTestMode() ? " TESTMODE" : ""));
+			getDifference();
+		});
 	} break;
 	case mtpc_updates_difference: {
 		auto &d = result.c_updates_difference();
-		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates());
-
-		stateDone(d.vstate());
+		const auto state = d.vstate();
+		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates(), [=] {
+			stateDone(state);
+		});
 	} break;
 	case mtpc_updates_differenceTooLong: {
 		LOG(("API Error: updates.differenceTooLong is not supported by Telegram Desktop!"));
@@ -574,13 +603,51 @@ void Updates::feedDifference(
 		const MTPVector<MTPUser> &users,
 		const MTPVector<MTPChat> &chats,
 		const MTPVector<MTPMessage> &msgs,
-		const MTPVector<MTPUpdate> &other) {
+		const MTPVector<MTPUpdate> &other,
+		Fn<void()> done) {
+	Expects(!_differenceApplying);
+
 	Core::App().checkAutoLock();
 	session().data().processUsers(users);
 	session().data().processChats(chats);
 	feedMessageIds(other);
-	session().data().processMessages(msgs, NewMessageType::Unread);
-	feedUpdateVector(other, SkipUpdatePolicy::SkipMessageIds);
+	if (msgs.v.size() <= kDifferenceMessagesChunk) {
+		session().data().processMessages(msgs, NewMessageType::Unread);
+		feedUpdateVector(other, SkipUpdatePolicy::SkipMessageIds);
+		done();
+		return;
+	}
+
+	// Applying thousands of messages at once freezes the interface,
+	// so we apply them by chunks and keep the pts waiter requesting
+	// meanwhile, so that all the new updates wait for us to finish.
+	_differenceApplying = std::make_unique<DifferenceApplying>(
+		DifferenceApplying{ msgs.v, other, std::move(done) });
+	applyDifferenceChunk();
+}
+
+void Updates::applyDifferenceChunk() {
+	Expects(_differenceApplying != nullptr);
+
+	auto &applying = *_differenceApplying;
+	const auto from = applying.applied;
+	const auto count = std::min(
+		int(applying.messages.size()) - from,
+		kDifferenceMessagesChunk);
+	session().data().processMessages(
+		MTP_vector<MTPMessage>(applying.messages.mid(from, count)),
+		NewMessageType::Unread);
+	applying.applied += count;
+	if (applying.applied < applying.messages.size()) {
+		session().data().sendHistoryChangeNotifications();
+		crl::on_main(&session(), [=] {
+			applyDifferenceChunk();
+		});
+		return;
+	}
+	const auto finished = base::take(_differenceApplying);
+	feedUpdateVector(finished->other, SkipUpdatePolicy::SkipMessageIds);
+	finished->done();
 }
 
 void Updates::differenceFail(const MTP::Error &error) {
@@ -831,6 +898,9 @@ void Updates::mtpNewSessionCreated() {
 }
 
 void Updates::mtpUpdateReceived(const MTPUpdates &updates) {
+	if (UpdatesReplay::Recording()) {
+		UpdatesReplay::RecordUpdates(updates);
+	}
 	Core::App().checkAutoLock();
 	_lastUpdateTime = crl::now();
 	_noUpdatesTimer.callOnce(kNoUpdatesTimeout);
@@ -1319,6 +1389,36 @@ void Updates::applyUpdateNoPtsCheck(const MTPUpdate &update) {
 	}
 }
 
+void Updates::replayUpdates(const MTPUpdates &updates) {
+	const auto apply = [&](const MTPUpdate &update) {
+		if (CanApplyWithoutPtsCheck(update)) {
+			applyUpdateNoPtsCheck(update);
+		} else {
+			feedUpdate(update);
+		}
+	};
+	updates.match([&](const MTPDupdates &data) {
+		session().data().processUsers(data.vusers());
+		session().data().processChats(data.vchats());
+		for (const auto &update : data.vupdates().v) {
+			apply(update);
+		}
+	}, [&](const MTPDupdatesCombined &data) {
+		session().data().processUsers(data.vusers());
+		session().data().processChats(data.vchats());
+		for (const auto &update : data.vupdates().v) {
+			apply(update);
+		}
+	}, [&](const MTPDupdateShort &data) {
+		apply(data.vupdate());
+	}, [&](const MTPDupdateShortMessage &data) {
+		applyUpdatesNoPtsCheck(updates);
+	}, [&](const MTPDupdateShortChatMessage &data) {
+		applyUpdatesNoPtsCheck(updates);
+	}, [](const auto &data) {
+	});
+}
+
 void Updates::applyUpdates(
 		const MTPUpdates &updates,
 		uint64 sentMessageRandomId) {
@@ -1467,6 +1567,9 @@ void Updates::applyUpdates(
 }
 
 void Updates::feedUpdate(const MTPUpdate &update) {
+	const auto task = Logs::TaskScope(
+		"Api::Updates::feedUpdate",
+		int(update.type()));
 	switch (update.type()) {
 
 	// New messages.
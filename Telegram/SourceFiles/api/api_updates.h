@@ -40,6 +40,9 @@ public:
 	void applyUpdatesNoPtsCheck(const MTPUpdates &updates);
 	void applyUpdateNoPtsCheck(const MTPUpdate &update);
 
+	// Applies recorded updates once more, see api_updates_replay.h.
+	void replayUpdates(const MTPUpdates &updates);
+
 	[[nodiscard]] int32 pts() const;
 
 	void updateOnline(crl::time lastNonIdleTime = 0);
@@ -77,6 +80,13 @@ private:
 		SkipExceptGroupCallParticipants,
 	};
 
+	struct DifferenceApplying {
+		QVector<MTPMessage> messages;
+		MTPVector<MTPUpdate> other;
+		Fn<void()> done;
+		int applied = 0;
+	};
+
 	struct ActiveChatTracker {
 		PeerData *peer = nullptr;
 		rpl::lifetime lifetime;
@@ -108,7 +118,9 @@ private:
 		const MTPVector<MTPUser> &users,
 		const MTPVector<MTPChat> &chats,
 		const MTPVector<MTPMessage> &msgs,
-		const MTPVector<MTPUpdate> &other);
+		const MTPVector<MTPUpdate> &other,
+		Fn<void()> done);
+	void applyDifferenceChunk();
 	void stateDone(const MTPupdates_State &state);
 	void setState(int32 pts, int32 date, int32 qts, int32 seq);
 	void channelDifferenceDone(
@@ -168,6 +180,7 @@ private:
 	base::Timer _onlineTimer;
 
 	PtsWaiter _ptsWaiter;
+	std::unique_ptr<DifferenceApplying> _differenceApplying;
 
 	base::flat_map<not_null<ChannelData*>, crl::time> _whenGetDiffByPts;
 	base::flat_map<not_null<ChannelData*>, crl::time> _whenGetDiffAfterFail;
@@ -0,0 +1,213 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "api/api_updates_replay.h"
+
+#include "api/api_updates.h"
+#include "data/data_session.h"
+#include "history/history.h"
+#include "main/main_session.h"
+
+#include <QtCore/QDataStream>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+
+namespace Api::UpdatesReplay {
+namespace {
+
+constexpr auto kReplayMagic = quint32(0x52505554); // 'TUPR'
+constexpr auto kReplayVersion = quint32(1);
+
+enum class EntryType : quint8 {
+	Updates = 1,
+	Messages = 2,
+};
+
+struct Entry {
+	std::optional<MTPUpdates> updates;
+	MTPVector<MTPMessage> messages;
+	NewMessageType messagesType = NewMessageType::Existing;
+};
+
+std::unique_ptr<QFile> RecordingFile;
+bool Replaying = false;
+
+template <typename Type>
+[[nodiscard]] QByteArray Serialize(const Type &value) {
+	auto buffer = mtpBuffer();
+	buffer.reserve(tl::count_length(value) >> 2);
+	value.write(buffer);
+	return QByteArray(
+		reinterpret_cast<const char*>(buffer.constData()),
+		buffer.size() * sizeof(mtpPrime));
+}
+
+template <typename Type>
+[[nodiscard]] bool Deserialize(const QByteArray &bytes, Type &to) {
+	if (bytes.isEmpty() || (bytes.size() % sizeof(mtpPrime))) {
+		return false;
+	}
+	auto buffer = mtpBuffer(bytes.size() / sizeof(mtpPrime));
+	memcpy(buffer.data(), bytes.constData(), bytes.size());
+	auto from = buffer.constData();
+	return to.read(from, from + buffer.size());
+}
+
+void Write(EntryType type, qint32 flags, const QByteArray &payload) {
+	if (!RecordingFile || Replaying) {
+		return;
+	}
+	auto stream = QDataStream(RecordingFile.get());
+	stream << quint8(type) << flags << payload;
+	if (stream.status() != QDataStream::Ok) {
+		LOG(("Replay Error: Could not write to the updates record."));
+		RecordingFile = nullptr;
+	}
+}
+
+[[nodiscard]] std::optional<std::vector<Entry>> Read(const QString &path) {
+	auto file = QFile(path);
+	if (!file.open(QIODevice::ReadOnly)) {
+		return std::nullopt;
+	}
+	auto stream = QDataStream(&file);
+	auto magic = quint32();
+	auto version = quint32();
+	stream >> magic >> version;
+	if (magic != kReplayMagic || version != kReplayVersion) {
+		return std::nullopt;
+	}
+	auto result = std::vector<Entry>();
+	while (!stream.atEnd()) {
+		auto type = quint8();
+		auto flags = qint32();
+		auto payload = QByteArray();
+		stream >> type >> flags >> payload;
+		if (stream.status() != QDataStream::Ok) {
+			break;
+		}
+		auto entry = Entry();
+		if (type == quint8(EntryType::Updates)) {
+			auto updates = MTPUpdates();
+			if (!Deserialize(payload, updates)) {
+				continue;
+			}
+			entry.updates = std::move(updates);
+		} else if (type == quint8(EntryType::Messages)) {
+			if (!Deserialize(payload, entry.messages)) {
+				continue;
+			}
+			entry.messagesType = NewMessageType(flags);
+		} else {
+			continue;
+		}
+		result.push_back(std::move(entry));
+	}
+	return result;
+}
+
+[[nodiscard]] int CountUpdates(const MTPUpdates &updates) {
+	return updates.match([](const MTPDupdates &data) {
+		return int(data.vupdates().v.size());
+	}, [](const MTPDupdatesCombined &data) {
+		return int(data.vupdates().v.size());
+	}, [](const MTPDupdateShort &data) {
+		return 1;
+	}, [](const MTPDupdateShortMessage &data) {
+		return 1;
+	}, [](const MTPDupdateShortChatMessage &data) {
+		return 1;
+	}, [](const auto &data) {
+		return 0;
+	});
+}
+
+[[nodiscard]] int64 PerSecond(int64 count, crl::profile_time elapsed) {
+	return elapsed ? (count * 1000000 / elapsed) : 0;
+}
+
+} // namespace
+
+QString DefaultPath() {
+	return cWorkingDir() + qsl("DebugLogs/updates_replay.bin");
+}
+
+bool SetRecording(bool enabled, const QString &path) {
+	if (!enabled) {
+		RecordingFile = nullptr;
+		return true;
+	}
+	QDir().mkpath(QFileInfo(path).absolutePath());
+	auto file = std::make_unique<QFile>(path);
+	if (!file->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		LOG(("Replay Error: Could not open '%1' for writing.").arg(path));
+		return false;
+	}
+	auto stream = QDataStream(file.get());
+	stream << kReplayMagic << kReplayVersion;
+	RecordingFile = std::move(file);
+	return true;
+}
+
+bool Recording() {
+	return (RecordingFile != nullptr);
+}
+
+void RecordUpdates(const MTPUpdates &updates) {
+	Write(EntryType::Updates, 0, Serialize(updates));
+}
+
+void RecordMessages(const QVector<MTPMessage> &data, NewMessageType type) {
+	Write(
+		EntryType::Messages,
+		qint32(type),
+		Serialize(MTP_vector<MTPMessage>(data)));
+}
+
+QString Replay(not_null<Main::Session*> session, const QString &path) {
+	// Parsing is not measured, only applying the parsed data.
+	const auto entries = Read(path);
+	if (!entries) {
+		return qsl("Could not read '%1'.").arg(path);
+	}
+	auto updatesCount = int64();
+	auto messagesCount = int64();
+	for (const auto &entry : *entries) {
+		if (entry.updates) {
+			updatesCount += CountUpdates(*entry.updates);
+		} else {
+			messagesCount += entry.messages.v.size();
+		}
+	}
+
+	Replaying = true;
+	const auto started = crl::profile();
+	for (const auto &entry : *entries) {
+		if (entry.updates) {
+			session->updates().replayUpdates(*entry.updates);
+		} else {
+			session->data().processMessages(
+				entry.messages,
+				entry.messagesType);
+		}
+	}
+	const auto elapsed = crl::profile() - started;
+	Replaying = false;
+
+	const auto result = qsl("Replayed %1 updates and %2 messages "
+		"in %3 ms: %4 updates/s, %5 messages/s."
+	).arg(updatesCount
+	).arg(messagesCount
+	).arg(elapsed / 1000
+	).arg(PerSecond(updatesCount, elapsed)
+	).arg(PerSecond(messagesCount, elapsed));
+	LOG(("Replay: %1").arg(result));
+	return result;
+}
+
+} // namespace Api::UpdatesReplay
@@ -0,0 +1,34 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+enum class NewMessageType;
+
+namespace Main {
+class Session;
+} // namespace Main
+
+namespace Api::UpdatesReplay {
+
+// While recording, the updates and message slices received from the
+// server are appended to a file. Replaying that file applies them once
+// more to the session and measures how fast they are absorbed.
+[[nodiscard]] QString DefaultPath();
+
+bool SetRecording(bool enabled, const QString &path = DefaultPath());
+[[nodiscard]] bool Recording();
+
+void RecordUpdates(const MTPUpdates &updates);
+void RecordMessages(const QVector<MTPMessage> &data, NewMessageType type);
+
+// Returns a human-readable summary of the measured numbers.
+[[nodiscard]] QString Replay(
+	not_null<Main::Session*> session,
+	const QString &path = DefaultPath());
+
+} // namespace Api::UpdatesReplay
@@ -21,6 +21,12 @@ namespace {
 // Send channel views each second.
 constexpr auto kSendViewsTimeout = crl::time(1000);
 
+// Not more than that many peers are requested at each send.
+constexpr auto kMaxRequestsPerSend = 3;
+
+// Items requested recently are not requested again on chat reopen.
+constexpr auto kViewsFreshTimeout = 2 * 60 * crl::time(1000);
+
 } // namespace
 
 ViewsManager::ViewsManager(not_null<ApiWrap*> api)
@@ -30,55 +36,86 @@ ViewsManager::ViewsManager(not_null<ApiWrap*> api)
 }
 
 void ViewsManager::scheduleIncrement(not_null<HistoryItem*> item) {
-	auto peer = item->history()->peer;
-	auto i = _incremented.find(peer);
-	if (i != _incremented.cend()) {
-		if (i->second.contains(item->id)) {
-			return;
+	const auto peer = item->history()->peer;
+	const auto now = crl::now();
+	auto &incremented = _incremented[peer];
+	if (incremented.contains(item->id)) {
+		return;
+	}
+	incremented.emplace(item->id, now);
+	auto &pending = _toIncrement[peer];
+	pending.ids.emplace(item->id);
+	pending.scheduled = now;
+	checkScheduled();
+}
+
+void ViewsManager::removeIncremented(not_null<PeerData*> peer) {
+	const auto i = _incremented.find(peer);
+	if (i == _incremented.end()) {
+		return;
+	}
+	const auto stale = crl::now() - kViewsFreshTimeout;
+	auto &incremented = i->second;
+	for (auto j = incremented.begin(); j != incremented.end();) {
+		if (j->second < stale) {
+			j = incremented.erase(j);
+		} else {
+			++j;
 		}
-	} else {
-		i = _incremented.emplace(peer).first;
 	}
-	i->second.emplace(item->id);
-	auto j = _toIncrement.find(peer);
-	if (j == _toIncrement.cend()) {
-		j = _toIncrement.emplace(peer).first;
-		_incrementTimer.callOnce(kSendViewsTimeout);
+	if (incremented.empty()) {
+		_incremented.erase(i);
 	}
-	j->second.emplace(item->id);
 }
 
-void ViewsManager::removeIncremented(not_null<PeerData*> peer) {
-	_incremented.remove(peer);
+void ViewsManager::checkScheduled() {
+	if (!_toIncrement.empty() && !_incrementTimer.isActive()) {
+		_incrementTimer.callOnce(kSendViewsTimeout);
+	}
 }
 
 void ViewsManager::viewsIncrement() {
-	for (auto i = _toIncrement.begin(); i != _toIncrement.cend();) {
-		if (_incrementRequests.contains(i->first)) {
-			++i;
-			continue;
+	// The peers with the most recently shown items go first.
+	auto order = std::vector<std::pair<crl::time, not_null<PeerData*>>>();
+	order.reserve(_toIncrement.size());
+	for (const auto &[peer, pending] : _toIncrement) {
+		if (!_incrementRequests.contains(peer)) {
+			order.emplace_back(pending.scheduled, peer);
 		}
+	}
+	ranges::sort(order, ranges::greater());
+	if (int(order.size()) > kMaxRequestsPerSend) {
+		order.resize(kMaxRequestsPerSend);
+	}
+	for (const auto &[scheduled, peer] : order) {
+		const auto i = _toIncrement.find(peer);
+		send(peer, i->second.ids);
+		_toIncrement.erase(i);
+	}
+	checkScheduled();
+}
 
-		QVector<MTPint> ids;
-		ids.reserve(i->second.size());
-		for (const auto &msgId : i->second) {
-			ids.push_back(MTP_int(msgId));
-		}
-		const auto requestId = _api.request(MTPmessages_GetMessagesViews(
-			i->first->input,
-			MTP_vector<MTPint>(ids),
-			MTP_bool(true)
-		)).done([=](
-				const MTPmessages_MessageViews &result,
-				mtpRequestId requestId) {
-			done(ids, result, requestId);
-		}).fail([=](const MTP::Error &error, mtpRequestId requestId) {
-			fail(error, requestId);
-		}).afterDelay(5).send();
-
-		_incrementRequests.emplace(i->first, requestId);
-		i = _toIncrement.erase(i);
+void ViewsManager::send(
+		not_null<PeerData*> peer,
+		const base::flat_set<MsgId> &ids) {
+	auto list = QVector<MTPint>();
+	list.reserve(ids.size());
+	for (const auto &msgId : ids) {
+		list.push_back(MTP_int(msgId));
 	}
+	const auto requestId = _api.request(MTPmessages_GetMessagesViews(
+		peer->input,
+		MTP_vector<MTPint>(list),
+		MTP_bool(true)
+	)).done([=](
+			const MTPmessages_MessageViews &result,
+			mtpRequestId requestId) {
+		done(list, result, requestId);
+	}).fail([=](const MTP::Error &error, mtpRequestId requestId) {
+		fail(error, requestId);
+	}).afterDelay(5).inBackground().send();
+
+	_incrementRequests.emplace(peer, requestId);
 }
 
 void ViewsManager::done(
@@ -117,9 +154,7 @@ void ViewsManager::done(
 			break;
 		}
 	}
-	if (!_toIncrement.empty() && !_incrementTimer.isActive()) {
-		_incrementTimer.callOnce(kSendViewsTimeout);
-	}
+	checkScheduled();
 }
 
 void ViewsManager::fail(const MTP::Error &error, mtpRequestId requestId) {
@@ -129,9 +164,7 @@ void ViewsManager::fail(const MTP::Error &error, mtpRequestId requestId) {
 			break;
 		}
 	}
-	if (!_toIncrement.empty() && !_incrementTimer.isActive()) {
-		_incrementTimer.callOnce(kSendViewsTimeout);
-	}
+	checkScheduled();
 }
 
 } // namespace Api
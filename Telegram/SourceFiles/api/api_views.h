@@ -27,7 +27,14 @@ public:
 	void removeIncremented(not_null<PeerData*> peer);
 
 private:
+	struct PendingViews {
+		base::flat_set<MsgId> ids;
+		crl::time scheduled = 0;
+	};
+
 	void viewsIncrement();
+	void send(not_null<PeerData*> peer, const base::flat_set<MsgId> &ids);
+	void checkScheduled();
 
 	void done(
 		QVector<MTPint> ids,
@@ -38,8 +45,10 @@ private:
 	const not_null<Main::Session*> _session;
 	MTP::Sender _api;
 
-	base::flat_map<not_null<PeerData*>, base::flat_set<MsgId>> _incremented;
-	base::flat_map<not_null<PeerData*>, base::flat_set<MsgId>> _toIncrement;
+	base::flat_map<
+		not_null<PeerData*>,
+		base::flat_map<MsgId, crl::time>> _incremented;
+	base::flat_map<not_null<PeerData*>, PendingViews> _toIncrement;
 	base::flat_map<not_null<PeerData*>, mtpRequestId> _incrementRequests;
 	base::flat_map<mtpRequestId, not_null<PeerData*>> _incrementByRequest;
 	base::Timer _incrementTimer;
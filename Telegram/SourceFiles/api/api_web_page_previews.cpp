@@ -0,0 +1,113 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "api/api_web_page_previews.h"
+
+#include "apiwrap.h"
+#include "base/unixtime.h"
+#include "data/data_session.h"
+#include "data/data_web_page.h"
+#include "main/main_session.h"
+
+#include <QtCore/QUrl>
+
+namespace Api {
+namespace {
+
+// Previews are reused while the user edits a message with the same links.
+constexpr auto kCacheLifetime = 10 * 60 * crl::time(1000);
+
+} // namespace
+
+WebPagePreviews::WebPagePreviews(not_null<ApiWrap*> api)
+: _session(&api->session())
+, _api(&api->instance()) {
+}
+
+QString WebPagePreviews::Normalize(const QString &links) {
+	auto result = QStringList();
+	for (const auto &link : links.split(' ', Qt::SkipEmptyParts)) {
+		const auto url = QUrl::fromUserInput(link);
+		result.push_back(url.isValid()
+			? url.adjusted(QUrl::StripTrailingSlash).toString()
+			: link);
+	}
+	return result.join(' ');
+}
+
+std::optional<WebPageId> WebPagePreviews::cached(const QString &links) {
+	const auto now = crl::now();
+	clearStale(now);
+	const auto i = _cache.find(Normalize(links));
+	return (i != end(_cache))
+		? std::make_optional(i->second.id)
+		: std::nullopt;
+}
+
+void WebPagePreviews::request(
+		const QString &links,
+		Fn<void(WebPageId)> callback) {
+	const auto key = Normalize(links);
+	auto &request = _requests[key];
+	request.callbacks.push_back(std::move(callback));
+	if (request.requestId) {
+		return;
+	}
+	request.requestId = _api.request(MTPmessages_GetWebPagePreview(
+		MTP_flags(0),
+		MTP_string(links),
+		MTPVector<MTPMessageEntity>()
+	)).done([=](const MTPMessageMedia &result) {
+		done(key, result);
+	}).fail([=](const MTP::Error &error) {
+		_requests.remove(key);
+	}).send();
+}
+
+void WebPagePreviews::done(
+		const QString &key,
+		const MTPMessageMedia &result) {
+	auto callbacks = std::vector<Fn<void(WebPageId)>>();
+	if (const auto i = _requests.find(key); i != end(_requests)) {
+		callbacks = std::move(i->second.callbacks);
+		_requests.erase(i);
+	}
+	const auto id = result.match([&](
+			const MTPDmessageMediaWebPage &data) -> std::optional<WebPageId> {
+		auto &owner = _session->data();
+		const auto page = owner.processWebpage(data.vwebpage());
+		if (page->pendingTill > 0
+			&& page->pendingTill <= base::unixtime::now()) {
+			page->pendingTill = -1;
+		}
+		owner.sendWebPageGamePollNotifications();
+		return page->id;
+	}, [&](const MTPDmessageMediaEmpty &) -> std::optional<WebPageId> {
+		return WebPageId(0);
+	}, [&](const auto &) -> std::optional<WebPageId> {
+		return std::nullopt;
+	});
+	if (!id) {
+		return;
+	}
+	_cache[key] = Entry{ .id = *id, .received = crl::now() };
+	for (const auto &callback : callbacks) {
+		callback(*id);
+	}
+}
+
+void WebPagePreviews::clearStale(crl::time now) {
+	for (auto i = begin(_cache); i != end(_cache);) {
+		if (i->second.received + kCacheLifetime <= now) {
+			i = _cache.erase(i);
+		} else {
+			++i;
+		}
+	}
+}
+
+} // namespace Api
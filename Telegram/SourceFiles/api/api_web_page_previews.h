@@ -0,0 +1,51 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "mtproto/sender.h"
+
+class ApiWrap;
+
+namespace Main {
+class Session;
+} // namespace Main
+
+namespace Api {
+
+class WebPagePreviews final {
+public:
+	explicit WebPagePreviews(not_null<ApiWrap*> api);
+
+	// Zero page id means there is no preview for those links.
+	[[nodiscard]] std::optional<WebPageId> cached(const QString &links);
+	void request(const QString &links, Fn<void(WebPageId)> callback);
+
+private:
+	struct Entry {
+		WebPageId id = 0;
+		crl::time received = 0;
+	};
+	struct Request {
+		mtpRequestId requestId = 0;
+		std::vector<Fn<void(WebPageId)>> callbacks;
+	};
+
+	[[nodiscard]] static QString Normalize(const QString &links);
+
+	void done(const QString &key, const MTPMessageMedia &result);
+	void clearStale(crl::time now);
+
+	const not_null<Main::Session*> _session;
+	MTP::Sender _api;
+
+	base::flat_map<QString, Entry> _cache;
+	base::flat_map<QString, Request> _requests;
+
+};
+
+} // namespace Api
@@ -25,6 +25,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "api/api_updates.h"
 #include "api/api_user_privacy.h"
 #include "api/api_views.h"
+#include "api/api_web_page_previews.h"
 #include "api/api_confirm_phone.h"
 #include "data/stickers/data_stickers.h"
 #include "data/data_drafts.h"
@@ -102,12 +103,13 @@ constexpr auto kUnreadMentionsFirstRequestLimit = 10;
 constexpr auto kUnreadMentionsNextRequestLimit = 100;
 constexpr auto kSharedMediaLimit = 100;
 constexpr auto kReadFeaturedSetsTimeout = crl::time(1000);
-constexpr auto kFileLoaderQueueStopTimeout = crl::time(5000);
 constexpr auto kStickersByEmojiInvalidateTimeout = crl::time(6 * 1000);
 constexpr auto kNotifySettingSaveTimeout = crl::time(1000);
 constexpr auto kDialogsFirstLoad = 20;
 constexpr auto kDialogsPerPage = 500;
 constexpr auto kJoinErrorDuration = 5 * crl::time(1000);
+constexpr auto kFileReferencesBatchDelay = crl::time(50);
+constexpr auto kFileReferencesBatchLimit = 100;
 
 using PhotoFileLocationId = Data::PhotoFileLocationId;
 using DocumentFileLocationId = Data::DocumentFileLocationId;
@@ -126,10 +128,12 @@ ApiWrap::ApiWrap(not_null<Main::Session*> session)
 , _webPagesTimer([=] { resolveWebPages(); })
 , _draftsSaveTimer([=] { saveDraftsToCloud(); })
 , _featuredSetsReadTimer([=] { readFeaturedSets(); })
+, _sharedMediaCountsTimer([=] { sendSharedMediaCounts(); })
 , _dialogsLoadState(std::make_unique<DialogsLoadState>())
-, _fileLoader(std::make_unique<TaskQueue>(kFileLoaderQueueStopTimeout))
+, _fileLoader(std::make_unique<TaskQueue>())
 , _topPromotionTimer([=] { refreshTopPromotion(); })
 , _updateNotifySettingsTimer([=] { sendNotifySettingsUpdates(); })
+, _fileReferenceMessagesTimer([=] { sendMessagesFileReferences(); })
 , _authorizations(std::make_unique<Api::Authorizations>(this))
 , _attachedStickers(std::make_unique<Api::AttachedStickers>(this))
 , _blockedPeers(std::make_unique<Api::BlockedPeers>(this))
@@ -143,7 +147,8 @@ ApiWrap::ApiWrap(not_null<Main::Session*> session)
 , _confirmPhone(std::make_unique<Api::ConfirmPhone>(this))
 , _peerPhoto(std::make_unique<Api::PeerPhoto>(this))
 , _polls(std::make_unique<Api::Polls>(this))
-, _chatParticipants(std::make_unique<Api::ChatParticipants>(this)) {
+, _chatParticipants(std::make_unique<Api::ChatParticipants>(this))
+, _webPagePreviews(std::make_unique<Api::WebPagePreviews>(this)) {
 	crl::on_main(session, [=] {
 		// You can't use _session->lifetime() in the constructor,
 		// only queued, because it is not constructed yet.
@@ -1449,7 +1454,7 @@ void ApiWrap::requestStickerSets() {
 			gotStickerSet(setId, result);
 		}).fail([=, setId = i.key()] {
 			_stickerSetRequests.remove(setId);
-		}).afterDelay(waitMs).send();
+		}).afterDelay(waitMs).inBackground().send();
 	}
 }
 
@@ -2316,41 +2321,116 @@ void ApiWrap::requestFileReference(
 
 	request(std::move(data)).done([=](const auto &result) {
 		const auto parsed = Data::GetFileReferences(result);
-		for (const auto &p : parsed.data) {
-			// Unpack here the parsed pair by hand to workaround a GCC bug.
-			// See https://gcc.gnu.org/bugzilla/show_bug.cgi?id=87122
-			const auto &origin = p.first;
-			const auto &reference = p.second;
-			const auto documentId = std::get_if<DocumentFileLocationId>(
-				&origin);
-			if (documentId) {
-				_session->data().document(
-					documentId->id
-				)->refreshFileReference(reference);
+		applyFileReferences(parsed);
+		fileReferencesDone(origin, parsed);
+	}).fail([=] {
+		fileReferencesDone(origin, UpdatedFileReferences());
+	}).send();
+}
+
+void ApiWrap::requestMessageFileReference(
+		FullMsgId itemId,
+		FileReferencesHandler &&handler) {
+	const auto origin = Data::FileOrigin(itemId);
+	const auto i = _fileReferenceHandlers.find(origin);
+	if (i != end(_fileReferenceHandlers)) {
+		i->second.push_back(std::move(handler));
+		return;
+	}
+	auto handlers = std::vector<FileReferencesHandler>();
+	handlers.push_back(std::move(handler));
+	_fileReferenceHandlers.emplace(origin, std::move(handlers));
+
+	// Many downloads usually fail together, when an old chat is opened.
+	_fileReferenceMessages.emplace(itemId);
+	if (!_fileReferenceMessagesTimer.isActive()) {
+		_fileReferenceMessagesTimer.callOnce(kFileReferencesBatchDelay);
+	}
+}
+
+void ApiWrap::sendMessagesFileReferences() {
+	auto byChannel = base::flat_map<ChannelData*, std::vector<FullMsgId>>();
+	for (const auto &itemId : base::take(_fileReferenceMessages)) {
+		if (const auto item = _session->data().message(itemId)) {
+			byChannel[item->history()->peer->asChannel()].push_back(itemId);
+		} else {
+			fileReferencesDone(itemId, UpdatedFileReferences());
+		}
+	}
+	for (const auto &[channel, all] : byChannel) {
+		for (auto from = 0; from < int(all.size());) {
+			const auto till = std::min(
+				from + kFileReferencesBatchLimit,
+				int(all.size()));
+			auto itemIds = std::vector<FullMsgId>(
+				begin(all) + from,
+				begin(all) + till);
+			from = till;
+
+			auto ids = QVector<MTPInputMessage>();
+			ids.reserve(itemIds.size());
+			for (const auto &itemId : itemIds) {
+				ids.push_back(MTP_inputMessageID(MTP_int(itemId.msg)));
 			}
-			const auto photoId = std::get_if<PhotoFileLocationId>(&origin);
-			if (photoId) {
-				_session->data().photo(
-					photoId->id
-				)->refreshFileReference(reference);
+			const auto finish = [=](const UpdatedFileReferences &data) {
+				for (const auto &itemId : itemIds) {
+					fileReferencesDone(itemId, data);
+				}
+			};
+			const auto send = [&](auto &&data) {
+				request(std::move(data)).done([=](
+						const MTPmessages_Messages &result) {
+					const auto parsed = Data::GetFileReferences(result);
+					applyFileReferences(parsed);
+					finish(parsed);
+				}).fail([=] {
+					finish(UpdatedFileReferences());
+				}).send();
+			};
+			if (channel) {
+				send(MTPchannels_GetMessages(
+					channel->inputChannel,
+					MTP_vector<MTPInputMessage>(std::move(ids))));
+			} else {
+				send(MTPmessages_GetMessages(
+					MTP_vector<MTPInputMessage>(std::move(ids))));
 			}
 		}
-		const auto i = _fileReferenceHandlers.find(origin);
-		Assert(i != end(_fileReferenceHandlers));
-		auto handlers = std::move(i->second);
-		_fileReferenceHandlers.erase(i);
-		for (auto &handler : handlers) {
-			handler(parsed);
+	}
+}
+
+void ApiWrap::applyFileReferences(const UpdatedFileReferences &data) {
+	for (const auto &p : data.data) {
+		// Unpack here the parsed pair by hand to workaround a GCC bug.
+		// See https://gcc.gnu.org/bugzilla/show_bug.cgi?id=87122
+		const auto &origin = p.first;
+		const auto &reference = p.second;
+		const auto documentId = std::get_if<DocumentFileLocationId>(
+			&origin);
+		if (documentId) {
+			_session->data().document(
+				documentId->id
+			)->refreshFileReference(reference);
 		}
-	}).fail([=] {
-		const auto i = _fileReferenceHandlers.find(origin);
-		Assert(i != end(_fileReferenceHandlers));
-		auto handlers = std::move(i->second);
-		_fileReferenceHandlers.erase(i);
-		for (auto &handler : handlers) {
-			handler(UpdatedFileReferences());
+		const auto photoId = std::get_if<PhotoFileLocationId>(&origin);
+		if (photoId) {
+			_session->data().photo(
+				photoId->id
+			)->refreshFileReference(reference);
 		}
-	}).send();
+	}
+}
+
+void ApiWrap::fileReferencesDone(
+		Data::FileOrigin origin,
+		const UpdatedFileReferences &data) {
+	const auto i = _fileReferenceHandlers.find(origin);
+	Assert(i != end(_fileReferenceHandlers));
+	auto handlers = std::move(i->second);
+	_fileReferenceHandlers.erase(i);
+	for (auto &handler : handlers) {
+		handler(data);
+	}
 }
 
 void ApiWrap::refreshFileReference(
@@ -2395,17 +2475,8 @@ void ApiWrap::refreshFileReference(
 				request(MTPmessages_GetScheduledMessages(
 					item->history()->peer->input,
 					MTP_vector<MTPint>(1, MTP_int(realId))));
-			} else if (const auto channel = item->history()->peer->asChannel()) {
-				request(MTPchannels_GetMessages(
-					channel->inputChannel,
-					MTP_vector<MTPInputMessage>(
-						1,
-						MTP_inputMessageID(MTP_int(item->id)))));
 			} else {
-				request(MTPmessages_GetMessages(
-					MTP_vector<MTPInputMessage>(
-						1,
-						MTP_inputMessageID(MTP_int(item->id)))));
+				requestMessageFileReference(data, std::move(handler));
 			}
 		} else {
 			fail();
@@ -2598,7 +2669,7 @@ void ApiWrap::requestStickers(TimeId now) {
 	)).done(done).fail([=] {
 		LOG(("App Fail: Failed to get stickers!"));
 		done(MTP_messages_allStickersNotModified());
-	}).send();
+	}).inBackground().send();
 }
 
 void ApiWrap::requestMasks(TimeId now) {
@@ -2622,7 +2693,7 @@ void ApiWrap::requestMasks(TimeId now) {
 	)).done(done).fail([=] {
 		LOG(("App Fail: Failed to get masks!"));
 		done(MTP_messages_allStickersNotModified());
-	}).send();
+	}).inBackground().send();
 }
 
 void ApiWrap::requestRecentStickers(TimeId now, bool attached) {
@@ -2745,7 +2816,7 @@ void ApiWrap::requestFeaturedStickers(TimeId now) {
 		_featuredStickersUpdateRequest = 0;
 
 		LOG(("App Fail: Failed to get featured stickers!"));
-	}).send();
+	}).inBackground().send();
 }
 
 void ApiWrap::requestSavedGifs(TimeId now) {
@@ -2824,11 +2895,26 @@ void ApiWrap::requestMessageAfterDate(
 		not_null<PeerData*> peer,
 		const QDate &date,
 		Callback &&callback) {
+	const auto history = _session->data().historyLoaded(peer);
+	const auto dayStart = TimeId(date.startOfDay().toSecsSinceEpoch());
+	if (const auto loaded = history
+		? history->loadedMessageAtDate(dayStart)
+		: std::nullopt) {
+		// Answer asynchronously, the same as after the request below.
+		crl::on_main(_session, [
+			id = *loaded,
+			callback = std::forward<Callback>(callback)
+		] {
+			callback(id);
+		});
+		return;
+	}
+
 	// API returns a message with date <= offset_date.
 	// So we request a message with offset_date = desired_date - 1 and add_offset = -1.
 	// This should give us the first message with date >= desired_date.
 	const auto offsetId = 0;
-	const auto offsetDate = static_cast<int>(date.startOfDay().toSecsSinceEpoch()) - 1;
+	const auto offsetDate = dayStart - 1;
 	const auto addOffset = -1;
 	const auto limit = 1;
 	const auto maxId = 0;
@@ -2952,7 +3038,91 @@ void ApiWrap::checkForUnreadMentions(
 void ApiWrap::requestSharedMediaCount(
 		not_null<PeerData*> peer,
 		Storage::SharedMediaType type) {
-	requestSharedMedia(peer, type, 0, SliceType::Before);
+	_sharedMediaCountsPending[peer].emplace(type);
+	if (!_sharedMediaCountsTimer.isActive()) {
+		_sharedMediaCountsTimer.callOnce(0);
+	}
+}
+
+void ApiWrap::sendSharedMediaCounts() {
+	auto pending = base::take(_sharedMediaCountsPending);
+	for (auto &[peer, types] : pending) {
+		if (_sharedMediaCountsRequests.contains(peer)) {
+			// Asked again while the counters are being loaded.
+			auto &still = _sharedMediaCountsPending[peer];
+			still.merge(types.begin(), types.end());
+			continue;
+		}
+
+		// Show the last known counts while the fresh ones are loading.
+		auto saved = local().readSharedMediaCounts(peer->id);
+		for (const auto type : types) {
+			const auto i = saved.find(type);
+			if (i != end(saved)) {
+				_session->storage().add(Storage::SharedMediaAddSlice(
+					peer->id,
+					type,
+					{},
+					{},
+					i->second));
+			}
+		}
+
+		auto filters = QVector<MTPMessagesFilter>();
+		auto requested = std::vector<SharedMediaType>();
+		filters.reserve(types.size());
+		requested.reserve(types.size());
+		for (const auto type : types) {
+			auto filter = Api::PrepareSearchFilter(type);
+			if (filter.type() != mtpc_inputMessagesFilterEmpty) {
+				filters.push_back(std::move(filter));
+				requested.push_back(type);
+			}
+		}
+		if (filters.isEmpty()) {
+			continue;
+		}
+		const auto requestId = request(MTPmessages_GetSearchCounters(
+			peer->input,
+			MTP_vector<MTPMessagesFilter>(std::move(filters))
+		)).done([=](const MTPVector<MTPmessages_SearchCounter> &result) {
+			_sharedMediaCountsRequests.remove(peer);
+			sharedMediaCountsDone(peer, requested, result);
+			if (_sharedMediaCountsPending.contains(peer)) {
+				_sharedMediaCountsTimer.callOnce(0);
+			}
+		}).fail([=] {
+			_sharedMediaCountsRequests.remove(peer);
+			_sharedMediaCountsPending.remove(peer);
+		}).send();
+		_sharedMediaCountsRequests.emplace(peer, requestId);
+	}
+}
+
+void ApiWrap::sharedMediaCountsDone(
+		not_null<PeerData*> peer,
+		const std::vector<SharedMediaType> &types,
+		const MTPVector<MTPmessages_SearchCounter> &result) {
+	auto saved = local().readSharedMediaCounts(peer->id);
+	for (const auto &counter : result.v) {
+		const auto &data = counter.data();
+		const auto filter = data.vfilter().type();
+		const auto i = ranges::find(types, filter, [](SharedMediaType type) {
+			return Api::PrepareSearchFilter(type).type();
+		});
+		if (i == end(types)) {
+			continue;
+		}
+		const auto count = data.vcount().v;
+		_session->storage().add(Storage::SharedMediaAddSlice(
+			peer->id,
+			*i,
+			{},
+			{},
+			count));
+		saved[*i] = count;
+	}
+	local().writeSharedMediaCounts(peer->id, std::move(saved));
 }
 
 void ApiWrap::requestSharedMedia(
@@ -3839,7 +4009,8 @@ void ApiWrap::sendVoiceMessage(
 		QByteArray result,
 		VoiceWaveform waveform,
 		int duration,
-		const SendAction &action) {
+		const SendAction &action,
+		uint64 streamedUploadId) {
 	const auto caption = TextWithTags();
 	const auto to = fileLoadTaskOptions(action);
 	_fileLoader->addTask(std::make_unique<FileLoadTask>(
@@ -3848,7 +4019,8 @@ void ApiWrap::sendVoiceMessage(
 		duration,
 		waveform,
 		to,
-		caption));
+		caption,
+		streamedUploadId));
 }
 
 void ApiWrap::editMedia(
@@ -3893,7 +4065,8 @@ void ApiWrap::sendFiles(
 	for (auto &file : list.files) {
 		const auto uploadWithType = !album
 			? type
-			: (file.type == Ui::PreparedFile::Type::Photo
+			: ((file.type == Ui::PreparedFile::Type::Photo
+				|| file.type == Ui::PreparedFile::Type::Video)
 				&& type != SendMediaType::File)
 			? SendMediaType::Photo
 			: SendMediaType::File;
@@ -4008,8 +4181,6 @@ void ApiWrap::sendMessage(
 		_session->user()).flags;
 	TextUtilities::PrepareForSending(left, prepareFlags);
 
-	HistoryItem *lastMessage = nullptr;
-
 	auto &histories = history->owner().histories();
 	const auto requestType = Data::Histories::RequestType::Send;
 
@@ -4077,18 +4248,9 @@ void ApiWrap::sendMessage(
 			flags |= MessageFlag::IsOrWasScheduled;
 			sendFlags |= MTPmessages_SendMessage::Flag::f_schedule_date;
 		}
-		const auto viaBotId = UserId();
-		lastMessage = history->addNewLocalMessage(
-			newId.msg,
-			flags,
-			viaBotId,
-			action.replyTo,
-			HistoryItem::NewMessageDate(action.options.scheduled),
-			messageFromId,
-			messagePostAuthor,
-			sending,
-			media,
-			HistoryMessageMarkupData());
+
+		// The request is sent before the local message is created,
+		// so that the session thread writes it while we lay it out.
 		histories.sendRequest(history, requestType, [=](Fn<void()> finish) {
 			history->sendRequestId = request(MTPmessages_SendMessage(
 				MTP_flags(sendFlags),
@@ -4115,8 +4277,11 @@ void ApiWrap::sendMessage(
 			}).fail([=](
 					const MTP::Error &error,
 					const MTP::Response &response) {
-				if (error.type() == qstr("MESSAGE_EMPTY") && !forwarding) {
-					lastMessage->destroy();
+				const auto item = _session->data().message(newId);
+				if (error.type() == qstr("MESSAGE_EMPTY")
+					&& !forwarding
+					&& item) {
+					item->destroy();
 				} else {
 					sendMessageFail(error, peer, randomId, newId);
 				}
@@ -4127,8 +4292,22 @@ void ApiWrap::sendMessage(
 				finish();
 			}).afterRequest(history->sendRequestId
 			).send();
+			instance().sendAnything();
 			return history->sendRequestId;
 		});
+
+		const auto viaBotId = UserId();
+		history->addNewLocalMessage(
+			newId.msg,
+			flags,
+			viaBotId,
+			action.replyTo,
+			HistoryItem::NewMessageDate(action.options.scheduled),
+			messageFromId,
+			messagePostAuthor,
+			sending,
+			media,
+			HistoryMessageMarkupData());
 	}
 
 	if (!forwarding) {
@@ -4655,3 +4834,7 @@ Api::Polls &ApiWrap::polls() {
 Api::ChatParticipants &ApiWrap::chatParticipants() {
 	return *_chatParticipants;
 }
+
+Api::WebPagePreviews &ApiWrap::webPagePreviews() {
+	return *_webPagePreviews;
+}
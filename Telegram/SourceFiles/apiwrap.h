@@ -67,6 +67,7 @@ class ConfirmPhone;
 class PeerPhoto;
 class Polls;
 class ChatParticipants;
+class WebPagePreviews;
 
 namespace details {
 
@@ -298,7 +299,8 @@ public:
 		QByteArray result,
 		VoiceWaveform waveform,
 		int duration,
-		const SendAction &action);
+		const SendAction &action,
+		uint64 streamedUploadId = 0);
 	void sendFiles(
 		Ui::PreparedList &&list,
 		SendMediaType type,
@@ -363,6 +365,7 @@ public:
 	[[nodiscard]] Api::PeerPhoto &peerPhoto();
 	[[nodiscard]] Api::Polls &polls();
 	[[nodiscard]] Api::ChatParticipants &chatParticipants();
+	[[nodiscard]] Api::WebPagePreviews &webPagePreviews();
 
 	void updatePrivacyLastSeens();
 
@@ -455,6 +458,11 @@ private:
 		MsgId messageId,
 		SliceType slice,
 		const MTPmessages_Messages &result);
+	void sendSharedMediaCounts();
+	void sharedMediaCountsDone(
+		not_null<PeerData*> peer,
+		const std::vector<SharedMediaType> &types,
+		const MTPVector<MTPmessages_SearchCounter> &result);
 
 	void userPhotosDone(
 		not_null<UserData*> user,
@@ -511,6 +519,14 @@ private:
 		Data::FileOrigin origin,
 		FileReferencesHandler &&handler,
 		Request &&data);
+	void requestMessageFileReference(
+		FullMsgId itemId,
+		FileReferencesHandler &&handler);
+	void sendMessagesFileReferences();
+	void applyFileReferences(const UpdatedFileReferences &data);
+	void fileReferencesDone(
+		Data::FileOrigin origin,
+		const UpdatedFileReferences &data);
 
 	void migrateDone(
 		not_null<PeerData*> peer,
@@ -577,6 +593,13 @@ private:
 		MsgId,
 		SliceType>> _sharedMediaRequests;
 
+	// Count requests from the profile are sent as one search counters call.
+	base::flat_map<
+		not_null<PeerData*>,
+		base::flat_set<SharedMediaType>> _sharedMediaCountsPending;
+	base::flat_map<not_null<PeerData*>, mtpRequestId> _sharedMediaCountsRequests;
+	base::Timer _sharedMediaCountsTimer;
+
 	base::flat_map<not_null<UserData*>, mtpRequestId> _userPhotosRequests;
 
 	std::unique_ptr<DialogsLoadState> _dialogsLoadState;
@@ -604,6 +627,8 @@ private:
 	std::map<
 		Data::FileOrigin,
 		std::vector<FileReferencesHandler>> _fileReferenceHandlers;
+	base::flat_set<FullMsgId> _fileReferenceMessages;
+	base::Timer _fileReferenceMessagesTimer;
 
 	mtpRequestId _deepLinkInfoRequestId = 0;
 
@@ -643,6 +668,7 @@ private:
 	const std::unique_ptr<Api::PeerPhoto> _peerPhoto;
 	const std::unique_ptr<Api::Polls> _polls;
 	const std::unique_ptr<Api::ChatParticipants> _chatParticipants;
+	const std::unique_ptr<Api::WebPagePreviews> _webPagePreviews;
 
 	mtpRequestId _wallPaperRequestId = 0;
 	QString _wallPaperSlug;
@@ -13,6 +13,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/localstorage.h"
 #include "base/qthelp_url.h"
 #include "base/call_delayed.h"
+#include "base/timer_rpl.h"
 #include "core/application.h"
 #include "core/core_settings.h"
 #include "main/main_account.h"
@@ -41,6 +42,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace {
 
 constexpr auto kSaveSettingsDelayedTimeout = crl::time(1000);
+constexpr auto kMaxParallelChecks = 8;
+constexpr auto kCheckTimeout = 10 * crl::time(1000);
+constexpr auto kQualityRefreshInterval = crl::time(1000);
 
 using ProxyData = MTP::ProxyData;
 
@@ -604,6 +608,20 @@ void ProxiesBox::setupContent() {
 			tr::lng_connection_try_ipv6(tr::now),
 			_settings.tryIPv6()),
 		st::proxyTryIPv6Padding);
+	auto quality = _controller->connectionQualityValue();
+	inner->add(
+		object_ptr<Ui::SlideWrap<Ui::FlatLabel>>(
+			inner,
+			object_ptr<Ui::FlatLabel>(
+				inner,
+				rpl::duplicate(quality),
+				st::boxDividerLabel),
+			st::proxyTryIPv6Padding)
+	)->toggleOn(std::move(
+		quality
+	) | rpl::map([](const QString &text) {
+		return !text.isEmpty();
+	}), anim::type::instant);
 	_proxySettings
 		= std::make_shared<Ui::RadioenumGroup<ProxyData::Settings>>(
 			_settings.settings());
@@ -1063,7 +1081,8 @@ void ProxyBox::addLabel(
 ProxiesBoxController::ProxiesBoxController(not_null<Main::Account*> account)
 : _account(account)
 , _settings(Core::App().settings().proxy())
-, _saveTimer([] { Local::writeSettings(); }) {
+, _saveTimer([] { Local::writeSettings(); })
+, _checkTimeoutTimer([=] { checkTimeouts(); }) {
 	_list = ranges::views::all(
 		_settings.list()
 	) | ranges::views::transform([&](const ProxyData &proxy) {
@@ -1079,8 +1098,15 @@ ProxiesBoxController::ProxiesBoxController(not_null<Main::Account*> account)
 		}
 	}, _lifetime);
 
-	for (auto &item : _list) {
-		refreshChecker(item);
+	// Check the selected proxy first, the rest may wait in the queue.
+	const auto selected = findByProxy(_settings.selected());
+	if (selected != end(_list)) {
+		refreshChecker(*selected);
+	}
+	for (auto i = begin(_list); i != end(_list); ++i) {
+		if (i != selected) {
+			refreshChecker(*i);
+		}
 	}
 }
 
@@ -1157,6 +1183,40 @@ auto ProxiesBoxController::proxySettingsValue() const
 }
 
 void ProxiesBoxController::refreshChecker(Item &item) {
+	item.state = ItemState::Checking;
+	item.checker = nullptr;
+	item.checkerv6 = nullptr;
+	if (checkersCount() >= kMaxParallelChecks) {
+		if (!ranges::contains(_checkQueue, item.id)) {
+			_checkQueue.push_back(item.id);
+		}
+		return;
+	}
+	_checkQueue.erase(ranges::remove(_checkQueue, item.id), end(_checkQueue));
+	startChecker(item);
+}
+
+int ProxiesBoxController::checkersCount() const {
+	return ranges::count_if(_list, [](const Item &item) {
+		return item.checker || item.checkerv6;
+	});
+}
+
+void ProxiesBoxController::startQueuedCheckers() {
+	while (!_checkQueue.empty() && checkersCount() < kMaxParallelChecks) {
+		const auto id = _checkQueue.front();
+		_checkQueue.pop_front();
+		const auto i = ranges::find(_list, id, &Item::id);
+		if (i != end(_list) && i->state == ItemState::Checking) {
+			startChecker(*i);
+			if (i->state != ItemState::Checking) {
+				updateView(*i);
+			}
+		}
+	}
+}
+
+void ProxiesBoxController::startChecker(Item &item) {
 	using Variants = MTP::DcOptions::Variants;
 	const auto type = (item.data.type == Type::Http)
 		? Variants::Http
@@ -1165,7 +1225,6 @@ void ProxiesBoxController::refreshChecker(Item &item) {
 	const auto dcId = mtproto->mainDcId();
 	const auto forFiles = false;
 
-	item.state = ItemState::Checking;
 	const auto setup = [&](Checker &checker, const bytes::vector &secret) {
 		checker = MTP::details::AbstractConnection::Create(
 			mtproto,
@@ -1213,8 +1272,39 @@ void ProxiesBoxController::refreshChecker(Item &item) {
 		connect(item.checkerv6, Variants::IPv6);
 		if (!item.checker && !item.checkerv6) {
 			item.state = ItemState::Unavailable;
+			return;
+		}
+	}
+	item.checkStarted = crl::now();
+	if (!_checkTimeoutTimer.isActive()) {
+		_checkTimeoutTimer.callOnce(kCheckTimeout);
+	}
+}
+
+void ProxiesBoxController::checkTimeouts() {
+	// A check that neither connects nor fails would hold its slot forever.
+	const auto now = crl::now();
+	auto next = crl::time(0);
+	for (auto &item : _list) {
+		if (!item.checker && !item.checkerv6) {
+			continue;
+		}
+		const auto left = item.checkStarted + kCheckTimeout - now;
+		if (left > 0) {
+			next = next ? std::min(next, left) : left;
+			continue;
+		}
+		item.checker = nullptr;
+		item.checkerv6 = nullptr;
+		if (item.state == ItemState::Checking) {
+			item.state = ItemState::Unavailable;
+			updateView(item);
 		}
 	}
+	if (next) {
+		_checkTimeoutTimer.callOnce(next);
+	}
+	startQueuedCheckers();
 }
 
 void ProxiesBoxController::setupChecker(int id, const Checker &checker) {
@@ -1230,6 +1320,7 @@ void ProxiesBoxController::setupChecker(int id, const Checker &checker) {
 			item->ping = pingTime;
 			updateView(*item);
 		}
+		startQueuedCheckers();
 	});
 	const auto failed = [=] {
 		const auto item = findById(id);
@@ -1244,6 +1335,9 @@ void ProxiesBoxController::setupChecker(int id, const Checker &checker) {
 			item->state = ItemState::Unavailable;
 			updateView(*item);
 		}
+		if (!item->checker && !item->checkerv6) {
+			startQueuedCheckers();
+		}
 	};
 	pointer->connect(pointer, &Connection::disconnected, failed);
 	pointer->connect(pointer, &Connection::error, failed);
@@ -1389,7 +1483,9 @@ void ProxiesBoxController::replaceItemWith(
 	proxies.erase(ranges::remove(proxies, which->data), end(proxies));
 
 	_views.fire({ which->id });
+	_checkQueue.erase(ranges::remove(_checkQueue, which->id), end(_checkQueue));
 	_list.erase(which);
+	startQueuedCheckers();
 
 	if (with->deleted) {
 		restoreItem(with->id);
@@ -1492,6 +1588,33 @@ auto ProxiesBoxController::views() const -> rpl::producer<ItemView> {
 	return _views.events();
 }
 
+rpl::producer<QString> ProxiesBoxController::connectionQualityValue() const {
+	const auto account = _account;
+	return rpl::single(
+		rpl::empty_value()
+	) | rpl::then(
+		base::timer_each(kQualityRefreshInterval)
+	) | rpl::map([=] {
+		const auto quality = account->mtp().dcquality();
+		if (!quality.smoothedRoundTrip) {
+			return QString();
+		}
+		return ktr("ktg_proxy_connection_quality", {
+			"ping",
+			QString::number(quality.smoothedRoundTrip),
+		}, {
+			"variance",
+			QString::number(quality.roundTripVariance),
+		}, {
+			"lost",
+			QString::number(quality.lostPings),
+		}, {
+			"connected",
+			QString::number(quality.connectedPing),
+		});
+	}) | rpl::distinct_until_changed();
+}
+
 void ProxiesBoxController::updateView(const Item &item) {
 	const auto selected = (_settings.selected() == item.data);
 	const auto deleted = item.deleted;
@@ -77,6 +77,7 @@ public:
 	rpl::producer<ProxyData::Settings> proxySettingsValue() const;
 
 	rpl::producer<ItemView> views() const;
+	rpl::producer<QString> connectionQualityValue() const;
 
 	~ProxiesBoxController();
 
@@ -90,6 +91,7 @@ private:
 		Checker checkerv6;
 		ItemState state = ItemState::Checking;
 		int ping = 0;
+		crl::time checkStarted = 0;
 
 	};
 
@@ -100,6 +102,10 @@ private:
 	void share(const ProxyData &proxy);
 	void saveDelayed();
 	void refreshChecker(Item &item);
+	void startChecker(Item &item);
+	void startQueuedCheckers();
+	void checkTimeouts();
+	[[nodiscard]] int checkersCount() const;
 	void setupChecker(int id, const Checker &checker);
 
 	void replaceItemWith(
@@ -114,8 +120,10 @@ private:
 	Core::SettingsProxy &_settings;
 	int _idCounter = 0;
 	std::vector<Item> _list;
+	std::deque<int> _checkQueue;
 	rpl::event_stream<ItemView> _views;
 	base::Timer _saveTimer;
+	base::Timer _checkTimeoutTimer;
 	rpl::event_stream<ProxyData::Settings> _proxySettingsChanges;
 
 	ProxyData _lastSelectedProxy;
@@ -18,6 +18,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/text/format_values.h"
 #include "ui/emoji_config.h"
 #include "storage/storage_account.h"
+#include "storage/storage_cache_usage.h"
 #include "storage/cache/storage_cache_database.h"
 #include "data/data_session.h"
 #include "lang/lang_keys.h"
@@ -34,7 +35,7 @@ constexpr auto kMediaSizeLimitsCount = 18;
 constexpr auto kMinimalSizeLimit = 100 * kMegabyte;
 constexpr auto kTimeLimitsCount = 22;
 constexpr auto kMaxTimeLimitValue = std::numeric_limits<size_type>::max();
-constexpr auto kFakeMediaCacheTag = uint16(0xFFFF);
+constexpr auto kFakeMediaCacheTag = Storage::kCacheBigFileUsageTag;
 
 int64 TotalSizeLimitInMB(int index) {
 	if (index < 8) {
@@ -129,6 +130,18 @@ size_type ValueToLimit(size_type timeLimit) {
 	return (timeLimit != kMaxTimeLimitValue) ? timeLimit : 0;
 }
 
+QString UsageText(const Storage::CacheUsage &usage) {
+	const auto reads = usage.hits + usage.misses;
+	if (!reads) {
+		return QString();
+	}
+	return ktr(
+		"ktg_local_storage_usage",
+		{ "percent", QString::number(usage.hits * 100 / reads) },
+		{ "size", Ui::FormatSizeText(usage.bytesRead) },
+		{ "time", QString::number(usage.readTime / reads) });
+}
+
 } // namespace
 
 class LocalStorageBox::Row : public Ui::RpWidget {
@@ -140,6 +153,7 @@ public:
 		const Database::TaggedSummary &data);
 
 	void update(const Database::TaggedSummary &data);
+	void updateUsage(const Storage::CacheUsage &usage);
 	void toggleProgress(bool shown);
 
 	rpl::producer<> clearRequests() const;
@@ -151,9 +165,12 @@ protected:
 private:
 	QString titleText(const Database::TaggedSummary &data) const;
 	QString sizeText(const Database::TaggedSummary &data) const;
+	QString descriptionText() const;
 	void radialAnimationCallback();
 
 	Fn<QString(size_type)> _titleFactory;
+	QString _size;
+	QString _usage;
 	object_ptr<Ui::FlatLabel> _title;
 	object_ptr<Ui::FlatLabel> _description;
 	object_ptr<Ui::FlatLabel> _clearing = { nullptr };
@@ -169,13 +186,14 @@ LocalStorageBox::Row::Row(
 	const Database::TaggedSummary &data)
 : RpWidget(parent)
 , _titleFactory(std::move(title))
+, _size(sizeText(data))
 , _title(
 	this,
 	titleText(data),
 	st::localStorageRowTitle)
 , _description(
 	this,
-	sizeText(data),
+	_size,
 	st::localStorageRowSize)
 , _clear(this, std::move(clear), st::localStorageClear) {
 	_clear->setVisible(data.count != 0);
@@ -185,10 +203,16 @@ void LocalStorageBox::Row::update(const Database::TaggedSummary &data) {
 	if (data.count != 0) {
 		_title->setText(titleText(data));
 	}
-	_description->setText(sizeText(data));
+	_size = sizeText(data);
+	_description->setText(descriptionText());
 	_clear->setVisible(data.count != 0);
 }
 
+void LocalStorageBox::Row::updateUsage(const Storage::CacheUsage &usage) {
+	_usage = UsageText(usage);
+	_description->setText(descriptionText());
+}
+
 void LocalStorageBox::Row::toggleProgress(bool shown) {
 	if (!shown) {
 		_progress = nullptr;
@@ -275,13 +299,20 @@ QString LocalStorageBox::Row::sizeText(const Database::TaggedSummary &data) cons
 		: tr::lng_local_storage_empty(tr::now);
 }
 
+QString LocalStorageBox::Row::descriptionText() const {
+	return _usage.isEmpty()
+		? _size
+		: (_size + QString::fromUtf8(" \xC2\xB7 ") + _usage);
+}
+
 LocalStorageBox::LocalStorageBox(
 	QWidget*,
 	not_null<Main::Session*> session,
 	CreateTag)
 : _session(session)
 , _db(&session->data().cache())
-, _dbBig(&session->data().cacheBigFile()) {
+, _dbBig(&session->data().cacheBigFile())
+, _dbShared(&session->data().sharedCache()) {
 	const auto &settings = session->local().cacheSettings();
 	const auto &settingsBig = session->local().cacheBigFileSettings();
 	_totalSizeLimit = settings.totalSizeLimit + settingsBig.totalSizeLimit;
@@ -295,11 +326,16 @@ void LocalStorageBox::Show(not_null<::Main::Session*> session) {
 	const auto weak = shared->data();
 	rpl::combine(
 		session->data().cache().statsOnMain(),
-		session->data().cacheBigFile().statsOnMain()
+		session->data().cacheBigFile().statsOnMain(),
+		session->data().sharedCache().statsOnMain()
 	) | rpl::start_with_next([=](
 			Database::Stats &&stats,
-			Database::Stats &&statsBig) {
-		weak->update(std::move(stats), std::move(statsBig));
+			Database::Stats &&statsBig,
+			Database::Stats &&statsShared) {
+		weak->update(
+			std::move(stats),
+			std::move(statsBig),
+			std::move(statsShared));
 		if (auto &strong = *shared) {
 			Ui::show(std::move(strong));
 		}
@@ -327,14 +363,30 @@ void LocalStorageBox::updateRow(
 
 void LocalStorageBox::update(
 		Database::Stats &&stats,
-		Database::Stats &&statsBig) {
+		Database::Stats &&statsBig,
+		Database::Stats &&statsShared) {
 	_stats = std::move(stats);
 	_statsBig = std::move(statsBig);
+
+	// The public files shared with other accounts are shown together
+	// with the account ones, they are cleared together as well.
+	_stats.full.count += statsShared.full.count;
+	_stats.full.totalSize += statsShared.full.totalSize;
+	for (const auto &[tag, summary] : statsShared.tagged) {
+		auto &to = _stats.tagged[tag];
+		to.count += summary.count;
+		to.totalSize += summary.totalSize;
+	}
+	_stats.clearing = _stats.clearing || statsShared.clearing;
+
 	if (const auto i = _rows.find(0); i != end(_rows)) {
 		i->second->entity()->toggleProgress(
 			_stats.clearing || _statsBig.clearing);
 	}
 	for (const auto &entry : _rows) {
+		entry.second->entity()->updateUsage(entry.first
+			? Storage::CacheUsageByTag(entry.first)
+			: Storage::CacheUsageTotal());
 		if (entry.first == kFakeMediaCacheTag) {
 			updateRow(entry.second, &_statsBig.full);
 		} else if (entry.first) {
@@ -361,9 +413,11 @@ void LocalStorageBox::clearByTag(uint16 tag) {
 		_dbBig->clear();
 	} else if (tag) {
 		_db->clearByTag(tag);
+		_dbShared->clearByTag(tag);
 	} else {
 		_db->clear();
 		_dbBig->clear();
+		_dbShared->clear();
 		Ui::Emoji::ClearIrrelevantCache();
 	}
 }
@@ -385,6 +439,9 @@ void LocalStorageBox::setupControls() {
 				std::move(clear),
 				data)));
 		const auto shown = (data.count && data.totalSize) || !tag;
+		result->entity()->updateUsage(tag
+			? Storage::CacheUsageByTag(tag)
+			: Storage::CacheUsageTotal());
 		result->toggle(shown, anim::type::instant);
 		result->entity()->clearRequests(
 		) | rpl::start_with_next([=] {
@@ -603,6 +660,7 @@ void LocalStorageBox::save() {
 	updateBig.totalTimeLimit = _timeLimit;
 	_session->local().updateCacheSettings(update, updateBig);
 	_session->data().cache().updateSettings(update);
+	_session->data().sharedCache().updateSettings(update);
 	closeBox();
 }
 
@@ -51,7 +51,10 @@ private:
 	class Row;
 
 	void clearByTag(uint16 tag);
-	void update(Database::Stats &&stats, Database::Stats &&statsBig);
+	void update(
+		Database::Stats &&stats,
+		Database::Stats &&statsBig,
+		Database::Stats &&statsShared);
 	void updateRow(
 		not_null<Ui::SlideWrap<Row>*> row,
 		const Database::TaggedSummary *data);
@@ -86,6 +89,7 @@ private:
 	const not_null<Main::Session*> _session;
 	const not_null<Storage::Cache::Database*> _db;
 	const not_null<Storage::Cache::Database*> _dbBig;
+	const not_null<Storage::Cache::Database*> _dbShared;
 
 	Database::Stats _stats;
 	Database::Stats _statsBig;
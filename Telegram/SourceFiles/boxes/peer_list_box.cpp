@@ -1046,6 +1046,7 @@ void PeerListContent::addToSearchIndex(not_null<PeerListRow*> row) {
 	for (auto ch : row->nameFirstLetters()) {
 		_searchIndex[ch].push_back(row);
 	}
+	_localFilterResultsValid = false;
 }
 
 void PeerListContent::removeFromSearchIndex(not_null<PeerListRow*> row) {
@@ -1062,6 +1063,8 @@ void PeerListContent::removeFromSearchIndex(not_null<PeerListRow*> row) {
 			}
 		}
 		row->setNameFirstLetters({});
+		_localFilterResultsValid = false;
+		_localFilterResults.clear();
 	}
 }
 
@@ -1164,6 +1167,8 @@ void PeerListContent::clearAllContent() {
 	_rowsByPeer.clear();
 	_filterResults.clear();
 	_searchIndex.clear();
+	_localFilterResults.clear();
+	_localFilterResultsValid = false;
 	_rows.clear();
 	_searchRows.clear();
 	_searchQuery
@@ -1846,20 +1851,33 @@ void PeerListContent::searchQueryChanged(QString query) {
 	const auto searchWordsList = TextUtilities::PrepareSearchWords(query);
 	const auto normalizedQuery = searchWordsList.join(' ');
 	if (_normalizedSearchQuery != normalizedQuery) {
+		// Extending the query only drops rows from the last local matches.
+		const auto narrowing = _localFilterResultsValid
+			&& !_normalizedSearchQuery.isEmpty()
+			&& normalizedQuery.startsWith(_normalizedSearchQuery);
+		auto previous = narrowing
+			? base::take(_localFilterResults)
+			: std::vector<not_null<PeerListRow*>>();
+		_localFilterResults.clear();
+		_localFilterResultsValid = false;
 		setSearchQuery(query, normalizedQuery);
 		if (_controller->searchInLocal() && !searchWordsList.isEmpty()) {
 			Assert(_hiddenRows.empty());
 
 			auto minimalList = (const std::vector<not_null<PeerListRow*>>*)nullptr;
-			for (const auto &searchWord : searchWordsList) {
-				auto searchWordStart = searchWord[0].toLower();
-				auto it = _searchIndex.find(searchWordStart);
-				if (it == _searchIndex.cend()) {
-					// Some word can't be found in any row.
-					minimalList = nullptr;
-					break;
-				} else if (!minimalList || minimalList->size() > it->second.size()) {
-					minimalList = &it->second;
+			if (narrowing) {
+				minimalList = &previous;
+			} else {
+				for (const auto &searchWord : searchWordsList) {
+					auto searchWordStart = searchWord[0].toLower();
+					auto it = _searchIndex.find(searchWordStart);
+					if (it == _searchIndex.cend()) {
+						// Some word can't be found in any row.
+						minimalList = nullptr;
+						break;
+					} else if (!minimalList || minimalList->size() > it->second.size()) {
+						minimalList = &it->second;
+					}
 				}
 			}
 			if (minimalList) {
@@ -1890,6 +1908,8 @@ void PeerListContent::searchQueryChanged(QString query) {
 					}
 				}
 			}
+			_localFilterResults = _filterResults;
+			_localFilterResultsValid = true;
 		}
 		if (_controller->hasComplexSearch()) {
 			_controller->search(_searchQuery);
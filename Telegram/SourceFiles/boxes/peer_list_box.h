@@ -805,6 +805,10 @@ private:
 	QString _normalizedSearchQuery;
 	QString _mentionHighlight;
 	std::vector<not_null<PeerListRow*>> _filterResults;
+
+	// Local matches of the last query while the index is unchanged.
+	std::vector<not_null<PeerListRow*>> _localFilterResults;
+	bool _localFilterResultsValid = false;
 	base::flat_set<not_null<PeerListRow*>> _hiddenRows;
 
 	int _aboveHeight = 0;
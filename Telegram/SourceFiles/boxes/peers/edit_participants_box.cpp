@@ -45,6 +45,7 @@ constexpr auto kForwardMessagesOnAdd = 100;
 
 constexpr auto kParticipantsFirstPageCount = 16;
 constexpr auto kParticipantsPerPage = 200;
+constexpr auto kParticipantsParallelPages = 3;
 constexpr auto kSortByOnlineDelay = crl::time(1000);
 
 void RemoveAdmin(
@@ -789,7 +790,7 @@ ParticipantsOnlineSorter::ParticipantsOnlineSorter(
 : _peer(peer)
 , _delegate(delegate)
 , _sortByOnlineTimer([=] { sort(); }) {
-	peer->session().changes().peerUpdates(
+	peer->session().changes().framedPeerUpdates(
 		Data::PeerUpdate::Flag::OnlineStatus
 	) | rpl::start_with_next([=](const Data::PeerUpdate &update) {
 		const auto peerId = update.peer->id;
@@ -1093,7 +1094,7 @@ auto ParticipantsBoxController::saveState() const
 	auto my = std::make_unique<SavedState>(_additional);
 	my->offset = _offset;
 	my->allLoaded = _allLoaded;
-	my->wasLoading = (_loadRequestId != 0);
+	my->wasLoading = !_loadRequests.empty();
 	if (const auto search = searchController()) {
 		my->searchState = search->saveState();
 	}
@@ -1147,12 +1148,10 @@ void ParticipantsBoxController::restoreState(
 		? state->controllerState.get()
 		: nullptr;
 	if (const auto my = dynamic_cast<SavedState*>(typeErasedState)) {
-		if (const auto requestId = base::take(_loadRequestId)) {
-			_api.request(requestId).cancel();
-		}
+		cancelLoadRequests();
 
 		_additional = std::move(my->additional);
-		_offset = my->offset;
+		_offset = _requestedOffset = my->offset;
 		_allLoaded = my->allLoaded;
 		if (const auto search = searchController()) {
 			search->restoreState(std::move(my->searchState));
@@ -1354,15 +1353,30 @@ void ParticipantsBoxController::rebuildRowTypes() {
 void ParticipantsBoxController::loadMoreRows() {
 	if (searchController() && searchController()->loadMoreRows()) {
 		return;
-	} else if (!_peer->isChannel() || _loadRequestId || _allLoaded) {
+	} else if (!_peer->isChannel() || _allLoaded) {
 		return;
 	}
 
-	const auto channel = _peer->asChannel();
 	if (feedMegagroupLastParticipants()) {
 		return;
 	}
 
+	// First query is small and fast, next ones load a lot of rows.
+	if (!_offset) {
+		if (_loadRequests.empty()) {
+			requestParticipantsPage(0, kParticipantsFirstPageCount);
+		}
+		return;
+	}
+	while (_loadRequests.size() < kParticipantsParallelPages) {
+		requestParticipantsPage(_requestedOffset, kParticipantsPerPage);
+	}
+}
+
+void ParticipantsBoxController::requestParticipantsPage(
+		int offset,
+		int limit) {
+	const auto channel = _peer->asChannel();
 	const auto filter = [&] {
 		if (_role == Role::Members || _role == Role::Profile) {
 			return MTP_channelParticipantsRecent();
@@ -1373,24 +1387,50 @@ void ParticipantsBoxController::loadMoreRows() {
 		}
 		return MTP_channelParticipantsKicked(MTP_string());
 	}();
-
-	// First query is small and fast, next loads a lot of rows.
-	const auto perPage = (_offset > 0)
-		? kParticipantsPerPage
-		: kParticipantsFirstPageCount;
 	const auto participantsHash = uint64(0);
 
-	_loadRequestId = _api.request(MTPchannels_GetParticipants(
+	_requestedOffset = offset + limit;
+	_loadRequests[offset] = _api.request(MTPchannels_GetParticipants(
 		channel->inputChannel,
 		filter,
-		MTP_int(_offset),
-		MTP_int(perPage),
+		MTP_int(offset),
+		MTP_int(limit),
 		MTP_long(participantsHash)
 	)).done([=](const MTPchannels_ChannelParticipants &result) {
-		const auto firstLoad = !_offset;
-		_loadRequestId = 0;
+		_loadRequests.remove(offset);
+		_loadedPages.emplace(offset, result);
+		applyLoadedPages();
+	}).fail([=] {
+		// Later pages wait for this one, so start again from it.
+		cancelLoadRequests();
+		_requestedOffset = _offset;
+	}).send();
+}
 
-		auto wasRecentRequest = firstLoad
+void ParticipantsBoxController::applyLoadedPages() {
+	const auto channel = _peer->asChannel();
+	const auto firstLoad = !_offset;
+	const auto nextPageOffset = [&] {
+		const auto loaded = _loadedPages.empty()
+			? _requestedOffset
+			: _loadedPages.front().first;
+		const auto requested = _loadRequests.empty()
+			? _requestedOffset
+			: _loadRequests.front().first;
+		return std::min(loaded, requested);
+	};
+	auto applied = false;
+	auto restart = false;
+	while (!_loadedPages.empty()
+		&& (_loadRequests.empty()
+			|| _loadedPages.front().first < _loadRequests.front().first)) {
+		const auto result = std::move(_loadedPages.front().second);
+		_loadedPages.erase(_loadedPages.begin());
+		applied = true;
+
+		const auto firstPage = !_offset;
+		const auto wasOffset = _offset;
+		const auto wasRecentRequest = firstPage
 			&& (_role == Role::Members || _role == Role::Profile);
 
 		result.match([&](const MTPDchannels_channelParticipants &data) {
@@ -1414,17 +1454,38 @@ void ParticipantsBoxController::loadMoreRows() {
 				"channels.channelParticipantsNotModified received!"));
 		});
 
-		if (_allLoaded
-			|| (firstLoad && delegate()->peerListFullRowsCount() > 0)) {
-			refreshDescription();
+		if (_allLoaded) {
+			cancelLoadRequests();
+		} else if (nextPageOffset() != _offset) {
+			// The server may return less rows than asked, that shifts
+			// the pages requested after this one. Drop them and continue
+			// from the received offset.
+			cancelLoadRequests();
+			_requestedOffset = _offset;
+			restart = !firstPage && (_offset != wasOffset);
 		}
-		if (_onlineSorter) {
-			_onlineSorter->sort();
-		}
-		delegate()->peerListRefreshRows();
-	}).fail([this] {
-		_loadRequestId = 0;
-	}).send();
+	}
+	if (!applied) {
+		return;
+	}
+	if (_allLoaded
+		|| (firstLoad && delegate()->peerListFullRowsCount() > 0)) {
+		refreshDescription();
+	}
+	if (_onlineSorter) {
+		_onlineSorter->sort();
+	}
+	delegate()->peerListRefreshRows();
+	if (restart) {
+		loadMoreRows();
+	}
+}
+
+void ParticipantsBoxController::cancelLoadRequests() {
+	for (const auto &[offset, requestId] : base::take(_loadRequests)) {
+		_api.request(requestId).cancel();
+	}
+	_loadedPages.clear();
 }
 
 void ParticipantsBoxController::refreshDescription() {
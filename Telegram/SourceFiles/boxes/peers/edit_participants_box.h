@@ -257,6 +257,9 @@ private:
 	bool removeRow(not_null<PeerData*> participant);
 	void refreshCustomStatus(not_null<PeerListRow*> row) const;
 	bool feedMegagroupLastParticipants();
+	void requestParticipantsPage(int offset, int limit);
+	void applyLoadedPages();
+	void cancelLoadRequests();
 	Type computeType(not_null<PeerData*> participant) const;
 	void recomputeTypeFor(not_null<PeerData*> participant);
 
@@ -272,8 +275,13 @@ private:
 	MTP::Sender _api;
 	Role _role = Role::Admins;
 	int _offset = 0;
-	mtpRequestId _loadRequestId = 0;
 	bool _allLoaded = false;
+
+	// Pages are requested a few at once and applied in offset order.
+	base::flat_map<int, mtpRequestId> _loadRequests;
+	base::flat_map<int, MTPchannels_ChannelParticipants> _loadedPages;
+	int _requestedOffset = 0;
+
 	ParticipantsAdditionalData _additional;
 	std::unique_ptr<ParticipantsOnlineSorter> _onlineSorter;
 	Ui::BoxPointer _editBox;
@@ -59,6 +59,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace {
 
+// Previews are decoded in parallel, while the files are still added to
+// the box in their original order.
+constexpr auto kPrepareInParallel = 4;
+
 using Ui::SendFilesWay;
 
 inline bool CanAddUrls(const QList<QUrl> &urls) {
@@ -285,31 +289,46 @@ void SendFilesBox::initPreview() {
 	}, _dimensionsLifetime);
 }
 
-void SendFilesBox::enqueueNextPrepare() {
-	if (_preparing) {
-		return;
+struct SendFilesBox::PreparingFile {
+	explicit PreparingFile(Ui::PreparedFile &&file)
+	: file(std::move(file))
+	, ready(this->file.information != nullptr) {
 	}
-	while (!_list.filesToProcess.empty()
-		&& _list.filesToProcess.front().information) {
-		auto file = std::move(_list.filesToProcess.front());
+
+	Ui::PreparedFile file;
+	bool ready = false;
+};
+
+void SendFilesBox::enqueueNextPrepare() {
+	while (true) {
+		while (!_preparing.empty() && _preparing.front()->ready) {
+			addFile(std::move(_preparing.front()->file));
+			_preparing.pop_front();
+		}
+		if (_list.filesToProcess.empty()
+			|| int(_preparing.size()) >= kPrepareInParallel) {
+			return;
+		}
+		const auto entry = std::make_shared<PreparingFile>(
+			std::move(_list.filesToProcess.front()));
 		_list.filesToProcess.pop_front();
-		addFile(std::move(file));
-	}
-	if (_list.filesToProcess.empty()) {
-		return;
-	}
-	auto file = std::move(_list.filesToProcess.front());
-	_list.filesToProcess.pop_front();
-	const auto weak = Ui::MakeWeak(this);
-	_preparing = true;
-	crl::async([weak, file = std::move(file)]() mutable {
-		Storage::PrepareDetails(file, st::sendMediaPreviewSize);
-		crl::on_main([weak, file = std::move(file)]() mutable {
-			if (weak) {
-				weak->addPreparedAsyncFile(std::move(file));
-			}
+		_preparing.push_back(entry);
+		if (entry->ready) {
+			continue;
+		}
+		const auto weak = Ui::MakeWeak(this);
+
+		// The file is not accessed on main until it is marked ready.
+		crl::async([weak, entry] {
+			Storage::PrepareDetails(entry->file, st::sendMediaPreviewSize);
+			crl::on_main([weak, entry] {
+				entry->ready = true;
+				if (weak) {
+					weak->addPreparedAsyncFiles();
+				}
+			});
 		});
-	});
+	}
 }
 
 void SendFilesBox::setupShadows() {
@@ -829,17 +848,13 @@ bool SendFilesBox::addFiles(Ui::PreparedList list) {
 	return true;
 }
 
-void SendFilesBox::addPreparedAsyncFile(Ui::PreparedFile &&file) {
-	Expects(file.information != nullptr);
-
-	_preparing = false;
+void SendFilesBox::addPreparedAsyncFiles() {
 	const auto count = int(_list.files.size());
-	addFile(std::move(file));
 	enqueueNextPrepare();
 	if (_list.files.size() > count) {
 		refreshAllAfterChanges(count);
 	}
-	if (!_preparing && _whenReadySend) {
+	if (_preparing.empty() && _whenReadySend) {
 		_whenReadySend();
 	}
 }
@@ -994,7 +1009,7 @@ void SendFilesBox::send(
 		&& !options.scheduled) {
 		return sendScheduled();
 	}
-	if (_preparing) {
+	if (!_preparing.empty()) {
 		_whenReadySend = [=] {
 			send(options, ctrlShiftEnter);
 		};
@@ -85,6 +85,7 @@ protected:
 	void resizeEvent(QResizeEvent *e) override;
 
 private:
+	struct PreparingFile;
 	class Block final {
 	public:
 		Block(
@@ -155,7 +156,7 @@ private:
 	void refreshAllAfterChanges(int fromItem);
 
 	void enqueueNextPrepare();
-	void addPreparedAsyncFile(Ui::PreparedFile &&file);
+	void addPreparedAsyncFiles();
 
 	const not_null<Window::SessionController*> _controller;
 	const Api::SendType _sendType = Api::SendType();
@@ -195,7 +196,7 @@ private:
 	QPointer<Ui::VerticalLayout> _inner;
 	std::vector<Block> _blocks;
 	Fn<void()> _whenReadySend;
-	bool _preparing = false;
+	std::deque<std::shared_ptr<PreparingFile>> _preparing;
 
 	QPointer<Ui::RoundButton> _send;
 	QPointer<Ui::RoundButton> _addFile;
@@ -813,7 +813,7 @@ not_null<Lottie::MultiPlayer*> StickerSetBox::Inner::getLottiePlayer() {
 	if (!_lottiePlayer) {
 		_lottiePlayer = std::make_unique<Lottie::MultiPlayer>(
 			Lottie::Quality::Default,
-			Lottie::MakeFrameRenderer());
+			ChatHelpers::LottieRendererFromPool());
 		_lottiePlayer->updates(
 		) | rpl::start_with_next([=] {
 			update();
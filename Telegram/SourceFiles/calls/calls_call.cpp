@@ -15,6 +15,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/boxes/confirm_box.h"
 #include "ui/boxes/rate_call_box.h"
 #include "calls/calls_instance.h"
+#include "calls/calls_call_stats.h"
 #include "base/openssl_help.h"
 #include "base/random.h"
 #include "mtproto/mtproto_dh_utils.h"
@@ -48,6 +49,7 @@ constexpr auto kMinLayer = 65;
 constexpr auto kHangupTimeoutMs = 5000;
 constexpr auto kSha256Size = 32;
 constexpr auto kAuthKeySize = 256;
+constexpr auto kRecordStatsInterval = crl::time(1000);
 const auto kDefaultVersion = "2.4.4"_q;
 
 const auto Register = tgcalls::Register<tgcalls::InstanceImpl>();
@@ -896,6 +898,29 @@ void Call::createAndStartController(const MTPDphoneCall &call) {
 
 	raw->setIncomingVideoOutput(_videoIncoming->sink());
 	raw->setAudioOutputDuckingEnabled(settings.callAudioDuckingEnabled());
+
+	if (cRecordCallStats()) {
+		startStatsRecorder();
+	}
+}
+
+void Call::startStatsRecorder() {
+	const auto path = LastCallStatsPath();
+	QDir().mkpath(QFileInfo(path).absolutePath());
+	_statsRecorder = std::make_unique<CallStatsRecorder>(path);
+	_statsTimer.setCallback([=] { recordStats(); });
+	_statsTimer.callEach(kRecordStatsInterval);
+}
+
+void Call::recordStats() {
+	if (!_instance || !_statsRecorder) {
+		return;
+	}
+	const auto traffic = _instance->getTrafficStats();
+	_statsRecorder->add(
+		_signalBarCount.current(),
+		traffic.bytesSentWifi + traffic.bytesSentMobile,
+		traffic.bytesReceivedWifi + traffic.bytesReceivedMobile);
 }
 
 void Call::handleControllerStateChange(tgcalls::State state) {
@@ -1253,6 +1278,11 @@ void Call::handleControllerError(const QString &error) {
 }
 
 void Call::destroyController() {
+	if (_statsRecorder) {
+		recordStats();
+		_statsTimer.cancel();
+		_statsRecorder = nullptr;
+	}
 	if (_instance) {
 		_instance->stop([](tgcalls::FinalState) {
 		});
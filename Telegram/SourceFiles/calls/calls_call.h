@@ -34,6 +34,8 @@ class VideoTrack;
 
 namespace Calls {
 
+class CallStatsRecorder;
+
 struct DhConfig {
 	int32 version = 0;
 	int32 g = 0;
@@ -247,6 +249,8 @@ private:
 	void setFailedQueued(const QString &error);
 	void setSignalBarCount(int count);
 	void destroyController();
+	void startStatsRecorder();
+	void recordStats();
 
 	void setupOutgoingVideo();
 	void updateRemoteMediaState(
@@ -291,6 +295,9 @@ private:
 
 	std::unique_ptr<Media::Audio::Track> _waitingTrack;
 
+	std::unique_ptr<CallStatsRecorder> _statsRecorder;
+	base::Timer _statsTimer;
+
 	rpl::lifetime _lifetime;
 
 };
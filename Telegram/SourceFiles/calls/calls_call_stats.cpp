@@ -0,0 +1,239 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "calls/calls_call_stats.h"
+
+#include "kotato/kotato_lang.h"
+#include "lang/lang_keys.h"
+#include "ui/layers/generic_box.h"
+#include "ui/widgets/labels.h"
+#include "ui/text/format_values.h"
+#include "styles/style_layers.h"
+#include "styles/style_boxes.h"
+
+#include <QtCore/QDataStream>
+
+namespace Calls {
+namespace {
+
+constexpr auto kStatsMagic = quint32(0x54435354); // 'TCST'
+constexpr auto kStatsVersion = quint32(1);
+constexpr auto kSignalBarCount = 4;
+
+[[nodiscard]] float64 Kbps(int64 bytes, crl::time duration) {
+	return (duration > 0) ? (bytes * 8. / duration) : 0.;
+}
+
+void PaintGraph(
+		QPainter &p,
+		QRect rect,
+		const std::vector<CallStatsSample> &samples,
+		Fn<float64(int index)> value,
+		float64 maxValue,
+		const style::color &color) {
+	if (samples.size() < 2 || maxValue <= 0.) {
+		return;
+	}
+	const auto last = samples.back().time;
+	const auto x = [&](int index) {
+		return rect.x() + rect.width() * float64(samples[index].time) / last;
+	};
+	const auto y = [&](int index) {
+		const auto ratio = std::clamp(value(index) / maxValue, 0., 1.);
+		return rect.y() + rect.height() * (1. - ratio);
+	};
+	auto path = QPainterPath(QPointF(x(0), y(0)));
+	for (auto i = 1; i != int(samples.size()); ++i) {
+		path.lineTo(x(i), y(i));
+	}
+	p.setPen(QPen(color, st::lineWidth * 2));
+	p.setBrush(Qt::NoBrush);
+	p.drawPath(path);
+}
+
+} // namespace
+
+CallStatsRecorder::CallStatsRecorder(const QString &path)
+: _file(path)
+, _started(crl::now()) {
+	if (!_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		LOG(("Call Error: Could not open stats file '%1'.").arg(path));
+		_failed = true;
+		return;
+	}
+	auto stream = QDataStream(&_file);
+	stream << kStatsMagic << kStatsVersion;
+}
+
+void CallStatsRecorder::add(
+		int signalBars,
+		uint64 bytesSent,
+		uint64 bytesReceived) {
+	if (_failed) {
+		return;
+	}
+	const auto sent = std::max(bytesSent, _bytesSent) - _bytesSent;
+	const auto received = std::max(bytesReceived, _bytesReceived)
+		- _bytesReceived;
+	_bytesSent = bytesSent;
+	_bytesReceived = bytesReceived;
+
+	auto stream = QDataStream(&_file);
+	stream
+		<< quint32(crl::now() - _started)
+		<< qint8(std::clamp(signalBars, -1, kSignalBarCount))
+		<< quint32(std::min(sent, uint64(0xFFFFFFFFU)))
+		<< quint32(std::min(received, uint64(0xFFFFFFFFU)));
+	if (stream.status() != QDataStream::Ok || !_file.flush()) {
+		LOG(("Call Error: Could not write stats file."));
+		_failed = true;
+	}
+}
+
+QString LastCallStatsPath() {
+	return cWorkingDir() + qsl("DebugLogs/last_call_stats.bin");
+}
+
+std::vector<CallStatsSample> ReadCallStats(const QString &path) {
+	auto file = QFile(path);
+	if (!file.open(QIODevice::ReadOnly)) {
+		return {};
+	}
+	auto stream = QDataStream(&file);
+	auto magic = quint32();
+	auto version = quint32();
+	stream >> magic >> version;
+	if (magic != kStatsMagic || version != kStatsVersion) {
+		return {};
+	}
+	auto result = std::vector<CallStatsSample>();
+	result.reserve(file.size() / 13);
+	while (!stream.atEnd()) {
+		auto time = quint32();
+		auto signalBars = qint8();
+		auto sent = quint32();
+		auto received = quint32();
+		stream >> time >> signalBars >> sent >> received;
+		if (stream.status() != QDataStream::Ok) {
+			break;
+		}
+		result.push_back({
+			.time = crl::time(time),
+			.signalBars = signalBars,
+			.bytesSent = sent,
+			.bytesReceived = received,
+		});
+	}
+	return result;
+}
+
+void CallStatsBox(
+		not_null<Ui::GenericBox*> box,
+		std::vector<CallStatsSample> samples) {
+	box->setTitle(rktr("ktg_call_stats_title"));
+	box->setWidth(st::boxWideWidth);
+	box->addButton(tr::lng_close(), [=] { box->closeBox(); });
+
+	if (samples.size() < 2) {
+		box->addRow(object_ptr<Ui::FlatLabel>(
+			box,
+			ktr("ktg_call_stats_empty"),
+			st::boxLabel));
+		return;
+	}
+
+	// Per sample rates, the first one covers the time since the start.
+	auto sent = std::vector<float64>();
+	auto received = std::vector<float64>();
+	sent.reserve(samples.size());
+	received.reserve(samples.size());
+	auto maxRate = 0.;
+	auto totalSent = int64();
+	auto totalReceived = int64();
+	for (auto i = 0; i != int(samples.size()); ++i) {
+		const auto &sample = samples[i];
+		const auto duration = sample.time - (i ? samples[i - 1].time : 0);
+		sent.push_back(Kbps(sample.bytesSent, duration));
+		received.push_back(Kbps(sample.bytesReceived, duration));
+		maxRate = std::max({ maxRate, sent.back(), received.back() });
+		totalSent += sample.bytesSent;
+		totalReceived += sample.bytesReceived;
+	}
+	const auto duration = samples.back().time;
+
+	box->addRow(object_ptr<Ui::FlatLabel>(
+		box,
+		ktr("ktg_call_stats_summary", {
+			"duration",
+			Ui::FormatDurationText(duration / 1000),
+		}, {
+			"received",
+			QString::number(int(Kbps(totalReceived, duration))),
+		}, {
+			"sent",
+			QString::number(int(Kbps(totalSent, duration))),
+		}),
+		st::boxLabel));
+
+	const auto graphHeight = style::ConvertScale(120);
+	const auto barsHeight = style::ConvertScale(40);
+	const auto skip = st::boxLittleSkip;
+	const auto font = st::normalFont;
+	const auto graph = box->addRow(
+		object_ptr<Ui::RpWidget>(box),
+		style::margins(
+			st::boxRowPadding.left(),
+			skip,
+			st::boxRowPadding.right(),
+			skip));
+	graph->resize(
+		graph->width(),
+		2 * font->height + graphHeight + barsHeight + 3 * skip);
+
+	const auto data = std::make_shared<std::vector<CallStatsSample>>(
+		std::move(samples));
+	graph->paintRequest(
+	) | rpl::start_with_next([=] {
+		auto p = QPainter(graph);
+		auto hq = PainterHighQualityEnabler(p);
+		const auto width = graph->width();
+
+		p.setFont(font);
+		p.setPen(st::windowSubTextFg);
+		p.drawText(
+			QRect(0, 0, width, font->height),
+			ktr("ktg_call_stats_bitrate", {
+				"max",
+				QString::number(int(maxRate)),
+			}),
+			style::al_left);
+		auto top = font->height + skip;
+		const auto rates = QRect(0, top, width, graphHeight);
+		p.fillRect(rates, st::windowBgOver);
+		PaintGraph(p, rates, *data, [&](int index) {
+			return received[index];
+		}, maxRate, st::windowActiveTextFg);
+		PaintGraph(p, rates, *data, [&](int index) {
+			return sent[index];
+		}, maxRate, st::attentionButtonFg);
+
+		top += graphHeight + skip;
+		p.setPen(st::windowSubTextFg);
+		p.drawText(
+			QRect(0, top, width, font->height),
+			ktr("ktg_call_stats_signal"),
+			style::al_left);
+		top += font->height + skip;
+		const auto bars = QRect(0, top, width, barsHeight);
+		p.fillRect(bars, st::windowBgOver);
+		PaintGraph(p, bars, *data, [&](int index) {
+			return float64(std::max((*data)[index].signalBars, 0));
+		}, float64(kSignalBarCount), st::windowActiveTextFg);
+	}, graph->lifetime());
+}
+
+} // namespace Calls
@@ -0,0 +1,48 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Ui {
+class GenericBox;
+} // namespace Ui
+
+namespace Calls {
+
+struct CallStatsSample {
+	crl::time time = 0;
+	int signalBars = 0;
+	int64 bytesSent = 0;
+	int64 bytesReceived = 0;
+};
+
+// Appends a sample per interval to a compact binary file,
+// traffic is stored as bytes passed since the previous sample.
+class CallStatsRecorder final {
+public:
+	explicit CallStatsRecorder(const QString &path);
+
+	void add(int signalBars, uint64 bytesSent, uint64 bytesReceived);
+
+private:
+	QFile _file;
+	crl::time _started = 0;
+	uint64 _bytesSent = 0;
+	uint64 _bytesReceived = 0;
+	bool _failed = false;
+
+};
+
+[[nodiscard]] QString LastCallStatsPath();
+[[nodiscard]] std::vector<CallStatsSample> ReadCallStats(
+	const QString &path);
+
+void CallStatsBox(
+	not_null<Ui::GenericBox*> box,
+	std::vector<CallStatsSample> samples);
+
+} // namespace Calls
@@ -32,6 +32,7 @@ namespace Calls::Group {
 namespace {
 
 constexpr auto kLabelRefreshInterval = 10 * crl::time(1000);
+constexpr auto kJoinAsCacheTimeout = 60 * crl::time(1000);
 
 using Context = ChooseJoinAsProcess::Context;
 
@@ -354,28 +355,10 @@ void ChooseJoinAsProcess::start(
 			strong->closeBox();
 		}
 	};
-	_request->id = session->api().request(MTPphone_GetGroupCallJoinAs(
-		_request->peer->input
-	)).done([=](const MTPphone_JoinAsPeers &result) {
+	const auto process = [=](std::vector<not_null<PeerData*>> list) {
 		const auto peer = _request->peer;
 		const auto self = peer->session().user();
 		auto info = JoinInfo{ .peer = peer, .joinAs = self };
-		auto list = result.match([&](const MTPDphone_joinAsPeers &data) {
-			session->data().processUsers(data.vusers());
-			session->data().processChats(data.vchats());
-			const auto &peers = data.vpeers().v;
-			auto list = std::vector<not_null<PeerData*>>();
-			list.reserve(peers.size());
-			for (const auto &peer : peers) {
-				const auto peerId = peerFromMTP(peer);
-				if (const auto peer = session->data().peerLoaded(peerId)) {
-					if (!ranges::contains(list, not_null{ peer })) {
-						list.push_back(peer);
-					}
-				}
-			}
-			return list;
-		});
 		const auto selectedId = peer->groupCallDefaultJoinAs();
 		if (list.empty()) {
 			_request->showToast(Lang::Hard::ServerError());
@@ -467,6 +450,41 @@ void ChooseJoinAsProcess::start(
 
 		_request->box = box.data();
 		_request->showBox(std::move(box));
+	};
+
+	if (_cachedSession.get() != session) {
+		_cached.clear();
+		_cachedSession = base::make_weak(session);
+	}
+	const auto i = _cached.find(peer);
+	if (i != end(_cached)
+		&& crl::now() - i->second.received < kJoinAsCacheTimeout) {
+		process(i->second.list);
+		return;
+	}
+	_request->id = session->api().request(MTPphone_GetGroupCallJoinAs(
+		_request->peer->input
+	)).done([=](const MTPphone_JoinAsPeers &result) {
+		auto list = result.match([&](const MTPDphone_joinAsPeers &data) {
+			session->data().processUsers(data.vusers());
+			session->data().processChats(data.vchats());
+			const auto &peers = data.vpeers().v;
+			auto list = std::vector<not_null<PeerData*>>();
+			list.reserve(peers.size());
+			for (const auto &peer : peers) {
+				const auto peerId = peerFromMTP(peer);
+				if (const auto peer = session->data().peerLoaded(peerId)) {
+					if (!ranges::contains(list, not_null{ peer })) {
+						list.push_back(peer);
+					}
+				}
+			}
+			return list;
+		});
+		if (!list.empty()) {
+			_cached[_request->peer] = { list, crl::now() };
+		}
+		process(std::move(list));
 	}).fail([=] {
 		finish({
 			.peer = _request->peer,
@@ -12,6 +12,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 class PeerData;
 
+namespace Main {
+class Session;
+} // namespace Main
+
 namespace Ui {
 class BoxContent;
 } // namespace Ui
@@ -54,6 +58,14 @@ private:
 	};
 	std::unique_ptr<ChannelsListRequest> _request;
 
+	// Join-as options rarely change, a fresh list skips the request.
+	struct CachedList {
+		std::vector<not_null<PeerData*>> list;
+		crl::time received = 0;
+	};
+	base::flat_map<not_null<PeerData*>, CachedList> _cached;
+	base::weak_ptr<Main::Session> _cachedSession;
+
 };
 
 } // namespace Calls::Group
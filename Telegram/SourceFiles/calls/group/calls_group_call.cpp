@@ -51,6 +51,10 @@ constexpr auto kFixManualLargeVideoDuration = 5 * crl::time(1000);
 constexpr auto kFixSpeakingLargeVideoDuration = 3 * crl::time(1000);
 constexpr auto kFullAsMediumsCount = 4; // 1 Full is like 4 Mediums.
 constexpr auto kMaxMediumQualities = 16; // 4 Fulls or 16 Mediums.
+constexpr auto kMinMediumQualities = 4; // 1 Full or 4 Mediums.
+constexpr auto kCheckVideoBudgetInterval = 2 * crl::time(1000);
+constexpr auto kVideoBudgetLowFps = 12;
+constexpr auto kVideoBudgetGoodFps = 20;
 
 [[nodiscard]] std::unique_ptr<Webrtc::MediaDevices> CreateMediaDevices() {
 	const auto &settings = Core::App().settings();
@@ -247,6 +251,9 @@ struct GroupCall::VideoTrack {
 	not_null<PeerData*> peer;
 	rpl::lifetime lifetime;
 	Group::VideoQuality quality = Group::VideoQuality();
+	int framesReceived = 0;
+	bool receivingBudgeted = false;
+	bool offscreen = false;
 	bool shown = false;
 };
 
@@ -577,6 +584,8 @@ GroupCall::GroupCall(
 , _checkJoinedTimer([=] { checkJoined(); })
 , _pushToTalkCancelTimer([=] { pushToTalkCancel(); })
 , _connectingSoundTimer([=] { playConnectingSoundOnce(); })
+, _videoBudgetTimer([=] { checkVideoBudget(); })
+, _mediumQualitiesBudget(kMaxMediumQualities)
 , _mediaDevices(CreateMediaDevices()) {
 	_muted.value(
 	) | rpl::combine_previous(
@@ -1157,6 +1166,7 @@ void GroupCall::markEndpointActive(
 		) | rpl::start_with_next([=] {
 			const auto activeTrack = _activeVideoTracks[endpoint].get();
 			const auto size = track->frameSize();
+			++activeTrack->framesReceived;
 			if (size.isEmpty()) {
 				track->markFrameShown();
 			} else if (!activeTrack->shown) {
@@ -2569,10 +2579,13 @@ void GroupCall::updateRequestedVideoChannels() {
 		return;
 	}
 	auto channels = std::vector<tgcalls::VideoChannelDescription>();
+	auto tracks = std::vector<not_null<VideoTrack*>>();
 	using Quality = tgcalls::VideoChannelDescription::Quality;
 	channels.reserve(_activeVideoTracks.size());
+	tracks.reserve(_activeVideoTracks.size());
 	const auto &camera = cameraSharingEndpoint();
 	const auto &screen = screenSharingEndpoint();
+	const auto &large = _videoEndpointLarge.current();
 	auto mediums = 0;
 	auto fullcameras = 0;
 	auto fullscreencasts = 0;
@@ -2580,6 +2593,9 @@ void GroupCall::updateRequestedVideoChannels() {
 		const auto &endpointId = endpoint.id;
 		if (endpointId == camera || endpointId == screen) {
 			continue;
+		} else if (video->offscreen && endpoint != large) {
+			// Nothing shows this video now, don't receive it at all.
+			continue;
 		}
 		const auto participant = real->participantByEndpoint(endpointId);
 		const auto params = (participant && participant->ssrc)
@@ -2616,9 +2632,12 @@ void GroupCall::updateRequestedVideoChannels() {
 			.minQuality = min,
 			.maxQuality = max,
 		});
+		tracks.push_back(video.get());
 	}
 
 	// We limit `count(Full) * kFullAsMediumsCount + count(medium)`.
+	// The limit starts at kMaxMediumQualities and is lowered while the
+	// videos we receive can't keep their frame rate, see checkVideoBudget.
 	//
 	// Try to preserve all qualities; If not
 	// Try to preserve all screencasts as Full and cameras as Medium; If not
@@ -2626,9 +2645,11 @@ void GroupCall::updateRequestedVideoChannels() {
 	// Try to preserve all cameras as Medium;
 	const auto mediumsCount = mediums
 		+ (fullcameras + fullscreencasts) * kFullAsMediumsCount;
-	const auto downgradeSome = (mediumsCount > kMaxMediumQualities);
+	const auto budget = _mediumQualitiesBudget;
+	const auto downgradeSome = (mediumsCount > budget);
 	const auto downgradeAll = (fullscreencasts * kFullAsMediumsCount)
-		> kMaxMediumQualities;
+		> budget;
+	_videoBudgetLimited = downgradeSome;
 	if (downgradeSome) {
 		for (auto &channel : channels) {
 			if (channel.maxQuality == Quality::Full) {
@@ -2649,16 +2670,72 @@ void GroupCall::updateRequestedVideoChannels() {
 			fullscreencasts = 0;
 		}
 	}
-	if (mediums > kMaxMediumQualities) {
+	if (mediums > budget) {
 		for (auto &channel : channels) {
 			if (channel.maxQuality == Quality::Medium) {
 				channel.maxQuality = Quality::Thumbnail;
 			}
 		}
 	}
+	for (auto i = 0, count = int(channels.size()); i != count; ++i) {
+		tracks[i]->receivingBudgeted
+			= (channels[i].maxQuality != Quality::Thumbnail);
+	}
+	if (channels.empty()) {
+		_videoBudgetTimer.cancel();
+	} else if (!_videoBudgetTimer.isActive()) {
+		for (const auto &[endpoint, video] : _activeVideoTracks) {
+			video->framesReceived = 0;
+		}
+		_videoBudgetCheckedAt = crl::now();
+		_videoBudgetTimer.callEach(kCheckVideoBudgetInterval);
+	}
 	_instance->setRequestedVideoChannels(std::move(channels));
 }
 
+void GroupCall::checkVideoBudget() {
+	const auto now = crl::now();
+	const auto elapsed = now - base::take(_videoBudgetCheckedAt, now);
+	auto frames = 0;
+	auto tracks = 0;
+	for (const auto &[endpoint, video] : _activeVideoTracks) {
+		const auto received = base::take(video->framesReceived);
+
+		// Screencasts send frames only when the screen changes,
+		// so their frame rate says nothing about our decoding.
+		if (endpoint.type == VideoEndpointType::Camera
+			&& video->receivingBudgeted
+			&& video->shown
+			&& video->track.state() == Webrtc::VideoState::Active) {
+			frames += received;
+			++tracks;
+		}
+	}
+	if (!tracks || elapsed <= 0) {
+		return;
+	}
+	// When decoding or the downlink can't keep up the frame rate of
+	// Medium and Full camera videos drops, so we ask for less of them.
+	const auto fps = (frames * crl::time(1000)) / (elapsed * tracks);
+	const auto was = _mediumQualitiesBudget;
+	if (fps < kVideoBudgetLowFps) {
+		_mediumQualitiesBudget = std::max(
+			_mediumQualitiesBudget - kFullAsMediumsCount,
+			kMinMediumQualities);
+	} else if (fps >= kVideoBudgetGoodFps && _videoBudgetLimited) {
+		_mediumQualitiesBudget = std::min(
+			_mediumQualitiesBudget + 1,
+			kMaxMediumQualities);
+	}
+	if (_mediumQualitiesBudget != was) {
+		DEBUG_LOG(("Call Info: Video budget %1 -> %2, fps %3."
+			).arg(was
+			).arg(_mediumQualitiesBudget
+			).arg(fps));
+		updateRequestedVideoChannels();
+	}
+}
+
 void GroupCall::updateRequestedVideoChannelsDelayed() {
 	if (_requestedVideoChannelsUpdateScheduled) {
 		return;
@@ -3140,6 +3217,20 @@ void GroupCall::requestVideoQuality(
 	updateRequestedVideoChannelsDelayed();
 }
 
+void GroupCall::toggleVideoOffscreen(
+		const VideoEndpoint &endpoint,
+		bool offscreen) {
+	if (!endpoint) {
+		return;
+	}
+	const auto i = _activeVideoTracks.find(endpoint);
+	if (i == end(_activeVideoTracks) || i->second->offscreen == offscreen) {
+		return;
+	}
+	i->second->offscreen = offscreen;
+	updateRequestedVideoChannelsDelayed();
+}
+
 void GroupCall::setCurrentAudioDevice(bool input, const QString &deviceId) {
 	if (input) {
 		_mediaDevices->switchToAudioInput(deviceId);
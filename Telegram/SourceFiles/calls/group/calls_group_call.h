@@ -324,6 +324,7 @@ public:
 	void requestVideoQuality(
 		const VideoEndpoint &endpoint,
 		Group::VideoQuality quality);
+	void toggleVideoOffscreen(const VideoEndpoint &endpoint, bool offscreen);
 
 	[[nodiscard]] bool videoEndpointPinned() const {
 		return _videoEndpointPinned.current();
@@ -519,6 +520,7 @@ private:
 
 	void updateRequestedVideoChannels();
 	void updateRequestedVideoChannelsDelayed();
+	void checkVideoBudget();
 	void fillActiveVideoEndpoints();
 
 	void editParticipant(
@@ -647,6 +649,10 @@ private:
 	std::shared_ptr<GlobalShortcutValue> _pushToTalk;
 	base::Timer _pushToTalkCancelTimer;
 	base::Timer _connectingSoundTimer;
+	base::Timer _videoBudgetTimer;
+	crl::time _videoBudgetCheckedAt = 0;
+	int _mediumQualitiesBudget = 0;
+	bool _videoBudgetLimited = false;
 	bool _hadJoinedState = false;
 
 	std::unique_ptr<Webrtc::MediaDevices> _mediaDevices;
@@ -144,6 +144,7 @@ private:
 	void removeRowFromSoundingMap(not_null<Row*> row);
 	void updateRowLevel(not_null<Row*> row, float level);
 	void checkRowPosition(not_null<Row*> row);
+	void checkRowPositions();
 	[[nodiscard]] bool needToReorder(not_null<Row*> row) const;
 	[[nodiscard]] bool allRowsAboveAreSpeaking(not_null<Row*> row) const;
 	[[nodiscard]] bool allRowsAboveMoreImportantThanHand(
@@ -182,6 +183,8 @@ private:
 	not_null<QWidget*> _menuParent;
 	base::unique_qptr<Ui::PopupMenu> _menu;
 	base::flat_set<not_null<PeerData*>> _menuCheckRowsAfterHidden;
+	base::flat_set<not_null<PeerData*>> _checkPositionRows;
+	bool _checkPositionsScheduled = false;
 
 	base::flat_map<PeerListRowId, crl::time> _raisedHandStatusRemoveAt;
 	base::Timer _raisedHandStatusRemoveTimer;
@@ -647,7 +650,34 @@ void Members::Controller::checkRowPosition(not_null<Row*> row) {
 		// Don't reorder rows while we show the popup menu.
 		_menuCheckRowsAfterHidden.emplace(row->peer());
 		return;
-	} else if (!needToReorder(row)) {
+	}
+
+	// Large calls send speaking updates in bursts, we sort once for all.
+	_checkPositionRows.emplace(row->peer());
+	if (_checkPositionsScheduled) {
+		return;
+	}
+	_checkPositionsScheduled = true;
+	crl::on_main(this, [=] {
+		checkRowPositions();
+	});
+}
+
+void Members::Controller::checkRowPositions() {
+	_checkPositionsScheduled = false;
+	if (_menu) {
+		for (const auto &peer : base::take(_checkPositionRows)) {
+			_menuCheckRowsAfterHidden.emplace(peer);
+		}
+		return;
+	}
+	auto rows = base::flat_set<not_null<const PeerListRow*>>();
+	for (const auto &peer : base::take(_checkPositionRows)) {
+		if (const auto row = findRow(peer); row && needToReorder(row)) {
+			rows.emplace(row);
+		}
+	}
+	if (rows.empty()) {
 		return;
 	}
 
@@ -655,25 +685,28 @@ void Members::Controller::checkRowPosition(not_null<Row*> row) {
 	// Or someone raised hand and has force muted above him.
 	// Or someone was forced muted and had can_unmute_self below him. Sort.
 	static constexpr auto kTop = std::numeric_limits<uint64>::max();
+	const auto moved = [&](const PeerListRow &row) {
+		return rows.contains(&row);
+	};
 	const auto projForAdmin = [&](const PeerListRow &other) {
 		const auto &real = static_cast<const Row&>(other);
 		return real.speaking()
-			// Speaking 'row' to the top, all other speaking below it.
-			? (&real == row.get() ? kTop : (kTop - 1))
+			// Speaking 'rows' to the top, all other speaking below them.
+			? (moved(real) ? kTop : (kTop - 1))
 			: (real.raisedHandRating() > 0)
 			// Then all raised hands sorted by rating.
 			? real.raisedHandRating()
 			: (real.state() == Row::State::Muted)
-			// All force muted at the bottom, but 'row' still above others.
-			? (&real == row.get() ? 1ULL : 0ULL)
+			// All force muted at the bottom, but 'rows' still above others.
+			? (moved(real) ? 1ULL : 0ULL)
 			// All not force-muted lie between raised hands and speaking.
 			: (kTop - 2);
 	};
 	const auto projForOther = [&](const PeerListRow &other) {
 		const auto &real = static_cast<const Row&>(other);
 		return real.speaking()
-			// Speaking 'row' to the top, all other speaking below it.
-			? (&real == row.get() ? kTop : (kTop - 1))
+			// Speaking 'rows' to the top, all other speaking below them.
+			? (moved(real) ? kTop : (kTop - 1))
 			: 0ULL;
 	};
 
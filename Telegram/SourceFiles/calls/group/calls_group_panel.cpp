@@ -955,6 +955,11 @@ void Panel::setupVideo(not_null<Viewport*> viewport) {
 	) | rpl::start_with_next([=](const VideoQualityRequest &request) {
 		_call->requestVideoQuality(request.endpoint, request.quality);
 	}, viewport->lifetime());
+
+	viewport->offscreenToggles(
+	) | rpl::start_with_next([=](const VideoStateToggle &toggle) {
+		_call->toggleVideoOffscreen(toggle.endpoint, toggle.value);
+	}, viewport->lifetime());
 }
 
 void Panel::toggleWideControls(bool shown) {
@@ -74,10 +74,12 @@ void Viewport::setup() {
 	raw->setMouseTracking(true);
 
 	_content->sizeValue(
-	) | rpl::filter([=] {
-		return wide();
-	}) | rpl::start_with_next([=] {
-		updateTilesGeometry();
+	) | rpl::start_with_next([=] {
+		if (wide()) {
+			updateTilesGeometry();
+		} else {
+			updateTilesOffscreen();
+		}
 	}, lifetime());
 
 	_content->events(
@@ -577,6 +579,28 @@ void Viewport::updateTilesGeometry(int outerWidth) {
 	} else {
 		updateTilesGeometryNarrow(outerWidth);
 	}
+	updateTilesOffscreen();
+}
+
+void Viewport::updateTilesOffscreen() {
+	// Tiles scrolled far enough out of the narrow list stop receiving
+	// video, half of the visible height around it is kept as prefetch.
+	const auto height = widget()->height();
+	const auto prefetch = height / 2;
+	for (const auto &tile : _tiles) {
+		const auto geometry = tile->geometry();
+		const auto offscreen = !wide()
+			&& !tile->hidden()
+			&& (height > 0)
+			&& (geometry.y() + geometry.height() <= -prefetch
+				|| geometry.y() >= height + prefetch);
+		if (tile->updateOffscreen(offscreen)) {
+			_offscreenToggles.fire({
+				.endpoint = tile->endpoint(),
+				.value = offscreen,
+			});
+		}
+	}
 }
 
 void Viewport::refreshHasTwoOrMore() {
@@ -839,6 +863,10 @@ rpl::producer<VideoQualityRequest> Viewport::qualityRequests() const {
 	return _qualityRequests.events();
 }
 
+auto Viewport::offscreenToggles() const -> rpl::producer<VideoStateToggle> {
+	return _offscreenToggles.events();
+}
+
 rpl::producer<bool> Viewport::mouseInsideValue() const {
 	return _mouseInside.value();
 }
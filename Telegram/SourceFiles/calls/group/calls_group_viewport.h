@@ -24,6 +24,7 @@ namespace Calls {
 class GroupCall;
 struct VideoEndpoint;
 struct VideoQualityRequest;
+struct VideoStateToggle;
 } // namespace Calls
 
 namespace Webrtc {
@@ -89,6 +90,8 @@ public:
 	[[nodiscard]] rpl::producer<bool> pinToggled() const;
 	[[nodiscard]] rpl::producer<VideoEndpoint> clicks() const;
 	[[nodiscard]] rpl::producer<VideoQualityRequest> qualityRequests() const;
+	[[nodiscard]] auto offscreenToggles() const
+		-> rpl::producer<VideoStateToggle>;
 	[[nodiscard]] rpl::producer<bool> mouseInsideValue() const;
 
 	[[nodiscard]] rpl::lifetime &lifetime();
@@ -145,6 +148,7 @@ private:
 	void updateTilesGeometryWide(int outerWidth, int outerHeight);
 	void updateTilesGeometryNarrow(int outerWidth);
 	void updateTilesGeometryColumn(int outerWidth);
+	void updateTilesOffscreen();
 	void setTileGeometry(not_null<VideoTile*> tile, QRect geometry);
 	void refreshHasTwoOrMore();
 	void updateTopControlsVisibility();
@@ -180,6 +184,7 @@ private:
 	rpl::event_stream<VideoEndpoint> _clicks;
 	rpl::event_stream<bool> _pinToggles;
 	rpl::event_stream<VideoQualityRequest> _qualityRequests;
+	rpl::event_stream<VideoStateToggle> _offscreenToggles;
 	float64 _controlsShownRatio = 1.;
 	VideoTile *_large = nullptr;
 	Fn<void()> _updateLargeScheduled;
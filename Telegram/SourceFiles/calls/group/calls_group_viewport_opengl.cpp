@@ -13,6 +13,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "calls/group/calls_group_members_row.h"
 #include "lang/lang_keys.h"
 #include "ui/gl/gl_shader.h"
+#include "core/paint_profiler.h"
 #include "data/data_peer.h"
 #include "styles/style_calls.h"
 
@@ -434,6 +435,7 @@ void Viewport::RendererGL::paint(
 
 	const auto defaultFramebufferObject = widget->defaultFramebufferObject();
 
+	const auto profile = Core::PaintProfiler::Scope("GroupCall/Viewport");
 	validateDatas();
 	auto index = 0;
 	for (const auto &tile : _owner->_tiles) {
@@ -761,15 +763,26 @@ void Viewport::RendererGL::paintTile(
 		geometry.size(),
 		_factor);
 	prepareObjects(f, tileData, blurSize);
-	f.glViewport(0, 0, blurSize.width(), blurSize.height());
 
-	bindFrame(f, data, tileData, _downscaleProgram);
+	// The first blur pass result is kept in the tile textures, so while
+	// the frame is the same only the final pass is drawn.
+	const auto imageIndex = _userpicFrame ? 0 : (data.index + 1);
+	if (tileData.blurTrackIndex != imageIndex
+		|| tileData.blurRotation != frameRotation) {
+		const auto profile = Core::PaintProfiler::Scope("GroupCall/Blur");
+		tileData.blurTrackIndex = imageIndex;
+		tileData.blurRotation = frameRotation;
+
+		f.glViewport(0, 0, blurSize.width(), blurSize.height());
 
-	drawDownscalePass(f, tileData);
-	drawFirstBlurPass(f, tileData, blurSize);
+		bindFrame(f, data, tileData, _downscaleProgram);
 
-	f.glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject);
-	setDefaultViewport(f);
+		drawDownscalePass(f, tileData);
+		drawFirstBlurPass(f, tileData, blurSize);
+
+		f.glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject);
+		setDefaultViewport(f);
+	}
 
 	bindFrame(f, data, tileData, _frameProgram);
 
@@ -895,6 +908,7 @@ void Viewport::RendererGL::prepareObjects(
 		return;
 	}
 	tileData.textureBlurSize = blurSize;
+	tileData.blurTrackIndex = -1;
 
 	const auto create = [&](int framebufferIndex, int index) {
 		tileData.textures.bind(f, index);
@@ -952,6 +966,9 @@ void Viewport::RendererGL::bindFrame(
 	const auto imageIndex = _userpicFrame ? 0 : (data.index + 1);
 	const auto upload = (tileData.trackIndex != imageIndex);
 	tileData.trackIndex = imageIndex;
+	const auto profile = Core::PaintProfiler::Scope([&] {
+		return upload ? "GroupCall/Upload" : nullptr;
+	});
 	if (_rgbaFrame) {
 		ensureARGB32Program();
 		program.argb32->bind();
@@ -54,6 +54,8 @@ private:
 		QRect nameRect;
 		int nameVersion = 0;
 		mutable int trackIndex = -1;
+		int blurTrackIndex = -1;
+		int blurRotation = 0;
 		mutable QSize rgbaSize;
 		mutable QSize textureSize;
 		mutable QSize textureChromaSize;
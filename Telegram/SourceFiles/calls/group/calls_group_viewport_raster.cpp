@@ -81,6 +81,27 @@ void Viewport::RendererSW::validateUserpicFrame(
 		kBlurRadius);
 }
 
+const QImage &Viewport::RendererSW::validateScaledFrame(
+		TileData &data,
+		const QImage &image,
+		qint64 key,
+		int rotation,
+		QSize size) {
+	const auto ratio = cIntRetinaFactor();
+	if (data.scaledKey != key
+		|| data.scaledFrame.size() != size * ratio) {
+		data.scaledKey = key;
+		data.scaledFrame = (rotation
+			? RotateFrameImage(image, rotation)
+			: image).scaled(
+				size * ratio,
+				Qt::IgnoreAspectRatio,
+				Qt::SmoothTransformation);
+		data.scaledFrame.setDevicePixelRatio(cRetinaFactor());
+	}
+	return data.scaledFrame;
+}
+
 void Viewport::RendererSW::paintTile(
 		Painter &p,
 		not_null<VideoTile*> tile,
@@ -134,7 +155,23 @@ void Viewport::RendererSW::paintTile(
 	const auto left = (width - scaled.width()) / 2;
 	const auto top = (height - scaled.height()) / 2;
 	const auto target = QRect(QPoint(x + left, y + top), scaled);
-	if (UsePainterRotation(frameRotation)) {
+	const auto downscale = (scaled.width() * cIntRetinaFactor()
+		< FlipSizeByRotation(image.size(), frameRotation).width());
+	if (downscale) {
+		// Repaints of other tiles or controls reuse the scaled frame,
+		// the track frame is scaled once for each new index.
+		const auto key = (_userpicFrame || _pausedFrame)
+			? image.cacheKey()
+			: -qint64(data.index) - 1;
+		p.drawImage(
+			target,
+			validateScaledFrame(
+				tileData,
+				image,
+				key,
+				frameRotation,
+				scaled));
+	} else if (UsePainterRotation(frameRotation)) {
 		if (frameRotation) {
 			p.save();
 			p.rotate(frameRotation);
@@ -148,6 +185,9 @@ void Viewport::RendererSW::paintTile(
 	} else {
 		p.drawImage(target, image);
 	}
+	if (!downscale) {
+		tileData.scaledFrame = QImage();
+	}
 	bg -= target;
 
 	if (left > 0) {
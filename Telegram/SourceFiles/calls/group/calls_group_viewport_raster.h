@@ -28,6 +28,8 @@ private:
 	struct TileData {
 		QImage userpicFrame;
 		QImage blurredFrame;
+		QImage scaledFrame;
+		qint64 scaledKey = 0;
 		bool stale = false;
 	};
 	void paintTile(
@@ -52,6 +54,12 @@ private:
 	void validateUserpicFrame(
 		not_null<VideoTile*> tile,
 		TileData &data);
+	[[nodiscard]] const QImage &validateScaledFrame(
+		TileData &data,
+		const QImage &image,
+		qint64 key,
+		int rotation,
+		QSize size);
 
 	const not_null<Viewport*> _owner;
 
@@ -121,6 +121,14 @@ bool Viewport::VideoTile::updateRequestedQuality(VideoQuality quality) {
 	return true;
 }
 
+bool Viewport::VideoTile::updateOffscreen(bool offscreen) {
+	if (_offscreen == offscreen) {
+		return false;
+	}
+	_offscreen = offscreen;
+	return true;
+}
+
 QSize Viewport::VideoTile::PinInnerSize(bool pinned) {
 	const auto &st = st::groupCallVideoTile;
 	const auto &icon = st::groupCallVideoTile.pin.icon;
@@ -74,6 +74,7 @@ public:
 	void hide();
 	void toggleTopControlsShown(bool shown);
 	bool updateRequestedQuality(VideoQuality quality);
+	bool updateOffscreen(bool offscreen);
 
 	[[nodiscard]] rpl::lifetime &lifetime() {
 		return _lifetime;
@@ -119,6 +120,7 @@ private:
 	bool _topControlsShown = false;
 	bool _pinned = false;
 	bool _hidden = true;
+	bool _offscreen = false;
 	std::optional<VideoQuality> _quality;
 
 	rpl::lifetime _lifetime;
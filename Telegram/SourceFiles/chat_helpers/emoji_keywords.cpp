@@ -35,10 +35,29 @@ struct LangPackEmoji {
 	QString text;
 };
 
+using LangPackMap = std::map<QString, std::vector<LangPackEmoji>>;
+
+struct LangPackEntry {
+	QString key;
+	std::vector<LangPackEmoji> list;
+};
+
+// Prefix tree node, all the keys starting with the node prefix are
+// in the [keysFrom, keysTill) range and the key equal to the prefix,
+// if there is one, is the first in that range.
+struct LangPackNode {
+	int keysFrom = 0;
+	int keysTill = 0;
+	int childrenFrom = 0;
+	int childrenCount = 0;
+	QChar ch;
+};
+
 struct LangPackData {
 	int version = 0;
 	int maxKeyLength = 0;
-	std::map<QString, std::vector<LangPackEmoji>> emoji;
+	std::vector<LangPackEntry> entries; // Sorted by key.
+	std::vector<LangPackNode> nodes;
 };
 
 [[nodiscard]] bool MustAddPostfix(const QString &text) {
@@ -72,6 +91,63 @@ struct LangPackData {
 	return false;
 }
 
+void BuildPrefixTree(LangPackData &data) {
+	const auto &entries = data.entries;
+	auto &nodes = data.nodes;
+	nodes.clear();
+	if (entries.empty()) {
+		return;
+	}
+	auto depths = std::vector<int>();
+	nodes.push_back({ .keysFrom = 0, .keysTill = int(entries.size()) });
+	depths.push_back(0);
+
+	// Children of each node are added together, so they are contiguous.
+	for (auto index = 0; index != int(nodes.size()); ++index) {
+		const auto depth = depths[index];
+		const auto till = nodes[index].keysTill;
+		auto from = nodes[index].keysFrom;
+		if (entries[from].key.size() == depth) {
+			++from;
+		}
+		const auto childrenFrom = int(nodes.size());
+		while (from != till) {
+			const auto ch = entries[from].key[depth];
+			auto next = from + 1;
+			while (next != till && entries[next].key[depth] == ch) {
+				++next;
+			}
+			nodes.push_back({ .keysFrom = from, .keysTill = next, .ch = ch });
+			depths.push_back(depth + 1);
+			from = next;
+		}
+		nodes[index].childrenFrom = childrenFrom;
+		nodes[index].childrenCount = int(nodes.size()) - childrenFrom;
+	}
+}
+
+[[nodiscard]] LangPackData Compile(int version, LangPackMap &&map) {
+	auto result = LangPackData{ .version = version };
+	result.entries.reserve(map.size());
+	for (auto &[key, list] : map) {
+		result.maxKeyLength = std::max(result.maxKeyLength, int(key.size()));
+		result.entries.push_back({ key, std::move(list) });
+	}
+	BuildPrefixTree(result);
+	return result;
+}
+
+[[nodiscard]] LangPackMap Decompile(LangPackData &&data) {
+	auto result = LangPackMap();
+	for (auto &entry : data.entries) {
+		result.emplace_hint(
+			end(result),
+			std::move(entry.key),
+			std::move(entry.list));
+	}
+	return result;
+}
+
 [[nodiscard]] EmojiPtr FindExact(const QString &text) {
 	auto length = 0;
 	const auto result = Find(text, &length);
@@ -96,7 +172,7 @@ void CreateCacheFilePath() {
 	if (!file.open(QIODevice::ReadOnly)) {
 		return {};
 	}
-	auto result = LangPackData();
+	auto result = LangPackMap();
 	auto stream = QDataStream(&file);
 	stream.setVersion(QDataStream::Qt_5_1);
 	auto version = qint32();
@@ -116,7 +192,7 @@ void CreateCacheFilePath() {
 		if (size < 0 || stream.status() != QDataStream::Ok) {
 			return {};
 		}
-		auto &list = result.emoji[key];
+		auto &list = result[key];
 		for (auto j = 0; j != size; ++j) {
 			auto text = QString();
 			stream >> text;
@@ -132,14 +208,12 @@ void CreateCacheFilePath() {
 			}
 			list.push_back(entry);
 		}
-		result.maxKeyLength = std::max(result.maxKeyLength, int(key.size()));
 	}
-	result.version = version;
-	return result;
+	return Compile(version, std::move(result));
 }
 
 void WriteLocalCache(const QString &id, const LangPackData &data) {
-	if (!data.version && data.emoji.empty()) {
+	if (!data.version && data.entries.empty()) {
 		return;
 	}
 	CreateCacheFilePath();
@@ -151,8 +225,8 @@ void WriteLocalCache(const QString &id, const LangPackData &data) {
 	stream.setVersion(QDataStream::Qt_5_1);
 	stream
 		<< qint32(data.version)
-		<< qint32(data.emoji.size());
-	for (const auto &[key, list] : data.emoji) {
+		<< qint32(data.entries.size());
+	for (const auto &[key, list] : data.entries) {
 		stream
 			<< key
 			<< qint32(list.size());
@@ -172,30 +246,19 @@ void WriteLocalCache(const QString &id, const LangPackData &data) {
 
 void AppendFoundEmoji(
 		std::vector<Result> &result,
+		base::flat_set<EmojiPtr> &added,
 		const QString &label,
 		const std::vector<LangPackEmoji> &list) {
-	// It is important that the 'result' won't relocate while inserting.
-	result.reserve(result.size() + list.size());
-	const auto alreadyBegin = begin(result);
-	const auto alreadyEnd = alreadyBegin + result.size();
-
-	auto &&add = ranges::views::all(
-		list
-	) | ranges::views::filter([&](const LangPackEmoji &entry) {
-		const auto i = ranges::find(
-			alreadyBegin,
-			alreadyEnd,
-			entry.emoji,
-			&Result::emoji);
-		return (i == alreadyEnd);
-	}) | ranges::views::transform([&](const LangPackEmoji &entry) {
-		return Result{ entry.emoji, label, entry.text };
-	});
-	result.insert(end(result), add.begin(), add.end());
+	for (const auto &entry : list) {
+		if (added.emplace(entry.emoji).second) {
+			result.push_back({ entry.emoji, label, entry.text });
+		}
+	}
 }
 
 void AppendLegacySuggestions(
 		std::vector<Result> &result,
+		base::flat_set<EmojiPtr> &added,
 		const QString &query) {
 	const auto badSuggestionChar = [](QChar ch) {
 		return (ch < 'a' || ch > 'z')
@@ -210,46 +273,30 @@ void AppendLegacySuggestions(
 	}
 
 	const auto suggestions = GetSuggestions(QStringToUTF16(query));
-
-	// It is important that the 'result' won't relocate while inserting.
-	result.reserve(result.size() + suggestions.size());
-	const auto alreadyBegin = begin(result);
-	const auto alreadyEnd = alreadyBegin + result.size();
-
-	auto &&add = ranges::views::all(
-		suggestions
-	) | ranges::views::transform([](const Suggestion &suggestion) {
-		return Result{
-			Find(QStringFromUTF16(suggestion.emoji())),
-			QStringFromUTF16(suggestion.label()),
-			QStringFromUTF16(suggestion.replacement())
-		};
-	}) | ranges::views::filter([&](const Result &entry) {
-		const auto i = entry.emoji
-			? ranges::find(
-				alreadyBegin,
-				alreadyEnd,
-				entry.emoji,
-				&Result::emoji)
-			: alreadyEnd;
-		return (entry.emoji != nullptr)
-			&& (i == alreadyEnd);
-	});
-	result.insert(end(result), add.begin(), add.end());
+	for (const auto &suggestion : suggestions) {
+		const auto emoji = Find(QStringFromUTF16(suggestion.emoji()));
+		if (emoji && added.emplace(emoji).second) {
+			result.push_back({
+				emoji,
+				QStringFromUTF16(suggestion.label()),
+				QStringFromUTF16(suggestion.replacement())
+			});
+		}
+	}
 }
 
 void ApplyDifference(
 		LangPackData &data,
 		const QVector<MTPEmojiKeyword> &keywords,
 		int version) {
-	data.version = version;
+	auto map = Decompile(std::move(data));
 	for (const auto &keyword : keywords) {
 		keyword.match([&](const MTPDemojiKeyword &keyword) {
 			const auto word = NormalizeKey(qs(keyword.vkeyword()));
 			if (word.isEmpty()) {
 				return;
 			}
-			auto &list = data.emoji[word];
+			auto &list = map[word];
 			auto &&emoji = ranges::views::all(
 				keyword.vemoticons().v
 			) | ranges::views::transform([](const MTPstring &string) {
@@ -273,8 +320,8 @@ void ApplyDifference(
 			if (word.isEmpty()) {
 				return;
 			}
-			const auto i = data.emoji.find(word);
-			if (i == end(data.emoji)) {
+			const auto i = map.find(word);
+			if (i == end(map)) {
 				return;
 			}
 			auto &list = i->second;
@@ -284,20 +331,11 @@ void ApplyDifference(
 					end(list));
 			}
 			if (list.empty()) {
-				data.emoji.erase(i);
+				map.erase(i);
 			}
 		});
 	}
-	if (data.emoji.empty()) {
-		data.maxKeyLength = 0;
-	} else {
-		auto &&lengths = ranges::views::all(
-			data.emoji
-		) | ranges::views::transform([](auto &&pair) {
-			return pair.first.size();
-		});
-		data.maxKeyLength = *ranges::max_element(lengths);
-	}
+	data = Compile(version, std::move(map));
 }
 
 } // namespace
@@ -316,7 +354,9 @@ public:
 	void refresh();
 	void apiChanged();
 
-	[[nodiscard]] std::vector<Result> query(
+	void appendResults(
+		std::vector<Result> &result,
+		base::flat_set<EmojiPtr> &added,
 		const QString &normalized,
 		bool exact) const;
 	[[nodiscard]] int maxQueryLength() const;
@@ -403,7 +443,7 @@ void EmojiKeywords::LangPack::refresh() {
 		}).fail([=] {
 			_requestId = 0;
 			_lastRefreshTime = crl::now();
-		}).send();
+		}).inBackground().send();
 	};
 	_requestId = (_data.version > 0)
 		? send(MTPmessages_GetEmojiKeywordsDifference(
@@ -467,29 +507,40 @@ void EmojiKeywords::LangPack::apiChanged() {
 	refresh();
 }
 
-std::vector<Result> EmojiKeywords::LangPack::query(
+void EmojiKeywords::LangPack::appendResults(
+		std::vector<Result> &result,
+		base::flat_set<EmojiPtr> &added,
 		const QString &normalized,
 		bool exact) const {
 	if (normalized.size() > _data.maxKeyLength
-		|| _data.emoji.empty()
+		|| _data.nodes.empty()
 		|| (exact && SkipExactKeyword(_id, normalized))) {
-		return {};
+		return;
 	}
-
-	const auto from = _data.emoji.lower_bound(normalized);
-	auto &&chosen = ranges::make_subrange(
-		from,
-		end(_data.emoji)
-	) | ranges::views::take_while([&](const auto &pair) {
-		const auto &key = pair.first;
-		return exact ? (key == normalized) : key.startsWith(normalized);
-	});
-
-	auto result = std::vector<Result>();
-	for (const auto &[key, list] : chosen) {
-		AppendFoundEmoji(result, key, list);
+	const auto &nodes = _data.nodes;
+	auto node = &nodes.front();
+	for (const auto ch : normalized) {
+		const auto from = begin(nodes) + node->childrenFrom;
+		const auto till = from + node->childrenCount;
+		const auto i = std::lower_bound(from, till, ch, [](
+				const LangPackNode &node,
+				QChar ch) {
+			return (node.ch < ch);
+		});
+		if (i == till || i->ch != ch) {
+			return;
+		}
+		node = &*i;
+	}
+	const auto &entries = _data.entries;
+	const auto till = exact
+		? ((entries[node->keysFrom].key.size() == normalized.size())
+			? (node->keysFrom + 1)
+			: node->keysFrom)
+		: node->keysTill;
+	for (auto i = node->keysFrom; i != till; ++i) {
+		AppendFoundEmoji(result, added, entries[i].key, entries[i].list);
 	}
-	return result;
 }
 
 int EmojiKeywords::LangPack::maxQueryLength() const {
@@ -610,30 +661,12 @@ std::vector<Result> EmojiKeywords::query(
 		return {};
 	}
 	auto result = std::vector<Result>();
+	auto added = base::flat_set<EmojiPtr>();
 	for (const auto &[language, item] : _data) {
-		const auto list = item->query(normalized, exact);
-
-		// It is important that the 'result' won't relocate while inserting.
-		result.reserve(result.size() + list.size());
-		const auto alreadyBegin = begin(result);
-		const auto alreadyEnd = alreadyBegin + result.size();
-
-		auto &&add = ranges::views::all(
-			list
-		) | ranges::views::filter([&](Result entry) {
-			// In each item->query() result the list has no duplicates.
-			// So we need to check only for duplicates between queries.
-			const auto i = ranges::find(
-				alreadyBegin,
-				alreadyEnd,
-				entry.emoji,
-				&Result::emoji);
-			return (i == alreadyEnd);
-		});
-		result.insert(end(result), add.begin(), add.end());
+		item->appendResults(result, added, normalized, exact);
 	}
 	if (!exact) {
-		AppendLegacySuggestions(result, query);
+		AppendLegacySuggestions(result, added, query);
 	}
 	return result;
 }
@@ -15,6 +15,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_peer_values.h"
 #include "data/data_file_origin.h"
 #include "data/data_session.h"
+#include "data/data_history_tags_index.h"
 #include "data/stickers/data_stickers.h"
 #include "chat_helpers/send_context_menu.h" // SendMenu::FillSendMenu
 #include "chat_helpers/stickers_lottie.h"
@@ -23,6 +24,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "apiwrap.h"
 #include "api/api_chat_participants.h"
 #include "main/main_session.h"
+#include "history/history.h"
 #include "storage/storage_account.h"
 #include "core/application.h"
 #include "core/core_settings.h"
@@ -47,6 +49,16 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <QtWidgets/QApplication>
 
+namespace {
+
+// Online statuses change slowly, resort the participants from time to time.
+constexpr auto kResortParticipantsTimeout = 60 * crl::time(1000);
+
+// Hashtags used in the chat are suggested after the recently written ones.
+constexpr auto kMaxChatHashtags = 20;
+
+} // namespace
+
 class FieldAutocomplete::Inner final : public Ui::RpWidget {
 public:
 	struct ScrollTo {
@@ -103,7 +115,6 @@ private:
 	QSize stickerBoundingBox() const;
 	void setupLottie(StickerSuggestion &suggestion);
 	void repaintSticker(not_null<DocumentData*> document);
-	std::shared_ptr<Lottie::FrameRenderer> getLottieRenderer();
 
 	const not_null<Window::SessionController*> _controller;
 	const not_null<FieldAutocomplete*> _parent;
@@ -112,7 +123,6 @@ private:
 	const not_null<BotCommandRows*> _brows;
 	const not_null<StickerRows*> _srows;
 	rpl::lifetime _stickersLifetime;
-	std::weak_ptr<Lottie::FrameRenderer> _lottieRenderer;
 	base::unique_qptr<Ui::PopupMenu> _menu;
 	int _stickersPerRow = 1;
 	int _recentInlineBotsInRows = 0;
@@ -245,6 +255,7 @@ void FieldAutocomplete::showFiltered(
 	_chat = peer->asChat();
 	_user = peer->asUser();
 	_channel = peer->asChannel();
+	_history = peer->owner().historyLoaded(peer);
 	if (query.isEmpty()) {
 		_type = Type::Mentions;
 		rowsUpdated(
@@ -302,6 +313,7 @@ void FieldAutocomplete::showStickers(EmojiPtr emoji) {
 	_chat = nullptr;
 	_user = nullptr;
 	_channel = nullptr;
+	_history = nullptr;
 
 	updateFiltered(resetScroll);
 }
@@ -314,16 +326,33 @@ bool FieldAutocomplete::clearFilteredBotCommands() {
 	return true;
 }
 
-namespace {
-template <typename T, typename U>
-inline int indexOfInFirstN(const T &v, const U &elem, int last) {
-	for (auto b = v.cbegin(), i = b, e = b + std::max(int(v.size()), last); i != e; ++i) {
-		if (i->user == elem) {
-			return (i - b);
+auto FieldAutocomplete::sortedChatParticipants()
+-> const std::vector<not_null<UserData*>> & {
+	Expects(_chat != nullptr);
+
+	auto &cache = _sortedParticipants;
+	const auto now = crl::now();
+	if (cache.chat != _chat
+		|| cache.version != _chat->version()
+		|| cache.count != int(_chat->participants.size())
+		|| now - cache.sortedAt >= kResortParticipantsTimeout) {
+		const auto unixtime = base::unixtime::now();
+		auto sorted = base::flat_multi_map<TimeId, not_null<UserData*>>();
+		for (const auto &user : _chat->participants) {
+			sorted.emplace(Data::SortByOnlineValue(user, unixtime), user);
+		}
+		cache.chat = _chat;
+		cache.version = _chat->version();
+		cache.count = int(_chat->participants.size());
+		cache.sortedAt = now;
+		cache.list.clear();
+		cache.list.reserve(sorted.size());
+		for (auto i = sorted.cend(), b = sorted.cbegin(); i != b;) {
+			--i;
+			cache.list.push_back(i->second);
 		}
 	}
-	return -1;
-}
+	return cache.list;
 }
 
 FieldAutocomplete::StickerRows FieldAutocomplete::getStickerSuggestions() {
@@ -355,7 +384,7 @@ FieldAutocomplete::StickerRows FieldAutocomplete::getStickerSuggestions() {
 }
 
 void FieldAutocomplete::updateFiltered(bool resetScroll) {
-	int32 now = base::unixtime::now(), recentInlineBots = 0;
+	auto recentInlineBots = 0;
 	MentionRows mrows;
 	HashtagRows hrows;
 	BotCommandRows brows;
@@ -374,6 +403,7 @@ void FieldAutocomplete::updateFiltered(bool resetScroll) {
 		if (maxListSize) {
 			mrows.reserve(maxListSize);
 		}
+		auto added = base::flat_set<not_null<UserData*>>();
 
 		auto filterNotPassedByUsername = [this](UserData *user) -> bool {
 			if (user->username.startsWith(_filter, Qt::CaseInsensitive)) {
@@ -401,35 +431,29 @@ void FieldAutocomplete::updateFiltered(bool resetScroll) {
 					continue;
 				}
 				mrows.push_back({ user });
+				added.emplace(user);
 				++recentInlineBots;
 			}
 		}
 		if (_chat) {
-			auto sorted = base::flat_multi_map<TimeId, not_null<UserData*>>();
-			const auto byOnline = [&](not_null<UserData*> user) {
-				return Data::SortByOnlineValue(user, now);
-			};
 			mrows.reserve(mrows.size() + (_chat->participants.empty() ? _chat->lastAuthors.size() : _chat->participants.size()));
 			if (_chat->noParticipantInfo()) {
 				_chat->session().api().requestFullPeer(_chat);
-			} else if (!_chat->participants.empty()) {
-				for (const auto &user : _chat->participants) {
-					if (user->isInaccessible()) continue;
-					if (!listAllSuggestions && filterNotPassedByName(user)) continue;
-					if (indexOfInFirstN(mrows, user, recentInlineBots) >= 0) continue;
-					sorted.emplace(byOnline(user), user);
-				}
 			}
 			for (const auto user : _chat->lastAuthors) {
 				if (user->isInaccessible()) continue;
 				if (!listAllSuggestions && filterNotPassedByName(user)) continue;
-				if (indexOfInFirstN(mrows, user, recentInlineBots) >= 0) continue;
+				if (!added.emplace(user).second) continue;
 				mrows.push_back({ user });
-				sorted.remove(byOnline(user), user);
 			}
-			for (auto i = sorted.cend(), b = sorted.cbegin(); i != b;) {
-				--i;
-				mrows.push_back({ i->second });
+			if (!_chat->noParticipantInfo() && !_chat->participants.empty()) {
+				// Sorted by online only when the participants change.
+				for (const auto &user : sortedChatParticipants()) {
+					if (user->isInaccessible()) continue;
+					if (!listAllSuggestions && filterNotPassedByName(user)) continue;
+					if (!added.emplace(user).second) continue;
+					mrows.push_back({ user });
+				}
 			}
 		} else if (_channel && _channel->isMegagroup()) {
 			if (_channel->lastParticipantsRequestNeeded()) {
@@ -440,7 +464,7 @@ void FieldAutocomplete::updateFiltered(bool resetScroll) {
 				for (const auto user : _channel->mgInfo->lastParticipants) {
 					if (user->isInaccessible()) continue;
 					if (!listAllSuggestions && filterNotPassedByName(user)) continue;
-					if (indexOfInFirstN(mrows, user, recentInlineBots) >= 0) continue;
+					if (!added.emplace(user).second) continue;
 					mrows.push_back({ user });
 				}
 			}
@@ -460,6 +484,19 @@ void FieldAutocomplete::updateFiltered(bool resetScroll) {
 			}
 			hrows.push_back(tag);
 		}
+		if (_history) {
+			const auto chat = _history->tagsIndex().hashtags(
+				_filter,
+				kMaxChatHashtags);
+			for (const auto &tag : chat) {
+				const auto exists = ranges::any_of(hrows, [&](const QString &row) {
+					return !row.compare(tag, Qt::CaseInsensitive);
+				});
+				if (!exists && tag.size() != _filter.size()) {
+					hrows.push_back(tag);
+				}
+			}
+		}
 	} else if (_type == Type::BotCommands) {
 		bool listAllSuggestions = _filter.isEmpty();
 		bool hasUsername = _filter.indexOf('@') > 0;
@@ -1279,16 +1316,6 @@ void FieldAutocomplete::Inner::rowsUpdated() {
 	}
 }
 
-auto FieldAutocomplete::Inner::getLottieRenderer()
--> std::shared_ptr<Lottie::FrameRenderer> {
-	if (auto result = _lottieRenderer.lock()) {
-		return result;
-	}
-	auto result = Lottie::MakeFrameRenderer();
-	_lottieRenderer = result;
-	return result;
-}
-
 void FieldAutocomplete::Inner::setupLottie(StickerSuggestion &suggestion) {
 	const auto document = suggestion.document;
 	suggestion.animated = ChatHelpers::LottiePlayerFromDocument(
@@ -1296,7 +1323,7 @@ void FieldAutocomplete::Inner::setupLottie(StickerSuggestion &suggestion) {
 		ChatHelpers::StickerLottieSize::InlineResults,
 		stickerBoundingBox() * cIntRetinaFactor(),
 		Lottie::Quality::Default,
-		getLottieRenderer());
+		ChatHelpers::LottieRendererFromPool());
 
 	suggestion.animated->updates(
 	) | rpl::start_with_next([=] {
@@ -13,6 +13,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/timer.h"
 #include "base/object_ptr.h"
 
+class History;
+
 namespace Ui {
 class PopupMenu;
 class ScrollArea;
@@ -160,9 +162,19 @@ private:
 	void animationCallback();
 	void hideFinish();
 
+	struct SortedParticipants {
+		ChatData *chat = nullptr;
+		int version = 0;
+		int count = 0;
+		crl::time sortedAt = 0;
+		std::vector<not_null<UserData*>> list;
+	};
+
 	void updateFiltered(bool resetScroll = false);
 	void recount(bool resetScroll = false);
 	StickerRows getStickerSuggestions();
+	[[nodiscard]] auto sortedChatParticipants()
+		-> const std::vector<not_null<UserData*>> &;
 
 	const not_null<Window::SessionController*> _controller;
 	QPixmap _cache;
@@ -182,8 +194,10 @@ private:
 	QPointer<Inner> _inner;
 
 	ChatData *_chat = nullptr;
+	SortedParticipants _sortedParticipants;
 	UserData *_user = nullptr;
 	ChannelData *_channel = nullptr;
+	History *_history = nullptr;
 	EmojiPtr _emoji;
 	uint64 _stickersSeed = 0;
 	Type _type = Type::Mentions;
@@ -537,6 +537,8 @@ void MessageLinksParser::parse() {
 	const auto &markdownTags = _field->getMarkdownTags();
 	if (text.isEmpty()) {
 		_list = QStringList();
+		_parsedText = QString();
+		_parsedRanges.clear();
 		return;
 	}
 	const auto tagCanIntersectWithLink = [](const QString &tag) {
@@ -598,11 +600,23 @@ void MessageLinksParser::parse() {
 				+ markdownTag->adjustedLength < from + length);
 	};
 
-	const auto len = text.size();
+	// Links never span several lines, so only the edited paragraphs
+	// are searched again and the rest of the found links are reused.
+	const auto [from, till, wasTill] = changedParagraphs(text);
+	auto found = QVector<LinkRange>();
+	found.reserve(_parsedRanges.size());
+	for (const auto &range : _parsedRanges) {
+		if (range.start >= from) {
+			break;
+		}
+		found.push_back(range);
+	}
+
+	const auto len = till;
 	const QChar *start = text.unicode(), *end = start + text.size();
-	for (auto offset = 0, matchOffset = offset; offset < len;) {
+	for (auto offset = from, matchOffset = offset; offset < len;) {
 		auto m = qthelp::RegExpDomain().match(text, matchOffset);
-		if (!m.hasMatch()) break;
+		if (!m.hasMatch() || m.capturedStart() >= till) break;
 
 		auto domainOffset = m.capturedStart();
 
@@ -663,19 +677,57 @@ void MessageLinksParser::parse() {
 			static_cast<int>(p - start - domainOffset),
 			QString()
 		};
-		processTagsBefore(domainOffset);
+		found.push_back(range);
+		offset = matchOffset = p - start;
+	}
+	const auto delta = text.size() - _parsedText.size();
+	for (const auto &range : _parsedRanges) {
+		if (range.start >= wasTill) {
+			found.push_back({ int(range.start + delta), range.length });
+		}
+	}
+	_parsedText = text;
+	_parsedRanges = std::move(found);
+
+	for (const auto &range : _parsedRanges) {
+		processTagsBefore(range.start);
 		if (!hasTagsIntersection(range.start + range.length)) {
 			if (markdownTagsAllow(range.start, range.length)) {
 				ranges.push_back(range);
 			}
 		}
-		offset = matchOffset = p - start;
 	}
 	processTagsBefore(QFIXED_MAX);
 
 	apply(text, ranges);
 }
 
+auto MessageLinksParser::changedParagraphs(const QString &text) const
+-> ChangedRange {
+	const auto &was = _parsedText;
+	const auto wasLength = int(was.size());
+	const auto nowLength = int(text.size());
+	const auto common = std::min(wasLength, nowLength);
+	auto prefix = 0;
+	while (prefix < common && was[prefix] == text[prefix]) {
+		++prefix;
+	}
+	if (prefix == wasLength && prefix == nowLength) {
+		return { nowLength, nowLength, wasLength };
+	}
+	auto suffix = 0;
+	while (suffix < common - prefix
+		&& was[wasLength - suffix - 1] == text[nowLength - suffix - 1]) {
+		++suffix;
+	}
+	const auto from = prefix
+		? int(text.lastIndexOf(QChar('\n'), prefix - 1) + 1)
+		: 0;
+	const auto newline = int(text.indexOf(QChar('\n'), nowLength - suffix));
+	const auto till = (newline >= 0) ? newline : nowLength;
+	return { from, till, till - (nowLength - wasLength) };
+}
+
 void MessageLinksParser::apply(
 		const QString &text,
 		const QVector<LinkRange> &ranges) {
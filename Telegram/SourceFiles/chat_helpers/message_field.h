@@ -93,11 +93,20 @@ private:
 		return !(a == b);
 	}
 
+	struct ChangedRange {
+		int from = 0;
+		int till = 0;
+		int wasTill = 0;
+	};
+
 	void parse();
+	[[nodiscard]] ChangedRange changedParagraphs(const QString &text) const;
 	void apply(const QString &text, const QVector<LinkRange> &ranges);
 
 	not_null<Ui::InputField*> _field;
 	rpl::variable<QStringList> _list;
+	QString _parsedText;
+	QVector<LinkRange> _parsedRanges;
 	int _lastLength = 0;
 	base::Timer _timer;
 	base::qt_connection _connection;
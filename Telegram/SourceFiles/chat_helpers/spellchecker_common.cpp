@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #ifndef TDESKTOP_DISABLE_SPELLCHECK
 
+#include "base/call_delayed.h"
 #include "base/platform/base_platform_info.h"
 #include "base/zlib_help.h"
 #include "data/data_session.h"
@@ -45,6 +46,9 @@ constexpr auto kLangsForLWC = { 31, 91 };
 // 225 - QLocale::UnitesStates, 30 - QLocale::Brazil.
 constexpr auto kDefaultCountries = { 225, 30 };
 
+// Loading dictionaries is heavy, don't do it while the app is starting.
+constexpr auto kUpdateLanguagesDelay = crl::time(3000);
+
 // Language With Country.
 inline auto LWC(QLocale::Country country) {
 	const auto l = QLocale::matchingLocales(
@@ -389,7 +393,9 @@ void Start(not_null<Main::Session*> session) {
 	};
 
 	const auto guard = gsl::finally([=] {
-		onEnabled(settings->spellcheckerEnabled());
+		base::call_delayed(kUpdateLanguagesDelay, session, [=] {
+			onEnabled(settings->spellcheckerEnabled());
+		});
 	});
 
 	if (Platform::Spellchecker::IsSystemSpellchecker()) {
@@ -10,15 +10,23 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "main/main_session.h"
 #include "data/data_session.h"
 #include "data/data_document.h"
+#include "data/data_document_media.h"
 #include "ui/image/image_location_factory.h"
 #include "storage/localimageloader.h"
 #include "base/unixtime.h"
+#include "base/call_delayed.h"
 #include "apiwrap.h"
 
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
 
 namespace Stickers {
+namespace {
+
+// Let the chats list and the first history load first.
+constexpr auto kPreloadDelay = 15 * crl::time(1000);
+
+} // namespace
 
 const QString DicePacks::kDiceString = QString::fromUtf8("\xF0\x9F\x8E\xB2");
 const QString DicePacks::kDartString = QString::fromUtf8("\xF0\x9F\x8E\xAF");
@@ -42,6 +50,25 @@ DocumentData *DicePack::lookup(int value) {
 	return (i != end(_map)) ? i->second.get() : nullptr;
 }
 
+void DicePack::preload() {
+	_preload = true;
+	if (_setApplied) {
+		preloadDocuments();
+	} else if (!_requestId) {
+		load();
+	}
+}
+
+void DicePack::preloadDocuments() {
+	// Only download the animations to the cache, the frames cache for the
+	// message size is generated by the player when the dice is first shown.
+	for (const auto &[index, document] : _map) {
+		document->createMediaView()->automaticLoad(
+			document->stickerSetOrigin(),
+			nullptr);
+	}
+}
+
 void DicePack::load() {
 	if (_requestId) {
 		return;
@@ -52,6 +79,10 @@ void DicePack::load() {
 	)).done([=](const MTPmessages_StickerSet &result) {
 		result.match([&](const MTPDmessages_stickerSet &data) {
 			applySet(data);
+			_setApplied = true;
+			if (_preload) {
+				preloadDocuments();
+			}
 		}, [](const MTPDmessages_stickerSetNotModified &) {
 			LOG(("API Error: Unexpected messages.stickerSetNotModified."));
 		});
@@ -145,20 +176,39 @@ void DicePack::generateLocal(int index, const QString &name) {
 }
 
 DicePacks::DicePacks(not_null<Main::Session*> session) : _session(session) {
+	base::call_delayed(kPreloadDelay, session, [=] {
+		preload();
+	});
 }
 
 DocumentData *DicePacks::lookup(const QString &emoji, int value) {
 	const auto key = emoji.endsWith(QChar(0xFE0F))
 		? emoji.mid(0, emoji.size() - 1)
 		: emoji;
-	const auto i = _packs.find(key);
+	return pack(key)->lookup(value);
+}
+
+not_null<DicePack*> DicePacks::pack(const QString &emoji) {
+	const auto i = _packs.find(emoji);
 	if (i != end(_packs)) {
-		return i->second->lookup(value);
+		return i->second.get();
 	}
 	return _packs.emplace(
-		key,
-		std::make_unique<DicePack>(_session, key)
-	).first->second->lookup(value);
+		emoji,
+		std::make_unique<DicePack>(_session, emoji)
+	).first->second.get();
+}
+
+void DicePacks::preload() {
+	for (const auto &emoji : {
+		kDiceString,
+		kDartString,
+		kSlotString,
+		kFballString,
+		kBballString,
+	}) {
+		pack(emoji)->preload();
+	}
 }
 
 } // namespace Stickers
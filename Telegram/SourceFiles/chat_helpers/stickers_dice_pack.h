@@ -21,10 +21,12 @@ public:
 	~DicePack();
 
 	[[nodiscard]] DocumentData *lookup(int value);
+	void preload();
 
 private:
 	void load();
 	void applySet(const MTPDmessages_stickerSet &data);
+	void preloadDocuments();
 	void tryGenerateLocalZero();
 	void generateLocal(int index, const QString &name);
 
@@ -32,6 +34,8 @@ private:
 	QString _emoji;
 	base::flat_map<int, not_null<DocumentData*>> _map;
 	mtpRequestId _requestId = 0;
+	bool _setApplied = false;
+	bool _preload = false;
 
 };
 
@@ -52,6 +56,9 @@ public:
 	[[nodiscard]] DocumentData *lookup(const QString &emoji, int value);
 
 private:
+	[[nodiscard]] not_null<DicePack*> pack(const QString &emoji);
+	void preload();
+
 	const not_null<Main::Session*> _session;
 
 	base::flat_map<QString, std::unique_ptr<DicePack>> _packs;
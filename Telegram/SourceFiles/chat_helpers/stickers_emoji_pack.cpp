@@ -17,6 +17,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_file_origin.h"
 #include "data/data_session.h"
 #include "data/data_document.h"
+#include "data/data_document_media.h"
 #include "core/core_settings.h"
 #include "core/application.h"
 #include "base/call_delayed.h"
@@ -29,6 +30,9 @@ namespace Stickers {
 namespace {
 
 constexpr auto kRefreshTimeout = 7200 * crl::time(1000);
+constexpr auto kFirstRefreshDelay = 3 * crl::time(1000);
+constexpr auto kPreloadDelay = 15 * crl::time(1000);
+constexpr auto kPreloadRecentCount = 12;
 
 [[nodiscard]] std::optional<int> IndexFromEmoticon(const QString &emoticon) {
 	if (emoticon.size() < 2) {
@@ -92,7 +96,13 @@ QSize LargeEmojiImage::Size() {
 
 EmojiPack::EmojiPack(not_null<Main::Session*> session)
 : _session(session) {
-	refresh();
+	// Large emoji are not shown in the chats list, so the set request
+	// waits until the startup is finished, unless a message needs it.
+	base::call_delayed(kFirstRefreshDelay, _session, [=] {
+		if (!_refreshRequested) {
+			refresh();
+		}
+	});
 
 	session->data().itemRemoved(
 	) | rpl::filter([](not_null<const HistoryItem*> item) {
@@ -146,6 +156,10 @@ void EmojiPack::remove(not_null<const HistoryItem*> item) {
 auto EmojiPack::stickerForEmoji(const IsolatedEmoji &emoji) -> Sticker {
 	Expects(!emoji.empty());
 
+	if (!_refreshRequested) {
+		refresh();
+	}
+
 	if (emoji.items[1] != nullptr) {
 		return Sticker();
 	}
@@ -211,6 +225,7 @@ void EmojiPack::refresh() {
 	if (_requestId) {
 		return;
 	}
+	_refreshRequested = true;
 	_requestId = _session->api().request(MTPmessages_GetStickerSet(
 		MTP_inputStickerSetAnimatedEmoji(),
 		MTP_int(0) // hash
@@ -273,6 +288,34 @@ void EmojiPack::applySet(const MTPDmessages_stickerSet &data) {
 	for (const auto &[emoji, document] : was) {
 		refreshItems(emoji);
 	}
+
+	base::call_delayed(kPreloadDelay, _session, [=] {
+		preloadRecent();
+	});
+}
+
+void EmojiPack::preloadRecent() {
+	if (!Core::App().settings().largeEmoji()) {
+		return;
+	}
+	// Download the large animated emoji that are most likely to be sent.
+	auto left = kPreloadRecentCount;
+	for (const auto &recent : Core::App().settings().recentEmoji()) {
+		const auto emoji = recent.emoji->original()
+			? recent.emoji->original()
+			: recent.emoji;
+		const auto i = _map.find(emoji);
+		if (i == end(_map)) {
+			continue;
+		}
+		const auto document = i->second;
+		document->createMediaView()->automaticLoad(
+			document->stickerSetOrigin(),
+			nullptr);
+		if (!--left) {
+			break;
+		}
+	}
 }
 
 void EmojiPack::applyAnimationsSet(const MTPDmessages_stickerSet &data) {
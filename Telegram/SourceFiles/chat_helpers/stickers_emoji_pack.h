@@ -89,6 +89,7 @@ private:
 	void refreshAll();
 	void refreshItems(EmojiPtr emoji);
 	void refreshItems(const base::flat_set<not_null<HistoryItem*>> &list);
+	void preloadRecent();
 
 	not_null<Main::Session*> _session;
 	base::flat_map<EmojiPtr, not_null<DocumentData*>> _map;
@@ -97,6 +98,7 @@ private:
 		base::flat_set<not_null<HistoryItem*>>> _items;
 	base::flat_map<EmojiPtr, std::weak_ptr<LargeEmojiImage>> _images;
 	mtpRequestId _requestId = 0;
+	bool _refreshRequested = false;
 
 	base::flat_map<
 		EmojiPtr,
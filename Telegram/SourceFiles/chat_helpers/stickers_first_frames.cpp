@@ -0,0 +1,187 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "chat_helpers/stickers_first_frames.h"
+
+#include "data/data_session.h"
+#include "main/main_session.h"
+#include "storage/cache/storage_cache_database.h"
+
+#include <QtCore/QBuffer>
+
+namespace ChatHelpers {
+namespace {
+
+constexpr auto kVersion = quint32(1);
+constexpr auto kColumns = 8;
+
+struct Atlas {
+	uint64 hash = 0;
+	QSize tile;
+	std::vector<DocumentId> ids;
+	std::vector<QSize> sizes;
+	QImage image;
+};
+
+[[nodiscard]] QPoint TilePosition(QSize tile, int index) {
+	return QPoint(
+		(index % kColumns) * tile.width(),
+		(index / kColumns) * tile.height());
+}
+
+[[nodiscard]] QByteArray Serialize(
+		uint64 hash,
+		QSize tile,
+		const std::vector<StickerFirstFrame> &frames) {
+	const auto count = int(frames.size());
+	const auto rows = (count + kColumns - 1) / kColumns;
+	auto atlas = QImage(
+		tile.width() * std::min(count, kColumns),
+		tile.height() * rows,
+		QImage::Format_ARGB32_Premultiplied);
+	atlas.fill(Qt::transparent);
+	{
+		auto p = QPainter(&atlas);
+		p.setCompositionMode(QPainter::CompositionMode_Source);
+		for (auto i = 0; i != count; ++i) {
+			p.drawImage(TilePosition(tile, i), frames[i].frame);
+		}
+	}
+	auto image = QByteArray();
+	{
+		auto buffer = QBuffer(&image);
+		atlas.save(&buffer, "PNG");
+	}
+	auto result = QByteArray();
+	{
+		auto stream = QDataStream(&result, QIODevice::WriteOnly);
+		stream.setVersion(QDataStream::Qt_5_1);
+		stream
+			<< kVersion
+			<< quint64(hash)
+			<< qint32(tile.width())
+			<< qint32(tile.height())
+			<< qint32(count);
+		for (const auto &[id, frame] : frames) {
+			stream
+				<< quint64(id)
+				<< qint32(frame.width())
+				<< qint32(frame.height());
+		}
+		stream << image;
+	}
+	return result;
+}
+
+[[nodiscard]] Atlas Deserialize(const QByteArray &data) {
+	if (data.isEmpty()) {
+		return {};
+	}
+	auto stream = QDataStream(data);
+	stream.setVersion(QDataStream::Qt_5_1);
+	auto version = quint32();
+	auto hash = quint64();
+	auto width = qint32();
+	auto height = qint32();
+	auto count = qint32();
+	stream >> version >> hash >> width >> height >> count;
+	if (stream.status() != QDataStream::Ok
+		|| version != kVersion
+		|| width <= 0
+		|| height <= 0
+		|| count <= 0
+		|| count > kStickerSetFirstFramesLimit) {
+		return {};
+	}
+	auto result = Atlas{ .hash = hash, .tile = QSize(width, height) };
+	result.ids.reserve(count);
+	result.sizes.reserve(count);
+	for (auto i = 0; i != count; ++i) {
+		auto id = quint64();
+		auto frameWidth = qint32();
+		auto frameHeight = qint32();
+		stream >> id >> frameWidth >> frameHeight;
+		if (frameWidth <= 0
+			|| frameHeight <= 0
+			|| frameWidth > width
+			|| frameHeight > height) {
+			return {};
+		}
+		result.ids.push_back(id);
+		result.sizes.emplace_back(frameWidth, frameHeight);
+	}
+	auto image = QByteArray();
+	stream >> image;
+	if (stream.status() != QDataStream::Ok) {
+		return {};
+	}
+	result.image.loadFromData(image, "PNG");
+	const auto rows = (count + kColumns - 1) / kColumns;
+	if (result.image.width() < width * std::min(int(count), kColumns)
+		|| result.image.height() < height * rows) {
+		return {};
+	}
+	return result;
+}
+
+} // namespace
+
+void LoadStickerSetFirstFrames(
+		not_null<Main::Session*> session,
+		uint64 setId,
+		uint64 hash,
+		QSize tile,
+		Fn<void(std::vector<StickerFirstFrame>)> done) {
+	const auto weak = base::make_weak(session.get());
+	session->data().cache().get(
+		Data::StickerSetFramesCacheKey(setId),
+		[=](QByteArray value) {
+			const auto atlas = Deserialize(value);
+			auto frames = std::vector<StickerFirstFrame>();
+			if (atlas.hash == hash && atlas.tile == tile) {
+				const auto count = int(atlas.ids.size());
+				frames.reserve(count);
+				for (auto i = 0; i != count; ++i) {
+					frames.push_back({
+						.id = atlas.ids[i],
+						.frame = atlas.image.copy(QRect(
+							TilePosition(tile, i),
+							atlas.sizes[i])),
+					});
+				}
+			}
+			crl::on_main(weak, [=, frames = std::move(frames)]() mutable {
+				done(std::move(frames));
+			});
+		});
+}
+
+void SaveStickerSetFirstFrames(
+		not_null<Main::Session*> session,
+		uint64 setId,
+		uint64 hash,
+		QSize tile,
+		std::vector<StickerFirstFrame> frames) {
+	if (frames.empty()) {
+		return;
+	} else if (int(frames.size()) > kStickerSetFirstFramesLimit) {
+		frames.resize(kStickerSetFirstFramesLimit);
+	}
+	const auto weak = base::make_weak(session.get());
+	crl::async([=, frames = std::move(frames)] {
+		auto serialized = Serialize(hash, tile, frames);
+		crl::on_main(weak, [=, data = std::move(serialized)]() mutable {
+			weak->data().cache().put(
+				Data::StickerSetFramesCacheKey(setId),
+				Storage::Cache::Database::TaggedValue(
+					std::move(data),
+					Data::kImageCacheTag));
+		});
+	});
+}
+
+} // namespace ChatHelpers
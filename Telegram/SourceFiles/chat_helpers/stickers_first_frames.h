@@ -0,0 +1,43 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Main {
+class Session;
+} // namespace Main
+
+namespace ChatHelpers {
+
+inline constexpr auto kStickerSetFirstFramesLimit = 120;
+
+struct StickerFirstFrame {
+	DocumentId id = 0;
+	QImage frame;
+};
+
+// First frames of a whole sticker set are kept in the cache as one
+// atlas image, so the stickers panel can show them with one decode.
+// The atlas is dropped if the set hash or the tile size has changed.
+//
+// The callback is called on the main thread, with an empty vector
+// if there is no good atlas in the cache.
+void LoadStickerSetFirstFrames(
+	not_null<Main::Session*> session,
+	uint64 setId,
+	uint64 hash,
+	QSize tile,
+	Fn<void(std::vector<StickerFirstFrame>)> done);
+
+void SaveStickerSetFirstFrames(
+	not_null<Main::Session*> session,
+	uint64 setId,
+	uint64 hash,
+	QSize tile,
+	std::vector<StickerFirstFrame> frames);
+
+} // namespace ChatHelpers
@@ -16,6 +16,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_changes.h"
 #include "chat_helpers/send_context_menu.h" // SendMenu::FillSendMenu
 #include "chat_helpers/stickers_lottie.h"
+#include "chat_helpers/stickers_first_frames.h"
 #include "ui/widgets/buttons.h"
 #include "ui/widgets/popup_menu.h"
 #include "ui/effects/animations.h"
@@ -52,6 +53,12 @@ namespace {
 constexpr auto kSearchRequestDelay = 400;
 constexpr auto kPreloadOfficialPages = 4;
 constexpr auto kOfficialLoadLimit = 40;
+constexpr auto kFastScrollSpeed = 2; // Pixels per millisecond.
+constexpr auto kFastScrollMaxInterval = crl::time(100);
+constexpr auto kScrollSettleTimeout = crl::time(150);
+constexpr auto kMinAnimatingStickers = 6;
+constexpr auto kMaxAnimatingStickers = 40;
+constexpr auto kPaintDurationLimit = crl::time(12);
 
 using Data::StickersSet;
 using Data::StickersPack;
@@ -803,7 +810,7 @@ void StickersListWidget::Footer::validateIconLottieAnimation(
 			st::stickerIconWidth - 2 * st::stickerIconPadding,
 			st::emojiFooterHeight - 2 * st::stickerIconPadding
 		) * cIntRetinaFactor(),
-		_pan->getLottieRenderer());
+		LottieRendererFromPool());
 	if (!player) {
 		return;
 	}
@@ -924,6 +931,8 @@ StickersListWidget::StickersListWidget(
 	bool masks)
 : Inner(parent, controller)
 , _api(&controller->session().mtp())
+, _scrollSettleTimer([=] { _scrollingFast = false; update(); })
+, _animatingLimit(kMaxAnimatingStickers)
 , _section(Section::Stickers)
 , _isMasks(masks)
 , _pathGradient(std::make_unique<Ui::PathShiftGradient>(
@@ -1035,6 +1044,53 @@ void StickersListWidget::visibleTopBottomUpdated(
 		checkVisibleLottie();
 	}
 	validateSelectedIcon(ValidateIconAnimations::Full);
+	updateScrollSpeed(visibleTop);
+}
+
+void StickersListWidget::updateScrollSpeed(int visibleTop) {
+	const auto now = crl::now();
+	const auto elapsed = now - _lastScrollTime;
+	const auto delta = std::abs(visibleTop - _lastScrollTop);
+	_lastScrollTop = visibleTop;
+	_lastScrollTime = now;
+	if (!delta) {
+		return;
+	} else if (elapsed > 0
+		&& elapsed < kFastScrollMaxInterval
+		&& delta > kFastScrollSpeed * elapsed) {
+		_scrollingFast = true;
+	}
+	if (_scrollingFast) {
+		// Animations are paused until the scrolling settles.
+		_scrollSettleTimer.callOnce(kScrollSettleTimeout);
+	}
+}
+
+void StickersListWidget::updateAnimatingLimit(crl::time paintDuration) {
+	const auto animating = int(_animating.size());
+	if (!animating) {
+		return;
+	} else if (paintDuration > kPaintDurationLimit) {
+		_animatingLimit = std::max(
+			std::min(_animatingLimit, animating) * 3 / 4,
+			kMinAnimatingStickers);
+	} else if (paintDuration < kPaintDurationLimit / 2
+		&& animating >= _animatingLimit) {
+		_animatingLimit = std::min(_animatingLimit + 1, kMaxAnimatingStickers);
+	}
+}
+
+bool StickersListWidget::canAnimateSticker(
+		Lottie::Animation *animation) const {
+	if (_scrollingFast) {
+		return false;
+	}
+	// Counted over all the unpaused animations, not only the painted ones,
+	// so that the ones above the lowered limit are paused when painted.
+	const auto animating = int(_animating.size());
+	return (animation && _animating.contains(animation))
+		? (animating <= _animatingLimit)
+		: (animating < _animatingLimit);
 }
 
 void StickersListWidget::checkVisibleFeatured(
@@ -1475,6 +1531,7 @@ void StickersListWidget::takeHeavyData(Set &to, Set &from) {
 		}
 		for (const auto &sticker : fromList) {
 			if (sticker.animated) {
+				_animating.remove(sticker.animated);
 				to.lottiePlayer->remove(sticker.animated);
 			}
 		}
@@ -1584,7 +1641,9 @@ void StickersListWidget::paintEvent(QPaintEvent *e) {
 	auto clip = e->rect();
 	p.fillRect(clip, st::emojiPanBg);
 
+	const auto started = crl::now();
 	paintStickers(p, clip);
+	updateAnimatingLimit(crl::now() - started);
 }
 
 void StickersListWidget::paintStickers(Painter &p, QRect clip) {
@@ -1720,6 +1779,7 @@ void StickersListWidget::paintStickers(Painter &p, QRect clip) {
 			paintMegagroupEmptySet(p, info.rowsTop, buttonSelected);
 			return true;
 		}
+		checkFirstFrames(set);
 		auto fromRow = floorclamp(clip.y() - info.rowsTop, _singleSize.height(), 0, info.rowsCount);
 		auto toRow = ceilclamp(clip.y() + clip.height() - info.rowsTop, _singleSize.height(), 0, info.rowsCount);
 		for (int i = fromRow; i < toRow; ++i) {
@@ -1772,15 +1832,125 @@ void StickersListWidget::checkVisibleLottie() {
 void StickersListWidget::clearHeavyIn(Set &set, bool clearSavedFrames) {
 	const auto player = base::take(set.lottiePlayer);
 	const auto lifetime = base::take(set.lottieLifetime);
+	if (clearSavedFrames) {
+		// Take them from the cached atlas when the set is shown again.
+		_firstFrames.remove(set.id);
+	}
 	for (auto &sticker : set.stickers) {
 		if (clearSavedFrames) {
 			sticker.savedFrame = QPixmap();
 		}
-		sticker.animated = nullptr;
+		if (const auto animated = base::take(sticker.animated)) {
+			_animating.remove(animated);
+		}
 		sticker.documentMedia = nullptr;
 	}
 }
 
+void StickersListWidget::checkFirstFrames(Set &set) {
+	if (!set.set || !set.set->hash || set.stickers.empty()) {
+		return;
+	}
+	const auto i = _firstFrames.find(set.id);
+	if (i == end(_firstFrames)) {
+		_firstFrames.emplace(set.id, FirstFramesState::Loading);
+		const auto setId = set.id;
+		LoadStickerSetFirstFrames(
+			&session(),
+			setId,
+			set.set->hash,
+			boundingBoxSize() * cIntRetinaFactor(),
+			crl::guard(this, [=](std::vector<StickerFirstFrame> frames) {
+				applyFirstFrames(setId, std::move(frames));
+			}));
+	}
+}
+
+void StickersListWidget::firstFrameSaved(const Set &set) {
+	const auto i = _firstFrames.find(set.id);
+	if (i != end(_firstFrames) && i->second == FirstFramesState::Missing) {
+		saveFirstFrames(set);
+	}
+}
+
+void StickersListWidget::applyFirstFrames(
+		uint64 setId,
+		std::vector<StickerFirstFrame> frames) {
+	const auto i = _firstFrames.find(setId);
+	if (i == end(_firstFrames)
+		|| i->second != FirstFramesState::Loading) {
+		return;
+	}
+	i->second = frames.empty()
+		? FirstFramesState::Missing
+		: FirstFramesState::Loaded;
+	auto &sets = shownSets();
+	const auto j = ranges::find(sets, setId, &Set::id);
+	if (j == end(sets)) {
+		return;
+	} else if (frames.empty()) {
+		// All the frames could be painted while the atlas was loading.
+		saveFirstFrames(*j);
+		return;
+	}
+	auto applied = false;
+	for (auto &sticker : j->stickers) {
+		if (!sticker.savedFrame.isNull()) {
+			continue;
+		}
+		const auto k = ranges::find(
+			frames,
+			sticker.document->id,
+			&StickerFirstFrame::id);
+		if (k != end(frames)) {
+			sticker.savedFrame = QPixmap::fromImage(
+				std::move(k->frame),
+				Qt::ColorOnly);
+			sticker.savedFrame.setDevicePixelRatio(cRetinaFactor());
+			applied = true;
+		}
+	}
+	if (applied) {
+		update();
+	}
+}
+
+void StickersListWidget::saveFirstFrames(const Set &set) {
+	const auto tile = boundingBoxSize() * cIntRetinaFactor();
+	const auto count = std::min(
+		int(set.stickers.size()),
+		kStickerSetFirstFramesLimit);
+	const auto stickers = ranges::make_subrange(
+		begin(set.stickers),
+		begin(set.stickers) + count);
+	if (ranges::any_of(stickers, &QPixmap::isNull, &Sticker::savedFrame)) {
+		// Wait until all of them are painted.
+		return;
+	}
+	auto frames = std::vector<StickerFirstFrame>();
+	frames.reserve(count);
+	for (const auto &sticker : stickers) {
+		auto frame = sticker.savedFrame.toImage();
+		if (frame.width() > tile.width() || frame.height() > tile.height()) {
+			frame = frame.scaled(
+				tile,
+				Qt::KeepAspectRatio,
+				Qt::SmoothTransformation);
+		}
+		frames.push_back({
+			.id = sticker.document->id,
+			.frame = std::move(frame),
+		});
+	}
+	_firstFrames[set.id] = FirstFramesState::Saved;
+	SaveStickerSetFirstFrames(
+		&session(),
+		set.id,
+		set.set->hash,
+		tile,
+		std::move(frames));
+}
+
 void StickersListWidget::pauseInvisibleLottieIn(const SectionInfo &info) {
 	auto &set = shownSets()[info.section];
 	const auto player = set.lottiePlayer.get();
@@ -1797,6 +1967,7 @@ void StickersListWidget::pauseInvisibleLottieIn(const SectionInfo &info) {
 					break;
 				}
 				if (const auto animated = set.stickers[index].animated) {
+					_animating.remove(animated);
 					player->pause(animated);
 				}
 			}
@@ -1873,7 +2044,7 @@ void StickersListWidget::ensureLottiePlayer(Set &set) {
 	}
 	set.lottiePlayer = std::make_unique<Lottie::MultiPlayer>(
 		Lottie::Quality::Default,
-		getLottieRenderer());
+		LottieRendererFromPool());
 	const auto raw = set.lottiePlayer.get();
 
 	raw->updates(
@@ -1921,7 +2092,9 @@ void StickersListWidget::paintSticker(Painter &p, Set &set, int y, int section,
 	}
 
 	const auto isAnimated = document->sticker()->animated;
-	if (isAnimated
+	const auto canAnimate = isAnimated
+		&& canAnimateSticker(sticker.animated);
+	if (canAnimate
 		&& !sticker.animated
 		&& media->loaded()) {
 		setupLottie(set, section, index);
@@ -1936,7 +2109,9 @@ void StickersListWidget::paintSticker(Painter &p, Set &set, int y, int section,
 		Ui::FillRoundRect(p, QRect(tl, _singleSize), st::emojiPanHover, Ui::StickerHoverCorners);
 	}
 
-	media->checkStickerSmall();
+	if (sticker.savedFrame.isNull()) {
+		media->checkStickerSmall();
+	}
 
 	auto w = 1;
 	auto h = 1;
@@ -1953,7 +2128,8 @@ void StickersListWidget::paintSticker(Painter &p, Set &set, int y, int section,
 	}
 	auto ppos = pos + QPoint((_singleSize.width() - w) / 2, (_singleSize.height() - h) / 2);
 
-	if (sticker.animated && sticker.animated->ready()) {
+	const auto ready = sticker.animated && sticker.animated->ready();
+	if (ready && (canAnimate || sticker.savedFrame.isNull())) {
 		auto request = Lottie::FrameRequest();
 		request.box = boundingBoxSize() * cIntRetinaFactor();
 		const auto frame = sticker.animated->frame(request);
@@ -1963,9 +2139,21 @@ void StickersListWidget::paintSticker(Painter &p, Set &set, int y, int section,
 		if (sticker.savedFrame.isNull()) {
 			sticker.savedFrame = QPixmap::fromImage(frame, Qt::ColorOnly);
 			sticker.savedFrame.setDevicePixelRatio(cRetinaFactor());
+			firstFrameSaved(set);
+		}
+		if (canAnimate) {
+			_animating.emplace(sticker.animated);
+			set.lottiePlayer->unpause(sticker.animated);
+		} else {
+			_animating.remove(sticker.animated);
+			set.lottiePlayer->pause(sticker.animated);
 		}
-		set.lottiePlayer->unpause(sticker.animated);
 	} else {
+		if (sticker.animated) {
+			// Flinging or over the budget, show the saved first frame.
+			_animating.remove(sticker.animated);
+			set.lottiePlayer->pause(sticker.animated);
+		}
 		const auto image = media->getStickerSmall();
 		const auto pixmap = !sticker.savedFrame.isNull()
 			? sticker.savedFrame
@@ -1981,6 +2169,7 @@ void StickersListWidget::paintSticker(Painter &p, Set &set, int y, int section,
 			p.drawPixmapLeft(ppos, width(), pixmap);
 			if (sticker.savedFrame.isNull()) {
 				sticker.savedFrame = pixmap;
+				firstFrameSaved(set);
 			}
 		} else {
 			PaintStickerThumbnailPath(
@@ -2991,16 +3180,6 @@ void StickersListWidget::showPreview() {
 	}
 }
 
-auto StickersListWidget::getLottieRenderer()
--> std::shared_ptr<Lottie::FrameRenderer> {
-	if (auto result = _lottieRenderer.lock()) {
-		return result;
-	}
-	auto result = Lottie::MakeFrameRenderer();
-	_lottieRenderer = result;
-	return result;
-}
-
 void StickersListWidget::showStickerSet(uint64 setId) {
 	clearSelection();
 
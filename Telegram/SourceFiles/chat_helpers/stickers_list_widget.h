@@ -42,6 +42,7 @@ class StickersSet;
 namespace ChatHelpers {
 
 struct StickerIcon;
+struct StickerFirstFrame;
 
 class StickersListWidget final : public TabbedSelector::Inner {
 public:
@@ -82,8 +83,6 @@ public:
 	void sendSearchRequest();
 	void searchForSets(const QString &query);
 
-	std::shared_ptr<Lottie::FrameRenderer> getLottieRenderer();
-
 	void fillContextMenu(
 		not_null<Ui::PopupMenu*> menu,
 		SendMenu::Type type) override;
@@ -264,6 +263,13 @@ private:
 	std::unique_ptr<Ui::RippleAnimation> createButtonRipple(int section);
 	QPoint buttonRippleTopLeft(int section) const;
 
+	enum class FirstFramesState {
+		Loading,
+		Loaded,
+		Missing,
+		Saved,
+	};
+
 	enum class ValidateIconAnimations {
 		Full,
 		Scroll,
@@ -286,7 +292,17 @@ private:
 	void setupLottie(Set &set, int section, int index);
 	void markLottieFrameShown(Set &set);
 	void checkVisibleLottie();
+	void updateScrollSpeed(int visibleTop);
+	void updateAnimatingLimit(crl::time paintDuration);
+	[[nodiscard]] bool canAnimateSticker(
+		Lottie::Animation *animation) const;
 	void pauseInvisibleLottieIn(const SectionInfo &info);
+	void checkFirstFrames(Set &set);
+	void firstFrameSaved(const Set &set);
+	void applyFirstFrames(
+		uint64 setId,
+		std::vector<StickerFirstFrame> frames);
+	void saveFirstFrames(const Set &set);
 	void takeHeavyData(std::vector<Set> &to, std::vector<Set> &from);
 	void takeHeavyData(Set &to, Set &from);
 	void takeHeavyData(Sticker &to, Sticker &from);
@@ -348,7 +364,14 @@ private:
 	base::flat_set<uint64> _installedLocallySets;
 	std::vector<bool> _custom;
 	base::flat_set<not_null<DocumentData*>> _favedStickersMap;
-	std::weak_ptr<Lottie::FrameRenderer> _lottieRenderer;
+	base::flat_map<uint64, FirstFramesState> _firstFrames;
+
+	int _lastScrollTop = 0;
+	crl::time _lastScrollTime = 0;
+	bool _scrollingFast = false;
+	base::Timer _scrollSettleTimer;
+	int _animatingLimit = 0;
+	base::flat_set<not_null<Lottie::Animation*>> _animating;
 
 	mtpRequestId _officialRequestId = 0;
 	int _officialOffset = 0;
@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "lottie/lottie_single_player.h"
 #include "lottie/lottie_multi_player.h"
+#include "lottie/lottie_frame_renderer.h"
 #include "data/stickers/data_stickers_set.h"
 #include "data/data_document.h"
 #include "data/data_document_media.h"
@@ -18,10 +19,72 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/effects/path_shift_gradient.h"
 #include "main/main_session.h"
 
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+
 namespace ChatHelpers {
 namespace {
 
 constexpr auto kDontCacheLottieAfterArea = 512 * 512;
+constexpr auto kMaxLottieRenderers = 8;
+
+// Frames cache of one sticker (size tag and colors are in the key),
+// just rendered by one of the players showing it in the panel, in the
+// chat or in the sticker set box. The next player that asks for the
+// cache takes the bytes, so they are not kept after being decoded.
+// They are dropped as well once they are put to the cache database.
+//
+// Accessed from the cache and the lottie threads.
+class SharedFrames final {
+public:
+	[[nodiscard]] std::optional<QByteArray> takeBytes() {
+		QMutexLocker lock(&_mutex);
+		return base::take(_bytes);
+	}
+	void setBytes(const QByteArray &bytes) {
+		QMutexLocker lock(&_mutex);
+		_bytes = bytes;
+	}
+	void clearBytes() {
+		QMutexLocker lock(&_mutex);
+		_bytes = std::nullopt;
+	}
+
+private:
+	QMutex _mutex;
+	std::optional<QByteArray> _bytes;
+
+};
+
+using SharedFramesKey = std::pair<
+	not_null<const Main::Session*>,
+	Storage::Cache::Key>;
+
+QMutex SharedFramesMutex;
+base::flat_map<SharedFramesKey, std::weak_ptr<SharedFrames>> SharedFramesMap;
+
+[[nodiscard]] std::shared_ptr<SharedFrames> LookupSharedFrames(
+		not_null<const Main::Session*> session,
+		Storage::Cache::Key key) {
+	QMutexLocker lock(&SharedFramesMutex);
+	const auto mapKey = SharedFramesKey{ session, key };
+	auto &weak = SharedFramesMap[mapKey];
+	if (auto result = weak.lock()) {
+		return result;
+	}
+	auto result = std::make_shared<SharedFrames>();
+	weak = result;
+
+	// Drop the entries of stickers that are not shown anymore.
+	for (auto i = begin(SharedFramesMap); i != end(SharedFramesMap);) {
+		if (i->second.expired()) {
+			i = SharedFramesMap.erase(i);
+		} else {
+			++i;
+		}
+	}
+	return result;
+}
 
 } // namespace
 
@@ -37,15 +100,21 @@ auto LottieCachedFromContent(
 		baseKey.high,
 		baseKey.low + keyShift
 	};
+	const auto shared = LookupSharedFrames(session, key);
 	const auto get = [=](FnMut<void(QByteArray &&cached)> handler) {
-		session->data().cacheBigFile().get(
-			key,
-			std::move(handler));
+		if (auto bytes = shared->takeBytes()) {
+			handler(base::take(*bytes));
+			return;
+		}
+		session->data().cacheBigFile().get(key, std::move(handler));
 	};
 	const auto weak = base::make_weak(session.get());
 	const auto put = [=](QByteArray &&cached) {
+		shared->setBytes(cached);
 		crl::on_main(weak, [=, data = std::move(cached)]() mutable {
+			// The database reads queued after this put will find it.
 			weak->data().cacheBigFile().put(key, std::move(data));
+			shared->clearBytes();
 		});
 	};
 	return method(
@@ -84,6 +153,24 @@ auto LottieFromDocument(
 		Lottie::FrameRequest{ box });
 }
 
+std::shared_ptr<Lottie::FrameRenderer> LottieRendererFromPool() {
+	static auto Pool = std::vector<std::weak_ptr<Lottie::FrameRenderer>>();
+	static auto Next = 0;
+
+	if (Pool.empty()) {
+		Pool.resize(
+			std::clamp(QThread::idealThreadCount(), 1, kMaxLottieRenderers));
+	}
+	auto &weak = Pool[Next];
+	Next = (Next + 1) % int(Pool.size());
+	if (auto result = weak.lock()) {
+		return result;
+	}
+	auto result = Lottie::MakeFrameRenderer();
+	weak = result;
+	return result;
+}
+
 std::unique_ptr<Lottie::SinglePlayer> LottiePlayerFromDocument(
 		not_null<Data::DocumentMedia*> media,
 		StickerLottieSize sizeTag,
@@ -111,7 +198,7 @@ std::unique_ptr<Lottie::SinglePlayer> LottiePlayerFromDocument(
 			std::forward<decltype(args)>(args)...,
 			quality,
 			replacements,
-			std::move(renderer));
+			renderer ? std::move(renderer) : LottieRendererFromPool());
 	};
 	const auto tag = replacements ? replacements->tag : uint8(0);
 	const auto keyShift = ((tag << 4) & 0xF0) | (uint8(sizeTag) & 0x0F);
@@ -171,9 +258,12 @@ std::unique_ptr<Lottie::SinglePlayer> LottieThumbnail(
 	if (content.isEmpty()) {
 		return nullptr;
 	}
-	const auto method = [](auto &&...args) {
+	const auto method = [&](auto &&...args) {
 		return std::make_unique<Lottie::SinglePlayer>(
-			std::forward<decltype(args)>(args)...);
+			std::forward<decltype(args)>(args)...,
+			Lottie::Quality(),
+			nullptr,
+			renderer ? std::move(renderer) : LottieRendererFromPool());
 	};
 	const auto session = thumb
 		? &thumb->owner()->session()
@@ -50,6 +50,11 @@ enum class StickerLottieSize : uchar {
 	EmojiInteractionReserved3,
 };
 
+// Renderers are shared by all the animations, one per core, and are
+// handed out in turn, so that many animations render in parallel.
+// The players created without an explicit renderer use them as well.
+[[nodiscard]] std::shared_ptr<Lottie::FrameRenderer> LottieRendererFromPool();
+
 [[nodiscard]] std::unique_ptr<Lottie::SinglePlayer> LottiePlayerFromDocument(
 	not_null<Data::DocumentMedia*> media,
 	StickerLottieSize sizeTag,
@@ -398,7 +398,11 @@ TabbedSelector::TabbedSelector(
 		) | rpl::start_with_next([=] {
 			refreshStickers();
 		}, lifetime());
-		refreshStickers();
+
+		// Otherwise we'll refresh after the local stickers are read.
+		if (session().data().stickers().localLoaded()) {
+			refreshStickers();
+		}
 	}
 	//setAttribute(Qt::WA_AcceptTouchEvents);
 	setAttribute(Qt::WA_OpaquePaintEvent, false);
@@ -46,9 +46,13 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mainwidget.h"
 #include "core/file_utilities.h"
 #include "core/crash_reports.h"
+#include "core/idle_maintenance.h"
+#include "core/startup_timeline.h"
+#include "core/soak_test.h"
 #include "main/main_account.h"
 #include "main/main_domain.h"
 #include "main/main_session.h"
+#include "main/main_session_settings.h"
 #include "media/view/media_view_overlay_widget.h"
 #include "media/view/media_view_open_common.h"
 #include "mtproto/mtproto_dc_options.h"
@@ -96,6 +100,8 @@ namespace {
 constexpr auto kQuitPreventTimeoutMs = crl::time(1500);
 constexpr auto kAutoLockTimeoutLateMs = crl::time(3000);
 constexpr auto kClearEmojiImageSourceTimeout = 10 * crl::time(1000);
+constexpr auto kEmojiKeywordsRefreshInterval = 3600 * crl::time(1000);
+constexpr auto kEmojiKeywordsRefreshBudget = crl::time(50);
 
 void SetCrashAnnotationsGL() {
 #ifdef Q_OS_WIN
@@ -137,6 +143,7 @@ Application::Application(not_null<Launcher*> launcher)
 , _audio(std::make_unique<Media::Audio::Instance>())
 , _fallbackProductionConfig(
 	std::make_unique<MTP::Config>(MTP::Environment::Production))
+, _idleMaintenance(std::make_unique<IdleMaintenance>())
 , _domain(std::make_unique<Main::Domain>(cDataFile()))
 , _exportManager(std::make_unique<Export::Manager>())
 , _calls(std::make_unique<Calls::Instance>())
@@ -156,6 +163,23 @@ Application::Application(not_null<Launcher*> launcher)
 		_notifications->updateAll();
 	}, _lifetime);
 
+	_domain->activeSessionValue(
+	) | rpl::map([](Main::Session *session) -> rpl::producer<bool> {
+		return session
+			? session->updates().isIdleValue()
+			: rpl::single(false);
+	}) | rpl::flatten_latest(
+	) | rpl::start_with_next([=](bool idle) {
+		_idleMaintenance->setIdle(idle);
+	}, _lifetime);
+
+	_idleMaintenance->add({
+		.name = u"emoji keywords"_q,
+		.interval = kEmojiKeywordsRefreshInterval,
+		.budget = kEmojiKeywordsRefreshBudget,
+		.run = [=] { _emojiKeywords->refresh(); },
+	}, _lifetime);
+
 	_domain->activeSessionChanges(
 	) | rpl::start_with_next([=](Main::Session *session) {
 		if (session && !UpdaterDisabled()) { // #TODO multi someSessionValue
@@ -172,6 +196,7 @@ Application::~Application() {
 	// Depend on activeWindow() for now :(
 	Shortcuts::Finish();
 
+	_soakTest = nullptr;
 	_window = nullptr;
 	_mediaView = nullptr;
 	_notifications->clearAllFast();
@@ -207,6 +232,7 @@ Application::~Application() {
 }
 
 void Application::run() {
+	StartupTimeline::Mark("application");
 	style::internal::StartFonts();
 
 	ThirdParty::start();
@@ -217,6 +243,7 @@ void Application::run() {
 
 	startLocalStorage();
 	Kotato::Lang::Load(Lang::GetInstance().baseId(), Lang::GetInstance().id());
+	StartupTimeline::Mark("local storage");
 
 	if (!cQtScale()) {
 		ValidateScale();
@@ -288,6 +315,7 @@ void Application::run() {
 	}, _lifetime);
 
 	DEBUG_LOG(("Application Info: window created..."));
+	StartupTimeline::Mark("window");
 
 	// Depend on activeWindow() for now :(
 	startShortcuts();
@@ -331,6 +359,10 @@ void Application::run() {
 			[[maybe_unused]] const auto countriesCopy = countries;
 		});
 	}
+
+	if (SoakTest::Enabled()) {
+		_soakTest = std::make_unique<SoakTest>();
+	}
 }
 
 void Application::showOpenGLCrashNotification() {
@@ -360,9 +392,11 @@ void Application::showOpenGLCrashNotification() {
 
 void Application::startDomain() {
 	const auto state = _domain->start(QByteArray());
+	StartupTimeline::Mark("domain");
 	if (state != Storage::StartResult::IncorrectPasscodeLegacy) {
 		// In case of non-legacy passcoded app all global settings are ready.
 		startSettingsAndBackground();
+		StartupTimeline::Mark("settings and background");
 	}
 	if (state != Storage::StartResult::Success) {
 		lockByPasscode();
@@ -478,7 +512,11 @@ bool Application::eventFilter(QObject *object, QEvent *e) {
 }
 
 void Application::saveSettingsDelayed(crl::time delay) {
-	if (_saveSettingsTimer) {
+	// Don't postpone an already scheduled save, so a stream of changes
+	// like a window move is written at most once per delay.
+	if (_saveSettingsTimer
+		&& (!_saveSettingsTimer->isActive()
+			|| _saveSettingsTimer->remainingTime() > delay)) {
 		_saveSettingsTimer->callOnce(delay);
 	}
 }
@@ -1111,9 +1149,29 @@ bool Application::readyToQuit() {
 		quitDelayed();
 		return false;
 	}
+	if (!cRestarting() && !cRestartingUpdate()) {
+		forgetRestoreChats();
+	}
 	return true;
 }
 
+void Application::forgetRestoreChats() {
+	// A clean quit starts from the chats list next time, the opened
+	// chat is restored only after a crash or a restart.
+	if (!_domain->started()) {
+		return;
+	}
+	for (const auto &[index, account] : _domain->accounts()) {
+		if (const auto session = account->maybeSession()) {
+			auto &settings = session->settings();
+			if (settings.restoreChatPeer()) {
+				settings.setRestoreChat(PeerId(), MsgId());
+				session->saveSettingsDelayed();
+			}
+		}
+	}
+}
+
 void Application::quitPreventFinished() {
 	if (App::quitting()) {
 		QuitAttempt();
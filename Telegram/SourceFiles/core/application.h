@@ -101,6 +101,8 @@ class Instance;
 namespace Core {
 
 class Launcher;
+class IdleMaintenance;
+class SoakTest;
 struct LocalUrlHandler;
 
 class Application final : public QObject {
@@ -202,6 +204,9 @@ public:
 	[[nodiscard]] ChatHelpers::EmojiKeywords &emojiKeywords() {
 		return *_emojiKeywords;
 	}
+	[[nodiscard]] IdleMaintenance &idleMaintenance() {
+		return *_idleMaintenance;
+	}
 	[[nodiscard]] auto emojiImageLoader() const
 	-> const crl::object_on_queue<Stickers::EmojiImageLoader> & {
 		return _emojiImageLoader;
@@ -294,6 +299,7 @@ private:
 	static void QuitAttempt();
 	void quitDelayed();
 	[[nodiscard]] bool readyToQuit();
+	void forgetRestoreChats();
 
 	void showOpenGLCrashNotification();
 	void clearPasscodeLock();
@@ -333,6 +339,8 @@ private:
 	// Mutable because is created in run() after OpenSSL is inited.
 	std::unique_ptr<Window::Notifications::System> _notifications;
 
+	// Maintenance jobs are registered by the accounts.
+	const std::unique_ptr<IdleMaintenance> _idleMaintenance;
 	const std::unique_ptr<Main::Domain> _domain;
 	const std::unique_ptr<Export::Manager> _exportManager;
 	const std::unique_ptr<Calls::Instance> _calls;
@@ -356,6 +364,8 @@ private:
 
 	std::optional<base::Timer> _saveSettingsTimer;
 
+	std::unique_ptr<SoakTest> _soakTest;
+
 	struct LeaveFilter {
 		std::vector<QPointer<QWidget>> registered;
 		QPointer<QObject> filter;
@@ -242,6 +242,8 @@ void SignalHandler(int signum) {
 	const auto thread = QThread::currentThreadId();
 
 	if (ReportingThreadId.compare_exchange_strong(expected, thread)) {
+		// The last debug records before the crash are the useful ones.
+		Logs::flushForCrash();
 		WriteReportInfo(signum, name);
 		ReportingThreadId = nullptr;
 	}
@@ -10,13 +10,163 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "platform/platform_file_bookmark.h"
 #include "logs.h"
 
+#include <crl/crl_async.h>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
 #include <QtCore/QFileInfo>
+#include <QtCore/QFileSystemWatcher>
+#include <QtCore/QPointer>
+#include <QtCore/QThread>
 
 namespace Core {
 namespace {
 
 const auto kInMediaCacheLocation = u"*media_cache*"_q;
 
+constexpr auto kCheckRefreshTimeout = crl::time(5000);
+constexpr auto kMaxWatchedFolders = 4;
+constexpr auto kMaxCachedStates = 4096;
+
+// What the filesystem said about the file, not the result for a location.
+struct FileState {
+	bool readable = false;
+	quint64 size = 0;
+	QDateTime modified;
+	crl::time checked = 0;
+	bool watched = false;
+	bool refreshing = false;
+};
+
+[[nodiscard]] FileState ReadFileState(const QFileInfo &f) {
+	const auto readable = f.isReadable();
+	return {
+		.readable = readable,
+		.size = readable ? quint64(f.size()) : 0,
+		.modified = readable ? f.lastModified() : QDateTime(),
+		.checked = crl::now(),
+	};
+}
+
+// Cached states are trusted for a few seconds, so that the rows painted
+// for the downloaded files don't stat them on every frame. In the watched
+// download folders they are dropped when the folder changes and are
+// refreshed off the main thread once they get old.
+class FileStates final {
+public:
+	[[nodiscard]] const FileState *find(
+		const QString &path,
+		bool canRefresh);
+	void store(const QString &path, FileState state);
+	void watch(const QString &folder);
+
+private:
+	void refresh(const QString &path);
+	void folderChanged(const QString &folder);
+	void prune();
+
+	QPointer<QFileSystemWatcher> _watcher;
+	base::flat_map<QString, FileState> _states;
+	base::flat_map<QString, base::flat_set<QString>> _watchedPaths;
+
+};
+
+[[nodiscard]] FileStates *ChecksCache() {
+	const auto app = QCoreApplication::instance();
+	if (!app || QThread::currentThread() != app->thread()) {
+		return nullptr;
+	}
+	static auto Result = FileStates();
+	return &Result;
+}
+
+const FileState *FileStates::find(const QString &path, bool canRefresh) {
+	const auto i = _states.find(path);
+	if (i == end(_states)) {
+		return nullptr;
+	} else if (crl::now() - i->second.checked < kCheckRefreshTimeout) {
+		return &i->second;
+	} else if (!canRefresh || !i->second.watched) {
+		_states.erase(i);
+		return nullptr;
+	} else if (!i->second.refreshing) {
+		i->second.refreshing = true;
+		refresh(path);
+	}
+	return &i->second;
+}
+
+void FileStates::store(const QString &path, FileState state) {
+	const auto folder = QFileInfo(path).absolutePath();
+	const auto i = _watchedPaths.find(folder);
+	state.watched = (i != end(_watchedPaths));
+	if (state.watched) {
+		i->second.emplace(path);
+	}
+	_states[path] = std::move(state);
+	if (_states.size() > kMaxCachedStates) {
+		prune();
+	}
+}
+
+void FileStates::watch(const QString &folder) {
+	const auto path = QDir(folder).absolutePath();
+	if (_watchedPaths.contains(path)
+		|| _watchedPaths.size() >= kMaxWatchedFolders) {
+		return;
+	}
+	if (!_watcher) {
+		_watcher = new QFileSystemWatcher(QCoreApplication::instance());
+		QObject::connect(
+			_watcher,
+			&QFileSystemWatcher::directoryChanged,
+			[=](const QString &folder) { folderChanged(folder); });
+	}
+	if (_watcher->addPath(path)) {
+		_watchedPaths.emplace(path);
+	}
+}
+
+void FileStates::refresh(const QString &path) {
+	crl::async([=] {
+		auto state = ReadFileState(QFileInfo(path));
+		crl::on_main([=, state = std::move(state)]() mutable {
+			const auto i = _states.find(path);
+			if (i != end(_states) && i->second.refreshing) {
+				state.watched = true;
+				i->second = std::move(state);
+			}
+		});
+	});
+}
+
+void FileStates::folderChanged(const QString &folder) {
+	const auto i = _watchedPaths.find(folder);
+	if (i == end(_watchedPaths)) {
+		return;
+	}
+	for (const auto &path : base::take(i->second)) {
+		_states.remove(path);
+	}
+}
+
+void FileStates::prune() {
+	const auto now = crl::now();
+	for (auto i = begin(_states); i != end(_states);) {
+		if (!i->second.watched
+			&& (now - i->second.checked >= kCheckRefreshTimeout)) {
+			i = _states.erase(i);
+		} else {
+			++i;
+		}
+	}
+	if (_states.size() > kMaxCachedStates) {
+		_states.clear();
+		for (auto &[folder, paths] : _watchedPaths) {
+			paths.clear();
+		}
+	}
+}
+
 } // namespace
 
 ReadAccessEnabler::ReadAccessEnabler(const Platform::FileBookmark *bookmark)
@@ -50,6 +200,9 @@ FileLocation::FileLocation(const QString &name) : fname(name) {
 			} else {
 				modified = f.lastModified();
 				size = qint32(s);
+				if (const auto cache = ChecksCache()) {
+					cache->store(this->name(), ReadFileState(f));
+				}
 			}
 		} else {
 			fname = QString();
@@ -59,6 +212,12 @@ FileLocation::FileLocation(const QString &name) : fname(name) {
 	}
 }
 
+void WatchFileLocationsFolder(const QString &folder) {
+	if (const auto cache = ChecksCache()) {
+		cache->watch(folder);
+	}
+}
+
 FileLocation FileLocation::InMediaCacheLocation() {
 	return FileLocation(kInMediaCacheLocation);
 }
@@ -68,15 +227,25 @@ bool FileLocation::check() const {
 		return false;
 	}
 
-	ReadAccessEnabler enabler(_bookmark);
-	if (enabler.failed()) {
-		const_cast<FileLocation*>(this)->_bookmark = nullptr;
-	}
+	const auto cache = ChecksCache();
+	const auto path = name();
 
-	QFileInfo f(name());
-	if (!f.isReadable()) return false;
+	// Bookmarked files are refreshed synchronously with access enabled.
+	const auto cached = cache ? cache->find(path, !_bookmark) : nullptr;
+	const auto state = cached ? *cached : [&] {
+		ReadAccessEnabler enabler(_bookmark);
+		if (enabler.failed()) {
+			const_cast<FileLocation*>(this)->_bookmark = nullptr;
+		}
+		auto result = ReadFileState(QFileInfo(path));
+		if (cache) {
+			cache->store(path, result);
+		}
+		return result;
+	}();
+	if (!state.readable) return false;
 
-	quint64 s = f.size();
+	const auto s = state.size;
 	if (s > INT_MAX) {
 		DEBUG_LOG(("File location check: Wrong size %1").arg(s));
 		return false;
@@ -86,7 +255,7 @@ bool FileLocation::check() const {
 		DEBUG_LOG(("File location check: Wrong size %1 when should be %2").arg(s).arg(size));
 		return false;
 	}
-	auto realModified = f.lastModified();
+	const auto &realModified = state.modified;
 	if (realModified != modified) {
 		DEBUG_LOG(("File location check: Wrong last modified time %1 when should be %2").arg(realModified.toMSecsSinceEpoch()).arg(modified.toMSecsSinceEpoch()));
 		return false;
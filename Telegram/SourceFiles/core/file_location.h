@@ -31,6 +31,10 @@ private:
 
 };
 
+// Main thread. Checked file states in this folder are kept until it
+// changes, in other folders they are trusted only for a few seconds.
+void WatchFileLocationsFolder(const QString &folder);
+
 class FileLocation {
 public:
 	FileLocation() = default;
@@ -0,0 +1,161 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/freeze_watchdog.h"
+
+namespace Core {
+namespace {
+
+constexpr auto kPingInterval = crl::time(100);
+constexpr auto kSampleInterval = crl::time(20);
+constexpr auto kDisabledCheckInterval = crl::time(1000);
+constexpr auto kLongTaskThreshold = crl::time(200);
+constexpr auto kMaxSamples = 1000;
+constexpr auto kHistogramLogInterval = 10 * 60 * crl::time(1000);
+constexpr auto kHistogramBounds = std::array<crl::time, 6>{
+	{ 16, 50, 100, 200, 500, 1000 }
+};
+
+[[nodiscard]] QString TaskName(const Logs::Task &task) {
+	// No label means the main thread is inside the native event loop.
+	return task.label ? QString::fromLatin1(task.label) : u"native"_q;
+}
+
+[[nodiscard]] QString TraceTime(crl::time value) {
+	// Chrome tracing expects microseconds.
+	return QString::number(value * 1000);
+}
+
+} // namespace
+
+FreezeWatchdog::FreezeWatchdog()
+: _answered(std::make_shared<std::atomic<uint64>>(0))
+, _histogramLogged(crl::now()) {
+	_thread = std::thread([=] { run(); });
+}
+
+FreezeWatchdog::~FreezeWatchdog() {
+	{
+		auto lock = std::unique_lock(_mutex);
+		_stopping = true;
+	}
+	_condition.notify_all();
+	_thread.join();
+}
+
+bool FreezeWatchdog::waitFor(crl::time timeout) {
+	auto lock = std::unique_lock(_mutex);
+	_condition.wait_for(
+		lock,
+		std::chrono::milliseconds(timeout),
+		[&] { return _stopping; });
+	return !_stopping;
+}
+
+void FreezeWatchdog::run() {
+	auto ping = uint64(0);
+	auto samples = std::vector<Sample>();
+	while (true) {
+		if (!Logs::DebugEnabled()) {
+			if (!waitFor(kDisabledCheckInterval)) {
+				return;
+			}
+			continue;
+		}
+		const auto id = ++ping;
+		const auto sent = crl::now();
+		crl::on_main([answered = _answered, id] {
+			answered->store(id, std::memory_order_release);
+		});
+		samples.clear();
+		while (_answered->load(std::memory_order_acquire) != id) {
+			if (!waitFor(kSampleInterval)) {
+				return;
+			}
+			const auto now = crl::now();
+			if (now - sent >= kLongTaskThreshold
+				&& samples.size() < kMaxSamples) {
+				samples.push_back({ now, Logs::CurrentTask() });
+			}
+		}
+		const auto received = crl::now();
+		measured(received - sent);
+		if (received - sent >= kLongTaskThreshold) {
+			writeFreeze(sent, received, samples);
+		}
+		if (!waitFor(kPingInterval)) {
+			return;
+		}
+	}
+}
+
+void FreezeWatchdog::measured(crl::time latency) {
+	const auto bucket = ranges::upper_bound(kHistogramBounds, latency)
+		- begin(kHistogramBounds);
+	++_histogram[bucket];
+
+	const auto now = crl::now();
+	if (now - _histogramLogged >= kHistogramLogInterval) {
+		_histogramLogged = now;
+		writeHistogram();
+	}
+}
+
+void FreezeWatchdog::writeFreeze(
+		crl::time started,
+		crl::time finished,
+		const std::vector<Sample> &samples) const {
+	Logs::writeTrace(QString(
+		"{\"name\":\"Freeze\",\"cat\":\"main\",\"ph\":\"X\","
+		"\"pid\":1,\"tid\":1,\"ts\":%1,\"dur\":%2}"
+	).arg(TraceTime(started), TraceTime(finished - started)));
+
+	// Merge the equal samples in a row into one slice of the trace.
+	auto durations = base::flat_map<QString, crl::time>();
+	for (auto i = begin(samples); i != end(samples);) {
+		const auto task = i->task;
+		const auto from = i->when;
+		while (i != end(samples)
+			&& i->task.label == task.label
+			&& i->task.type == task.type) {
+			++i;
+		}
+		const auto till = (i != end(samples)) ? i->when : finished;
+		const auto name = TaskName(task);
+		durations[name] += (till - from);
+		Logs::writeTrace(QString(
+			"{\"name\":\"%1\",\"cat\":\"task\",\"ph\":\"X\","
+			"\"pid\":1,\"tid\":1,\"ts\":%2,\"dur\":%3,"
+			"\"args\":{\"type\":%4}}"
+		).arg(name
+		).arg(TraceTime(from)
+		).arg(TraceTime(till - from)
+		).arg(task.type));
+	}
+	const auto mostly = ranges::max_element(
+		durations,
+		ranges::less(),
+		[](const auto &pair) { return pair.second; });
+	LOG(("Freeze Watchdog: Main thread was busy for %1 ms, mostly in %2."
+		).arg(finished - started
+		).arg((mostly != end(durations)) ? mostly->first : u"unknown"_q));
+}
+
+void FreezeWatchdog::writeHistogram() {
+	auto parts = QStringList();
+	for (auto i = 0; i != int(_histogram.size()); ++i) {
+		const auto bound = (i < int(kHistogramBounds.size()))
+			? ("<" + QString::number(kHistogramBounds[i]))
+			: (">=" + QString::number(kHistogramBounds.back()));
+		parts.push_back(bound + "ms: " + QString::number(_histogram[i]));
+	}
+	DEBUG_LOG(("Freeze Watchdog: Event loop latency %1."
+		).arg(parts.join(", ")));
+	_histogram = {};
+}
+
+} // namespace Core
@@ -0,0 +1,52 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace Core {
+
+// While debug logs are enabled pings the main thread from a separate one.
+// Keeps a histogram of the event loop latency and writes the tasks
+// labelled by Logs::TaskScope during long freezes to the trace log.
+class FreezeWatchdog final {
+public:
+	FreezeWatchdog();
+	FreezeWatchdog(const FreezeWatchdog &other) = delete;
+	FreezeWatchdog &operator=(const FreezeWatchdog &other) = delete;
+	~FreezeWatchdog();
+
+private:
+	struct Sample {
+		crl::time when = 0;
+		Logs::Task task;
+	};
+
+	void run();
+	[[nodiscard]] bool waitFor(crl::time timeout);
+	void measured(crl::time latency);
+	void writeFreeze(
+		crl::time started,
+		crl::time finished,
+		const std::vector<Sample> &samples) const;
+	void writeHistogram();
+
+	std::thread _thread;
+	std::mutex _mutex;
+	std::condition_variable _condition;
+	bool _stopping = false;
+
+	const std::shared_ptr<std::atomic<uint64>> _answered;
+	std::array<int, 7> _histogram = { { 0 } };
+	crl::time _histogramLogged = 0;
+
+};
+
+} // namespace Core
@@ -0,0 +1,83 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/idle_maintenance.h"
+
+namespace Core {
+namespace {
+
+constexpr auto kTickTimeout = 30 * crl::time(1000);
+constexpr auto kMaxInterval = 7 * 24 * 3600 * crl::time(1000);
+
+} // namespace
+
+IdleMaintenance::IdleMaintenance()
+: _timer([=] { runNext(); }) {
+}
+
+void IdleMaintenance::add(Job &&job, rpl::lifetime &lifetime) {
+	Expects(job.run != nullptr);
+
+	const auto id = ++_autoincrement;
+	_entries.push_back({ .id = id, .job = std::move(job) });
+	lifetime.add([=] { remove(id); });
+}
+
+void IdleMaintenance::remove(uint64 id) {
+	_entries.erase(ranges::remove(_entries, id, &Entry::id), end(_entries));
+}
+
+void IdleMaintenance::setIdle(bool idle) {
+	if (_idle == idle) {
+		return;
+	}
+	_idle = idle;
+	if (_idle) {
+		_timer.callEach(kTickTimeout);
+	} else {
+		_timer.cancel();
+	}
+}
+
+void IdleMaintenance::runNext() {
+	const auto now = crl::now();
+	const auto due = [&](const Entry &entry) {
+		return !entry.lastRun
+			|| (entry.job.interval > 0
+				&& now - entry.lastRun >= entry.job.interval);
+	};
+	const auto i = ranges::find_if(_entries, due);
+	if (i == end(_entries)) {
+		return;
+	}
+	const auto id = i->id;
+	const auto run = i->job.run;
+	i->lastRun = now;
+
+	run();
+
+	// The job could have destroyed an owner and removed some entries.
+	const auto j = ranges::find(_entries, id, &Entry::id);
+	if (j == end(_entries)) {
+		return;
+	} else if (!j->job.interval) {
+		_entries.erase(j);
+		return;
+	}
+	const auto duration = crl::now() - now;
+	if (j->job.budget > 0 && duration > j->job.budget) {
+		j->job.interval = std::min(j->job.interval * 2, kMaxInterval);
+		LOG(("Maintenance Info: '%1' took %2 ms, next in %3 ms."
+			).arg(j->job.name
+			).arg(duration
+			).arg(j->job.interval));
+	}
+	// Move the job to the end, so the others get their turn first.
+	std::rotate(j, j + 1, end(_entries));
+}
+
+} // namespace Core
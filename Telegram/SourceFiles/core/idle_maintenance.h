@@ -0,0 +1,48 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/timer.h"
+
+namespace Core {
+
+// Runs maintenance jobs while the user is idle, one job per tick.
+// A job that takes longer than its budget gets its interval doubled,
+// a job with zero interval is run only once.
+class IdleMaintenance final {
+public:
+	struct Job {
+		QString name;
+		crl::time interval = 0;
+		crl::time budget = 0;
+		Fn<void()> run;
+	};
+
+	IdleMaintenance();
+
+	void add(Job &&job, rpl::lifetime &lifetime);
+	void setIdle(bool idle);
+
+private:
+	struct Entry {
+		uint64 id = 0;
+		Job job;
+		crl::time lastRun = 0;
+	};
+
+	void remove(uint64 id);
+	void runNext();
+
+	std::vector<Entry> _entries;
+	base::Timer _timer;
+	uint64 _autoincrement = 0;
+	bool _idle = false;
+
+};
+
+} // namespace Core
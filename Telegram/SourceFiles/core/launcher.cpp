@@ -17,6 +17,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/crash_reports.h"
 #include "core/update_checker.h"
 #include "core/sandbox.h"
+#include "core/startup_timeline.h"
+#include "core/soak_test.h"
 #include "base/concurrent_timer.h"
 #include "kotato/json_settings.h"
 
@@ -319,6 +321,7 @@ void Launcher::init() {
 }
 
 int Launcher::exec() {
+	StartupTimeline::Mark("launcher");
 	init();
 
 	if (cLaunchMode() == LaunchModeFixPrevious) {
@@ -330,6 +333,7 @@ int Launcher::exec() {
 	// Must be started before Platform is started.
 	Logs::start(this);
 	Kotato::JsonSettings::Start();
+	StartupTimeline::Mark("logs and settings");
 
 	if (cQtScale()) {
 		QApplication::setAttribute(Qt::AA_DisableHighDpiScaling, false);
@@ -506,6 +510,8 @@ void Launcher::processArguments() {
 		{ "-no-env-api"     , KeyFormat::NoValues },
 		{ "-api-id"         , KeyFormat::OneValue },
 		{ "-api-hash"       , KeyFormat::OneValue },
+		{ "-startup-timeline", KeyFormat::OneValue },
+		{ "-soak"           , KeyFormat::OneValue },
 	};
 	auto parseResult = QMap<QByteArray, QStringList>();
 	auto parsingKey = QByteArray();
@@ -561,6 +567,11 @@ void Launcher::processArguments() {
 			: value;
 	}
 
+	StartupTimeline::SetOutputPath(
+		parseResult.value("-startup-timeline", {}).join(QString()));
+	SoakTest::SetReportPath(
+		parseResult.value("-soak", {}).join(QString()));
+
 	gUseEnvApi = !parseResult.contains("-no-env-api");
 	auto customApiId = parseResult.value("-api-id", {}).join(QString()).toInt();
 	auto customApiHash = parseResult.value("-api-hash", {}).join(QString());
@@ -0,0 +1,146 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/memory_stats.h"
+
+#include "base/timer.h"
+#include "ui/image/image.h"
+#include "platform/platform_specific.h"
+
+#include <QtCore/QFile>
+
+namespace Core::MemoryStats {
+namespace {
+
+constexpr auto kLogTimeout = 10 * 60 * crl::time(1000);
+constexpr auto kTagsCount = int(Tag::kCount);
+
+struct Counters {
+	std::atomic<int64> objects = 0;
+	std::atomic<int64> bytes = 0;
+};
+
+std::array<Counters, kTagsCount> CountersByTag;
+std::unique_ptr<base::Timer> LogTimer;
+
+[[nodiscard]] Counters &CountersFor(Tag tag) {
+	Expects(tag != Tag::kCount);
+
+	return CountersByTag[int(tag)];
+}
+
+[[nodiscard]] QString TagName(Tag tag) {
+	switch (tag) {
+	case Tag::HistoryItems: return u"history items"_q;
+	case Tag::StreamingCache: return u"streaming cache"_q;
+	case Tag::kCount: break;
+	}
+	Unexpected("Tag in Core::MemoryStats::TagName.");
+}
+
+[[nodiscard]] QString FormatBytes(int64 bytes) {
+	return QString::number(bytes / (1024. * 1024.), 'f', 1) + " MB";
+}
+
+} // namespace
+
+void Add(Tag tag, int64 bytes) {
+	auto &counters = CountersFor(tag);
+	counters.objects.fetch_add(1, std::memory_order_relaxed);
+	counters.bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void Remove(Tag tag, int64 bytes) {
+	auto &counters = CountersFor(tag);
+	counters.objects.fetch_sub(1, std::memory_order_relaxed);
+	counters.bytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void Resize(Tag tag, int64 delta) {
+	CountersFor(tag).bytes.fetch_add(delta, std::memory_order_relaxed);
+}
+
+Counter::Counter(Tag tag) : _tag(tag) {
+	Add(_tag);
+}
+
+Counter::Counter(Counter &&other) noexcept
+: _tag(other._tag)
+, _bytes(base::take(other._bytes)) {
+	Add(_tag);
+}
+
+Counter &Counter::operator=(Counter &&other) noexcept {
+	Expects(_tag == other._tag);
+
+	if (this != &other) {
+		set(0);
+		_bytes = base::take(other._bytes);
+	}
+	return *this;
+}
+
+Counter::~Counter() {
+	Remove(_tag, _bytes);
+}
+
+void Counter::set(int64 bytes) {
+	Resize(_tag, bytes - _bytes);
+	_bytes = bytes;
+}
+
+QString Summary(bool detailed) {
+	auto result = QStringList();
+	for (auto i = 0; i != kTagsCount; ++i) {
+		const auto tag = Tag(i);
+		const auto &counters = CountersFor(tag);
+		const auto bytes = counters.bytes.load(std::memory_order_relaxed);
+		result.push_back(TagName(tag)
+			+ ": " + QString::number(counters.objects.load())
+			+ (bytes ? (", " + FormatBytes(bytes)) : QString()));
+	}
+	result.push_back("images: " + FormatBytes(Image::ResidentBytes()));
+
+	const auto allocator = Platform::AllocatorStats(detailed);
+	if (!allocator.isEmpty()) {
+		result.push_back(allocator);
+	}
+	return result.join(detailed ? u"\n"_q : u"; "_q);
+}
+
+bool DumpToFile(const QString &path) {
+	auto file = QFile(path);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		LOG(("Memory Stats Error: Could not open '%1' for writing."
+			).arg(path));
+		return false;
+	}
+	file.write(Summary(true).toUtf8());
+	file.write("\n");
+	return true;
+}
+
+void SetLogging(bool enabled) {
+	if (!enabled) {
+		LogTimer = nullptr;
+		return;
+	} else if (LogTimer) {
+		return;
+	}
+	const auto log = [] {
+		LOG(("Memory: %1").arg(Summary(false)));
+	};
+	LogTimer = std::make_unique<base::Timer>(log);
+	LogTimer->callEach(kLogTimeout);
+	log();
+}
+
+bool Logging() {
+	return (LogTimer != nullptr);
+}
+
+} // namespace Core::MemoryStats
@@ -0,0 +1,48 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Core::MemoryStats {
+
+// Objects and bytes held by the subsystems that usually grow in long
+// running sessions. Can be updated from any thread.
+enum class Tag : uchar {
+	HistoryItems,
+	StreamingCache,
+
+	kCount,
+};
+
+void Add(Tag tag, int64 bytes = 0);
+void Remove(Tag tag, int64 bytes = 0);
+void Resize(Tag tag, int64 delta);
+
+// Counts one object of a movable value type and the bytes it holds.
+class Counter final {
+public:
+	explicit Counter(Tag tag);
+	Counter(Counter &&other) noexcept;
+	Counter &operator=(Counter &&other) noexcept;
+	~Counter();
+
+	void set(int64 bytes);
+
+private:
+	Tag _tag = Tag::kCount;
+	int64 _bytes = 0;
+
+};
+
+[[nodiscard]] QString Summary(bool detailed);
+bool DumpToFile(const QString &path);
+
+// Writes a short summary to the log every few minutes.
+void SetLogging(bool enabled);
+[[nodiscard]] bool Logging();
+
+} // namespace Core::MemoryStats
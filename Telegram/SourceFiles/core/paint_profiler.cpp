@@ -0,0 +1,150 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/paint_profiler.h"
+
+#include "base/timer.h"
+#include "ui/rp_widget.h"
+#include "styles/style_basic.h"
+
+#include <QtCore/QFile>
+
+namespace Core::PaintProfiler {
+namespace {
+
+constexpr auto kSamplesCount = 512;
+constexpr auto kOverlayRefreshTimeout = crl::time(1000);
+constexpr auto kOverlayPadding = 8;
+
+struct Samples {
+	std::array<crl::profile_time, kSamplesCount> values = { { 0 } };
+	int count = 0;
+	int next = 0;
+	int64 total = 0;
+};
+
+bool EnabledValue = false;
+std::map<std::string_view, Samples> SamplesByName;
+base::unique_qptr<Ui::RpWidget> Overlay;
+
+[[nodiscard]] crl::profile_time Percentile(
+		std::vector<crl::profile_time> &sorted,
+		int percent) {
+	const auto index = (int(sorted.size()) - 1) * percent / 100;
+	return sorted[index];
+}
+
+[[nodiscard]] QString FormatTime(crl::profile_time value) {
+	return QString::number(value / 1000., 'f', 2) + " ms";
+}
+
+void SetupOverlay(not_null<Ui::RpWidget*> overlay) {
+	const auto lines = overlay->lifetime().make_state<QStringList>();
+	const auto refresh = [=] {
+		*lines = Summary().split('\n', Qt::SkipEmptyParts);
+		const auto &font = st::normalFont;
+		auto width = 0;
+		for (const auto &line : *lines) {
+			width = std::max(width, font->width(line));
+		}
+		const auto size = QSize(width, font->height * int(lines->size()))
+			+ QSize(kOverlayPadding, kOverlayPadding) * 2;
+		const auto parent = overlay->parentWidget();
+		overlay->setGeometry(
+			QRect(QPoint(parent->width() - size.width(), 0), size));
+		overlay->update();
+	};
+	const auto timer = overlay->lifetime().make_state<base::Timer>(refresh);
+	timer->callEach(kOverlayRefreshTimeout);
+
+	overlay->setAttribute(Qt::WA_TransparentForMouseEvents);
+	overlay->paintRequest(
+	) | rpl::start_with_next([=] {
+		const auto &font = st::normalFont;
+		auto p = QPainter(overlay);
+		p.fillRect(overlay->rect(), QColor(0, 0, 0, 192));
+		p.setFont(font);
+		p.setPen(Qt::white);
+		auto top = kOverlayPadding;
+		for (const auto &line : *lines) {
+			p.drawText(kOverlayPadding, top + font->ascent, line);
+			top += font->height;
+		}
+	}, overlay->lifetime());
+
+	refresh();
+	overlay->show();
+	overlay->raise();
+}
+
+} // namespace
+
+void SetEnabled(bool enabled) {
+	EnabledValue = enabled;
+	if (!enabled) {
+		SamplesByName.clear();
+		Overlay = nullptr;
+	}
+}
+
+bool Enabled() {
+	return EnabledValue;
+}
+
+void ShowOverlay(not_null<QWidget*> parent) {
+	if (!EnabledValue) {
+		return;
+	}
+	Overlay = base::make_unique_q<Ui::RpWidget>(parent.get());
+	SetupOverlay(Overlay.get());
+}
+
+void Record(const char *name, crl::profile_time duration) {
+	auto &samples = SamplesByName[name];
+	if (samples.count == kSamplesCount) {
+		samples.total -= samples.values[samples.next];
+	} else {
+		++samples.count;
+	}
+	samples.values[samples.next] = duration;
+	samples.total += duration;
+	samples.next = (samples.next + 1) % kSamplesCount;
+}
+
+QString Summary() {
+	auto result = QStringList();
+	auto sorted = std::vector<crl::profile_time>();
+	for (const auto &[name, samples] : SamplesByName) {
+		if (!samples.count) {
+			continue;
+		}
+		sorted.assign(
+			begin(samples.values),
+			begin(samples.values) + samples.count);
+		ranges::sort(sorted);
+		result.push_back(QString::fromLatin1(name.data(), name.size())
+			+ ": p50 " + FormatTime(Percentile(sorted, 50))
+			+ ", p99 " + FormatTime(Percentile(sorted, 99))
+			+ ", avg " + FormatTime(samples.total / samples.count)
+			+ " (" + QString::number(samples.count) + ")");
+	}
+	return result.join('\n');
+}
+
+bool DumpToFile(const QString &path) {
+	auto file = QFile(path);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		LOG(("Paint Profiler Error: Could not open '%1' for writing."
+			).arg(path));
+		return false;
+	}
+	file.write(Summary().toUtf8());
+	file.write("\n");
+	return true;
+}
+
+} // namespace Core::PaintProfiler
@@ -0,0 +1,50 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Core::PaintProfiler {
+
+// Collects paint durations of the named sections while enabled and
+// shows rolling p50 / p99 values of them in an overlay.
+void SetEnabled(bool enabled);
+[[nodiscard]] bool Enabled();
+
+void ShowOverlay(not_null<QWidget*> parent);
+
+void Record(const char *name, crl::profile_time duration);
+
+[[nodiscard]] QString Summary();
+bool DumpToFile(const QString &path);
+
+class Scope final {
+public:
+	explicit Scope(const char *name)
+	: _name(Enabled() ? name : nullptr)
+	, _started(_name ? crl::profile() : 0) {
+	}
+	template <
+		typename Name,
+		typename = std::enable_if_t<std::is_invocable_v<Name>>>
+	explicit Scope(Name &&name)
+	: Scope(Enabled() ? name() : nullptr) {
+	}
+	Scope(const Scope &other) = delete;
+	Scope &operator=(const Scope &other) = delete;
+	~Scope() {
+		if (_name) {
+			Record(_name, crl::profile() - _started);
+		}
+	}
+
+private:
+	const char *_name = nullptr;
+	crl::profile_time _started = 0;
+
+};
+
+} // namespace Core::PaintProfiler
@@ -0,0 +1,108 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/rpl_profiler.h"
+
+#include <QtCore/QFile>
+
+#include <deque>
+#include <mutex>
+
+namespace Core::RplProfiler {
+namespace {
+
+constexpr auto kSummaryLimit = 50;
+
+struct Entry {
+	explicit Entry(const QByteArray &name) : name(name) {
+	}
+
+	QByteArray name;
+	std::atomic<int64> events = 0;
+};
+
+std::mutex Mutex;
+std::deque<Entry> Entries;
+base::flat_map<QByteArray, not_null<Entry*>> EntryByName;
+crl::time Started = 0;
+
+} // namespace
+
+not_null<std::atomic<int64>*> Register(const QByteArray &name) {
+	const auto lock = std::lock_guard<std::mutex>(Mutex);
+	if (!Started) {
+		Started = crl::now();
+	}
+	const auto i = EntryByName.find(name);
+	if (i != end(EntryByName)) {
+		return &i->second->events;
+	}
+	const auto entry = &Entries.emplace_back(name);
+	EntryByName.emplace(name, entry);
+	return &entry->events;
+}
+
+QString Summary() {
+	auto counts = std::vector<std::pair<int64, QByteArray>>();
+	auto started = crl::time(0);
+	{
+		const auto lock = std::lock_guard<std::mutex>(Mutex);
+		started = Started;
+		counts.reserve(Entries.size());
+		for (const auto &entry : Entries) {
+			const auto events = entry.events.load(std::memory_order_relaxed);
+			if (events > 0) {
+				counts.emplace_back(events, entry.name);
+			}
+		}
+	}
+	ranges::sort(counts, ranges::greater());
+
+	const auto seconds = started
+		? std::max((crl::now() - started) / 1000., 1.)
+		: 1.;
+	auto total = int64(0);
+	for (const auto &[events, name] : counts) {
+		total += events;
+	}
+	auto result = QStringList();
+	result.push_back(QString("%1 events in %2 sites during %3 s."
+		).arg(total
+		).arg(counts.size()
+		).arg(int64(seconds)));
+	const auto till = std::min(int(counts.size()), kSummaryLimit);
+	for (auto i = 0; i != till; ++i) {
+		const auto &[events, name] = counts[i];
+		result.push_back(QString("%1: %2 (%3 / s)"
+			).arg(QString::fromLatin1(name)
+			).arg(events
+			).arg(events / seconds, 0, 'f', 1));
+	}
+	return result.join('\n');
+}
+
+bool DumpToFile(const QString &path) {
+	auto file = QFile(path);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		LOG(("Rpl Profiler Error: Could not open '%1' for writing."
+			).arg(path));
+		return false;
+	}
+	file.write(Summary().toUtf8());
+	file.write("\n");
+	return true;
+}
+
+void Reset() {
+	const auto lock = std::lock_guard<std::mutex>(Mutex);
+	for (auto &entry : Entries) {
+		entry.events.store(0, std::memory_order_relaxed);
+	}
+	Started = crl::now();
+}
+
+} // namespace Core::RplProfiler
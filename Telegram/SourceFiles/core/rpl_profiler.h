@@ -0,0 +1,49 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <atomic>
+
+namespace Core::RplProfiler {
+
+// Counts the events passing through the named rpl chains, to find the
+// subscriptions that fire too often. The counting is compiled in only
+// with TDESKTOP_RPL_PROFILING, otherwise Site() returns the producer.
+[[nodiscard]] constexpr bool Enabled() {
+#ifdef TDESKTOP_RPL_PROFILING
+	return true;
+#else // TDESKTOP_RPL_PROFILING
+	return false;
+#endif // TDESKTOP_RPL_PROFILING
+}
+
+[[nodiscard]] not_null<std::atomic<int64>*> Register(const QByteArray &name);
+
+[[nodiscard]] QString Summary();
+bool DumpToFile(const QString &path);
+void Reset();
+
+// Usage: producer | Core::RplProfiler::Site("Dialogs/Names") | ...
+// Each subscriber marks its own chain, so the counts are per site.
+[[nodiscard]] inline auto Site(const char *name) {
+#ifdef TDESKTOP_RPL_PROFILING
+	return [counter = Register(name)](auto &&initial) {
+		return std::forward<decltype(initial)>(
+			initial
+		) | rpl::before_next([=] {
+			counter->fetch_add(1, std::memory_order_relaxed);
+		});
+	};
+#else // TDESKTOP_RPL_PROFILING
+	return [](auto &&initial) {
+		return std::forward<decltype(initial)>(initial);
+	};
+#endif // TDESKTOP_RPL_PROFILING
+}
+
+} // namespace Core::RplProfiler
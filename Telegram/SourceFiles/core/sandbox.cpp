@@ -19,6 +19,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/launcher.h"
 #include "core/local_url_handlers.h"
 #include "core/update_checker.h"
+#include "core/freeze_watchdog.h"
 #include "base/timer.h"
 #include "base/concurrent_timer.h"
 #include "base/invoke_queued.h"
@@ -183,6 +184,7 @@ int Sandbox::start() {
 		return 0;
 	}
 	_started = true;
+	_freezeWatchdog = std::make_unique<FreezeWatchdog>();
 	return exec();
 }
 
@@ -593,6 +595,9 @@ bool Sandbox::notify(QObject *receiver, QEvent *e) {
 	}
 
 	const auto wrap = createEventNestingLevel();
+	const auto task = Logs::TaskScope(
+		receiver->metaObject()->className(),
+		int(e->type()));
 	if (e->type() == QEvent::UpdateRequest) {
 		const auto weak = QPointer<QObject>(receiver);
 		_widgetUpdateRequests.fire({});
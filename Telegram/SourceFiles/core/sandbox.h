@@ -22,6 +22,7 @@ namespace Core {
 class Launcher;
 class UpdateChecker;
 class Application;
+class FreezeWatchdog;
 
 class Sandbox final
 	: public QApplication
@@ -133,6 +134,8 @@ private:
 
 	rpl::event_stream<> _widgetUpdateRequests;
 
+	std::unique_ptr<FreezeWatchdog> _freezeWatchdog;
+
 };
 
 } // namespace Core
@@ -0,0 +1,174 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/soak_test.h"
+
+#include "core/application.h"
+#include "core/memory_stats.h"
+#include "data/data_session.h"
+#include "data/stickers/data_stickers.h"
+#include "dialogs/dialogs_indexed_list.h"
+#include "dialogs/dialogs_main_list.h"
+#include "history/history.h"
+#include "info/info_memento.h"
+#include "main/main_account.h"
+#include "main/main_domain.h"
+#include "main/main_session.h"
+#include "window/window_controller.h"
+#include "window/window_session_controller.h"
+
+#include <QtCore/QFile>
+
+namespace Core {
+namespace {
+
+constexpr auto kStepTimeout = 3 * crl::time(1000);
+constexpr auto kSampleTimeout = 60 * crl::time(1000);
+
+constexpr auto kMediaTypes = std::array{
+	Storage::SharedMediaType::PhotoVideo,
+	Storage::SharedMediaType::GIF,
+	Storage::SharedMediaType::File,
+	Storage::SharedMediaType::Link,
+};
+
+enum class Step {
+	OpenChat,
+	SharedMedia,
+	PlayGif,
+	SwitchAccount,
+
+	kCount,
+};
+
+QString ReportPath;
+
+} // namespace
+
+SoakTest::SoakTest()
+: _stepTimer([=] { step(); })
+, _sampleTimer([=] { sample(); })
+, _started(crl::now()) {
+	Expects(Enabled());
+
+	auto file = QFile(ReportPath);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		LOG(("Soak Test Error: Could not open '%1' for writing."
+			).arg(ReportPath));
+	}
+	sample();
+	_stepTimer.callEach(kStepTimeout);
+	_sampleTimer.callEach(kSampleTimeout);
+}
+
+void SoakTest::SetReportPath(const QString &path) {
+	ReportPath = path;
+}
+
+bool SoakTest::Enabled() {
+	return !ReportPath.isEmpty();
+}
+
+void SoakTest::step() {
+	const auto window = Core::App().activeWindow();
+	const auto controller = window ? window->sessionController() : nullptr;
+	if (!controller) {
+		return;
+	}
+	Core::App().hideMediaView();
+
+	switch (Step(_steps++ % int(Step::kCount))) {
+	case Step::OpenChat: openChat(controller); break;
+	case Step::SharedMedia: openSharedMedia(controller); break;
+	case Step::PlayGif: playGif(controller); break;
+	case Step::SwitchAccount: switchAccount(); break;
+	case Step::kCount: Unexpected("Step in SoakTest::step.");
+	}
+}
+
+void SoakTest::openChat(not_null<Window::SessionController*> controller) {
+	const auto list = controller->session().data().chatsList()->indexed();
+	if (list->empty()) {
+		return;
+	}
+	const auto index = (_chatIndex++) % list->size();
+	if (const auto history = (*(list->begin() + index))->history()) {
+		controller->showPeerHistory(
+			history->peer,
+			Window::SectionShow::Way::ClearStack,
+			ShowAtUnreadMsgId);
+	}
+}
+
+void SoakTest::openSharedMedia(
+		not_null<Window::SessionController*> controller) {
+	const auto peer = controller->activeChatCurrent().peer();
+	if (!peer) {
+		return;
+	}
+	const auto type = kMediaTypes[(_mediaIndex++) % kMediaTypes.size()];
+	controller->showSection(
+		std::make_shared<Info::Memento>(peer, Info::Section(type)));
+}
+
+void SoakTest::playGif(not_null<Window::SessionController*> controller) {
+	const auto &gifs = controller->session().data().stickers().savedGifs();
+	if (gifs.isEmpty()) {
+		return;
+	}
+	const auto document = gifs[(_gifIndex++) % gifs.size()];
+	controller->openDocument(document, FullMsgId(), true);
+}
+
+void SoakTest::switchAccount() {
+	auto &domain = Core::App().domain();
+	const auto &accounts = domain.accounts();
+	const auto active = ranges::find(
+		accounts,
+		&domain.active(),
+		[](const Main::Domain::AccountWithIndex &value) {
+			return value.account.get();
+		});
+	if (active == end(accounts)) {
+		return;
+	}
+	const auto count = int(accounts.size());
+	const auto from = int(active - begin(accounts));
+	for (auto i = 1; i != count; ++i) {
+		const auto &entry = accounts[(from + i) % count];
+		if (entry.account->sessionExists()) {
+			domain.activate(entry.account.get());
+			return;
+		}
+	}
+}
+
+void SoakTest::sample() {
+	const auto minutes = (crl::now() - _started) / kSampleTimeout;
+	auto sessions = QStringList();
+	for (const auto &[index, account] : Core::App().domain().accounts()) {
+		if (account->sessionExists()) {
+			sessions.push_back(u"account %1: %2"_q
+				.arg(index)
+				.arg(account->session().data().debugStats()));
+		}
+	}
+	write(u"%1 min; %2; %3"_q
+		.arg(minutes)
+		.arg(MemoryStats::Summary(false))
+		.arg(sessions.join(u"; "_q)));
+}
+
+void SoakTest::write(const QString &line) {
+	auto file = QFile(ReportPath);
+	if (file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+		file.write(line.toUtf8());
+		file.write("\n");
+	}
+}
+
+} // namespace Core
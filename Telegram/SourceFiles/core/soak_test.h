@@ -0,0 +1,48 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/timer.h"
+
+namespace Window {
+class SessionController;
+} // namespace Window
+
+namespace Core {
+
+// Enabled with -soak <report path>. Cycles through opening chats,
+// shared media, GIFs and accounts for as long as the app is running
+// and appends the memory stats to the report once a minute.
+class SoakTest final {
+public:
+	SoakTest();
+
+	static void SetReportPath(const QString &path);
+	[[nodiscard]] static bool Enabled();
+
+private:
+	void step();
+	void openChat(not_null<Window::SessionController*> controller);
+	void openSharedMedia(not_null<Window::SessionController*> controller);
+	void playGif(not_null<Window::SessionController*> controller);
+	void switchAccount();
+
+	void sample();
+	void write(const QString &line);
+
+	base::Timer _stepTimer;
+	base::Timer _sampleTimer;
+	crl::time _started = 0;
+	int _steps = 0;
+	int _chatIndex = 0;
+	int _mediaIndex = 0;
+	int _gifIndex = 0;
+
+};
+
+} // namespace Core
@@ -0,0 +1,64 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/startup_timeline.h"
+
+#include <QtCore/QFile>
+
+namespace Core::StartupTimeline {
+namespace {
+
+struct Phase {
+	const char *name = nullptr;
+	crl::time when = 0;
+};
+
+std::vector<Phase> Phases;
+QString OutputPath;
+bool Finished = false;
+
+} // namespace
+
+void SetOutputPath(const QString &path) {
+	OutputPath = path;
+}
+
+void Mark(const char *phase) {
+	if (!Finished) {
+		Phases.push_back({ phase, crl::now() });
+	}
+}
+
+void Finish() {
+	if (Finished || Phases.empty()) {
+		return;
+	}
+	Mark("chats painted");
+	Finished = true;
+
+	const auto started = Phases.front().when;
+	auto lines = QStringList();
+	for (const auto &phase : base::take(Phases)) {
+		const auto ms = phase.when - started;
+		LOG(("Startup Info: %1 at %2 ms.").arg(phase.name).arg(ms));
+		lines.push_back(QString::fromUtf8(phase.name)
+			+ '\t'
+			+ QString::number(ms));
+	}
+	if (OutputPath.isEmpty()) {
+		return;
+	}
+	auto file = QFile(OutputPath);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		LOG(("Startup Error: Could not write timeline to '%1'."
+			).arg(OutputPath));
+		return;
+	}
+	file.write((lines.join('\n') + '\n').toUtf8());
+}
+
+} // namespace Core::StartupTimeline
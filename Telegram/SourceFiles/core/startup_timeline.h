@@ -0,0 +1,20 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Core::StartupTimeline {
+
+// Timestamps of the cold start phases, counted from the first mark.
+// They are logged when the chat list is painted for the first time and
+// written to the path passed with -startup-timeline. Main thread only.
+void SetOutputPath(const QString &path);
+
+void Mark(const char *phase);
+void Finish();
+
+} // namespace Core::StartupTimeline
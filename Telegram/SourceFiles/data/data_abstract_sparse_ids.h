@@ -34,7 +34,13 @@ public:
 		return _skippedAfter;
 	}
 	std::optional<int> indexOf(Id id) const {
-		const auto it = ranges::find(_ids, id);
+		const auto it = [&] {
+			if constexpr (kSorted) {
+				return _ids.find(id);
+			} else {
+				return ranges::find(_ids, id);
+			}
+		}();
 		if (it != _ids.end()) {
 			return (it - _ids.begin());
 		}
@@ -70,6 +76,10 @@ public:
 	}
 
 private:
+	static constexpr auto kSorted = std::is_same_v<
+		IdsContainer,
+		base::flat_set<Id>>;
+
 	IdsContainer _ids;
 	std::optional<int> _fullCount;
 	std::optional<int> _skippedBefore;
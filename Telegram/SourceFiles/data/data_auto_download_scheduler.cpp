@@ -0,0 +1,61 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "data/data_auto_download_scheduler.h"
+
+#include "data/data_session.h"
+#include "history/history_item.h"
+
+namespace Data {
+namespace {
+
+constexpr auto kFastScrollVelocity = 2.5;
+constexpr auto kSettleDelay = crl::time(150);
+
+} // namespace
+
+AutoDownloadScheduler::AutoDownloadScheduler(not_null<Session*> owner)
+: _owner(owner)
+, _settleTimer([=] { settled(); }) {
+}
+
+void AutoDownloadScheduler::scrolled(not_null<const void*> list, int top) {
+	const auto now = crl::now();
+	const auto elapsed = now - _time;
+	if (_list != list || elapsed > kSettleDelay) {
+		_velocity = 0.;
+	} else {
+		const auto distance = float64(std::abs(top - _top));
+		const auto current = distance / std::max(elapsed, crl::time(1));
+		_velocity = (_velocity + current) / 2.;
+	}
+	_list = list;
+	_top = top;
+	_time = now;
+	if (_velocity > kFastScrollVelocity) {
+		_settleTimer.callOnce(kSettleDelay);
+	}
+}
+
+bool AutoDownloadScheduler::allow(not_null<const HistoryItem*> item) {
+	if (!_settleTimer.isActive()) {
+		return true;
+	}
+	_delayed.emplace(item->fullId());
+	return false;
+}
+
+void AutoDownloadScheduler::settled() {
+	_velocity = 0.;
+	for (const auto &itemId : base::take(_delayed)) {
+		if (const auto item = _owner->message(itemId)) {
+			_owner->requestItemRepaint(item);
+		}
+	}
+}
+
+} // namespace Data
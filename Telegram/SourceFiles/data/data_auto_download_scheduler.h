@@ -0,0 +1,44 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/timer.h"
+
+class HistoryItem;
+
+namespace Data {
+
+class Session;
+
+// Holds back automatic downloads of the media that is flung past
+// the viewport. The delayed items are repainted when the scroll slows
+// down, so only the ones that are still visible start loading.
+class AutoDownloadScheduler final {
+public:
+	explicit AutoDownloadScheduler(not_null<Session*> owner);
+
+	void scrolled(not_null<const void*> list, int top);
+
+	[[nodiscard]] bool allow(not_null<const HistoryItem*> item);
+
+private:
+	void settled();
+
+	const not_null<Session*> _owner;
+
+	const void *_list = nullptr;
+	int _top = 0;
+	crl::time _time = 0;
+	float64 _velocity = 0.; // Pixels per millisecond.
+
+	base::flat_set<FullMsgId> _delayed;
+	base::Timer _settleTimer;
+
+};
+
+} // namespace Data
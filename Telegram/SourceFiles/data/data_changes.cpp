@@ -10,6 +10,11 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "main/main_session.h"
 
 namespace Data {
+namespace {
+
+constexpr auto kFrameDuration = crl::time(16);
+
+} // namespace
 
 template <typename DataType, typename UpdateType>
 void Changes::Manager<DataType, UpdateType>::updated(
@@ -24,8 +29,21 @@ void Changes::Manager<DataType, UpdateType>::updated(
 			_updates.erase(i);
 		}
 		_stream.fire({ data, flags });
+
+		// Don't keep the pointer in the framed updates, it may be dead.
+		const auto j = _framedUpdates.find(data);
+		if (j != _framedUpdates.end()) {
+			flags |= j->second;
+			_framedUpdates.erase(j);
+		}
+		_framedStream.fire({ data, flags });
 	} else {
-		_updates[data] |= flags;
+		++_stats.scheduled;
+		auto &scheduled = _updates[data];
+		if (scheduled) {
+			++_stats.merged;
+		}
+		scheduled |= flags;
 	}
 }
 
@@ -77,13 +95,43 @@ rpl::producer<UpdateType> Changes::Manager<DataType, UpdateType>::flagsValue(
 }
 
 template <typename DataType, typename UpdateType>
-void Changes::Manager<DataType, UpdateType>::sendNotifications() {
+rpl::producer<UpdateType> Changes::Manager<DataType, UpdateType>::framedUpdates(
+		Flags flags) const {
+	return _framedStream.events(
+	) | rpl::filter([=](const UpdateType &update) {
+		return (update.flags & flags);
+	});
+}
+
+template <typename DataType, typename UpdateType>
+bool Changes::Manager<DataType, UpdateType>::sendNotifications() {
 	for (const auto &[data, flags] : base::take(_updates)) {
 		_stream.fire({ data, flags });
+
+		auto &framed = _framedUpdates[data];
+		if (framed) {
+			++_stats.framedMerged;
+		}
+		framed |= flags;
+	}
+	return !_framedUpdates.empty();
+}
+
+template <typename DataType, typename UpdateType>
+void Changes::Manager<DataType, UpdateType>::sendFramedNotifications() {
+	for (const auto &[data, flags] : base::take(_framedUpdates)) {
+		_framedStream.fire({ data, flags });
 	}
 }
 
-Changes::Changes(not_null<Main::Session*> session) : _session(session) {
+Changes::Changes(not_null<Main::Session*> session)
+: _session(session)
+, _framedTimer([=] {
+	_peerChanges.sendFramedNotifications();
+	_historyChanges.sendFramedNotifications();
+	_messageChanges.sendFramedNotifications();
+	_entryChanges.sendFramedNotifications();
+}) {
 }
 
 Main::Session &Changes::session() const {
@@ -134,6 +182,11 @@ rpl::producer<PeerUpdate> Changes::realtimePeerUpdates(
 	return _peerChanges.realtimeUpdates(flag);
 }
 
+rpl::producer<PeerUpdate> Changes::framedPeerUpdates(
+		PeerUpdate::Flags flags) const {
+	return _peerChanges.framedUpdates(flags);
+}
+
 void Changes::historyUpdated(
 		not_null<History*> history,
 		HistoryUpdate::Flags flags) {
@@ -163,6 +216,11 @@ rpl::producer<HistoryUpdate> Changes::realtimeHistoryUpdates(
 	return _historyChanges.realtimeUpdates(flag);
 }
 
+rpl::producer<HistoryUpdate> Changes::framedHistoryUpdates(
+		HistoryUpdate::Flags flags) const {
+	return _historyChanges.framedUpdates(flags);
+}
+
 void Changes::messageUpdated(
 		not_null<HistoryItem*> item,
 		MessageUpdate::Flags flags) {
@@ -195,6 +253,11 @@ rpl::producer<MessageUpdate> Changes::realtimeMessageUpdates(
 	return _messageChanges.realtimeUpdates(flag);
 }
 
+rpl::producer<MessageUpdate> Changes::framedMessageUpdates(
+		MessageUpdate::Flags flags) const {
+	return _messageChanges.framedUpdates(flags);
+}
+
 void Changes::entryUpdated(
 		not_null<Dialogs::Entry*> entry,
 		EntryUpdate::Flags flags) {
@@ -225,7 +288,9 @@ rpl::producer<EntryUpdate> Changes::realtimeEntryUpdates(
 }
 
 void Changes::scheduleNotifications() {
-	if (!_notify) {
+	if (_notificationsSuspended) {
+		_notifyAfterResume = true;
+	} else if (!_notify) {
 		_notify = true;
 		crl::on_main(&session(), [=] {
 			sendNotifications();
@@ -236,12 +301,39 @@ void Changes::scheduleNotifications() {
 void Changes::sendNotifications() {
 	if (!_notify) {
 		return;
+	} else if (_notificationsSuspended) {
+		_notify = false;
+		_notifyAfterResume = true;
+		return;
 	}
 	_notify = false;
-	_peerChanges.sendNotifications();
-	_historyChanges.sendNotifications();
-	_messageChanges.sendNotifications();
-	_entryChanges.sendNotifications();
+	auto framed = _peerChanges.sendNotifications();
+	framed |= _historyChanges.sendNotifications();
+	framed |= _messageChanges.sendNotifications();
+	framed |= _entryChanges.sendNotifications();
+	if (framed && !_framedTimer.isActive()) {
+		_framedTimer.callOnce(kFrameDuration);
+	}
+}
+
+ChangesStats Changes::stats() const {
+	auto result = _peerChanges.stats();
+	result += _historyChanges.stats();
+	result += _messageChanges.stats();
+	result += _entryChanges.stats();
+	return result;
+}
+
+void Changes::suspendNotifications() {
+	++_notificationsSuspended;
+}
+
+void Changes::resumeNotifications() {
+	Expects(_notificationsSuspended > 0);
+
+	if (!--_notificationsSuspended && base::take(_notifyAfterResume)) {
+		scheduleNotifications();
+	}
 }
 
 } // namespace Data
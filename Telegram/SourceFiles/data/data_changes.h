@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "base/flags.h"
+#include "base/timer.h"
 
 class History;
 class PeerData;
@@ -177,6 +178,19 @@ struct EntryUpdate {
 
 };
 
+struct ChangesStats {
+	int64 scheduled = 0;
+	int64 merged = 0;
+	int64 framedMerged = 0;
+
+	ChangesStats &operator+=(const ChangesStats &other) {
+		scheduled += other.scheduled;
+		merged += other.merged;
+		framedMerged += other.framedMerged;
+		return *this;
+	}
+};
+
 class Changes final {
 public:
 	explicit Changes(not_null<Main::Session*> session);
@@ -202,6 +216,11 @@ public:
 	[[nodiscard]] rpl::producer<PeerUpdate> realtimePeerUpdates(
 		PeerUpdate::Flag flag) const;
 
+	// Framed updates are merged by key for a whole paint frame, so that
+	// storms like online statuses in large groups wake subscribers once.
+	[[nodiscard]] rpl::producer<PeerUpdate> framedPeerUpdates(
+		PeerUpdate::Flags flags) const;
+
 	void historyUpdated(
 		not_null<History*> history,
 		HistoryUpdate::Flags flags);
@@ -215,6 +234,8 @@ public:
 		HistoryUpdate::Flags flags) const;
 	[[nodiscard]] rpl::producer<HistoryUpdate> realtimeHistoryUpdates(
 		HistoryUpdate::Flag flag) const;
+	[[nodiscard]] rpl::producer<HistoryUpdate> framedHistoryUpdates(
+		HistoryUpdate::Flags flags) const;
 
 	void messageUpdated(
 		not_null<HistoryItem*> item,
@@ -229,6 +250,8 @@ public:
 		MessageUpdate::Flags flags) const;
 	[[nodiscard]] rpl::producer<MessageUpdate> realtimeMessageUpdates(
 		MessageUpdate::Flag flag) const;
+	[[nodiscard]] rpl::producer<MessageUpdate> framedMessageUpdates(
+		MessageUpdate::Flags flags) const;
 
 	void entryUpdated(
 		not_null<Dialogs::Entry*> entry,
@@ -246,6 +269,13 @@ public:
 
 	void sendNotifications();
 
+	[[nodiscard]] ChangesStats stats() const;
+
+	// While suspended the scheduled notifications are only accumulated.
+	// They're sent as one coalesced set after the last resume.
+	void suspendNotifications();
+	void resumeNotifications();
+
 private:
 	template <typename DataType, typename UpdateType>
 	class Manager final {
@@ -266,8 +296,16 @@ private:
 			Flags flags) const;
 		[[nodiscard]] rpl::producer<UpdateType> realtimeUpdates(
 			Flag flag) const;
+		[[nodiscard]] rpl::producer<UpdateType> framedUpdates(
+			Flags flags) const;
+
+		// Returns true if some framed updates are waiting.
+		bool sendNotifications();
+		void sendFramedNotifications();
 
-		void sendNotifications();
+		[[nodiscard]] const ChangesStats &stats() const {
+			return _stats;
+		}
 
 	private:
 		static constexpr auto kCount = details::CountBit<Flag>();
@@ -277,6 +315,9 @@ private:
 		std::array<rpl::event_stream<UpdateType>, kCount> _realtimeStreams;
 		base::flat_map<not_null<DataType*>, Flags> _updates;
 		rpl::event_stream<UpdateType> _stream;
+		base::flat_map<not_null<DataType*>, Flags> _framedUpdates;
+		rpl::event_stream<UpdateType> _framedStream;
+		ChangesStats _stats;
 
 	};
 
@@ -290,6 +331,10 @@ private:
 	Manager<HistoryItem, MessageUpdate> _messageChanges;
 	Manager<Dialogs::Entry, EntryUpdate> _entryChanges;
 
+	base::Timer _framedTimer;
+
+	int _notificationsSuspended = 0;
+	bool _notifyAfterResume = false;
 	bool _notify = false;
 
 };
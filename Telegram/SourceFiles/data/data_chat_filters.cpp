@@ -30,6 +30,117 @@ constexpr auto kLoadExceptionsAfter = 100;
 constexpr auto kLoadExceptionsPerRequest = 100;
 constexpr auto kFiltersLimit = 10;
 
+// Everything of a history that the filter flags look at, packed in bits.
+constexpr auto kFlagsStateTypeMask = 0x07;
+constexpr auto kFlagsStateCreator = 0x08;
+constexpr auto kFlagsStateAdmin = 0x10;
+constexpr auto kFlagsStateRecent = 0x20;
+constexpr auto kFlagsStateMuted = 0x40;
+constexpr auto kFlagsStateMentionsInMain = 0x80;
+constexpr auto kFlagsStateUnread = 0x100;
+constexpr auto kFlagsStateInMain = 0x200;
+constexpr auto kFlagsStatesCount = 0x400;
+
+constexpr auto kFlagsStateTypes = std::array{
+	ChatFilter::Flag::Contacts,
+	ChatFilter::Flag::NonContacts,
+	ChatFilter::Flag::Groups,
+	ChatFilter::Flag::Channels,
+	ChatFilter::Flag::Bots,
+};
+
+[[nodiscard]] int FlagsState(not_null<History*> history, bool withRecent) {
+	using Flag = ChatFilter::Flag;
+	const auto peer = history->peer;
+	const auto type = [&] {
+		if (const auto user = peer->asUser()) {
+			return user->isBot()
+				? Flag::Bots
+				: user->isContact()
+				? Flag::Contacts
+				: Flag::NonContacts;
+		} else if (const auto chat = peer->asChat()) {
+			return Flag::Groups;
+		} else if (const auto channel = peer->asChannel()) {
+			if (channel->isBroadcast()) {
+				return Flag::Channels;
+			} else {
+				return Flag::Groups;
+			}
+		} else {
+			Unexpected("Peer type in ChatFilter::contains.");
+		}
+	}();
+	auto result = int(ranges::find(kFlagsStateTypes, type)
+		- begin(kFlagsStateTypes));
+	if (const auto chat = peer->asChat()) {
+		if (chat->amCreator()) {
+			result |= kFlagsStateCreator;
+		}
+		if (chat->hasAdminRights()) {
+			result |= kFlagsStateAdmin;
+		}
+	} else if (const auto channel = peer->asChannel()) {
+		if (channel->amCreator()) {
+			result |= kFlagsStateCreator;
+		}
+		if (channel->hasAdminRights()) {
+			result |= kFlagsStateAdmin;
+		}
+	}
+	if (withRecent
+		&& history->owner().session().account().isRecent(peer->id)) {
+		result |= kFlagsStateRecent;
+	}
+	if (history->mute()) {
+		result |= kFlagsStateMuted;
+	}
+	const auto inMain = history->folderKnown() && !history->folder();
+	if (history->hasUnreadMentions() && inMain) {
+		result |= kFlagsStateMentionsInMain;
+	}
+	if (history->unreadCount()
+		|| history->unreadMark()
+		|| history->hasUnreadMentions()
+		|| history->fakeUnreadWhileOpened()) {
+		result |= kFlagsStateUnread;
+	}
+	if (inMain) {
+		result |= kFlagsStateInMain;
+	}
+	return result;
+}
+
+// Checks the filter flags, except NoFilter, against a packed state.
+[[nodiscard]] bool FlagsMatch(ChatFilter::Flags flags, int state) {
+	using Flag = ChatFilter::Flag;
+	const auto type = kFlagsStateTypes[state & kFlagsStateTypeMask];
+	const auto filterAdmin = [&] {
+		if (!(flags & Flag::Owned)
+			&& !(flags & Flag::NotOwned)
+			&& !(flags & Flag::Admin)
+			&& !(flags & Flag::NotAdmin)) {
+			return true;
+		} else if (type != Flag::Groups && type != Flag::Channels) {
+			return false;
+		}
+		const auto creator = (state & kFlagsStateCreator) != 0;
+		const auto admin = (state & kFlagsStateAdmin) != 0;
+		return (creator && (flags & Flag::Owned) && !(flags & Flag::NotOwned))
+			|| (admin && (flags & Flag::Admin) && !(flags & Flag::NotAdmin))
+			|| (!creator && !(flags & Flag::Owned) && (flags & Flag::NotOwned))
+			|| (!admin && !(flags & Flag::Admin) && (flags & Flag::NotAdmin));
+	};
+	return (flags & type)
+		&& filterAdmin()
+		&& (!(flags & Flag::Recent) || (state & kFlagsStateRecent))
+		&& (!(flags & Flag::NoMuted)
+			|| !(state & kFlagsStateMuted)
+			|| (state & kFlagsStateMentionsInMain))
+		&& (!(flags & Flag::NoRead) || (state & kFlagsStateUnread))
+		&& (!(flags & Flag::NoArchived) || (state & kFlagsStateInMain));
+}
+
 } // namespace
 
 ChatFilter::ChatFilter(FilterId id, bool isLocal)
@@ -285,61 +396,17 @@ const base::flat_set<not_null<History*>> &ChatFilter::never() const {
 bool ChatFilter::contains(not_null<History*> history) const {
 	if (_never.contains(history)) {
 		return false;
+	} else if (_always.contains(history)) {
+		return true;
 	}
-	const auto flag = [&] {
-		const auto peer = history->peer;
-		if (const auto user = peer->asUser()) {
-			return user->isBot()
-				? Flag::Bots
-				: user->isContact()
-				? Flag::Contacts
-				: Flag::NonContacts;
-		} else if (const auto chat = peer->asChat()) {
-			return Flag::Groups;
-		} else if (const auto channel = peer->asChannel()) {
-			if (channel->isBroadcast()) {
-				return Flag::Channels;
-			} else {
-				return Flag::Groups;
-			}
-		} else {
-			Unexpected("Peer type in ChatFilter::contains.");
-		}
-	}();
-	const auto filterAdmin = [&] {
-		if (!(_flags & Flag::Owned)
-			&& !(_flags & Flag::NotOwned)
-			&& !(_flags & Flag::Admin)
-			&& !(_flags & Flag::NotAdmin)) {
-			return true;
-		}
-
-		const auto peer = history->peer;
-		if (const auto chat = peer->asChat()) {
-			if ((chat->amCreator() && (_flags & Flag::Owned) && !(_flags & Flag::NotOwned))
-				|| (chat->hasAdminRights() && (_flags & Flag::Admin) && !(_flags & Flag::NotAdmin))
-				|| (!chat->amCreator() && !(_flags & Flag::Owned) && (_flags & Flag::NotOwned))
-				|| (!chat->hasAdminRights() && !(_flags & Flag::Admin) && (_flags & Flag::NotAdmin))) {
-				return true;
-			}
-		} else if (const auto channel = peer->asChannel()) {
-			if ((channel->amCreator() && (_flags & Flag::Owned) && !(_flags & Flag::NotOwned))
-				|| (channel->hasAdminRights() && (_flags & Flag::Admin) && !(_flags & Flag::NotAdmin))
-				|| (!channel->amCreator() && !(_flags & Flag::Owned) && (_flags & Flag::NotOwned))
-				|| (!channel->hasAdminRights() && !(_flags & Flag::Admin) && (_flags & Flag::NotAdmin))) {
-				return true;
-			}
-		}
-
-		return false;
-	};
+	const auto state = FlagsState(history, !!(_flags & Flag::Recent));
 	const auto filterUnfiltered = [&] {
 		if (!(_flags & Flag::NoFilter)) {
 			return true;
 		}
 
 		const auto &list = history->owner().chatsFilters().list();
-		for (auto filter : list) {
+		for (const auto &filter : list) {
 			if (filter.id() == _id) {
 				continue;
 			}
@@ -351,25 +418,7 @@ bool ChatFilter::contains(not_null<History*> history) const {
 
 		return true;
 	};
-	return false
-		|| ((_flags & flag)
-			&& filterAdmin()
-			&& (!(_flags & Flag::Recent)
-				|| history->owner().session().account().isRecent(history->peer->id))
-			&& (!(_flags & Flag::NoMuted)
-				|| !history->mute()
-				|| (history->hasUnreadMentions()
-					&& history->folderKnown()
-					&& !history->folder()))
-			&& (!(_flags & Flag::NoRead)
-				|| history->unreadCount()
-				|| history->unreadMark()
-				|| history->hasUnreadMentions()
-				|| history->fakeUnreadWhileOpened())
-			&& (!(_flags & Flag::NoArchived)
-				|| (history->folderKnown() && !history->folder()))
-			&& filterUnfiltered())
-		|| _always.contains(history);
+	return FlagsMatch(_flags, state) && filterUnfiltered();
 }
 
 bool ChatFilter::isLocal() const {
@@ -786,6 +835,60 @@ bool ChatFilters::loadNextExceptions(bool chatsListLoaded) {
 	return true;
 }
 
+std::vector<bool> ChatFilters::membership(
+		not_null<History*> history) const {
+	using Flag = ChatFilter::Flag;
+	const auto withRecent = ranges::any_of(_list, [](const ChatFilter &f) {
+		return !!(f.flags() & Flag::Recent);
+	});
+	const auto state = FlagsState(history, withRecent);
+	const auto matches = [&](ChatFilter::Flags flags) {
+		auto &table = _flagsMatches[flags.value()];
+		if (table.empty()) {
+			table.resize(kFlagsStatesCount);
+		}
+		auto &cached = table[state];
+		if (!cached) {
+			cached = FlagsMatch(flags, state) ? 2 : 1;
+		}
+		return (cached == 2);
+	};
+
+	auto result = std::vector<bool>(_list.size());
+	auto always = std::vector<bool>(_list.size());
+	auto noFilter = false;
+	for (auto i = 0, count = int(_list.size()); i != count; ++i) {
+		const auto &filter = _list[i];
+		if (filter.never().contains(history)) {
+			continue;
+		} else if (filter.always().contains(history)) {
+			result[i] = always[i] = true;
+		} else if (matches(filter.flags())) {
+			result[i] = true;
+			if (filter.flags() & Flag::NoFilter) {
+				noFilter = true;
+			}
+		}
+	}
+	if (noFilter) {
+		const auto matched = result;
+		for (auto i = 0, count = int(_list.size()); i != count; ++i) {
+			if (!matched[i]
+				|| always[i]
+				|| !(_list[i].flags() & Flag::NoFilter)) {
+				continue;
+			}
+			for (auto j = 0; j != count; ++j) {
+				if (j != i && matched[j]) {
+					result[i] = false;
+					break;
+				}
+			}
+		}
+	}
+	return result;
+}
+
 void ChatFilters::refreshHistory(not_null<History*> history) {
 	if (history->inChatList() && !list().empty()) {
 		_owner->refreshChatListEntry(history);
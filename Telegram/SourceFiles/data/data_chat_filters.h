@@ -128,6 +128,11 @@ public:
 
 	bool loadNextExceptions(bool chatsListLoaded);
 
+	// Whether each filter of list() contains the history, in list() order.
+	// Evaluation of the filter flags is memoized by their values.
+	[[nodiscard]] std::vector<bool> membership(
+		not_null<History*> history) const;
+
 	void refreshHistory(not_null<History*> history);
 
 	[[nodiscard]] not_null<Dialogs::MainList*> chatsList(FilterId filterId);
@@ -160,6 +165,7 @@ private:
 	const not_null<Session*> _owner;
 
 	std::vector<ChatFilter> _list;
+	mutable base::flat_map<ushort, std::vector<uint8>> _flagsMatches;
 	base::flat_map<FilterId, std::unique_ptr<Dialogs::MainList>> _chatsLists;
 	rpl::event_stream<> _listChanged;
 	mtpRequestId _loadRequestId = 0;
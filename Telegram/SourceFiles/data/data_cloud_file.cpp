@@ -13,8 +13,78 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/file_download.h"
 #include "ui/image/image.h"
 #include "main/main_session.h"
+#include "kotato/settings.h"
 
 namespace Data {
+namespace {
+
+constexpr auto kDecodedThumbnailMaxArea = 320 * 320;
+
+[[nodiscard]] int64 DecodedThumbnailsSizeLimit() {
+	return int64(cDecodedImagesCacheSize()) * 1024 * 1024;
+}
+
+} // namespace
+
+QImage DecodedThumbnails::lookup(const Storage::Cache::Key &key) {
+	const auto i = _index.find(std::make_pair(key.high, key.low));
+	if (i == end(_index)) {
+		return QImage();
+	}
+	_entries.splice(begin(_entries), _entries, i->second);
+	return i->second->image;
+}
+
+void DecodedThumbnails::remember(
+		const Storage::Cache::Key &key,
+		const QImage &image) {
+	if (!Fits(image) || ComputeSize(image) > DecodedThumbnailsSizeLimit()) {
+		return;
+	}
+	const auto entryKey = std::make_pair(key.high, key.low);
+	const auto i = _index.find(entryKey);
+	if (i != end(_index)) {
+		_totalSize -= ComputeSize(i->second->image);
+		i->second->image = image;
+		_entries.splice(begin(_entries), _entries, i->second);
+	} else {
+		_entries.push_front({ .key = entryKey, .image = image });
+		_index.emplace(entryKey, begin(_entries));
+	}
+	_totalSize += ComputeSize(image);
+	while (_totalSize > DecodedThumbnailsSizeLimit()) {
+		removeOldest();
+	}
+}
+
+void DecodedThumbnails::clear() {
+	invalidate_weak_ptrs(this);
+	_index.clear();
+	_entries.clear();
+	_totalSize = 0;
+}
+
+int64 DecodedThumbnails::totalSize() const {
+	return _totalSize;
+}
+
+bool DecodedThumbnails::Fits(const QImage &image) {
+	return !image.isNull()
+		&& (image.width() * image.height() <= kDecodedThumbnailMaxArea);
+}
+
+int64 DecodedThumbnails::ComputeSize(const QImage &image) {
+	return image.isNull() ? 0 : int64(image.sizeInBytes());
+}
+
+void DecodedThumbnails::removeOldest() {
+	Expects(!_entries.empty());
+
+	const auto &oldest = _entries.back();
+	_totalSize -= ComputeSize(oldest.image);
+	_index.remove(oldest.key);
+	_entries.pop_back();
+}
 
 CloudFile::~CloudFile() {
 	// Destroy loader with still alive CloudFile with already zero '.loader'.
@@ -234,7 +304,8 @@ void LoadCloudFile(
 		Fn<void(CloudFile&)> done,
 		Fn<void(bool)> fail,
 		Fn<void()> progress,
-		int downloadFrontPartSize = 0) {
+		int downloadFrontPartSize = 0,
+		Fn<std::unique_ptr<FileLoader>()> createLoader = nullptr) {
 	const auto loadSize = downloadFrontPartSize
 		? std::min(downloadFrontPartSize, file.byteSize)
 		: file.byteSize;
@@ -252,18 +323,21 @@ void LoadCloudFile(
 		return;
 	}
 	file.flags &= ~CloudFile::Flag::Cancelled;
-	file.loader = CreateFileLoader(
-		session,
-		file.location.file(),
-		origin,
-		QString(),
-		loadSize,
-		file.byteSize,
-		UnknownFileLocation,
-		LoadToCacheAsWell,
-		fromCloud,
-		autoLoading,
-		cacheTag);
+	file.loader = createLoader ? createLoader() : nullptr;
+	if (!file.loader) {
+		file.loader = CreateFileLoader(
+			session,
+			file.location.file(),
+			origin,
+			QString(),
+			loadSize,
+			file.byteSize,
+			UnknownFileLocation,
+			LoadToCacheAsWell,
+			fromCloud,
+			autoLoading,
+			cacheTag);
+	}
 
 	const auto finish = [done](CloudFile &file) {
 		if (!file.loader || file.loader->cancelled()) {
@@ -311,14 +385,41 @@ void LoadCloudFile(
 		Fn<void(bool)> fail,
 		Fn<void()> progress,
 		int downloadFrontPartSize) {
+	const auto decoded = (cacheTag == kImageCacheTag)
+		&& !downloadFrontPartSize;
+	if (decoded
+		&& !file.loader
+		&& file.location.valid()
+		&& (!finalCheck || finalCheck())) {
+		if (const auto key = file.location.file().cacheKey()) {
+			auto &thumbnails = session->data().decodedThumbnails();
+			if (auto image = thumbnails.lookup(key); !image.isNull()) {
+				// Callers expect the result later, like from a loader.
+				file.flags |= CloudFile::Flag::Loaded;
+				crl::on_main(&thumbnails, [=, image = std::move(image)] {
+					if (const auto onstack = done) {
+						onstack(image);
+					}
+				});
+				return;
+			}
+		}
+	}
 	const auto callback = [=](CloudFile &file) {
 		if (auto read = file.loader->imageData(); read.isNull()) {
 			file.flags |= CloudFile::Flag::Failed;
 			if (const auto onstack = fail) {
 				onstack(true);
 			}
-		} else if (const auto onstack = done) {
-			onstack(std::move(read));
+		} else {
+			if (decoded && DecodedThumbnails::Fits(read)) {
+				if (const auto key = file.location.file().cacheKey()) {
+					session->data().decodedThumbnails().remember(key, read);
+				}
+			}
+			if (const auto onstack = done) {
+				onstack(std::move(read));
+			}
 		}
 	};
 	LoadCloudFile(
@@ -345,7 +446,8 @@ void LoadCloudFile(
 		Fn<bool()> finalCheck,
 		Fn<void(QByteArray)> done,
 		Fn<void(bool)> fail,
-		Fn<void()> progress) {
+		Fn<void()> progress,
+		Fn<std::unique_ptr<FileLoader>()> createLoader) {
 	const auto callback = [=](CloudFile &file) {
 		if (auto bytes = file.loader->bytes(); bytes.isEmpty()) {
 			file.flags |= CloudFile::Flag::Failed;
@@ -366,7 +468,9 @@ void LoadCloudFile(
 		finalCheck,
 		callback,
 		std::move(fail),
-		std::move(progress));
+		std::move(progress),
+		0,
+		std::move(createLoader));
 }
 
 } // namespace Data
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "base/flags.h"
+#include "base/weak_ptr.h"
 #include "ui/image/image.h"
 #include "ui/image/image_location.h"
 
@@ -16,6 +17,7 @@ class FileLoader;
 namespace Storage {
 namespace Cache {
 class Database;
+struct Key;
 } // namespace Cache
 } // namespace Storage
 
@@ -44,6 +46,34 @@ struct CloudFile final {
 	base::flags<Flag> flags;
 };
 
+// Keeps decoded small images, so that media views created again while
+// scrolling don't read and decode them from the cache database.
+class DecodedThumbnails final : public base::has_weak_ptr {
+public:
+	[[nodiscard]] QImage lookup(const Storage::Cache::Key &key);
+	void remember(const Storage::Cache::Key &key, const QImage &image);
+	void clear();
+
+	[[nodiscard]] int64 totalSize() const;
+	[[nodiscard]] static bool Fits(const QImage &image);
+
+private:
+	using EntryKey = std::pair<uint64, uint64>;
+	struct Entry {
+		EntryKey key;
+		QImage image;
+	};
+
+	[[nodiscard]] static int64 ComputeSize(const QImage &image);
+	void removeOldest();
+
+	// Most recently used first.
+	std::list<Entry> _entries;
+	base::flat_map<EntryKey, std::list<Entry>::iterator> _index;
+	int64 _totalSize = 0;
+
+};
+
 class CloudImageView final {
 public:
 	void set(not_null<Main::Session*> session, QImage image);
@@ -121,6 +151,7 @@ void LoadCloudFile(
 	Fn<bool()> finalCheck,
 	Fn<void(QByteArray)> done,
 	Fn<void(bool)> fail = nullptr,
-	Fn<void()> progress = nullptr);
+	Fn<void()> progress = nullptr,
+	Fn<std::unique_ptr<FileLoader>()> createLoader = nullptr);
 
 } // namespace Data
@@ -75,6 +75,16 @@ QString JoinStringList(const QStringList &list, const QString &separator) {
 	return result;
 }
 
+void CancelWaveformTask(const VoiceWaveform &waveform) {
+	if (!waveform.isEmpty()
+		&& waveform[0] == -1
+		&& waveform.size() > int32(sizeof(TaskId))) {
+		auto taskId = TaskId();
+		memcpy(&taskId, waveform.constData() + 1, sizeof(taskId));
+		Local::cancelTask(taskId);
+	}
+}
+
 } // namespace
 
 QString FileNameUnsafe(
@@ -140,6 +150,7 @@ QString FileNameUnsafe(
 			return path;
 		}
 	}();
+	Core::WatchFileLocationsFolder(path);
 	if (name.isEmpty()) name = qsl(".unknown");
 	if (name.at(0) == QChar::fromLatin1('.')) {
 		if (!QDir().exists(path)) QDir().mkpath(path);
@@ -262,14 +273,12 @@ Data::FileOrigin StickerData::setOrigin() const {
 		: Data::FileOrigin();
 }
 
+SongData::~SongData() {
+	CancelWaveformTask(waveform);
+}
+
 VoiceData::~VoiceData() {
-	if (!waveform.isEmpty()
-		&& waveform[0] == -1
-		&& waveform.size() > int32(sizeof(TaskId))) {
-		auto taskId = TaskId();
-		memcpy(&taskId, waveform.constData() + 1, sizeof(taskId));
-		Local::cancelTask(taskId);
-	}
+	CancelWaveformTask(waveform);
 }
 
 DocumentData::DocumentData(not_null<Data::Session*> owner, DocumentId id)
@@ -573,6 +582,14 @@ Storage::Cache::Key DocumentData::goodThumbnailCacheKey() const {
 	return Data::DocumentThumbCacheKey(_dc, id);
 }
 
+Storage::Cache::Key DocumentData::storyboardCacheKey() const {
+	return Data::DocumentStoryboardCacheKey(_dc, id);
+}
+
+Storage::Cache::Key DocumentData::waveformCacheKey() const {
+	return Data::DocumentWaveformCacheKey(_dc, id);
+}
+
 bool DocumentData::goodThumbnailChecked() const {
 	return (_goodThumbnailState & GoodThumbnailFlag::Mask)
 		== GoodThumbnailFlag::Checked;
@@ -1384,6 +1401,10 @@ bool DocumentData::hasAttachedStickers() const {
 	return (_flags & Flag::HasAttachedStickers);
 }
 
+MTP::DcId DocumentData::dcId() const {
+	return _dc;
+}
+
 bool DocumentData::supportsStreaming() const {
 	return (_flags & kStreamingSupportedMask) == kStreamingSupportedMaybeYes;
 }
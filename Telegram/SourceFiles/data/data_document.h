@@ -66,8 +66,12 @@ struct StickerData : public DocumentAdditionalData {
 };
 
 struct SongData : public DocumentAdditionalData {
+	~SongData();
+
 	int32 duration = 0;
 	QString title, performer;
+	VoiceWaveform waveform;
+	char wavemax = 0;
 
 };
 
@@ -192,6 +196,8 @@ public:
 	}
 
 	[[nodiscard]] Storage::Cache::Key goodThumbnailCacheKey() const;
+	[[nodiscard]] Storage::Cache::Key storyboardCacheKey() const;
+	[[nodiscard]] Storage::Cache::Key waveformCacheKey() const;
 	[[nodiscard]] bool goodThumbnailChecked() const;
 	[[nodiscard]] bool goodThumbnailGenerating() const;
 	[[nodiscard]] bool goodThumbnailNoData() const;
@@ -233,6 +239,7 @@ public:
 	void setMimeString(const QString &mime);
 
 	[[nodiscard]] bool hasAttachedStickers() const;
+	[[nodiscard]] MTP::DcId dcId() const;
 
 	[[nodiscard]] MediaKey mediaKey() const;
 	[[nodiscard]] Storage::Cache::Key cacheKey() const;
@@ -13,6 +13,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_cloud_themes.h"
 #include "data/data_file_origin.h"
 #include "data/data_auto_download.h"
+#include "data/data_auto_download_scheduler.h"
 #include "media/clip/media_clip_reader.h"
 #include "main/main_session.h"
 #include "main/main_session_settings.h"
@@ -186,11 +187,9 @@ Image *DocumentMedia::thumbnailInline() const {
 	if (!_inlineThumbnail && !_owner->inlineThumbnailIsPath()) {
 		const auto bytes = _owner->inlineThumbnailBytes();
 		if (!bytes.isEmpty()) {
-			auto image = Images::FromInlineBytes(bytes);
-			if (image.isNull()) {
+			_inlineThumbnail = _owner->owner().inlineThumbnail(bytes);
+			if (!_inlineThumbnail) {
 				_owner->clearInlineThumbnailBytes();
-			} else {
-				_inlineThumbnail = std::make_unique<Image>(std::move(image));
 			}
 		}
 	}
@@ -301,6 +300,11 @@ void DocumentMedia::automaticLoad(
 			: Data::AutoDownload::Should(
 				_owner->session().settings().autoDownload(),
 				_owner));
+	if (item
+		&& shouldLoadFromCloud
+		&& !_owner->owner().autoDownloadScheduler().allow(item)) {
+		return;
+	}
 	const auto loadFromCloud = shouldLoadFromCloud
 		? LoadFromCloudOrLocal
 		: LoadFromLocalOnly;
@@ -315,8 +319,8 @@ void DocumentMedia::collectLocalData(not_null<DocumentMedia*> local) {
 	if (const auto image = local->_goodThumbnail.get()) {
 		_goodThumbnail = std::make_unique<Image>(image->original());
 	}
-	if (const auto image = local->_inlineThumbnail.get()) {
-		_inlineThumbnail = std::make_unique<Image>(image->original());
+	if (local->_inlineThumbnail) {
+		_inlineThumbnail = local->_inlineThumbnail;
 	}
 	if (const auto image = local->_thumbnail.get()) {
 		_thumbnail = std::make_unique<Image>(image->original());
@@ -102,7 +102,7 @@ private:
 	// In case this is a problem the ~Gif code should be rewritten.
 	const not_null<DocumentData*> _owner;
 	std::unique_ptr<Image> _goodThumbnail;
-	mutable std::unique_ptr<Image> _inlineThumbnail;
+	mutable std::shared_ptr<Image> _inlineThumbnail;
 	mutable QPainterPath _pathThumbnail;
 	std::unique_ptr<Image> _thumbnail;
 	std::unique_ptr<Image> _sticker;
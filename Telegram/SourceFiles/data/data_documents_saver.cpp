@@ -0,0 +1,186 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "data/data_documents_saver.h"
+
+#include "data/data_session.h"
+#include "data/data_document.h"
+#include "data/data_photo.h"
+#include "data/data_photo_media.h"
+#include "data/data_media_types.h"
+#include "history/history_item.h"
+#include "main/main_session.h"
+#include "core/file_utilities.h"
+#include "core/mime_type.h"
+#include "ui/image/image.h"
+#include "ui/toast/toast.h"
+#include "kotato/kotato_lang.h"
+
+namespace Data {
+namespace {
+
+constexpr auto kMaxInFlight = 3;
+
+[[nodiscard]] QString DocumentName(not_null<DocumentData*> document) {
+	const auto name = document->filename();
+	if (!name.isEmpty()) {
+		return name;
+	}
+	const auto patterns = Core::MimeTypeForName(
+		document->mimeString()).globPatterns();
+	auto extension = patterns.isEmpty()
+		? qsl(".unknown")
+		: QString(patterns.front()).replace('*', QString());
+	return qsl("doc_%1").arg(document->id) + extension;
+}
+
+} // namespace
+
+DocumentsSaver::DocumentsSaver(not_null<Session*> owner)
+: _owner(owner) {
+	session().downloaderTaskFinished(
+	) | rpl::start_with_next([=] {
+		if (!_folder.isEmpty()) {
+			process();
+		}
+	}, _lifetime);
+}
+
+DocumentsSaver::~DocumentsSaver() = default;
+
+Main::Session &DocumentsSaver::session() const {
+	return _owner->session();
+}
+
+void DocumentsSaver::save(const MessageIdsList &ids, const QString &folder) {
+	if (!_folder.isEmpty() && _folder != folder) {
+		// Only one batch at a time, more ids for the same folder join it.
+		Ui::Toast::Show(ktr("ktg_save_selected_busy"));
+		return;
+	}
+	auto added = 0;
+	for (const auto &itemId : ids) {
+		const auto item = _owner->message(itemId);
+		const auto media = item ? item->media() : nullptr;
+		if (!media) {
+			continue;
+		} else if (const auto document = media->document()) {
+			_queue.push_back({ .itemId = itemId, .document = document });
+		} else if (const auto photo = media->photo()) {
+			_queue.push_back({ .itemId = itemId, .photo = photo });
+		} else {
+			continue;
+		}
+		++added;
+	}
+	if (!added) {
+		return;
+	}
+	_folder = folder;
+	_total += added;
+	Ui::Toast::Show(ktr(
+		"ktg_save_selected_started",
+		_total,
+		{ "count", QString::number(_total) }));
+	process();
+}
+
+bool DocumentsSaver::start(Entry &entry) {
+	const auto isPath = [&](const QString &path) {
+		return ranges::contains(_loading, path, &Entry::path);
+	};
+	const auto uniquePath = [&](const QString &name) {
+		auto result = filedialogNextFilename(name, QString(), _folder);
+		for (auto i = 2; isPath(result); ++i) {
+			const auto dot = name.lastIndexOf('.');
+			result = filedialogNextFilename(
+				((dot >= 0) ? name.mid(0, dot) : name)
+					+ qsl(" (%1)").arg(i)
+					+ ((dot >= 0) ? name.mid(dot) : QString()),
+				QString(),
+				_folder);
+		}
+		return result;
+	};
+	const auto item = _owner->message(entry.itemId);
+	if (!item) {
+		return false;
+	} else if (const auto document = entry.document) {
+		entry.path = uniquePath(DocumentName(document));
+		document->save(entry.itemId, entry.path);
+		return true;
+	}
+	const auto photo = entry.photo;
+	entry.path = uniquePath(QFileInfo(filedialogDefaultName(
+		qsl("photo"),
+		qsl(".jpg"),
+		_folder,
+		true,
+		item->date())).fileName());
+	entry.photoMedia = photo->createMediaView();
+	entry.photoMedia->wanted(PhotoSize::Large, entry.itemId);
+	return true;
+}
+
+bool DocumentsSaver::finished(const Entry &entry) {
+	if (const auto document = entry.document) {
+		if (document->loading()) {
+			return false;
+		} else if (!document->filepath(true).isEmpty()) {
+			++_saved;
+		}
+		return true;
+	}
+	const auto media = entry.photoMedia.get();
+	if (const auto image = media->image(PhotoSize::Large)) {
+		if (image->original().save(entry.path, "JPG")) {
+			++_saved;
+		}
+		return true;
+	}
+	return !entry.photo->loading(PhotoSize::Large);
+}
+
+void DocumentsSaver::process() {
+	if (_processing) {
+		// Cached files may finish right inside start().
+		return;
+	}
+	_processing = true;
+	while (true) {
+		while (int(_loading.size()) < kMaxInFlight && !_queue.empty()) {
+			auto entry = std::move(_queue.front());
+			_queue.pop_front();
+			if (start(entry)) {
+				_loading.push_back(std::move(entry));
+			}
+		}
+		const auto from = ranges::remove_if(_loading, [&](const Entry &e) {
+			return finished(e);
+		});
+		if (from == end(_loading)) {
+			break;
+		}
+		_loading.erase(from, end(_loading));
+	}
+	_processing = false;
+	if (_loading.empty()) {
+		finish();
+	}
+}
+
+void DocumentsSaver::finish() {
+	Ui::Toast::Show(ktr(
+		"ktg_save_selected_finished",
+		_saved,
+		{ "count", QString::number(_saved) },
+		{ "folder", QDir::toNativeSeparators(_folder) }));
+	_folder = QString();
+	_total = _saved = 0;
+}
+
+} // namespace Data
@@ -0,0 +1,60 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+class PhotoData;
+class DocumentData;
+
+namespace Main {
+class Session;
+} // namespace Main
+
+namespace Data {
+
+class Session;
+class PhotoMedia;
+
+// Saves a batch of message files into one folder, keeping only a few
+// of them downloading at once. Documents are written straight into
+// their target files by the regular loaders.
+class DocumentsSaver final {
+public:
+	explicit DocumentsSaver(not_null<Session*> owner);
+	~DocumentsSaver();
+
+	void save(const MessageIdsList &ids, const QString &folder);
+
+private:
+	struct Entry {
+		FullMsgId itemId;
+		DocumentData *document = nullptr;
+		PhotoData *photo = nullptr;
+		std::shared_ptr<PhotoMedia> photoMedia;
+		QString path;
+	};
+
+	[[nodiscard]] Main::Session &session() const;
+	[[nodiscard]] bool start(Entry &entry);
+	[[nodiscard]] bool finished(const Entry &entry);
+	void process();
+	void finish();
+
+	const not_null<Session*> _owner;
+
+	std::deque<Entry> _queue;
+	std::vector<Entry> _loading;
+	QString _folder;
+	int _total = 0;
+	int _saved = 0;
+	bool _processing = false;
+
+	rpl::lifetime _lifetime;
+
+};
+
+} // namespace Data
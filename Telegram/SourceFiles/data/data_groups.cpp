@@ -143,6 +143,9 @@ const Group *Groups::find(not_null<const HistoryItem*> item) const {
 void Groups::refreshViews(const HistoryItemsList &items) {
 	if (items.empty()) {
 		return;
+	} else if (_refreshSuspended) {
+		_refreshPending.emplace(items.front()->groupId());
+		return;
 	}
 	const auto history = items.front()->history();
 	for (const auto &item : items) {
@@ -151,6 +154,24 @@ void Groups::refreshViews(const HistoryItemsList &items) {
 	}
 }
 
+void Groups::suspendViewsRefresh() {
+	++_refreshSuspended;
+}
+
+void Groups::resumeViewsRefresh() {
+	Expects(_refreshSuspended > 0);
+
+	if (--_refreshSuspended) {
+		return;
+	}
+	for (const auto groupId : base::take(_refreshPending)) {
+		const auto i = _groups.find(groupId);
+		if (i != end(_groups)) {
+			refreshViews(i->second.items);
+		}
+	}
+}
+
 not_null<HistoryItem*> Groups::findItemToEdit(
 		not_null<HistoryItem*> item) const {
 	const auto group = find(item);
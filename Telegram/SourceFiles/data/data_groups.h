@@ -32,6 +32,10 @@ public:
 
 	not_null<HistoryItem*> findItemToEdit(not_null<HistoryItem*> item) const;
 
+	// While suspended each changed group refreshes its views only once.
+	void suspendViewsRefresh();
+	void resumeViewsRefresh();
+
 private:
 	HistoryItemsList::const_iterator findPositionForItem(
 		const HistoryItemsList &group,
@@ -41,6 +45,8 @@ private:
 	not_null<Session*> _data;
 	std::map<MessageGroupId, Group> _groups;
 	std::map<MessageGroupId, MessageGroupId> _alias;
+	base::flat_set<MessageGroupId> _refreshPending;
+	int _refreshSuspended = 0;
 
 };
 
@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_channel.h"
 #include "data/data_chat.h"
 #include "data/data_folder.h"
+#include "data/data_replies_list.h"
 #include "data/data_scheduled_messages.h"
 #include "base/unixtime.h"
 #include "main/main_session.h"
@@ -25,6 +26,8 @@ namespace Data {
 namespace {
 
 constexpr auto kReadRequestTimeout = 3 * crl::time(1000);
+constexpr auto kReadRequestMaxDelay = 10 * crl::time(1000);
+constexpr auto kRecentRepliesLimit = 8;
 
 } // namespace
 
@@ -59,6 +62,7 @@ not_null<History*> Histories::findOrCreate(PeerId peerId) {
 }
 
 void Histories::unloadAll() {
+	_recentReplies.clear();
 	for (const auto &[peerId, history] : _map) {
 		history->clear(History::ClearType::Unload);
 	}
@@ -206,26 +210,33 @@ void Histories::readInboxTill(
 		return;
 	}
 	auto &state = maybeState ? *maybeState : _states[history];
+	const auto sendingNow = state.willReadTill && !state.willReadWhen;
 	state.willReadTill = tillId;
-	if (force || !stillUnread || !*stillUnread) {
+	if (force || sendingNow || !stillUnread || !*stillUnread) {
 		DEBUG_LOG(("Reading: will read till %1 with still unread %2"
 			).arg(tillId.bare
 			).arg(stillUnread.value_or(-666)));
 		state.willReadWhen = 0;
-		sendReadRequests();
+		scheduleReadRequests();
 		if (!stillUnread) {
 			return;
 		}
 	} else if (!state.willReadWhen) {
 		DEBUG_LOG(("Reading: will read till %1 with postponed"
 			).arg(tillId.bare));
-		state.willReadWhen = crl::now() + kReadRequestTimeout;
+		state.willReadStarted = crl::now();
+		state.willReadWhen = state.willReadStarted + kReadRequestTimeout;
 		if (!_readRequestsTimer.isActive()) {
 			_readRequestsTimer.callOnce(kReadRequestTimeout);
 		}
 	} else {
 		DEBUG_LOG(("Reading: will read till %1 postponed already"
 			).arg(tillId.bare));
+
+		// Send only the last id after the scrolling settles.
+		state.willReadWhen = std::min(
+			crl::now() + kReadRequestTimeout,
+			state.willReadStarted + kReadRequestMaxDelay);
 	}
 	DEBUG_LOG(("Reading: marking now with till %1 and still %2"
 		).arg(tillId.bare
@@ -494,7 +505,22 @@ void Histories::sendPendingReadInbox(not_null<History*> history) {
 	}
 }
 
+void Histories::scheduleReadRequests() {
+	// All the histories read during one event loop iteration are sent
+	// together, so switching through chats doesn't send them one by one.
+	if (_readRequestsScheduled) {
+		return;
+	}
+	_readRequestsScheduled = true;
+	crl::on_main(&session(), [=] {
+		if (base::take(_readRequestsScheduled)) {
+			sendReadRequests();
+		}
+	});
+}
+
 void Histories::sendReadRequests() {
+	_readRequestsScheduled = false;
 	DEBUG_LOG(("Reading: send requests with count %1.").arg(_states.size()));
 	if (_states.empty()) {
 		return;
@@ -526,6 +552,7 @@ void Histories::sendReadRequest(not_null<History*> history, State &state) {
 
 	const auto tillId = state.sentReadTill = base::take(state.willReadTill);
 	state.willReadWhen = 0;
+	state.willReadStarted = 0;
 	state.sentReadDone = false;
 	DEBUG_LOG(("Reading: sending request now with till %1."
 		).arg(tillId.bare));
@@ -861,6 +888,27 @@ void Histories::cancelRequest(int id) {
 	finishSentRequest(*history, state, id);
 }
 
+std::shared_ptr<RepliesList> Histories::repliesList(
+		not_null<History*> history,
+		MsgId rootId) {
+	const auto i = ranges::find_if(_recentReplies, [&](const auto &list) {
+		return (list->history() == history) && (list->rootId() == rootId);
+	});
+	if (i != end(_recentReplies)) {
+		auto result = *i;
+		_recentReplies.erase(i);
+		_recentReplies.push_back(result);
+		result->reconcile();
+		return result;
+	}
+	auto result = std::make_shared<RepliesList>(history, rootId);
+	_recentReplies.push_back(result);
+	if (_recentReplies.size() > kRecentRepliesLimit) {
+		_recentReplies.erase(begin(_recentReplies));
+	}
+	return result;
+}
+
 void Histories::finishSentRequest(
 		not_null<History*> history,
 		not_null<State*> state,
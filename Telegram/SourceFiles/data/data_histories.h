@@ -20,6 +20,7 @@ namespace Data {
 
 class Session;
 class Folder;
+class RepliesList;
 
 class Histories final {
 public:
@@ -90,6 +91,11 @@ public:
 		Fn<mtpRequestId(Fn<void()> finish)> generator);
 	void cancelRequest(int id);
 
+	// Recently opened threads are kept, so that they reopen instantly.
+	[[nodiscard]] std::shared_ptr<RepliesList> repliesList(
+		not_null<History*> history,
+		MsgId rootId);
+
 private:
 	struct PostponedHistoryRequest {
 		Fn<mtpRequestId(Fn<void()> finish)> generator;
@@ -105,6 +111,7 @@ private:
 		MsgId willReadTill = 0;
 		MsgId sentReadTill = 0;
 		crl::time willReadWhen = 0;
+		crl::time willReadStarted = 0;
 		bool sentReadDone = false;
 		bool postponedRequestEntry = false;
 	};
@@ -115,6 +122,7 @@ private:
 
 	void readInboxTill(not_null<History*> history, MsgId tillId, bool force);
 	void sendReadRequests();
+	void scheduleReadRequests();
 	void sendReadRequest(not_null<History*> history, State &state);
 	[[nodiscard]] State *lookup(not_null<History*> history);
 	void checkEmptyState(not_null<History*> history);
@@ -136,6 +144,7 @@ private:
 	base::flat_map<int, not_null<History*>> _historyByRequest;
 	int _requestAutoincrement = 0;
 	base::Timer _readRequestsTimer;
+	bool _readRequestsScheduled = false;
 
 	base::flat_set<not_null<Data::Folder*>> _dialogFolderRequests;
 	base::flat_map<
@@ -151,6 +160,8 @@ private:
 		not_null<History*>,
 		ChatListGroupRequest> _chatListGroupRequests;
 
+	std::vector<std::shared_ptr<RepliesList>> _recentReplies;
+
 };
 
 } // namespace Data
@@ -0,0 +1,141 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "data/data_history_tags_index.h"
+
+#include "history/history_item.h"
+
+namespace Data {
+namespace {
+
+[[nodiscard]] QString EntityTag(
+		const TextWithEntities &text,
+		const EntityInText &entity) {
+	switch (entity.type()) {
+	case EntityType::Hashtag:
+	case EntityType::Mention:
+	case EntityType::Url:
+		return text.text.mid(entity.offset(), entity.length());
+	case EntityType::CustomUrl:
+		return entity.data();
+	}
+	return QString();
+}
+
+} // namespace
+
+QString HistoryTagsIndex::NormalizeTag(const QString &tag) {
+	auto result = tag.trimmed().toLower();
+	if (result.startsWith('#') || result.startsWith('@')) {
+		return result;
+	}
+	for (const auto &prefix : { qstr("https://"), qstr("http://") }) {
+		if (result.startsWith(prefix)) {
+			result = result.mid(prefix.size());
+			break;
+		}
+	}
+	if (result.startsWith(qstr("www."))) {
+		result = result.mid(4);
+	}
+	while (result.endsWith('/')) {
+		result.chop(1);
+	}
+	return result;
+}
+
+void HistoryTagsIndex::add(
+		not_null<HistoryItem*> item,
+		const TextWithEntities &text) {
+	auto tags = std::vector<QString>();
+	for (const auto &entity : text.entities) {
+		auto tag = NormalizeTag(EntityTag(text, entity));
+		if (tag.size() > 1 && !ranges::contains(tags, tag)) {
+			tags.push_back(std::move(tag));
+		}
+	}
+	if (tags.empty()) {
+		remove(item);
+		return;
+	}
+	const auto i = _tags.find(item);
+	if (i != end(_tags) && i->second == tags) {
+		return;
+	}
+	remove(item);
+	for (const auto &tag : tags) {
+		_items[tag].emplace(item);
+	}
+	_tags.emplace(item, std::move(tags));
+}
+
+void HistoryTagsIndex::remove(not_null<HistoryItem*> item) {
+	const auto i = _tags.find(item);
+	if (i == end(_tags)) {
+		return;
+	}
+	for (const auto &tag : i->second) {
+		const auto j = _items.find(tag);
+		if (j != end(_items)) {
+			j->second.remove(item);
+			if (j->second.empty()) {
+				_items.erase(j);
+			}
+		}
+	}
+	_tags.erase(i);
+}
+
+std::vector<not_null<HistoryItem*>> HistoryTagsIndex::lookup(
+		const QString &tag,
+		int limit) const {
+	const auto i = _items.find(NormalizeTag(tag));
+	if (i == end(_items) || limit <= 0) {
+		return {};
+	}
+	auto result = std::vector<not_null<HistoryItem*>>();
+	result.reserve(i->second.size());
+	for (const auto item : i->second) {
+		if (item->isHistoryEntry() && !item->isScheduled()) {
+			result.push_back(item);
+		}
+	}
+	ranges::sort(result, ranges::greater(), [](not_null<HistoryItem*> item) {
+		return std::make_pair(item->date(), item->id);
+	});
+	if (int(result.size()) > limit) {
+		result.resize(limit);
+	}
+	return result;
+}
+
+std::vector<QString> HistoryTagsIndex::hashtags(
+		const QString &prefix,
+		int limit) const {
+	const auto normalized = '#' + prefix.toLower();
+	auto found = std::vector<std::pair<QString, int>>();
+	for (auto i = _items.lower_bound(normalized); i != end(_items); ++i) {
+		if (!i->first.startsWith(normalized)) {
+			break;
+		}
+		found.emplace_back(i->first.mid(1), int(i->second.size()));
+	}
+	ranges::stable_sort(found, ranges::greater(), [](const auto &pair) {
+		return pair.second;
+	});
+	auto result = std::vector<QString>();
+	result.reserve(std::min(int(found.size()), limit));
+	for (auto &[tag, count] : found) {
+		if (int(result.size()) == limit) {
+			break;
+		}
+		result.push_back(std::move(tag));
+	}
+	return result;
+}
+
+} // namespace Data
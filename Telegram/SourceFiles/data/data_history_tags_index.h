@@ -0,0 +1,40 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+class HistoryItem;
+
+namespace Data {
+
+// Hashtags, mentions and links of the messages created in one history.
+// Items are reindexed each time their text is set, so lookups never
+// have to walk through the loaded blocks.
+class HistoryTagsIndex final {
+public:
+	void add(not_null<HistoryItem*> item, const TextWithEntities &text);
+	void remove(not_null<HistoryItem*> item);
+
+	// Takes "#hashtag", "@username" or a link, newest messages first.
+	[[nodiscard]] std::vector<not_null<HistoryItem*>> lookup(
+		const QString &tag,
+		int limit) const;
+
+	// Hashtags without the '#', most used first.
+	[[nodiscard]] std::vector<QString> hashtags(
+		const QString &prefix,
+		int limit) const;
+
+	[[nodiscard]] static QString NormalizeTag(const QString &tag);
+
+private:
+	base::flat_map<QString, base::flat_set<not_null<HistoryItem*>>> _items;
+	base::flat_map<not_null<HistoryItem*>, std::vector<QString>> _tags;
+
+};
+
+} // namespace Data
@@ -0,0 +1,285 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <optional>
+
+namespace Data {
+
+// Open-addressing hash map with linear probing for id-keyed tables.
+// Erase uses backward shift, so there are no tombstones. Any insert may
+// rehash and move the values, so iterators and references to values are
+// not stable across inserts (values owned by std::unique_ptr still are).
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class IdMap final {
+	using Slot = std::optional<std::pair<Key, Value>>;
+
+	template <bool Const>
+	class Iterator final {
+		using SlotPointer = std::conditional_t<Const, const Slot*, Slot*>;
+
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = std::pair<Key, Value>;
+		using difference_type = std::ptrdiff_t;
+		using pointer = std::conditional_t<
+			Const,
+			const value_type*,
+			value_type*>;
+		using reference = std::conditional_t<
+			Const,
+			const value_type&,
+			value_type&>;
+
+		Iterator() = default;
+		Iterator(SlotPointer slot, SlotPointer till)
+		: _slot(slot)
+		, _till(till) {
+			skipEmpty();
+		}
+		template <
+			bool OtherConst,
+			typename = std::enable_if_t<Const && !OtherConst>>
+		Iterator(const Iterator<OtherConst> &other)
+		: _slot(other._slot)
+		, _till(other._till) {
+		}
+
+		[[nodiscard]] reference operator*() const {
+			return **_slot;
+		}
+		[[nodiscard]] pointer operator->() const {
+			return &**_slot;
+		}
+		Iterator &operator++() {
+			++_slot;
+			skipEmpty();
+			return *this;
+		}
+		Iterator operator++(int) {
+			auto result = *this;
+			++*this;
+			return result;
+		}
+
+		[[nodiscard]] friend inline bool operator==(
+				const Iterator &a,
+				const Iterator &b) {
+			return (a._slot == b._slot);
+		}
+		[[nodiscard]] friend inline bool operator!=(
+				const Iterator &a,
+				const Iterator &b) {
+			return (a._slot != b._slot);
+		}
+
+	private:
+		friend class IdMap;
+		template <bool>
+		friend class Iterator;
+
+		void skipEmpty() {
+			while (_slot != _till && !*_slot) {
+				++_slot;
+			}
+		}
+
+		SlotPointer _slot = nullptr;
+		SlotPointer _till = nullptr;
+
+	};
+
+public:
+	using key_type = Key;
+	using mapped_type = Value;
+	using value_type = std::pair<Key, Value>;
+	using size_type = std::size_t;
+	using iterator = Iterator<false>;
+	using const_iterator = Iterator<true>;
+
+	IdMap() = default;
+	IdMap(const IdMap &other) = delete;
+	IdMap &operator=(const IdMap &other) = delete;
+	IdMap(IdMap &&other) noexcept
+	: _slots(base::take(other._slots))
+	, _size(base::take(other._size)) {
+	}
+	IdMap &operator=(IdMap &&other) noexcept {
+		if (this != &other) {
+			_slots = base::take(other._slots);
+			_size = base::take(other._size);
+		}
+		return *this;
+	}
+
+	[[nodiscard]] size_type size() const {
+		return _size;
+	}
+	[[nodiscard]] bool empty() const {
+		return !_size;
+	}
+
+	[[nodiscard]] iterator begin() {
+		return { _slots.data(), _slots.data() + _slots.size() };
+	}
+	[[nodiscard]] iterator end() {
+		const auto till = _slots.data() + _slots.size();
+		return { till, till };
+	}
+	[[nodiscard]] const_iterator begin() const {
+		return cbegin();
+	}
+	[[nodiscard]] const_iterator end() const {
+		return cend();
+	}
+	[[nodiscard]] const_iterator cbegin() const {
+		return { _slots.data(), _slots.data() + _slots.size() };
+	}
+	[[nodiscard]] const_iterator cend() const {
+		const auto till = _slots.data() + _slots.size();
+		return { till, till };
+	}
+
+	[[nodiscard]] friend inline iterator begin(IdMap &map) {
+		return map.begin();
+	}
+	[[nodiscard]] friend inline iterator end(IdMap &map) {
+		return map.end();
+	}
+	[[nodiscard]] friend inline const_iterator begin(const IdMap &map) {
+		return map.begin();
+	}
+	[[nodiscard]] friend inline const_iterator end(const IdMap &map) {
+		return map.end();
+	}
+
+	[[nodiscard]] iterator find(const Key &key) {
+		const auto index = lookup(key);
+		return (index != kNotFound)
+			? iterator(_slots.data() + index, _slots.data() + _slots.size())
+			: end();
+	}
+	[[nodiscard]] const_iterator find(const Key &key) const {
+		const auto index = lookup(key);
+		return (index != kNotFound)
+			? const_iterator(
+				_slots.data() + index,
+				_slots.data() + _slots.size())
+			: end();
+	}
+	[[nodiscard]] bool contains(const Key &key) const {
+		return (lookup(key) != kNotFound);
+	}
+
+	template <typename ...Args>
+	std::pair<iterator, bool> emplace(const Key &key, Args &&...args) {
+		if (const auto index = lookup(key); index != kNotFound) {
+			return { iterator(slotAt(index), slotsTill()), false };
+		}
+		if ((_size + 1) * kMaxLoadDenominator
+			> _slots.size() * kMaxLoadNumerator) {
+			rehash(std::max(_slots.size() * 2, kMinCapacity));
+		}
+		const auto index = freeSlotFor(key);
+		_slots[index].emplace(key, Value(std::forward<Args>(args)...));
+		++_size;
+		return { iterator(slotAt(index), slotsTill()), true };
+	}
+
+	void erase(const_iterator i) {
+		Expects(i._slot != nullptr && i._slot != i._till && *i._slot);
+
+		eraseAt(i._slot - _slots.data());
+	}
+	size_type erase(const Key &key) {
+		const auto index = lookup(key);
+		if (index == kNotFound) {
+			return 0;
+		}
+		eraseAt(index);
+		return 1;
+	}
+
+	void clear() {
+		_slots.clear();
+		_size = 0;
+	}
+
+private:
+	static constexpr auto kNotFound = std::numeric_limits<size_type>::max();
+	static constexpr auto kMinCapacity = size_type(16);
+	static constexpr auto kMaxLoadNumerator = size_type(3);
+	static constexpr auto kMaxLoadDenominator = size_type(4);
+
+	[[nodiscard]] Slot *slotAt(size_type index) {
+		return _slots.data() + index;
+	}
+	[[nodiscard]] Slot *slotsTill() {
+		return _slots.data() + _slots.size();
+	}
+	[[nodiscard]] size_type mask() const {
+		return _slots.size() - 1;
+	}
+	[[nodiscard]] size_type ideal(const Key &key) const {
+		// Fibonacci hashing keeps sequential ids apart in the table.
+		const auto hash = uint64(Hash()(key)) * 0x9E3779B97F4A7C15ULL;
+		return size_type(hash >> 32) & mask();
+	}
+
+	[[nodiscard]] size_type lookup(const Key &key) const {
+		if (_slots.empty()) {
+			return kNotFound;
+		}
+		for (auto index = ideal(key);; index = (index + 1) & mask()) {
+			const auto &slot = _slots[index];
+			if (!slot) {
+				return kNotFound;
+			} else if (slot->first == key) {
+				return index;
+			}
+		}
+	}
+	[[nodiscard]] size_type freeSlotFor(const Key &key) const {
+		auto index = ideal(key);
+		while (_slots[index]) {
+			index = (index + 1) & mask();
+		}
+		return index;
+	}
+
+	void rehash(size_type capacity) {
+		auto old = std::exchange(_slots, std::vector<Slot>(capacity));
+		for (auto &slot : old) {
+			if (slot) {
+				_slots[freeSlotFor(slot->first)] = std::move(slot);
+			}
+		}
+	}
+
+	void eraseAt(size_type index) {
+		_slots[index].reset();
+		--_size;
+
+		// Shift back the following entries of the probe sequence.
+		auto hole = index;
+		for (auto i = (index + 1) & mask(); _slots[i]; i = (i + 1) & mask()) {
+			const auto from = ideal(_slots[i]->first);
+			if (((i - from) & mask()) >= ((i - hole) & mask())) {
+				_slots[hole] = std::move(_slots[i]);
+				_slots[i].reset();
+				hole = i;
+			}
+		}
+	}
+
+	std::vector<Slot> _slots;
+	size_type _size = 0;
+
+};
+
+} // namespace Data
@@ -25,12 +25,14 @@ namespace {
 
 constexpr auto kRefreshFullListEach = 60 * 60 * crl::time(1000);
 constexpr auto kPollEach = 20 * crl::time(1000);
+constexpr auto kChangedCollectDelay = crl::time(16);
 
 } // namespace
 
 Reactions::Reactions(not_null<Session*> owner)
 : _owner(owner)
-, _repaintTimer([=] { repaintCollected(); }) {
+, _repaintTimer([=] { repaintCollected(); })
+, _changedTimer([=] { notifyChangedCollected(); }) {
 	refresh();
 
 	base::timer_each(
@@ -46,6 +48,7 @@ Reactions::Reactions(not_null<Session*> owner)
 		_pollingItems.remove(item);
 		_pollItems.remove(item);
 		_repaintItems.remove(item);
+		_changedItems.remove(item);
 	}, _lifetime);
 }
 
@@ -324,6 +327,19 @@ void Reactions::updateAllInHistory(not_null<PeerData*> peer, bool enabled) {
 	}
 }
 
+void Reactions::scheduleItemDataChange(not_null<HistoryItem*> item) {
+	_changedItems.emplace(item);
+	if (!_changedTimer.isActive()) {
+		_changedTimer.callOnce(kChangedCollectDelay);
+	}
+}
+
+void Reactions::notifyChangedCollected() {
+	for (const auto &item : base::take(_changedItems)) {
+		_owner->notifyItemDataChange(item);
+	}
+}
+
 void Reactions::repaintCollected() {
 	const auto now = crl::now();
 	auto closest = 0;
@@ -452,7 +468,8 @@ void MessageReactions::set(
 		}
 	}
 	if (changed) {
-		_item->history()->owner().notifyItemDataChange(_item);
+		// Popular posts get many updates, relayout them once per frame.
+		_item->history()->owner().reactions().scheduleItemDataChange(_item);
 	}
 }
 
@@ -65,6 +65,8 @@ public:
 
 	void updateAllInHistory(not_null<PeerData*> peer, bool enabled);
 
+	void scheduleItemDataChange(not_null<HistoryItem*> item);
+
 private:
 	struct ImageSet {
 		QImage bottomInfo;
@@ -84,6 +86,7 @@ private:
 
 	void repaintCollected();
 	void pollCollected();
+	void notifyChangedCollected();
 
 	const not_null<Session*> _owner;
 
@@ -106,6 +109,9 @@ private:
 	base::flat_set<not_null<HistoryItem*>> _pollingItems;
 	mtpRequestId _pollRequestId = 0;
 
+	base::flat_set<not_null<HistoryItem*>> _changedItems;
+	base::Timer _changedTimer;
+
 	rpl::lifetime _lifetime;
 
 };
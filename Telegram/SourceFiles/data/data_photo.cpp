@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_file_origin.h"
 #include "data/data_reply_preview.h"
 #include "data/data_photo_media.h"
+#include "data/data_streaming.h"
 #include "ui/image/image.h"
 #include "main/main_session.h"
 #include "history/history.h"
@@ -19,6 +20,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/streaming/media_streaming_loader_mtproto.h"
 #include "mainwidget.h"
 #include "storage/file_download.h"
+#include "storage/streamed_file_downloader.h"
 #include "core/application.h"
 #include "facades.h"
 
@@ -416,6 +418,10 @@ void PhotoData::setHasAttachedStickers(bool value) {
 	_hasStickers = value;
 }
 
+MTP::DcId PhotoData::dcId() const {
+	return _dc;
+}
+
 int PhotoData::width() const {
 	return _images[PhotoSizeIndex(PhotoSize::Large)].location.width();
 }
@@ -449,6 +455,32 @@ void PhotoData::loadVideo(Data::FileOrigin origin) {
 			active->setVideo(std::move(result));
 		}
 	};
+	const auto createLoader = [=]() -> std::unique_ptr<FileLoader> {
+		// Share part requests with the streaming player of the same video.
+		const auto &location = videoLocation().file().data;
+		if (!v::is<StorageFileLocation>(location)) {
+			return nullptr;
+		}
+		auto reader = owner().streaming().sharedReader(this, origin, true);
+		if (!reader) {
+			return nullptr;
+		}
+		return std::make_unique<Storage::StreamedFileDownloader>(
+			&session(),
+			id,
+			v::get<StorageFileLocation>(location).dcId(),
+			origin,
+			videoLocation().file().cacheKey(),
+			MediaKey(),
+			std::move(reader),
+			QString(),
+			videoByteSize(),
+			UnknownFileLocation,
+			LoadToCacheAsWell,
+			LoadFromCloudOrLocal,
+			autoLoading,
+			Data::kAnimationCacheTag);
+	};
 	Data::LoadCloudFile(
 		&session(),
 		_video,
@@ -457,7 +489,10 @@ void PhotoData::loadVideo(Data::FileOrigin origin) {
 		autoLoading,
 		Data::kAnimationCacheTag,
 		finalCheck,
-		done);
+		done,
+		nullptr,
+		nullptr,
+		createLoader);
 }
 
 const ImageLocation &PhotoData::videoLocation() const {
@@ -149,6 +149,8 @@ public:
 	[[nodiscard]] bool hasAttachedStickers() const;
 	void setHasAttachedStickers(bool value);
 
+	[[nodiscard]] MTP::DcId dcId() const;
+
 	// For now they return size of the 'large' image.
 	int width() const;
 	int height() const;
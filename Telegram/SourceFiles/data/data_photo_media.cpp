@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_session.h"
 #include "data/data_file_origin.h"
 #include "data/data_auto_download.h"
+#include "data/data_auto_download_scheduler.h"
 #include "main/main_session.h"
 #include "main/main_session_settings.h"
 #include "history/history_item.h"
@@ -37,11 +38,9 @@ Image *PhotoMedia::thumbnailInline() const {
 	if (!_inlineThumbnail) {
 		const auto bytes = _owner->inlineThumbnailBytes();
 		if (!bytes.isEmpty()) {
-			auto image = Images::FromInlineBytes(bytes);
-			if (image.isNull()) {
+			_inlineThumbnail = _owner->owner().inlineThumbnail(bytes);
+			if (!_inlineThumbnail) {
 				_owner->clearInlineThumbnailBytes();
-			} else {
-				_inlineThumbnail = std::make_unique<Image>(std::move(image));
 			}
 		}
 	}
@@ -150,6 +149,10 @@ void PhotoMedia::automaticLoad(
 		_owner->session().settings().autoDownload(),
 		item->history()->peer,
 		_owner);
+	if (loadFromCloud
+		&& !_owner->owner().autoDownloadScheduler().allow(item)) {
+		return;
+	}
 	_owner->load(
 		origin,
 		loadFromCloud ? LoadFromCloudOrLocal : LoadFromLocalOnly,
@@ -157,8 +160,8 @@ void PhotoMedia::automaticLoad(
 }
 
 void PhotoMedia::collectLocalData(not_null<PhotoMedia*> local) {
-	if (const auto image = local->_inlineThumbnail.get()) {
-		_inlineThumbnail = std::make_unique<Image>(image->original());
+	if (local->_inlineThumbnail) {
+		_inlineThumbnail = local->_inlineThumbnail;
 	}
 	for (auto i = 0; i != kPhotoSizeCount; ++i) {
 		if (const auto image = local->_images[i].data.get()) {
@@ -52,7 +52,7 @@ private:
 	// In DocumentData::collectLocalData a shared_ptr is sent on_main.
 	// In case this is a problem the ~Gif code should be rewritten.
 	const not_null<PhotoData*> _owner;
-	mutable std::unique_ptr<Image> _inlineThumbnail;
+	mutable std::shared_ptr<Image> _inlineThumbnail;
 	std::array<PhotoImage, kPhotoSizeCount>  _images;
 	QByteArray _videoBytes;
 
@@ -17,6 +17,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_channel.h"
 #include "data/data_messages.h"
 #include "lang/lang_keys.h"
+#include "api/api_hash.h"
 #include "apiwrap.h"
 
 namespace Data {
@@ -53,6 +54,27 @@ struct RepliesList::Viewer {
 RepliesList::RepliesList(not_null<History*> history, MsgId rootId)
 : _history(history)
 , _rootId(rootId) {
+	// The list may be kept while no one views it, so track it always.
+	_history->session().changes().messageUpdates(
+		MessageUpdate::Flag::NewAdded
+		| MessageUpdate::Flag::NewMaybeAdded
+		| MessageUpdate::Flag::Destroyed
+	) | rpl::filter([=](const MessageUpdate &update) {
+		return applyUpdate(update);
+	}) | rpl::start_with_next([=] {
+		_listChanges.fire({});
+	}, _lifetime);
+
+	_history->owner().channelDifferenceTooLong(
+	) | rpl::filter([=](not_null<ChannelData*> channel) {
+		if (_history->peer != channel || !_skippedAfter.has_value()) {
+			return false;
+		}
+		_skippedAfter = std::nullopt;
+		return true;
+	}) | rpl::start_with_next([=] {
+		_listChanges.fire({});
+	}, _lifetime);
 }
 
 RepliesList::~RepliesList() {
@@ -89,11 +111,9 @@ rpl::producer<MessagesSlice> RepliesList::source(
 		viewer->limitAfter = limitAfter;
 
 		_history->session().changes().messageUpdates(
-			MessageUpdate::Flag::NewAdded
-			| MessageUpdate::Flag::NewMaybeAdded
-			| MessageUpdate::Flag::Destroyed
+			MessageUpdate::Flag::Destroyed
 		) | rpl::filter([=](const MessageUpdate &update) {
-			return applyUpdate(viewer, update);
+			return injectedDestroyed(viewer, update);
 		}) | rpl::start_with_next(pushDelayed, lifetime);
 
 		_history->session().changes().historyUpdates(
@@ -101,18 +121,11 @@ rpl::producer<MessagesSlice> RepliesList::source(
 			Data::HistoryUpdate::Flag::ClientSideMessages
 		) | rpl::start_with_next(pushDelayed, lifetime);
 
-		_partLoaded.events(
+		rpl::merge(
+			_partLoaded.events(),
+			_listChanges.events()
 		) | rpl::start_with_next(pushDelayed, lifetime);
 
-		_history->owner().channelDifferenceTooLong(
-		) | rpl::filter([=](not_null<ChannelData*> channel) {
-			if (_history->peer != channel || !_skippedAfter.has_value()) {
-				return false;
-			}
-			_skippedAfter = std::nullopt;
-			return true;
-		}) | rpl::start_with_next(pushDelayed, lifetime);
-
 		push();
 		return lifetime;
 	};
@@ -370,21 +383,26 @@ bool RepliesList::buildFromData(not_null<Viewer*> viewer) {
 	return true;
 }
 
-bool RepliesList::applyUpdate(
+bool RepliesList::injectedDestroyed(
 		not_null<Viewer*> viewer,
-		const MessageUpdate &update) {
-	if (update.item->history() != _history || !update.item->isRegular()) {
-		return false;
-	}
-	if (update.flags & MessageUpdate::Flag::Destroyed) {
-		const auto id = update.item->fullId();
-		for (auto i = 0; i != viewer->injectedForRoot; ++i) {
-			if (viewer->slice.ids[i] == id) {
-				return true;
-			}
+		const MessageUpdate &update) const {
+	const auto id = update.item->fullId();
+	for (auto i = 0; i != viewer->injectedForRoot; ++i) {
+		if (viewer->slice.ids[i] == id) {
+			return true;
 		}
 	}
-	if (update.item->replyToTop() != _rootId) {
+	return false;
+}
+
+bool RepliesList::applyUpdate(const MessageUpdate &update) {
+	if ((update.flags & MessageUpdate::Flag::Destroyed)
+		&& (update.item == _divider)) {
+		_divider = nullptr;
+		return false;
+	} else if (update.item->history() != _history
+		|| !update.item->isRegular()
+		|| update.item->replyToTop() != _rootId) {
 		return false;
 	}
 	const auto id = update.item->id;
@@ -425,7 +443,22 @@ HistoryItem *RepliesList::lookupRoot() {
 	return _history->owner().message(_history->peer->id, _rootId);
 }
 
-void RepliesList::loadAround(MsgId id) {
+void RepliesList::reconcile() {
+	if (_list.empty()
+		|| _skippedAfter != 0
+		|| _loadingAround
+		|| _beforeId
+		|| _afterId) {
+		return;
+	}
+	const auto count = std::min(int(_list.size()), kMessagesPerPage);
+	const auto hash = Api::CountHash(_list
+		| ranges::views::take(count)
+		| ranges::views::transform(&MsgId::bare));
+	loadAround(0, hash);
+}
+
+void RepliesList::loadAround(MsgId id, uint64 hash) {
 	if (_loadingAround && *_loadingAround == id) {
 		return;
 	}
@@ -442,13 +475,15 @@ void RepliesList::loadAround(MsgId id) {
 			MTP_int(kMessagesPerPage), // limit
 			MTP_int(0), // max_id
 			MTP_int(0), // min_id
-			MTP_long(0) // hash
+			MTP_long(hash)
 		)).done([=](const MTPmessages_Messages &result) {
 			_beforeId = 0;
 			_loadingAround = std::nullopt;
 			finish();
 
-			if (!id) {
+			if (result.type() == mtpc_messages_messagesNotModified) {
+				return;
+			} else if (!id) {
 				_skippedAfter = 0;
 			} else {
 				_skippedAfter = std::nullopt;
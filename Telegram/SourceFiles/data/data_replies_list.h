@@ -24,6 +24,13 @@ public:
 	RepliesList(not_null<History*> history, MsgId rootId);
 	~RepliesList();
 
+	[[nodiscard]] not_null<History*> history() const {
+		return _history;
+	}
+	[[nodiscard]] MsgId rootId() const {
+		return _rootId;
+	}
+
 	[[nodiscard]] rpl::producer<MessagesSlice> source(
 		MessagePosition aroundId,
 		int limitBefore,
@@ -36,6 +43,9 @@ public:
 		MsgId wasReadTillId,
 		std::optional<int> wasUnreadCountAfter) const;
 
+	// Checks that the newest loaded part is still actual.
+	void reconcile();
+
 private:
 	struct Viewer;
 
@@ -49,16 +59,17 @@ private:
 	void appendClientSideMessages(MessagesSlice &slice);
 
 	[[nodiscard]] bool buildFromData(not_null<Viewer*> viewer);
-	[[nodiscard]] bool applyUpdate(
+	[[nodiscard]] bool applyUpdate(const MessageUpdate &update);
+	[[nodiscard]] bool injectedDestroyed(
 		not_null<Viewer*> viewer,
-		const MessageUpdate &update);
+		const MessageUpdate &update) const;
 	void injectRootMessageAndReverse(not_null<Viewer*> viewer);
 	void injectRootMessage(not_null<Viewer*> viewer);
 	void injectRootDivider(
 		not_null<HistoryItem*> root,
 		not_null<MessagesSlice*> slice);
 	bool processMessagesIsEmpty(const MTPmessages_Messages &result);
-	void loadAround(MsgId id);
+	void loadAround(MsgId id, uint64 hash = 0);
 	void loadBefore();
 	void loadAfter();
 
@@ -69,12 +80,15 @@ private:
 	std::optional<int> _skippedAfter;
 	rpl::variable<std::optional<int>> _fullCount;
 	rpl::event_stream<> _partLoaded;
+	rpl::event_stream<> _listChanges;
 	std::optional<MsgId> _loadingAround;
 	HistoryService *_divider = nullptr;
 	bool _dividerWithComments = false;
 	int _beforeId = 0;
 	int _afterId = 0;
 
+	rpl::lifetime _lifetime;
+
 };
 
 } // namespace Data
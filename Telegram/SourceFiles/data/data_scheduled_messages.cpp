@@ -16,12 +16,15 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history.h"
 #include "history/history_item_components.h"
 #include "history/history_message.h"
+#include "storage/storage_account.h"
+#include "core/version.h"
 #include "apiwrap.h"
 
 namespace Data {
 namespace {
 
 constexpr auto kRequestTimeLimit = 60 * crl::time(1000);
+constexpr auto kSaveLocalDelay = crl::time(1000);
 
 [[nodiscard]] bool TooEarlyForRequest(crl::time received) {
 	return (received > 0) && (received + kRequestTimeLimit > crl::now());
@@ -78,11 +81,61 @@ MTPMessage PrepareMessage(const MTPMessage &message) {
 	});
 }
 
+[[nodiscard]] bool AlreadySent(const MTPMessage &message) {
+	const auto date = message.match([](const MTPDmessageEmpty &) {
+		return TimeId(0);
+	}, [](const auto &data) {
+		return data.vdate().v;
+	});
+	return (date != ScheduledMessages::kScheduledUntilOnlineTimestamp)
+		&& (date <= base::unixtime::now());
+}
+
+[[nodiscard]] QByteArray SerializeMessages(
+		const base::flat_map<MsgId, MTPMessage> &messages) {
+	if (messages.empty()) {
+		return QByteArray();
+	}
+	auto list = QVector<MTPMessage>();
+	list.reserve(messages.size());
+	for (const auto &[id, message] : messages) {
+		list.push_back(message);
+	}
+	const auto vector = MTP_vector<MTPMessage>(std::move(list));
+	auto buffer = mtpBuffer();
+	buffer.reserve(1 + tl::count_length(vector) / sizeof(mtpPrime));
+
+	// Raw TL may change with any app update, so it is tagged by version.
+	buffer.push_back(mtpPrime(AppVersion));
+	vector.write(buffer);
+	return QByteArray(
+		reinterpret_cast<const char*>(buffer.constData()),
+		buffer.size() * sizeof(mtpPrime));
+}
+
+[[nodiscard]] QVector<MTPMessage> DeserializeMessages(
+		const QByteArray &serialized) {
+	if (serialized.isEmpty() || (serialized.size() % sizeof(mtpPrime))) {
+		return {};
+	}
+	auto buffer = mtpBuffer(serialized.size() / sizeof(mtpPrime));
+	memcpy(buffer.data(), serialized.constData(), serialized.size());
+	if (buffer.front() != mtpPrime(AppVersion)) {
+		return {};
+	}
+	auto from = buffer.constData() + 1;
+	auto result = MTPVector<MTPMessage>();
+	return result.read(from, from + buffer.size())
+		? result.v
+		: QVector<MTPMessage>();
+}
+
 } // namespace
 
 ScheduledMessages::ScheduledMessages(not_null<Session*> owner)
 : _session(&owner->session())
-, _clearTimer([=] { clearOldRequests(); }) {
+, _clearTimer([=] { clearOldRequests(); })
+, _saveLocalTimer([=] { saveLocal(); }) {
 	owner->itemRemoved(
 	) | rpl::filter([](not_null<const HistoryItem*> item) {
 		return item->isScheduled();
@@ -379,8 +432,12 @@ void ScheduledMessages::request(not_null<History*> history) {
 	if (request.requestId || TooEarlyForRequest(request.lastReceived)) {
 		return;
 	}
+	readLocal(history);
+
+	// Users and chats of a restored list are not saved, so we need
+	// the full list with them instead of messagesNotModified.
 	const auto i = _data.find(history);
-	const auto hash = (i != end(_data))
+	const auto hash = (i != end(_data) && !_localRestored.contains(history))
 		? countListHash(i->second)
 		: uint64(0);
 	request.requestId = _session->api().request(
@@ -400,6 +457,7 @@ void ScheduledMessages::parse(
 	auto &request = _requests[history];
 	request.lastReceived = crl::now();
 	request.requestId = 0;
+	_localRestored.remove(history);
 	if (!_clearTimer.isActive()) {
 		_clearTimer.callOnce(kRequestTimeLimit * 2);
 	}
@@ -461,6 +519,8 @@ HistoryItem *ScheduledMessages::append(
 			existing->updateDate(data.vdate().v);
 			history->owner().requestItemTextRefresh(existing);
 		}, [&](const auto &data) {});
+		list.received.emplace_or_assign(id, message);
+		saveLocalDelayed(history);
 		return existing;
 	}
 
@@ -476,6 +536,8 @@ HistoryItem *ScheduledMessages::append(
 	list.items.emplace_back(item);
 	list.itemById.emplace(id, item);
 	list.idByItem.emplace(item, id);
+	list.received.emplace_or_assign(id, message);
+	saveLocalDelayed(history);
 	return item;
 }
 
@@ -525,7 +587,9 @@ void ScheduledMessages::remove(not_null<const HistoryItem*> item) {
 		const auto j = list.idByItem.find(item);
 		Assert(j != end(list.idByItem));
 		list.itemById.remove(j->second);
+		list.received.remove(j->second);
 		list.idByItem.erase(j);
+		saveLocalDelayed(history);
 	}
 	const auto k = ranges::find(list.items, item, &OwnedItem::get);
 	Assert(k != list.items.end());
@@ -538,6 +602,60 @@ void ScheduledMessages::remove(not_null<const HistoryItem*> item) {
 	_updates.fire_copy(history);
 }
 
+void ScheduledMessages::readLocal(not_null<History*> history) {
+	if (_localRead.contains(history)) {
+		return;
+	}
+	_localRead.emplace(history);
+	if (_data.contains(history)) {
+		// The server list will replace the saved one anyway.
+		return;
+	}
+	const auto messages = DeserializeMessages(
+		_session->local().readScheduledMessages(history->peer->id));
+	if (messages.isEmpty()) {
+		return;
+	}
+	auto &list = _data.emplace(history, List()).first->second;
+	for (const auto &message : messages) {
+		if (!AlreadySent(message)) {
+			append(history, list, message);
+		}
+	}
+	_localToSave.remove(history);
+	if (list.items.empty()) {
+		_data.remove(history);
+		return;
+	}
+	sort(list);
+	_localRestored.emplace(history);
+
+	// We're called from updates(), let the caller subscribe first.
+	crl::on_main(_session, [=] {
+		_updates.fire_copy(history);
+	});
+}
+
+void ScheduledMessages::saveLocalDelayed(not_null<History*> history) {
+	_localToSave.emplace(history);
+	if (!_saveLocalTimer.isActive()) {
+		_saveLocalTimer.callOnce(kSaveLocalDelay);
+	}
+}
+
+void ScheduledMessages::saveLocal() {
+	auto lists = base::flat_map<PeerId, QByteArray>();
+	for (const auto &history : base::take(_localToSave)) {
+		const auto i = _data.find(history);
+		lists.emplace(
+			history->peer->id,
+			((i != end(_data))
+				? SerializeMessages(i->second.received)
+				: QByteArray()));
+	}
+	_session->local().writeScheduledMessages(std::move(lists));
+}
+
 uint64 ScheduledMessages::countListHash(const List &list) const {
 	using namespace Api;
 
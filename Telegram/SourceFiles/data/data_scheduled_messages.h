@@ -58,6 +58,9 @@ private:
 		std::vector<OwnedItem> items;
 		base::flat_map<MsgId, not_null<HistoryItem*>> itemById;
 		base::flat_map<not_null<HistoryItem*>, MsgId> idByItem;
+
+		// Server messages by their ids, saved to the local storage.
+		base::flat_map<MsgId, MTPMessage> received;
 	};
 	struct Request {
 		mtpRequestId requestId = 0;
@@ -82,12 +85,20 @@ private:
 	[[nodiscard]] uint64 countListHash(const List &list) const;
 	void clearOldRequests();
 
+	void readLocal(not_null<History*> history);
+	void saveLocalDelayed(not_null<History*> history);
+	void saveLocal();
+
 	const not_null<Main::Session*> _session;
 
 	base::Timer _clearTimer;
+	base::Timer _saveLocalTimer;
 	base::flat_map<not_null<History*>, List> _data;
 	base::flat_map<not_null<History*>, Request> _requests;
 	rpl::event_stream<not_null<History*>> _updates;
+	base::flat_set<not_null<History*>> _localRead;
+	base::flat_set<not_null<History*>> _localRestored;
+	base::flat_set<not_null<History*>> _localToSave;
 
 	rpl::lifetime _lifetime;
 
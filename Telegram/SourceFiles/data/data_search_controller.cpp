@@ -12,8 +12,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_messages.h"
 #include "data/data_channel.h"
 #include "data/data_histories.h"
+#include "data/data_history_tags_index.h"
 #include "history/history.h"
 #include "history/history_item.h"
+#include "history/view/history_view_element.h"
 #include "apiwrap.h"
 
 namespace Api {
@@ -21,45 +23,52 @@ namespace {
 
 constexpr auto kSharedMediaLimit = 100;
 constexpr auto kDefaultSearchTimeoutMs = crl::time(200);
+constexpr auto kMaxCachedQueries = 8;
+
+// Searching loaded messages of all chats runs on the main thread.
+constexpr auto kLoadedSearchChatsLimit = 100;
+constexpr auto kLoadedSearchMessagesLimit = 20000;
 
 } // namespace
 
+MTPMessagesFilter PrepareSearchFilter(Storage::SharedMediaType type) {
+	using Type = Storage::SharedMediaType;
+	switch (type) {
+	case Type::Photo:
+		return MTP_inputMessagesFilterPhotos();
+	case Type::Video:
+		return MTP_inputMessagesFilterVideo();
+	case Type::PhotoVideo:
+		return MTP_inputMessagesFilterPhotoVideo();
+	case Type::MusicFile:
+		return MTP_inputMessagesFilterMusic();
+	case Type::File:
+		return MTP_inputMessagesFilterDocument();
+	case Type::VoiceFile:
+		return MTP_inputMessagesFilterVoice();
+	case Type::RoundVoiceFile:
+		return MTP_inputMessagesFilterRoundVoice();
+	case Type::RoundFile:
+		return MTP_inputMessagesFilterRoundVideo();
+	case Type::GIF:
+		return MTP_inputMessagesFilterGif();
+	case Type::Link:
+		return MTP_inputMessagesFilterUrl();
+	case Type::ChatPhoto:
+		return MTP_inputMessagesFilterChatPhotos();
+	case Type::Pinned:
+		return MTP_inputMessagesFilterPinned();
+	}
+	return MTP_inputMessagesFilterEmpty();
+}
+
 std::optional<MTPmessages_Search> PrepareSearchRequest(
 		not_null<PeerData*> peer,
 		Storage::SharedMediaType type,
 		const QString &query,
 		MsgId messageId,
 		Data::LoadDirection direction) {
-	const auto filter = [&] {
-		using Type = Storage::SharedMediaType;
-		switch (type) {
-		case Type::Photo:
-			return MTP_inputMessagesFilterPhotos();
-		case Type::Video:
-			return MTP_inputMessagesFilterVideo();
-		case Type::PhotoVideo:
-			return MTP_inputMessagesFilterPhotoVideo();
-		case Type::MusicFile:
-			return MTP_inputMessagesFilterMusic();
-		case Type::File:
-			return MTP_inputMessagesFilterDocument();
-		case Type::VoiceFile:
-			return MTP_inputMessagesFilterVoice();
-		case Type::RoundVoiceFile:
-			return MTP_inputMessagesFilterRoundVoice();
-		case Type::RoundFile:
-			return MTP_inputMessagesFilterRoundVideo();
-		case Type::GIF:
-			return MTP_inputMessagesFilterGif();
-		case Type::Link:
-			return MTP_inputMessagesFilterUrl();
-		case Type::ChatPhoto:
-			return MTP_inputMessagesFilterChatPhotos();
-		case Type::Pinned:
-			return MTP_inputMessagesFilterPinned();
-		}
-		return MTP_inputMessagesFilterEmpty();
-	}();
+	const auto filter = PrepareSearchFilter(type);
 	if (query.isEmpty() && filter.type() == mtpc_inputMessagesFilterEmpty) {
 		return std::nullopt;
 	}
@@ -202,6 +211,124 @@ SearchController::CacheEntry::CacheEntry(
 	: std::nullopt) {
 }
 
+std::vector<not_null<HistoryItem*>> SearchLoadedMessages(
+		not_null<History*> history,
+		const QString &query,
+		PeerData *from,
+		int limit) {
+	auto scanLeft = std::numeric_limits<int>::max();
+	return SearchLoadedMessages(history, query, from, limit, scanLeft);
+}
+
+std::vector<not_null<HistoryItem*>> SearchLoadedMessages(
+		not_null<History*> history,
+		const QString &query,
+		PeerData *from,
+		int limit,
+		int &scanLeft) {
+	const auto tag = query.trimmed();
+	const auto single = !tag.isEmpty()
+		&& !ranges::any_of(tag, [](QChar ch) { return ch.isSpace(); });
+	if (single && limit > 0) {
+		// Hashtags, mentions and links are answered by the index.
+		auto result = history->tagsIndex().lookup(
+			tag,
+			from ? std::numeric_limits<int>::max() : limit);
+		if (from) {
+			result.erase(ranges::remove_if(result, [&](auto item) {
+				return (item->from() != from);
+			}), end(result));
+			if (int(result.size()) > limit) {
+				result.resize(limit);
+			}
+		}
+		if (!result.empty() || tag.startsWith('#') || tag.startsWith('@')) {
+			return result;
+		}
+	}
+	const auto words = TextUtilities::PrepareSearchWords(query);
+	if (words.isEmpty() || limit <= 0) {
+		return {};
+	}
+	auto result = std::vector<not_null<HistoryItem*>>();
+	for (const auto &block : ranges::views::reverse(history->blocks)) {
+		for (const auto &view : ranges::views::reverse(block->messages)) {
+			if (scanLeft <= 0) {
+				return result;
+			}
+			--scanLeft;
+			const auto item = view->data();
+			if (item->isService() || (from && item->from() != from)) {
+				continue;
+			}
+			const auto &text = item->originalText().text;
+			if (text.isEmpty()) {
+				continue;
+			}
+			const auto prepared = TextUtilities::RemoveAccents(text).toLower();
+			const auto matches = ranges::all_of(words, [&](const QString &word) {
+				return prepared.contains(word);
+			});
+			if (matches) {
+				result.push_back(item);
+				if (int(result.size()) == limit) {
+					return result;
+				}
+			}
+		}
+	}
+	return result;
+}
+
+std::vector<not_null<HistoryItem*>> SearchLoadedMessages(
+		const std::vector<not_null<History*>> &histories,
+		const QString &query,
+		int limit) {
+	// Only the first chats are searched and the scanned messages count
+	// is limited, the server results replace these anyway.
+	auto lists = std::vector<std::vector<not_null<HistoryItem*>>>();
+	auto scanLeft = kLoadedSearchMessagesLimit;
+	const auto count = std::min(
+		int(histories.size()),
+		kLoadedSearchChatsLimit);
+	for (auto i = 0; i != count && scanLeft > 0; ++i) {
+		auto found = SearchLoadedMessages(
+			histories[i],
+			query,
+			nullptr,
+			limit,
+			scanLeft);
+		if (!found.empty()) {
+			lists.push_back(std::move(found));
+		}
+	}
+
+	// Each list is newest first, take from the one with the latest head.
+	using Position = std::pair<int, int>;
+	const auto earlier = [&](Position a, Position b) {
+		return lists[a.first][a.second]->date()
+			< lists[b.first][b.second]->date();
+	};
+	auto heap = std::vector<Position>();
+	heap.reserve(lists.size());
+	for (auto i = 0; i != int(lists.size()); ++i) {
+		heap.emplace_back(i, 0);
+	}
+	std::make_heap(begin(heap), end(heap), earlier);
+	auto result = std::vector<not_null<HistoryItem*>>();
+	while (!heap.empty() && int(result.size()) < limit) {
+		std::pop_heap(begin(heap), end(heap), earlier);
+		auto &[list, index] = heap.back();
+		result.push_back(lists[list][index]);
+		if (++index < int(lists[list].size())) {
+			std::push_heap(begin(heap), end(heap), earlier);
+		} else {
+			heap.pop_back();
+		}
+	}
+	return result;
+}
+
 SearchController::SearchController(not_null<Main::Session*> session)
 : _session(session) {
 }
@@ -218,10 +345,25 @@ void SearchController::setQuery(const Query &query) {
 		_current = _cache.find(query);
 	}
 	if (_current == _cache.end()) {
+		removeLeastUsed();
 		_current = _cache.emplace(
 			query,
 			std::make_unique<CacheEntry>(_session, query)).first;
 	}
+	_current->second->used = ++_usedCounter;
+}
+
+void SearchController::removeLeastUsed() {
+	// The most recent query may still have viewers, it is never the least
+	// used one while there is room for more than one query in the cache.
+	while (_cache.size() >= kMaxCachedQueries) {
+		const auto i = ranges::min_element(
+			_cache,
+			ranges::less(),
+			[](const auto &pair) { return pair.second->used; });
+		_cache.erase(i);
+	}
+	_current = _cache.end();
 }
 
 rpl::producer<SparseIdsMergedSlice> SearchController::idsSlice(
@@ -344,6 +486,7 @@ void SearchController::restoreState(SavedState &&state) {
 
 	auto it = _cache.find(state.query);
 	if (it == _cache.end()) {
+		removeLeastUsed();
 		it = _cache.emplace(
 			state.query,
 			std::make_unique<CacheEntry>(_session, state.query)).first;
@@ -357,6 +500,7 @@ void SearchController::restoreState(SavedState &&state) {
 		replace.list = std::move(*migrated);
 		it->second->migratedData = std::move(replace);
 	}
+	it->second->used = ++_usedCounter;
 	_current = it;
 }
 
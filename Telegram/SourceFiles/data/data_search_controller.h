@@ -30,6 +30,9 @@ struct SearchResult {
 	int fullCount = 0;
 };
 
+[[nodiscard]] MTPMessagesFilter PrepareSearchFilter(
+	Storage::SharedMediaType type);
+
 std::optional<MTPmessages_Search> PrepareSearchRequest(
 	not_null<PeerData*> peer,
 	Storage::SharedMediaType type,
@@ -44,6 +47,28 @@ SearchResult ParseSearchResult(
 	Data::LoadDirection direction,
 	const MTPmessages_Messages &data);
 
+// Looks through the already loaded part of the history, newest first,
+// so the results can be shown before the server answers.
+std::vector<not_null<HistoryItem*>> SearchLoadedMessages(
+	not_null<History*> history,
+	const QString &query,
+	PeerData *from,
+	int limit);
+
+// Same, but stops after checking scanLeft messages, decreasing it.
+std::vector<not_null<HistoryItem*>> SearchLoadedMessages(
+	not_null<History*> history,
+	const QString &query,
+	PeerData *from,
+	int limit,
+	int &scanLeft);
+
+// Same for the first chats of a list, their results are merged by date.
+std::vector<not_null<HistoryItem*>> SearchLoadedMessages(
+	const std::vector<not_null<History*>> &histories,
+	const QString &query,
+	int limit);
+
 class SearchController final {
 public:
 	using IdsList = Storage::SparseIdsList;
@@ -106,6 +131,7 @@ private:
 
 		Data peerData;
 		std::optional<Data> migratedData;
+		uint64 used = 0;
 	};
 
 	struct CacheLess {
@@ -128,10 +154,12 @@ private:
 		const SparseIdsSliceBuilder::AroundData &key,
 		const Query &query,
 		Data *listData);
+	void removeLeastUsed();
 
 	const not_null<Main::Session*> _session;
 	Cache _cache;
 	Cache::iterator _current = _cache.end();
+	uint64 _usedCounter = 0;
 
 };
 
@@ -12,6 +12,12 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/view/history_view_send_action.h"
 
 namespace Data {
+namespace {
+
+// All the indicators are moved together at most that often.
+constexpr auto kAnimationFrameDelay = crl::time(1000) / 30;
+
+} // namespace
 
 SendActionManager::SendActionManager()
 : _animation([=](crl::time now) { return callback(now); }) {
@@ -115,6 +121,10 @@ void SendActionManager::repliesPaintersClear(
 }
 
 bool SendActionManager::callback(crl::time now) {
+	if (now < _lastAnimationFrame + kAnimationFrameDelay) {
+		return true;
+	}
+	_lastAnimationFrame = now;
 	for (auto i = begin(_sendActions); i != end(_sendActions);) {
 		const auto sendAction = lookupPainter(
 			i->first.first,
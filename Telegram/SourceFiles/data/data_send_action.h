@@ -66,6 +66,7 @@ private:
 		std::pair<not_null<History*>, MsgId>,
 		crl::time> _sendActions;
 	Ui::Animations::Basic _animation;
+	crl::time _lastAnimationFrame = 0;
 
 	rpl::event_stream<AnimationUpdate> _animationUpdate;
 	rpl::event_stream<not_null<History*>> _speakingAnimationUpdate;
@@ -13,6 +13,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "apiwrap.h"
 #include "mainwidget.h"
 #include "api/api_text_entities.h"
+#include "api/api_updates_replay.h"
 #include "core/application.h"
 #include "core/mime_type.h" // Core::IsMimeSticker
 #include "core/crash_reports.h" // CrashReports::SetAnnotation
@@ -29,6 +30,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/view/history_view_element.h"
 #include "inline_bots/inline_bot_layout_item.h"
 #include "storage/storage_account.h"
+#include "storage/storage_domain.h"
 #include "storage/storage_encrypted_file.h"
 #include "media/player/media_player_instance.h" // instance()->play()
 #include "media/audio/media_audio.h"
@@ -58,6 +60,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_cloud_themes.h"
 #include "data/data_streaming.h"
 #include "data/data_media_rotation.h"
+#include "data/data_documents_saver.h"
+#include "data/data_auto_download_scheduler.h"
 #include "data/data_histories.h"
 #include "base/platform/base_platform_info.h"
 #include "base/unixtime.h"
@@ -71,6 +75,7 @@ namespace Data {
 namespace {
 
 constexpr auto kMaxNotifyCheckDelay = 24 * 3600 * crl::time(1000);
+constexpr auto kInlineThumbnailsCacheSize = 24;
 
 using ViewElement = HistoryView::Element;
 
@@ -215,6 +220,23 @@ std::vector<UnavailableReason> ExtractUnavailableReasons(
 
 } // namespace
 
+PreparedMessageTexts PrepareMessageTexts(
+		const QVector<MTPMessage> &messages) {
+	auto result = PreparedMessageTexts();
+	for (const auto &message : messages) {
+		message.match([&](const MTPDmessage &data) {
+			result.emplace(data.vid().v, TextWithEntities{
+				TextUtilities::Clean(qs(data.vmessage())),
+				Api::EntitiesFromMTP(
+					nullptr,
+					data.ventities().value_or_empty())
+			});
+		}, [](const auto &) {
+		});
+	}
+	return result;
+}
+
 Session::Session(not_null<Main::Session*> session)
 : _session(session)
 , _cache(Core::App().databases().get(
@@ -223,6 +245,8 @@ Session::Session(not_null<Main::Session*> session)
 , _bigFileCache(Core::App().databases().get(
 	_session->local().cacheBigFilePath(),
 	_session->local().cacheBigFileSettings()))
+, _sharedCache(_session->domainLocal().acquireSharedCache(
+	_session->local().cacheSettings()))
 , _chatsList(
 	session,
 	FilterId(),
@@ -240,6 +264,8 @@ Session::Session(not_null<Main::Session*> session)
 , _sendActionManager(std::make_unique<SendActionManager>())
 , _streaming(std::make_unique<Streaming>(this))
 , _mediaRotation(std::make_unique<MediaRotation>())
+, _documentsSaver(std::make_unique<DocumentsSaver>(this))
+, _autoDownloadScheduler(std::make_unique<AutoDownloadScheduler>(this))
 , _histories(std::make_unique<Histories>(this))
 , _stickers(std::make_unique<Stickers>(this))
 , _sponsoredMessages(std::make_unique<SponsoredMessages>(this))
@@ -299,6 +325,8 @@ void Session::clear() {
 	_games.clear();
 	_documents.clear();
 	_photos.clear();
+	_inlineThumbnails.clear();
+	_decodedThumbnails.clear();
 }
 
 void Session::keepAlive(std::shared_ptr<PhotoMedia> media) {
@@ -313,6 +341,30 @@ void Session::keepAlive(std::shared_ptr<DocumentMedia> media) {
 	crl::on_main(&session(), [media = std::move(media)] {});
 }
 
+std::shared_ptr<Image> Session::inlineThumbnail(const QByteArray &bytes) {
+	const auto i = ranges::find(
+		_inlineThumbnails,
+		bytes,
+		&std::pair<QByteArray, std::shared_ptr<Image>>::first);
+	if (i != end(_inlineThumbnails)) {
+		auto result = i->second;
+		if (i + 1 != end(_inlineThumbnails)) {
+			std::rotate(i, i + 1, end(_inlineThumbnails));
+		}
+		return result;
+	}
+	auto image = Images::FromInlineBytes(bytes);
+	if (image.isNull()) {
+		return nullptr;
+	}
+	auto result = std::make_shared<Image>(std::move(image));
+	if (_inlineThumbnails.size() >= kInlineThumbnailsCacheSize) {
+		_inlineThumbnails.erase(begin(_inlineThumbnails));
+	}
+	_inlineThumbnails.emplace_back(bytes, result);
+	return result;
+}
+
 not_null<PeerData*> Session::peer(PeerId id) {
 	const auto i = _peers.find(id);
 	if (i != _peers.cend()) {
@@ -1044,6 +1096,14 @@ Storage::Cache::Database &Session::cacheBigFile() {
 	return *_bigFileCache;
 }
 
+DecodedThumbnails &Session::decodedThumbnails() {
+	return _decodedThumbnails;
+}
+
+Storage::Cache::Database &Session::sharedCache() {
+	return *_sharedCache;
+}
+
 void Session::suggestStartExport(TimeId availableAt) {
 	_exportAvailableAt = availableAt;
 	suggestStartExport();
@@ -1191,7 +1251,9 @@ void Session::setupUserIsContactViewer() {
 	}, _lifetime);
 }
 
-Session::~Session() = default;
+Session::~Session() {
+	_session->domainLocal().releaseSharedCache();
+}
 
 template <typename Method>
 void Session::enumerateItemViews(
@@ -1594,6 +1656,11 @@ void Session::unloadHeavyViewParts(
 	for (const auto view : remove) {
 		view->unloadHeavyPart();
 	}
+	if (!remove.empty()) {
+		DEBUG_LOG(("Images: %1 bytes decoded, %2 bytes kept in memory cache."
+			).arg(Image::ResidentBytes()
+			).arg(_decodedThumbnails.totalSize()));
+	}
 }
 
 void Session::registerShownSpoiler(FullMsgId id) {
@@ -1878,6 +1945,10 @@ void Session::updateEditedMessage(const MTPMessage &data) {
 void Session::processMessages(
 		const QVector<MTPMessage> &data,
 		NewMessageType type) {
+	if (Api::UpdatesReplay::Recording()) {
+		Api::UpdatesReplay::RecordMessages(data, type);
+	}
+	suspendUpdates();
 	auto indices = base::flat_map<uint64, int>();
 	for (int i = 0, l = data.size(); i != l; ++i) {
 		const auto &message = data[i];
@@ -1898,6 +1969,7 @@ void Session::processMessages(
 			MessageFlags(),
 			type);
 	}
+	resumeUpdates();
 }
 
 void Session::processMessages(
@@ -2030,6 +2102,57 @@ void Session::processMessagesDeleted(
 	}
 }
 
+void Session::setPreparedMessageTexts(
+		PeerId peerId,
+		PreparedMessageTexts &&texts) {
+	_preparedMessageTextsPeerId = peerId;
+	_preparedMessageTexts = std::move(texts);
+}
+
+void Session::clearPreparedMessageTexts() {
+	_preparedMessageTextsPeerId = 0;
+	_preparedMessageTexts.clear();
+}
+
+std::optional<TextWithEntities> Session::takePreparedMessageText(
+		PeerId peerId,
+		MsgId itemId) {
+	if (peerId != _preparedMessageTextsPeerId) {
+		return std::nullopt;
+	}
+	const auto i = _preparedMessageTexts.find(itemId);
+	if (i == end(_preparedMessageTexts)) {
+		return std::nullopt;
+	}
+	auto result = std::move(i->second);
+	_preparedMessageTexts.erase(i);
+	Api::ResolveMentionNames(_session, result.entities);
+	return result;
+}
+
+void Session::suspendUpdates() {
+	if (!_updatesSuspended++) {
+		session().changes().suspendNotifications();
+		_groups.suspendViewsRefresh();
+	}
+}
+
+void Session::resumeUpdates() {
+	Expects(_updatesSuspended > 0);
+
+	if (--_updatesSuspended) {
+		return;
+	}
+	while (!_chatListEntriesToRefresh.empty()) {
+		const auto i = _chatListEntriesToRefresh.begin();
+		const auto entry = *i;
+		_chatListEntriesToRefresh.erase(i);
+		refreshChatListEntry(entry);
+	}
+	_groups.resumeViewsRefresh();
+	session().changes().resumeNotifications();
+}
+
 void Session::processNonChannelMessagesDeleted(const QVector<MTPint> &data) {
 	auto historiesToCheck = base::flat_set<not_null<History*>>();
 	for (const auto &messageId : data) {
@@ -3738,6 +3861,11 @@ not_null<Dialogs::IndexedList*> Session::contactsNoChatsList() {
 void Session::refreshChatListEntry(Dialogs::Key key) {
 	Expects(key.entry()->folderKnown());
 
+	if (_updatesSuspended) {
+		_chatListEntriesToRefresh.emplace(key.entry());
+		return;
+	}
+
 	using namespace Dialogs;
 
 	const auto entry = key.entry();
@@ -3757,11 +3885,13 @@ void Session::refreshChatListEntry(Dialogs::Key key) {
 	if (!history) {
 		return;
 	}
-	for (const auto &filter : _chatsFilters->list()) {
-		const auto id = filter.id();
+	const auto membership = _chatsFilters->membership(history);
+	const auto &filters = _chatsFilters->list();
+	for (auto i = 0, count = int(filters.size()); i != count; ++i) {
+		const auto id = filters[i].id();
 		const auto filterList = chatsFilters().chatsList(id);
 		auto event = ChatListEntryRefresh{ .key = key, .filterId = id };
-		if (filter.contains(history)) {
+		if (membership[i]) {
 			event.existenceChanged = !entry->inChatList(id);
 			if (event.existenceChanged) {
 				entry->addToChatList(id, filterList);
@@ -3790,6 +3920,7 @@ void Session::removeChatListEntry(Dialogs::Key key) {
 	using namespace Dialogs;
 
 	const auto entry = key.entry();
+	_chatListEntriesToRefresh.remove(entry);
 	if (!entry->inChatList()) {
 		return;
 	}
@@ -4187,6 +4318,23 @@ uint64 Session::wallpapersHash() const {
 	return _wallpapersHash;
 }
 
+QString Session::debugStats() const {
+	auto messages = _nonChannelMessages.size();
+	for (const auto &[peerId, list] : _messages) {
+		messages += list.size();
+	}
+	return u"peers %1, messages %2, views %3, dependent %4, "
+		"photos %5, documents %6, webpages %7, inline thumbnails %8"_q
+		.arg(_peers.size())
+		.arg(messages)
+		.arg(_views.size())
+		.arg(_dependentMessages.size())
+		.arg(_photos.size())
+		.arg(_documents.size())
+		.arg(_webpages.size())
+		.arg(_inlineThumbnails.size());
+}
+
 void Session::clearLocalStorage() {
 	_cache->close();
 	_cache->clear();
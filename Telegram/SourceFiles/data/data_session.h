@@ -14,6 +14,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_groups.h"
 #include "data/data_cloud_file.h"
 #include "data/data_notify_settings.h"
+#include "data/data_id_map.h"
 #include "history/history_location_manager.h"
 #include "base/timer.h"
 #include "base/flags.h"
@@ -57,12 +58,20 @@ class ChatFilters;
 class CloudThemes;
 class Streaming;
 class MediaRotation;
+class DocumentsSaver;
+class AutoDownloadScheduler;
 class Histories;
 class DocumentMedia;
 class PhotoMedia;
 class Stickers;
 class GroupCall;
 
+using PreparedMessageTexts = base::flat_map<MsgId, TextWithEntities>;
+
+// Can be called from any thread, mention names are left unresolved.
+[[nodiscard]] PreparedMessageTexts PrepareMessageTexts(
+	const QVector<MTPMessage> &messages);
+
 class Session final {
 public:
 	using ViewElement = HistoryView::Element;
@@ -105,6 +114,12 @@ public:
 	[[nodiscard]] MediaRotation &mediaRotation() const {
 		return *_mediaRotation;
 	}
+	[[nodiscard]] DocumentsSaver &documentsSaver() const {
+		return *_documentsSaver;
+	}
+	[[nodiscard]] AutoDownloadScheduler &autoDownloadScheduler() const {
+		return *_autoDownloadScheduler;
+	}
 	[[nodiscard]] Histories &histories() const {
 		return *_histories;
 	}
@@ -124,9 +139,17 @@ public:
 
 	void clear();
 
+	// Sizes of the biggest maps, for the memory reports.
+	[[nodiscard]] QString debugStats() const;
+
 	void keepAlive(std::shared_ptr<PhotoMedia> media);
 	void keepAlive(std::shared_ptr<DocumentMedia> media);
 
+	// Media views are destroyed when they leave the viewport, the recent
+	// inline thumbnails are kept with their blurred pixmaps for reuse.
+	[[nodiscard]] std::shared_ptr<Image> inlineThumbnail(
+		const QByteArray &bytes);
+
 	void suggestStartExport(TimeId availableAt);
 	void clearExportSuggestion();
 
@@ -139,6 +162,8 @@ public:
 
 	[[nodiscard]] Storage::Cache::Database &cache();
 	[[nodiscard]] Storage::Cache::Database &cacheBigFile();
+	[[nodiscard]] Data::DecodedThumbnails &decodedThumbnails();
+	[[nodiscard]] Storage::Cache::Database &sharedCache();
 
 	[[nodiscard]] not_null<PeerData*> peer(PeerId id);
 	[[nodiscard]] not_null<PeerData*> peer(UserId id) = delete;
@@ -364,6 +389,21 @@ public:
 		PeerId peerId,
 		const QVector<MTPint> &data);
 
+	// Texts prepared by PrepareMessageTexts() are used by the
+	// messages of this peer created until the clear call.
+	void setPreparedMessageTexts(
+		PeerId peerId,
+		PreparedMessageTexts &&texts);
+	void clearPreparedMessageTexts();
+	[[nodiscard]] std::optional<TextWithEntities> takePreparedMessageText(
+		PeerId peerId,
+		MsgId itemId);
+
+	// Chat list refreshes and change notifications are coalesced
+	// between these calls, so that a bulk apply re-sorts each entry once.
+	void suspendUpdates();
+	void resumeUpdates();
+
 	[[nodiscard]] MsgId nextLocalMessageId();
 	[[nodiscard]] HistoryItem *message(
 		PeerId peerId,
@@ -690,7 +730,7 @@ public:
 	void clearLocalStorage();
 
 private:
-	using Messages = std::unordered_map<MsgId, not_null<HistoryItem*>>;
+	using Messages = IdMap<MsgId, not_null<HistoryItem*>>;
 
 	void suggestStartExport();
 
@@ -823,6 +863,8 @@ private:
 
 	Storage::DatabasePointer _cache;
 	Storage::DatabasePointer _bigFileCache;
+	const not_null<Storage::Cache::Database*> _sharedCache;
+	Data::DecodedThumbnails _decodedThumbnails;
 
 	TimeId _exportAvailableAt = 0;
 	QPointer<Ui::BoxContent> _exportSuggestion;
@@ -870,7 +912,7 @@ private:
 	std::map<TimeId, base::flat_set<not_null<HistoryItem*>>> _ttlMessages;
 	base::Timer _ttlCheckTimer;
 
-	std::unordered_map<MsgId, not_null<HistoryItem*>> _nonChannelMessages;
+	Messages _nonChannelMessages;
 
 	base::flat_map<uint64, FullMsgId> _messageByRandomId;
 	base::flat_map<uint64, SentData> _sentMessagesData;
@@ -878,19 +920,23 @@ private:
 	base::Timer _selfDestructTimer;
 	std::vector<FullMsgId> _selfDestructItems;
 
-	std::unordered_map<
+	std::vector<std::pair<
+		QByteArray,
+		std::shared_ptr<Image>>> _inlineThumbnails;
+
+	IdMap<
 		PhotoId,
 		std::unique_ptr<PhotoData>> _photos;
 	std::unordered_map<
 		not_null<const PhotoData*>,
 		base::flat_set<not_null<HistoryItem*>>> _photoItems;
-	std::unordered_map<
+	IdMap<
 		DocumentId,
 		std::unique_ptr<DocumentData>> _documents;
 	std::unordered_map<
 		not_null<const DocumentData*>,
 		base::flat_set<not_null<HistoryItem*>>> _documentItems;
-	std::unordered_map<
+	IdMap<
 		WebPageId,
 		std::unique_ptr<WebPageData>> _webpages;
 	std::unordered_map<
@@ -902,10 +948,10 @@ private:
 	std::unordered_map<
 		LocationPoint,
 		std::unique_ptr<Data::CloudImage>> _locations;
-	std::unordered_map<
+	IdMap<
 		PollId,
 		std::unique_ptr<PollData>> _polls;
-	std::unordered_map<
+	IdMap<
 		GameId,
 		std::unique_ptr<GameData>> _games;
 	std::unordered_map<
@@ -943,6 +989,12 @@ private:
 
 	base::flat_set<not_null<ViewElement*>> _heavyViewParts;
 
+	PeerId _preparedMessageTextsPeerId = 0;
+	PreparedMessageTexts _preparedMessageTexts;
+
+	int _updatesSuspended = 0;
+	base::flat_set<not_null<Dialogs::Entry*>> _chatListEntriesToRefresh;
+
 	base::flat_map<uint64, not_null<GroupCall*>> _groupCalls;
 	rpl::event_stream<InviteToCall> _invitesToCalls;
 	base::flat_map<uint64, base::flat_set<not_null<UserData*>>> _invitedToCallUsers;
@@ -960,7 +1012,7 @@ private:
 	std::unordered_set<not_null<const PeerData*>> _mutedPeers;
 	base::Timer _unmuteByFinishedTimer;
 
-	std::unordered_map<PeerId, std::unique_ptr<PeerData>> _peers;
+	IdMap<PeerId, std::unique_ptr<PeerData>> _peers;
 
 	MessageIdsList _mimeForwardIds;
 
@@ -979,6 +1031,8 @@ private:
 	const std::unique_ptr<SendActionManager> _sendActionManager;
 	const std::unique_ptr<Streaming> _streaming;
 	const std::unique_ptr<MediaRotation> _mediaRotation;
+	const std::unique_ptr<DocumentsSaver> _documentsSaver;
+	const std::unique_ptr<AutoDownloadScheduler> _autoDownloadScheduler;
 	const std::unique_ptr<Histories> _histories;
 	const std::unique_ptr<Stickers> _stickers;
 	std::unique_ptr<SponsoredMessages> _sponsoredMessages;
@@ -136,6 +136,11 @@ rpl::producer<SparseIdsSlice> SharedMediaViewer(
 			peer = session->data().peer(key.peerId),
 			type = key.type
 		](const SparseIdsSliceBuilder::AroundData &data) {
+			if (!data.aroundId
+				&& data.direction == Data::LoadDirection::Around) {
+				peer->session().api().requestSharedMediaCount(peer, type);
+				return;
+			}
 			peer->session().api().requestSharedMedia(
 				peer,
 				type,
@@ -184,11 +184,46 @@ bool SparseIdsSliceBuilder::applyUpdate(
 	auto skippedAfter = (update.range.till == ServerMaxMsgId)
 		? 0
 		: std::optional<int> {};
+	if (!needMergeMessages) {
+		mergeSliceData(
+			update.count,
+			base::flat_set<MsgId> {},
+			skippedBefore,
+			skippedAfter);
+		return true;
+	}
+
+	// The storage slice may hold the whole shared media of a channel,
+	// only the part that can survive sliceToLimits() is worth merging.
+	const auto &messages = *update.messages;
+	auto from = messages.begin();
+	auto till = messages.end();
+	if (_key) {
+		const auto around = ranges::lower_bound(messages, _key);
+		const auto before = std::min(
+			int(around - from),
+			_limitBefore);
+		const auto after = std::min(
+			int(till - around),
+			_limitAfter + 1);
+		if (before + after > 0) {
+			from = around - before;
+			till = around + after;
+		}
+	}
+	if (from == messages.begin() && till == messages.end()) {
+		mergeSliceData(update.count, messages, skippedBefore, skippedAfter);
+		return true;
+	}
+	if (skippedBefore) {
+		*skippedBefore += int(from - messages.begin());
+	}
+	if (skippedAfter) {
+		*skippedAfter += int(messages.end() - till);
+	}
 	mergeSliceData(
 		update.count,
-		needMergeMessages
-			? *update.messages
-			: base::flat_set<MsgId> {},
+		base::flat_set<MsgId>(from, till),
 		skippedBefore,
 		skippedAfter);
 	return true;
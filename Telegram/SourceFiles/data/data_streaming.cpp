@@ -15,10 +15,22 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/streaming/media_streaming_reader.h"
 #include "media/streaming/media_streaming_document.h"
 
+#include <thread>
+
 namespace Data {
 namespace {
 
 constexpr auto kKeepAliveTimeout = 5 * crl::time(1000);
+constexpr auto kMinAutoplayBudget = 2;
+constexpr auto kMaxAutoplayBudget = 8;
+
+[[nodiscard]] int ComputeAutoplayBudget() {
+	// One decoder for a core, weak machines still get a couple of them.
+	return std::clamp(
+		int(std::thread::hardware_concurrency()),
+		kMinAutoplayBudget,
+		kMaxAutoplayBudget);
+}
 
 template <typename Object, typename Data>
 bool PruneDestroyedAndSet(
@@ -45,7 +57,8 @@ bool PruneDestroyedAndSet(
 
 Streaming::Streaming(not_null<Session*> owner)
 : _owner(owner)
-, _keptAliveTimer([=] { clearKeptAlive(); }) {
+, _keptAliveTimer([=] { clearKeptAlive(); })
+, _autoplayBudget(ComputeAutoplayBudget()) {
 }
 
 Streaming::~Streaming() = default;
@@ -160,6 +173,37 @@ void Streaming::keepAlive(not_null<PhotoData*> photo) {
 	keepAlive(_photoDocuments, photo);
 }
 
+bool Streaming::requestAutoplay(
+		not_null<DocumentData*> document,
+		not_null<const void*> holder,
+		Fn<void()> retry) {
+	if (_autoplayHolders.contains(holder)) {
+		return true;
+	}
+	auto documents = base::flat_set<not_null<DocumentData*>>();
+	for (const auto &[_, playing] : _autoplayHolders) {
+		documents.emplace(playing);
+	}
+	if (!documents.contains(document)
+		&& int(documents.size()) >= _autoplayBudget) {
+		_autoplayWaiting[holder] = std::move(retry);
+		return false;
+	}
+	_autoplayWaiting.remove(holder);
+	_autoplayHolders.emplace(holder, document);
+	return true;
+}
+
+void Streaming::releaseAutoplay(not_null<const void*> holder) {
+	_autoplayWaiting.remove(holder);
+	if (!_autoplayHolders.remove(holder)) {
+		return;
+	}
+	for (const auto &[_, retry] : base::take(_autoplayWaiting)) {
+		retry();
+	}
+}
+
 void Streaming::clearKeptAlive() {
 	const auto now = crl::now();
 	auto min = std::numeric_limits<crl::time>::max();
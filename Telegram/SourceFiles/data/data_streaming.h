@@ -53,6 +53,16 @@ public:
 	void keepAlive(not_null<DocumentData*> document);
 	void keepAlive(not_null<PhotoData*> photo);
 
+	// Inline autoplay is limited by a global budget of decoded documents.
+	// Views of the same document share the decoder, so they share a slot.
+	// When a slot is not available the retry callback is stored and then
+	// called after some slot is released.
+	[[nodiscard]] bool requestAutoplay(
+		not_null<DocumentData*> document,
+		not_null<const void*> holder,
+		Fn<void()> retry);
+	void releaseAutoplay(not_null<const void*> holder);
+
 private:
 	void clearKeptAlive();
 
@@ -92,6 +102,12 @@ private:
 	base::flat_map<std::shared_ptr<Document>, crl::time> _keptAlive;
 	base::Timer _keptAliveTimer;
 
+	base::flat_map<
+		not_null<const void*>,
+		not_null<DocumentData*>> _autoplayHolders;
+	base::flat_map<not_null<const void*>, Fn<void()>> _autoplayWaiting;
+	const int _autoplayBudget = 0;
+
 };
 
 } // namespace Data
@@ -18,9 +18,14 @@ constexpr auto kDocumentCacheTag = 0x0000000000000100ULL;
 constexpr auto kDocumentCacheMask = 0x00000000000000FFULL;
 constexpr auto kDocumentThumbCacheTag = 0x0000000000000200ULL;
 constexpr auto kDocumentThumbCacheMask = 0x00000000000000FFULL;
+constexpr auto kDocumentStoryboardCacheTag = 0x0000000000000300ULL;
+constexpr auto kDocumentStoryboardCacheMask = 0x00000000000000FFULL;
+constexpr auto kDocumentWaveformCacheTag = 0x0000000000000400ULL;
+constexpr auto kDocumentWaveformCacheMask = 0x00000000000000FFULL;
 constexpr auto kWebDocumentCacheTag = 0x0000020000000000ULL;
 constexpr auto kUrlCacheTag = 0x0000030000000000ULL;
 constexpr auto kGeoPointCacheTag = 0x0000040000000000ULL;
+constexpr auto kStickerSetFramesCacheTag = 0x0000050000000000ULL;
 
 } // namespace
 
@@ -39,6 +44,26 @@ Storage::Cache::Key DocumentThumbCacheKey(int32 dcId, uint64 id) {
 	};
 }
 
+Storage::Cache::Key DocumentStoryboardCacheKey(int32 dcId, uint64 id) {
+	const auto part = (uint64(dcId) & Data::kDocumentStoryboardCacheMask);
+	return Storage::Cache::Key{
+		Data::kDocumentStoryboardCacheTag | part,
+		id
+	};
+}
+
+Storage::Cache::Key DocumentWaveformCacheKey(int32 dcId, uint64 id) {
+	const auto part = (uint64(dcId) & Data::kDocumentWaveformCacheMask);
+	return Storage::Cache::Key{
+		Data::kDocumentWaveformCacheTag | part,
+		id
+	};
+}
+
+Storage::Cache::Key StickerSetFramesCacheKey(uint64 setId) {
+	return Storage::Cache::Key{ Data::kStickerSetFramesCacheTag, setId };
+}
+
 Storage::Cache::Key WebDocumentCacheKey(const WebFileLocation &location) {
 	const auto CacheDcId = 4; // The default production value. Doesn't matter.
 	const auto dcId = uint64(CacheDcId) & 0xFFULL;
@@ -46,6 +46,9 @@ struct UploadState {
 
 Storage::Cache::Key DocumentCacheKey(int32 dcId, uint64 id);
 Storage::Cache::Key DocumentThumbCacheKey(int32 dcId, uint64 id);
+Storage::Cache::Key DocumentStoryboardCacheKey(int32 dcId, uint64 id);
+Storage::Cache::Key DocumentWaveformCacheKey(int32 dcId, uint64 id);
+Storage::Cache::Key StickerSetFramesCacheKey(uint64 setId);
 Storage::Cache::Key WebDocumentCacheKey(const WebFileLocation &location);
 Storage::Cache::Key UrlCacheKey(const QString &location);
 Storage::Cache::Key GeoPointCacheKey(const GeoPointLocation &location);
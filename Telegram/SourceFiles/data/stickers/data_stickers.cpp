@@ -78,7 +78,22 @@ Main::Session &Stickers::session() const {
 	return _owner->session();
 }
 
+void Stickers::setLocalLoader(Fn<void()> loader) {
+	_localLoader = std::move(loader);
+}
+
+void Stickers::ensureLocalLoaded() const {
+	if (_localLoader) {
+		base::take(_localLoader)();
+	}
+}
+
+bool Stickers::localLoaded() const {
+	return !_localLoader;
+}
+
 void Stickers::notifyUpdated() {
+	_emojiIndexValid = false;
 	_updated.fire({});
 }
 
@@ -979,13 +994,13 @@ std::vector<not_null<DocumentData*>> Stickers::getListByEmoji(
 		TimeId date = 0;
 	};
 	auto result = std::vector<StickerWithDate>();
-	auto &sets = setsRef();
-	auto setsToRequest = base::flat_map<uint64, uint64>();
+	auto added = base::flat_set<not_null<DocumentData*>>();
+
+	validateEmojiIndex();
+	const auto &sets = _sets;
 
 	const auto add = [&](not_null<DocumentData*> document, TimeId date) {
-		if (ranges::find(result, document, [](const StickerWithDate &data) {
-			return data.document;
-		}) == result.end()) {
+		if (added.emplace(document).second) {
 			result.push_back({ document, date });
 		}
 	};
@@ -1002,13 +1017,14 @@ std::vector<not_null<DocumentData*>> Stickers::getListByEmoji(
 	const auto CreateRecentSortKey = [&](not_null<DocumentData*> document) {
 		return CreateSortKey(document, kSlice * 6);
 	};
-	auto myCounter = 0;
-	const auto CreateMySortKey = [&](not_null<DocumentData*> document) {
+	const auto CreateMySortKey = [&](
+			not_null<DocumentData*> document,
+			int myIndex) {
 		auto base = kSlice * 6;
 		if (!document->sticker() || !document->sticker()->animated) {
 			base -= kSlice;
 		}
-		return (base - (++myCounter));
+		return (base - myIndex);
 	};
 	const auto CreateFeaturedSortKey = [&](not_null<DocumentData*> document) {
 		return CreateSortKey(document, kSlice * 2);
@@ -1057,47 +1073,32 @@ std::vector<not_null<DocumentData*>> Stickers::getListByEmoji(
 				const auto date = usageDate
 					? usageDate
 					: InstallDate(document);
-				result.push_back({
-					document,
-					date ? date : CreateRecentSortKey(document) });
+				add(document, date ? date : CreateRecentSortKey(document));
 			}
 		}
 	}
-	const auto addList = [&](
-			const StickersSetsOrder &order,
-			SetFlag skip) {
-		for (const auto setId : order) {
-			auto it = sets.find(setId);
-			if (it == sets.cend() || (it->second->flags & skip)) {
-				continue;
-			}
-			const auto set = it->second.get();
-			if (set->emoji.isEmpty()) {
-				setsToRequest.emplace(set->id, set->accessHash);
-				set->flags |= SetFlag::NotLoaded;
-				continue;
-			}
-			auto i = set->emoji.constFind(original);
-			if (i == set->emoji.cend()) {
-				continue;
-			}
-			const auto my = (set->flags & SetFlag::Installed);
-			result.reserve(result.size() + i->size());
-			for (const auto document : *i) {
-				const auto installDate = my ? set->installDate : TimeId(0);
-				const auto date = (installDate > 1)
-					? InstallDateAdjusted(installDate, document)
-					: my
-					? CreateMySortKey(document)
-					: CreateFeaturedSortKey(document);
-				add(document, date);
-			}
+	if (const auto i = _emojiIndex.find(original); i != end(_emojiIndex)) {
+		result.reserve(result.size() + i->second.size());
+		for (const auto &entry : i->second) {
+			const auto document = entry.document;
+			const auto date = (entry.installDate > 1)
+				? InstallDateAdjusted(entry.installDate, document)
+				: entry.my
+				? CreateMySortKey(document, entry.myIndex)
+				: CreateFeaturedSortKey(document);
+			add(document, date);
 		}
-	};
-
-	addList(setsOrder(), SetFlag::Archived);
-	//addList(featuredSetsOrder(), SetFlag::Installed);
+	}
 
+	auto setsToRequest = base::flat_map<uint64, uint64>();
+	for (const auto setId : _emojiIndexNotLoaded) {
+		const auto it = sets.find(setId);
+		if (it != sets.end() && it->second->emoji.isEmpty()) {
+			const auto set = it->second.get();
+			setsToRequest.emplace(set->id, set->accessHash);
+			set->flags |= SetFlag::NotLoaded;
+		}
+	}
 	if (!setsToRequest.empty()) {
 		for (const auto &[setId, accessHash] : setsToRequest) {
 			session().api().scheduleStickerSetRequest(setId, accessHash);
@@ -1128,6 +1129,53 @@ std::vector<not_null<DocumentData*>> Stickers::getListByEmoji(
 	}) | ranges::to_vector;
 }
 
+void Stickers::validateEmojiIndex() {
+	ensureLocalLoaded();
+	if (_emojiIndexValid) {
+		return;
+	}
+	_emojiIndexValid = true;
+	_emojiIndex.clear();
+	_emojiIndexNotLoaded.clear();
+
+	auto myCounters = base::flat_map<EmojiPtr, int>();
+	for (const auto setId : _setsOrder) {
+		const auto it = _sets.find(setId);
+		if (it == _sets.cend() || (it->second->flags & SetFlag::Archived)) {
+			continue;
+		}
+		const auto set = it->second.get();
+		if (set->emoji.isEmpty()) {
+			_emojiIndexNotLoaded.push_back(set->id);
+			continue;
+		}
+		const auto my = (set->flags & SetFlag::Installed);
+		const auto installDate = my ? set->installDate : TimeId(0);
+		for (auto i = set->emoji.cbegin(); i != set->emoji.cend(); ++i) {
+			auto &list = _emojiIndex[i.key()];
+			auto &myCounter = myCounters[i.key()];
+			list.reserve(list.size() + i->size());
+			for (const auto document : *i) {
+				const auto myIndex = (my && installDate <= 1)
+					? ++myCounter
+					: 0;
+				const auto already = ranges::contains(
+					list,
+					not_null<DocumentData*>(document),
+					&EmojiIndexEntry::document);
+				if (!already) {
+					list.push_back({
+						.document = document,
+						.installDate = installDate,
+						.myIndex = myIndex,
+						.my = my,
+					});
+				}
+			}
+		}
+	}
+}
+
 std::optional<std::vector<not_null<EmojiPtr>>> Stickers::getEmojiListFromSet(
 		not_null<DocumentData*> document) {
 	if (auto sticker = document->sticker()) {
@@ -122,40 +122,59 @@ public:
 	[[nodiscard]] rpl::producer<int> featuredSetsUnreadCountValue() const {
 		return _featuredSetsUnreadCount.value();
 	}
+	// Local sticker sets are read on first access to them.
+	void setLocalLoader(Fn<void()> loader);
+	void ensureLocalLoaded() const;
+	[[nodiscard]] bool localLoaded() const;
+
 	const StickersSets &sets() const {
+		ensureLocalLoaded();
 		return _sets;
 	}
 	StickersSets &setsRef() {
+		ensureLocalLoaded();
+		_emojiIndexValid = false;
 		return _sets;
 	}
 	const StickersSetsOrder &setsOrder() const {
+		ensureLocalLoaded();
 		return _setsOrder;
 	}
 	StickersSetsOrder &setsOrderRef() {
+		ensureLocalLoaded();
+		_emojiIndexValid = false;
 		return _setsOrder;
 	}
 	const StickersSetsOrder &maskSetsOrder() const {
+		ensureLocalLoaded();
 		return _maskSetsOrder;
 	}
 	StickersSetsOrder &maskSetsOrderRef() {
+		ensureLocalLoaded();
 		return _maskSetsOrder;
 	}
 	const StickersSetsOrder &featuredSetsOrder() const {
+		ensureLocalLoaded();
 		return _featuredSetsOrder;
 	}
 	StickersSetsOrder &featuredSetsOrderRef() {
+		ensureLocalLoaded();
 		return _featuredSetsOrder;
 	}
 	const StickersSetsOrder &archivedSetsOrder() const {
+		ensureLocalLoaded();
 		return _archivedSetsOrder;
 	}
 	StickersSetsOrder &archivedSetsOrderRef() {
+		ensureLocalLoaded();
 		return _archivedSetsOrder;
 	}
 	const StickersSetsOrder &archivedMaskSetsOrder() const {
+		ensureLocalLoaded();
 		return _archivedMaskSetsOrder;
 	}
 	StickersSetsOrder &archivedMaskSetsOrderRef() {
+		ensureLocalLoaded();
 		return _archivedMaskSetsOrder;
 	}
 	const SavedGifs &savedGifs() const {
@@ -206,6 +225,13 @@ public:
 	RecentStickerPack &getRecentPack() const;
 
 private:
+	struct EmojiIndexEntry {
+		not_null<DocumentData*> document;
+		TimeId installDate = 0;
+		int myIndex = 0;
+		bool my = false;
+	};
+
 	bool updateNeeded(crl::time lastUpdate, crl::time now) const {
 		constexpr auto kUpdateTimeout = crl::time(3600'000);
 		return (lastUpdate == 0)
@@ -232,6 +258,7 @@ private:
 		const QVector<MTPStickerSet> &data,
 		uint64 hash,
 		bool masks);
+	void validateEmojiIndex();
 
 	const not_null<Session*> _owner;
 	rpl::event_stream<> _updated;
@@ -246,6 +273,7 @@ private:
 	crl::time _lastMasksUpdate = 0;
 	crl::time _lastRecentAttachedUpdate = 0;
 	rpl::variable<int> _featuredSetsUnreadCount = 0;
+	mutable Fn<void()> _localLoader;
 	StickersSets _sets;
 	StickersSetsOrder _setsOrder;
 	StickersSetsOrder _maskSetsOrder;
@@ -254,6 +282,11 @@ private:
 	StickersSetsOrder _archivedMaskSetsOrder;
 	SavedGifs _savedGifs;
 
+	// Installed sets stickers by emoji, rebuilt after any sets change.
+	base::flat_map<EmojiPtr, std::vector<EmojiIndexEntry>> _emojiIndex;
+	std::vector<uint64> _emojiIndexNotLoaded;
+	bool _emojiIndexValid = false;
+
 };
 
 } // namespace Data
@@ -88,6 +88,20 @@ inline UnreadState operator-(const UnreadState &a, const UnreadState &b) {
 	return result;
 }
 
+inline bool operator==(const UnreadState &a, const UnreadState &b) {
+	return (a.messages == b.messages)
+		&& (a.messagesMuted == b.messagesMuted)
+		&& (a.chats == b.chats)
+		&& (a.chatsMuted == b.chatsMuted)
+		&& (a.marks == b.marks)
+		&& (a.marksMuted == b.marksMuted)
+		&& (a.known == b.known);
+}
+
+inline bool operator!=(const UnreadState &a, const UnreadState &b) {
+	return !(a == b);
+}
+
 class Entry {
 public:
 	enum class Type {
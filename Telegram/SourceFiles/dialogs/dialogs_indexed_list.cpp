@@ -12,6 +12,23 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history.h"
 
 namespace Dialogs {
+namespace {
+
+// The smallest string greater than every string starting with prefix.
+[[nodiscard]] QString PrefixEnd(QString prefix) {
+	while (!prefix.isEmpty()) {
+		const auto last = prefix.size() - 1;
+		const auto code = prefix[last].unicode();
+		if (code < 0xFFFF) {
+			prefix[last] = QChar(code + 1);
+			return prefix;
+		}
+		prefix.chop(1);
+	}
+	return prefix;
+}
+
+} // namespace
 
 IndexedList::IndexedList(SortMode sortMode, FilterId filterId)
 : _sortMode(sortMode)
@@ -26,6 +43,7 @@ RowsByLetter IndexedList::addToEnd(Key key) {
 	}
 
 	auto result = RowsByLetter{ _list.addToEnd(key) };
+	indexNameWords(key);
 	for (const auto &ch : key.entry()->chatListFirstLetters()) {
 		auto j = _index.find(ch);
 		if (j == _index.cend()) {
@@ -42,6 +60,7 @@ Row *IndexedList::addByName(Key key) {
 	}
 
 	const auto result = _list.addByName(key);
+	indexNameWords(key);
 	for (const auto &ch : key.entry()->chatListFirstLetters()) {
 		auto j = _index.find(ch);
 		if (j == _index.cend()) {
@@ -119,6 +138,9 @@ void IndexedList::adjustByName(
 	const auto mainRow = _list.adjustByName(key);
 	if (!mainRow) return;
 
+	unindexNameWords(key);
+	indexNameWords(key);
+
 	auto toRemove = oldLetters;
 	auto toAdd = base::flat_set<QChar>();
 	for (const auto &ch : key.entry()->chatListFirstLetters()) {
@@ -156,6 +178,9 @@ void IndexedList::adjustNames(
 	auto mainRow = _list.getRow(key);
 	if (!mainRow) return;
 
+	unindexNameWords(key);
+	indexNameWords(key);
+
 	auto toRemove = oldLetters;
 	auto toAdd = base::flat_set<QChar>();
 	for (const auto &ch : key.entry()->chatListFirstLetters()) {
@@ -188,6 +213,7 @@ void IndexedList::adjustNames(
 
 void IndexedList::del(Key key, Row *replacedBy) {
 	if (_list.del(key, replacedBy)) {
+		unindexNameWords(key);
 		for (const auto &ch : key.entry()->chatListFirstLetters()) {
 			if (auto it = _index.find(ch); it != _index.cend()) {
 				it->second.del(key, replacedBy);
@@ -198,35 +224,99 @@ void IndexedList::del(Key key, Row *replacedBy) {
 
 void IndexedList::clear() {
 	_index.clear();
+	_nameWords.clear();
+	_wordsByEntry.clear();
+	_nameWordsDirty = false;
+}
+
+void IndexedList::indexNameWords(Key key) {
+	const auto entry = key.entry();
+	_wordsByEntry[entry] = entry->chatListNameWords();
+	_nameWordsDirty = true;
+}
+
+void IndexedList::unindexNameWords(Key key) {
+	const auto i = _wordsByEntry.find(key.entry());
+	if (i != end(_wordsByEntry)) {
+		_wordsByEntry.erase(i);
+		_nameWordsDirty = true;
+	}
+}
+
+void IndexedList::ensureNameWords() const {
+	if (!_nameWordsDirty) {
+		return;
+	}
+	_nameWordsDirty = false;
+
+	// Build the whole index at once when it is searched, so that adding
+	// many rows while loading the chat list does not shift the vector.
+	auto count = std::size_t(0);
+	for (const auto &[entry, words] : _wordsByEntry) {
+		count += words.size();
+	}
+	_nameWords.clear();
+	_nameWords.reserve(count);
+	for (const auto &[entry, words] : _wordsByEntry) {
+		for (const auto &word : words) {
+			_nameWords.emplace_back(word, entry);
+		}
+	}
+	ranges::sort(_nameWords, std::less<>(), &NameWord::first);
+}
+
+auto IndexedList::nameWordsByPrefix(const QString &prefix) const
+-> NameWordsRange {
+	const auto from = ranges::lower_bound(
+		_nameWords,
+		prefix,
+		std::less<>(),
+		&NameWord::first);
+	const auto end = PrefixEnd(prefix);
+	const auto till = end.isEmpty()
+		? _nameWords.end()
+		: ranges::lower_bound(
+			_nameWords,
+			end,
+			std::less<>(),
+			&NameWord::first);
+	return { from, till };
 }
 
 std::vector<not_null<Row*>> IndexedList::filtered(
 		const QStringList &words) const {
-	const auto minimal = [&]() -> const Dialogs::List* {
-		if (empty()) {
-			return nullptr;
+	auto result = std::vector<not_null<Row*>>();
+	if (empty()) {
+		return result;
+	}
+
+	ensureNameWords();
+
+	// Take candidates from the word with the fewest prefix matches.
+	auto minimal = std::optional<NameWordsRange>();
+	for (const auto &word : words) {
+		if (word.isEmpty()) {
+			continue;
 		}
-		auto result = (const Dialogs::List*)nullptr;
-		for (const auto &word : words) {
-			if (word.isEmpty()) {
-				continue;
-			}
-			const auto found = filtered(word[0]);
-			if (!found || found->empty()) {
-				return nullptr;
-			} else if (!result || result->size() > found->size()) {
-				result = found;
-			}
+		const auto range = nameWordsByPrefix(word);
+		if (range.first == range.second) {
+			return result;
+		} else if (!minimal
+			|| (minimal->second - minimal->first)
+				> (range.second - range.first)) {
+			minimal = range;
 		}
-		return result;
-	}();
-	auto result = std::vector<not_null<Row*>>();
-	if (!minimal || minimal->empty()) {
+	}
+	if (!minimal) {
 		return result;
 	}
-	result.reserve(minimal->size());
-	for (const auto &row : *minimal) {
-		const auto &nameWords = row->entry()->chatListNameWords();
+	result.reserve(minimal->second - minimal->first);
+	for (auto i = minimal->first; i != minimal->second; ++i) {
+		const auto row = _list.getRow(i->second);
+		if (!row) {
+			continue;
+		}
+		const auto &nameWords = i->second->chatListNameWords();
 		const auto found = [&](const QString &word) {
 			for (const auto &name : nameWords) {
 				if (name.startsWith(word)) {
@@ -247,6 +337,12 @@ std::vector<not_null<Row*>> IndexedList::filtered(
 			result.push_back(row);
 		}
 	}
+
+	// An entry could match by several of its words, keep the list order.
+	ranges::sort(result, std::less<>(), [](not_null<Row*> row) {
+		return row->pos();
+	});
+	result.erase(ranges::unique(result), end(result));
 	return result;
 }
 
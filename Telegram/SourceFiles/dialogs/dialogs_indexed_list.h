@@ -80,11 +80,27 @@ private:
 		not_null<History*> history,
 		const base::flat_set<QChar> &oldChars);
 
+	using NameWord = std::pair<QString, not_null<Entry*>>;
+	using NameWordsRange = std::pair<
+		std::vector<NameWord>::const_iterator,
+		std::vector<NameWord>::const_iterator>;
+	void indexNameWords(Key key);
+	void unindexNameWords(Key key);
+	void ensureNameWords() const;
+	[[nodiscard]] NameWordsRange nameWordsByPrefix(
+		const QString &prefix) const;
+
 	SortMode _sortMode = SortMode();
 	FilterId _filterId = 0;
 	List _list, _empty;
 	base::flat_map<QChar, List> _index;
 
+	// Sorted name words of all entries, for prefix search by binary search.
+	// Rebuilt from _wordsByEntry on the first search after any change.
+	mutable std::vector<NameWord> _nameWords;
+	mutable bool _nameWordsDirty = false;
+	base::flat_map<not_null<Entry*>, base::flat_set<QString>> _wordsByEntry;
+
 };
 
 } // namespace Dialogs
@@ -15,6 +15,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history_item.h"
 #include "core/shortcuts.h"
 #include "core/application.h"
+#include "core/paint_profiler.h"
+#include "core/rpl_profiler.h"
+#include "core/startup_timeline.h"
 #include "ui/widgets/buttons.h"
 #include "ui/widgets/popup_menu.h"
 #include "ui/text/text_utilities.h"
@@ -140,13 +143,20 @@ InnerWidget::InnerWidget(
 
 	session().downloaderTaskFinished(
 	) | rpl::start_with_next([=] {
+		clearWaitingRowCaches();
 		update();
 	}, lifetime());
 
+	style::PaletteChanged(
+	) | rpl::start_with_next([=] {
+		clearRowCaches();
+	}, lifetime());
+
 	Core::App().notifications().settingsChanged(
 	) | rpl::start_with_next([=](Window::Notifications::ChangeType change) {
 		if (change == Window::Notifications::ChangeType::CountMessages) {
 			// Folder rows change their unread badge with this setting.
+			clearRowCaches();
 			update();
 		}
 	}, lifetime());
@@ -170,6 +180,11 @@ InnerWidget::InnerWidget(
 	session().data().sendActionManager().animationUpdated(
 	) | rpl::start_with_next([=](
 			const Data::SendActionManager::AnimationUpdate &update) {
+		// Only the text changes are needed for the rows scrolled away,
+		// so that their caches are invalidated.
+		if (!update.textUpdated && !dialogRowMayBeVisible(update.history)) {
+			return;
+		}
 		const auto updateRect = Ui::RowPainter::sendActionAnimationRect(
 			update.left,
 			update.width,
@@ -218,11 +233,14 @@ InnerWidget::InnerWidget(
 	session().changes().historyUpdates(
 		Data::HistoryUpdate::Flag::IsPinned
 		| Data::HistoryUpdate::Flag::ChatOccupied
+	) | Core::RplProfiler::Site(
+		"Dialogs/PinnedOccupied"
 	) | rpl::start_with_next([=](const Data::HistoryUpdate &update) {
 		if (update.flags & Data::HistoryUpdate::Flag::IsPinned) {
 			stopReorderPinned();
 		}
 		if (update.flags & Data::HistoryUpdate::Flag::ChatOccupied) {
+			clearRowCaches();
 			this->update();
 			_updated.fire({});
 		}
@@ -233,8 +251,11 @@ InnerWidget::InnerWidget(
 		UpdateFlag::Name
 		| UpdateFlag::Photo
 		| UpdateFlag::IsContact
+	) | Core::RplProfiler::Site(
+		"Dialogs/NamePhoto"
 	) | rpl::start_with_next([=](const Data::PeerUpdate &update) {
 		if (update.flags & (UpdateFlag::Name | UpdateFlag::Photo)) {
+			clearRowCaches();
 			this->update();
 			_updated.fire({});
 		}
@@ -246,12 +267,18 @@ InnerWidget::InnerWidget(
 
 	session().changes().messageUpdates(
 		Data::MessageUpdate::Flag::DialogRowRefresh
+	) | Core::RplProfiler::Site(
+		"Dialogs/RowRefresh"
 	) | rpl::start_with_next([=](const Data::MessageUpdate &update) {
 		refreshDialogRow({ update.item->history(), update.item->fullId() });
 	}, lifetime());
 
+	setupRowCacheInvalidation();
+
 	session().changes().entryUpdates(
 		Data::EntryUpdate::Flag::Repaint
+	) | Core::RplProfiler::Site(
+		"Dialogs/EntryRepaint"
 	) | rpl::start_with_next([=](const Data::EntryUpdate &update) {
 		const auto entry = update.entry;
 		const auto repaintId = (_state == WidgetState::Default)
@@ -396,12 +423,14 @@ void InnerWidget::changeOpenedFolder(Data::Folder *folder) {
 }
 
 void InnerWidget::paintEvent(QPaintEvent *e) {
+	const auto profile = Core::PaintProfiler::Scope("Dialogs/List");
 	Painter p(this);
 
 	const auto r = e->rect();
 	if (_controller->widget()->contentOverlapped(this, r)) {
 		return;
 	}
+	Core::StartupTimeline::Finish();
 	const auto activeEntry = _controller->activeChatEntryCurrent();
 	auto fullWidth = width();
 	auto dialogsClip = r;
@@ -442,14 +471,7 @@ void InnerWidget::paintEvent(QPaintEvent *e) {
 				}
 				const auto isActive = (row->key() == active);
 				const auto isSelected = (row->key() == selected);
-				Ui::RowPainter::paint(
-					p,
-					row,
-					_filterId,
-					fullWidth,
-					isActive,
-					isSelected,
-					ms);
+				paintDialog(p, row, fullWidth, isActive, isSelected, ms);
 				if (xadd || yadd) {
 					p.translate(-xadd, -yadd);
 				}
@@ -667,6 +689,164 @@ void InnerWidget::paintEvent(QPaintEvent *e) {
 	}
 }
 
+void InnerWidget::paintDialog(
+		Painter &p,
+		not_null<Row*> row,
+		int fullWidth,
+		bool active,
+		bool selected,
+		crl::time ms) {
+	if (Ui::RowPainter::animating(row)) {
+		_rowCaches.remove(row->key());
+		Ui::RowPainter::paint(
+			p,
+			row,
+			_filterId,
+			fullWidth,
+			active,
+			selected,
+			ms);
+		return;
+	}
+	const auto ratio = style::DevicePixelRatio();
+	const auto date = QDate::currentDate();
+	auto &cache = _rowCaches[row->key()];
+	if (cache.image.isNull()
+		|| cache.image.devicePixelRatio() != ratio
+		|| cache.date != date
+		|| cache.filterId != _filterId
+		|| cache.width != fullWidth
+		|| cache.active != active
+		|| cache.selected != selected) {
+		const auto size = QSize(fullWidth, DialogsRowHeight());
+		if (cache.image.size() != size * ratio) {
+			cache.image = QImage(
+				size * ratio,
+				QImage::Format_ARGB32_Premultiplied);
+			cache.image.setDevicePixelRatio(ratio);
+		}
+		cache.image.fill(Qt::transparent);
+		cache.date = date;
+		cache.filterId = _filterId;
+		cache.width = fullWidth;
+		cache.active = active;
+		cache.selected = selected;
+
+		auto q = Painter(&cache.image);
+		Ui::RowPainter::paint(
+			q,
+			row,
+			_filterId,
+			fullWidth,
+			active,
+			selected,
+			ms);
+		cache.waitingUserpic = waitingUserpic(row);
+	}
+	p.drawImage(0, 0, cache.image);
+}
+
+bool InnerWidget::waitingUserpic(not_null<Row*> row) const {
+	if (row->folder()) {
+		// Folder userpics are combined from several chats, don't track.
+		return true;
+	} else if (const auto history = row->history()) {
+		const auto peer = history->peer;
+		return peer->hasUserpic() && peer->useEmptyUserpic(row->userpicView());
+	}
+	return false;
+}
+
+void InnerWidget::setupRowCacheInvalidation() {
+	using PeerFlag = Data::PeerUpdate::Flag;
+	session().changes().peerUpdates(
+		PeerFlag::Notifications
+		| PeerFlag::Migration
+		| PeerFlag::OnlineStatus
+		| PeerFlag::HasCalls
+		| PeerFlag::GroupCall
+	) | Core::RplProfiler::Site(
+		"Dialogs/RowCache/Peer"
+	) | rpl::start_with_next([=](const Data::PeerUpdate &update) {
+		invalidateRowCache(update.peer);
+	}, lifetime());
+
+	using HistoryFlag = Data::HistoryUpdate::Flag;
+	session().changes().historyUpdates(
+		HistoryFlag::IsPinned
+		| HistoryFlag::UnreadView
+		| HistoryFlag::TopPromoted
+		| HistoryFlag::Folder
+		| HistoryFlag::UnreadMentions
+		| HistoryFlag::ClientSideMessages
+		| HistoryFlag::CloudDraft
+		| HistoryFlag::LocalDraftSet
+	) | Core::RplProfiler::Site(
+		"Dialogs/RowCache/History"
+	) | rpl::start_with_next([=](const Data::HistoryUpdate &update) {
+		invalidateRowCache(Key(update.history));
+	}, lifetime());
+
+	using MessageFlag = Data::MessageUpdate::Flag;
+	session().changes().messageUpdates(
+		MessageFlag::Edited
+		| MessageFlag::Destroyed
+		| MessageFlag::DialogRowRepaint
+	) | Core::RplProfiler::Site(
+		"Dialogs/RowCache/Message"
+	) | rpl::start_with_next([=](const Data::MessageUpdate &update) {
+		invalidateRowCache(Key(update.item->history()));
+	}, lifetime());
+}
+
+void InnerWidget::invalidateRowCache(Key key) {
+	if (!key) {
+		return;
+	}
+	_rowCaches.remove(key);
+	if (const auto folder = key.entry()->folder()) {
+		_rowCaches.remove(Key(folder));
+	}
+}
+
+void InnerWidget::invalidateRowCache(not_null<PeerData*> peer) {
+	if (const auto history = session().data().historyLoaded(peer)) {
+		invalidateRowCache(Key(history));
+	}
+	if (const auto to = peer->migrateTo()) {
+		if (const auto history = session().data().historyLoaded(to)) {
+			invalidateRowCache(Key(history));
+		}
+	}
+}
+
+void InnerWidget::clearRowCaches() {
+	_rowCaches.clear();
+}
+
+void InnerWidget::clearWaitingRowCaches() {
+	for (auto i = begin(_rowCaches); i != end(_rowCaches);) {
+		if (i->second.waitingUserpic) {
+			i = _rowCaches.erase(i);
+		} else {
+			++i;
+		}
+	}
+}
+
+void InnerWidget::clearRowCachesOutside(int from, int till) {
+	const auto list = shownDialogs();
+	for (auto i = begin(_rowCaches); i != end(_rowCaches);) {
+		const auto row = list->getRow(i->first);
+		const auto top = row ? defaultRowTop(row) : 0;
+		if (!row || top + DialogsRowHeight() <= from || top >= till) {
+			i = _rowCaches.erase(i);
+		} else {
+			++i;
+		}
+	}
+}
+
 void InnerWidget::paintCollapsedRows(Painter &p, QRect clip) const {
 	auto index = 0;
 	const auto rowHeight = st::dialogsImportantBarHeight;
@@ -1418,6 +1598,9 @@ void InnerWidget::resizeEvent(QResizeEvent *e) {
 void InnerWidget::dialogRowReplaced(
 		Row *oldRow,
 		Row *newRow) {
+	if (oldRow) {
+		_rowCaches.remove(oldRow->key());
+	}
 	if (_state == WidgetState::Filtered) {
 		for (auto i = _filterResults.begin(); i != _filterResults.end();) {
 			if (*i == oldRow) { // this row is shown in filtered and maybe is in contacts!
@@ -1517,9 +1700,24 @@ int InnerWidget::defaultRowTop(not_null<Row*> row) const {
 	return top + position * DialogsRowHeight();
 }
 
+bool InnerWidget::dialogRowMayBeVisible(not_null<History*> history) const {
+	if (!isVisible()) {
+		return false;
+	} else if (_state != WidgetState::Default || history->folder()) {
+		return true;
+	}
+	const auto row = shownDialogs()->getRow(Key(history));
+	if (!row) {
+		return false;
+	}
+	const auto top = defaultRowTop(row);
+	return (top < _visibleBottom) && (top + DialogsRowHeight() > _visibleTop);
+}
+
 void InnerWidget::repaintDialogRow(
 		FilterId filterId,
 		not_null<Row*> row) {
+	invalidateRowCache(row->key());
 	if (_state == WidgetState::Default) {
 		if (_filterId == filterId) {
 			if (const auto folder = row->folder()) {
@@ -1591,6 +1789,7 @@ void InnerWidget::updateDialogRow(
 			}
 		}
 	}
+	invalidateRowCache(row.key);
 
 	const auto updateRow = [&](int rowTop) {
 		rtlupdate(
@@ -1976,6 +2175,9 @@ void InnerWidget::visibleTopBottomUpdated(
 	_visibleTop = visibleTop;
 	_visibleBottom = visibleBottom;
 	loadPeerPhotos();
+	clearRowCachesOutside(
+		_visibleTop - (_visibleBottom - _visibleTop),
+		_visibleBottom + (_visibleBottom - _visibleTop));
 	if (_visibleTop + PreloadHeightsCount * (_visibleBottom - _visibleTop) >= height()) {
 		if (_loadMoreCallback) {
 			_loadMoreCallback();
@@ -2114,6 +2316,21 @@ bool InnerWidget::searchReceived(
 	return lastDateFound != 0;
 }
 
+void InnerWidget::searchLocalReceived(
+		const std::vector<not_null<HistoryItem*>> &items) {
+	if (_state != WidgetState::Filtered) {
+		return;
+	}
+	// Shown until the first server page replaces them.
+	clearSearchResults(false);
+	for (const auto item : items) {
+		_searchResults.push_back(
+			std::make_unique<FakeRow>(_searchInChat, item));
+	}
+	_searchedCount = int(items.size());
+	refresh();
+}
+
 void InnerWidget::peerSearchReceived(
 		const QString &query,
 		const QVector<MTPPeer> &my,
@@ -2203,6 +2420,7 @@ void InnerWidget::refresh(bool toTop) {
 	if (needCollapsedRowsRefresh()) {
 		return refreshWithCollapsedRows(toTop);
 	}
+	clearRowCaches();
 	refreshEmptyLabel();
 	const auto list = shownDialogs();
 	auto h = 0;
@@ -2954,9 +3172,11 @@ MsgId InnerWidget::lastSearchMigratedId() const {
 }
 
 void InnerWidget::setupOnlineStatusCheck() {
-	session().changes().peerUpdates(
+	session().changes().framedPeerUpdates(
 		Data::PeerUpdate::Flag::OnlineStatus
 		| Data::PeerUpdate::Flag::GroupCall
+	) | Core::RplProfiler::Site(
+		"Dialogs/OnlineStatus"
 	) | rpl::start_with_next([=](const Data::PeerUpdate &update) {
 		if (update.peer->isUser()) {
 			userOnlineUpdated(update.peer);
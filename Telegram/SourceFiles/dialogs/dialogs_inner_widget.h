@@ -75,6 +75,8 @@ public:
 		HistoryItem *inject,
 		SearchRequestType type,
 		int fullCount);
+	void searchLocalReceived(
+		const std::vector<not_null<HistoryItem*>> &items);
 	void peerSearchReceived(
 		const QString &query,
 		const QVector<MTPPeer> &my,
@@ -156,6 +158,15 @@ private:
 	struct CollapsedRow;
 	struct HashtagResult;
 	struct PeerSearchResult;
+	struct RowCache {
+		QImage image;
+		QDate date;
+		FilterId filterId = 0;
+		int width = 0;
+		bool active = false;
+		bool selected = false;
+		bool waitingUserpic = false;
+	};
 
 	enum class JumpSkip {
 		PreviousOrBegin,
@@ -222,6 +233,7 @@ private:
 	bool hasHistoryInResults(not_null<History*> history) const;
 
 	int defaultRowTop(not_null<Row*> row) const;
+	[[nodiscard]] bool dialogRowMayBeVisible(not_null<History*> history) const;
 	void setupOnlineStatusCheck();
 	void userOnlineUpdated(not_null<PeerData*> peer);
 	void groupHasCallUpdated(not_null<PeerData*> peer);
@@ -258,6 +270,20 @@ private:
 		RowDescriptor row,
 		QRect updateRect = QRect(),
 		UpdateRowSections sections = UpdateRowSection::All);
+	void paintDialog(
+		Painter &p,
+		not_null<Row*> row,
+		int fullWidth,
+		bool active,
+		bool selected,
+		crl::time ms);
+	void setupRowCacheInvalidation();
+	void invalidateRowCache(Key key);
+	void invalidateRowCache(not_null<PeerData*> peer);
+	[[nodiscard]] bool waitingUserpic(not_null<Row*> row) const;
+	void clearRowCaches();
+	void clearWaitingRowCaches();
+	void clearRowCachesOutside(int from, int till);
 	void fillSupportSearchMenu(not_null<Ui::PopupMenu*> menu);
 	void fillArchiveSearchMenu(not_null<Ui::PopupMenu*> menu);
 
@@ -349,6 +375,9 @@ private:
 	Ui::Animations::Basic _pinnedShiftAnimation;
 	base::flat_set<Key> _pinnedOnDragStart;
 
+	// Painted chat list rows, reused until something they show changes.
+	base::flat_map<Key, RowCache> _rowCaches;
+
 	// Remember the last currently dragged row top shift for updating area.
 	int _aboveTopShift = -1;
 
@@ -13,6 +13,31 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mainwidget.h"
 
 namespace Dialogs {
+namespace {
+
+// Finds the first element in a partitioned range not satisfying predicate,
+// probing exponentially growing steps from the start first. Rows usually
+// move only a little, so this is O(log distance) instead of O(distance).
+template <typename Iterator, typename Predicate>
+[[nodiscard]] Iterator GallopPartitionPoint(
+		Iterator from,
+		Iterator till,
+		Predicate predicate) {
+	auto step = typename std::iterator_traits<Iterator>::difference_type(1);
+	while (from != till && predicate(*from)) {
+		const auto left = (till - from);
+		if (step >= left) {
+			return std::partition_point(from + 1, till, predicate);
+		} else if (!predicate(*(from + step))) {
+			return std::partition_point(from + 1, from + step, predicate);
+		}
+		from += step;
+		step *= 2;
+	}
+	return from;
+}
+
+} // namespace
 
 List::List(SortMode sortMode, FilterId filterId)
 : _sortMode(sortMode)
@@ -87,15 +112,17 @@ void List::adjustByDate(not_null<Row*> row) {
 	const auto key = row->sortKey(_filterId);
 	const auto index = row->pos();
 	const auto i = _rows.begin() + index;
-	const auto before = std::find_if(i + 1, _rows.end(), [&](Row *row) {
-		return (row->sortKey(_filterId) <= key);
+	const auto before = GallopPartitionPoint(i + 1, _rows.end(), [&](
+			Row *row) {
+		return (row->sortKey(_filterId) > key);
 	});
 	if (before != i + 1) {
 		rotate(i, i + 1, before);
 	} else {
 		const auto from = std::make_reverse_iterator(i);
-		const auto after = std::find_if(from, _rows.rend(), [&](Row *row) {
-			return (row->sortKey(_filterId) >= key);
+		const auto after = GallopPartitionPoint(from, _rows.rend(), [&](
+				Row *row) {
+			return (row->sortKey(_filterId) < key);
 		}).base();
 		if (after != i) {
 			rotate(after, i, i + 1);
@@ -12,6 +12,13 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history.h"
 
 namespace Dialogs {
+namespace {
+
+#ifdef _DEBUG
+constexpr auto kVerifyUnreadStateEach = 256;
+#endif // _DEBUG
+
+} // namespace
 
 MainList::MainList(
 	not_null<Main::Session*> session,
@@ -111,6 +118,9 @@ void MainList::recomputeFullListSize() {
 void MainList::unreadStateChanged(
 		const UnreadState &wasState,
 		const UnreadState &nowState) {
+	if (wasState == nowState) {
+		return;
+	}
 	const auto useClouded = _cloudUnreadState.known && !loaded();
 	const auto updateCloudUnread = _cloudUnreadState.known && wasState.known;
 	const auto notify = !useClouded || wasState.known;
@@ -121,6 +131,9 @@ void MainList::unreadStateChanged(
 		_cloudUnreadState += nowState - wasState;
 		finalizeCloudUnread();
 	}
+#ifdef _DEBUG
+	verifyUnreadState();
+#endif // _DEBUG
 }
 
 void MainList::unreadEntryChanged(
@@ -145,7 +158,35 @@ void MainList::unreadEntryChanged(
 		}
 		finalizeCloudUnread();
 	}
+#ifdef _DEBUG
+	verifyUnreadState();
+#endif // _DEBUG
+}
+
+#ifdef _DEBUG
+void MainList::verifyUnreadState() {
+	if (++_unreadDeltasSinceVerify < kVerifyUnreadStateEach) {
+		return;
+	}
+	_unreadDeltasSinceVerify = 0;
+
+	auto summed = UnreadState();
+	for (const auto &row : _all) {
+		summed += row->key().entry()->chatListUnreadState();
+	}
+	summed.known = _unreadState.known;
+	if (summed != _unreadState) {
+		LOG(("Unread Error: filter %1 state %2/%3/%4 instead of %5/%6/%7."
+			).arg(_filterId
+			).arg(_unreadState.messages
+			).arg(_unreadState.chats
+			).arg(_unreadState.marks
+			).arg(summed.messages
+			).arg(summed.chats
+			).arg(summed.marks));
+	}
 }
+#endif // _DEBUG
 
 void MainList::updateCloudUnread(const MTPDdialogFolder &data) {
 	const auto notifier = unreadStateChangeNotifier(!loaded());
@@ -54,11 +54,16 @@ public:
 private:
 	void finalizeCloudUnread();
 	void recomputeFullListSize();
+#ifdef _DEBUG
+	void verifyUnreadState();
+#endif // _DEBUG
 
+	// Folders and filters apply only the difference we fire here,
+	// so don't cascade the changes that didn't change anything.
 	auto unreadStateChangeNotifier(bool notify) {
 		const auto wasState = notify ? unreadState() : UnreadState();
 		return gsl::finally([=] {
-			if (notify) {
+			if (notify && unreadState() != wasState) {
 				_unreadStateChanges.fire_copy(wasState);
 			}
 		});
@@ -72,6 +77,9 @@ private:
 	rpl::event_stream<UnreadState> _unreadStateChanges;
 	rpl::variable<int> _fullListSize = 0;
 	int _cloudListSize = 0;
+#ifdef _DEBUG
+	int _unreadDeltasSinceVerify = 0;
+#endif // _DEBUG
 
 	bool _loaded = false;
 	bool _allAreMuted = false;
@@ -58,6 +58,8 @@ public:
 		int outerWidth,
 		const QColor *colorOverride = nullptr) const;
 
+	[[nodiscard]] bool animating() const;
+
 	std::shared_ptr<Data::CloudImageView> &userpicView() const {
 		return _userpic;
 	}
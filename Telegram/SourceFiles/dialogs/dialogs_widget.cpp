@@ -12,6 +12,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "dialogs/dialogs_search_from_controllers.h"
 #include "dialogs/dialogs_key.h"
 #include "dialogs/dialogs_entry.h"
+#include "dialogs/dialogs_indexed_list.h"
+#include "dialogs/dialogs_main_list.h"
 #include "history/history.h"
 #include "history/view/history_view_top_bar_widget.h"
 #include "ui/widgets/buttons.h"
@@ -29,6 +31,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "apiwrap.h"
 #include "base/event_filter.h"
 #include "core/application.h"
+#include "core/paint_profiler.h"
 #include "core/update_checker.h"
 #include "boxes/peer_list_box.h"
 #include "boxes/peers/edit_participants_box.h"
@@ -45,6 +48,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_chat.h"
 #include "data/data_user.h"
 #include "data/data_folder.h"
+#include "data/data_search_controller.h"
 #include "data/data_histories.h"
 #include "data/data_changes.h"
 #include "facades.h"
@@ -854,6 +858,11 @@ bool Widget::onSearchMessages(bool searchCache) {
 			auto &histories = session().data().histories();
 			const auto type = Data::Histories::RequestType::History;
 			const auto history = session().data().history(peer);
+			_inner->searchLocalReceived(Api::SearchLoadedMessages(
+				history,
+				_searchQuery,
+				_searchQueryFrom,
+				SearchPerPage));
 			_searchInHistoryRequest = histories.sendRequest(history, type, [=](Fn<void()> finish) {
 				const auto type = SearchRequestType::PeerFromStart;
 				const auto flags = _searchQueryFrom
@@ -889,6 +898,26 @@ bool Widget::onSearchMessages(bool searchCache) {
 				return _searchRequest;
 			});
 		} else {
+			auto histories = std::vector<not_null<History*>>();
+			const auto addList = [&](not_null<Dialogs::IndexedList*> list) {
+				for (const auto &row : list->all()) {
+					if (const auto history = row->history()) {
+						histories.push_back(history);
+					}
+				}
+			};
+			addList(session().data().chatsList()->indexed());
+			const auto archive = session().settings().skipArchiveInSearch()
+				? nullptr
+				: session().data().folderLoaded(Data::Folder::kId);
+			if (archive) {
+				addList(archive->chatsList()->indexed());
+			}
+			_inner->searchLocalReceived(Api::SearchLoadedMessages(
+				histories,
+				_searchQuery,
+				SearchPerPage));
+
 			const auto type = SearchRequestType::FromStart;
 			const auto flags = session().settings().skipArchiveInSearch()
 				? MTPmessages_SearchGlobal::Flag::f_folder_id
@@ -1713,6 +1742,7 @@ void Widget::paintEvent(QPaintEvent *e) {
 		return;
 	}
 
+	const auto profile = Core::PaintProfiler::Scope("Dialogs/Widget");
 	Painter p(this);
 	QRect r(e->rect());
 	if (r != rect()) {
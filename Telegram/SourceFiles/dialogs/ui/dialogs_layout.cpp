@@ -1188,6 +1188,15 @@ void RowPainter::paint(
 	}
 }
 
+bool RowPainter::animating(not_null<const Row*> row) {
+	if (row->animating()) {
+		return true;
+	} else if (const auto history = row->history()) {
+		return history->sendActionPainter()->animating();
+	}
+	return false;
+}
+
 QRect RowPainter::sendActionAnimationRect(
 		int animationLeft,
 		int animationWidth,
@@ -43,6 +43,7 @@ public:
 		bool selected,
 		crl::time ms,
 		bool displayUnreadInfo);
+	[[nodiscard]] static bool animating(not_null<const Row*> row);
 	static QRect sendActionAnimationRect(
 		int animationLeft,
 		int animationWidth,
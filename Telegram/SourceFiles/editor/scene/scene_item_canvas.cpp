@@ -9,10 +9,15 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <QGraphicsScene>
 #include <QGraphicsSceneMouseEvent>
+#include <QStyleOptionGraphicsItem>
 
 namespace Editor {
 namespace {
 
+// Larger photos are shown downscaled and exported with one pixel per
+// scene unit, a retina canvas would only add pixels to fill and draw.
+constexpr auto kRetinaCanvasMaxSide = 2048;
+
 QRectF NormalizedRect(const QPointF& p1, const QPointF& p2) {
 	return QRectF(
 		std::min(p1.x(), p2.x()),
@@ -79,16 +84,36 @@ std::vector<QPointF> InterpolatedPoints(
 
 ItemCanvas::ItemCanvas() {
 	setAcceptedMouseButtons({});
+	setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
 }
 
 void ItemCanvas::clearPixmap() {
+	const auto sceneSize = scene()->sceneRect().size();
+	const auto factor = (std::max(sceneSize.width(), sceneSize.height())
+		> kRetinaCanvasMaxSide)
+		? 1
+		: cIntRetinaFactor();
+	const auto size = (sceneSize * factor).toSize();
+	if (_pixmap.size() == size && _p) {
+		// Only the last stroke was drawn, clear it instead of
+		// allocating and filling the whole canvas again.
+		if (_dirtyRect.isValid()) {
+			_p->save();
+			_p->setCompositionMode(QPainter::CompositionMode_Source);
+			_p->fillRect(_dirtyRect, Qt::transparent);
+			_p->restore();
+		}
+		_dirtyRect = QRectF();
+		return;
+	}
 	_hq = nullptr;
 	_p = nullptr;
 
-	_pixmap = QPixmap(
-		(scene()->sceneRect().size() * cIntRetinaFactor()).toSize());
-	_pixmap.setDevicePixelRatio(cRetinaFactor());
+	_factor = factor;
+	_pixmap = QPixmap(size);
+	_pixmap.setDevicePixelRatio(factor);
 	_pixmap.fill(Qt::transparent);
+	_dirtyRect = QRectF();
 
 	_p = std::make_unique<Painter>(&_pixmap);
 	_hq = std::make_unique<PainterHighQualityEnabler>(*_p);
@@ -136,6 +161,7 @@ void ItemCanvas::drawLine(
 	const auto points = InterpolatedPoints(lastPoint, currentPoint);
 
 	_rectToUpdate |= NormalizedRect(currentPoint, lastPoint) + _brushMargins;
+	_dirtyRect |= _rectToUpdate;
 
 	for (const auto &point : points) {
 		_p->drawEllipse(point, halfBrushSize, halfBrushSize);
@@ -170,13 +196,15 @@ void ItemCanvas::handleMouseReleaseEvent(
 
 	if (_contentRect.isValid()) {
 		const auto scaledContentRect = QRectF(
-			_contentRect.x() * cRetinaFactor(),
-			_contentRect.y() * cRetinaFactor(),
-			_contentRect.width() * cRetinaFactor(),
-			_contentRect.height() * cRetinaFactor());
+			_contentRect.x() * _factor,
+			_contentRect.y() * _factor,
+			_contentRect.width() * _factor,
+			_contentRect.height() * _factor);
 
+		auto pixmap = _pixmap.copy(scaledContentRect.toRect());
+		pixmap.setDevicePixelRatio(_factor);
 		_grabContentRequests.fire({
-			.pixmap = _pixmap.copy(scaledContentRect.toRect()),
+			.pixmap = std::move(pixmap),
 			.position = _contentRect.topLeft(),
 		});
 	}
@@ -186,10 +214,18 @@ void ItemCanvas::handleMouseReleaseEvent(
 
 void ItemCanvas::paint(
 		QPainter *p,
-		const QStyleOptionGraphicsItem *,
+		const QStyleOptionGraphicsItem *option,
 		QWidget *) {
-	p->fillRect(_rectToUpdate, Qt::transparent);
-	p->drawPixmap(0, 0, _pixmap);
+	// Draw only the exposed part of the canvas, it is as large
+	// as the full resolution photo.
+	const auto exposed = option->exposedRect.intersected(boundingRect());
+	if (!exposed.isEmpty()) {
+		p->drawPixmap(exposed, _pixmap, QRectF(
+			exposed.x() * _factor,
+			exposed.y() * _factor,
+			exposed.width() * _factor,
+			exposed.height() * _factor));
+	}
 	_rectToUpdate = QRectF();
 }
 
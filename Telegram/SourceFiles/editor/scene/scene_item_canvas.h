@@ -57,12 +57,14 @@ private:
 	std::unique_ptr<Painter> _p;
 
 	QRectF _rectToUpdate;
+	QRectF _dirtyRect;
 	QRectF _contentRect;
 	QMarginsF _brushMargins;
 
 	QPointF _lastPoint;
 
 	QPixmap _pixmap;
+	int _factor = 1;
 
 	struct {
 		float size = 1.;
@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "export/data/export_data_types.h"
 #include "export/output/export_output_result.h"
 #include "export/output/export_output_file.h"
+#include "export/output/export_output_abstract.h"
 #include "mtproto/mtproto_response.h"
 #include "base/value_ordering.h"
 #include "base/bytes.h"
@@ -18,13 +19,16 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include <set>
 #include <deque>
 
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+
 namespace Export {
 namespace {
 
 constexpr auto kUserpicsSliceLimit = 100;
 constexpr auto kFileChunkSize = 128 * 1024;
-constexpr auto kFileRequestsCount = 2;
-//constexpr auto kFileNextRequestDelay = crl::time(20);
+constexpr auto kFileRequestsCountMax = 8;
 constexpr auto kChatsSliceLimit = 100;
 constexpr auto kMessagesSliceLimit = 100;
 constexpr auto kTopPeerSliceLimit = 100;
@@ -95,6 +99,7 @@ public:
 	LoadedFileCache(int limit);
 
 	void save(const Location &location, const QString &relativePath);
+	void save(const LocationKey &key, const QString &relativePath);
 	std::optional<QString> find(const Location &location) const;
 
 private:
@@ -158,13 +163,15 @@ struct ApiWrap::FileProcess {
 	Data::FileOrigin origin;
 	int offset = 0;
 	int size = 0;
+	int requestsCount = 1;
 
 	struct Request {
 		int offset = 0;
 		QByteArray bytes;
+		mtpRequestId requestId = 0;
 	};
 	std::deque<Request> requests;
-	mtpRequestId requestId = 0;
+	mtpRequestId requestId = 0; // File reference refresh.
 };
 
 struct ApiWrap::FileProgress {
@@ -211,6 +218,10 @@ struct ApiWrap::ChatProcess {
 	std::optional<Data::MessagesSlice> slice;
 	bool lastSlice = false;
 	int fileIndex = 0;
+
+	std::optional<MTPmessages_Messages> prefetched;
+	bool prefetchRequested = false;
+	bool prefetchWaiting = false;
 };
 
 
@@ -222,7 +233,8 @@ public:
 
 	RequestBuilder(
 		Original &&builder,
-		Fn<void(const MTP::Error&)> commonFailHandler);
+		Fn<void(const MTP::Error&)> commonFailHandler,
+		Fn<void()> commonDoneHandler);
 
 	[[nodiscard]] RequestBuilder &done(FnMut<void()> &&handler);
 	[[nodiscard]] RequestBuilder &done(
@@ -235,15 +247,18 @@ public:
 private:
 	Original _builder;
 	Fn<void(const MTP::Error&)> _commonFailHandler;
+	Fn<void()> _commonDoneHandler;
 
 };
 
 template <typename Request>
 ApiWrap::RequestBuilder<Request>::RequestBuilder(
 	Original &&builder,
-	Fn<void(const MTP::Error&)> commonFailHandler)
+	Fn<void(const MTP::Error&)> commonFailHandler,
+	Fn<void()> commonDoneHandler)
 : _builder(std::move(builder))
-, _commonFailHandler(std::move(commonFailHandler)) {
+, _commonFailHandler(std::move(commonFailHandler))
+, _commonDoneHandler(std::move(commonDoneHandler)) {
 }
 
 template <typename Request>
@@ -251,7 +266,13 @@ auto ApiWrap::RequestBuilder<Request>::done(
 	FnMut<void()> &&handler
 ) -> RequestBuilder& {
 	if (handler) {
-		[[maybe_unused]] auto &silence_warning = _builder.done(std::move(handler));
+		[[maybe_unused]] auto &silence_warning = _builder.done([
+			common = _commonDoneHandler,
+			specific = std::move(handler)
+		]() mutable {
+			common();
+			specific();
+		});
 	}
 	return *this;
 }
@@ -261,7 +282,13 @@ auto ApiWrap::RequestBuilder<Request>::done(
 	FnMut<void(Response &&)> &&handler
 ) -> RequestBuilder& {
 	if (handler) {
-		[[maybe_unused]] auto &silence_warning = _builder.done(std::move(handler));
+		[[maybe_unused]] auto &silence_warning = _builder.done([
+			common = _commonDoneHandler,
+			specific = std::move(handler)
+		](Response &&result) mutable {
+			common();
+			specific(std::move(result));
+		});
 	}
 	return *this;
 }
@@ -300,7 +327,12 @@ void ApiWrap::LoadedFileCache::save(
 	if (!location) {
 		return;
 	}
-	const auto key = ComputeLocationKey(location);
+	save(ComputeLocationKey(location), relativePath);
+}
+
+void ApiWrap::LoadedFileCache::save(
+		const LocationKey &key,
+		const QString &relativePath) {
 	_map[key] = relativePath;
 	_list.push_back(key);
 	if (_list.size() > _limit) {
@@ -333,11 +365,17 @@ auto ApiWrap::mainRequest(Request &&request) {
 	auto original = std::move(_mtp.request(MTPInvokeWithTakeout<Request>(
 		MTP_long(*_takeoutId),
 		std::forward<Request>(request)
-	)).toDC(MTP::ShiftDcId(0, MTP::kExportDcShift)));
+	)).toDC(MTP::ShiftDcId(0, MTP::kExportDcShift)).inBackground());
 
+	const auto sent = crl::now();
 	return RequestBuilder<MTPInvokeWithTakeout<Request>>(
 		std::move(original),
-		[=](const MTP::Error &result) { error(result); });
+		[=](const MTP::Error &result) { error(result); },
+		[=] {
+			if (_stats) {
+				_stats->addApiWait(sent, crl::now());
+			}
+		});
 }
 
 template <typename Request>
@@ -358,6 +396,18 @@ auto ApiWrap::fileRequest(const Data::FileLocation &location, int offset) {
 	Expects(_takeoutId.has_value());
 	Expects(_fileProcess->requestId == 0);
 
+	const auto clearRequestId = [=] {
+		using Request = FileProcess::Request;
+		auto &requests = _fileProcess->requests;
+		const auto i = ranges::find(
+			requests,
+			offset,
+			[](const Request &request) { return request.offset; });
+		if (i != end(requests)) {
+			i->requestId = 0;
+		}
+		fileRequestsChanged();
+	};
 	return std::move(_mtp.request(MTPInvokeWithTakeout<MTPupload_GetFile>(
 		MTP_long(*_takeoutId),
 		MTPupload_GetFile(
@@ -366,7 +416,7 @@ auto ApiWrap::fileRequest(const Data::FileLocation &location, int offset) {
 			MTP_int(offset),
 			MTP_int(kFileChunkSize))
 	)).fail([=](const MTP::Error &result) {
-		_fileProcess->requestId = 0;
+		clearRequestId();
 		if (result.type() == qstr("TAKEOUT_FILE_EMPTY")
 			&& _otherDataProcess != nullptr) {
 			filePartDone(
@@ -381,11 +431,13 @@ auto ApiWrap::fileRequest(const Data::FileLocation &location, int offset) {
 			filePartUnavailable();
 		} else if (result.code() == 400
 			&& result.type().startsWith(qstr("FILE_REFERENCE_"))) {
-			filePartRefreshReference(offset);
+			filePartRefreshReference();
 		} else {
 			error(std::move(result));
 		}
-	}).toDC(MTP::ShiftDcId(location.dcId, MTP::kExportMediaDcShift)));
+	}).toDC(
+		MTP::ShiftDcId(location.dcId, MTP::kExportMediaDcShift)
+	).inBackground());
 }
 
 ApiWrap::ApiWrap(QPointer<MTP::Instance> weak, Fn<void(FnMut<void()>)> runner)
@@ -413,6 +465,11 @@ void ApiWrap::startExport(
 	_startProcess = std::make_unique<StartProcess>();
 	_startProcess->done = std::move(done);
 
+	loadCheckpoint();
+	if (_settings->incremental && !_settings->previousPath.isEmpty()) {
+		loadPreviousState();
+	}
+
 	using Step = StartProcess::Step;
 	if (_settings->types & Settings::Type::Userpics) {
 		_startProcess->steps.push_back(Step::UserpicsCount);
@@ -949,6 +1006,9 @@ void ApiWrap::requestMessages(
 	_chatProcess->fileProgress = std::move(progress);
 	_chatProcess->handleSlice = std::move(slice);
 	_chatProcess->done = std::move(done);
+	if (_settings->incremental) {
+		_chatProcess->largestIdPlusOne = previousLastMessageId() + 1;
+	}
 
 	requestMessagesCount(0);
 }
@@ -957,6 +1017,14 @@ void ApiWrap::requestMessagesCount(int localSplitIndex) {
 	Expects(_chatProcess != nullptr);
 	Expects(localSplitIndex < _chatProcess->info.splits.size());
 
+	if (_settings->incremental
+		&& _chatProcess->info.splits[localSplitIndex] < 0
+		&& previousLastMessageId() > 0) {
+		// Migrated group history was exported already and can't grow.
+		messagesCountLoaded(localSplitIndex, 0);
+		return;
+	}
+
 	requestChatMessages(
 		_chatProcess->info.splits[localSplitIndex],
 		0, // offset_id
@@ -1031,6 +1099,11 @@ void ApiWrap::messagesCountLoaded(int localSplitIndex, int count) {
 void ApiWrap::finishExport(FnMut<void()> done) {
 	const auto guard = gsl::finally([&] { _takeoutId = std::nullopt; });
 
+	saveState();
+	if (_checkpoint) {
+		base::take(_checkpoint)->remove();
+	}
+
 	mainRequest(MTPaccount_FinishTakeoutSession(
 		MTP_flags(MTPaccount_FinishTakeoutSession::Flag::f_success)
 	)).done(std::move(done)).send();
@@ -1042,8 +1115,7 @@ void ApiWrap::skipFile(uint64 randomId) {
 	}
 	LOG(("Export Info: File skipped."));
 	Assert(!_fileProcess->requests.empty());
-	Assert(_fileProcess->requestId != 0);
-	_mtp.request(base::take(_fileProcess->requestId)).cancel();
+	cancelFileRequests();
 	base::take(_fileProcess)->done(QString());
 }
 
@@ -1367,6 +1439,15 @@ void ApiWrap::requestMessagesSlice() {
 	if (!count) {
 		loadMessagesFiles({});
 		return;
+	} else if (_chatProcess->prefetchRequested) {
+		// The prefetched slice always starts right after the last one.
+		if (_chatProcess->prefetched) {
+			_chatProcess->prefetchRequested = false;
+			messagesSliceLoaded(*base::take(_chatProcess->prefetched));
+		} else {
+			_chatProcess->prefetchWaiting = true;
+		}
+		return;
 	}
 	requestChatMessages(
 		_chatProcess->info.splits[_chatProcess->localSplitIndex],
@@ -1374,21 +1455,47 @@ void ApiWrap::requestMessagesSlice() {
 		-kMessagesSliceLimit,
 		kMessagesSliceLimit,
 		[=](const MTPmessages_Messages &result) {
+		messagesSliceLoaded(result);
+	});
+}
+
+void ApiWrap::prefetchMessagesSlice(int offsetId) {
+	Expects(_chatProcess != nullptr);
+	Expects(!_chatProcess->prefetchRequested);
+
+	_chatProcess->prefetchRequested = true;
+	requestChatMessages(
+		_chatProcess->info.splits[_chatProcess->localSplitIndex],
+		offsetId,
+		-kMessagesSliceLimit,
+		kMessagesSliceLimit,
+		[=](const MTPmessages_Messages &result) {
 		Expects(_chatProcess != nullptr);
 
-		result.match([&](const MTPDmessages_messagesNotModified &data) {
-			error("Unexpected messagesNotModified received.");
-		}, [&](const auto &data) {
-			if constexpr (MTPDmessages_messages::Is<decltype(data)>()) {
-				_chatProcess->lastSlice = true;
-			}
-			loadMessagesFiles(Data::ParseMessagesSlice(
-				_chatProcess->context,
-				data.vmessages(),
-				data.vusers(),
-				data.vchats(),
-				_chatProcess->info.relativePath));
-		});
+		if (base::take(_chatProcess->prefetchWaiting)) {
+			_chatProcess->prefetchRequested = false;
+			messagesSliceLoaded(result);
+		} else {
+			_chatProcess->prefetched = result;
+		}
+	});
+}
+
+void ApiWrap::messagesSliceLoaded(const MTPmessages_Messages &result) {
+	Expects(_chatProcess != nullptr);
+
+	result.match([&](const MTPDmessages_messagesNotModified &data) {
+		error("Unexpected messagesNotModified received.");
+	}, [&](const auto &data) {
+		if constexpr (MTPDmessages_messages::Is<decltype(data)>()) {
+			_chatProcess->lastSlice = true;
+		}
+		loadMessagesFiles(Data::ParseMessagesSlice(
+			_chatProcess->context,
+			data.vmessages(),
+			data.vusers(),
+			data.vchats(),
+			_chatProcess->info.relativePath));
 	});
 }
 
@@ -1474,6 +1581,10 @@ void ApiWrap::loadMessagesFiles(Data::MessagesSlice &&slice) {
 	_chatProcess->slice = std::move(slice);
 	_chatProcess->fileIndex = 0;
 
+	// Request the next slice while files of this one are loading.
+	if (!_chatProcess->lastSlice) {
+		prefetchMessagesSlice(_chatProcess->slice->list.back().id + 1);
+	}
 	loadNextMessageFile();
 }
 
@@ -1551,6 +1662,9 @@ void ApiWrap::finishMessagesSlice() {
 			_chatProcess->localSplitIndex];
 		if (splitIndex < 0) {
 			slice = AdjustMigrateMessageIds(std::move(slice));
+		} else {
+			_lastMessageIds[_chatProcess->info.peerId]
+				= slice.list.back().id;
 		}
 		if (!_chatProcess->handleSlice(std::move(slice))) {
 			return;
@@ -1560,7 +1674,9 @@ void ApiWrap::finishMessagesSlice() {
 		&& (++_chatProcess->localSplitIndex
 			< _chatProcess->info.splits.size())) {
 		_chatProcess->lastSlice = false;
-		_chatProcess->largestIdPlusOne = 1;
+		_chatProcess->largestIdPlusOne = _settings->incremental
+			? (previousLastMessageId() + 1)
+			: 1;
 	}
 	if (!_chatProcess->lastSlice) {
 		requestMessagesSlice();
@@ -1694,7 +1810,7 @@ bool ApiWrap::writePreloadedFile(
 		const auto process = prepareFileProcess(file, origin);
 		if (const auto result = process->file.writeBlock(file.content)) {
 			file.relativePath = process->relativePath;
-			_fileCache->save(file.location, file.relativePath);
+			fileSaved(file.location, file.relativePath, process->file.size());
 		} else {
 			ioError(result);
 		}
@@ -1715,6 +1831,10 @@ void ApiWrap::loadFile(
 	_fileProcess = prepareFileProcess(file, origin);
 	_fileProcess->progress = std::move(progress);
 	_fileProcess->done = std::move(done);
+	_fileProcess->requestsCount = std::clamp(
+		cExportFileRequestsCount(),
+		1,
+		kFileRequestsCountMax);
 
 	if (_fileProcess->progress) {
 		const auto progress = FileProgress{
@@ -1728,7 +1848,7 @@ void ApiWrap::loadFile(
 
 	loadFilePart();
 
-	Ensures(_fileProcess->requestId != 0);
+	Ensures(!_fileProcess->requests.empty());
 }
 
 auto ApiWrap::prepareFileProcess(
@@ -1752,37 +1872,79 @@ auto ApiWrap::prepareFileProcess(
 }
 
 void ApiWrap::loadFilePart() {
-	if (!_fileProcess
-		|| _fileProcess->requestId
-		|| _fileProcess->requests.size() >= kFileRequestsCount
-		|| (_fileProcess->size > 0
-			&& _fileProcess->offset >= _fileProcess->size)) {
+	if (!_fileProcess || _fileProcess->requestId) {
 		return;
 	}
+	auto &process = *_fileProcess;
+	while (int(process.requests.size()) < process.requestsCount) {
+		if (process.size > 0) {
+			if (process.offset >= process.size) {
+				return;
+			}
+		} else if (!process.requests.empty()) {
+			// Parts of a file with unknown size are requested one by one.
+			return;
+		}
+
+		const auto offset = process.offset;
+		process.requests.push_back({ offset });
+		sendFilePartRequest(offset);
+		process.offset += kFileChunkSize;
+	}
+}
+
+void ApiWrap::sendFilePartRequest(int offset) {
+	Expects(_fileProcess != nullptr);
 
-	const auto offset = _fileProcess->offset;
-	_fileProcess->requests.push_back({ offset });
-	_fileProcess->requestId = fileRequest(
+	using Request = FileProcess::Request;
+	auto &requests = _fileProcess->requests;
+	const auto i = ranges::find(
+		requests,
+		offset,
+		[](const Request &request) { return request.offset; });
+	Assert(i != end(requests));
+
+	const auto sent = crl::now();
+	const auto dcId = _fileProcess->location.dcId;
+	i->requestId = fileRequest(
 		_fileProcess->location,
-		_fileProcess->offset
+		offset
 	).done([=](const MTPupload_File &result) {
-		_fileProcess->requestId = 0;
+		if (_stats && result.type() == mtpc_upload_file) {
+			_stats->addDownload(
+				dcId,
+				result.c_upload_file().vbytes().v.size(),
+				crl::now() - sent);
+		}
 		filePartDone(offset, result);
 	}).send();
-	_fileProcess->offset += kFileChunkSize;
+	fileRequestsChanged();
+}
+
+void ApiWrap::fileRequestsChanged() {
+	if (!_stats) {
+		return;
+	}
+	using Request = FileProcess::Request;
+	_stats->setRequestsQueued(_fileProcess
+		? int(ranges::count_if(
+			_fileProcess->requests,
+			[](const Request &request) { return request.requestId != 0; }))
+		: 0);
+}
+
+void ApiWrap::cancelFileRequests() {
+	Expects(_fileProcess != nullptr);
 
-	if (_fileProcess->size > 0
-		&& _fileProcess->requests.size() < kFileRequestsCount) {
-		// Only one request at a time supported right now.
-		//const auto runner = _runner;
-		//crl::on_main([=] {
-		//	QTimer::singleShot(kFileNextRequestDelay, [=] {
-		//		runner([=] {
-		//			loadFilePart();
-		//		});
-		//	});
-		//});
+	for (auto &request : _fileProcess->requests) {
+		if (request.requestId) {
+			_mtp.request(base::take(request.requestId)).cancel();
+		}
 	}
+	if (_fileProcess->requestId) {
+		_mtp.request(base::take(_fileProcess->requestId)).cancel();
+	}
+	fileRequestsChanged();
 }
 
 void ApiWrap::filePartDone(int offset, const MTPupload_File &result) {
@@ -1814,6 +1976,8 @@ void ApiWrap::filePartDone(int offset, const MTPupload_File &result) {
 		Assert(i != end(requests));
 
 		i->bytes = data.vbytes().v;
+		i->requestId = 0;
+		fileRequestsChanged();
 
 		auto &file = _fileProcess->file;
 		while (!requests.empty() && !requests.front().bytes.isEmpty()) {
@@ -1840,15 +2004,145 @@ void ApiWrap::filePartDone(int offset, const MTPupload_File &result) {
 	}
 
 	auto process = base::take(_fileProcess);
+	fileRequestsChanged();
 	const auto relativePath = process->relativePath;
-	_fileCache->save(process->location, relativePath);
+	fileSaved(process->location, relativePath, process->file.size());
 	process->done(process->relativePath);
 }
 
-void ApiWrap::filePartRefreshReference(int offset) {
+void ApiWrap::loadPreviousState() {
+	Expects(_settings != nullptr);
+
+	auto file = QFile(_settings->previousPath + Output::kStateFileName);
+	if (!file.open(QIODevice::ReadOnly)) {
+		return;
+	}
+	while (!file.atEnd()) {
+		// Each line is "<peer id> <last message id>".
+		const auto parts = file.readLine().trimmed().split(' ');
+		if (parts.size() != 2) {
+			continue;
+		}
+		const auto peerId = PeerId(parts[0].toULongLong());
+		const auto messageId = parts[1].toInt();
+		if (peerId && messageId > 0) {
+			_previousMessageIds[peerId] = messageId;
+		}
+	}
+	_lastMessageIds = _previousMessageIds;
+	LOG(("Export Info: Incremental, %1 chats in '%2'."
+		).arg(_previousMessageIds.size()
+		).arg(_settings->previousPath));
+}
+
+void ApiWrap::saveState() {
+	Expects(_settings != nullptr);
+
+	auto file = QFile(_settings->path + Output::kStateFileName);
+	if (!file.open(QIODevice::WriteOnly)) {
+		LOG(("Export Error: Could not write state '%1'."
+			).arg(file.fileName()));
+		return;
+	}
+	for (const auto &[peerId, messageId] : _lastMessageIds) {
+		file.write(QString("%1 %2\n"
+		).arg(peerId.value
+		).arg(messageId).toUtf8());
+	}
+}
+
+int32 ApiWrap::previousLastMessageId() const {
+	Expects(_chatProcess != nullptr);
+
+	const auto i = _previousMessageIds.find(_chatProcess->info.peerId);
+	return (i != end(_previousMessageIds)) ? i->second : 0;
+}
+
+void ApiWrap::loadCheckpoint() {
+	Expects(_settings != nullptr);
+
+	_checkpoint = std::make_unique<QFile>(
+		_settings->path + Output::kCheckpointFileName);
+
+	// A checkpoint left by an export with other settings is started anew.
+	const auto resume = Output::CheckpointMatches(
+		_settings->path,
+		*_settings);
+	if (resume && _checkpoint->open(QIODevice::ReadOnly)) {
+		auto restored = 0;
+		_checkpoint->readLine();
+		while (!_checkpoint->atEnd()) {
+			// After the header each line is
+			// "<type> <id> <size> <relative path>".
+			const auto line = QString::fromUtf8(
+				_checkpoint->readLine()).trimmed();
+			const auto parts = line.split(' ');
+			if (parts.size() < 4) {
+				continue;
+			}
+			const auto key = LocationKey{
+				parts[0].toULongLong(),
+				parts[1].toULongLong(),
+			};
+			const auto size = parts[2].toLongLong();
+			const auto relativePath = QStringList(parts.mid(3)).join(' ');
+			const auto info = QFileInfo(_settings->path + relativePath);
+			if (info.isFile() && info.size() == size) {
+				_fileCache->save(key, relativePath);
+				++restored;
+			}
+		}
+		_checkpoint->close();
+		LOG(("Export Info: Resuming, %1 files already loaded."
+			).arg(restored));
+	}
+	const auto mode = resume
+		? QIODevice::OpenMode(QIODevice::Append)
+		: (QIODevice::WriteOnly | QIODevice::Truncate);
+	if (!_checkpoint->open(mode)) {
+		const auto info = QFileInfo(*_checkpoint);
+		if (!info.absoluteDir().mkpath(info.absolutePath())
+			|| !_checkpoint->open(mode)) {
+			LOG(("Export Error: Could not open checkpoint '%1'."
+				).arg(_checkpoint->fileName()));
+			_checkpoint = nullptr;
+			return;
+		}
+	}
+	if (!resume) {
+		_checkpoint->write(Output::CheckpointHeader(*_settings) + '\n');
+		_checkpoint->flush();
+	}
+}
+
+void ApiWrap::fileSaved(
+		const Data::FileLocation &location,
+		const QString &relativePath,
+		int size) {
+	_fileCache->save(location, relativePath);
+	if (!_checkpoint || !location) {
+		return;
+	}
+	const auto key = ComputeLocationKey(location);
+	if (!key.id) {
+		// Takeout file locations can't be told apart by the key.
+		return;
+	}
+	_checkpoint->write(QString("%1 %2 %3 %4\n"
+	).arg(key.type
+	).arg(key.id
+	).arg(size
+	).arg(relativePath).toUtf8());
+	_checkpoint->flush();
+}
+
+void ApiWrap::filePartRefreshReference() {
 	Expects(_fileProcess != nullptr);
-	Expects(_fileProcess->requestId == 0);
 
+	if (_fileProcess->requestId) {
+		// Some other part already requested the reference refresh.
+		return;
+	}
 	const auto &origin = _fileProcess->origin;
 	if (!origin.messageId) {
 		error("FILE_REFERENCE error for non-message file.");
@@ -1875,7 +2169,7 @@ void ApiWrap::filePartRefreshReference(int offset) {
 			return true;
 		}).done([=](const MTPmessages_Messages &result) {
 			_fileProcess->requestId = 0;
-			filePartExtractReference(offset, result);
+			filePartExtractReference(result);
 		}).send();
 	} else {
 		_fileProcess->requestId = splitRequest(
@@ -1891,13 +2185,12 @@ void ApiWrap::filePartRefreshReference(int offset) {
 			return true;
 		}).done([=](const MTPmessages_Messages &result) {
 			_fileProcess->requestId = 0;
-			filePartExtractReference(offset, result);
+			filePartExtractReference(result);
 		}).send();
 	}
 }
 
 void ApiWrap::filePartExtractReference(
-		int offset,
 		const MTPmessages_Messages &result) {
 	Expects(_fileProcess != nullptr);
 	Expects(_fileProcess->requestId == 0);
@@ -1924,13 +2217,14 @@ void ApiWrap::filePartExtractReference(
 					_fileProcess->location,
 					message.thumb().file.location);
 				if (refresh1 || refresh2) {
-					_fileProcess->requestId = fileRequest(
-						_fileProcess->location,
-						offset
-					).done([=](const MTPupload_File &result) {
-						_fileProcess->requestId = 0;
-						filePartDone(offset, result);
-					}).send();
+					// Resend all the parts that are not loaded yet and
+					// are not in flight (failed with FILE_REFERENCE_*).
+					for (const auto &request : _fileProcess->requests) {
+						if (!request.requestId && request.bytes.isEmpty()) {
+							sendFilePartRequest(request.offset);
+						}
+					}
+					loadFilePart();
 					return;
 				}
 			}
@@ -1945,6 +2239,7 @@ void ApiWrap::filePartUnavailable() {
 
 	LOG(("Export Error: File unavailable."));
 
+	cancelFileRequests();
 	base::take(_fileProcess)->done(QString());
 }
 
@@ -150,6 +150,8 @@ private:
 	void checkFirstMessageDate(int localSplitIndex, int count);
 	void messagesCountLoaded(int localSplitIndex, int count);
 	void requestMessagesSlice();
+	void prefetchMessagesSlice(int offsetId);
+	void messagesSliceLoaded(const MTPmessages_Messages &result);
 	void requestChatMessages(
 		int splitIndex,
 		int offsetId,
@@ -185,13 +187,23 @@ private:
 		const Data::FileOrigin &origin,
 		Fn<bool(FileProgress)> progress,
 		FnMut<void(QString)> done);
+	void loadPreviousState();
+	void saveState();
+	[[nodiscard]] int32 previousLastMessageId() const;
+	void loadCheckpoint();
+	void fileSaved(
+		const Data::FileLocation &location,
+		const QString &relativePath,
+		int size);
+
 	void loadFilePart();
+	void sendFilePartRequest(int offset);
+	void cancelFileRequests();
+	void fileRequestsChanged();
 	void filePartDone(int offset, const MTPupload_File &result);
 	void filePartUnavailable();
-	void filePartRefreshReference(int offset);
-	void filePartExtractReference(
-		int offset,
-		const MTPmessages_Messages &result);
+	void filePartRefreshReference();
+	void filePartExtractReference(const MTPmessages_Messages &result);
 
 	template <typename Request>
 	class RequestBuilder;
@@ -220,6 +232,9 @@ private:
 
 	std::unique_ptr<StartProcess> _startProcess;
 	std::unique_ptr<LoadedFileCache> _fileCache;
+	std::unique_ptr<QFile> _checkpoint;
+	base::flat_map<PeerId, int32> _previousMessageIds;
+	base::flat_map<PeerId, int32> _lastMessageIds;
 	std::unique_ptr<ContactsProcess> _contactsProcess;
 	std::unique_ptr<UserpicsProcess> _userpicsProcess;
 	std::unique_ptr<OtherDataProcess> _otherDataProcess;
@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "export/export_settings.h"
 #include "export/data/export_data_types.h"
 #include "export/output/export_output_abstract.h"
+#include "export/output/export_output_file.h"
 #include "export/output/export_output_result.h"
 #include "export/output/export_output_stats.h"
 #include "mtproto/mtp_instance.h"
@@ -248,6 +249,9 @@ void ControllerObject::startExport(
 	_settings = NormalizeSettings(settings);
 	_environment = environment;
 
+	if (_settings.incremental) {
+		_settings.previousPath = Output::FindPreviousExport(_settings);
+	}
 	_settings.path = Output::NormalizePath(_settings);
 	_writer = Output::CreateWriter(_settings.format);
 	fillExportSteps();
@@ -603,10 +607,23 @@ int ControllerObject::substepsInStep(Step step) const {
 }
 
 void ControllerObject::setFinishedState() {
+	const auto summary = Output::File(
+		_settings.path + Output::kStatsFileName,
+		nullptr
+	).writeBlock(_stats.summary());
+	if (!summary) {
+		LOG(("Export Error: Could not write '%1'.").arg(summary.path));
+	}
+	const auto downloadTime = _stats.downloadTime();
 	setState(FinishedState{
 		_writer->mainFilePath(),
 		_stats.filesCount(),
-		_stats.bytesCount() });
+		_stats.bytesCount(),
+		(downloadTime
+			? (_stats.downloadedBytes() * 1000 / downloadTime)
+			: 0),
+		_stats.apiWaitTime(),
+		_stats.writeTime() });
 }
 
 Controller::Controller(
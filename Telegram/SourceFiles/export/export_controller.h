@@ -96,6 +96,9 @@ struct FinishedState {
 	QString path;
 	int filesCount = 0;
 	int64 bytesCount = 0;
+	int64 downloadRate = 0;
+	crl::time apiWaitTime = 0;
+	crl::time writeTime = 0;
 };
 
 using State = std::variant<
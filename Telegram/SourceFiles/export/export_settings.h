@@ -83,6 +83,10 @@ struct Settings {
 
 	TimeId availableAt = 0;
 
+	// Export only messages after the ones from the previous export.
+	bool incremental = false;
+	QString previousPath; // Found when the export starts, not saved.
+
 	bool onlySinglePeer() const {
 		return singlePeer.type() != mtpc_inputPeerEmpty;
 	}
@@ -11,30 +11,77 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "export/output/export_output_json.h"
 #include "export/output/export_output_stats.h"
 #include "export/output/export_output_result.h"
+#include "export/export_settings.h"
 
 #include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
 #include <QtCore/QDate>
+#include <QtCore/QDateTime>
 
 namespace Export {
 namespace Output {
 
+QByteArray CheckpointHeader(const Settings &settings) {
+	// Everything that changes what is exported, but not where to.
+	auto peer = mtpBuffer();
+	settings.singlePeer.write(peer);
+	return "settings "
+		+ QByteArray::number(int(settings.format))
+		+ ' ' + QByteArray::number(settings.types.value())
+		+ ' ' + QByteArray::number(settings.fullChats.value())
+		+ ' ' + QByteArray::number(settings.media.types.value())
+		+ ' ' + QByteArray::number(settings.media.sizeLimit)
+		+ ' ' + QByteArray::number(settings.singlePeerFrom)
+		+ ' ' + QByteArray::number(settings.singlePeerTill)
+		+ ' ' + QByteArray::number(settings.incremental ? 1 : 0)
+		+ ' ' + QByteArray(
+			reinterpret_cast<const char*>(peer.constData()),
+			peer.size() * sizeof(mtpPrime)).toHex();
+}
+
+bool CheckpointMatches(const QString &folder, const Settings &settings) {
+	auto file = QFile(folder + kCheckpointFileName);
+	return file.open(QIODevice::ReadOnly)
+		&& (file.readLine().trimmed() == CheckpointHeader(settings));
+}
+
 QString NormalizePath(const Settings &settings) {
 	QDir folder(settings.path);
 	const auto path = folder.absolutePath();
 	auto result = path.endsWith('/') ? path : (path + '/');
 	if (!folder.exists() && !settings.forceSubPath) {
 		return result;
+	} else if (!settings.forceSubPath
+		&& CheckpointMatches(result, settings)) {
+		// Resume an interrupted export right in this folder.
+		return result;
 	}
 	const auto mode = QDir::AllEntries | QDir::NoDotAndDotDot;
 	const auto list = folder.entryInfoList(mode);
 	if (list.isEmpty() && !settings.forceSubPath) {
 		return result;
 	}
+	const auto prefix = QString(settings.onlySinglePeer()
+		? "ChatExport_"
+		: "DataExport_");
+	auto interrupted = QFileInfo();
+	for (const auto &entry : list) {
+		if (entry.isDir()
+			&& entry.fileName().startsWith(prefix)
+			&& CheckpointMatches(
+				entry.absoluteFilePath() + '/',
+				settings)
+			&& (interrupted.fileName().isEmpty()
+				|| entry.lastModified() > interrupted.lastModified())) {
+			interrupted = entry;
+		}
+	}
+	if (!interrupted.fileName().isEmpty()) {
+		return result + interrupted.fileName() + '/';
+	}
 	const auto date = QDate::currentDate();
-	const auto base = QString(settings.onlySinglePeer()
-		? "ChatExport_%1"
-		: "DataExport_%1"
-	).arg(date.toString(Qt::ISODate));
+	const auto base = prefix + date.toString(Qt::ISODate);
 	const auto add = [&](int i) {
 		return base + (i ? " (" + QString::number(i) + ')' : QString());
 	};
@@ -46,6 +93,33 @@ QString NormalizePath(const Settings &settings) {
 	return result;
 }
 
+QString FindPreviousExport(const Settings &settings) {
+	QDir folder(settings.path);
+	const auto path = folder.absolutePath();
+	const auto base = path.endsWith('/') ? path : (path + '/');
+	const auto prefix = QString(settings.onlySinglePeer()
+		? "ChatExport_"
+		: "DataExport_");
+	auto result = QString();
+	auto latest = QDateTime();
+	const auto check = [&](const QString &folder) {
+		const auto state = QFileInfo(folder + kStateFileName);
+		if (state.isFile()
+			&& (latest.isNull() || state.lastModified() > latest)) {
+			result = folder;
+			latest = state.lastModified();
+		}
+	};
+	check(base);
+	const auto mode = QDir::Dirs | QDir::NoDotAndDotDot;
+	for (const auto &entry : folder.entryInfoList(mode)) {
+		if (entry.fileName().startsWith(prefix)) {
+			check(base + entry.fileName() + '/');
+		}
+	}
+	return result;
+}
+
 std::unique_ptr<AbstractWriter> CreateWriter(Format format) {
 	switch (format) {
 	case Format::Html: return std::make_unique<HtmlWriter>();
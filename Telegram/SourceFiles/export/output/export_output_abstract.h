@@ -27,7 +27,25 @@ struct Environment;
 
 namespace Output {
 
+// While the export is running it keeps the list of downloaded files
+// in this file, so that an interrupted export can be resumed later.
+inline constexpr auto kCheckpointFileName = "export_checkpoint.txt";
+
+// Written into the export folder when the export is finished, keeps
+// the last exported message id for each chat for incremental exports.
+inline constexpr auto kStateFileName = "export_state.txt";
+
+// Download, request and disk timings of the export, in JSON.
+inline constexpr auto kStatsFileName = "export_stats.json";
+
+// The first line of the checkpoint, it tells which export it belongs to.
+[[nodiscard]] QByteArray CheckpointHeader(const Settings &settings);
+[[nodiscard]] bool CheckpointMatches(
+	const QString &folder,
+	const Settings &settings);
+
 QString NormalizePath(const Settings &settings);
+QString FindPreviousExport(const Settings &settings);
 
 struct Result;
 class Stats;
@@ -21,6 +21,7 @@ namespace Output {
 namespace {
 
 constexpr auto kMessagesInFile = 1000;
+constexpr auto kChatFileSizeLimit = 2 * 1024 * 1024;
 constexpr auto kPersonalUserpicSize = 90;
 constexpr auto kEntryUserpicSize = 48;
 constexpr auto kServiceMessagePhotoSize = 60;
@@ -475,6 +476,7 @@ public:
 	Wrap(const QString &path, const QString &base, Stats *stats);
 
 	[[nodiscard]] bool empty() const;
+	[[nodiscard]] int size() const;
 
 	[[nodiscard]] QByteArray pushTag(
 		const QByteArray &tag,
@@ -654,6 +656,10 @@ bool HtmlWriter::Wrap::empty() const {
 	return _file.empty();
 }
 
+int HtmlWriter::Wrap::size() const {
+	return _file.size();
+}
+
 QByteArray HtmlWriter::Wrap::pushTag(
 		const QByteArray &tag,
 		std::map<QByteArray, QByteArray> &&attributes) {
@@ -694,6 +700,7 @@ QByteArray HtmlWriter::Wrap::pushUserpic(const UserpicData &userpic) {
 			{ "class", "userpic" },
 			{ "style", sizeStyle },
 			{ "src", relativePath(userpic.imageLink).toUtf8() },
+			{ "loading", "lazy" },
 			{ "empty", "" }
 		}));
 	} else {
@@ -1339,6 +1346,7 @@ QByteArray HtmlWriter::Wrap::pushGenericMedia(const MediaData &data) {
 		result.append(pushTag("img", {
 			{ "class", "thumb pull_left" },
 			{ "src", relativePath(data.thumb).toUtf8() },
+			{ "loading", "lazy" },
 			{ "empty", "" }
 		}));
 	}
@@ -1412,6 +1420,7 @@ QByteArray HtmlWriter::Wrap::pushStickerMedia(
 		{ "class", "sticker" },
 		{ "style", sizeStyle },
 		{ "src", relativePath(thumb).toUtf8() },
+		{ "loading", "lazy" },
 		{ "empty", "" }
 	}));
 	result.append(popTag());
@@ -1465,6 +1474,7 @@ QByteArray HtmlWriter::Wrap::pushAnimatedMedia(
 		{ "class", "animated" },
 		{ "style", sizeStyle },
 		{ "src", relativePath(data.thumb.file.relativePath).toUtf8() },
+		{ "loading", "lazy" },
 		{ "empty", "" }
 	}));
 	result.append(popTag());
@@ -1524,6 +1534,7 @@ QByteArray HtmlWriter::Wrap::pushVideoFileMedia(
 		{ "class", "video_file" },
 		{ "style", sizeStyle },
 		{ "src", relativePath(data.thumb.file.relativePath).toUtf8() },
+		{ "loading", "lazy" },
 		{ "empty", "" }
 	}));
 	result.append(popTag());
@@ -1575,6 +1586,7 @@ QByteArray HtmlWriter::Wrap::pushPhotoMedia(
 		{ "class", "photo" },
 		{ "style", sizeStyle },
 		{ "src", relativePath(thumb).toUtf8() },
+		{ "loading", "lazy" },
 		{ "empty", "" }
 	}));
 	result.append(popTag());
@@ -2390,6 +2402,9 @@ Result HtmlWriter::writeDialogStart(const Data::DialogInfo &data) {
 
 	_chat = fileWithRelativePath(data.relativePath + messagesFile(0));
 	_chatFileEmpty = true;
+	_chatFileIndex = 0;
+	_messagesInFile = 0;
+	_chatPages.clear();
 	_messagesCount = 0;
 	_dateMessageId = 0;
 	_lastMessageInfo = nullptr;
@@ -2405,9 +2420,6 @@ Result HtmlWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 	const auto messageLinkWrapper = [&](int messageId, QByteArray text) {
 		return wrapMessageLink(messageId, text);
 	};
-	auto oldIndex = (_messagesCount > 0)
-		? ((_messagesCount - 1) / kMessagesInFile)
-		: 0;
 	auto previous = _lastMessageInfo.get();
 	auto saved = std::optional<MessageInfo>();
 	auto block = QByteArray();
@@ -2415,11 +2427,16 @@ Result HtmlWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 		if (Data::SkipMessageByDate(message, _settings)) {
 			continue;
 		}
-		const auto newIndex = (_messagesCount / kMessagesInFile);
-		if (oldIndex != newIndex) {
+		// Start a new file either by messages count or by its size,
+		// so that pages with lots of media stay fast to open.
+		const auto full = (_messagesInFile >= kMessagesInFile)
+			|| (_messagesInFile > 0
+				&& _chat->size() + block.size() >= kChatFileSizeLimit);
+		if (full) {
+			const auto index = _chatFileIndex + 1;
 			if (const auto result = _chat->writeBlock(block); !result) {
 				return result;
-			} else if (const auto next = switchToNextChatFile(newIndex)) {
+			} else if (const auto next = switchToNextChatFile(index)) {
 				Assert(saved.has_value() || _lastMessageInfo != nullptr);
 				_lastMessageIdsPerFile.push_back(saved
 					? saved->id
@@ -2428,18 +2445,25 @@ Result HtmlWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 				_lastMessageInfo = nullptr;
 				previous = nullptr;
 				saved = std::nullopt;
-				oldIndex = newIndex;
+				_chatFileIndex = index;
+				_messagesInFile = 0;
 			} else {
 				return next;
 			}
 		}
 		if (_chatFileEmpty) {
-			if (const auto result = writeDialogOpening(oldIndex); !result) {
+			const auto result = writeDialogOpening(_chatFileIndex);
+			if (!result) {
 				return result;
 			}
 			_chatFileEmpty = false;
 		}
 		const auto date = message.date;
+		if (!_messagesInFile) {
+			_chatPages.push_back({ date, date });
+		} else {
+			_chatPages.back().till = date;
+		}
 		if (DisplayDate(date, previous ? previous->date : 0)) {
 			block.append(_chat->pushServiceMessage(
 				--_dateMessageId,
@@ -2458,6 +2482,7 @@ Result HtmlWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 		block.append(content);
 
 		++_messagesCount;
+		++_messagesInFile;
 		saved = info;
 		previous = &*saved;
 	}
@@ -2494,6 +2519,8 @@ Result HtmlWriter::writeDialogEnd() {
 
 	if (const auto closed = base::take(_chat)->close(); !closed) {
 		return closed;
+	} else if (const auto pages = writeChatPages(); !pages) {
+		return pages;
 	} else if (_settings.onlySinglePeer()) {
 		return Result::Success();
 	}
@@ -2623,10 +2650,44 @@ Result HtmlWriter::writeDialogOpening(int index) {
 			}));
 		block.append("Previous messages");
 		block.append(_chat->popTag());
+		block.append(_chat->pushTag("a", {
+			{ "class", "pagination block_link" },
+			{ "href", pagesFile().toUtf8() }
+			}));
+		block.append("Jump to date");
+		block.append(_chat->popTag());
 	}
 	return _chat->writeBlock(block);
 }
 
+Result HtmlWriter::writeChatPages() {
+	if (_chatPages.size() < 2) {
+		return Result::Success();
+	}
+	const auto file = fileWithRelativePath(_dialog.relativePath + pagesFile());
+	auto block = file->pushHeader(
+		"Jump to date",
+		_dialog.relativePath + messagesFile(0));
+	block.append(file->pushDiv("page_body list_page"));
+	block.append(file->pushDiv("entry_list"));
+	for (auto i = 0, count = int(_chatPages.size()); i != count; ++i) {
+		const auto &page = _chatPages[i];
+		block.append(file->pushTag("a", {
+			{ "class", "pagination block_link" },
+			{ "href", messagesFile(i).toUtf8() }
+		}));
+		block.append(FormatDateText(page.from));
+		if (DisplayDate(page.till, page.from)) {
+			block.append(" \xE2\x80\x93 " + FormatDateText(page.till));
+		}
+		block.append(file->popTag());
+	}
+	if (const auto result = file->writeBlock(block); !result) {
+		return result;
+	}
+	return file->close();
+}
+
 void HtmlWriter::pushSection(
 		int priority,
 		const QByteArray &label,
@@ -2703,6 +2764,12 @@ Result HtmlWriter::switchToNextChatFile(int index) {
 	});
 	next.append("Next messages");
 	next.append(_chat->popTag());
+	next.append(_chat->pushTag("a", {
+		{ "class", "pagination block_link" },
+		{ "href", pagesFile().toUtf8() }
+	}));
+	next.append("Jump to date");
+	next.append(_chat->popTag());
 	if (const auto result = _chat->writeBlock(next); !result) {
 		return result;
 	} else if (const auto end = _chat->close(); !end) {
@@ -2767,6 +2834,10 @@ QString HtmlWriter::messagesFile(int index) const {
 		+ ".html";
 }
 
+QString HtmlWriter::pagesFile() const {
+	return "pages.html";
+}
+
 std::unique_ptr<HtmlWriter::Wrap> HtmlWriter::fileWithRelativePath(
 		const QString &path) const {
 	return std::make_unique<Wrap>(
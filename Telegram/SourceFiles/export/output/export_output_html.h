@@ -98,6 +98,7 @@ private:
 	[[nodiscard]] std::unique_ptr<Wrap> fileWithRelativePath(
 		const QString &path) const;
 	[[nodiscard]] QString messagesFile(int index) const;
+	[[nodiscard]] QString pagesFile() const;
 
 	[[nodiscard]] Result writeSavedContacts(const Data::ContactsList &data);
 	[[nodiscard]] Result writeFrequentContacts(const Data::ContactsList &data);
@@ -109,6 +110,7 @@ private:
 	[[nodiscard]] Result writeDialogOpening(int index);
 	[[nodiscard]] Result switchToNextChatFile(int index);
 	[[nodiscard]] Result writeEmptySinglePeer();
+	[[nodiscard]] Result writeChatPages();
 
 	void pushSection(
 		int priority,
@@ -160,6 +162,14 @@ private:
 	std::unique_ptr<Wrap> _chat;
 	std::vector<int> _lastMessageIdsPerFile;
 	bool _chatFileEmpty = false;
+	int _chatFileIndex = 0;
+	int _messagesInFile = 0;
+
+	struct ChatPage {
+		TimeId from = 0;
+		TimeId till = 0;
+	};
+	std::vector<ChatPage> _chatPages;
 
 };
 
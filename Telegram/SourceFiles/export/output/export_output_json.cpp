@@ -21,6 +21,8 @@ namespace Export {
 namespace Output {
 namespace {
 
+constexpr auto kOutputBufferSize = 1024 * 1024;
+
 using Context = details::JsonContext;
 
 QByteArray SerializeString(const QByteArray &value) {
@@ -688,13 +690,14 @@ Result JsonWriter::start(
 	_environment = environment;
 	_stats = stats;
 	_output = fileWithRelativePath(mainFileRelativePath());
+	_buffer.reserve(kOutputBufferSize);
 	if (_settings.onlySinglePeer()) {
 		return Result::Success();
 	}
 	auto block = pushNesting(Context::kObject);
 	block.append(prepareObjectItemStart("about"));
 	block.append(SerializeString(_environment.aboutTelegram));
-	return _output->writeBlock(block);
+	return writeBlock(block);
 }
 
 QByteArray JsonWriter::pushNesting(Context::Type type) {
@@ -735,7 +738,7 @@ Result JsonWriter::writePersonal(const Data::PersonalInfo &data) {
 	Expects(_output != nullptr);
 
 	const auto &info = data.user.info;
-	return _output->writeBlock(
+	return writeBlock(
 		prepareObjectItemStart("personal_information")
 		+ SerializeObject(_context, {
 		{ "user_id", Data::NumberToString(data.user.bareId) },
@@ -764,7 +767,7 @@ Result JsonWriter::writeUserpicsStart(const Data::UserpicsInfo &data) {
 	Expects(_output != nullptr);
 
 	auto block = prepareObjectItemStart("profile_pictures");
-	return _output->writeBlock(block + pushNesting(Context::kArray));
+	return writeBlock(block + pushNesting(Context::kArray));
 }
 
 Result JsonWriter::writeUserpicsSlice(const Data::UserpicsSlice &data) {
@@ -803,13 +806,13 @@ Result JsonWriter::writeUserpicsSlice(const Data::UserpicsSlice &data) {
 			},
 		}));
 	}
-	return _output->writeBlock(block);
+	return writeBlock(block);
 }
 
 Result JsonWriter::writeUserpicsEnd() {
 	Expects(_output != nullptr);
 
-	return _output->writeBlock(popNesting());
+	return writeBlock(popNesting());
 }
 
 Result JsonWriter::writeContactsList(const Data::ContactsList &data) {
@@ -862,7 +865,7 @@ Result JsonWriter::writeSavedContacts(const Data::ContactsList &data) {
 		}
 	}
 	block.append(popNesting());
-	return _output->writeBlock(block + popNesting());
+	return writeBlock(block + popNesting());
 }
 
 Result JsonWriter::writeFrequentContacts(const Data::ContactsList &data) {
@@ -906,7 +909,7 @@ Result JsonWriter::writeFrequentContacts(const Data::ContactsList &data) {
 	writeList(data.inlineBots, "inline_bots");
 	writeList(data.phoneCalls, "calls");
 	block.append(popNesting());
-	return _output->writeBlock(block + popNesting());
+	return writeBlock(block + popNesting());
 }
 
 Result JsonWriter::writeSessionsList(const Data::SessionsList &data) {
@@ -988,7 +991,7 @@ Result JsonWriter::writeOtherData(const Data::File &data) {
 	} else {
 		pushArray(document.array());
 	}
-	return _output->writeBlock(block);
+	return writeBlock(block);
 }
 
 Result JsonWriter::writeSessions(const Data::SessionsList &data) {
@@ -1022,7 +1025,7 @@ Result JsonWriter::writeSessions(const Data::SessionsList &data) {
 		}));
 	}
 	block.append(popNesting());
-	return _output->writeBlock(block + popNesting());
+	return writeBlock(block + popNesting());
 }
 
 Result JsonWriter::writeWebSessions(const Data::SessionsList &data) {
@@ -1048,7 +1051,7 @@ Result JsonWriter::writeWebSessions(const Data::SessionsList &data) {
 		}));
 	}
 	block.append(popNesting());
-	return _output->writeBlock(block + popNesting());
+	return writeBlock(block + popNesting());
 }
 
 Result JsonWriter::writeDialogsStart(const Data::DialogsInfo &data) {
@@ -1096,7 +1099,7 @@ Result JsonWriter::writeDialogStart(const Data::DialogInfo &data) {
 		+ Data::NumberToString(Data::PeerToBareId(data.peerId)));
 	block.append(prepareObjectItemStart("messages"));
 	block.append(pushNesting(Context::kArray));
-	return _output->writeBlock(block);
+	return writeBlock(block);
 }
 
 Result JsonWriter::validateDialogsMode(bool isLeftChannel) {
@@ -1121,25 +1124,28 @@ Result JsonWriter::validateDialogsMode(bool isLeftChannel) {
 Result JsonWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 	Expects(_output != nullptr);
 
-	auto block = QByteArray();
 	for (const auto &message : data.list) {
 		if (Data::SkipMessageByDate(message, _settings)) {
 			continue;
 		}
-		block.append(prepareArrayItemStart() + SerializeMessage(
-			_context,
-			message,
-			data.peers,
-			_environment.internalLinksDomain));
+		const auto result = writeBlock(prepareArrayItemStart()
+			+ SerializeMessage(
+				_context,
+				message,
+				data.peers,
+				_environment.internalLinksDomain));
+		if (!result) {
+			return result;
+		}
 	}
-	return block.isEmpty() ? Result::Success() : _output->writeBlock(block);
+	return Result::Success();
 }
 
 Result JsonWriter::writeDialogEnd() {
 	Expects(_output != nullptr);
 
 	auto block = popNesting();
-	return _output->writeBlock(block + popNesting());
+	return writeBlock(block + popNesting());
 }
 
 Result JsonWriter::writeDialogsEnd() {
@@ -1159,14 +1165,14 @@ Result JsonWriter::writeChatsStart(
 	block.append(prepareObjectItemStart("about"));
 	block.append(SerializeString(about));
 	block.append(prepareObjectItemStart("list"));
-	return _output->writeBlock(block + pushNesting(Context::kArray));
+	return writeBlock(block + pushNesting(Context::kArray));
 }
 
 Result JsonWriter::writeChatsEnd() {
 	Expects(_output != nullptr);
 
 	auto block = popNesting();
-	return _output->writeBlock(block + popNesting());
+	return writeBlock(block + popNesting());
 }
 
 Result JsonWriter::finish() {
@@ -1174,11 +1180,42 @@ Result JsonWriter::finish() {
 
 	if (_settings.onlySinglePeer()) {
 		Assert(_context.nesting.empty());
-		return Result::Success();
+		return flush();
 	}
 	auto block = popNesting();
 	Assert(_context.nesting.empty());
-	return _output->writeBlock(block);
+	if (const auto result = writeBlock(block); !result) {
+		return result;
+	}
+	return flush();
+}
+
+Result JsonWriter::writeBlock(const QByteArray &block) {
+	Expects(_output != nullptr);
+
+	if (_buffer.size() + block.size() <= kOutputBufferSize) {
+		_buffer.append(block);
+		return Result::Success();
+	} else if (const auto result = flush(); !result) {
+		return result;
+	} else if (block.size() >= kOutputBufferSize) {
+		return _output->writeBlock(block);
+	}
+	_buffer.append(block);
+	return Result::Success();
+}
+
+Result JsonWriter::flush() {
+	Expects(_output != nullptr);
+
+	if (_buffer.isEmpty()) {
+		return Result::Success();
+	}
+	const auto result = _output->writeBlock(_buffer);
+	if (result) {
+		_buffer.resize(0);
+	}
+	return result;
 }
 
 QString JsonWriter::mainFilePath() {
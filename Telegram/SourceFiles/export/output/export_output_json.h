@@ -90,6 +90,11 @@ private:
 		const QByteArray &about);
 	[[nodiscard]] Result writeChatsEnd();
 
+	// Small blocks are collected in _buffer and written to _output
+	// in large chunks, so that the file isn't flushed for each of them.
+	[[nodiscard]] Result writeBlock(const QByteArray &block);
+	[[nodiscard]] Result flush();
+
 	Settings _settings;
 	Environment _environment;
 	Stats *_stats = nullptr;
@@ -99,6 +104,7 @@ private:
 	DialogsMode _dialogsMode = DialogsMode::None;
 
 	std::unique_ptr<File> _output;
+	QByteArray _buffer;
 
 };
 
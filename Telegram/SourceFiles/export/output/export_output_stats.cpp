@@ -7,12 +7,34 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "export/output/export_output_stats.h"
 
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QJsonArray>
+
 namespace Export {
 namespace Output {
+namespace {
+
+// Busy intervals kept to merge the requests that are still running.
+constexpr auto kApiBusyLimit = 64;
+
+} // namespace
 
 Stats::Stats(const Stats &other)
 : _files(other._files.load())
 , _bytes(other._bytes.load()) {
+	QMutexLocker lock(&other._mutex);
+	_downloads = other._downloads;
+	_downloadStarted = other._downloadStarted;
+	_downloadTime = other._downloadTime;
+	_requestsQueued = other._requestsQueued;
+	_apiWait = other._apiWait;
+	_apiBusy = other._apiBusy;
+	_apiRequests = other._apiRequests;
+	_write = other._write;
+	_writeMax = other._writeMax;
+	_writes = other._writes;
+	_requestsQueuedMax = other._requestsQueuedMax;
 }
 
 void Stats::incrementFiles() {
@@ -23,6 +45,57 @@ void Stats::incrementBytes(int count) {
 	_bytes += count;
 }
 
+void Stats::addDownload(int dcId, int bytes, crl::time duration) {
+	QMutexLocker lock(&_mutex);
+	auto &download = _downloads[dcId];
+	download.bytes += bytes;
+	++download.requests;
+	download.duration += duration;
+}
+
+void Stats::addApiWait(crl::time sent, crl::time received) {
+	QMutexLocker lock(&_mutex);
+	++_apiRequests;
+
+	// Requests are added when they finish, so no busy interval ends
+	// after received. Merge the ones that end after sent into this one
+	// and count only the time none of them covered.
+	auto from = end(_apiBusy);
+	while (from != begin(_apiBusy) && (from - 1)->second >= sent) {
+		--from;
+	}
+	auto covered = crl::time(0);
+	auto start = sent;
+	for (auto i = from; i != end(_apiBusy); ++i) {
+		covered += i->second - std::max(i->first, sent);
+		start = std::min(start, i->first);
+	}
+	_apiBusy.erase(from, end(_apiBusy));
+	_apiBusy.emplace_back(start, received);
+	if (_apiBusy.size() > kApiBusyLimit) {
+		_apiBusy.erase(begin(_apiBusy));
+	}
+	_apiWait += (received - sent) - covered;
+}
+
+void Stats::addWrite(crl::time duration) {
+	QMutexLocker lock(&_mutex);
+	_write += duration;
+	_writeMax = std::max(_writeMax, duration);
+	++_writes;
+}
+
+void Stats::setRequestsQueued(int count) {
+	QMutexLocker lock(&_mutex);
+	if (count > 0 && !_requestsQueued) {
+		_downloadStarted = crl::now();
+	} else if (!count && _requestsQueued) {
+		_downloadTime += crl::now() - _downloadStarted;
+	}
+	_requestsQueued = count;
+	_requestsQueuedMax = std::max(_requestsQueuedMax, count);
+}
+
 int Stats::filesCount() const {
 	return _files;
 }
@@ -31,5 +104,86 @@ int64 Stats::bytesCount() const {
 	return _bytes;
 }
 
+base::flat_map<int, Stats::Download> Stats::downloads() const {
+	QMutexLocker lock(&_mutex);
+	return _downloads;
+}
+
+int64 Stats::downloadedBytes() const {
+	QMutexLocker lock(&_mutex);
+	return ranges::accumulate(
+		_downloads,
+		int64(0),
+		ranges::plus(),
+		[](const auto &pair) { return pair.second.bytes; });
+}
+
+crl::time Stats::downloadTime() const {
+	QMutexLocker lock(&_mutex);
+	return _downloadTime
+		+ (_requestsQueued ? (crl::now() - _downloadStarted) : 0);
+}
+
+crl::time Stats::apiWaitTime() const {
+	QMutexLocker lock(&_mutex);
+	return _apiWait;
+}
+
+int Stats::apiRequestsCount() const {
+	QMutexLocker lock(&_mutex);
+	return _apiRequests;
+}
+
+crl::time Stats::writeTime() const {
+	QMutexLocker lock(&_mutex);
+	return _write;
+}
+
+crl::time Stats::writeTimeMax() const {
+	QMutexLocker lock(&_mutex);
+	return _writeMax;
+}
+
+int Stats::writesCount() const {
+	QMutexLocker lock(&_mutex);
+	return _writes;
+}
+
+int Stats::requestsQueuedMax() const {
+	QMutexLocker lock(&_mutex);
+	return _requestsQueuedMax;
+}
+
+QByteArray Stats::summary() const {
+	auto dcs = QJsonArray();
+	for (const auto &[dcId, download] : downloads()) {
+		dcs.append(QJsonObject{
+			{ "dc", dcId },
+			{ "bytes", download.bytes },
+			{ "requests", download.requests },
+			{ "request_time_ms", download.duration },
+			{ "average_request_ms", download.requests
+				? (download.duration / download.requests)
+				: 0 },
+		});
+	}
+	const auto time = downloadTime();
+	const auto bytes = downloadedBytes();
+	return QJsonDocument(QJsonObject{
+		{ "files", filesCount() },
+		{ "bytes_written", bytesCount() },
+		{ "bytes_downloaded", bytes },
+		{ "download_time_ms", time },
+		{ "download_rate", time ? (bytes * 1000 / time) : 0 },
+		{ "dcs", dcs },
+		{ "api_requests", apiRequestsCount() },
+		{ "api_wait_ms", apiWaitTime() },
+		{ "writes", writesCount() },
+		{ "write_time_ms", writeTime() },
+		{ "write_time_max_ms", writeTimeMax() },
+		{ "file_requests_in_flight_max", requestsQueuedMax() },
+	}).toJson(QJsonDocument::Indented);
+}
+
 } // namespace Output
 } // namespace Export
@@ -7,6 +7,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #pragma once
 
+#include <QtCore/QMutex>
+
 #include <atomic>
 
 namespace Export {
@@ -14,19 +16,58 @@ namespace Output {
 
 class Stats {
 public:
+	struct Download {
+		int64 bytes = 0;
+		int requests = 0;
+		crl::time duration = 0;
+	};
+
 	Stats() = default;
 	Stats(const Stats &other);
 
 	void incrementFiles();
 	void incrementBytes(int count);
 
+	// Both durations include the time MTP spent re-sending after
+	// FLOOD_WAIT errors, those are retried there and never reach us.
+	// The API wait is wall-clock, overlapping requests count once.
+	void addDownload(int dcId, int bytes, crl::time duration);
+	void addApiWait(crl::time sent, crl::time received);
+	void addWrite(crl::time duration);
+	void setRequestsQueued(int count);
+
 	int filesCount() const;
 	int64 bytesCount() const;
 
+	base::flat_map<int, Download> downloads() const;
+	int64 downloadedBytes() const;
+	crl::time downloadTime() const;
+	crl::time apiWaitTime() const;
+	int apiRequestsCount() const;
+	crl::time writeTime() const;
+	crl::time writeTimeMax() const;
+	int writesCount() const;
+	int requestsQueuedMax() const;
+
+	QByteArray summary() const;
+
 private:
 	std::atomic<int> _files;
 	std::atomic<int64> _bytes;
 
+	mutable QMutex _mutex;
+	base::flat_map<int, Download> _downloads;
+	crl::time _downloadStarted = 0;
+	crl::time _downloadTime = 0;
+	int _requestsQueued = 0;
+	crl::time _apiWait = 0;
+	std::vector<std::pair<crl::time, crl::time>> _apiBusy;
+	int _apiRequests = 0;
+	crl::time _write = 0;
+	crl::time _writeMax = 0;
+	int _writes = 0;
+	int _requestsQueuedMax = 0;
+
 };
 
 } // namespace Output
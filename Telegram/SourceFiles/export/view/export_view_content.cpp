@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "export/export_settings.h"
 #include "lang/lang_keys.h"
 #include "ui/text/format_values.h"
+#include "kotato/kotato_lang.h"
 
 namespace Export {
 namespace View {
@@ -156,6 +157,16 @@ Content ContentFromState(const FinishedState &state) {
 			Ui::FormatSizeText(state.bytesCount)),
 		QString(),
 		1. });
+	if (state.downloadRate > 0) {
+		result.rows.push_back({
+			Content::kDoneId,
+			ktr("ktg_export_total_stats",
+				{ "rate", Ui::FormatSizeText(state.downloadRate) },
+				{ "api", QString::number(state.apiWaitTime / 1000) },
+				{ "disk", QString::number(state.writeTime / 1000) }),
+			QString(),
+			1. });
+	}
 	return result;
 }
 
@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "export/output/export_output_abstract.h"
 #include "export/view/export_view_panel_controller.h"
+#include "kotato/kotato_lang.h"
 #include "lang/lang_keys.h"
 #include "ui/widgets/checkbox.h"
 #include "ui/widgets/buttons.h"
@@ -273,6 +274,26 @@ void SettingsWidget::setupPathAndFormat(
 	addLocationLabel(container);
 	addFormatOption(tr::lng_export_option_html(tr::now), Format::Html);
 	addFormatOption(tr::lng_export_option_json(tr::now), Format::Json);
+
+	const auto incremental = container->add(
+		object_ptr<Ui::Checkbox>(
+			container,
+			ktr("ktg_export_option_incremental"),
+			readData().incremental,
+			st::defaultBoxCheckbox),
+		st::exportSettingPadding);
+	incremental->checkedChanges(
+	) | rpl::start_with_next([=](bool checked) {
+		changeData([&](Settings &data) {
+			data.incremental = checked;
+		});
+	}, incremental->lifetime());
+	container->add(
+		object_ptr<Ui::FlatLabel>(
+			container,
+			ktr("ktg_export_option_incremental_about"),
+			st::exportAboutOptionLabel),
+		st::exportAboutOptionPadding);
 }
 
 void SettingsWidget::addLocationLabel(
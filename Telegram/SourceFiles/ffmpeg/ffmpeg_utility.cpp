@@ -12,6 +12,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "logs.h"
 
 #include <QImage>
+#include <QtCore/QIODevice>
 
 #ifdef LIB_FFMPEG_USE_QT_PRIVATE_API
 #include <private/qdrawhelper_p.h>
@@ -19,6 +20,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 extern "C" {
 #include <libavutil/opt.h>
+#include <libavutil/hwcontext.h>
 } // extern "C"
 
 namespace FFmpeg {
@@ -32,6 +34,74 @@ constexpr auto kAvioBlockSize = 4096;
 constexpr auto kTimeUnknown = std::numeric_limits<crl::time>::min();
 constexpr auto kDurationMax = crl::time(std::numeric_limits<int>::max());
 
+// In the order of preference, decoders fall back to software ones.
+constexpr auto kHwDeviceTypes = std::array{
+#ifdef Q_OS_WIN
+	AV_HWDEVICE_TYPE_D3D11VA,
+	AV_HWDEVICE_TYPE_DXVA2,
+#elif defined Q_OS_MAC // Q_OS_WIN
+	AV_HWDEVICE_TYPE_VIDEOTOOLBOX,
+#else // Q_OS_WIN || Q_OS_MAC
+	AV_HWDEVICE_TYPE_VAAPI,
+#endif // Q_OS_WIN || Q_OS_MAC
+};
+
+[[nodiscard]] AVPixelFormat HwPixelFormat(
+		const AVCodec *codec,
+		AVHWDeviceType type) {
+	for (auto i = 0;; ++i) {
+		const auto config = avcodec_get_hw_config(codec, i);
+		if (!config) {
+			return AV_PIX_FMT_NONE;
+		} else if ((config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX)
+			&& (config->device_type == type)) {
+			return config->pix_fmt;
+		}
+	}
+}
+
+[[nodiscard]] AVPixelFormat GetHwFormat(
+		AVCodecContext *context,
+		const AVPixelFormat *formats) {
+	if (context->hw_device_ctx) {
+		const auto device = reinterpret_cast<AVHWDeviceContext*>(
+			context->hw_device_ctx->data);
+		const auto wanted = HwPixelFormat(context->codec, device->type);
+		for (auto format = formats; *format != AV_PIX_FMT_NONE; ++format) {
+			if (*format == wanted) {
+				return wanted;
+			}
+		}
+		DEBUG_LOG(("Video Info: "
+			"Hardware decoding is not available for this stream."));
+	}
+	return avcodec_default_get_format(context, formats);
+}
+
+bool InitHardwareDecoding(
+		not_null<AVCodecContext*> context,
+		not_null<const AVCodec*> codec) {
+	for (const auto type : kHwDeviceTypes) {
+		if (HwPixelFormat(codec, type) == AV_PIX_FMT_NONE) {
+			continue;
+		}
+		auto device = (AVBufferRef*)nullptr;
+		const auto error = AvErrorWrap(
+			av_hwdevice_ctx_create(&device, type, nullptr, nullptr, 0));
+		if (error || !device) {
+			LogError(qstr("av_hwdevice_ctx_create"), error);
+			continue;
+		}
+		context->hw_device_ctx = device;
+		context->get_format = GetHwFormat;
+		DEBUG_LOG(("Video Info: Using \"%1\" hardware decoding for \"%2\"."
+			).arg(av_hwdevice_get_type_name(type)
+			).arg(codec->name));
+		return true;
+	}
+	return false;
+}
+
 void AlignedImageBufferCleanupHandler(void* data) {
 	const auto buffer = static_cast<uchar*>(data);
 	delete[] buffer;
@@ -148,6 +218,36 @@ FormatPointer MakeFormatPointer(
 	return FormatPointer(result);
 }
 
+int ReadIODevice(void *opaque, uint8_t *buffer, int bufferSize) {
+	const auto device = static_cast<QIODevice*>(opaque);
+	const auto result = device->read(
+		reinterpret_cast<char*>(buffer),
+		bufferSize);
+	return (result > 0) ? int(result) : AVERROR_EOF;
+}
+
+int WriteIODevice(void *opaque, uint8_t *buffer, int bufferSize) {
+	const auto device = static_cast<QIODevice*>(opaque);
+	const auto result = device->write(
+		reinterpret_cast<const char*>(buffer),
+		bufferSize);
+	return (result == bufferSize) ? bufferSize : AVERROR(EIO);
+}
+
+int64_t SeekIODevice(void *opaque, int64_t offset, int whence) {
+	const auto device = static_cast<QIODevice*>(opaque);
+	const auto seek = [&](int64_t position) -> int64_t {
+		return device->seek(position) ? device->pos() : -1;
+	};
+	switch (whence) {
+	case SEEK_SET: return seek(offset);
+	case SEEK_CUR: return seek(device->pos() + offset);
+	case SEEK_END: return seek(device->size() + offset);
+	case AVSEEK_SIZE: return device->size();
+	}
+	return -1;
+}
+
 void FormatDeleter::operator()(AVFormatContext *value) {
 	if (value) {
 		const auto deleter = IOPointer(value->pb);
@@ -155,8 +255,9 @@ void FormatDeleter::operator()(AVFormatContext *value) {
 	}
 }
 
-CodecPointer MakeCodecPointer(not_null<AVStream*> stream) {
+CodecPointer MakeCodecPointer(CodecDescriptor descriptor) {
 	auto error = AvErrorWrap();
+	const auto stream = descriptor.stream;
 
 	auto result = CodecPointer(avcodec_alloc_context3(nullptr));
 	const auto context = result.get();
@@ -183,7 +284,11 @@ CodecPointer MakeCodecPointer(not_null<AVStream*> stream) {
 	if (!codec) {
 		LogError(qstr("avcodec_find_decoder"), context->codec_id);
 		return {};
-	} else if ((error = avcodec_open2(context, codec, nullptr))) {
+	}
+	if (descriptor.hwAllowed) {
+		InitHardwareDecoding(context, codec);
+	}
+	if ((error = avcodec_open2(context, codec, nullptr))) {
 		LogError(qstr("avcodec_open2"), error);
 		return {};
 	}
@@ -214,6 +319,15 @@ void FrameDeleter::operator()(AVFrame *value) {
 	av_frame_free(&value);
 }
 
+BufferPoolPointer MakeBufferPoolPointer(int size) {
+	return BufferPoolPointer(av_buffer_pool_init(size, nullptr));
+}
+
+void BufferPoolDeleter::operator()(AVBufferPool *value) {
+	// The pool is freed when all the buffers are returned to it.
+	av_buffer_pool_uninit(&value);
+}
+
 SwscalePointer MakeSwscalePointer(
 		QSize srcSize,
 		int srcFormat,
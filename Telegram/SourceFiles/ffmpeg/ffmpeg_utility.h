@@ -121,11 +121,21 @@ using FormatPointer = std::unique_ptr<AVFormatContext, FormatDeleter>;
 	int(*write)(void *opaque, uint8_t *buffer, int bufferSize),
 	int64_t(*seek)(void *opaque, int64_t offset, int whence));
 
+// Callbacks for MakeIOPointer / MakeFormatPointer with a QIODevice opaque.
+int ReadIODevice(void *opaque, uint8_t *buffer, int bufferSize);
+int WriteIODevice(void *opaque, uint8_t *buffer, int bufferSize);
+int64_t SeekIODevice(void *opaque, int64_t offset, int whence);
+
 struct CodecDeleter {
 	void operator()(AVCodecContext *value);
 };
 using CodecPointer = std::unique_ptr<AVCodecContext, CodecDeleter>;
-[[nodiscard]] CodecPointer MakeCodecPointer(not_null<AVStream*> stream);
+
+struct CodecDescriptor {
+	not_null<AVStream*> stream;
+	bool hwAllowed = false;
+};
+[[nodiscard]] CodecPointer MakeCodecPointer(CodecDescriptor descriptor);
 
 struct FrameDeleter {
 	void operator()(AVFrame *value);
@@ -135,6 +145,12 @@ using FramePointer = std::unique_ptr<AVFrame, FrameDeleter>;
 [[nodiscard]] bool FrameHasData(AVFrame *frame);
 void ClearFrameMemory(AVFrame *frame);
 
+struct BufferPoolDeleter {
+	void operator()(AVBufferPool *value);
+};
+using BufferPoolPointer = std::unique_ptr<AVBufferPool, BufferPoolDeleter>;
+[[nodiscard]] BufferPoolPointer MakeBufferPoolPointer(int size);
+
 struct SwscaleDeleter {
 	QSize srcSize;
 	int srcFormat = int(AV_PIX_FMT_NONE);
@@ -70,9 +70,106 @@ namespace {
 constexpr auto kMaxChannelAdmins = 200;
 constexpr auto kScrollDateHideTimeout = 1000;
 constexpr auto kEventsFirstPage = 20;
-constexpr auto kEventsPerPage = 50;
+constexpr auto kEventsPerPage = 100;
 constexpr auto kClearUserpicsAfter = 50;
 
+using FilterFlag = FilterValue::Flag;
+using FilterFlags = FilterValue::Flags;
+
+[[nodiscard]] FilterFlags AllFilterFlags() {
+	return FilterFlags::from_raw((uint32(FilterFlag::MAX_FIELD) << 1) - 1);
+}
+
+[[nodiscard]] FilterFlags ResolvedFlags(const FilterValue &filter) {
+	return filter.flags ? filter.flags : AllFilterFlags();
+}
+
+// Filters the server may list the event under, all of them if not sure.
+[[nodiscard]] FilterFlags EventFilterFlags(
+		const MTPChannelAdminLogEventAction &action) {
+	switch (action.type()) {
+	case mtpc_channelAdminLogEventActionParticipantJoin:
+		return FilterFlag::Join;
+	case mtpc_channelAdminLogEventActionParticipantLeave:
+		return FilterFlag::Leave;
+	case mtpc_channelAdminLogEventActionParticipantInvite:
+		return FilterFlag::Invite;
+	case mtpc_channelAdminLogEventActionParticipantToggleBan:
+		return FilterFlag::Ban
+			| FilterFlag::Unban
+			| FilterFlag::Kick
+			| FilterFlag::Unkick;
+	case mtpc_channelAdminLogEventActionParticipantToggleAdmin:
+		return FilterFlag::Promote | FilterFlag::Demote;
+	case mtpc_channelAdminLogEventActionChangeTitle:
+	case mtpc_channelAdminLogEventActionChangeAbout:
+	case mtpc_channelAdminLogEventActionChangeUsername:
+	case mtpc_channelAdminLogEventActionChangePhoto:
+		return FilterFlag::Info;
+	case mtpc_channelAdminLogEventActionToggleInvites:
+	case mtpc_channelAdminLogEventActionToggleSignatures:
+	case mtpc_channelAdminLogEventActionTogglePreHistoryHidden:
+	case mtpc_channelAdminLogEventActionDefaultBannedRights:
+	case mtpc_channelAdminLogEventActionToggleSlowMode:
+		return FilterFlag::Settings;
+	case mtpc_channelAdminLogEventActionUpdatePinned:
+		return FilterFlag::Pinned;
+	case mtpc_channelAdminLogEventActionEditMessage:
+		return FilterFlag::Edit;
+	case mtpc_channelAdminLogEventActionDeleteMessage:
+		return FilterFlag::Delete;
+	case mtpc_channelAdminLogEventActionStartGroupCall:
+	case mtpc_channelAdminLogEventActionDiscardGroupCall:
+	case mtpc_channelAdminLogEventActionParticipantMute:
+	case mtpc_channelAdminLogEventActionParticipantUnmute:
+	case mtpc_channelAdminLogEventActionParticipantVolume:
+	case mtpc_channelAdminLogEventActionToggleGroupCallSetting:
+		return FilterFlag::GroupCall;
+	case mtpc_channelAdminLogEventActionExportedInviteDelete:
+	case mtpc_channelAdminLogEventActionExportedInviteRevoke:
+	case mtpc_channelAdminLogEventActionExportedInviteEdit:
+		return FilterFlag::Invites;
+	}
+	return AllFilterFlags();
+}
+
+// Whether all events matching "narrow" are also matching "wide".
+[[nodiscard]] bool IsNarrowerFilter(
+		const FilterValue &narrow,
+		const FilterValue &wide) {
+	if (ResolvedFlags(narrow) & ~ResolvedFlags(wide)) {
+		return false;
+	} else if (wide.allUsers) {
+		return true;
+	}
+	return !narrow.allUsers && ranges::all_of(narrow.admins, [&](
+			not_null<UserData*> admin) {
+		return ranges::contains(wide.admins, admin);
+	});
+}
+
+[[nodiscard]] std::optional<bool> EventMatchesFilter(
+		const MTPDchannelAdminLogEvent &event,
+		const FilterValue &filter) {
+	if (!filter.allUsers) {
+		const auto userId = UserId(event.vuser_id().v);
+		const auto admin = [&](not_null<UserData*> user) {
+			return (peerToUser(user->id) == userId);
+		};
+		if (!ranges::any_of(filter.admins, admin)) {
+			return false;
+		}
+	}
+	const auto possible = EventFilterFlags(event.vaction());
+	const auto flags = ResolvedFlags(filter);
+	if (!(possible & ~flags)) {
+		return true;
+	} else if (!(possible & flags)) {
+		return false;
+	}
+	return std::nullopt;
+}
+
 } // namespace
 
 template <InnerWidget::EnumItemsDirection direction, typename Method>
@@ -432,7 +529,9 @@ void InnerWidget::checkPreloadMore() {
 void InnerWidget::applyFilter(FilterValue &&value) {
 	if (_filter != value) {
 		_filter = value;
-		clearAndRequestLog();
+		if (!refilterLoadedEvents()) {
+			clearAndRequestLog();
+		}
 	}
 }
 
@@ -497,6 +596,11 @@ void InnerWidget::showFilter(Fn<void(FilterValue &&filter)> callback) {
 void InnerWidget::clearAndRequestLog() {
 	_api.request(base::take(_preloadUpRequestId)).cancel();
 	_api.request(base::take(_preloadDownRequestId)).cancel();
+
+	// The loaded events don't match the new filter or search query,
+	// they are remembered again when the first page comes.
+	_loadedEvents.clear();
+	_loadedEventsFilter = std::nullopt;
 	_filterChanged = true;
 	_upLoaded = false;
 	_downLoaded = true;
@@ -504,6 +608,50 @@ void InnerWidget::clearAndRequestLog() {
 	preloadMore(Direction::Up);
 }
 
+bool InnerWidget::refilterLoadedEvents() {
+	if (!_loadedEventsFilter
+		|| !IsNarrowerFilter(_filter, *_loadedEventsFilter)) {
+		return false;
+	}
+	auto filtered = QVector<MTPChannelAdminLogEvent>();
+	filtered.reserve(_loadedEvents.size());
+	for (const auto &event : _loadedEvents) {
+		const auto matches = EventMatchesFilter(
+			event.c_channelAdminLogEvent(),
+			_filter);
+		if (!matches) {
+			return false;
+		} else if (*matches) {
+			filtered.push_back(event);
+		}
+	}
+
+	// All loaded events matching the new filter are here already.
+	_api.request(base::take(_preloadUpRequestId)).cancel();
+	_api.request(base::take(_preloadDownRequestId)).cancel();
+	_loadedEventsFilter = _filter;
+	clearAfterFilterChange();
+	if (!filtered.isEmpty()) {
+		addEvents(Direction::Up, filtered);
+	}
+	return true;
+}
+
+void InnerWidget::rememberEvents(
+		Direction direction,
+		const QVector<MTPChannelAdminLogEvent> &events) {
+	if (_filterChanged || (_items.empty() && _loadedEvents.empty())) {
+		_loadedEvents.clear();
+		_loadedEventsFilter = _filter;
+	} else if (!_loadedEventsFilter) {
+		return;
+	}
+	const auto where = (direction == Direction::Up)
+		? end(_loadedEvents)
+		: begin(_loadedEvents);
+	_loadedEvents.insert(where, events.begin(), events.end());
+}
+
 void InnerWidget::updateEmptyText() {
 	auto options = _defaultOptions;
 	options.flags |= TextParseMarkdown;
@@ -778,6 +926,7 @@ void InnerWidget::preloadMore(Direction direction) {
 		_channel->owner().processUsers(results.vusers());
 		_channel->owner().processChats(results.vchats());
 		if (!loadedFlag) {
+			rememberEvents(direction, results.vevents().v);
 			addEvents(direction, results.vevents().v);
 		}
 	}).fail([this, &requestId, &loadedFlag] {
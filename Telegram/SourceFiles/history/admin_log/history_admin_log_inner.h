@@ -225,6 +225,10 @@ private:
 	void paintEmpty(Painter &p, not_null<const Ui::ChatStyle*> st);
 	void clearAfterFilterChange();
 	void clearAndRequestLog();
+	[[nodiscard]] bool refilterLoadedEvents();
+	void rememberEvents(
+		Direction direction,
+		const QVector<MTPChannelAdminLogEvent> &events);
 	void addEvents(Direction direction, const QVector<MTPChannelAdminLogEvent> &events);
 	Element *viewForItem(const HistoryItem *item);
 
@@ -327,6 +331,10 @@ private:
 
 	FilterValue _filter;
 	QString _searchQuery;
+
+	// Raw events loaded for the current items, used to narrow the filter.
+	std::vector<MTPChannelAdminLogEvent> _loadedEvents;
+	std::optional<FilterValue> _loadedEventsFilter;
 	std::vector<not_null<UserData*>> _admins;
 	std::vector<not_null<UserData*>> _adminsCanEdit;
 	Fn<void(FilterValue &&filter)> _showFilterCallback;
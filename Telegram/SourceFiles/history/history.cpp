@@ -31,6 +31,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_user.h"
 #include "data/data_document.h"
 #include "data/data_histories.h"
+#include "data/data_history_tags_index.h"
 #include "lang/lang_keys.h"
 #include "apiwrap.h"
 #include "api/api_chat_participants.h"
@@ -60,6 +61,9 @@ namespace {
 
 constexpr auto kNewBlockEachMessage = 50;
 constexpr auto kSkipCloudDraftsFor = TimeId(2);
+constexpr auto kLazyResizeMinItems = 300;
+constexpr auto kLazyResizeAround = 100;
+constexpr auto kLazyResizeStep = 200;
 
 using UpdateFlag = Data::HistoryUpdate::Flag;
 
@@ -386,6 +390,7 @@ std::vector<not_null<HistoryItem*>> History::createItems(
 	result.reserve(data.size());
 	const auto localFlags = MessageFlags();
 	const auto detachExistingItem = true;
+	owner().suspendUpdates();
 	for (auto i = data.cend(), e = data.cbegin(); i != e;) {
 		const auto &data = *--i;
 		result.emplace_back(createItem(
@@ -394,6 +399,7 @@ std::vector<not_null<HistoryItem*>> History::createItems(
 			localFlags,
 			detachExistingItem));
 	}
+	owner().resumeUpdates();
 	return result;
 }
 
@@ -455,6 +461,9 @@ void History::destroyMessage(not_null<HistoryItem*> item) {
 
 	owner().unregisterMessage(item);
 	Core::App().notifications().clearFromItem(item);
+	if (_tagsIndex) {
+		_tagsIndex->remove(item);
+	}
 
 	auto hack = std::unique_ptr<HistoryItem>(item.get());
 	const auto i = _messages.find(hack);
@@ -468,6 +477,13 @@ void History::destroyMessage(not_null<HistoryItem*> item) {
 	}
 }
 
+Data::HistoryTagsIndex &History::tagsIndex() {
+	if (!_tagsIndex) {
+		_tagsIndex = std::make_unique<Data::HistoryTagsIndex>();
+	}
+	return *_tagsIndex;
+}
+
 void History::destroyMessagesByDates(TimeId minDate, TimeId maxDate) {
 	auto toDestroy = std::vector<not_null<HistoryItem*>>();
 	for (const auto &message : _messages) {
@@ -2824,20 +2840,82 @@ HistoryItem *History::lastEditableMessage() const {
 }
 
 void History::resizeToWidth(int newWidth) {
-	const auto resizeAllItems = (_width != newWidth);
+	const auto widthChanged = (_width != newWidth);
 
-	if (!resizeAllItems && !hasPendingResizedItems()) {
+	if (!widthChanged && !hasPendingResizedItems()) {
 		return;
 	}
 	_flags &= ~(Flag::f_has_pending_resized_items);
 
+	// Zero width means the first layout or forceFullResize().
+	const auto resizeAllItems = !_width;
+	if (resizeAllItems) {
+		_lazyResizeAround = 0;
+	} else if (widthChanged) {
+		auto count = 0;
+		for (const auto &block : blocks) {
+			count += int(block->messages.size());
+		}
+		_lazyResizeAround = (count > kLazyResizeMinItems)
+			? kLazyResizeAround
+			: 0;
+	}
 	_width = newWidth;
-	int y = 0;
+	relayoutBlocks(resizeAllItems);
+}
+
+bool History::hasLazyResizedItems() const {
+	return (_lazyResizeLeft > 0);
+}
+
+bool History::resizeLazyItems() {
+	if (!hasLazyResizedItems()) {
+		return false;
+	}
+	_lazyResizeAround += kLazyResizeStep;
+	relayoutBlocks(false);
+	return true;
+}
+
+int History::lazyResizeAnchorIndex() const {
+	auto result = 0;
+	for (const auto &block : blocks) {
+		if (scrollTopItem && scrollTopItem->block() == block.get()) {
+			return result + scrollTopItem->indexInBlock();
+		}
+		result += int(block->messages.size());
+	}
+
+	// No scrollTopItem means we're at the bottom.
+	return result;
+}
+
+void History::relayoutBlocks(bool resizeAllItems) {
+	const auto anchor = _lazyResizeAround ? lazyResizeAnchorIndex() : 0;
+	auto index = 0;
+	auto y = 0;
+	_lazyResizeLeft = 0;
 	for (const auto &block : blocks) {
+		const auto count = int(block->messages.size());
+		const auto staleFrom = _lazyResizeAround
+			? std::clamp(anchor - _lazyResizeAround - index, 0, count)
+			: 0;
+		const auto staleTill = _lazyResizeAround
+			? std::clamp(anchor + _lazyResizeAround + 1 - index, 0, count)
+			: count;
 		block->setY(y);
-		y += block->resizeGetHeight(newWidth, resizeAllItems);
+		y += block->resizeGetHeight(
+			_width,
+			resizeAllItems,
+			staleFrom,
+			staleTill,
+			_lazyResizeLeft);
+		index += count;
 	}
 	_height = y;
+	if (!_lazyResizeLeft) {
+		_lazyResizeAround = 0;
+	}
 }
 
 void History::forceFullResize() {
@@ -3066,6 +3144,42 @@ auto History::findLastNonEmpty() const -> Element* {
 	return nullptr;
 }
 
+std::optional<MsgId> History::loadedMessageAtDate(TimeId date) const {
+	if (blocks.empty()) {
+		return std::nullopt;
+	}
+	const auto dateOf = [](const std::unique_ptr<Element> &view) {
+		return view->data()->date();
+	};
+	if (!loadedAtTop() && dateOf(blocks.front()->messages.front()) >= date) {
+		return std::nullopt;
+	}
+
+	// Blocks and messages in them are ordered by date already.
+	const auto from = ranges::partition_point(blocks, [&](
+			const std::unique_ptr<HistoryBlock> &block) {
+		return dateOf(block->messages.back()) < date;
+	});
+	for (auto i = from; i != end(blocks); ++i) {
+		const auto &messages = (*i)->messages;
+		const auto first = (i == from)
+			? ranges::partition_point(messages, [&](
+					const std::unique_ptr<Element> &view) {
+				return dateOf(view) < date;
+			})
+			: begin(messages);
+		for (auto j = first; j != end(messages); ++j) {
+			const auto item = (*j)->data();
+			if (item->isRegular()) {
+				return item->id;
+			}
+		}
+	}
+	return loadedAtBottom()
+		? std::make_optional(ShowAtUnreadMsgId)
+		: std::nullopt;
+}
+
 auto History::findLastDisplayed() const -> Element* {
 	for (const auto &block : ranges::views::reverse(blocks)) {
 		for (const auto &element : ranges::views::reverse(block->messages)) {
@@ -3301,13 +3415,26 @@ HistoryBlock::HistoryBlock(not_null<History*> history)
 : _history(history) {
 }
 
-int HistoryBlock::resizeGetHeight(int newWidth, bool resizeAllItems) {
+int HistoryBlock::resizeGetHeight(
+		int newWidth,
+		bool resizeAllItems,
+		int staleFrom,
+		int staleTill,
+		int &staleLeft) {
 	auto y = 0;
-	for (const auto &message : messages) {
+	for (auto i = 0, count = int(messages.size()); i != count; ++i) {
+		const auto &message = messages[i];
 		message->setY(y);
-		if (resizeAllItems || message->pendingResize()) {
+		const auto stale = (message->width() != newWidth);
+		const auto laidOut = (message->width() > 0);
+		if (resizeAllItems
+			|| message->pendingResize()
+			|| (stale && (!laidOut || (i >= staleFrom && i < staleTill)))) {
 			y += message->resizeGetHeight(newWidth);
 		} else {
+			if (stale) {
+				++staleLeft;
+			}
 			y += message->height();
 		}
 	}
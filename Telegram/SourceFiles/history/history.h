@@ -35,6 +35,7 @@ struct Draft;
 class Session;
 class Folder;
 class ChatFilter;
+class HistoryTagsIndex;
 struct SponsoredFrom;
 
 enum class ForwardOptions {
@@ -106,6 +107,11 @@ public:
 	Element *findFirstDisplayed() const;
 	Element *findLastNonEmpty() const;
 	Element *findLastDisplayed() const;
+
+	// First regular message sent at date or later if the loaded range is
+	// enough to tell, ShowAtUnreadMsgId if there are none after the date.
+	[[nodiscard]] std::optional<MsgId> loadedMessageAtDate(
+		TimeId date) const;
 	bool hasOrphanMediaGroupPart() const;
 	bool removeOrphanMediaGroupPart();
 	[[nodiscard]] std::vector<MsgId> collectMessagesFromParticipantToDelete(
@@ -139,6 +145,7 @@ public:
 					std::forward<Args>(args)...)).get());
 	}
 	void destroyMessage(not_null<HistoryItem*> item);
+	[[nodiscard]] Data::HistoryTagsIndex &tagsIndex();
 	void destroyMessagesByDates(TimeId minDate, TimeId maxDate);
 
 	void unpinAllMessages();
@@ -305,6 +312,12 @@ public:
 	void forceFullResize();
 	int height() const;
 
+	// After a width change in a large history only the items around
+	// scrollTopItem are resized, the others keep their old heights.
+	// resizeLazyItems() widens that window, returns false if all done.
+	[[nodiscard]] bool hasLazyResizedItems() const;
+	bool resizeLazyItems();
+
 	void itemRemoved(not_null<HistoryItem*> item);
 	void itemVanished(not_null<HistoryItem*> item);
 
@@ -596,12 +609,17 @@ private:
 	HistoryService *insertJoinedMessage();
 	void insertMessageToBlocks(not_null<HistoryItem*> item);
 
+	[[nodiscard]] int lazyResizeAnchorIndex() const;
+	void relayoutBlocks(bool resizeAllItems);
+
 	void setFolderPointer(Data::Folder *folder);
 
 	Flags _flags = 0;
 	bool _mute = false;
 	int _width = 0;
 	int _height = 0;
+	int _lazyResizeAround = 0;
+	int _lazyResizeLeft = 0;
 	Element *_unreadBarView = nullptr;
 	Element *_firstUnreadView = nullptr;
 	HistoryService *_joinedMessage = nullptr;
@@ -619,6 +637,7 @@ private:
 	std::optional<HistoryItem*> _lastServerMessage;
 	base::flat_set<not_null<HistoryItem*>> _clientSideMessages;
 	std::unordered_set<std::unique_ptr<HistoryItem>> _messages;
+	std::unique_ptr<Data::HistoryTagsIndex> _tagsIndex;
 
 	// This almost always is equal to _lastMessage. The only difference is
 	// for a group that migrated to a supergroup. Then _lastMessage can
@@ -668,7 +687,14 @@ public:
 	void remove(not_null<Element*> view);
 	void refreshView(not_null<Element*> view);
 
-	int resizeGetHeight(int newWidth, bool resizeAllItems);
+	// Items in [staleFrom, staleTill) are resized if their width differs,
+	// the other already laid out ones are only counted in staleLeft.
+	int resizeGetHeight(
+		int newWidth,
+		bool resizeAllItems,
+		int staleFrom,
+		int staleTill,
+		int &staleLeft);
 	int y() const {
 		return _y;
 	}
@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/file_utilities.h"
 #include "core/crash_reports.h"
 #include "core/click_handler_types.h"
+#include "core/paint_profiler.h"
 #include "history/history.h"
 #include "history/history_message.h"
 #include "history/view/media/history_view_media.h"
@@ -81,6 +82,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_changes.h"
 #include "data/stickers/data_stickers.h"
 #include "data/data_sponsored_messages.h"
+#include "data/data_auto_download_scheduler.h"
 #include "facades.h"
 #include "app.h"
 #include "styles/style_chat.h"
@@ -689,6 +691,7 @@ void HistoryInner::paintEvent(QPaintEvent *e) {
 		_userpicsCache.clear();
 	});
 
+	const auto profile = Core::PaintProfiler::Scope("History/List");
 	Painter p(this);
 	auto clip = e->rect();
 
@@ -769,7 +772,12 @@ void HistoryInner::paintEvent(QPaintEvent *e) {
 					view,
 					selfromy - mtop,
 					seltoy - mtop);
-				view->draw(p, context);
+				{
+					const auto profile = Core::PaintProfiler::Scope([&] {
+						return HistoryView::ElementPaintSection(view);
+					});
+					view->draw(p, context);
+				}
 
 				const auto height = view->height();
 				const auto middle = top + height / 2;
@@ -824,7 +832,12 @@ void HistoryInner::paintEvent(QPaintEvent *e) {
 						view,
 						selfromy - htop,
 						seltoy - htop);
-					view->draw(p, context);
+					{
+						const auto profile = Core::PaintProfiler::Scope([&] {
+							return HistoryView::ElementPaintSection(view);
+						});
+						view->draw(p, context);
+					}
 
 					const auto item = view->data();
 					const auto middle = top + height / 2;
@@ -2519,6 +2532,7 @@ void HistoryInner::visibleAreaUpdated(int top, int bottom) {
 	auto scrolledUp = (top < _visibleAreaTop);
 	_visibleAreaTop = top;
 	_visibleAreaBottom = bottom;
+	session().data().autoDownloadScheduler().scrolled(this, top);
 	const auto visibleAreaHeight = bottom - top;
 
 	// if history has pending resize events we should not update scrollTopItem
@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "lang/lang_keys.h"
 #include "mainwidget.h"
 #include "history/view/history_view_element.h"
+#include "history/history_object_pool.h"
 #include "history/view/history_view_item_preview.h"
 #include "history/view/history_view_service_message.h"
 #include "history/history_item_components.h"
@@ -33,6 +34,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mainwindow.h"
 #include "window/window_session_controller.h"
 #include "core/crash_reports.h"
+#include "core/memory_stats.h"
 #include "base/unixtime.h"
 #include "api/api_text_entities.h"
 #include "dialogs/ui/dialogs_message_view.h"
@@ -179,6 +181,14 @@ MediaCheckResult CheckMessageMedia(const MTPMessageMedia &media) {
 
 } // namespace
 
+void *HistoryItem::operator new(std::size_t size) {
+	return HistoryObjectPool::Allocate(size);
+}
+
+void HistoryItem::operator delete(void *memory, std::size_t size) {
+	HistoryObjectPool::Free(memory, size);
+}
+
 void HistoryItem::HistoryItem::Destroyer::operator()(HistoryItem *value) {
 	if (value) {
 		value->destroy();
@@ -196,6 +206,7 @@ HistoryItem::HistoryItem(
 , _from(from ? history->owner().peer(from) : history->peer)
 , _flags(FinalizeMessageFlags(flags))
 , _date(date) {
+	Core::MemoryStats::Add(Core::MemoryStats::Tag::HistoryItems);
 	if (isHistoryEntry() && IsClientMsgId(id)) {
 		_history->registerClientSideMessage(this);
 	}
@@ -971,6 +982,22 @@ void HistoryItem::applyTTL(const MTPDmessageService &data) {
 	}
 }
 
+int HistoryItem::textHeightForWidth(int width) {
+	const auto i = ranges::find(_textHeights, width, &TextHeight::width);
+	const auto found = (i != end(_textHeights));
+	const auto result = found ? i->height : textLayout().countHeight(width);
+
+	// Keep the most recently used width in front.
+	const auto till = found ? i : (end(_textHeights) - 1);
+	std::move_backward(begin(_textHeights), till, till + 1);
+	_textHeights.front() = { width, result };
+	return result;
+}
+
+void HistoryItem::invalidateTextHeights() {
+	_textHeights.fill(TextHeight());
+}
+
 void HistoryItem::applyTTL(TimeId destroyAt) {
 	const auto previousDestroyAt = std::exchange(_ttlDestroyAt, destroyAt);
 	if (previousDestroyAt) {
@@ -1069,8 +1096,16 @@ MessageGroupId HistoryItem::groupId() const {
 	return _groupId;
 }
 
+Ui::Text::String &HistoryItem::textLayout() const {
+	const auto that = const_cast<HistoryItem*>(this);
+	if (_textPending) {
+		that->layoutPendingText();
+	}
+	return that->_text;
+}
+
 bool HistoryItem::isEmpty() const {
-	return _text.isEmpty()
+	return emptyText()
 		&& !_media
 		&& !Has<HistoryMessageLogEntryOriginal>();
 }
@@ -1081,7 +1116,7 @@ QString HistoryItem::notificationText() const {
 			return _media->notificationText();
 		} else if (!emptyText()) {
 			return TextUtilities::TextWithSpoilerCommands(
-				_text.toTextWithEntities());
+				textLayout().toTextWithEntities());
 		}
 		return QString();
 	}();
@@ -1102,9 +1137,9 @@ ItemPreview HistoryItem::toPreview(ToPreviewOptions options) const {
 			return {
 				.text = TextUtilities::Clean(
 					options.ignoreSpoilers
-						? _text.toString()
+						? textLayout().toString()
 						: TextUtilities::TextWithSpoilerCommands(
-							_text.toTextWithEntities()),
+							textLayout().toTextWithEntities()),
 					!options.ignoreSpoilers),
 			};
 		}
@@ -1163,6 +1198,7 @@ Ui::Text::IsolatedEmoji HistoryItem::isolatedEmoji() const {
 
 HistoryItem::~HistoryItem() {
 	applyTTL(0);
+	Core::MemoryStats::Remove(Core::MemoryStats::Tag::HistoryItems);
 }
 
 QDateTime ItemDateTime(not_null<const HistoryItem*> item) {
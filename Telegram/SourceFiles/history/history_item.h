@@ -73,6 +73,9 @@ class History;
 
 class HistoryItem : public RuntimeComposer<HistoryItem> {
 public:
+	[[nodiscard]] static void *operator new(std::size_t size);
+	static void operator delete(void *memory, std::size_t size);
+
 	static not_null<HistoryItem*> Create(
 		not_null<History*> history,
 		MsgId id,
@@ -337,7 +340,7 @@ public:
 	}
 
 	[[nodiscard]] bool emptyText() const {
-		return _text.isEmpty();
+		return !_textPending && _text.isEmpty();
 	}
 
 	[[nodiscard]] bool canPin() const;
@@ -452,9 +455,25 @@ protected:
 	void applyTTL(const MTPDmessageService &data);
 	void applyTTL(TimeId destroyAt);
 
+	// Heights of _text are cached for the last few layout widths,
+	// so that a window resizing back and forth doesn't relayout it.
+	[[nodiscard]] int textHeightForWidth(int width);
+	void invalidateTextHeights();
+
+	// Received texts are laid out on the first access,
+	// because most of them are never shown, see _textPending.
+	[[nodiscard]] Ui::Text::String &textLayout() const;
+	virtual void layoutPendingText() {
+	}
+
 	Ui::Text::String _text = { st::msgMinWidth };
-	int _textWidth = -1;
-	int _textHeight = 0;
+	std::unique_ptr<TextWithEntities> _pendingText;
+	bool _textPending = false;
+	struct TextHeight {
+		int width = -1;
+		int height = 0;
+	};
+	std::array<TextHeight, 3> _textHeights;
 
 	struct SavedMediaData {
 		TextWithEntities text;
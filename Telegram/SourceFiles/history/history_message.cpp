@@ -47,6 +47,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_channel.h"
 #include "data/data_user.h"
 #include "data/data_histories.h"
+#include "data/data_history_tags_index.h"
 #include "data/data_web_page.h"
 #include "data/data_sponsored_messages.h"
 #include "styles/style_dialogs.h"
@@ -59,6 +60,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace {
 
+// Shorter texts are laid out right away, they may be isolated emoji.
+constexpr auto kLazyTextMinLength = 64;
+
 [[nodiscard]] MessageFlags NewForwardedFlags(
 		not_null<PeerData*> peer,
 		PeerId from,
@@ -506,12 +510,17 @@ HistoryMessage::HistoryMessage(
 	if (const auto media = data.vmedia()) {
 		setMedia(*media);
 	}
-	const auto textWithEntities = TextWithEntities{
-		TextUtilities::Clean(qs(data.vmessage())),
-		Api::EntitiesFromMTP(
-			&history->session(),
-			data.ventities().value_or_empty())
-	};
+	auto prepared = history->owner().takePreparedMessageText(
+		history->peer->id,
+		id);
+	const auto textWithEntities = prepared
+		? std::move(*prepared)
+		: TextWithEntities{
+			TextUtilities::Clean(qs(data.vmessage())),
+			Api::EntitiesFromMTP(
+				&history->session(),
+				data.ventities().value_or_empty())
+		};
 	setText(_media ? textWithEntities : EnsureNonEmpty(textWithEntities));
 	if (const auto groupedId = data.vgrouped_id()) {
 		setGroupId(
@@ -1041,7 +1050,9 @@ void HistoryMessage::setCommentsItemId(FullMsgId id) {
 }
 
 void HistoryMessage::hideSpoilers() {
-	HistoryView::HideSpoilers(_text);
+	if (!_textPending) {
+		HistoryView::HideSpoilers(_text);
+	}
 }
 
 bool HistoryMessage::updateDependencyItem() {
@@ -1644,6 +1655,7 @@ TextWithEntities HistoryMessage::withLocalEntities(
 }
 
 void HistoryMessage::setText(const TextWithEntities &textWithEntities) {
+	history()->tagsIndex().add(this, textWithEntities);
 	for (const auto &entity : textWithEntities.entities) {
 		auto type = entity.type();
 		if (type == EntityType::Url
@@ -1660,6 +1672,25 @@ void HistoryMessage::setText(const TextWithEntities &textWithEntities) {
 	}
 
 	clearIsolatedEmoji();
+	if (textWithEntities.text.size() >= kLazyTextMinLength) {
+		_pendingText = std::make_unique<TextWithEntities>(textWithEntities);
+		_textPending = true;
+		invalidateTextHeights();
+		return;
+	}
+	_pendingText = nullptr;
+	_textPending = false;
+	applyText(textWithEntities);
+}
+
+void HistoryMessage::layoutPendingText() {
+	_textPending = false;
+	if (const auto pending = base::take(_pendingText)) {
+		applyText(*pending);
+	}
+}
+
+void HistoryMessage::applyText(const TextWithEntities &textWithEntities) {
 	const auto context = Core::MarkedTextContext{
 		.session = &history()->session()
 	};
@@ -1680,8 +1711,7 @@ void HistoryMessage::setText(const TextWithEntities &textWithEntities) {
 		checkIsolatedEmoji();
 	}
 
-	_textWidth = -1;
-	_textHeight = 0;
+	invalidateTextHeights();
 }
 
 void HistoryMessage::reapplyText() {
@@ -1691,13 +1721,14 @@ void HistoryMessage::reapplyText() {
 
 void HistoryMessage::setEmptyText() {
 	clearIsolatedEmoji();
+	_pendingText = nullptr;
+	_textPending = false;
 	_text.setMarkedText(
 		st::messageTextStyle,
 		{ QString(), EntitiesInText() },
 		Ui::ItemTextOptions(this));
 
-	_textWidth = -1;
-	_textHeight = 0;
+	invalidateTextHeights();
 }
 
 void HistoryMessage::clearIsolatedEmoji() {
@@ -1760,14 +1791,14 @@ void HistoryMessage::setReplyMarkup(HistoryMessageMarkupData &&markup) {
 }
 
 Ui::Text::IsolatedEmoji HistoryMessage::isolatedEmoji() const {
-	return _text.toIsolatedEmoji();
+	return textLayout().toIsolatedEmoji();
 }
 
 TextWithEntities HistoryMessage::originalText() const {
 	if (emptyText()) {
 		return { QString(), EntitiesInText() };
 	}
-	return _text.toTextWithEntities();
+	return textLayout().toTextWithEntities();
 }
 
 TextWithEntities HistoryMessage::originalTextWithLocalEntities() const {
@@ -1778,11 +1809,11 @@ TextForMimeData HistoryMessage::clipboardText() const {
 	if (emptyText()) {
 		return TextForMimeData();
 	}
-	return _text.toTextForMimeData();
+	return textLayout().toTextForMimeData();
 }
 
 bool HistoryMessage::textHasLinks() const {
-	return emptyText() ? false : _text.hasLinks();
+	return emptyText() ? false : textLayout().hasLinks();
 }
 
 bool HistoryMessage::changeViewsCount(int count) {
@@ -227,6 +227,8 @@ public:
 	~HistoryMessage();
 
 private:
+	void layoutPendingText() override;
+	void applyText(const TextWithEntities &textWithEntities);
 	void setEmptyText();
 	[[nodiscard]] bool isTooOldForEdit(TimeId now) const;
 	[[nodiscard]] bool isLegacyMessage() const {
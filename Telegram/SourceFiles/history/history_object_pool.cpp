@@ -0,0 +1,147 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "history/history_object_pool.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QThread>
+
+namespace HistoryObjectPool {
+namespace {
+
+constexpr auto kSlotAlignment = std::size_t(16);
+constexpr auto kMaxSlotSize = std::size_t(1024);
+constexpr auto kSlotsInChunk = std::size_t(64);
+constexpr auto kBucketsCount = kMaxSlotSize / kSlotAlignment;
+
+struct FreeSlot {
+	FreeSlot *next = nullptr;
+};
+
+struct Chunk {
+	std::unique_ptr<char[]> data;
+	FreeSlot *free = nullptr;
+	std::size_t used = 0;
+};
+
+struct Bucket {
+	// Chunks by the address of their data, to find the chunk of a slot.
+	base::flat_map<const char*, std::unique_ptr<Chunk>> chunks;
+
+	// Chunks with free slots, the last one is allocated from first.
+	std::vector<not_null<Chunk*>> available;
+
+	// A single empty chunk is kept, so that an object created and
+	// destroyed over and over doesn't allocate and free a chunk each time.
+	Chunk *spare = nullptr;
+};
+
+[[nodiscard]] std::size_t BucketIndex(std::size_t size) {
+	return (size + kSlotAlignment - 1) / kSlotAlignment - 1;
+}
+
+[[nodiscard]] Bucket &BucketBySize(std::size_t size) {
+	static auto Buckets = std::array<Bucket, kBucketsCount>();
+	return Buckets[BucketIndex(size)];
+}
+
+[[nodiscard]] std::size_t SlotSize(std::size_t size) {
+	return (BucketIndex(size) + 1) * kSlotAlignment;
+}
+
+void AddChunk(Bucket &bucket, std::size_t slotSize) {
+	auto chunk = std::make_unique<Chunk>();
+	chunk->data = std::make_unique<char[]>(slotSize * kSlotsInChunk);
+	for (auto i = kSlotsInChunk; i != 0;) {
+		const auto slot = reinterpret_cast<FreeSlot*>(
+			chunk->data.get() + (--i) * slotSize);
+		slot->next = chunk->free;
+		chunk->free = slot;
+	}
+	bucket.available.push_back(chunk.get());
+	bucket.chunks.emplace(chunk->data.get(), std::move(chunk));
+}
+
+[[nodiscard]] not_null<Chunk*> ChunkBySlot(
+		const Bucket &bucket,
+		const void *slot) {
+	const auto address = static_cast<const char*>(slot);
+	const auto i = bucket.chunks.upper_bound(address);
+	Assert(i != begin(bucket.chunks));
+	return std::prev(i)->second.get();
+}
+
+void RemoveChunk(Bucket &bucket, not_null<Chunk*> chunk) {
+	const auto i = ranges::find(bucket.available, chunk);
+	Assert(i != end(bucket.available));
+	bucket.available.erase(i);
+	bucket.chunks.erase(bucket.chunks.find(chunk->data.get()));
+}
+
+[[nodiscard]] bool IsMainThread() {
+	// Objects could be destroyed after the application object is gone.
+	const auto application = QCoreApplication::instance();
+	return !application
+		|| (QThread::currentThread() == application->thread());
+}
+
+} // namespace
+
+void *Allocate(std::size_t size) {
+	if (!size || size > kMaxSlotSize) {
+		return ::operator new(size);
+	}
+
+	// The buckets are not guarded, see the header.
+	Expects(IsMainThread());
+
+	auto &bucket = BucketBySize(size);
+	if (bucket.available.empty()) {
+		AddChunk(bucket, SlotSize(size));
+	}
+	const auto chunk = bucket.available.back();
+	const auto result = chunk->free;
+	chunk->free = result->next;
+	if (!chunk->used++) {
+		if (bucket.spare == chunk) {
+			bucket.spare = nullptr;
+		}
+	}
+	if (!chunk->free) {
+		bucket.available.pop_back();
+	}
+	return result;
+}
+
+void Free(void *memory, std::size_t size) {
+	if (!memory) {
+		return;
+	} else if (!size || size > kMaxSlotSize) {
+		::operator delete(memory);
+		return;
+	}
+	Expects(IsMainThread());
+
+	auto &bucket = BucketBySize(size);
+	const auto chunk = ChunkBySlot(bucket, memory);
+	Assert(chunk->used > 0);
+	if (!chunk->free) {
+		bucket.available.push_back(chunk);
+	}
+	const auto slot = static_cast<FreeSlot*>(memory);
+	slot->next = chunk->free;
+	chunk->free = slot;
+	if (--chunk->used) {
+		return;
+	} else if (!bucket.spare) {
+		bucket.spare = chunk;
+	} else {
+		RemoveChunk(bucket, chunk);
+	}
+}
+
+} // namespace HistoryObjectPool
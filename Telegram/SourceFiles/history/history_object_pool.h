@@ -0,0 +1,18 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace HistoryObjectPool {
+
+// Main thread only, the buckets are not guarded. Small objects are taken
+// from chunks of same sized slots. A chunk is released when all its
+// slots are free, except for a single spare chunk of each size.
+[[nodiscard]] void *Allocate(std::size_t size);
+void Free(void *memory, std::size_t size);
+
+} // namespace HistoryObjectPool
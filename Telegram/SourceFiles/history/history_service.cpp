@@ -114,6 +114,12 @@ QString GenerateServiceTime(TimeId date) {
 
 void HistoryService::setMessageByAction(const MTPmessageAction &action) {
 	setNeedTime(true);
+	const auto compact = compactTextFor(action);
+	if (compact != CompactText::None) {
+		setCompactText(compact);
+		applyAction(action);
+		return;
+	}
 	auto prepareChatAddUserText = [this](const MTPDmessageActionChatAddUser &action) {
 		auto result = PreparedText{};
 		auto &users = action.vusers().v;
@@ -150,13 +156,6 @@ void HistoryService::setMessageByAction(const MTPmessageAction &action) {
 		return result;
 	};
 
-	auto prepareChatJoinedByLink = [this](const MTPDmessageActionChatJoinedByLink &action) {
-		auto result = PreparedText{};
-		result.links.push_back(fromLink());
-		result.text = tr::lng_action_user_joined_by_link(tr::now, lt_from, fromLinkText());
-		return result;
-	};
-
 	auto prepareChatCreate = [this](const MTPDmessageActionChatCreate &action) {
 		auto result = PreparedText{};
 		result.links.push_back(fromLink());
@@ -466,18 +465,11 @@ void HistoryService::setMessageByAction(const MTPmessageAction &action) {
 		return result;
 	};
 
-	auto prepareChatJoinedByRequest = [this](const MTPDmessageActionChatJoinedByRequest &action) {
-		auto result = PreparedText{};
-		result.links.push_back(fromLink());
-		result.text = tr::lng_action_user_joined_by_request(tr::now, lt_from, fromLinkText());
-		return result;
-	};
-
 	const auto messageText = action.match([&](
 		const MTPDmessageActionChatAddUser &data) {
 		return prepareChatAddUserText(data);
-	}, [&](const MTPDmessageActionChatJoinedByLink &data) {
-		return prepareChatJoinedByLink(data);
+	}, [](const MTPDmessageActionChatJoinedByLink &) -> PreparedText {
+		Unexpected("JoinedByLink type in HistoryService, it is compact.");
 	}, [&](const MTPDmessageActionChatCreate &data) {
 		return prepareChatCreate(data);
 	}, [](const MTPDmessageActionChatMigrateTo &) {
@@ -532,8 +524,8 @@ void HistoryService::setMessageByAction(const MTPmessageAction &action) {
 		return prepareCallScheduledText(data.vschedule_date().v);
 	}, [&](const MTPDmessageActionSetChatTheme &data) {
 		return prepareSetChatTheme(data);
-	}, [&](const MTPDmessageActionChatJoinedByRequest &data) {
-		return prepareChatJoinedByRequest(data);
+	}, [](const MTPDmessageActionChatJoinedByRequest &) -> PreparedText {
+		Unexpected("JoinedByRequest type in HistoryService, it is compact.");
 	}, [](const MTPDmessageActionEmpty &) {
 		return PreparedText{ tr::lng_message_empty(tr::now) };
 	});
@@ -544,6 +536,68 @@ void HistoryService::setMessageByAction(const MTPmessageAction &action) {
 	applyAction(action);
 }
 
+auto HistoryService::compactTextFor(const MTPmessageAction &action) const
+-> CompactText {
+	return action.match([&](const MTPDmessageActionChatAddUser &data) {
+		const auto &users = data.vusers().v;
+		return (users.size() == 1 && peerFromUser(users[0]) == _from->id)
+			? CompactText::Joined
+			: CompactText::None;
+	}, [&](const MTPDmessageActionChatDeleteUser &data) {
+		return (peerFromUser(data.vuser_id()) == _from->id)
+			? CompactText::Left
+			: CompactText::None;
+	}, [](const MTPDmessageActionChatJoinedByLink &) {
+		return CompactText::JoinedByLink;
+	}, [](const MTPDmessageActionChatJoinedByRequest &) {
+		return CompactText::JoinedByRequest;
+	}, [](const auto &) {
+		return CompactText::None;
+	});
+}
+
+void HistoryService::setCompactText(CompactText type) {
+	_compactText = type;
+	_textPending = true;
+	if (!_text.isEmpty()) {
+		_text = Ui::Text::String(st::msgMinWidth);
+		_cleanText = Ui::Text::String();
+	}
+	invalidateTextHeights();
+}
+
+auto HistoryService::prepareCompactText(CompactText type) const
+-> PreparedText {
+	const auto from = fromLinkText();
+	const auto text = [&] {
+		switch (type) {
+		case CompactText::Joined:
+			return tr::lng_action_user_joined(tr::now, lt_from, from);
+		case CompactText::JoinedByLink:
+			return tr::lng_action_user_joined_by_link(
+				tr::now,
+				lt_from,
+				from);
+		case CompactText::JoinedByRequest:
+			return tr::lng_action_user_joined_by_request(
+				tr::now,
+				lt_from,
+				from);
+		case CompactText::Left:
+			return tr::lng_action_user_left(tr::now, lt_from, from);
+		}
+		Unexpected("Type in HistoryService::prepareCompactText.");
+	}();
+	return { text, { fromLink() } };
+}
+
+void HistoryService::layoutPendingText() {
+	if (_compactText != CompactText::None) {
+		setServiceText(prepareCompactText(_compactText));
+	}
+	_textPending = false;
+}
+
 void HistoryService::applyAction(const MTPMessageAction &action) {
 	action.match([&](const MTPDmessageActionChatAddUser &data) {
 		if (const auto channel = history()->peer->asMegagroup()) {
@@ -977,6 +1031,7 @@ QString HistoryService::notificationText() const {
 		if (_media) {
 			return _media->notificationText();
 		} else if (!emptyText()) {
+			textLayout();
 			return _cleanText.toString();
 		}
 		return QString();
@@ -1006,10 +1061,12 @@ QString HistoryService::fromLinkText() const {
 }
 
 ClickHandlerPtr HistoryService::fromLink() const {
-	return _from->createOpenLink();
+	return _from->openLink();
 }
 
 void HistoryService::setServiceText(const PreparedText &prepared) {
+	_compactText = CompactText::None;
+	_textPending = false;
 	_text.setText(
 		st::serviceTextStyle,
 		(needTime() && !prepared.text.isEmpty() ? prepared.text + GenerateServiceTime(date()) : prepared.text),
@@ -1024,12 +1081,13 @@ void HistoryService::setServiceText(const PreparedText &prepared) {
 		// Link indices start with 1.
 		_text.setLink(++linkIndex, link);
 	}
-	_textWidth = -1;
-	_textHeight = 0;
+	invalidateTextHeights();
 }
 
 void HistoryService::hideSpoilers() {
-	HistoryView::HideSpoilers(_text);
+	if (!_textPending) {
+		HistoryView::HideSpoilers(_text);
+	}
 }
 
 void HistoryService::markMediaAsReadHook() {
@@ -1231,8 +1289,7 @@ void HistoryService::removeMedia() {
 	if (!_media) return;
 
 	_media.reset();
-	_textWidth = -1;
-	_textHeight = 0;
+	invalidateTextHeights();
 	history()->owner().requestItemResize(this);
 }
 
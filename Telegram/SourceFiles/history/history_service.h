@@ -139,6 +139,7 @@ protected:
 	friend class HistoryView::ServiceMessagePainter;
 
 	void markMediaAsReadHook() override;
+	void layoutPendingText() override;
 
 	QString fromLinkText() const;
 	ClickHandlerPtr fromLink() const;
@@ -146,6 +147,16 @@ protected:
 	void removeMedia();
 
 private:
+	// Huge groups have lots of join and leave messages, that are rarely
+	// shown, so only their type is kept until they are laid out.
+	enum class CompactText : uchar {
+		None,
+		Joined,
+		JoinedByLink,
+		JoinedByRequest,
+		Left,
+	};
+
 	HistoryServiceDependentData *GetDependentData() {
 		if (auto pinned = Get<HistoryServicePinned>()) {
 			return pinned;
@@ -172,6 +183,11 @@ private:
 		int ttlSeconds);
 	void applyAction(const MTPMessageAction &action);
 
+	[[nodiscard]] CompactText compactTextFor(
+		const MTPmessageAction &action) const;
+	void setCompactText(CompactText type);
+	[[nodiscard]] PreparedText prepareCompactText(CompactText type) const;
+
 	PreparedText preparePinnedText();
 	PreparedText prepareGameScoreText();
 	PreparedText preparePaymentSentText();
@@ -184,6 +200,7 @@ private:
 	friend class HistoryView::Service;
 
 	Ui::Text::String _cleanText;
+	CompactText _compactText = CompactText::None;
 	bool _needTime = true;
 };
 
@@ -14,6 +14,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "api/api_chat_participants.h"
 #include "api/api_sending.h"
 #include "api/api_text_entities.h"
+#include "api/api_web_page_previews.h"
 #include "api/api_send_progress.h"
 #include "ui/boxes/confirm_box.h"
 #include "boxes/delete_messages_box.h"
@@ -113,6 +114,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/audio/media_audio_capture.h"
 #include "media/player/media_player_instance.h"
 #include "core/application.h"
+#include "core/paint_profiler.h"
+#include "core/rpl_profiler.h"
 #include "apiwrap.h"
 #include "base/qthelp_regex.h"
 #include "ui/boxes/report_box.h"
@@ -172,6 +175,9 @@ constexpr auto kSaveDraftTimeout = 1000;
 constexpr auto kSaveDraftAnywayTimeout = 5000;
 constexpr auto kSaveCloudDraftIdleTimeout = 14000;
 constexpr auto kRefreshSlowmodeLabelTimeout = crl::time(200);
+constexpr auto kMaxMessagesInClosedHistory = 1000;
+constexpr auto kLazyResizeTimeout = crl::time(16);
+constexpr auto kRememberRestoreChatTimeout = 5 * crl::time(1000);
 constexpr auto kCommonModifiers = 0
 	| Qt::ShiftModifier
 	| Qt::MetaModifier
@@ -277,6 +283,14 @@ object_ptr<Ui::FlatButton> SetupDiscussButton(
 		crl::time(1000) * 8);
 }
 
+[[nodiscard]] int LoadedMessagesCount(not_null<History*> history) {
+	auto result = 0;
+	for (const auto &block : history->blocks) {
+		result += int(block->messages.size());
+	}
+	return result;
+}
+
 [[nodiscard]] rpl::producer<PeerData*> ActivePeerValue(
 		not_null<Window::SessionController*> controller) {
 	return controller->activeChatValue(
@@ -298,7 +312,11 @@ HistoryWidget::HistoryWidget(
 , _api(&controller->session().mtp())
 , _updateEditTimeLeftDisplay([=] { updateField(); })
 , _fieldBarCancel(this, st::historyReplyCancel)
-, _previewTimer([=] { requestPreview(); })
+, _previewTimer([=] {
+	if (_previewData && _previewData->pendingTill > 0) {
+		requestPreview();
+	}
+})
 , _previewState(Data::PreviewState::Allowed)
 , _topBar(this, controller)
 , _scroll(
@@ -351,6 +369,8 @@ HistoryWidget::HistoryWidget(
 , _membersDropdownShowTimer([=] { showMembersDropdown(); })
 , _saveDraftTimer([=] { saveDraft(); })
 , _saveCloudDraftTimer([=] { saveCloudDraft(); })
+, _lazyResizeTimer([=] { resizeLazyHistoryItems(); })
+, _rememberRestoreChatTimer([=] { rememberRestoreChat(); })
 , _topShadow(this) {
 	setAcceptDrops(true);
 
@@ -719,6 +739,8 @@ HistoryWidget::HistoryWidget(
 		| HistoryUpdateFlag::TopPromoted
 		| HistoryUpdateFlag::ClientSideMessages
 		| HistoryUpdateFlag::PinnedMessages
+	) | Core::RplProfiler::Site(
+		"HistoryWidget/History"
 	) | rpl::filter([=](const Data::HistoryUpdate &update) {
 		if (_migrated && update.history.get() == _migrated) {
 			if (_pinnedTracker
@@ -767,6 +789,8 @@ HistoryWidget::HistoryWidget(
 		| MessageUpdateFlag::Edited
 		| MessageUpdateFlag::ReplyMarkup
 		| MessageUpdateFlag::BotCallbackSent
+	) | Core::RplProfiler::Site(
+		"HistoryWidget/Message"
 	) | rpl::start_with_next([=](const Data::MessageUpdate &update) {
 		const auto flags = update.flags;
 		if (flags & MessageUpdateFlag::Destroyed) {
@@ -811,6 +835,8 @@ HistoryWidget::HistoryWidget(
 		| PeerUpdateFlag::MessagesTTL
 		| PeerUpdateFlag::ChatThemeEmoji
 		| PeerUpdateFlag::FullInfo
+	) | Core::RplProfiler::Site(
+		"HistoryWidget/Peer"
 	) | rpl::filter([=](const Data::PeerUpdate &update) {
 		return (update.peer.get() == _peer);
 	}) | rpl::map([](const Data::PeerUpdate &update) {
@@ -1041,6 +1067,7 @@ void HistoryWidget::initVoiceRecordBar() {
 	_voiceRecordBar->sendVoiceRequests(
 	) | rpl::start_with_next([=](const auto &data) {
 		if (!canWriteMessage() || data.bytes.isEmpty() || !_history) {
+			session().uploader().cancelStreamed(data.streamedUploadId);
 			return;
 		}
 
@@ -1049,7 +1076,8 @@ void HistoryWidget::initVoiceRecordBar() {
 			data.bytes,
 			data.waveform,
 			data.duration,
-			action);
+			action,
+			data.streamedUploadId);
 		_voiceRecordBar->clearListenState();
 		applyLocalDraft();
 	}, lifetime());
@@ -2210,7 +2238,12 @@ void HistoryWidget::showHistory(
 	}
 
 	clearReplyReturns();
+	auto closedHistories = std::vector<not_null<History*>>();
 	if (_history) {
+		closedHistories.push_back(_history);
+		if (_migrated) {
+			closedHistories.push_back(_migrated);
+		}
 		if (Ui::InFocusChain(_list)) {
 			// Removing focus from list clears selected and updates top bar.
 			setFocus();
@@ -2248,12 +2281,18 @@ void HistoryWidget::showHistory(
 	_replyEditMsg = nullptr;
 	_editMsgId = _replyToId = 0;
 	_previewData = nullptr;
-	_previewCache.clear();
 	_fieldBarCancel->hide();
 
 	_membersDropdownShowTimer.cancel();
 	_scroll->takeWidget<HistoryInner>().destroy();
 
+	// Views of long closed chats are dropped, items stay in memory.
+	for (const auto history : closedHistories) {
+		if (LoadedMessagesCount(history) > kMaxMessagesInClosedHistory) {
+			history->clear(History::ClearType::Unload);
+		}
+	}
+
 	clearInlineBot();
 
 	_showAtMsgId = showAtMsgId;
@@ -2436,6 +2475,7 @@ void HistoryWidget::showHistory(
 			_history,
 			FullMsgId(_history->peer->id, _showAtMsgId) });
 	}
+	rememberRestoreChat();
 	update();
 	controller()->floatPlayerAreaUpdated();
 
@@ -3025,6 +3065,37 @@ void HistoryWidget::messagesFailed(const MTP::Error &error, int requestId) {
 	}
 }
 
+void HistoryWidget::messagesReceivedAsync(
+		not_null<PeerData*> peer,
+		const MTPmessages_Messages &messages,
+		int requestId,
+		Fn<void()> finish) {
+	// Message texts and entities are prepared on a worker thread,
+	// the main thread only creates the items from them. The request
+	// is finished only after the slice is applied, so that the next
+	// one for this history is not sent before that.
+	const auto weak = Ui::MakeWeak(this);
+	const auto session = &peer->session();
+	crl::async([=] {
+		auto texts = messages.match([](
+				const MTPDmessages_messagesNotModified &) {
+			return Data::PreparedMessageTexts();
+		}, [](const auto &data) {
+			return Data::PrepareMessageTexts(data.vmessages().v);
+		});
+		crl::on_main(session, [=, texts = std::move(texts)]() mutable {
+			const auto guard = gsl::finally(finish);
+			if (!weak || !_history) {
+				return;
+			}
+			auto &owner = peer->owner();
+			owner.setPreparedMessageTexts(peer->id, std::move(texts));
+			messagesReceived(peer, messages, requestId);
+			owner.clearPreparedMessageTexts();
+		});
+	});
+}
+
 void HistoryWidget::messagesReceived(PeerData *peer, const MTPmessages_Messages &messages, int requestId) {
 	Expects(_history != nullptr);
 
@@ -3279,8 +3350,11 @@ void HistoryWidget::loadMessages() {
 			MTP_int(minId),
 			MTP_long(historyHash)
 		)).done([=](const MTPmessages_Messages &result) {
-			messagesReceived(history->peer, result, _preloadRequest);
-			finish();
+			messagesReceivedAsync(
+				history->peer,
+				result,
+				_preloadRequest,
+				finish);
 		}).fail([=](const MTP::Error &error) {
 			messagesFailed(error, _preloadRequest);
 			finish();
@@ -3331,8 +3405,11 @@ void HistoryWidget::loadMessagesDown() {
 			MTP_int(minId),
 			MTP_long(historyHash)
 		)).done([=](const MTPmessages_Messages &result) {
-			messagesReceived(history->peer, result, _preloadDownRequest);
-			finish();
+			messagesReceivedAsync(
+				history->peer,
+				result,
+				_preloadDownRequest,
+				finish);
 		}).fail([=](const MTP::Error &error) {
 			messagesFailed(error, _preloadDownRequest);
 			finish();
@@ -3409,6 +3486,10 @@ void HistoryWidget::handleScroll() {
 		preloadHistoryIfNeeded();
 	}
 	visibleAreaUpdated();
+	if (!_rememberRestoreChatTimer.isActive()) {
+		// Don't write the settings on each scroll event.
+		_rememberRestoreChatTimer.callOnce(kRememberRestoreChatTimeout);
+	}
 	if (!_itemsRevealHeight) {
 		updatePinnedViewer();
 	}
@@ -3441,6 +3522,29 @@ bool HistoryWidget::isItemCompletelyHidden(HistoryItem *item) const {
 	return (top >= scrollBottom || bottom <= scrollTop);
 }
 
+void HistoryWidget::rememberRestoreChat() {
+	_rememberRestoreChatTimer.cancel();
+
+	// Scrolled to the bottom there is no scrollTopItem, then we show
+	// the chat at the unread bar or at the end after a restart.
+	const auto item = (_history && _history->scrollTopItem)
+		? _history->scrollTopItem->data().get()
+		: nullptr;
+	const auto peerId = _peer ? _peer->id : PeerId();
+	const auto msgId = !peerId
+		? MsgId()
+		: (item && item->isRegular())
+		? item->id
+		: MsgId(ShowAtUnreadMsgId);
+	auto &settings = session().settings();
+	if (settings.restoreChatPeer() == peerId
+		&& settings.restoreChatMsgId() == msgId) {
+		return;
+	}
+	settings.setRestoreChat(peerId, msgId);
+	session().saveSettingsDelayed();
+}
+
 void HistoryWidget::visibleAreaUpdated() {
 	if (_list && !_scroll->isHidden()) {
 		const auto scrollTop = _scroll->scrollTop();
@@ -5518,6 +5622,11 @@ void HistoryWidget::updateListSize() {
 	Expects(_list != nullptr);
 
 	_list->recountHistoryGeometry();
+	if ((_history->hasLazyResizedItems()
+		|| (_migrated && _migrated->hasLazyResizedItems()))
+		&& !_lazyResizeTimer.isActive()) {
+		_lazyResizeTimer.callOnce(kLazyResizeTimeout);
+	}
 	auto washidden = _scroll->isHidden();
 	if (washidden) {
 		_scroll->show();
@@ -5531,6 +5640,18 @@ void HistoryWidget::updateListSize() {
 	_updateHistoryGeometryRequired = true;
 }
 
+void HistoryWidget::resizeLazyHistoryItems() {
+	if (!_history || !_list) {
+		return;
+	}
+	const auto history = _history->resizeLazyItems();
+	const auto migrated = _migrated && _migrated->resizeLazyItems();
+	if (history || migrated) {
+		// Keeps the scroll position by scrollTopItem.
+		updateHistoryGeometry();
+	}
+}
+
 bool HistoryWidget::hasPendingResizedItems() const {
 	if (!_list) {
 		// Based on the crash reports there is a codepath (at least on macOS)
@@ -6936,7 +7057,6 @@ void HistoryWidget::cancelFieldAreaState() {
 }
 
 void HistoryWidget::previewCancel() {
-	_api.request(base::take(_previewRequest)).cancel();
 	_previewData = nullptr;
 	_previewLinks.clear();
 	updatePreview();
@@ -6952,24 +7072,18 @@ void HistoryWidget::checkPreview() {
 	}
 	const auto links = _parsedLinks.join(' ');
 	if (_previewLinks != links) {
-		_api.request(base::take(_previewRequest)).cancel();
 		_previewLinks = links;
 		if (_previewLinks.isEmpty()) {
 			if (_previewData && _previewData->pendingTill >= 0) {
 				previewCancel();
 			}
 		} else {
-			const auto i = _previewCache.constFind(links);
-			if (i == _previewCache.cend()) {
-				_previewRequest = _api.request(MTPmessages_GetWebPagePreview(
-					MTP_flags(0),
-					MTP_string(links),
-					MTPVector<MTPMessageEntity>()
-				)).done([=](const MTPMessageMedia &result, mtpRequestId requestId) {
-					gotPreview(links, result, requestId);
-				}).send();
-			} else if (i.value()) {
-				_previewData = session().data().webpage(i.value());
+			const auto cached = session().api().webPagePreviews().cached(
+				links);
+			if (!cached) {
+				requestPreview();
+			} else if (*cached) {
+				_previewData = session().data().webpage(*cached);
 				updatePreview();
 			} else if (_previewData && _previewData->pendingTill >= 0) {
 				previewCancel();
@@ -6979,52 +7093,23 @@ void HistoryWidget::checkPreview() {
 }
 
 void HistoryWidget::requestPreview() {
-	if (!_previewData
-		|| (_previewData->pendingTill <= 0)
-		|| _previewLinks.isEmpty()) {
+	if (_previewLinks.isEmpty()) {
 		return;
 	}
 	const auto links = _previewLinks;
-	_previewRequest = _api.request(MTPmessages_GetWebPagePreview(
-		MTP_flags(0),
-		MTP_string(links),
-		MTPVector<MTPMessageEntity>()
-	)).done([=](const MTPMessageMedia &result, mtpRequestId requestId) {
-		gotPreview(links, result, requestId);
-	}).send();
-}
-
-void HistoryWidget::gotPreview(
-		QString links,
-		const MTPMessageMedia &result,
-		mtpRequestId req) {
-	if (req == _previewRequest) {
-		_previewRequest = 0;
-	}
-	if (result.type() == mtpc_messageMediaWebPage) {
-		const auto &data = result.c_messageMediaWebPage().vwebpage();
-		const auto page = session().data().processWebpage(data);
-		_previewCache.insert(links, page->id);
-		if (page->pendingTill > 0
-			&& page->pendingTill <= base::unixtime::now()) {
-			page->pendingTill = -1;
-		}
-		if (links == _previewLinks
-			&& _previewState == Data::PreviewState::Allowed) {
-			_previewData = (page->id && page->pendingTill >= 0)
-				? page.get()
-				: nullptr;
-			updatePreview();
-		}
-		session().data().sendWebPageGamePollNotifications();
-	} else if (result.type() == mtpc_messageMediaEmpty) {
-		_previewCache.insert(links, 0);
-		if (links == _previewLinks
-			&& _previewState == Data::PreviewState::Allowed) {
-			_previewData = nullptr;
-			updatePreview();
-		}
+	session().api().webPagePreviews().request(
+		links,
+		crl::guard(this, [=](WebPageId id) { gotPreview(links, id); }));
+}
+
+void HistoryWidget::gotPreview(QString links, WebPageId id) {
+	if (links != _previewLinks
+		|| _previewState != Data::PreviewState::Allowed) {
+		return;
 	}
+	const auto page = id ? session().data().webpage(id).get() : nullptr;
+	_previewData = (page && page->pendingTill >= 0) ? page : nullptr;
+	updatePreview();
 }
 
 void HistoryWidget::updatePreview() {
@@ -7704,6 +7789,7 @@ void HistoryWidget::paintEvent(QPaintEvent *e) {
 		updateListSize();
 	}
 
+	const auto profile = Core::PaintProfiler::Scope("History/Widget");
 	Window::SectionWidget::PaintBackground(
 		controller(),
 		_list ? _list->theme().get() : controller()->defaultChatTheme().get(),
@@ -541,13 +541,19 @@ private:
 
 	void checkPreview();
 	void requestPreview();
-	void gotPreview(QString links, const MTPMessageMedia &media, mtpRequestId req);
+	void gotPreview(QString links, WebPageId id);
 	void messagesReceived(PeerData *peer, const MTPmessages_Messages &messages, int requestId);
+	void messagesReceivedAsync(
+		not_null<PeerData*> peer,
+		const MTPmessages_Messages &messages,
+		int requestId,
+		Fn<void()> finish);
 	void messagesFailed(const MTP::Error &error, int requestId);
 	void addMessagesToFront(PeerData *peer, const QVector<MTPMessage> &messages);
 	void addMessagesToBack(PeerData *peer, const QVector<MTPMessage> &messages);
 
 	void updateHistoryGeometry(bool initial = false, bool loadedDown = false, const ScrollChange &change = { ScrollChangeNone, 0 });
+	void resizeLazyHistoryItems();
 	void updateListSize();
 	void startItemRevealAnimations();
 	void revealItemsCallback();
@@ -589,6 +595,7 @@ private:
 	// when scroll position or scroll area size changed this method
 	// updates the boundings of the visible area in HistoryInner
 	void visibleAreaUpdated();
+	void rememberRestoreChat();
 	int countInitialScrollTop();
 	int countAutomaticScrollTop();
 	void preloadHistoryByScroll();
@@ -660,9 +667,6 @@ private:
 	QStringList _parsedLinks;
 	QString _previewLinks;
 	WebPageData *_previewData = nullptr;
-	typedef QMap<QString, WebPageId> PreviewCache;
-	PreviewCache _previewCache;
-	mtpRequestId _previewRequest = 0;
 	Ui::Text::String _previewTitle;
 	Ui::Text::String _previewDescription;
 	base::Timer _previewTimer;
@@ -781,6 +785,8 @@ private:
 	bool _saveDraftText = false;
 	base::Timer _saveDraftTimer;
 	base::Timer _saveCloudDraftTimer;
+	base::Timer _lazyResizeTimer;
+	base::Timer _rememberRestoreChatTimer;
 
 	base::weak_ptr<Ui::Toast::Instance> _topToast;
 	std::unique_ptr<ChooseMessagesForReport> _chooseForReport;
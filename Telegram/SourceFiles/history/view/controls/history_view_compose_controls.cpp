@@ -32,6 +32,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/storage_account.h"
 #include "apiwrap.h"
 #include "api/api_chat_participants.h"
+#include "api/api_web_page_previews.h"
 #include "ui/boxes/confirm_box.h"
 #include "history/history.h"
 #include "history/history_item.h"
@@ -2231,11 +2232,6 @@ void ComposeControls::initWebpageProcess() {
 	const auto parsedLinks = lifetime.make_state<QStringList>();
 	const auto previewLinks = lifetime.make_state<QString>();
 	const auto previewData = lifetime.make_state<WebPageData*>(nullptr);
-	using PreviewCache = std::map<QString, WebPageId>;
-	const auto previewCache = lifetime.make_state<PreviewCache>();
-	const auto previewRequest = lifetime.make_state<mtpRequestId>(0);
-	const auto mtpSender =
-		lifetime.make_state<MTP::Sender>(&_window->session().mtp());
 
 	const auto title = std::make_shared<rpl::event_stream<QString>>();
 	const auto description = std::make_shared<rpl::event_stream<QString>>();
@@ -2268,38 +2264,18 @@ void ComposeControls::initWebpageProcess() {
 	};
 
 	const auto gotPreview = crl::guard(_wrap.get(), [=](
-			const auto &result,
-			QString links) {
-		if (*previewRequest) {
-			*previewRequest = 0;
+			QString links,
+			WebPageId id) {
+		if (links != *previewLinks
+			|| _previewState != Data::PreviewState::Allowed) {
+			return;
 		}
-		result.match([=](const MTPDmessageMediaWebPage &d) {
-			const auto page = _history->owner().processWebpage(d.vwebpage());
-			previewCache->insert({ links, page->id });
-			auto &till = page->pendingTill;
-			if (till > 0 && till <= base::unixtime::now()) {
-				till = -1;
-			}
-			if (links == *previewLinks
-				&& _previewState == Data::PreviewState::Allowed) {
-				*previewData = (page->id && page->pendingTill >= 0)
-					? page.get()
-					: nullptr;
-				updatePreview();
-			}
-		}, [=](const MTPDmessageMediaEmpty &d) {
-			previewCache->insert({ links, 0 });
-			if (links == *previewLinks
-				&& _previewState == Data::PreviewState::Allowed) {
-				*previewData = nullptr;
-				updatePreview();
-			}
-		}, [](const auto &d) {
-		});
+		const auto page = id ? _history->owner().webpage(id).get() : nullptr;
+		*previewData = (page && page->pendingTill >= 0) ? page : nullptr;
+		updatePreview();
 	});
 
 	_previewCancel = [=] {
-		mtpSender->request(base::take(*previewRequest)).cancel();
 		*previewData = nullptr;
 		previewLinks->clear();
 		updatePreview();
@@ -2307,13 +2283,9 @@ void ComposeControls::initWebpageProcess() {
 
 	const auto getWebPagePreview = [=] {
 		const auto links = *previewLinks;
-		*previewRequest = mtpSender->request(MTPmessages_GetWebPagePreview(
-			MTP_flags(0),
-			MTP_string(links),
-			MTPVector<MTPMessageEntity>()
-		)).done([=](const MTPMessageMedia &result) {
-			gotPreview(result, links);
-		}).send();
+		_history->session().api().webPagePreviews().request(
+			links,
+			[=](WebPageId id) { gotPreview(links, id); });
 	};
 
 	const auto checkPreview = crl::guard(_wrap.get(), [=] {
@@ -2328,18 +2300,18 @@ void ComposeControls::initWebpageProcess() {
 		if (*previewLinks == newLinks) {
 			return;
 		}
-		mtpSender->request(base::take(*previewRequest)).cancel();
 		*previewLinks = newLinks;
 		if (previewLinks->isEmpty()) {
 			if (ShowWebPagePreview(*previewData)) {
 				_previewCancel();
 			}
 		} else {
-			const auto i = previewCache->find(*previewLinks);
-			if (i == previewCache->end()) {
+			const auto cached = _history->session().api(
+			).webPagePreviews().cached(*previewLinks);
+			if (!cached) {
 				getWebPagePreview();
-			} else if (i->second) {
-				*previewData = _history->owner().webpage(i->second);
+			} else if (*cached) {
+				*previewData = _history->owner().webpage(*cached);
 				updatePreview();
 			} else if (ShowWebPagePreview(*previewData)) {
 				_previewCancel();
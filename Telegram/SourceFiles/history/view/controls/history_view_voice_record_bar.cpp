@@ -20,6 +20,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/view/controls/history_view_voice_record_button.h"
 #include "lang/lang_keys.h"
 #include "main/main_session.h"
+#include "storage/file_upload.h"
 #include "mainwidget.h" // MainWidget::stopAndClosePlayer
 #include "mainwindow.h"
 #include "media/audio/media_audio.h"
@@ -999,6 +1000,9 @@ VoiceRecordBar::~VoiceRecordBar() {
 	if (isRecording()) {
 		stopRecording(StopType::Cancel);
 	}
+	// The stop callback above is guarded by this and won't be called.
+	_controller->session().uploader().cancelStreamed(
+		base::take(_streamedUploadId));
 }
 
 void VoiceRecordBar::updateMessageGeometry() {
@@ -1300,6 +1304,17 @@ void VoiceRecordBar::startRecording() {
 		_recording = true;
 		_controller->widget()->setInnerFocus();
 		instance()->start();
+
+		auto &uploader = _controller->session().uploader();
+		uploader.cancelStreamed(base::take(_streamedUploadId));
+		_streamedUploadId = uploader.startStreamed();
+		instance()->encoded(
+		) | rpl::start_with_next([=](const QByteArray &bytes) {
+			_controller->session().uploader().streamedData(
+				_streamedUploadId,
+				bytes);
+		}, _recordingLifetime);
+
 		instance()->updated(
 		) | rpl::start_with_next_error([=](const Update &update) {
 			_recordingTipRequired = (update.samples < kMinSamples);
@@ -1380,7 +1395,11 @@ void VoiceRecordBar::finish() {
 	_showAnimation.stop();
 	_lockToStopAnimation.stop();
 
-	_listen = nullptr;
+	if (base::take(_listen)) {
+		// Discarded from the listen state, if it was not sent.
+		_controller->session().uploader().cancelStreamed(
+			base::take(_streamedUploadId));
+	}
 
 	_sendActionUpdates.fire({ Api::SendProgressType::RecordVoice, -1 });
 	_controller->widget()->setInnerFocus();
@@ -1397,11 +1416,17 @@ void VoiceRecordBar::stopRecording(StopType type) {
 	using namespace ::Media::Capture;
 	if (type == StopType::Cancel) {
 		instance()->stop(crl::guard(this, [=](Result &&data) {
+			_controller->session().uploader().cancelStreamed(
+				base::take(_streamedUploadId));
 			_cancelRequests.fire({});
 		}));
 		return;
 	}
 	instance()->stop(crl::guard(this, [=](Result &&data) {
+		if (!data.streamed) {
+			_controller->session().uploader().cancelStreamed(
+				base::take(_streamedUploadId));
+		}
 		if (data.bytes.isEmpty()) {
 			// Close everything.
 			stop(false);
@@ -1411,7 +1436,12 @@ void VoiceRecordBar::stopRecording(StopType type) {
 		Window::ActivateWindow(_controller);
 		const auto duration = Duration(data.samples);
 		if (type == StopType::Send) {
-			_sendVoiceRequests.fire({ data.bytes, data.waveform, duration });
+			_sendVoiceRequests.fire({
+				.bytes = data.bytes,
+				.waveform = data.waveform,
+				.duration = duration,
+				.streamedUploadId = base::take(_streamedUploadId),
+			});
 		} else if (type == StopType::Listen) {
 			_listen = std::make_unique<ListenWrap>(
 				this,
@@ -1488,7 +1518,8 @@ void VoiceRecordBar::requestToSendWithOptions(Api::SendOptions options) {
 			data->bytes,
 			data->waveform,
 			Duration(data->samples),
-			options });
+			options,
+			base::take(_streamedUploadId) });
 	}
 }
 
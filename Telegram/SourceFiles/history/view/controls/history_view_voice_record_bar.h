@@ -158,6 +158,7 @@ private:
 	const style::font &_cancelFont;
 
 	rpl::lifetime _recordingLifetime;
+	uint64 _streamedUploadId = 0;
 
 	Ui::Animations::Simple _showLockAnimation;
 	Ui::Animations::Simple _lockToStopAnimation;
@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "kotato/kotato_lang.h"
 #include "api/api_chat_invite.h"
 #include "history/view/history_view_service_message.h"
+#include "history/history_object_pool.h"
 #include "history/view/history_view_message.h"
 #include "history/history_item_components.h"
 #include "history/history_item.h"
@@ -35,6 +36,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_session.h"
 #include "data/data_groups.h"
 #include "data/data_media_types.h"
+#include "data/data_document.h"
 #include "data/data_sponsored_messages.h"
 #include "lang/lang_keys.h"
 #include "app.h"
@@ -235,6 +237,31 @@ TextSelection ShiftItemSelection(
 	return ShiftItemSelection(selection, byText.length());
 }
 
+const char *ElementPaintSection(not_null<const Element*> view) {
+	const auto item = view->data();
+	const auto media = item->media();
+	if (item->isService()) {
+		return "Element/Service";
+	} else if (!media) {
+		return "Element/Text";
+	} else if (item->groupId()) {
+		return "Element/Grouped";
+	} else if (media->webpage()) {
+		return "Element/WebPage";
+	} else if (media->poll()) {
+		return "Element/Poll";
+	} else if (media->photo()) {
+		return "Element/Photo";
+	} else if (const auto document = media->document()) {
+		return document->sticker()
+			? "Element/Sticker"
+			: (document->isAnimation() || document->isVideoFile())
+			? "Element/Video"
+			: "Element/Document";
+	}
+	return "Element/Other";
+}
+
 QString DateTooltipText(not_null<Element*> view) {
 	const auto format = QLocale::system().dateTimeFormat(QLocale::LongFormat);
 	auto dateText = view->dateTime().toString(format);
@@ -345,6 +372,14 @@ void DateBadge::paint(
 	ServiceMessagePainter::PaintDate(p, st, text, width, y, w, chatWide);
 }
 
+void *Element::operator new(std::size_t size) {
+	return HistoryObjectPool::Allocate(size);
+}
+
+void Element::operator delete(void *memory, std::size_t size) {
+	HistoryObjectPool::Free(memory, size);
+}
+
 Element::Element(
 	not_null<ElementDelegate*> delegate,
 	not_null<HistoryItem*> data,
@@ -185,6 +185,9 @@ TextSelection ShiftItemSelection(
 
 QString DateTooltipText(not_null<Element*> view);
 
+// Section name of the element for Core::PaintProfiler.
+[[nodiscard]] const char *ElementPaintSection(not_null<const Element*> view);
+
 // Any HistoryView::Element can have this Component for
 // displaying the unread messages bar above the message.
 struct UnreadBar : public RuntimeComponent<UnreadBar, Element> {
@@ -234,6 +237,9 @@ public:
 		not_null<HistoryItem*> data,
 		Element *replacing);
 
+	[[nodiscard]] static void *operator new(std::size_t size);
+	static void operator delete(void *memory, std::size_t size);
+
 	enum class Flag : uchar {
 		NeedsResize        = 0x01,
 		AttachedToPrevious = 0x02,
@@ -30,6 +30,7 @@ constexpr auto kMaxPlays = 5;
 constexpr auto kMaxPlaysWithSmallDelay = 3;
 constexpr auto kSmallDelay = crl::time(200);
 constexpr auto kDropDelayedAfterDelay = crl::time(2000);
+constexpr auto kMaxDelayed = 8;
 
 [[nodiscard]] QPoint GenerateRandomShift(QSize emoji) {
 	// Random shift in [-0.08 ... 0.08] of animated emoji size.
@@ -73,6 +74,17 @@ void EmojiInteractions::play(
 			request.incoming);
 	} else {
 		const auto now = crl::now();
+		if (!_delayed.empty()) {
+			// Merge bursts of the same interaction on the same message.
+			const auto &last = _delayed.back();
+			if (last.view == view
+				&& last.emoticon == request.emoticon
+				&& last.shouldHaveStartedAt + kSmallDelay > now) {
+				return;
+			} else if (_delayed.size() >= kMaxDelayed) {
+				_delayed.erase(begin(_delayed));
+			}
+		}
 		_delayed.push_back({
 			request.emoticon,
 			view,
@@ -107,7 +119,7 @@ void EmojiInteractions::play(
 			const auto rect = computeRect(view).translated(shift);
 			if (rect.y() + rect.height() >= _visibleTop
 				&& rect.y() <= _visibleBottom) {
-				_updateRequests.fire_copy(rect);
+				requestUpdate(rect);
 			}
 		});
 	}, lottie->lifetime());
@@ -267,6 +279,19 @@ void EmojiInteractions::checkDelayed() {
 		good.incoming);
 }
 
+void EmojiInteractions::requestUpdate(QRect rect) {
+	// All the players ask for frames at the same time, repaint them once.
+	_pendingUpdate |= rect;
+	if (_updateScheduled) {
+		return;
+	}
+	_updateScheduled = true;
+	crl::on_main(this, [=] {
+		_updateScheduled = false;
+		_updateRequests.fire(base::take(_pendingUpdate));
+	});
+}
+
 rpl::producer<QRect> EmojiInteractions::updateRequests() const {
 	return _updateRequests.events();
 }
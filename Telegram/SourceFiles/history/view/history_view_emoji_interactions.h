@@ -28,7 +28,7 @@ namespace HistoryView {
 
 class Element;
 
-class EmojiInteractions final {
+class EmojiInteractions final : public base::has_weak_ptr {
 public:
 	explicit EmojiInteractions(not_null<Main::Session*> session);
 	~EmojiInteractions();
@@ -68,6 +68,7 @@ private:
 		std::shared_ptr<Data::DocumentMedia> media,
 		bool incoming);
 	void checkDelayed();
+	void requestUpdate(QRect rect);
 
 	[[nodiscard]] std::unique_ptr<Lottie::SinglePlayer> preparePlayer(
 		not_null<Data::DocumentMedia*> media);
@@ -80,6 +81,8 @@ private:
 
 	std::vector<Play> _plays;
 	std::vector<Delayed> _delayed;
+	QRect _pendingUpdate;
+	bool _updateScheduled = false;
 	rpl::event_stream<QRect> _updateRequests;
 	rpl::event_stream<QString> _playStarted;
 	base::flat_map<
@@ -23,6 +23,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mainwindow.h"
 #include "mainwidget.h"
 #include "core/click_handler_types.h"
+#include "core/paint_profiler.h"
 #include "apiwrap.h"
 #include "layout/layout_selection.h"
 #include "window/window_adaptive.h"
@@ -49,6 +50,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_channel.h"
 #include "data/data_file_click_handler.h"
 #include "data/data_message_reactions.h"
+#include "data/data_auto_download_scheduler.h"
 #include "facades.h"
 #include "styles/style_chat.h"
 
@@ -63,6 +65,7 @@ constexpr auto kPreloadIfLessThanScreens = 2;
 constexpr auto kPreloadedScreensCountFull
 	= kPreloadedScreensCount + 1 + kPreloadedScreensCount;
 constexpr auto kClearUserpicsAfter = 50;
+constexpr auto kRenderAheadPerPass = 4;
 
 } // namespace
 
@@ -270,6 +273,7 @@ ListWidget::ListWidget(
 		[=](QRect updated) { update(updated); }))
 , _scrollDateCheck([this] { scrollDateCheck(); })
 , _applyUpdatedScrollState([this] { applyUpdatedScrollState(); })
+, _renderAhead([this] { renderAhead(); })
 , _selectEnabled(_delegate->listAllowsMultiSelect())
 , _highlightTimer([this] { updateHighlightedMessage(); }) {
 	setMouseTracking(true);
@@ -317,9 +321,15 @@ ListWidget::ListWidget(
 
 	session().downloaderTaskFinished(
 	) | rpl::start_with_next([=] {
+		clearRenderCaches();
 		update();
 	}, lifetime());
 
+	style::PaletteChanged(
+	) | rpl::start_with_next([=] {
+		clearRenderCaches();
+	}, lifetime());
+
 	session().data().itemRemoved(
 	) | rpl::start_with_next([=](not_null<const HistoryItem*> item) {
 		itemRemoved(item);
@@ -759,6 +769,7 @@ void ListWidget::visibleTopBottomUpdated(
 	const auto scrolledUp = (visibleTop < _visibleTop);
 	_visibleTop = visibleTop;
 	_visibleBottom = visibleBottom;
+	session().data().autoDownloadScheduler().scrolled(this, visibleTop);
 
 	// Unload userpics.
 	if (_userpics.size() > kClearUserpicsAfter) {
@@ -776,6 +787,9 @@ void ListWidget::visibleTopBottomUpdated(
 	}
 	_controller->floatPlayerAreaUpdated();
 	_applyUpdatedScrollState.call();
+	if (cHistoryRenderCache()) {
+		_renderAhead.call();
+	}
 }
 
 void ListWidget::applyUpdatedScrollState() {
@@ -1471,6 +1485,9 @@ bool ListWidget::elementIsChatWide() {
 }
 
 not_null<Ui::PathShiftGradient*> ListWidget::elementPathShiftGradient() {
+	if (_renderingCache) {
+		_renderCacheUsedGradient = true;
+	}
 	return _pathGradient.get();
 }
 
@@ -1482,6 +1499,7 @@ void ListWidget::elementStartInteraction(not_null<const Element*> view) {
 }
 
 void ListWidget::elementShowSpoilerAnimation() {
+	clearRenderCaches();
 	_spoilerOpacity.stop();
 	_spoilerOpacity.start([=] { update(); }, 0., 1., st::fadeWrapDuration);
 }
@@ -1698,6 +1716,7 @@ void ListWidget::paintEvent(QPaintEvent *e) {
 		_userpicsCache.clear();
 	});
 
+	const auto profile = Core::PaintProfiler::Scope("History/Section");
 	Painter p(this);
 
 	_pathGradient->startFrame(
@@ -1724,11 +1743,18 @@ void ListWidget::paintEvent(QPaintEvent *e) {
 			.clip = clip,
 		}).translated(0, -top);
 		p.translate(0, top);
+		const auto useRenderCache = renderCacheAllowed(context);
 		for (auto i = from; i != to; ++i) {
 			const auto view = *i;
 			context.outbg = view->hasOutLayout();
 			context.selection = itemRenderSelection(view);
-			view->draw(p, context);
+			if (!useRenderCache
+				|| !paintFromRenderCache(p, view, context.selection)) {
+				const auto profile = Core::PaintProfiler::Scope([&] {
+					return ElementPaintSection(view);
+				});
+				view->draw(p, context);
+			}
 			const auto height = view->height();
 			top += height;
 			context.translate(0, -height);
@@ -2872,6 +2898,7 @@ void ListWidget::repaintItem(const Element *view) {
 	if (!view) {
 		return;
 	}
+	_renderCaches.remove(view);
 	const auto top = itemTop(view);
 	const auto range = view->verticalRepaintRange();
 	update(0, top + range.top, width(), range.height);
@@ -2969,6 +2996,7 @@ void ListWidget::refreshItem(not_null<const Element*> view) {
 }
 
 void ListWidget::viewReplaced(not_null<const Element*> was, Element *now) {
+	_renderCaches.remove(was);
 	if (_visibleTopItem == was) _visibleTopItem = now;
 	if (_scrollDateLastItem == was) _scrollDateLastItem = now;
 	if (_overElement == was) _overElement = now;
@@ -2998,6 +3026,130 @@ void ListWidget::viewReplaced(not_null<const Element*> was, Element *now) {
 	}
 }
 
+bool ListWidget::renderCacheAllowed(const PaintContext &context) const {
+	// Pattern bubbles depend on the position in the viewport.
+	return cHistoryRenderCache()
+		&& !context.bubblesPattern
+		&& !_highlightedMessageId
+		&& !_spoilerOpacity.animating();
+}
+
+bool ListWidget::paintFromRenderCache(
+		Painter &p,
+		not_null<const Element*> view,
+		TextSelection selection) {
+	const auto i = _renderCaches.find(view);
+	if (i == end(_renderCaches)) {
+		return false;
+	}
+	const auto &cache = i->second;
+	if (cache.width != width()
+		|| cache.height != view->height()
+		|| cache.selection != selection) {
+		_renderCaches.erase(i);
+		return false;
+	}
+	p.drawImage(0, 0, cache.image);
+	return true;
+}
+
+void ListWidget::renderAhead() {
+	if (!cHistoryRenderCache()) {
+		clearRenderCaches();
+		return;
+	} else if (_items.empty() || !(_visibleTop < _visibleBottom)) {
+		return;
+	}
+	const auto screen = _visibleBottom - _visibleTop;
+	const auto from = std::max(_visibleTop - screen, 0);
+	const auto till = _visibleBottom + screen;
+
+	for (auto i = begin(_renderCaches); i != end(_renderCaches);) {
+		const auto top = itemTop(i->first);
+		if (top >= till || top + i->first->height() <= from) {
+			i = _renderCaches.erase(i);
+		} else {
+			++i;
+		}
+	}
+
+	auto context = controller()->preparePaintContext({
+		.theme = _delegate->listChatTheme(),
+		.visibleAreaTop = _visibleTop,
+		.visibleAreaTopGlobal = mapToGlobal(QPoint(0, _visibleTop)).y(),
+		.visibleAreaWidth = width(),
+		.clip = QRect(0, from, width(), till - from),
+	});
+	if (!renderCacheAllowed(context)) {
+		return;
+	}
+	const auto cacheable = [&](not_null<const Element*> view) {
+		const auto height = view->height();
+		const auto range = view->verticalRepaintRange();
+		return (height > 0)
+			&& (height <= till - from)
+			&& (range.top == 0)
+			&& (range.height == height)
+			&& (view != _overElement)
+			&& (_itemRevealAnimations.find(view)
+				== end(_itemRevealAnimations))
+			&& !_renderCaches.contains(view);
+	};
+	const auto ratio = style::DevicePixelRatio();
+	auto rendered = 0;
+	auto i = std::lower_bound(begin(_items), end(_items), from, [&](
+			auto &elem,
+			int top) {
+		return itemTop(elem) + elem->height() <= top;
+	});
+	for (; i != end(_items) && itemTop(*i) < till; ++i) {
+		const auto view = *i;
+		if (!cacheable(view)) {
+			continue;
+		} else if (rendered == kRenderAheadPerPass) {
+			// Leave the rest for the next pass, so scrolling stays smooth.
+			_renderAhead.call();
+			return;
+		}
+		++rendered;
+
+		const auto top = itemTop(view);
+		const auto height = view->height();
+		auto image = QImage(
+			QSize(width(), height) * ratio,
+			QImage::Format_ARGB32_Premultiplied);
+		image.setDevicePixelRatio(ratio);
+		image.fill(Qt::transparent);
+
+		auto local = context.translated(0, -top);
+		local.clip = QRect(0, 0, width(), height);
+		local.outbg = view->hasOutLayout();
+		local.selection = itemRenderSelection(view);
+
+		_renderingCache = true;
+		_renderCacheUsedGradient = false;
+		{
+			Painter q(&image);
+			view->draw(q, local);
+		}
+		_renderingCache = false;
+
+		// Loading placeholders are animated without repaint requests.
+		if (!_renderCacheUsedGradient) {
+			_renderCaches.emplace(view, RenderCache{
+				.image = std::move(image),
+				.selection = local.selection,
+				.width = width(),
+				.height = height,
+			});
+		}
+	}
+}
+
+void ListWidget::clearRenderCaches() {
+	_renderCaches.clear();
+}
+
 void ListWidget::itemRemoved(not_null<const HistoryItem*> item) {
 	if (_selectedTextItem == item) {
 		clearTextSelection();
@@ -340,6 +340,12 @@ private:
 		Ui::Animations::Simple animation;
 		int startHeight = 0;
 	};
+	struct RenderCache {
+		QImage image;
+		TextSelection selection;
+		int width = 0;
+		int height = 0;
+	};
 	enum class Direction {
 		Up,
 		Down,
@@ -408,6 +414,15 @@ private:
 	[[nodiscard]] Element *strictFindItemByY(int y) const;
 	[[nodiscard]] int findNearestItem(Data::MessagePosition position) const;
 	void viewReplaced(not_null<const Element*> was, Element *now);
+
+	[[nodiscard]] bool renderCacheAllowed(
+		const PaintContext &context) const;
+	[[nodiscard]] bool paintFromRenderCache(
+		Painter &p,
+		not_null<const Element*> view,
+		TextSelection selection);
+	void renderAhead();
+	void clearRenderCaches();
 	[[nodiscard]] HistoryItemsList collectVisibleItems() const;
 
 	void checkMoveToOtherViewer();
@@ -585,6 +600,11 @@ private:
 	ClickHandlerPtr _scrollDateLink;
 	SingleQueuedInvokation _applyUpdatedScrollState;
 
+	base::flat_map<not_null<const Element*>, RenderCache> _renderCaches;
+	SingleQueuedInvokation _renderAhead;
+	bool _renderingCache = false;
+	bool _renderCacheUsedGradient = false;
+
 	MessagesBar _bar;
 	rpl::variable<QString> _barText;
 
@@ -358,7 +358,7 @@ QSize Message::performCountOptimalSize() {
 		if (context() == Context::Replies && item->isDiscussionPost()) {
 			maxWidth = std::max(maxWidth, st::msgMaxWidth);
 		}
-		minHeight = hasVisibleText() ? item->_text.minHeight() : 0;
+		minHeight = hasVisibleText() ? item->textLayout().minHeight() : 0;
 		if (reactionsInBubble) {
 			const auto reactionsMaxWidth = st::msgPadding.left()
 				+ _reactions->maxWidth()
@@ -397,8 +397,8 @@ QSize Message::performCountOptimalSize() {
 					- st::msgPadding.left()
 					- st::msgPadding.right();
 				if (hasVisibleText() && maxWidth < plainMaxWidth()) {
-					minHeight -= item->_text.minHeight();
-					minHeight += item->_text.countHeight(innerWidth);
+					minHeight -= item->textLayout().minHeight();
+					minHeight += item->textLayout().countHeight(innerWidth);
 				}
 				if (reactionsInBubble) {
 					minHeight -= _reactions->minHeight();
@@ -1144,7 +1144,7 @@ void Message::paintText(
 	const auto stm = context.messageStyle();
 	p.setPen(stm->historyTextFg);
 	p.setFont(st::msgFont);
-	item->_text.draw(p, trect.x(), trect.y(), trect.width(), style::al_left, 0, -1, context.selection);
+	item->textLayout().draw(p, trect.x(), trect.y(), trect.width(), style::al_left, 0, -1, context.selection);
 }
 
 PointState Message::pointState(QPoint point) const {
@@ -1433,7 +1433,7 @@ TextState Message::textState(
 				result = entry->textState(
 					point - QPoint(entryLeft, entryTop),
 					request);
-				result.symbol += item->_text.length() + (mediaDisplayed ? media->fullSelectionLength() : 0);
+				result.symbol += item->textLayout().length() + (mediaDisplayed ? media->fullSelectionLength() : 0);
 			}
 		}
 
@@ -1459,18 +1459,18 @@ TextState Message::textState(
 
 				if (point.y() >= mediaTop && point.y() < mediaTop + mediaHeight) {
 					result = media->textState(point - QPoint(mediaLeft, mediaTop), request);
-					result.symbol += item->_text.length();
+					result.symbol += item->textLayout().length();
 				} else if (getStateText(point, trect, &result, request)) {
 					checkBottomInfoState();
 					return result;
 				} else if (point.y() >= trect.y() + trect.height()) {
-					result.symbol = item->_text.length();
+					result.symbol = item->textLayout().length();
 				}
 			} else if (getStateText(point, trect, &result, request)) {
 				checkBottomInfoState();
 				return result;
 			} else if (point.y() >= trect.y() + trect.height()) {
-				result.symbol = item->_text.length();
+				result.symbol = item->textLayout().length();
 			}
 		}
 		checkBottomInfoState();
@@ -1492,7 +1492,7 @@ TextState Message::textState(
 		}
 	} else if (media && media->isDisplayed()) {
 		result = media->textState(point - g.topLeft(), request);
-		result.symbol += item->_text.length();
+		result.symbol += item->textLayout().length();
 	}
 
 	if (keyboard && item->isHistoryEntry()) {
@@ -1775,7 +1775,7 @@ bool Message::getStateText(
 	}
 	const auto item = message();
 	if (base::in_range(point.y(), trect.y(), trect.y() + trect.height())) {
-		*outResult = TextState(item, item->_text.getState(
+		*outResult = TextState(item, item->textLayout().getState(
 			point - trect.topLeft(),
 			trect.width(),
 			request.forText()));
@@ -1841,7 +1841,7 @@ TextForMimeData Message::selectedText(TextSelection selection) const {
 	const auto media = this->media();
 
 	auto logEntryOriginalResult = TextForMimeData();
-	auto textResult = item->_text.toTextForMimeData(selection);
+	auto textResult = item->textLayout().toTextForMimeData(selection);
 	auto skipped = skipTextSelection(selection);
 	auto mediaDisplayed = (media && media->isDisplayed());
 	auto mediaResult = (mediaDisplayed || isHiddenByGroup())
@@ -1873,8 +1873,8 @@ TextSelection Message::adjustSelection(
 	const auto item = message();
 	const auto media = this->media();
 
-	auto result = item->_text.adjustSelection(selection, type);
-	auto beforeMediaLength = item->_text.length();
+	auto result = item->textLayout().adjustSelection(selection, type);
+	auto beforeMediaLength = item->textLayout().length();
 	if (selection.to <= beforeMediaLength) {
 		return result;
 	}
@@ -2143,13 +2143,13 @@ void Message::refreshDataIdHook() {
 
 int Message::plainMaxWidth() const {
 	return st::msgPadding.left()
-		+ (hasVisibleText() ? message()->_text.maxWidth() : 0)
+		+ (hasVisibleText() ? message()->textLayout().maxWidth() : 0)
 		+ st::msgPadding.right();
 }
 
 int Message::monospaceMaxWidth() const {
 	return st::msgPadding.left()
-		+ (hasVisibleText() ? message()->_text.countMaxMonospaceWidth() : 0)
+		+ (hasVisibleText() ? message()->textLayout().countMaxMonospaceWidth() : 0)
 		+ st::msgPadding.right();
 }
 
@@ -2662,11 +2662,11 @@ TextSelection Message::skipTextSelection(TextSelection selection) const {
 	if (selection.from == 0xFFFF) {
 		return selection;
 	}
-	return HistoryView::UnshiftItemSelection(selection, message()->_text);
+	return HistoryView::UnshiftItemSelection(selection, message()->textLayout());
 }
 
 TextSelection Message::unskipTextSelection(TextSelection selection) const {
-	return HistoryView::ShiftItemSelection(selection, message()->_text);
+	return HistoryView::ShiftItemSelection(selection, message()->textLayout());
 }
 
 QRect Message::countGeometry() const {
@@ -2800,11 +2800,7 @@ int Message::resizeContentGetHeight(int newWidth) {
 			}
 		} else {
 			if (hasVisibleText()) {
-				if (textWidth != item->_textWidth) {
-					item->_textWidth = textWidth;
-					item->_textHeight = item->_text.countHeight(textWidth);
-				}
-				newHeight = item->_textHeight;
+				newHeight = item->textHeightForWidth(textWidth);
 			} else {
 				newHeight = 0;
 			}
@@ -2922,7 +2918,7 @@ void Message::refreshInfoSkipBlock() {
 	const auto item = message();
 	const auto media = this->media();
 	const auto hasTextSkipBlock = [&] {
-		if (item->_text.isEmpty()) {
+		if (item->textLayout().isEmpty()) {
 			return false;
 		} else if (item->Has<HistoryMessageLogEntryOriginal>()) {
 			return false;
@@ -2943,13 +2939,11 @@ void Message::refreshInfoSkipBlock() {
 		}
 	}
 	if (!hasTextSkipBlock) {
-		if (item->_text.removeSkipBlock()) {
-			item->_textWidth = -1;
-			item->_textHeight = 0;
+		if (item->textLayout().removeSkipBlock()) {
+			item->invalidateTextHeights();
 		}
-	} else if (item->_text.updateSkipBlock(skipWidth, skipHeight)) {
-		item->_textWidth = -1;
-		item->_textHeight = 0;
+	} else if (item->textLayout().updateSkipBlock(skipWidth, skipHeight)) {
+		item->invalidateTextHeights();
 	}
 }
 
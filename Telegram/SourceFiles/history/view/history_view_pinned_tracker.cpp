@@ -18,12 +18,17 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/storage_shared_media.h"
 #include "history/history.h"
 #include "history/history_item.h"
+#include "apiwrap.h"
 
 namespace HistoryView {
 namespace{
 
-constexpr auto kLoadedLimit = 5;
-constexpr auto kChangeViewerLimit = 2;
+// Wider slices let the bar move through many pins without a new viewer.
+constexpr auto kLoadedLimit = 20;
+constexpr auto kChangeViewerLimit = 5;
+
+// Contents of that many pins around the shown one are loaded in advance.
+constexpr auto kPreloadAround = 2;
 
 } // namespace
 
@@ -136,8 +141,10 @@ void PinnedTracker::refreshCurrentFromSlice() {
 			: 1;
 		if (i != begin(_slice.ids)) {
 			_current = PinnedId{ *(i - 1), index - 1, count };
+			preloadAround(int(i - begin(_slice.ids)) - 1);
 		} else if (!_slice.ids.empty()) {
 			_current = PinnedId{ _slice.ids.front(), 0, count };
+			preloadAround(0);
 		} else {
 			_current = PinnedId();
 		}
@@ -147,6 +154,25 @@ void PinnedTracker::refreshCurrentFromSlice() {
 	}
 }
 
+void PinnedTracker::preloadAround(int index) {
+	const auto from = std::max(index - kPreloadAround, 0);
+	const auto till = std::min(
+		index + kPreloadAround + 1,
+		int(_slice.ids.size()));
+	auto &owner = _history->owner();
+	for (auto i = from; i != till; ++i) {
+		const auto id = _slice.ids[i];
+		if (owner.message(id) || _preloaded.contains(id)) {
+			continue;
+		}
+		_preloaded.emplace(id);
+		_history->session().api().requestMessageData(
+			owner.peer(id.peer),
+			id.msg,
+			nullptr);
+	}
+}
+
 void PinnedTracker::clear() {
 	_dataLifetime.destroy();
 	_viewerAroundId = 0;
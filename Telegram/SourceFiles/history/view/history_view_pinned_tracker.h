@@ -43,6 +43,7 @@ private:
 	void clear();
 	void refreshViewer();
 	void refreshCurrentFromSlice();
+	void preloadAround(int index);
 
 	const not_null<History*> _history;
 	PeerData *_migratedPeer = nullptr;
@@ -53,6 +54,7 @@ private:
 	UniversalMsgId _aroundId = 0;
 	UniversalMsgId _viewerAroundId = 0;
 	Slice _slice;
+	base::flat_set<FullMsgId> _preloaded;
 
 	rpl::lifetime _lifetime;
 
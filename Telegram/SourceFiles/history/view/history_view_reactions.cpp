@@ -29,6 +29,12 @@ constexpr auto kOutNonChosenOpacity = 0.18;
 
 } // namespace
 
+bool operator==(const InlineListData &a, const InlineListData &b) {
+	return (a.flags == b.flags)
+		&& (a.chosenReaction == b.chosenReaction)
+		&& (a.reactions == b.reactions);
+}
+
 InlineList::InlineList(
 	not_null<::Data::Reactions*> owner,
 	Fn<ClickHandlerPtr(QString)> handlerFactory,
@@ -40,6 +46,10 @@ InlineList::InlineList(
 }
 
 void InlineList::update(Data &&data, int availableWidth) {
+	if (_data == data) {
+		// Views of the same message get notified for unrelated changes.
+		return;
+	}
 	_data = std::move(data);
 	layout();
 	if (width() > 0) {
@@ -38,6 +38,15 @@ struct InlineListData {
 	Flags flags = {};
 };
 
+[[nodiscard]] bool operator==(
+	const InlineListData &a,
+	const InlineListData &b);
+[[nodiscard]] inline bool operator!=(
+		const InlineListData &a,
+		const InlineListData &b) {
+	return !(a == b);
+}
+
 class InlineList final : public Object {
 public:
 	using Data = InlineListData;
@@ -54,6 +54,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_chat.h"
 #include "data/data_channel.h"
 #include "data/data_replies_list.h"
+#include "data/data_histories.h"
 #include "data/data_peer_values.h"
 #include "data/data_changes.h"
 #include "data/data_send_action.h"
@@ -965,7 +966,8 @@ void RepliesWidget::sendVoice(ComposeControls::VoiceToSend &&data) {
 		data.bytes,
 		data.waveform,
 		data.duration,
-		std::move(action));
+		std::move(action),
+		data.streamedUploadId);
 
 	_composeControls->cancelReplyMessage();
 	_composeControls->clearListenState();
@@ -1572,7 +1574,9 @@ void RepliesWidget::restoreState(not_null<RepliesMemento*> memento) {
 	if (auto replies = memento->getReplies()) {
 		setReplies(std::move(replies));
 	} else if (!_replies) {
-		setReplies(std::make_shared<Data::RepliesList>(_history, _rootId));
+		setReplies(_history->owner().histories().repliesList(
+			_history,
+			_rootId));
 	}
 	restoreReplyReturns(memento->replyReturns());
 	_inner->restoreState(memento->list());
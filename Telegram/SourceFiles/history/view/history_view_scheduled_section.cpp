@@ -50,6 +50,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_message_reactions.h"
 #include "storage/storage_media_prepare.h"
 #include "storage/storage_account.h"
+#include "storage/file_upload.h"
 #include "inline_bots/inline_bot_result.h"
 #include "lang/lang_keys.h"
 #include "facades.h"
@@ -221,6 +222,8 @@ void ScheduledWidget::setupComposeControls() {
 
 	_composeControls->sendVoiceRequests(
 	) | rpl::start_with_next([=](ComposeControls::VoiceToSend &&data) {
+		// The schedule box may be cancelled, upload when it is confirmed.
+		session().uploader().cancelStreamed(data.streamedUploadId);
 		sendVoice(data.bytes, data.waveform, data.duration);
 	}, lifetime());
 
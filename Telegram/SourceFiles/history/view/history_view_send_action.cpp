@@ -167,6 +167,10 @@ bool SendActionPainter::paint(
 	return false;
 }
 
+bool SendActionPainter::animating() const {
+	return _sendActionAnimation || _speakingAnimation;
+}
+
 void SendActionPainter::paintSpeaking(
 		Painter &p,
 		int x,
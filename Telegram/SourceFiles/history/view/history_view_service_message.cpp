@@ -414,8 +414,8 @@ QSize Service::performCountCurrentSize(int newWidth) {
 	const auto item = message();
 	const auto media = this->media();
 
-	if (item->_text.isEmpty()) {
-		item->_textHeight = 0;
+	if (item->textLayout().isEmpty()) {
+		item->invalidateTextHeights();
 	} else {
 		auto contentWidth = newWidth;
 		if (delegate()->elementIsChatWide() && !AdaptiveBubbles()) {
@@ -427,14 +427,10 @@ QSize Service::performCountCurrentSize(int newWidth) {
 		}
 
 		auto nwidth = qMax(contentWidth - st::msgServicePadding.left() - st::msgServicePadding.right(), 0);
-		if (nwidth != item->_textWidth) {
-			item->_textWidth = nwidth;
-			item->_textHeight = item->_text.countHeight(nwidth);
-		}
 		if (contentWidth >= maxWidth()) {
 			newHeight += minHeight();
 		} else {
-			newHeight += item->_textHeight;
+			newHeight += item->textHeightForWidth(nwidth);
 		}
 		newHeight += st::msgServicePadding.top() + st::msgServicePadding.bottom() + st::msgServiceMargin.top() + st::msgServiceMargin.bottom();
 		if (media) {
@@ -449,8 +445,8 @@ QSize Service::performCountOptimalSize() {
 	const auto item = message();
 	const auto media = this->media();
 
-	auto maxWidth = item->_text.maxWidth() + st::msgServicePadding.left() + st::msgServicePadding.right();
-	auto minHeight = item->_text.minHeight();
+	auto maxWidth = item->textLayout().maxWidth() + st::msgServicePadding.left() + st::msgServicePadding.right();
+	auto minHeight = item->textLayout().minHeight();
 	if (media) {
 		media->initDimensions();
 	}
@@ -530,13 +526,13 @@ void Service::draw(Painter &p, const PaintContext &context) const {
 		context.st,
 		g.left(),
 		g.width(),
-		item->_text,
+		item->textLayout(),
 		trect);
 
 	p.setBrush(Qt::NoBrush);
 	p.setPen(st->msgServiceFg());
 	p.setFont(st::msgServiceFont);
-	item->_text.draw(p, trect.x(), trect.y(), trect.width(), Qt::AlignCenter, 0, -1, context.selection, false);
+	item->textLayout().draw(p, trect.x(), trect.y(), trect.width(), Qt::AlignCenter, 0, -1, context.selection, false);
 
 	p.restoreTextPalette();
 
@@ -593,7 +589,7 @@ TextState Service::textState(QPoint point, StateRequest request) const {
 	if (trect.contains(point)) {
 		auto textRequest = request.forText();
 		textRequest.align = style::al_center;
-		result = TextState(item, item->_text.getState(
+		result = TextState(item, item->textLayout().getState(
 			point - trect.topLeft(),
 			trect.width(),
 			textRequest));
@@ -621,13 +617,13 @@ void Service::updatePressed(QPoint point) {
 }
 
 TextForMimeData Service::selectedText(TextSelection selection) const {
-	return message()->_text.toTextForMimeData(selection);
+	return message()->textLayout().toTextForMimeData(selection);
 }
 
 TextSelection Service::adjustSelection(
 		TextSelection selection,
 		TextSelectType type) const {
-	return message()->_text.adjustSelection(selection, type);
+	return message()->textLayout().adjustSelection(selection, type);
 }
 
 EmptyPainter::EmptyPainter(not_null<History*> history) : _history(history) {
@@ -25,6 +25,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/shortcuts.h"
 #include "core/application.h"
 #include "core/core_settings.h"
+#include "core/rpl_profiler.h"
 #include "ui/widgets/buttons.h"
 #include "ui/widgets/dropdown_menu.h"
 #include "ui/effects/radial_animation.h"
@@ -65,6 +66,12 @@ namespace {
 
 constexpr auto kEmojiInteractionSeenDuration = 3 * crl::time(1000);
 
+[[nodiscard]] int StatusTop() {
+	return st::topBarHeight
+		- st::topBarArrowPadding.bottom()
+		- st::dialogsTextFont->height;
+}
+
 } // namespace
 
 struct TopBarWidget::EmojiInteractionSeenAnimation {
@@ -148,8 +155,10 @@ TopBarWidget::TopBarWidget(
 		session().data().sendActionManager().animationUpdated(
 		) | rpl::filter([=](const AnimationUpdate &update) {
 			return (update.history == _activeChat.key.history());
-		}) | rpl::start_with_next([=] {
-			update();
+		}) | rpl::start_with_next([=](const AnimationUpdate &update) {
+			updateSendAction(
+				QRect(update.left, 0, update.width, update.height),
+				update.textUpdated);
 		}, lifetime());
 	}
 
@@ -160,6 +169,8 @@ TopBarWidget::TopBarWidget(
 		| UpdateFlag::Members
 		| UpdateFlag::SupportInfo
 		| UpdateFlag::Rights
+	) | Core::RplProfiler::Site(
+		"TopBar/Peer"
 	) | rpl::start_with_next([=](const Data::PeerUpdate &update) {
 		if (update.flags & UpdateFlag::HasCalls) {
 			if (update.peer->isUser()
@@ -222,9 +233,18 @@ void TopBarWidget::updateConnectingState() {
 }
 
 void TopBarWidget::connectingAnimationCallback() {
-	if (!anim::Disabled()) {
+	if (anim::Disabled()) {
+		return;
+	} else if (showSelectedActions() || _selectedShown.animating()) {
 		update();
+		return;
 	}
+	const auto &st = st::topBarConnectingAnimation;
+	const auto thickness = st.thickness;
+	rtlupdate(QRect(
+		QPoint(_leftTaken, StatusTop()) + st::topBarConnectingPosition,
+		st.size
+	).marginsAdded({ thickness, thickness, thickness, thickness }));
 }
 
 void TopBarWidget::refreshLang() {
@@ -376,6 +396,17 @@ int TopBarWidget::resizeGetHeight(int newWidth) {
 	return st::topBarHeight;
 }
 
+void TopBarWidget::updateSendAction(QRect animation, bool textUpdated) {
+	if (textUpdated
+		|| showSelectedActions()
+		|| _selectedShown.animating()) {
+		this->update();
+		return;
+	}
+	// Repaint only the animation, it runs each frame while someone types.
+	rtlupdate(animation.translated(_leftTaken, StatusTop()));
+}
+
 void TopBarWidget::paintEvent(QPaintEvent *e) {
 	if (_animatingMode) {
 		return;
@@ -398,7 +429,7 @@ void TopBarWidget::paintTopBar(Painter &p) {
 	}
 	auto nameleft = _leftTaken;
 	auto nametop = st::topBarArrowPadding.top();
-	auto statustop = st::topBarHeight - st::topBarArrowPadding.bottom() - st::dialogsTextFont->height;
+	auto statustop = StatusTop();
 	auto availableWidth = width() - _rightTaken - nameleft;
 
 	if (_chooseForReportReason) {
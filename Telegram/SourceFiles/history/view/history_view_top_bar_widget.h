@@ -128,6 +128,7 @@ private:
 	void connectingAnimationCallback();
 
 	void paintTopBar(Painter &p);
+	void updateSendAction(QRect animation, bool textUpdated);
 	void paintStatus(
 		Painter &p,
 		int left,
@@ -149,6 +149,7 @@ Document::Document(
 	}
 
 	setDocumentLinks(_data, realParent);
+	warmUpDownload(_data);
 
 	setStatusSize(Ui::FileStatusSizeReady);
 
@@ -503,7 +504,7 @@ void Document::draw(
 		if (const auto voiceData = _data->voice()) {
 			if (voiceData->waveform.isEmpty()) {
 				if (loaded) {
-					Local::countVoiceWaveform(_dataMedia.get());
+					Local::countWaveform(_dataMedia.get());
 				}
 			}
 		}
@@ -13,8 +13,14 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history.h"
 #include "history/view/history_view_element.h"
 #include "data/data_document.h"
+#include "data/data_photo.h"
+#include "data/data_photo_media.h"
+#include "data/data_auto_download.h"
 #include "data/data_file_click_handler.h"
 #include "data/data_session.h"
+#include "main/main_session.h"
+#include "main/main_session_settings.h"
+#include "storage/download_manager_mtproto.h"
 #include "styles/style_chat.h"
 
 namespace HistoryView {
@@ -134,6 +140,35 @@ void File::setDocumentLinks(
 			context));
 }
 
+void File::warmUpDownload(not_null<DocumentData*> document) const {
+	if (document->status != FileReady
+		|| document->cancelled()
+		|| document->loadedInMediaCache()
+		|| !document->location().isEmpty()
+		|| !Data::AutoDownload::Should(
+			document->session().settings().autoDownload(),
+			_realParent->history()->peer,
+			document)) {
+		return;
+	}
+	document->session().downloader().warmUp(document->dcId());
+}
+
+void File::warmUpDownload(not_null<PhotoData*> photo) const {
+	const auto media = photo->activeMediaView();
+	if (photo->loading()
+		|| photo->uploading()
+		|| (media && media->loaded())
+		|| !photo->location(Data::PhotoSize::Large).valid()
+		|| !Data::AutoDownload::Should(
+			photo->session().settings().autoDownload(),
+			_realParent->history()->peer,
+			photo)) {
+		return;
+	}
+	photo->session().downloader().warmUp(photo->dcId());
+}
+
 File::~File() = default;
 
 } // namespace HistoryView
@@ -54,6 +54,11 @@ protected:
 		not_null<DocumentData*> document,
 		not_null<HistoryItem*> realParent);
 
+	// Connect the download session in advance, but only if the file
+	// is going to be loaded automatically.
+	void warmUpDownload(not_null<DocumentData*> document) const;
+	void warmUpDownload(not_null<PhotoData*> photo) const;
+
 	// >= 0 will contain download / upload string, _statusSize = loaded bytes
 	// < 0 will contain played string, _statusSize = -(seconds + 1) played
 	// 0x7FFFFFF0 will contain status for not yet downloaded file
@@ -79,6 +79,7 @@ Gif::Gif(
 , _caption(st::minPhotoSize - st::msgPadding.left() - st::msgPadding.right())
 , _downloadSize(Ui::FormatSizeText(_data->size)) {
 	setDocumentLinks(_data, realParent);
+	warmUpDownload(_data);
 
 	setStatusSize(Ui::FileStatusSizeReady);
 
@@ -94,6 +95,7 @@ Gif::Gif(
 }
 
 Gif::~Gif() {
+	_data->owner().streaming().releaseAutoplay(this);
 	if (_streamed || _dataMedia) {
 		if (_streamed) {
 			_data->owner().streaming().keepAlive(_data);
@@ -1472,6 +1474,12 @@ void Gif::playAnimation(bool autoplay) {
 	} else if (_dataMedia->canBePlayed(_realParent)) {
 		if (!autoplayEnabled()) {
 			history()->owner().checkPlayingAnimations();
+		} else if (autoplay
+			&& !_data->owner().streaming().requestAutoplay(
+				_data,
+				this,
+				[=] { history()->owner().requestViewRepaint(_parent); })) {
+			return;
 		}
 		createStreamedPlayer();
 	}
@@ -1482,6 +1490,7 @@ void Gif::createStreamedPlayer() {
 		_data,
 		_realParent->fullId());
 	if (!shared) {
+		_data->owner().streaming().releaseAutoplay(this);
 		return;
 	}
 	setStreamed(std::make_unique<Streamed>(
@@ -1532,6 +1541,7 @@ void Gif::setStreamed(std::unique_ptr<Streamed> value) {
 	if (set) {
 		history()->owner().registerHeavyViewPart(_parent);
 	} else if (removed) {
+		_data->owner().streaming().releaseAutoplay(this);
 		_parent->checkHeavyPart();
 	}
 }
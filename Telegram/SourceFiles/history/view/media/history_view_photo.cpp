@@ -86,6 +86,7 @@ Photo::~Photo() {
 }
 
 void Photo::create(FullMsgId contextId, PeerData *chat) {
+	warmUpDownload(_data);
 	setLinks(
 		std::make_shared<PhotoOpenClickHandler>(
 			_data,
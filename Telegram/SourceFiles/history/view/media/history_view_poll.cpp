@@ -48,6 +48,7 @@ constexpr auto kScaleAmplitude = 0.03;
 constexpr auto kRollDuration = crl::time(400);
 constexpr auto kLargestRadialDuration = 30 * crl::time(1000);
 constexpr auto kCriticalCloseDuration = 5 * crl::time(1000);
+constexpr auto kVotesUpdateMinInterval = crl::time(1000);
 
 struct PercentCounterItem {
 	int index = 0;
@@ -231,7 +232,8 @@ Poll::Poll(
 , _sendVotesLink(
 	std::make_shared<LambdaClickHandler>(crl::guard(
 		this,
-		[=] { sendMultiOptions(); }))) {
+		[=] { sendMultiOptions(); })))
+, _votesUpdateTimer([=] { history()->owner().requestViewResize(_parent); }) {
 	history()->owner().registerPollView(_poll, _parent);
 }
 
@@ -371,6 +373,8 @@ QSize Poll::countCurrentSize(int newWidth) {
 void Poll::updateTexts() {
 	if (_pollVersion == _poll->version) {
 		return;
+	} else if (_pollVersion && delayVotesUpdate()) {
+		return;
 	}
 	const auto first = !_pollVersion;
 	_pollVersion = _poll->version;
@@ -416,6 +420,29 @@ void Poll::updateTexts() {
 		first ? anim::type::instant : anim::type::normal);
 }
 
+bool Poll::delayVotesUpdate() {
+	// Live polls may get many votes each second, show them not that often.
+	const auto now = crl::now();
+	const auto onlyVotesChanged = (_flags == _poll->flags())
+		&& (_voted == _poll->voted())
+		&& _poll->sendingVotes.empty()
+		&& ranges::equal(
+			_answers,
+			_poll->answers,
+			ranges::equal_to(),
+			&Answer::option,
+			&PollAnswer::option);
+	const auto till = _votesUpdated + kVotesUpdateMinInterval;
+	if (!onlyVotesChanged || now >= till) {
+		_votesUpdated = now;
+		_votesUpdateTimer.cancel();
+		return false;
+	} else if (!_votesUpdateTimer.isActive()) {
+		_votesUpdateTimer.callOnce(till - now);
+	}
+	return true;
+}
+
 void Poll::checkQuizAnswered() {
 	if (!_voted || !_votedFromHere || !_poll->quiz() || anim::Disabled()) {
 		return;
@@ -1493,7 +1520,12 @@ void Poll::paintBubbleFireworks(
 		Painter &p,
 		const QRect &bubble,
 		crl::time ms) const {
-	if (!_fireworksAnimation || _fireworksAnimation->paint(p, bubble)) {
+	if (!_fireworksAnimation) {
+		return;
+	}
+	_fireworksAnimation->setPaused(
+		_parent->delegate()->elementIsGifPaused());
+	if (_fireworksAnimation->paint(p, bubble)) {
 		return;
 	}
 	_fireworksAnimation = nullptr;
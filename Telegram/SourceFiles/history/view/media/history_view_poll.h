@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/effects/animations.h"
 #include "data/data_poll.h"
 #include "base/weak_ptr.h"
+#include "base/timer.h"
 
 namespace Data {
 class CloudImageView;
@@ -89,6 +90,7 @@ private:
 	[[nodiscard]] ClickHandlerPtr createAnswerClickHandler(
 		const Answer &answer);
 	void updateTexts();
+	[[nodiscard]] bool delayVotesUpdate();
 	void updateRecentVoters();
 	void updateAnswers();
 	void updateVotes();
@@ -226,6 +228,9 @@ private:
 	bool _votedFromHere = false;
 	mutable bool _wrongAnswerAnimated = false;
 
+	base::Timer _votesUpdateTimer;
+	crl::time _votesUpdated = 0;
+
 };
 
 } // namespace HistoryView
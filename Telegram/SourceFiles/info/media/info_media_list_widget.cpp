@@ -18,6 +18,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_peer_values.h"
 #include "data/data_document.h"
 #include "data/data_session.h"
+#include "data/data_documents_saver.h"
 #include "data/data_file_click_handler.h"
 #include "data/data_file_origin.h"
 #include "history/history_item.h"
@@ -42,7 +43,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "boxes/delete_messages_box.h"
 #include "boxes/peer_list_controllers.h"
 #include "core/file_utilities.h"
+#include "core/paint_profiler.h"
 #include "facades.h"
+#include "kotato/kotato_lang.h"
 #include "styles/style_overview.h"
 #include "styles/style_info.h"
 #include "styles/style_menu_icons.h"
@@ -1446,6 +1449,7 @@ QMargins ListWidget::padding() const {
 }
 
 void ListWidget::paintEvent(QPaintEvent *e) {
+	const auto profile = Core::PaintProfiler::Scope("Info/Media");
 	Painter p(this);
 
 	auto outerWidth = width();
@@ -1576,6 +1580,14 @@ void ListWidget::showContextMenu(
 			return !item.second.canForward;
 		});
 	};
+	auto canSaveAny = [&] {
+		return ranges::any_of(_selected, [&](auto &&item) {
+			const auto message = session().data().message(
+				computeFullId(item.first));
+			const auto media = message ? message->media() : nullptr;
+			return media && (media->document() || media->photo());
+		});
+	};
 
 	auto link = ClickHandler::getActive();
 
@@ -1678,6 +1690,14 @@ void ListWidget::showContextMenu(
 				}),
 				&st::menuIconForward);
 		}
+		if (canSaveAny()) {
+			_contextMenu->addAction(
+				ktr("ktg_context_save_selected"),
+				crl::guard(this, [this] {
+					saveSelected();
+				}),
+				&st::menuIconDownload);
+		}
 		if (canDeleteAll()) {
 			_contextMenu->addAction(
 				tr::lng_context_delete_selected(tr::now),
@@ -1752,6 +1772,24 @@ void ListWidget::forwardSelected() {
 	}
 }
 
+void ListWidget::saveSelected() {
+	auto items = collectSelectedIds();
+	if (items.empty()) {
+		return;
+	}
+	const auto session = &this->session();
+	FileDialog::GetFolder(
+		this,
+		tr::lng_download_path_choose(tr::now),
+		cDialogLastPath(),
+		crl::guard(session, [=](QString &&folder) {
+			if (!folder.isEmpty()) {
+				session->data().documentsSaver().save(items, folder);
+			}
+		}));
+	clearSelected();
+}
+
 void ListWidget::forwardItem(UniversalMsgId universalId) {
 	if (const auto item = session().data().message(computeFullId(universalId))) {
 		forwardItems({ 1, item->fullId() });
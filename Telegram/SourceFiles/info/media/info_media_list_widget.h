@@ -216,6 +216,7 @@ private:
 	bool hasSelectedItems() const;
 	void clearSelected();
 	void forwardSelected();
+	void saveSelected();
 	void forwardItem(UniversalMsgId universalId);
 	void forwardItems(MessageIdsList &&items);
 	void deleteSelected();
@@ -142,13 +142,19 @@ void Gif::paint(Painter &p, const QRect &clip, const PaintContext *context) cons
 	const auto document = getShownDocument();
 	ensureDataMediaCreated(document);
 	const auto preview = Data::VideoPreviewState(_dataMedia.get());
-	preview.automaticLoad(fileOrigin());
+
+	// With hover play only the hovered tile loads and plays the animation.
+	const auto playing = !cGifsPanelHoverPlay() || (_state & StateFlag::Over);
+	if (playing) {
+		preview.automaticLoad(fileOrigin());
+	}
 
 	const auto displayLoading = !preview.usingThumbnail()
 		&& document->displayLoading();
 	const auto loaded = preview.loaded();
 	const auto loading = preview.loading();
-	if (loaded
+	if (playing
+		&& loaded
 		&& !_gif
 		&& !_gif.isBad()
 		&& CanPlayInline(document)) {
@@ -190,7 +196,11 @@ void Gif::paint(Painter &p, const QRect &clip, const PaintContext *context) cons
 
 	if (radial
 		|| _gif.isBad()
-		|| (!_gif && !loaded && !loading && !preview.usingThumbnail())) {
+		|| (playing
+			&& !_gif
+			&& !loaded
+			&& !loading
+			&& !preview.usingThumbnail())) {
 		auto radialOpacity = (radial && loaded) ? _animation->radial.opacity() : 1.;
 		if (_animation && _animation->_a_over.animating()) {
 			auto over = _animation->_a_over.value(1.);
@@ -274,6 +284,16 @@ void Gif::clickHandlerActiveChanged(const ClickHandlerPtr &p, bool active) {
 			} else {
 				_state &= ~StateFlag::Over;
 			}
+			if (cGifsPanelHoverPlay()) {
+				if (!active) {
+					// Free the decoder, the tile goes back to _thumb: the
+					// first played frame or the static thumbnail.
+					_gif.reset();
+				} else if (_dataMedia) {
+					_dataMedia->videoThumbnailWanted(fileOrigin());
+				}
+				update();
+			}
 		}
 	}
 	ItemBase::clickHandlerActiveChanged(p, active);
@@ -343,7 +363,9 @@ void Gif::ensureDataMediaCreated(not_null<DocumentData*> document) const {
 	}
 	_dataMedia = document->createMediaView();
 	_dataMedia->thumbnailWanted(fileOrigin());
-	_dataMedia->videoThumbnailWanted(fileOrigin());
+	if (!cGifsPanelHoverPlay()) {
+		_dataMedia->videoThumbnailWanted(fileOrigin());
+	}
 }
 
 void Gif::ensureAnimation() const {
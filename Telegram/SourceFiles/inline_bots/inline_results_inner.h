@@ -58,6 +58,7 @@ struct CacheEntry {
 	QString nextOffset;
 	QString switchPmText, switchPmStartToken;
 	Results results;
+	crl::time expires = 0; // Computed from the cache_time of the bot.
 };
 
 class Inner
@@ -74,6 +75,7 @@ public:
 
 	int refreshInlineRows(PeerData *queryPeer, UserData *bot, const CacheEntry *results, bool resultsDeleted);
 	void inlineBotChanged();
+	void deleteUnusedInlineLayouts();
 	void hideInlineRowsPanel();
 	void clearInlineRowsPanel();
 
@@ -138,8 +140,6 @@ private:
 	void clearInlineRows(bool resultsDeleted);
 	ItemBase *layoutPrepareInlineResult(Result *result);
 
-	void deleteUnusedInlineLayouts();
-
 	int validateExistingInlineRows(const Results &results);
 	void selectInlineResult(
 		int index,
@@ -336,9 +336,13 @@ void Widget::inlineBotChanged() {
 
 	_api.request(base::take(_inlineRequestId)).cancel();
 	_inlineQuery = _inlineNextQuery = _inlineNextOffset = QString();
+	if (!_inlineCache.empty()) {
+		_otherCaches[{ _inlineBot, _inlineQueryPeer }] = base::take(
+			_inlineCache);
+	}
 	_inlineBot = nullptr;
-	_inlineCache.clear();
 	_inner->inlineBotChanged();
+	clearExpiredCache();
 	_inner->hideInlineRowsPanel();
 
 	_requesting.fire(false);
@@ -361,6 +365,8 @@ void Widget::inlineResultsDone(const MTPmessages_BotResults &result) {
 			it = _inlineCache.emplace(
 				_inlineQuery,
 				std::make_unique<CacheEntry>()).first;
+			it->second->expires = crl::now()
+				+ d.vcache_time().v * crl::time(1000);
 		}
 		auto entry = it->second.get();
 		entry->nextOffset = qs(d.vnext_offset().value_or_empty());
@@ -401,14 +407,20 @@ void Widget::inlineResultsDone(const MTPmessages_BotResults &result) {
 
 void Widget::queryInlineBot(UserData *bot, PeerData *peer, QString query) {
 	bool force = false;
-	_inlineQueryPeer = peer;
-	if (bot != _inlineBot) {
+	if (bot != _inlineBot || peer != _inlineQueryPeer) {
 		inlineBotChanged();
 		_inlineBot = bot;
+		_inlineQueryPeer = peer;
+		const auto i = _otherCaches.find({ bot, peer });
+		if (i != end(_otherCaches)) {
+			_inlineCache = std::move(i->second);
+			_otherCaches.erase(i);
+		}
 		force = true;
 	}
 
 	if (_inlineQuery != query || force) {
+		clearExpiredCache();
 		if (_inlineRequestId) {
 			_api.request(_inlineRequestId).cancel();
 			_inlineRequestId = 0;
@@ -425,6 +437,41 @@ void Widget::queryInlineBot(UserData *bot, PeerData *peer, QString query) {
 	}
 }
 
+void Widget::clearExpiredCache() {
+	const auto now = crl::now();
+	const auto expired = [&](const Cache::value_type &pair) {
+		// Results for the current query may be shown right now.
+		return (pair.second->expires <= now) && (pair.first != _inlineQuery);
+	};
+	auto removed = false;
+	for (auto i = begin(_inlineCache); i != end(_inlineCache);) {
+		if (expired(*i)) {
+			i = _inlineCache.erase(i);
+			removed = true;
+		} else {
+			++i;
+		}
+	}
+	for (auto i = begin(_otherCaches); i != end(_otherCaches);) {
+		auto &cache = i->second;
+		for (auto j = begin(cache); j != end(cache);) {
+			if (j->second->expires <= now) {
+				j = cache.erase(j);
+			} else {
+				++j;
+			}
+		}
+		if (cache.empty()) {
+			i = _otherCaches.erase(i);
+		} else {
+			++i;
+		}
+	}
+	if (removed) {
+		_inner->deleteUnusedInlineLayouts();
+	}
+}
+
 void Widget::onInlineRequest() {
 	if (_inlineRequestId || !_inlineBot || !_inlineQueryPeer) return;
 	_inlineQuery = _inlineNextQuery;
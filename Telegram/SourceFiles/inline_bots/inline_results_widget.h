@@ -118,6 +118,7 @@ private:
 	void updateContentHeight();
 
 	void inlineBotChanged();
+	void clearExpiredCache();
 	int showInlineRows(bool newResults);
 	void recountContentMaxHeight();
 	bool refreshInlineRows(int *added = nullptr);
@@ -145,7 +146,11 @@ private:
 	object_ptr<Ui::ScrollArea> _scroll;
 	QPointer<Inner> _inner;
 
-	std::map<QString, std::unique_ptr<CacheEntry>> _inlineCache;
+	using Cache = std::map<QString, std::unique_ptr<CacheEntry>>;
+	Cache _inlineCache;
+
+	// Results of other bots are kept until their cache_time ends.
+	base::flat_map<std::pair<UserData*, PeerData*>, Cache> _otherCaches;
 	base::Timer _inlineRequestTimer;
 
 	UserData *_inlineBot = nullptr;
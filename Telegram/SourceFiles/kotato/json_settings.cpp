@@ -24,6 +24,7 @@ https://github.com/kotatogram/kotatogram-desktop/blob/dev/LEGAL
 #include <QtCore/QJsonArray>
 #include <QtCore/QJsonValue>
 #include <QtCore/QTimer>
+#include <QtCore/QSaveFile>
 
 namespace Kotato {
 namespace JsonSettings {
@@ -188,7 +189,7 @@ bool ReadBoolOption(QJsonObject obj, QString key, std::function<void(bool)> call
 	return (readValueResult && readResult);
 }
 
-QByteArray GenerateSettingsJson(bool areDefault = false) {
+QJsonObject GenerateSettingsObject(bool areDefault = false) {
 	auto settings = QJsonObject();
 
 	auto settingsFonts = QJsonObject();
@@ -398,6 +399,22 @@ QByteArray GenerateSettingsJson(bool areDefault = false) {
 	settings.insert(qsl("forward_force_old_unquoted"), cForwardForceOld());
 	settings.insert(qsl("disable_chat_themes"), cDisableChatThemes());
 	settings.insert(qsl("remember_compress_images"), cRememberCompressImages());
+	settings.insert(qsl("decoded_images_cache_size"), cDecodedImagesCacheSize());
+	settings.insert(qsl("history_render_cache"), cHistoryRenderCache());
+	settings.insert(qsl("hw_video_decoding"), cHardwareVideoDecoding());
+	settings.insert(qsl("compress_videos"), cCompressVideos());
+	settings.insert(qsl("compact_photos"), cCompactPhotos());
+	settings.insert(qsl("gifs_panel_hover_play"), cGifsPanelHoverPlay());
+	settings.insert(qsl("export_file_requests_count"), cExportFileRequestsCount());
+
+	auto settingsDownloadLimits = QJsonObject();
+	settingsDownloadLimits.insert(qsl("total"), cDownloadSpeedLimit());
+	settingsDownloadLimits.insert(qsl("streaming"), cStreamingDownloadSpeedLimit());
+	settingsDownloadLimits.insert(qsl("user"), cUserDownloadSpeedLimit());
+	settingsDownloadLimits.insert(qsl("auto"), cAutoDownloadSpeedLimit());
+	settings.insert(qsl("download_speed_limits"), settingsDownloadLimits);
+	settings.insert(qsl("audio_latency"), cAudioLatency());
+	settings.insert(qsl("record_call_stats"), cRecordCallStats());
 
 	settingsFonts.insert(qsl("size"), cFontSize());
 	settingsFonts.insert(qsl("use_system_font"), cUseSystemFont());
@@ -415,15 +432,59 @@ QByteArray GenerateSettingsJson(bool areDefault = false) {
 	settings.insert(qsl("scales"), settingsScales);
 	settings.insert(qsl("replaces"), settingsReplaces);
 
+	return settings;
+}
+
+QByteArray SerializeSettings(const QJsonObject &settings) {
 	auto document = QJsonDocument();
 	document.setObject(settings);
 	return document.toJson(QJsonDocument::Indented);
 }
 
+QByteArray GenerateSettingsJson(bool areDefault = false) {
+	return SerializeSettings(GenerateSettingsObject(areDefault));
+}
+
 std::unique_ptr<Manager> Data;
 
 } // namespace
 
+// Lives on its own queue, the settings snapshot is taken on the main
+// thread and only serialized and written here.
+class Manager::Writer final {
+public:
+	void write(const QJsonObject &settings);
+
+private:
+	QByteArray _lastWritten;
+
+};
+
+void Manager::Writer::write(const QJsonObject &settings) {
+	const char *customHeader = R"HEADER(
+// This file was automatically generated from current settings
+// It's better to edit it with app closed, so there will be no rewrites
+// You should restart app to see changes
+
+)HEADER";
+	const auto content = customHeader + SerializeSettings(settings);
+	if (content == _lastWritten) {
+		return;
+	}
+	auto file = QSaveFile(CustomFilePath());
+	if (!file.open(QIODevice::WriteOnly)) {
+		LOG(("Kotato Error: Could not open '%1' for writing."
+			).arg(CustomFilePath()));
+		return;
+	}
+	file.write(content);
+	if (!file.commit()) {
+		LOG(("Kotato Error: Could not commit '%1'.").arg(CustomFilePath()));
+		return;
+	}
+	_lastWritten = content;
+}
+
 Manager::Manager() {
 	_jsonWriteTimer.setSingleShot(true);
 	connect(&_jsonWriteTimer, SIGNAL(timeout()), this, SLOT(writeTimeout()));
@@ -438,10 +499,14 @@ void Manager::fill() {
 	}
 }
 
+Manager::~Manager() = default;
+
 void Manager::write(bool force) {
 	if (force && _jsonWriteTimer.isActive()) {
 		_jsonWriteTimer.stop();
-		writeTimeout();
+		writeCurrentSettings(true);
+	} else if (force) {
+		waitForWrites();
 	} else if (!force && !_jsonWriteTimer.isActive()) {
 		_jsonWriteTimer.start(kWriteJsonTimeout);
 	}
@@ -997,6 +1062,66 @@ bool Manager::readCustomFile() {
 	ReadBoolOption(settings, "remember_compress_images", [&](auto v) {
 		cSetRememberCompressImages(v);
 	});
+
+	ReadIntOption(settings, "decoded_images_cache_size", [&](auto v) {
+		if (v >= 0 && v <= 512) {
+			cSetDecodedImagesCacheSize(v);
+		}
+	});
+
+	ReadBoolOption(settings, "history_render_cache", [&](auto v) {
+		cSetHistoryRenderCache(v);
+	});
+
+	ReadBoolOption(settings, "hw_video_decoding", [&](auto v) {
+		cSetHardwareVideoDecoding(v);
+	});
+
+	ReadBoolOption(settings, "compress_videos", [&](auto v) {
+		cSetCompressVideos(v);
+	});
+
+	ReadBoolOption(settings, "compact_photos", [&](auto v) {
+		cSetCompactPhotos(v);
+	});
+
+	ReadBoolOption(settings, "gifs_panel_hover_play", [&](auto v) {
+		cSetGifsPanelHoverPlay(v);
+	});
+
+	ReadIntOption(settings, "export_file_requests_count", [&](auto v) {
+		if (v >= 1 && v <= 8) {
+			cSetExportFileRequestsCount(v);
+		}
+	});
+
+	ReadObjectOption(settings, "download_speed_limits", [&](auto o) {
+		ReadIntOption(o, "total", [&](auto v) {
+			cSetDownloadSpeedLimit(std::max(v, 0));
+		});
+
+		ReadIntOption(o, "streaming", [&](auto v) {
+			cSetStreamingDownloadSpeedLimit(std::max(v, 0));
+		});
+
+		ReadIntOption(o, "user", [&](auto v) {
+			cSetUserDownloadSpeedLimit(std::max(v, 0));
+		});
+
+		ReadIntOption(o, "auto", [&](auto v) {
+			cSetAutoDownloadSpeedLimit(std::max(v, 0));
+		});
+	});
+
+	ReadIntOption(settings, "audio_latency", [&](auto v) {
+		if (v == 0 || (v >= 5 && v <= 200)) {
+			cSetAudioLatency(v);
+		}
+	});
+
+	ReadBoolOption(settings, "record_call_stats", [&](auto v) {
+		cSetRecordCallStats(v);
+	});
 	return true;
 }
 
@@ -1015,22 +1140,25 @@ void Manager::writeDefaultFile() {
 	file.write(GenerateSettingsJson(true));
 }
 
-void Manager::writeCurrentSettings() {
-	auto file = QFile(CustomFilePath());
-	if (!file.open(QIODevice::WriteOnly)) {
-		return;
-	}
+void Manager::writeCurrentSettings(bool sync) {
 	if (_jsonWriteTimer.isActive()) {
 		writing();
 	}
-	const char *customHeader = R"HEADER(
-// This file was automatically generated from current settings
-// It's better to edit it with app closed, so there will be no rewrites
-// You should restart app to see changes
+	_writer.with([settings = GenerateSettingsObject()](Writer &writer) {
+		writer.write(settings);
+	});
+	if (sync) {
+		waitForWrites();
+	}
+}
 
-)HEADER";
-	file.write(customHeader);
-	file.write(GenerateSettingsJson());
+void Manager::waitForWrites() {
+	// On quit wait for the queue, so the last write isn't lost.
+	auto done = crl::semaphore();
+	_writer.with([&](Writer &writer) {
+		done.release();
+	});
+	done.acquire();
 }
 
 void Manager::writeTimeout() {
@@ -8,6 +8,7 @@ https://github.com/kotatogram/kotatogram-desktop/blob/dev/LEGAL
 #pragma once
 
 #include <QtCore/QTimer>
+#include <crl/crl_object_on_queue.h>
 
 namespace Kotato {
 namespace JsonSettings {
@@ -17,6 +18,8 @@ class Manager : public QObject {
 
 public:
 	Manager();
+	~Manager();
+
 	void fill();
 	void write(bool force = false);
 
@@ -24,12 +27,16 @@ public Q_SLOTS:
 	void writeTimeout();
 
 private:
+	class Writer;
+
 	void writeDefaultFile();
-	void writeCurrentSettings();
+	void writeCurrentSettings(bool sync = false);
+	void waitForWrites();
 	bool readCustomFile();
 	void writing();
 
 	QTimer _jsonWriteTimer;
+	crl::object_on_queue<Writer> _writer;
 
 };
 
@@ -296,3 +296,20 @@ bool gForwardForceOld = false;
 
 bool gDisableChatThemes = false;
 bool gRememberCompressImages = true;
+
+int gDecodedImagesCacheSize = 16;
+
+bool gHistoryRenderCache = false;
+
+bool gHardwareVideoDecoding = false;
+
+bool gCompressVideos = false;
+bool gCompactPhotos = false;
+bool gGifsPanelHoverPlay = false;
+int gExportFileRequestsCount = 2;
+int gDownloadSpeedLimit = 0;
+int gStreamingDownloadSpeedLimit = 0;
+int gUserDownloadSpeedLimit = 0;
+int gAutoDownloadSpeedLimit = 0;
+int gAudioLatency = 0;
+bool gRecordCallStats = false;
@@ -188,3 +188,24 @@ DeclareSetting(bool, ForwardForceOld);
 
 DeclareSetting(bool, DisableChatThemes);
 DeclareSetting(bool, RememberCompressImages);
+
+// In megabytes, zero disables keeping decoded thumbnails in memory.
+DeclareSetting(int, DecodedImagesCacheSize);
+
+DeclareSetting(bool, HistoryRenderCache);
+
+DeclareSetting(bool, HardwareVideoDecoding);
+
+DeclareSetting(bool, CompressVideos);
+DeclareSetting(bool, CompactPhotos);
+DeclareSetting(bool, GifsPanelHoverPlay);
+DeclareSetting(int, ExportFileRequestsCount);
+DeclareSetting(int, DownloadSpeedLimit);
+DeclareSetting(int, StreamingDownloadSpeedLimit);
+DeclareSetting(int, UserDownloadSpeedLimit);
+DeclareSetting(int, AutoDownloadSpeedLimit);
+
+// In milliseconds, zero keeps the audio server defaults.
+// Applies to all the audio of the app on Linux, calls included.
+DeclareSetting(int, AudioLatency);
+DeclareSetting(bool, RecordCallStats);
@@ -775,6 +775,7 @@ void SetupKotatoOther(
 		Core::App().settings().setSendFilesWay(way);
 		Core::App().saveSettingsDelayed();
 	}, container->lifetime());
+	SettingsMenuCSwitch(ktg_settings_compact_photos, CompactPhotos);
 	SettingsMenuCSwitch(ktg_settings_ffmpeg_multithread, FFmpegMultithread);
 
 	AddSkip(container);
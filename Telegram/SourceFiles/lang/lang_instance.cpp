@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "lang/lang_instance.h"
 
 #include "core/application.h"
+#include "core/version.h"
 #include "storage/serialize_common.h"
 #include "storage/localstorage.h"
 #include "ui/boxes/confirm_box.h"
@@ -24,6 +25,14 @@ constexpr auto kDefaultLanguage = "en"_cs;
 constexpr auto kCloudLangPackName = "tdesktop"_cs;
 constexpr auto kCustomLanguage = "#custom"_cs;
 constexpr auto kLangValuesLimit = 20000;
+constexpr auto kCompiledTag = quint32(0x4C414E47); // 'LANG'
+
+// Parsed values are appended to the serialized pack as a key index into
+// a single UTF-16 pool, so a cached pack is loaded without parsing.
+// Key indices change between builds, so the block is checked against
+// the application version and the keys count.
+constexpr auto kCompiledOwn = uchar(0x01);
+constexpr auto kCompiledBase = uchar(0x02);
 
 std::vector<QString> PrepareDefaultValues() {
 	auto result = std::vector<QString>();
@@ -212,6 +221,12 @@ void ParseKeyValue(
 
 } // namespace
 
+struct Instance::CompiledValue {
+	ushort key = 0;
+	uchar flags = 0;
+	QString value;
+};
+
 QString DefaultLanguageId() {
 	return kDefaultLanguage.utf16();
 }
@@ -420,6 +435,91 @@ QByteArray Instance::serialize() const {
 			stream << nonDefault.first << nonDefault.second;
 		}
 		stream << base;
+		if (!_derived) {
+			writeCompiled(stream);
+		}
+	}
+	return result;
+}
+
+void Instance::writeCompiled(QDataStream &stream) const {
+	auto keys = QByteArray();
+	auto pool = QByteArray();
+	auto count = quint32(0);
+	{
+		QDataStream keysStream(&keys, QIODevice::WriteOnly);
+		keysStream.setVersion(QDataStream::Qt_5_1);
+		for (auto i = 0; i != kKeysCount; ++i) {
+			const auto flags = uchar(
+				(_nonDefaultSet[i] ? kCompiledOwn : 0)
+				| ((_base && _base->_nonDefaultSet[i]) ? kCompiledBase : 0));
+			if (!flags) {
+				continue;
+			}
+			const auto &value = _values[i];
+			keysStream
+				<< quint16(i)
+				<< quint8(flags)
+				<< quint32(pool.size() / sizeof(QChar))
+				<< quint32(value.size());
+			pool.append(
+				reinterpret_cast<const char*>(value.constData()),
+				value.size() * sizeof(QChar));
+			++count;
+		}
+	}
+	stream
+		<< kCompiledTag
+		<< qint32(AppVersion)
+		<< qint32(kKeysCount)
+		<< count
+		<< keys
+		<< pool;
+}
+
+auto Instance::readCompiled(QDataStream &stream) const
+-> std::optional<std::vector<CompiledValue>> {
+	if (stream.atEnd()) {
+		return std::nullopt;
+	}
+	auto tag = quint32();
+	auto version = qint32();
+	auto keysCount = qint32();
+	auto count = quint32();
+	auto keys = QByteArray();
+	auto pool = QByteArray();
+	stream >> tag >> version >> keysCount >> count >> keys >> pool;
+	if (stream.status() != QDataStream::Ok
+		|| tag != kCompiledTag
+		|| version != AppVersion
+		|| keysCount != kKeysCount
+		|| count > kKeysCount) {
+		return std::nullopt;
+	}
+	const auto chars = reinterpret_cast<const QChar*>(pool.constData());
+	const auto poolSize = quint32(pool.size() / sizeof(QChar));
+	auto result = std::vector<CompiledValue>();
+	result.reserve(count);
+	QDataStream keysStream(keys);
+	keysStream.setVersion(QDataStream::Qt_5_1);
+	for (auto i = quint32(); i != count; ++i) {
+		auto key = quint16();
+		auto flags = quint8();
+		auto offset = quint32();
+		auto length = quint32();
+		keysStream >> key >> flags >> offset >> length;
+		if (keysStream.status() != QDataStream::Ok
+			|| key >= kKeysCount
+			|| offset > poolSize
+			|| length > poolSize - offset) {
+			LOG(("Lang Error: Bad compiled langpack."));
+			return std::nullopt;
+		}
+		result.push_back({
+			.key = key,
+			.flags = flags,
+			.value = QString(chars + offset, length),
+		});
 	}
 	return result;
 }
@@ -427,6 +527,13 @@ QByteArray Instance::serialize() const {
 void Instance::fillFromSerialized(
 		const QByteArray &data,
 		int dataAppVersion) {
+	fillFromSerialized(data, dataAppVersion, true);
+}
+
+void Instance::fillFromSerialized(
+		const QByteArray &data,
+		int dataAppVersion,
+		bool parse) {
 	QDataStream stream(data);
 	stream.setVersion(QDataStream::Qt_5_1);
 	qint32 serializeVersion = 0;
@@ -527,9 +634,15 @@ void Instance::fillFromSerialized(
 	} else {
 		stream >> base;
 	}
+	const auto compiled = (!_derived && !legacyFormat)
+		? readCompiled(stream)
+		: std::nullopt;
+	if (compiled) {
+		parse = false;
+	}
 	if (!base.isEmpty()) {
 		_base = std::make_unique<Instance>(this, PrivateTag{});
-		_base->fillFromSerialized(base, dataAppVersion);
+		_base->fillFromSerialized(base, dataAppVersion, parse);
 	}
 
 	_id = id;
@@ -544,9 +657,27 @@ void Instance::fillFromSerialized(
 	_customFilePathAbsolute = customFilePathAbsolute;
 	_customFilePathRelative = customFilePathRelative;
 	_customFileContent = customFileContent;
-	LOG(("Lang Info: Loaded cached, keys: %1").arg(nonDefaultValuesCount));
+	LOG(("Lang Info: Loaded cached, keys: %1%2"
+		).arg(nonDefaultValuesCount
+		).arg(compiled ? " (compiled)" : ""));
 	for (auto i = 0, count = nonDefaultValuesCount * 2; i != count; i += 2) {
-		applyValue(nonDefaultStrings[i], nonDefaultStrings[i + 1]);
+		if (parse) {
+			applyValue(nonDefaultStrings[i], nonDefaultStrings[i + 1]);
+		} else {
+			_nonDefaultValues[nonDefaultStrings[i]]
+				= nonDefaultStrings[i + 1];
+		}
+	}
+	if (compiled) {
+		for (const auto &value : *compiled) {
+			_values[value.key] = value.value;
+			if (value.flags & kCompiledOwn) {
+				_nonDefaultSet[value.key] = 1;
+			}
+			if (_base && (value.flags & kCompiledBase)) {
+				_base->_nonDefaultSet[value.key] = 1;
+			}
+		}
 	}
 	updatePluralRules();
 	updateChoosingStickerReplacement();
@@ -108,7 +108,16 @@ public:
 	}
 
 private:
+	struct CompiledValue;
+
 	void setBaseId(const QString &baseId, const QString &pluralId);
+	void fillFromSerialized(
+		const QByteArray &data,
+		int dataAppVersion,
+		bool parse);
+	void writeCompiled(QDataStream &stream) const;
+	[[nodiscard]] auto readCompiled(QDataStream &stream) const
+		-> std::optional<std::vector<CompiledValue>>;
 
 	void applyDifferenceToMe(const MTPDlangPackDifference &difference);
 	void applyValue(const QByteArray &key, const QByteArray &value);
@@ -12,10 +12,20 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/crash_reports.h"
 #include "core/launcher.h"
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 namespace {
 
+constexpr auto kMaxQueuedRecords = 64 * 1024;
+constexpr auto kWakeFlusherRecords = 1024;
+constexpr auto kFlushInterval = std::chrono::milliseconds(100);
+
 std::atomic<int> ThreadCounter/* = 0*/;
 thread_local bool WritingEntryFlag/* = false*/;
+std::atomic<const char*> MainTaskLabel/* = nullptr*/;
+std::atomic<int> MainTaskType/* = 0*/;
 
 class WritingEntryScope final {
 public:
@@ -34,6 +44,7 @@ enum LogDataType {
 	LogDataDebug,
 	LogDataTcp,
 	LogDataMtp,
+	LogDataTrace,
 
 	LogDataCount
 };
@@ -56,18 +67,55 @@ QString _logsFilePath(LogDataType type, const QString &postfix = QString()) {
 	case LogDataDebug: path += qstr("DebugLogs/log") + postfix + qstr(".txt"); break;
 	case LogDataTcp: path += qstr("DebugLogs/tcp") + postfix + qstr(".txt"); break;
 	case LogDataMtp: path += qstr("DebugLogs/mtp") + postfix + qstr(".txt"); break;
+	case LogDataTrace: path += qstr("DebugLogs/trace") + postfix + qstr(".json"); break;
 	}
 	return path;
 }
 
 int32 LogsStartIndexChosen = -1;
-QString _logsEntryStart() {
-	static thread_local auto threadId = ThreadCounter++;
-	static auto index = 0;
 
-	const auto tm = QDateTime::currentDateTime();
+// Debug entries are formatted by the flusher, the caller only fills it.
+struct LogRecord {
+	LogDataType type = LogDataDebug;
+	QString text;
+	qint64 when = 0; // Zero if the text is already formatted.
+	int threadId = 0;
+	int index = 0;
+	int32 dc = -1;
+};
+
+[[nodiscard]] LogRecord _logsEntry(
+		LogDataType type,
+		const QString &text,
+		int32 dc = -1) {
+	static thread_local auto threadId = ThreadCounter++;
+	static auto index = std::atomic<int>();
+
+	return {
+		.type = type,
+		.text = text,
+		.when = QDateTime::currentMSecsSinceEpoch(),
+		.threadId = threadId,
+		.index = ++index,
+		.dc = dc,
+	};
+}
 
-	return QString("[%1 %2-%3]").arg(tm.toString("hh:mm:ss.zzz"), QString("%1").arg(threadId, 2, 10, QChar('0'))).arg(++index, 7, 10, QChar('0'));
+[[nodiscard]] QString _logsFormat(const LogRecord &record) {
+	if (!record.when) {
+		return record.text;
+	}
+	const auto tm = QDateTime::fromMSecsSinceEpoch(record.when);
+	const auto start = QString("[%1 %2-%3]").arg(
+		tm.toString("hh:mm:ss.zzz"),
+		QString("%1").arg(record.threadId, 2, 10, QChar('0'))
+	).arg(record.index, 7, 10, QChar('0'));
+	return (record.dc >= 0)
+		? QString("%1 (dc:%2) %3\n").arg(
+			start,
+			QString::number(record.dc),
+			record.text)
+		: QString("%1 %2\n").arg(start, record.text);
 }
 
 class LogsDataFields {
@@ -213,7 +261,13 @@ private:
 			}
 		}
 		if (files[type]->open(mode)) {
-			if (type != LogDataMain) {
+			if (type == LogDataTrace) {
+				// Chrome tracing accepts an array without the closing bracket.
+				if (!(mode & QIODevice::Append)) {
+					files[type]->write("[\n");
+					files[type]->flush();
+				}
+			} else if (type != LogDataMain) {
 				files[type]->write(((mode & QIODevice::Append)
 					? qsl("\
 ----------------------------------------------------------------\n\
@@ -247,24 +301,142 @@ NEW LOGGING INSTANCE STARTED!!!\n\
 		reopen(LogDataDebug, dayIndex, postfix);
 		reopen(LogDataTcp, dayIndex, postfix);
 		reopen(LogDataMtp, dayIndex, postfix);
+		reopen(LogDataTrace, dayIndex, postfix);
 	}
 
 };
 
 LogsDataFields *LogsData = 0;
 
+// Writes the debug logs on a separate thread, so that enabling them
+// changes the timings of the logged code as little as possible.
+class AsyncLogsWriter final {
+public:
+	AsyncLogsWriter() : _thread([=] { run(); }) {
+	}
+	~AsyncLogsWriter() {
+		{
+			auto lock = std::unique_lock(_mutex);
+			_finishing = true;
+		}
+		_wake.notify_one();
+		_thread.join();
+	}
+
+	void push(LogRecord &&record) {
+		auto lock = std::unique_lock(_mutex);
+		if (_queue.size() >= kMaxQueuedRecords) {
+			++_dropped;
+			return;
+		}
+		_queue.push_back(std::move(record));
+		if (_queue.size() == kWakeFlusherRecords) {
+			lock.unlock();
+			_wake.notify_one();
+		}
+	}
+
+	void flush() {
+		auto lock = std::unique_lock(_flushMutex);
+		write(take());
+	}
+
+	// For the crash handler: the crashed thread may hold the locks.
+	void tryFlush() {
+		auto lock = std::unique_lock(_flushMutex, std::try_to_lock);
+		if (!lock.owns_lock()) {
+			return;
+		}
+		auto queue = std::unique_lock(_mutex, std::try_to_lock);
+		if (!queue.owns_lock()) {
+			return;
+		}
+		auto taken = Taken{ base::take(_queue), base::take(_dropped) };
+		queue.unlock();
+		write(std::move(taken));
+	}
+
+private:
+	struct Taken {
+		std::vector<LogRecord> records;
+		int dropped = 0;
+	};
+
+	[[nodiscard]] Taken take() {
+		auto lock = std::unique_lock(_mutex);
+		return { base::take(_queue), base::take(_dropped) };
+	}
+
+	void run() {
+		auto finishing = false;
+		while (!finishing) {
+			{
+				auto lock = std::unique_lock(_mutex);
+				_wake.wait_for(lock, kFlushInterval, [&] {
+					return _finishing
+						|| (_queue.size() >= kWakeFlusherRecords);
+				});
+				finishing = _finishing;
+			}
+			flush();
+		}
+	}
+
+	void write(Taken &&taken) {
+		auto texts = std::array<QString, LogDataCount>();
+		if (taken.dropped) {
+			texts[LogDataDebug] = _logsFormat(_logsEntry(
+				LogDataDebug,
+				QString("Logs Warning: %1 records were dropped."
+				).arg(taken.dropped)));
+		}
+		for (const auto &record : taken.records) {
+			texts[record.type] += _logsFormat(record);
+		}
+		for (auto i = 0; i != LogDataCount; ++i) {
+			if (!texts[i].isEmpty()) {
+				LogsData->write(LogDataType(i), texts[i]);
+			}
+		}
+	}
+
+	std::mutex _mutex;
+	std::mutex _flushMutex;
+	std::condition_variable _wake;
+	std::vector<LogRecord> _queue;
+	int _dropped = 0;
+	bool _finishing = false;
+	std::thread _thread;
+
+};
+
+// Records are pushed from any thread, the writer is destroyed in finish().
+std::mutex LogsWriterMutex;
+AsyncLogsWriter *LogsWriter = nullptr;
+
 using LogsInMemoryList = QList<QPair<LogDataType, QString>>;
 LogsInMemoryList *LogsInMemory = 0;
 LogsInMemoryList *DeletedLogsInMemory = SharedMemoryLocation<LogsInMemoryList, 0>();
 
 QString LogsBeforeSingleInstanceChecked; // LogsInMemory already dumped in LogsData, but LogsData is about to be deleted
 
-void _logsWrite(LogDataType type, const QString &msg) {
+void _logsWrite(LogRecord &&record) {
+	const auto type = record.type;
 	if (LogsData && (type == LogDataMain || LogsStartIndexChosen < 0)) {
-		if (type == LogDataMain || Logs::DebugEnabled()) {
-			LogsData->write(type, msg);
+		if (type != LogDataMain && !Logs::DebugEnabled()) {
+			return;
+		} else if (type != LogDataMain) {
+			auto lock = std::unique_lock(LogsWriterMutex);
+			if (LogsWriter) {
+				LogsWriter->push(std::move(record));
+				return;
+			}
 		}
-	} else if (LogsInMemory != DeletedLogsInMemory) {
+		LogsData->write(type, _logsFormat(record));
+		return;
+	}
+	const auto msg = _logsFormat(record);
+	if (LogsInMemory != DeletedLogsInMemory) {
 		if (!LogsInMemory) {
 			LogsInMemory = new LogsInMemoryList;
 		}
@@ -274,6 +446,10 @@ void _logsWrite(LogDataType type, const QString &msg) {
 	}
 }
 
+void _logsWrite(LogDataType type, const QString &msg) {
+	_logsWrite(LogRecord{ .type = type, .text = msg });
+}
+
 namespace Logs {
 namespace {
 
@@ -343,6 +519,23 @@ bool WritingEntry() {
 	return WritingEntryFlag;
 }
 
+TaskScope::TaskScope(const char *label, int type)
+: _previousLabel(MainTaskLabel.exchange(label, std::memory_order_relaxed))
+, _previousType(MainTaskType.exchange(type, std::memory_order_relaxed)) {
+}
+
+TaskScope::~TaskScope() {
+	MainTaskLabel.store(_previousLabel, std::memory_order_relaxed);
+	MainTaskType.store(_previousType, std::memory_order_relaxed);
+}
+
+Task CurrentTask() {
+	return {
+		.label = MainTaskLabel.load(std::memory_order_relaxed),
+		.type = MainTaskType.load(std::memory_order_relaxed),
+	};
+}
+
 void start(not_null<Core::Launcher*> launcher) {
 	Assert(LogsData == nullptr);
 
@@ -465,6 +658,11 @@ void start(not_null<Core::Launcher*> launcher) {
 }
 
 void finish() {
+	const auto writer = [&] {
+		auto lock = std::unique_lock(LogsWriterMutex);
+		return base::take(LogsWriter);
+	}();
+	delete writer;
 	delete LogsData;
 	LogsData = 0;
 
@@ -509,6 +707,10 @@ bool instanceChecked() {
 	}
 	LogsInMemory = DeletedLogsInMemory;
 
+	{
+		auto lock = std::unique_lock(LogsWriterMutex);
+		LogsWriter = new AsyncLogsWriter();
+	}
 	DEBUG_LOG(("Debug logs started."));
 	LogsBeforeSingleInstanceChecked.clear();
 	return true;
@@ -529,11 +731,24 @@ void multipleInstances() {
 
 void closeMain() {
 	LOG(("Explicitly closing main log and finishing crash handlers."));
+	{
+		auto lock = std::unique_lock(LogsWriterMutex);
+		if (LogsWriter) {
+			LogsWriter->flush();
+		}
+	}
 	if (LogsData) {
 		LogsData->closeMain();
 	}
 }
 
+void flushForCrash() {
+	auto lock = std::unique_lock(LogsWriterMutex, std::try_to_lock);
+	if (lock.owns_lock() && LogsWriter) {
+		LogsWriter->tryFlush();
+	}
+}
+
 void writeMain(const QString &v) {
 	time_t t = time(NULL);
 	struct tm tm;
@@ -553,8 +768,7 @@ void writeMain(const QString &v) {
 }
 
 void writeDebug(const QString &v) {
-	const auto msg = QString("%1 %2\n").arg(_logsEntryStart(), v);
-	_logsWrite(LogDataDebug, msg);
+	_logsWrite(_logsEntry(LogDataDebug, v));
 
 #ifdef Q_OS_WIN
 	//OutputDebugString(reinterpret_cast<const wchar_t *>(msg.utf16()));
@@ -566,16 +780,15 @@ void writeDebug(const QString &v) {
 }
 
 void writeTcp(const QString &v) {
-	const auto msg = QString("%1 %2\n").arg(_logsEntryStart(), v);
-	_logsWrite(LogDataTcp, msg);
+	_logsWrite(_logsEntry(LogDataTcp, v));
+}
+
+void writeTrace(const QString &v) {
+	_logsWrite(LogDataTrace, v + ",\n");
 }
 
 void writeMtp(int32 dc, const QString &v) {
-	const auto msg = QString("%1 (dc:%2) %3\n").arg(
-		_logsEntryStart(),
-		QString::number(dc),
-		v);
-	_logsWrite(LogDataMtp, msg);
+	_logsWrite(_logsEntry(LogDataMtp, v, dc));
 }
 
 QString full() {
@@ -21,6 +21,27 @@ void SetDebugEnabled(bool enabled);
 bool DebugEnabled();
 [[nodiscard]] bool WritingEntry();
 
+// Names the work the main thread is busy with for the freeze watchdog.
+// Must be used on the main thread only, scopes may be nested.
+class TaskScope final {
+public:
+	explicit TaskScope(const char *label, int type = 0);
+	TaskScope(const TaskScope &other) = delete;
+	TaskScope &operator=(const TaskScope &other) = delete;
+	~TaskScope();
+
+private:
+	const char *_previousLabel = nullptr;
+	int _previousType = 0;
+
+};
+
+struct Task {
+	const char *label = nullptr;
+	int type = 0;
+};
+[[nodiscard]] Task CurrentTask();
+
 void start(not_null<Core::Launcher*> launcher);
 bool started();
 void finish();
@@ -30,11 +51,17 @@ void multipleInstances();
 
 void closeMain();
 
+// Writes the queued debug records on the calling thread, best effort.
+void flushForCrash();
+
 void writeMain(const QString &v);
 void writeDebug(const QString &v);
 void writeTcp(const QString &v);
 void writeMtp(int32 dc, const QString &v);
 
+// One event of the Chrome tracing format, in the debug logs folder.
+void writeTrace(const QString &v);
+
 QString full();
 
 inline const char *b(bool v) {
@@ -216,6 +216,7 @@ void Account::destroySession(DestroyReason reason) {
 		return;
 	}
 
+	_local->writePendingDrafts();
 	_sessionValue = nullptr;
 
 	if (reason == DestroyReason::LoggedOut) {
@@ -33,6 +33,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/unixtime.h"
 #include "calls/calls_instance.h"
 #include "support/support_helper.h"
+#include "core/startup_timeline.h"
 
 #ifndef TDESKTOP_DISABLE_SPELLCHECK
 #include "chat_helpers/spellchecker_common.h"
@@ -82,11 +83,12 @@ Session::Session(
 , _user(_data->processUser(user))
 , _emojiStickersPack(std::make_unique<Stickers::EmojiPack>(this))
 , _diceStickersPacks(std::make_unique<Stickers::DicePacks>(this))
-, _sendAsPeers(std::make_unique<SendAsPeers>(this))
 , _supportHelper(Support::Helper::Create(this))
 , _saveSettingsTimer([=] { saveSettings(); }) {
 	Expects(_settings != nullptr);
 
+	Core::StartupTimeline::Mark("session");
+
 	_api->requestTermsUpdate();
 	_api->requestFullPeer(_user);
 
@@ -134,14 +136,21 @@ Session::Session(
 
 		// Storage::Account uses Main::Account::session() in those methods.
 		// So they can't be called during Main::Session construction.
-		local().readInstalledStickers();
-		local().readInstalledMasks();
-		local().readFeaturedStickers();
-		local().readRecentStickers();
-		local().readRecentMasks();
-		local().readFavedStickers();
+		//
+		// Sticker sets are a lot of documents to read, so we read them
+		// on first access or when the window is shown, not at startup.
+		data().stickers().setLocalLoader([=] {
+			local().readInstalledStickers();
+			local().readInstalledMasks();
+			local().readFeaturedStickers();
+			local().readRecentStickers();
+			local().readRecentMasks();
+			local().readFavedStickers();
+			crl::on_main(this, [=] {
+				data().stickers().notifyUpdated();
+			});
+		});
 		local().readSavedGifs();
-		data().stickers().notifyUpdated();
 		data().stickers().notifySavedGifsUpdated();
 	});
 
@@ -177,6 +186,12 @@ void Session::finishLogout() {
 }
 
 Session::~Session() {
+	const auto stats = changes().stats();
+	DEBUG_LOG(("Changes: %1 scheduled, %2 merged, %3 merged in frames."
+		).arg(stats.scheduled
+		).arg(stats.merged
+		).arg(stats.framedMerged));
+
 	unlockTerms();
 	data().clear();
 	ClickHandler::clearActive();
@@ -230,6 +245,13 @@ bool Session::validateSelf(UserId id) {
 	return true;
 }
 
+SendAsPeers &Session::sendAsPeers() {
+	if (!_sendAsPeers) {
+		_sendAsPeers = std::make_unique<SendAsPeers>(this);
+	}
+	return *_sendAsPeers;
+}
+
 void Session::saveSettings() {
 	local().writeSessionSettings();
 }
@@ -114,9 +114,7 @@ public:
 	[[nodiscard]] SessionSettings &settings() const {
 		return *_settings;
 	}
-	[[nodiscard]] SendAsPeers &sendAsPeers() const {
-		return *_sendAsPeers;
-	}
+	[[nodiscard]] SendAsPeers &sendAsPeers();
 
 	void saveSettings();
 	void saveSettingsDelayed(crl::time delay = kDefaultSaveDelay);
@@ -185,7 +183,9 @@ private:
 	// _emojiStickersPack depends on _data.
 	const std::unique_ptr<Stickers::EmojiPack> _emojiStickersPack;
 	const std::unique_ptr<Stickers::DicePacks> _diceStickersPacks;
-	const std::unique_ptr<SendAsPeers> _sendAsPeers;
+
+	// Not needed for the chats list, created on first use.
+	std::unique_ptr<SendAsPeers> _sendAsPeers;
 
 	const std::unique_ptr<Support::Helper> _supportHelper;
 
@@ -39,6 +39,7 @@ QByteArray SessionSettings::serialize() const {
 	size += _mediaLastPlaybackPosition.size() * 2 * sizeof(quint64);
 	size += Serialize::bytearraySize(autoDownload);
 	size += sizeof(qint32) + _hiddenPinnedMessages.size() * (sizeof(quint64) + sizeof(qint32));
+	size += sizeof(quint64) + sizeof(qint64);
 
 	auto result = QByteArray();
 	result.reserve(size);
@@ -72,6 +73,9 @@ QByteArray SessionSettings::serialize() const {
 		for (const auto &[key, value] : _hiddenPinnedMessages) {
 			stream << SerializePeerId(key) << qint64(value.bare);
 		}
+		stream
+			<< SerializePeerId(_restoreChatPeer)
+			<< qint64(_restoreChatMsgId.bare);
 	}
 	return result;
 }
@@ -132,6 +136,8 @@ void SessionSettings::addFromSerialized(const QByteArray &serialized) {
 	qint32 dialogsFiltersEnabled = _dialogsFiltersEnabled ? 1 : 0;
 	qint32 supportAllSilent = _supportAllSilent ? 1 : 0;
 	qint32 photoEditorHintShowsCount = _photoEditorHintShowsCount;
+	quint64 restoreChatPeer = 0;
+	qint64 restoreChatMsgId = 0;
 
 	stream >> versionTag;
 	if (versionTag == kVersionTag) {
@@ -351,6 +357,9 @@ void SessionSettings::addFromSerialized(const QByteArray &serialized) {
 			}
 		}
 	}
+	if (!stream.atEnd()) {
+		stream >> restoreChatPeer >> restoreChatMsgId;
+	}
 	if (stream.status() != QDataStream::Ok) {
 		LOG(("App Error: "
 			"Bad data for SessionSettings::addFromSerialized()"));
@@ -394,6 +403,8 @@ void SessionSettings::addFromSerialized(const QByteArray &serialized) {
 	_dialogsFiltersEnabled = (dialogsFiltersEnabled == 1);
 	_supportAllSilent = (supportAllSilent == 1);
 	_photoEditorHintShowsCount = std::move(photoEditorHintShowsCount);
+	_restoreChatPeer = DeserializePeerId(restoreChatPeer);
+	_restoreChatMsgId = restoreChatMsgId;
 
 	if (version < 2) {
 		app.setLastSeenWarningSeen(appLastSeenWarningSeen == 1);
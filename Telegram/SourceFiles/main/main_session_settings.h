@@ -123,6 +123,19 @@ public:
 	[[nodiscard]] bool photoEditorHintShown() const;
 	void incrementPhotoEditorHintShown();
 
+	// The chat that was open when the settings were last saved, kept
+	// only until a clean quit, so it survives crashes and update restarts.
+	[[nodiscard]] PeerId restoreChatPeer() const {
+		return _restoreChatPeer;
+	}
+	[[nodiscard]] MsgId restoreChatMsgId() const {
+		return _restoreChatMsgId;
+	}
+	void setRestoreChat(PeerId peerId, MsgId msgId) {
+		_restoreChatPeer = peerId;
+		_restoreChatMsgId = msgId;
+	}
+
 private:
 	static constexpr auto kDefaultSupportChatsLimitSlice = 7 * 24 * 60 * 60;
 	static constexpr auto kPhotoEditorHintMaxShowsCount = 5;
@@ -138,6 +151,8 @@ private:
 	base::flat_map<PeerId, MsgId> _hiddenPinnedMessages;
 	bool _dialogsFiltersEnabled = false;
 	int _photoEditorHintShowsCount = 0;
+	PeerId _restoreChatPeer = 0;
+	MsgId _restoreChatMsgId = 0;
 
 	Support::SwitchSettings _supportSwitch;
 	bool _supportFixChatsOrder = true;
@@ -581,8 +581,7 @@ Mixer::Mixer(not_null<Audio::Instance*> instance)
 , _effectsDestructionTimer([=] { destroyStaleEffectsSafe(); })
 , _volumeVideo(kVolumeRound)
 , _volumeSong(kVolumeRound)
-, _fader(new Fader(&_faderThread))
-, _loader(new Loaders(&_loaderThread)) {
+, _fader(new Fader(&_faderThread)) {
 	connect(this, SIGNAL(faderOnTimer()), _fader, SLOT(onTimer()), Qt::QueuedConnection);
 	connect(this, SIGNAL(suppressSong()), _fader, SLOT(onSuppressSong()));
 	connect(this, SIGNAL(unsuppressSong()), _fader, SLOT(onUnsuppressSong()));
@@ -598,21 +597,34 @@ Mixer::Mixer(not_null<Audio::Instance*> instance)
 		QMetaObject::invokeMethod(_fader, "onVideoVolumeChanged");
 	}, _lifetime);
 
-	connect(this, SIGNAL(loaderOnStart(const AudioMsgId&, qint64)), _loader, SLOT(onStart(const AudioMsgId&, qint64)));
-	connect(this, SIGNAL(loaderOnCancel(const AudioMsgId&)), _loader, SLOT(onCancel(const AudioMsgId&)), Qt::QueuedConnection);
-	connect(_loader, SIGNAL(needToCheck()), _fader, SLOT(onTimer()));
-	connect(_loader, SIGNAL(error(const AudioMsgId&)), this, SLOT(onError(const AudioMsgId&)));
-	connect(_fader, SIGNAL(needToPreload(const AudioMsgId&)), _loader, SLOT(onLoad(const AudioMsgId&)));
+	for (auto i = 0; i != kLoadersCount; ++i) {
+		const auto type = AudioMsgId::Type(int(AudioMsgId::Type::Voice) + i);
+		const auto loader = new Loaders(&_loaderThreads[i], type);
+		_loaders[i] = loader;
+		connect(this, SIGNAL(loaderOnStart(const AudioMsgId&, qint64)), loader, SLOT(onStart(const AudioMsgId&, qint64)));
+		connect(this, SIGNAL(loaderOnCancel(const AudioMsgId&)), loader, SLOT(onCancel(const AudioMsgId&)), Qt::QueuedConnection);
+		connect(loader, SIGNAL(needToCheck()), _fader, SLOT(onTimer()));
+		connect(loader, SIGNAL(error(const AudioMsgId&)), this, SLOT(onError(const AudioMsgId&)));
+		connect(_fader, SIGNAL(needToPreload(const AudioMsgId&)), loader, SLOT(onLoad(const AudioMsgId&)));
+	}
 	connect(_fader, SIGNAL(playPositionUpdated(const AudioMsgId&)), this, SIGNAL(updated(const AudioMsgId&)));
 	connect(_fader, SIGNAL(audioStopped(const AudioMsgId&)), this, SLOT(onStopped(const AudioMsgId&)));
 	connect(_fader, SIGNAL(error(const AudioMsgId&)), this, SLOT(onError(const AudioMsgId&)));
 	connect(this, SIGNAL(stoppedOnError(const AudioMsgId&)), this, SIGNAL(updated(const AudioMsgId&)), Qt::QueuedConnection);
 	connect(this, SIGNAL(updated(const AudioMsgId&)), this, SLOT(onUpdated(const AudioMsgId&)));
 
-	_loaderThread.start();
+	for (auto &thread : _loaderThreads) {
+		thread.start();
+	}
 	_faderThread.start();
 }
 
+not_null<Loaders*> Mixer::loaderForType(AudioMsgId::Type type) const {
+	Expects(type != AudioMsgId::Type::Unknown);
+
+	return _loaders[int(type) - int(AudioMsgId::Type::Voice)];
+}
+
 // Thread: Main. Locks: AudioMutex.
 Mixer::~Mixer() {
 	{
@@ -629,9 +641,13 @@ Mixer::~Mixer() {
 	}
 
 	_faderThread.quit();
-	_loaderThread.quit();
+	for (auto &thread : _loaderThreads) {
+		thread.quit();
+	}
 	_faderThread.wait();
-	_loaderThread.wait();
+	for (auto &thread : _loaderThreads) {
+		thread.wait();
+	}
 }
 
 void Mixer::onUpdated(const AudioMsgId &audio) {
@@ -889,11 +905,11 @@ void Mixer::play(
 }
 
 void Mixer::feedFromExternal(ExternalSoundPart &&part) {
-	_loader->feedFromExternal(std::move(part));
+	loaderForType(part.audio.type())->feedFromExternal(std::move(part));
 }
 
 void Mixer::forceToBufferExternal(const AudioMsgId &audioId) {
-	_loader->forceToBufferExternal(audioId);
+	loaderForType(audioId.type())->forceToBufferExternal(audioId);
 }
 
 // Thread: Main. Locks: AudioMutex.
@@ -1742,13 +1758,28 @@ public:
 
 		auto fmt = format();
 		auto peak = uint16(0);
-		auto callback = [&](uint16 sample) {
-			accumulate_max(peak, sample);
-			sumbytes += Media::Player::kWaveformSamplesCount;
-			if (sumbytes >= countbytes) {
-				sumbytes -= countbytes;
-				peaks.push_back(peak);
-				peak = 0;
+		const auto step = int64(Media::Player::kWaveformSamplesCount);
+		const auto accumulatePeaks = [&](const auto *samples, int64 count) {
+			// Take the maximum over whole runs of samples that fall into
+			// the same peak, the inner loop is simple enough to vectorize.
+			while (count > 0) {
+				const auto left = (countbytes - sumbytes + step - 1) / step;
+				const auto run = std::clamp(left, int64(1), count);
+				auto value = uint16(0);
+				for (auto i = int64(0); i != run; ++i) {
+					value = std::max(
+						value,
+						Media::Audio::ReadOneSample(samples[i]));
+				}
+				accumulate_max(peak, value);
+				sumbytes += run * step;
+				if (sumbytes >= countbytes) {
+					sumbytes -= countbytes;
+					peaks.push_back(peak);
+					peak = 0;
+				}
+				samples += run;
+				count -= run;
 			}
 		};
 		while (processed < countbytes) {
@@ -1763,11 +1794,15 @@ public:
 				continue;
 			}
 
-			auto sampleBytes = bytes::make_span(buffer);
+			const auto data = buffer.constData();
 			if (fmt == AL_FORMAT_MONO8 || fmt == AL_FORMAT_STEREO8) {
-				Media::Audio::IterateSamples<uchar>(sampleBytes, callback);
+				accumulatePeaks(
+					reinterpret_cast<const uchar*>(data),
+					buffer.size());
 			} else if (fmt == AL_FORMAT_MONO16 || fmt == AL_FORMAT_STEREO16) {
-				Media::Audio::IterateSamples<int16>(sampleBytes, callback);
+				accumulatePeaks(
+					reinterpret_cast<const int16*>(data),
+					buffer.size() / int(sizeof(int16)));
 			}
 			processed += sampleSize() * samples;
 		}
@@ -310,9 +310,16 @@ private:
 	friend class Fader;
 	friend class Loaders;
 
-	QThread _faderThread, _loaderThread;
+	// Each track type decodes on its own thread, so a song being
+	// preloaded does not delay the buffers of a voice message.
+	static constexpr auto kLoadersCount = 3;
+	[[nodiscard]] not_null<Loaders*> loaderForType(
+		AudioMsgId::Type type) const;
+
+	QThread _faderThread;
+	std::array<QThread, kLoadersCount> _loaderThreads;
 	Fader *_fader;
-	Loaders *_loader;
+	std::array<Loaders*, kLoadersCount> _loaders = { { nullptr } };
 
 	rpl::lifetime _lifetime;
 
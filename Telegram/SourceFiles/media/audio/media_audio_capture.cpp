@@ -44,11 +44,15 @@ public:
 	Inner(QThread *thread);
 	~Inner();
 
-	void start(Fn<void(Update)> updated, Fn<void()> error);
+	void start(
+		Fn<void(Update)> updated,
+		Fn<void(QByteArray)> encoded,
+		Fn<void()> error);
 	void stop(Fn<void(Result&&)> callback = nullptr);
 
 private:
 	void process();
+	void sendEncoded();
 
 	[[nodiscard]] bool processFrame(int32 offset, int32 framesize);
 	void fail();
@@ -60,6 +64,7 @@ private:
 	[[nodiscard]] int writePackets();
 
 	Fn<void(Update)> _updated;
+	Fn<void(QByteArray)> _encoded;
 	Fn<void()> _error;
 
 	struct Private;
@@ -91,6 +96,10 @@ void Instance::start() {
 			crl::on_main(this, [=] {
 				_updates.fire_copy(update);
 			});
+		}, [=](QByteArray bytes) {
+			crl::on_main(this, [=] {
+				_encoded.fire_copy(bytes);
+			});
 		}, [=] {
 			crl::on_main(this, [=] {
 				_updates.fire_error({});
@@ -166,6 +175,8 @@ struct Instance::Inner::Private {
 
 	QByteArray data;
 	int32 dataPos = 0;
+	int32 streamed = 0;
+	bool rewritten = false;
 
 	int64 waveformMod = 0;
 	int64 waveformEach = (kCaptureFrequency / 100);
@@ -189,6 +200,7 @@ struct Instance::Inner::Private {
 		auto l = reinterpret_cast<Private*>(opaque);
 
 		if (buf_size <= 0) return 0;
+		if (l->dataPos < l->streamed) l->rewritten = true;
 		if (l->dataPos + buf_size > l->data.size()) l->data.resize(l->dataPos + buf_size);
 		memcpy(l->data.data() + l->dataPos, buf, buf_size);
 		l->dataPos += buf_size;
@@ -233,9 +245,15 @@ void Instance::Inner::fail() {
 	}
 }
 
-void Instance::Inner::start(Fn<void(Update)> updated, Fn<void()> error) {
+void Instance::Inner::start(
+		Fn<void(Update)> updated,
+		Fn<void(QByteArray)> encoded,
+		Fn<void()> error) {
 	_updated = std::move(updated);
+	_encoded = std::move(encoded);
 	_error = std::move(error);
+	d->streamed = 0;
+	d->rewritten = false;
 
 	// Start OpenAL Capture
 	d->device = alcCaptureOpenDevice(nullptr, kCaptureFrequency, AL_FORMAT_MONO16, kCaptureFrequency / 5);
@@ -452,6 +470,7 @@ void Instance::Inner::stop(Fn<void(Result&&)> callback) {
 	}
 
 	QByteArray result = d->fullSamples ? d->data : QByteArray();
+	const auto streamed = !result.isEmpty() && !d->rewritten;
 	VoiceWaveform waveform;
 	qint32 samples = d->fullSamples;
 	if (needResult && samples && !d->waveform.isEmpty()) {
@@ -536,7 +555,12 @@ void Instance::Inner::stop(Fn<void(Result&&)> callback) {
 	}
 
 	if (needResult) {
-		callback({ result, waveform, samples });
+		callback({
+			.bytes = result,
+			.waveform = waveform,
+			.samples = samples,
+			.streamed = streamed,
+		});
 	}
 }
 
@@ -605,12 +629,21 @@ void Instance::Inner::process() {
 			int32 goodSize = _captured.size() - encoded;
 			memmove(_captured.data(), _captured.constData() + encoded, goodSize);
 			_captured.resize(goodSize);
+			sendEncoded();
 		}
 	} else {
 		DEBUG_LOG(("Audio Capture: no samples to capture."));
 	}
 }
 
+void Instance::Inner::sendEncoded() {
+	if (d->rewritten || d->data.size() <= d->streamed || !_encoded) {
+		return;
+	}
+	_encoded(d->data.mid(d->streamed));
+	d->streamed = d->data.size();
+}
+
 bool Instance::Inner::processFrame(int32 offset, int32 framesize) {
 	// Prepare audio frame
 
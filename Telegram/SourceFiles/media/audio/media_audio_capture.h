@@ -23,6 +23,9 @@ struct Result {
 	QByteArray bytes;
 	VoiceWaveform waveform;
 	int samples = 0;
+
+	// All the parts from encoded() are the beginning of the bytes.
+	bool streamed = false;
 };
 
 void Start();
@@ -46,6 +49,11 @@ public:
 		return _started.changes();
 	}
 
+	// Parts of the encoded file, in order, while it is being recorded.
+	[[nodiscard]] rpl::producer<QByteArray> encoded() const {
+		return _encoded.events();
+	}
+
 	void start();
 	void stop(Fn<void(Result&&)> callback = nullptr);
 
@@ -56,6 +64,7 @@ private:
 	bool _available = false;
 	rpl::variable<bool> _started = false;;
 	rpl::event_stream<Update, rpl::empty_error> _updates;
+	rpl::event_stream<QByteArray> _encoded;
 	QThread _thread;
 	std::unique_ptr<Inner> _inner;
 
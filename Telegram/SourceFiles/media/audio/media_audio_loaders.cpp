@@ -16,11 +16,13 @@ namespace Player {
 namespace {
 
 constexpr auto kPlaybackBufferSize = 256 * 1024;
+constexpr auto kSlowDecodeThreshold = crl::time(100);
 
 } // namespace
 
-Loaders::Loaders(QThread *thread)
-: _fromExternalNotify([=] { videoSoundAdded(); }) {
+Loaders::Loaders(QThread *thread, AudioMsgId::Type type)
+: _type(type)
+, _fromExternalNotify([=] { videoSoundAdded(); }) {
 	moveToThread(thread);
 	_fromExternalNotify.moveToThread(thread);
 	connect(thread, SIGNAL(started()), this, SLOT(onInit()));
@@ -105,6 +107,9 @@ void Loaders::onInit() {
 
 void Loaders::onStart(const AudioMsgId &audio, qint64 positionMs) {
 	auto type = audio.type();
+	if (type != _type) {
+		return;
+	}
 	clear(type);
 	{
 		QMutexLocker lock(internal::audioPlayerMutex());
@@ -147,6 +152,9 @@ void Loaders::emitError(AudioMsgId::Type type) {
 }
 
 void Loaders::onLoad(const AudioMsgId &audio) {
+	if (audio.type() != _type) {
+		return;
+	}
 	loadData(audio);
 }
 
@@ -166,6 +174,7 @@ void Loaders::loadData(AudioMsgId audio, crl::time positionMs) {
 	auto waiting = false;
 	auto errAtStart = started;
 
+	const auto decodeStarted = crl::now();
 	QByteArray samples;
 	int64 samplesCount = 0;
 	if (l->holdsSavedDecodedSamples()) {
@@ -252,6 +261,15 @@ void Loaders::loadData(AudioMsgId audio, crl::time positionMs) {
 			l->setForceToBuffer(false);
 		}
 
+		const auto decodeTime = crl::now() - decodeStarted;
+		if (decodeTime >= kSlowDecodeThreshold) {
+			DEBUG_LOG(("Audio Info: "
+				"Decoding %1 ms ahead took %2 ms for type %3."
+				).arg(samplesCount * 1000 / l->samplesFrequency()
+				).arg(decodeTime
+				).arg(int(type)));
+		}
+
 		track->bufferSamples[bufferIndex] = samples;
 		track->samplesCount[bufferIndex] = samplesCount;
 		track->bufferedLength += samplesCount;
@@ -421,6 +439,9 @@ Mixer::Track *Loaders::checkLoader(AudioMsgId::Type type) {
 void Loaders::onCancel(const AudioMsgId &audio) {
 	Expects(audio.type() != AudioMsgId::Type::Unknown);
 
+	if (audio.type() != _type) {
+		return;
+	}
 	switch (audio.type()) {
 	case AudioMsgId::Type::Voice: if (_audio == audio) clear(audio.type()); break;
 	case AudioMsgId::Type::Song: if (_song == audio) clear(audio.type()); break;
@@ -20,7 +20,7 @@ class Loaders : public QObject {
 	Q_OBJECT
 
 public:
-	Loaders(QThread *thread);
+	Loaders(QThread *thread, AudioMsgId::Type type);
 	void feedFromExternal(ExternalSoundPart &&part);
 	void forceToBufferExternal(const AudioMsgId &audioId);
 	~Loaders();
@@ -39,6 +39,7 @@ public Q_SLOTS:
 private:
 	void videoSoundAdded();
 
+	const AudioMsgId::Type _type = AudioMsgId::Type::Unknown;
 	AudioMsgId _audio, _song, _video;
 	std::unique_ptr<AudioPlayerLoader> _audioLoader;
 	std::unique_ptr<AudioPlayerLoader> _songLoader;
@@ -0,0 +1,549 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "media/clip/media_clip_compress.h"
+
+#include "ffmpeg/ffmpeg_utility.h"
+#include "logs.h"
+
+#include <QtCore/QFile>
+
+namespace Media::Clip {
+namespace {
+
+constexpr auto kMinCompressSize = 16 * 1024 * 1024;
+constexpr auto kMaxSide = 1280;
+constexpr auto kBitrate = 2'000'000; // For 1280x720.
+constexpr auto kMinBitrate = 500'000;
+constexpr auto kMaxFrameRate = 30;
+constexpr auto kKeyframeInterval = 2 * kMaxFrameRate;
+constexpr auto kMinGain = 0.8;
+
+// Those accept frames in system memory, so no upload is required.
+constexpr auto kHardwareEncoders = std::array{
+#ifdef Q_OS_WIN
+	"h264_nvenc",
+	"h264_qsv",
+	"h264_amf",
+	"h264_mf",
+#elif defined Q_OS_MAC // Q_OS_WIN
+	"h264_videotoolbox",
+#else // Q_OS_WIN || Q_OS_MAC
+	"h264_nvenc",
+	"h264_qsv",
+#endif // Q_OS_WIN || Q_OS_MAC
+};
+constexpr auto kSoftwareEncoders = std::array{
+	"libx264",
+	"libopenh264",
+};
+
+struct OutputDeleter {
+	void operator()(AVFormatContext *value) {
+		if (value) {
+			const auto io = FFmpeg::IOPointer(value->pb);
+			avformat_free_context(value);
+		}
+	}
+};
+using OutputPointer = std::unique_ptr<AVFormatContext, OutputDeleter>;
+
+[[nodiscard]] AVPixelFormat ChooseFormat(not_null<const AVCodec*> codec) {
+	if (!codec->pix_fmts) {
+		return AV_PIX_FMT_YUV420P;
+	}
+	for (auto i = codec->pix_fmts; *i != AV_PIX_FMT_NONE; ++i) {
+		if (*i == AV_PIX_FMT_YUV420P || *i == AV_PIX_FMT_NV12) {
+			return *i;
+		}
+	}
+	return AV_PIX_FMT_NONE;
+}
+
+[[nodiscard]] bool CanCopyAudio(AVCodecID codec) {
+	return (codec == AV_CODEC_ID_AAC) || (codec == AV_CODEC_ID_MP3);
+}
+
+class Compressor final {
+public:
+	Compressor(
+		not_null<QIODevice*> input,
+		not_null<QIODevice*> output,
+		Fn<void(float64)> progress,
+		Fn<bool()> interrupted);
+
+	[[nodiscard]] bool run();
+
+private:
+	[[nodiscard]] bool openInput();
+	[[nodiscard]] bool openOutput();
+	[[nodiscard]] FFmpeg::CodecPointer openEncoder(const char *name);
+	[[nodiscard]] bool decode(AVPacket *packet);
+	[[nodiscard]] bool encode(AVFrame *frame);
+	[[nodiscard]] bool scale(not_null<AVFrame*> frame);
+	[[nodiscard]] bool copy(FFmpeg::Packet &&packet, not_null<AVStream*> to);
+	[[nodiscard]] bool write(AVPacket &packet);
+	void reportProgress(int64_t pts);
+
+	const not_null<QIODevice*> _inputDevice;
+	const not_null<QIODevice*> _outputDevice;
+	const Fn<void(float64)> _progress;
+	const Fn<bool()> _interrupted;
+
+	FFmpeg::FormatPointer _input;
+	OutputPointer _output;
+	FFmpeg::CodecPointer _decoder;
+	FFmpeg::CodecPointer _encoder;
+	FFmpeg::SwscalePointer _swscale;
+	FFmpeg::FramePointer _frame;
+	FFmpeg::FramePointer _scaled;
+	base::flat_map<int, not_null<AVStream*>> _audioStreams;
+	AVStream *_videoIn = nullptr;
+	AVStream *_videoOut = nullptr;
+	QSize _size;
+	int _bitrate = 0;
+	int64_t _minPtsDelta = 0;
+	int64_t _lastPts = AV_NOPTS_VALUE;
+	crl::time _duration = 0;
+	int _reportedPercent = -1;
+
+};
+
+Compressor::Compressor(
+	not_null<QIODevice*> input,
+	not_null<QIODevice*> output,
+	Fn<void(float64)> progress,
+	Fn<bool()> interrupted)
+: _inputDevice(input)
+, _outputDevice(output)
+, _progress(std::move(progress))
+, _interrupted(std::move(interrupted))
+, _frame(FFmpeg::MakeFramePointer())
+, _scaled(FFmpeg::MakeFramePointer()) {
+}
+
+bool Compressor::run() {
+	if (!openInput() || !openOutput()) {
+		return false;
+	}
+	while (true) {
+		if (_interrupted && _interrupted()) {
+			LOG(("Video Compress Info: Interrupted."));
+			return false;
+		}
+		auto packet = FFmpeg::Packet();
+		const auto error = FFmpeg::AvErrorWrap(
+			av_read_frame(_input.get(), &packet.fields()));
+		if (error) {
+			if (error.code() != AVERROR_EOF) {
+				FFmpeg::LogError(qstr("av_read_frame"), error);
+				return false;
+			}
+			break;
+		}
+		const auto index = packet.fields().stream_index;
+		if (index == _videoIn->index) {
+			if (!decode(&packet.fields())) {
+				return false;
+			}
+		} else if (const auto i = _audioStreams.find(index)
+			; i != end(_audioStreams)) {
+			if (!copy(std::move(packet), i->second)) {
+				return false;
+			}
+		}
+	}
+	if (!decode(nullptr) || !encode(nullptr)) {
+		return false;
+	}
+	const auto error = FFmpeg::AvErrorWrap(av_write_trailer(_output.get()));
+	if (error) {
+		FFmpeg::LogError(qstr("av_write_trailer"), error);
+		return false;
+	}
+	return true;
+}
+
+bool Compressor::openInput() {
+	_input = FFmpeg::MakeFormatPointer(
+		static_cast<QIODevice*>(_inputDevice.get()),
+		&FFmpeg::ReadIODevice,
+		nullptr,
+		&FFmpeg::SeekIODevice);
+	if (!_input) {
+		return false;
+	}
+	auto error = FFmpeg::AvErrorWrap(
+		avformat_find_stream_info(_input.get(), nullptr));
+	if (error) {
+		FFmpeg::LogError(qstr("avformat_find_stream_info"), error);
+		return false;
+	}
+	const auto index = av_find_best_stream(
+		_input.get(),
+		AVMEDIA_TYPE_VIDEO,
+		-1,
+		-1,
+		nullptr,
+		0);
+	if (index < 0) {
+		return false;
+	}
+	_videoIn = _input->streams[index];
+	for (auto i = 0; i != int(_input->nb_streams); ++i) {
+		const auto stream = _input->streams[i];
+		if (stream->codecpar->codec_type != AVMEDIA_TYPE_AUDIO) {
+			continue;
+		} else if (!CanCopyAudio(stream->codecpar->codec_id)) {
+			// We don't want to lose the sound, better send as is.
+			return false;
+		}
+		_audioStreams.emplace(i, stream);
+	}
+	_decoder = FFmpeg::MakeCodecPointer({ .stream = _videoIn });
+	if (!_decoder) {
+		return false;
+	}
+	_duration = (_input->duration != AV_NOPTS_VALUE)
+		? (_input->duration / (AV_TIME_BASE / 1000))
+		: crl::time(0);
+
+	const auto original = FFmpeg::CorrectByAspect(
+		QSize(_decoder->width, _decoder->height),
+		FFmpeg::ValidateAspectRatio(_videoIn->sample_aspect_ratio));
+	if (original.isEmpty()) {
+		return false;
+	}
+	const auto scaled = (std::max(original.width(), original.height())
+		> kMaxSide)
+		? original.scaled(kMaxSide, kMaxSide, Qt::KeepAspectRatio)
+		: original;
+	_size = QSize(
+		std::max(scaled.width() & ~1, 2),
+		std::max(scaled.height() & ~1, 2));
+	_bitrate = std::max(
+		int(int64(kBitrate) * _size.width() * _size.height() / (1280 * 720)),
+		kMinBitrate);
+	if (_input->bit_rate > 0 && _input->bit_rate < _bitrate / kMinGain) {
+		// Already compressed well enough.
+		return false;
+	}
+	const auto timeBase = _videoIn->time_base;
+	_minPtsDelta = av_rescale_q(1, { 1, kMaxFrameRate }, timeBase);
+	return true;
+}
+
+FFmpeg::CodecPointer Compressor::openEncoder(const char *name) {
+	const auto codec = avcodec_find_encoder_by_name(name);
+	if (!codec) {
+		return nullptr;
+	}
+	const auto format = ChooseFormat(codec);
+	if (format == AV_PIX_FMT_NONE) {
+		return nullptr;
+	}
+	auto result = FFmpeg::CodecPointer(avcodec_alloc_context3(codec));
+	if (!result) {
+		return nullptr;
+	}
+	const auto context = result.get();
+	context->width = _size.width();
+	context->height = _size.height();
+	context->pix_fmt = format;
+	context->sample_aspect_ratio = { 1, 1 };
+
+	// Frames keep their original timestamps, variable frame rate stays.
+	context->time_base = _videoIn->time_base;
+	context->framerate = { kMaxFrameRate, 1 };
+	context->bit_rate = _bitrate;
+	context->rc_max_rate = _bitrate * 2;
+	context->rc_buffer_size = _bitrate * 2;
+	context->gop_size = kKeyframeInterval;
+	context->max_b_frames = 0;
+	if (_output->oformat->flags & AVFMT_GLOBALHEADER) {
+		context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+	}
+	const auto error = FFmpeg::AvErrorWrap(
+		avcodec_open2(context, codec, nullptr));
+	if (error) {
+		DEBUG_LOG(("Video Compress: Could not open '%1', error %2."
+			).arg(name
+			).arg(error.code()));
+		return nullptr;
+	}
+	LOG(("Video Compress Info: Using '%1' encoder.").arg(name));
+	return result;
+}
+
+bool Compressor::openOutput() {
+	auto raw = (AVFormatContext*)nullptr;
+	auto error = FFmpeg::AvErrorWrap(
+		avformat_alloc_output_context2(&raw, nullptr, "mp4", nullptr));
+	if (error || !raw) {
+		FFmpeg::LogError(qstr("avformat_alloc_output_context2"), error);
+		return false;
+	}
+	_output = OutputPointer(raw);
+	auto io = FFmpeg::MakeIOPointer(
+		static_cast<QIODevice*>(_outputDevice.get()),
+		&FFmpeg::ReadIODevice,
+		&FFmpeg::WriteIODevice,
+		&FFmpeg::SeekIODevice);
+	if (!io) {
+		return false;
+	}
+	_output->pb = io.release();
+	_output->flags |= AVFMT_FLAG_CUSTOM_IO;
+
+	for (const auto name : kHardwareEncoders) {
+		if ((_encoder = openEncoder(name))) {
+			break;
+		}
+	}
+	if (!_encoder) {
+		for (const auto name : kSoftwareEncoders) {
+			if ((_encoder = openEncoder(name))) {
+				break;
+			}
+		}
+	}
+	if (!_encoder) {
+		LOG(("Video Compress Info: No H.264 encoder available."));
+		return false;
+	}
+
+	_videoOut = avformat_new_stream(_output.get(), nullptr);
+	if (!_videoOut) {
+		return false;
+	}
+	error = avcodec_parameters_from_context(
+		_videoOut->codecpar,
+		_encoder.get());
+	if (error) {
+		FFmpeg::LogError(qstr("avcodec_parameters_from_context"), error);
+		return false;
+	}
+	_videoOut->time_base = _encoder->time_base;
+	av_dict_copy(&_videoOut->metadata, _videoIn->metadata, 0);
+	auto matrixSize = 0;
+	if (const auto matrix = av_stream_get_side_data(
+			_videoIn,
+			AV_PKT_DATA_DISPLAYMATRIX,
+			&matrixSize)) {
+		// Keep the rotation.
+		if (const auto copy = av_stream_new_side_data(
+				_videoOut,
+				AV_PKT_DATA_DISPLAYMATRIX,
+				matrixSize)) {
+			memcpy(copy, matrix, matrixSize);
+		}
+	}
+
+	for (auto &[index, stream] : _audioStreams) {
+		const auto out = avformat_new_stream(_output.get(), nullptr);
+		if (!out) {
+			return false;
+		}
+		error = avcodec_parameters_copy(out->codecpar, stream->codecpar);
+		if (error) {
+			FFmpeg::LogError(qstr("avcodec_parameters_copy"), error);
+			return false;
+		}
+		out->codecpar->codec_tag = 0;
+		out->time_base = stream->time_base;
+		av_dict_copy(&out->metadata, stream->metadata, 0);
+		// From now on map input stream index to the output stream.
+		stream = out;
+	}
+
+	auto options = (AVDictionary*)nullptr;
+	av_dict_set(&options, "movflags", "+faststart", 0);
+	error = avformat_write_header(_output.get(), &options);
+	av_dict_free(&options);
+	if (error) {
+		FFmpeg::LogError(qstr("avformat_write_header"), error);
+		return false;
+	}
+
+	_scaled->format = _encoder->pix_fmt;
+	_scaled->width = _size.width();
+	_scaled->height = _size.height();
+	error = av_frame_get_buffer(_scaled.get(), 0);
+	if (error) {
+		FFmpeg::LogError(qstr("av_frame_get_buffer"), error);
+		return false;
+	}
+	return true;
+}
+
+bool Compressor::decode(AVPacket *packet) {
+	auto error = FFmpeg::AvErrorWrap(
+		avcodec_send_packet(_decoder.get(), packet));
+	if (error && error.code() != AVERROR_EOF) {
+		// Skip broken packets, the decoder will recover on a keyframe.
+		return packet != nullptr;
+	}
+	while (true) {
+		error = avcodec_receive_frame(_decoder.get(), _frame.get());
+		if (error.code() == AVERROR(EAGAIN) || error.code() == AVERROR_EOF) {
+			return true;
+		} else if (error) {
+			FFmpeg::LogError(qstr("avcodec_receive_frame"), error);
+			return false;
+		}
+		const auto pts = _frame->best_effort_timestamp;
+		if (pts == AV_NOPTS_VALUE
+			|| (_lastPts != AV_NOPTS_VALUE
+				&& pts < _lastPts + _minPtsDelta)) {
+			// Drop frames above the maximum frame rate.
+			FFmpeg::ClearFrameMemory(_frame.get());
+			continue;
+		}
+		_lastPts = pts;
+		if (!scale(_frame.get())) {
+			return false;
+		}
+		FFmpeg::ClearFrameMemory(_frame.get());
+		_scaled->pts = pts;
+		if (!encode(_scaled.get())) {
+			return false;
+		}
+		reportProgress(pts);
+	}
+}
+
+bool Compressor::scale(not_null<AVFrame*> frame) {
+	_swscale = FFmpeg::MakeSwscalePointer(
+		QSize(frame->width, frame->height),
+		frame->format,
+		_size,
+		_encoder->pix_fmt,
+		&_swscale);
+	if (!_swscale) {
+		return false;
+	}
+	const auto error = FFmpeg::AvErrorWrap(
+		av_frame_make_writable(_scaled.get()));
+	if (error) {
+		FFmpeg::LogError(qstr("av_frame_make_writable"), error);
+		return false;
+	}
+	sws_scale(
+		_swscale.get(),
+		frame->data,
+		frame->linesize,
+		0,
+		frame->height,
+		_scaled->data,
+		_scaled->linesize);
+	return true;
+}
+
+bool Compressor::encode(AVFrame *frame) {
+	auto error = FFmpeg::AvErrorWrap(
+		avcodec_send_frame(_encoder.get(), frame));
+	if (error && error.code() != AVERROR_EOF) {
+		FFmpeg::LogError(qstr("avcodec_send_frame"), error);
+		return false;
+	}
+	while (true) {
+		auto packet = FFmpeg::Packet();
+		error = avcodec_receive_packet(_encoder.get(), &packet.fields());
+		if (error.code() == AVERROR(EAGAIN) || error.code() == AVERROR_EOF) {
+			return true;
+		} else if (error) {
+			FFmpeg::LogError(qstr("avcodec_receive_packet"), error);
+			return false;
+		}
+		auto &fields = packet.fields();
+		fields.stream_index = _videoOut->index;
+		av_packet_rescale_ts(&fields, _encoder->time_base, _videoOut->time_base);
+		if (!write(fields)) {
+			return false;
+		}
+	}
+}
+
+bool Compressor::copy(FFmpeg::Packet &&packet, not_null<AVStream*> to) {
+	auto &fields = packet.fields();
+	const auto from = _input->streams[fields.stream_index];
+	fields.stream_index = to->index;
+	fields.pos = -1;
+	av_packet_rescale_ts(&fields, from->time_base, to->time_base);
+	return write(fields);
+}
+
+bool Compressor::write(AVPacket &packet) {
+	const auto error = FFmpeg::AvErrorWrap(
+		av_interleaved_write_frame(_output.get(), &packet));
+	if (error) {
+		FFmpeg::LogError(qstr("av_interleaved_write_frame"), error);
+		return false;
+	}
+	return true;
+}
+
+void Compressor::reportProgress(int64_t pts) {
+	if (!_progress || _duration <= 0) {
+		return;
+	}
+	const auto start = (_videoIn->start_time != AV_NOPTS_VALUE)
+		? _videoIn->start_time
+		: 0;
+	const auto position = FFmpeg::PtsToTime(pts - start, _videoIn->time_base);
+	const auto percent = int(std::clamp(
+		position * 100 / _duration,
+		crl::time(0),
+		crl::time(100)));
+	if (_reportedPercent != percent) {
+		_reportedPercent = percent;
+		_progress(percent / 100.);
+	}
+}
+
+} // namespace
+
+bool CompressForSending(
+		const QString &path,
+		const QString &outputPath,
+		Fn<void(float64)> progress,
+		Fn<bool()> interrupted) {
+	auto input = QFile(path);
+	if (input.size() < kMinCompressSize
+		|| !input.open(QIODevice::ReadOnly)) {
+		return false;
+	}
+	auto output = QFile(outputPath);
+	if (!output.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+		LOG(("Video Compress Error: Could not open '%1'.").arg(outputPath));
+		return false;
+	}
+
+	const auto started = crl::now();
+	const auto done = Compressor(
+		&input,
+		&output,
+		std::move(progress),
+		std::move(interrupted)).run();
+	const auto size = output.size();
+	output.close();
+	if (!done) {
+		QFile::remove(outputPath);
+		return false;
+	}
+	LOG(("Video Compress Info: %1 -> %2 bytes in %3 ms."
+		).arg(input.size()
+		).arg(size
+		).arg(crl::now() - started));
+	if (size > input.size() * kMinGain) {
+		QFile::remove(outputPath);
+		return false;
+	}
+	return true;
+}
+
+} // namespace Media::Clip
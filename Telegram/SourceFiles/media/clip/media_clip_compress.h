@@ -0,0 +1,23 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Media::Clip {
+
+// Re-encodes a large video to H.264 in MP4 keeping its audio tracks,
+// trying the hardware encoders first, and writes it to the output path.
+// Returns false and removes the output if there is no usable encoder,
+// if the result wouldn't be noticeably smaller or if it was interrupted.
+// The callbacks are called on the same thread.
+[[nodiscard]] bool CompressForSending(
+	const QString &path,
+	const QString &outputPath,
+	Fn<void(float64)> progress = nullptr,
+	Fn<bool()> interrupted = nullptr);
+
+} // namespace Media::Clip
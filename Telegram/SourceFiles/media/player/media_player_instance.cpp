@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/player/media_player_instance.h"
 
 #include "data/data_document.h"
+#include "data/data_document_media.h"
 #include "data/data_session.h"
 #include "data/data_changes.h"
 #include "data/data_streaming.h"
@@ -17,6 +18,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/audio/media_audio_capture.h"
 #include "media/streaming/media_streaming_instance.h"
 #include "media/streaming/media_streaming_player.h"
+#include "media/streaming/media_streaming_reader.h"
 #include "media/view/media_view_playback_progress.h"
 #include "calls/calls_instance.h"
 #include "history/history.h"
@@ -31,6 +33,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "main/main_session.h"
 #include "main/main_account.h" // session->account().sessionChanges().
 #include "main/main_session_settings.h"
+#include "storage/localstorage.h"
 
 namespace Media {
 namespace Player {
@@ -49,10 +52,32 @@ constexpr auto kRememberShuffledOrderItems = 16;
 
 constexpr auto kMinLengthForSavePosition = 20 * TimeId(60); // 20 minutes.
 
+// Start loading the next track when the current one is about to end.
+constexpr auto kPreloadNextBefore = 20 * crl::time(1000);
+constexpr auto kPreloadNextSeconds = 10;
+constexpr auto kPreloadNextMinBytes = 128 * 1024;
+constexpr auto kPreloadNextLoaderPriority = 0;
+
 auto VoicePlaybackSpeed() {
 	return std::clamp(Core::App().settings().voicePlaybackSpeed(), 0.6, 1.7);
 }
 
+[[nodiscard]] int PreloadNextBytes(not_null<DocumentData*> document) {
+	const auto duration = document->song()
+		? document->song()->duration
+		: document->voice()
+		? document->voice()->duration
+		: 0;
+	if (duration <= 0) {
+		return kPreloadNextMinBytes;
+	}
+	return std::max(
+		int(std::min(
+			int64(document->size) * kPreloadNextSeconds / duration,
+			int64(std::numeric_limits<int>::max()))),
+		kPreloadNextMinBytes);
+}
+
 } // namespace
 
 struct Instance::Streamed {
@@ -736,6 +761,17 @@ void Instance::play(const AudioMsgId &audioId) {
 		}
 		playStreamed(audioId, std::move(shared));
 	}
+	if (const auto song = document->song()) {
+		// Decoding the whole file is too heavy for painting the list,
+		// so the song waveforms are counted when they are played.
+		const auto &waveform = song->waveform;
+		if (waveform.isEmpty() || waveform[0] == -3) {
+			const auto media = document->createMediaView();
+			if (media->loaded()) {
+				Local::countWaveform(media.get());
+			}
+		}
+	}
 	if (document->isVoiceMessage() || document->isVideoMessage()) {
 		document->owner().markMediaRead(document);
 	}
@@ -760,6 +796,8 @@ void Instance::playStreamed(
 	const auto data = getData(audioId.type());
 	Assert(data != nullptr);
 
+	// Keep the preloaded reader alive until the new player takes it.
+	const auto preloaded = base::take(data->preloadedNext);
 	clearStreamed(data, data->current.audio() != audioId.audio());
 	data->streamed = std::make_unique<Streamed>(
 		audioId,
@@ -774,10 +812,62 @@ void Instance::playStreamed(
 	}, data->streamed->lifetime);
 
 	data->streamed->instance.play(streamingOptions(audioId));
+	if (preloaded) {
+		// Does nothing if the new player uses this reader.
+		preloaded->stopPreload();
+	}
 
 	emitUpdate(audioId.type());
 }
 
+void Instance::preloadNext(not_null<Data*> data, crl::time position) {
+	if (!data->streamed
+		|| !data->playlistIndex
+		|| order(data) == OrderMode::Shuffle
+		|| repeat(data) == RepeatMode::One) {
+		return;
+	}
+	const auto duration = data->streamed->instance.info().audio.state.duration;
+	if (position == kTimeUnknown
+		|| duration == kTimeUnknown
+		|| duration - position > kPreloadNextBefore) {
+		return;
+	}
+	const auto index = *data->playlistIndex
+		+ ((order(data) == OrderMode::Reverse) ? -1 : 1);
+	const auto item = itemByIndex(data, index);
+	const auto media = item ? item->media() : nullptr;
+	const auto document = media ? media->document() : nullptr;
+	if (!document
+		|| !(document->isAudioFile() || document->isVoiceMessage())) {
+		clearPreloadedNext(data);
+		return;
+	} else if (data->preloadedNextId != item->fullId()) {
+		clearPreloadedNext(data);
+		data->preloadedNext = document->owner().streaming().sharedReader(
+			document,
+			item->fullId());
+		if (!data->preloadedNext) {
+			return;
+		}
+		data->preloadedNextId = item->fullId();
+		data->preloadedNextReady = !data->preloadedNext->isRemoteLoader();
+	}
+	if (!data->preloadedNextReady) {
+		data->preloadedNextReady = data->preloadedNext->preload(
+			PreloadNextBytes(document),
+			kPreloadNextLoaderPriority);
+	}
+}
+
+void Instance::clearPreloadedNext(not_null<Data*> data) {
+	if (const auto reader = base::take(data->preloadedNext)) {
+		reader->stopPreload();
+	}
+	data->preloadedNextId = FullMsgId();
+	data->preloadedNextReady = false;
+}
+
 Streaming::PlaybackOptions Instance::streamingOptions(
 		const AudioMsgId &audioId,
 		crl::time position) {
@@ -818,6 +908,7 @@ void Instance::stop(AudioMsgId::Type type) {
 		if (data->streamed) {
 			clearStreamed(data);
 		}
+		clearPreloadedNext(data);
 		data->resumeOnCallEnd = false;
 		_playerStopped.fire_copy({type});
 	}
@@ -1251,6 +1342,7 @@ void Instance::handleStreamingUpdate(
 		//emitUpdate(data->type, [](AudioMsgId) { return true; });
 	}, [&](UpdateAudio &update) {
 		emitUpdate(data->type);
+		preloadNext(data, update.position);
 	}, [&](WaitingForData) {
 	}, [&](MutedByOther) {
 	}, [&](Finished) {
@@ -28,6 +28,7 @@ class PlaybackProgress;
 namespace Media {
 namespace Streaming {
 class Document;
+class Reader;
 class Instance;
 struct PlaybackOptions;
 struct Update;
@@ -195,6 +196,9 @@ private:
 		bool resumeOnCallEnd = false;
 		std::unique_ptr<Streamed> streamed;
 		std::unique_ptr<ShuffleData> shuffleData;
+		std::shared_ptr<Streaming::Reader> preloadedNext;
+		FullMsgId preloadedNextId;
+		bool preloadedNextReady = false;
 	};
 
 	struct SeekingChanges {
@@ -215,6 +219,8 @@ private:
 	Streaming::PlaybackOptions streamingOptions(
 		const AudioMsgId &audioId,
 		crl::time position = -1);
+	void preloadNext(not_null<Data*> data, crl::time position);
+	void clearPreloadedNext(not_null<Data*> data);
 
 	// Observed notifications.
 	void handleSongUpdate(const AudioMsgId &audioId);
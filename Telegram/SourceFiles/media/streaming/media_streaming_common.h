@@ -46,6 +46,7 @@ struct PlaybackOptions {
 	bool syncVideoByAudio = true;
 	bool waitForMarkAsShown = false;
 	bool loop = false;
+	bool hwAllowed = false;
 };
 
 struct TrackState {
@@ -154,6 +155,7 @@ enum class FrameFormat {
 	None,
 	ARGB32,
 	YUV420,
+	NV12, // u holds interleaved chroma, v is empty.
 };
 
 struct FrameChannel {
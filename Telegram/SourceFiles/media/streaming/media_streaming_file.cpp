@@ -15,8 +15,22 @@ namespace Media {
 namespace Streaming {
 namespace {
 
-constexpr auto kMaxSingleReadAmount = 8 * 1024 * 1024;
+constexpr auto kMaxSingleReadAmount = Reader::kMaxFillSize;
 constexpr auto kMaxQueuedPackets = 1024;
+constexpr auto kIndexPrefetchSize = 512 * 1024;
+constexpr auto kSeekPrefetchSize = 512 * 1024;
+
+[[nodiscard]] uint32 ReadBigEndian32(bytes::const_span data) {
+	return (uint32(data[0]) << 24)
+		| (uint32(data[1]) << 16)
+		| (uint32(data[2]) << 8)
+		| uint32(data[3]);
+}
+
+[[nodiscard]] uint64 ReadBigEndian64(bytes::const_span data) {
+	return (uint64(ReadBigEndian32(data)) << 32)
+		| uint64(ReadBigEndian32(data.subspan(4)));
+}
 
 } // namespace
 
@@ -41,14 +55,15 @@ int64_t File::Context::Seek(void *opaque, int64_t offset, int whence) {
 
 int File::Context::read(bytes::span buffer) {
 	Assert(_size >= _offset);
-	const auto amount = std::min(std::size_t(_size - _offset), buffer.size());
+	// Bigger reads are cut to one cache slice, FFmpeg reads the rest
+	// with the next call.
+	const auto amount = std::min({
+		std::size_t(_size - _offset),
+		buffer.size(),
+		std::size_t(kMaxSingleReadAmount) });
 
 	if (unroll()) {
 		return -1;
-	} else if (amount > kMaxSingleReadAmount) {
-		LOG(("Streaming Error: Read callback asked for too much data: %1"
-			).arg(amount));
-		return -1;
 	} else if (!amount) {
 		return amount;
 	}
@@ -77,10 +92,16 @@ int File::Context::read(bytes::span buffer) {
 			fail(*error);
 			return -1;
 		}
+		checkPrefetchRequest();
 	}
 
 	sendFullInCache();
 
+	if (!_offset && !_indexPrefetched) {
+		_indexPrefetched = true;
+		prefetchIndex(buffer);
+	}
+
 	_offset += amount;
 	return amount;
 }
@@ -133,7 +154,8 @@ void File::Context::logFatal(
 
 Stream File::Context::initStream(
 		not_null<AVFormatContext*> format,
-		AVMediaType type) {
+		AVMediaType type,
+		bool hwAllowed) {
 	auto result = Stream();
 	const auto index = result.index = av_find_best_stream(
 		format,
@@ -161,7 +183,10 @@ Stream File::Context::initStream(
 		}
 	}
 
-	result.codec = FFmpeg::MakeCodecPointer(info);
+	result.codec = FFmpeg::MakeCodecPointer({
+		.stream = info,
+		.hwAllowed = hwAllowed,
+	});
 	if (!result.codec) {
 		return result;
 	}
@@ -243,7 +268,7 @@ std::variant<FFmpeg::Packet, FFmpeg::AvErrorWrap> File::Context::readPacket() {
 	return error;
 }
 
-void File::Context::start(crl::time position) {
+void File::Context::start(crl::time position, bool hwAllow) {
 	auto error = FFmpeg::AvErrorWrap();
 
 	if (unroll()) {
@@ -262,17 +287,22 @@ void File::Context::start(crl::time position) {
 		return logFatal(qstr("avformat_find_stream_info"), error);
 	}
 
-	auto video = initStream(format.get(), AVMEDIA_TYPE_VIDEO);
+	auto video = initStream(format.get(), AVMEDIA_TYPE_VIDEO, hwAllow);
 	if (unroll()) {
 		return;
 	}
 
-	auto audio = initStream(format.get(), AVMEDIA_TYPE_AUDIO);
+	auto audio = initStream(format.get(), AVMEDIA_TYPE_AUDIO, false);
 	if (unroll()) {
 		return;
 	}
 
 	_reader->headerDone();
+	if (format->bit_rate > 0) {
+		_reader->setBitrate(int(std::min(
+			format->bit_rate / 8,
+			int64(std::numeric_limits<int>::max()))));
+	}
 	if (_reader->isRemoteLoader()) {
 		sendFullInCache(true);
 	}
@@ -290,6 +320,11 @@ void File::Context::start(crl::time position) {
 		_queuedPackets[audio.index].reserve(kMaxQueuedPackets);
 	}
 
+	_prefetchStreamIndex = video.codec
+		? video.index
+		: audio.codec
+		? audio.index
+		: -1;
 	const auto header = _reader->headerSize();
 	if (!_delegate->fileReady(header, std::move(video), std::move(audio))) {
 		return fail(Error::OpenFailed);
@@ -297,6 +332,75 @@ void File::Context::start(crl::time position) {
 	_format = std::move(format);
 }
 
+void File::Context::prefetchIndex(bytes::const_span header) {
+	// MP4 files without "faststart" have the "moov" atom after "mdat".
+	// FFmpeg reaches it only after reading the top level atom headers one
+	// by one, so we start loading the place where it should be at once.
+	constexpr auto kAtomHeader = 8;
+	constexpr auto kLargeAtomHeader = 16;
+	const auto type = [&](int64 offset) {
+		return QByteArray::fromRawData(
+			reinterpret_cast<const char*>(header.data() + offset + 4),
+			4);
+	};
+	auto offset = int64(0);
+	while (offset + kAtomHeader <= int64(header.size())) {
+		auto size = int64(ReadBigEndian32(header.subspan(offset)));
+		if (size == 1) {
+			if (offset + kLargeAtomHeader > int64(header.size())) {
+				return;
+			}
+			size = int64(ReadBigEndian64(header.subspan(offset + 8)));
+		}
+		if (size < kAtomHeader) {
+			// Zero size means the atom lasts till the end of the file.
+			return;
+		} else if (!offset && type(offset) != "ftyp") {
+			return;
+		} else if (type(offset) == "moov") {
+			return;
+		}
+		offset += size;
+	}
+	if (offset < _size) {
+		_reader->prefetch(
+			int(offset),
+			int(std::min(offset + kIndexPrefetchSize, int64(_size))));
+	}
+}
+
+void File::Context::prefetch(crl::time position) {
+	_prefetchPosition = position;
+	_semaphore.release();
+}
+
+void File::Context::checkPrefetchRequest() {
+	const auto position = _prefetchPosition.exchange(kTimeUnknown);
+	if (position == kTimeUnknown || !_format || _prefetchStreamIndex < 0) {
+		return;
+	} else if (!_reader->isRemoteLoader() || _reader->fullInCache()) {
+		return;
+	}
+	const auto stream = _format->streams[_prefetchStreamIndex];
+	const auto index = av_index_search_timestamp(
+		stream,
+		FFmpeg::TimeToPts(position, stream->time_base),
+		AVSEEK_FLAG_BACKWARD);
+	if (index < 0 || index >= stream->nb_index_entries) {
+		return;
+	}
+	const auto entry = &stream->index_entries[index];
+	if (entry->pos < 0
+		|| entry->pos >= _size
+		|| entry->pos == _prefetchedOffset) {
+		return;
+	}
+	_prefetchedOffset = entry->pos;
+	_reader->prefetch(
+		int(entry->pos),
+		int(std::min(entry->pos + kSeekPrefetchSize, int64(_size))));
+}
+
 void File::Context::sendFullInCache(bool force) {
 	const auto started = _fullInCache.has_value();
 	if (force || started) {
@@ -309,6 +413,7 @@ void File::Context::sendFullInCache(bool force) {
 }
 
 void File::Context::readNextPacket() {
+	checkPrefetchRequest();
 	auto result = readPacket();
 	if (unroll()) {
 		return;
@@ -363,6 +468,7 @@ void File::Context::processQueuedPackets(SleepPolicy policy) {
 			_reader->startSleep(&_semaphore);
 			_semaphore.acquire();
 			_reader->stopSleep();
+			checkPrefetchRequest();
 		} while (!unroll() && !_delegate->fileReadMore());
 	}
 }
@@ -407,7 +513,10 @@ File::File(std::shared_ptr<Reader> reader)
 : _reader(std::move(reader)) {
 }
 
-void File::start(not_null<FileDelegate*> delegate, crl::time position) {
+void File::start(
+		not_null<FileDelegate*> delegate,
+		crl::time position,
+		bool hwAllow) {
 	stop(true);
 
 	_reader->startStreaming();
@@ -415,7 +524,7 @@ void File::start(not_null<FileDelegate*> delegate, crl::time position) {
 
 	_thread = std::thread([=, context = &*_context] {
 		crl::toggle_fp_exceptions(true);
-		context->start(position);
+		context->start(position, hwAllow);
 		while (!context->finished()) {
 			context->readNextPacket();
 		}
@@ -444,6 +553,12 @@ bool File::isRemoteLoader() const {
 	return _reader->isRemoteLoader();
 }
 
+void File::prefetch(crl::time position) {
+	if (_context) {
+		_context->prefetch(position);
+	}
+}
+
 void File::setLoaderPriority(int priority) {
 	_reader->setLoaderPriority(priority);
 }
@@ -28,10 +28,16 @@ public:
 	File(const File &other) = delete;
 	File &operator=(const File &other) = delete;
 
-	void start(not_null<FileDelegate*> delegate, crl::time position);
+	void start(
+		not_null<FileDelegate*> delegate,
+		crl::time position,
+		bool hwAllow);
 	void wake();
 	void stop(bool stillActive = false);
 
+	// Loads the data around the keyframe before this position in advance.
+	void prefetch(crl::time position);
+
 	[[nodiscard]] bool isRemoteLoader() const;
 	void setLoaderPriority(int priority);
 
@@ -43,11 +49,12 @@ private:
 		Context(not_null<FileDelegate*> delegate, not_null<Reader*> reader);
 		~Context();
 
-		void start(crl::time position);
+		void start(crl::time position, bool hwAllow);
 		void readNextPacket();
 
 		void interrupt();
 		void wake();
+		void prefetch(crl::time position);
 		[[nodiscard]] bool interrupted() const;
 		[[nodiscard]] bool failed() const;
 		[[nodiscard]] bool finished() const;
@@ -74,7 +81,8 @@ private:
 
 		Stream initStream(
 			not_null<AVFormatContext *> format,
-			AVMediaType type);
+			AVMediaType type,
+			bool hwAllowed);
 		void seekToPosition(
 			not_null<AVFormatContext *> format,
 			const Stream &stream,
@@ -88,6 +96,9 @@ private:
 		void handleEndOfFile();
 		void sendFullInCache(bool force = false);
 
+		void prefetchIndex(bytes::const_span header);
+		void checkPrefetchRequest();
+
 		const not_null<FileDelegate*> _delegate;
 		const not_null<Reader*> _reader;
 
@@ -99,6 +110,10 @@ private:
 		std::optional<bool> _fullInCache;
 		crl::semaphore _semaphore;
 		std::atomic<bool> _interrupted = false;
+		std::atomic<crl::time> _prefetchPosition = kTimeUnknown;
+		int _prefetchStreamIndex = -1;
+		int64 _prefetchedOffset = -1;
+		bool _indexPrefetched = false;
 
 		FFmpeg::FormatPointer _format;
 
@@ -220,6 +220,12 @@ int Instance::priority() const {
 	return _priority;
 }
 
+void Instance::prefetch(crl::time position) {
+	Expects(_shared != nullptr);
+
+	_shared->player().prefetch(position);
+}
+
 rpl::lifetime &Instance::lifetime() {
 	return _lifetime;
 }
@@ -79,6 +79,8 @@ public:
 	void setPriority(int priority);
 	[[nodiscard]] int priority() const;
 
+	void prefetch(crl::time position);
+
 	[[nodiscard]] rpl::lifetime &lifetime();
 
 private:
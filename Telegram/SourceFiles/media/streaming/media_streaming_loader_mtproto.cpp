@@ -119,6 +119,10 @@ bool LoaderMtproto::readyToRequest() const {
 	return !_requested.empty();
 }
 
+Storage::DownloadClass LoaderMtproto::downloadClass() const {
+	return Storage::DownloadClass::Streaming;
+}
+
 int LoaderMtproto::takeNextRequestOffset() {
 	const auto offset = _requested.take();
 
@@ -43,6 +43,7 @@ public:
 
 private:
 	bool readyToRequest() const override;
+	Storage::DownloadClass downloadClass() const override;
 	int takeNextRequestOffset() override;
 	bool feedPart(int offset, const QByteArray &bytes) override;
 	void cancelOnFail() override;
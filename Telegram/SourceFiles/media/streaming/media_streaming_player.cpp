@@ -145,6 +145,12 @@ void Player::setLoaderPriority(int priority) {
 	_file->setLoaderPriority(priority);
 }
 
+void Player::prefetch(crl::time position) {
+	if (_remoteLoader && !_fullInCacheSinceStart.value_or(false)) {
+		_file->prefetch(position);
+	}
+}
+
 template <typename Track>
 void Player::trackReceivedTill(
 		const Track &track,
@@ -539,7 +545,7 @@ void Player::play(const PlaybackOptions &options) {
 		_options.speed = 1.;
 	}
 	_stage = Stage::Initializing;
-	_file->start(delegate(), _options.position);
+	_file->start(delegate(), _options.position, _options.hwAllowed);
 }
 
 void Player::savePreviousReceivedTill(
@@ -74,6 +74,7 @@ public:
 	bool markFrameShown();
 
 	void setLoaderPriority(int priority);
+	void prefetch(crl::time position); // For a likely seek target.
 
 	[[nodiscard]] Media::Player::TrackState prepareLegacyState() const;
 
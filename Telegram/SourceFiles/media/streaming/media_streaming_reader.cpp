@@ -10,21 +10,36 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/streaming/media_streaming_common.h"
 #include "media/streaming/media_streaming_loader.h"
 #include "storage/cache/storage_cache_database.h"
+#include "storage/storage_cache_usage.h"
 
 namespace Media {
 namespace Streaming {
 namespace {
 
 constexpr auto kPartSize = Loader::kPartSize;
-constexpr auto kPartsInSlice = 64;
+constexpr auto kPartsInSlice = 16;
 constexpr auto kInSlice = kPartsInSlice * kPartSize;
+static_assert(kInSlice == Reader::kMaxFillSize);
 constexpr auto kMaxPartsInHeader = 64;
 constexpr auto kMaxOnlyInHeader = 80 * kPartSize;
 constexpr auto kPartsOutsideFirstSliceGood = 8;
-constexpr auto kSlicesInMemory = 2;
+constexpr auto kSlicesInMemory = 8;
+
+// Old 8 MB slices were stored right after the base key, the current 2 MB
+// slices use different keys so that the old ones just expire in the cache.
+constexpr auto kSlicesKeyShift = uint64(0x8000);
+
+// Preloading without a player covers at most the first 8 MB, it was
+// one slice before the slices became smaller.
+constexpr auto kPreloadSlicesMax = 4;
 
 // 1 MB of parts are requested from cloud ahead of reading demand.
 constexpr auto kPreloadPartsAhead = 8;
+
+// With a known bitrate we try to have that much of the media loaded ahead.
+constexpr auto kPreloadDuration = 10 * crl::time(1000);
+constexpr auto kMinPreloadPartsAhead = 2;
+constexpr auto kThroughputWindow = 2 * crl::time(1000);
 constexpr auto kDownloaderRequestsLimit = 4;
 
 using PartsMap = base::flat_map<int, QByteArray>;
@@ -233,7 +248,10 @@ Reader::CacheHelper::CacheHelper(Storage::Cache::Key baseKey)
 }
 
 Storage::Cache::Key Reader::CacheHelper::key(int sliceNumber) const {
-	return Storage::Cache::Key{ baseKey.high, baseKey.low + sliceNumber };
+	return Storage::Cache::Key{
+		baseKey.high,
+		baseKey.low + kSlicesKeyShift + sliceNumber,
+	};
 }
 
 void Reader::Slice::processCacheData(PartsMap &&data) {
@@ -251,25 +269,27 @@ void Reader::Slice::processCacheData(PartsMap &&data) {
 			parts.emplace(offset, std::move(bytes));
 		}
 	}
+	partsChanged();
 }
 
 void Reader::Slice::addPart(int offset, QByteArray bytes) {
 	Expects(!parts.contains(offset));
 
 	parts.emplace(offset, std::move(bytes));
+	partsChanged();
 	if (flags & Flag::LoadedFromCache) {
 		flags |= Flag::ChangedSinceCache;
 	}
 }
 
-auto Reader::Slice::prepareFill(int from, int till) -> PrepareFillResult {
+auto Reader::Slice::prepareFill(int from, int till, int preloadParts)
+-> PrepareFillResult {
 	auto result = PrepareFillResult();
 
 	result.ready = false;
 	const auto fromOffset = (from / kPartSize) * kPartSize;
 	const auto tillPart = (till + kPartSize - 1) / kPartSize;
-	const auto preloadTillOffset = (tillPart + kPreloadPartsAhead)
-		* kPartSize;
+	const auto preloadTillOffset = (tillPart + preloadParts) * kPartSize;
 
 	const auto after = ranges::upper_bound(
 		parts,
@@ -332,6 +352,14 @@ auto Reader::Slice::offsetsFromLoader(int from, int till) const
 	return result;
 }
 
+void Reader::Slice::partsChanged() {
+	auto bytes = int64();
+	for (const auto &[offset, part] : parts) {
+		bytes += part.size();
+	}
+	memory.set(bytes);
+}
+
 Reader::Slices::Slices(int size, bool useCache)
 : _size(size) {
 	Expects(size > 0);
@@ -540,7 +568,10 @@ void Reader::Slices::processPart(
 	checkSliceFullLoaded(index + 1);
 }
 
-auto Reader::Slices::fill(int offset, bytes::span buffer) -> FillResult {
+auto Reader::Slices::fill(
+		int offset,
+		bytes::span buffer,
+		int preloadParts) -> FillResult {
 	Expects(!buffer.empty());
 	Expects(offset >= 0 && offset < _size);
 	Expects(offset + buffer.size() <= _size);
@@ -554,7 +585,7 @@ auto Reader::Slices::fill(int offset, bytes::span buffer) -> FillResult {
 		Assert(waitingForHeaderCache());
 		return {};
 	} else if (isFullInHeader()) {
-		return fillFromHeader(offset, buffer);
+		return fillFromHeader(offset, buffer, preloadParts);
 	}
 
 	auto result = FillResult();
@@ -596,14 +627,38 @@ auto Reader::Slices::fill(int offset, bytes::span buffer) -> FillResult {
 	const auto firstTill = std::min(kInSlice, till - fromSlice * kInSlice);
 	const auto secondFrom = 0;
 	const auto secondTill = till - (fromSlice + 1) * kInSlice;
-	const auto first = _data[fromSlice].prepareFill(firstFrom, firstTill);
+	const auto first = _data[fromSlice].prepareFill(
+		firstFrom,
+		firstTill,
+		preloadParts);
 	const auto second = (fromSlice + 1 < tillSlice)
-		? _data[fromSlice + 1].prepareFill(secondFrom, secondTill)
+		? _data[fromSlice + 1].prepareFill(
+			secondFrom,
+			secondTill,
+			preloadParts)
 		: Slice::PrepareFillResult();
 	handlePrepareResult(fromSlice, first);
 	if (fromSlice + 1 < tillSlice) {
 		handlePrepareResult(fromSlice + 1, second);
 	}
+
+	// Continue loading ahead in the next slice if we're close to its start.
+	const auto preloadTill = ((till + kPartSize - 1) / kPartSize
+		+ preloadParts) * kPartSize;
+	const auto nextSlice = tillSlice;
+	if (nextSlice < int(_data.size())
+		&& preloadTill > nextSlice * kInSlice
+		&& !cacheNotLoaded(nextSlice)) {
+		const auto ahead = _data[nextSlice].offsetsFromLoader(
+			0,
+			std::min(preloadTill - nextSlice * kInSlice, kInSlice));
+		for (const auto offset : ahead.values()) {
+			const auto full = offset + nextSlice * kInSlice;
+			if (full < _size) {
+				result.offsetsFromLoader.add(full);
+			}
+		}
+	}
 	if (first.ready && second.ready) {
 		markSliceUsed(fromSlice);
 		CopyLoaded(
@@ -630,13 +685,15 @@ auto Reader::Slices::fill(int offset, bytes::span buffer) -> FillResult {
 	return result;
 }
 
-auto Reader::Slices::fillFromHeader(int offset, bytes::span buffer)
--> FillResult {
+auto Reader::Slices::fillFromHeader(
+		int offset,
+		bytes::span buffer,
+		int preloadParts) -> FillResult {
 	auto result = FillResult();
 	const auto from = offset;
 	const auto till = int(offset + buffer.size());
 
-	const auto prepared = _header.prepareFill(from, till);
+	const auto prepared = _header.prepareFill(from, till, preloadParts);
 	for (const auto full : prepared.offsetsFromLoader.values()) {
 		if (full < _size) {
 			result.offsetsFromLoader.add(full);
@@ -653,6 +710,46 @@ auto Reader::Slices::fillFromHeader(int offset, bytes::span buffer)
 	return result;
 }
 
+auto Reader::Slices::prefetch(int from, int till) -> FillResult {
+	Expects(from >= 0 && from < till);
+
+	using Flag = Slice::Flag;
+
+	auto result = FillResult();
+	if ((_headerMode != HeaderMode::NoCache
+		&& !(_header.flags & Flag::LoadedFromCache))
+		|| isFullInHeader()) {
+		return result;
+	}
+	const auto index = from / kInSlice;
+	if (index >= int(_data.size())) {
+		return result;
+	}
+	auto &slice = _data[index];
+	if (_headerMode != HeaderMode::NoCache
+		&& _headerMode != HeaderMode::Unknown
+		&& !(slice.flags & Flag::LoadedFromCache)) {
+		if (!(slice.flags & Flag::LoadingFromCache)) {
+			slice.flags |= Flag::LoadingFromCache;
+			result.sliceNumbersFromCache.add(index + 1);
+		}
+		return result;
+	}
+	const auto sliceFrom = ((from - index * kInSlice) / kPartSize)
+		* kPartSize;
+	const auto sliceTill = std::min(
+		((till - index * kInSlice + kPartSize - 1) / kPartSize) * kPartSize,
+		kInSlice);
+	for (const auto offset
+		: slice.offsetsFromLoader(sliceFrom, sliceTill).values()) {
+		const auto full = offset + index * kInSlice;
+		if (full < _size) {
+			result.offsetsFromLoader.add(full);
+		}
+	}
+	return result;
+}
+
 QByteArray Reader::Slices::partForDownloader(int offset) const {
 	Expects(offset < _size);
 
@@ -824,6 +921,7 @@ QByteArray Reader::Slices::serializeAndUnloadFirstSliceNoHeader() {
 	for (const auto &[offset, part] : _header.parts) {
 		slice.parts.erase(offset);
 	}
+	slice.partsChanged();
 	auto result = serializeComplexSlice(slice);
 	unloadSlice(slice);
 	return result;
@@ -857,9 +955,14 @@ Reader::Reader(
 		if (_attachedDownloader) {
 			_partsForDownloader.fire_copy(part);
 		}
-		if (_streamingActive) {
+		if (_streamingActive || _preloading) {
 			_loadedParts.emplace(std::move(part));
 		}
+		if (_preloading && !_streamingActive) {
+			crl::on_main(this, [=] {
+				notifyPreloadUpdate();
+			});
+		}
 		if (const auto waiting = _waiting.load(std::memory_order_acquire)) {
 			_waiting.store(nullptr, std::memory_order_release);
 			waiting->release();
@@ -874,6 +977,7 @@ Reader::Reader(
 void Reader::startSleep(not_null<crl::semaphore*> wake) {
 	_sleeping.store(wake, std::memory_order_release);
 	processDownloaderRequests();
+	processPreloadRequests();
 }
 
 void Reader::wakeFromSleep() {
@@ -901,10 +1005,84 @@ void Reader::tryRemoveLoaderAsync() {
 }
 
 void Reader::startStreaming() {
+	_preloading = false;
 	_streamingActive = true;
 	refreshLoaderPriority();
 }
 
+bool Reader::preload(int till, int priority) {
+	if (_attachedDownloader) {
+		return true;
+	}
+	_preloadRequests.emplace(till);
+	if (_streamingActive) {
+		// The streaming thread owns the slices now, let it process this.
+		wakeFromSleep();
+		return true;
+	} else if (!_preloading) {
+		// The loaded parts are kept until the player processes them.
+		_preloading = true;
+		_realPriority = priority;
+		refreshLoaderPriority();
+	}
+	return processPreloadRequests();
+}
+
+bool Reader::processPreloadRequests() {
+	auto till = 0;
+	for (const auto value : _preloadRequests.take()) {
+		till = std::max(till, value);
+	}
+	if (till <= 0) {
+		return true;
+	}
+	checkForSomethingMoreReceived();
+	if (_streamingError) {
+		return true;
+	} else if (_slices.waitingForHeaderCache()) {
+		return false;
+	}
+	till = std::min({ till, kPreloadSlicesMax * kInSlice, size() });
+
+	// Slices::prefetch() works inside of a single slice.
+	auto waitingCache = false;
+	for (auto from = 0; from < till; from += kInSlice) {
+		auto result = _slices.prefetch(from, std::min(from + kInSlice, till));
+		for (const auto offset : result.offsetsFromLoader.values()) {
+			loadAtOffset(offset);
+		}
+		for (const auto number : result.sliceNumbersFromCache.values()) {
+			readFromCache(number);
+			waitingCache = true;
+		}
+	}
+	return !waitingCache;
+}
+
+void Reader::notifyPreloadUpdate() {
+	if (_preloading && !_streamingActive) {
+		_preloadUpdates.fire({});
+	}
+}
+
+rpl::producer<> Reader::preloadUpdates() const {
+	return _preloadUpdates.events();
+}
+
+void Reader::stopPreload() {
+	if (!_preloading) {
+		return;
+	}
+	_preloading = false;
+	_preloadRequests.take();
+	if (!_streamingActive) {
+		processLoadedParts();
+		refreshLoaderPriority();
+		_loadingOffsets.clear();
+		processDownloaderRequests();
+	}
+}
+
 void Reader::stopStreaming(bool stillActive) {
 	Expects(_sleeping == nullptr);
 
@@ -925,6 +1103,7 @@ rpl::producer<LoadedPart> Reader::partsForDownloader() const {
 void Reader::loadForDownloader(
 		not_null<Storage::StreamedFileDownloader*> downloader,
 		int offset) {
+	stopPreload();
 	if (_attachedDownloader != downloader) {
 		if (_attachedDownloader) {
 			cancelForDownloader(_attachedDownloader);
@@ -1106,7 +1285,9 @@ void Reader::setLoaderPriority(int priority) {
 }
 
 void Reader::refreshLoaderPriority() {
-	_loader->setPriority(_streamingActive ? _realPriority : 0);
+	_loader->setPriority((_streamingActive || _preloading)
+		? _realPriority
+		: 0);
 }
 
 bool Reader::isRemoteLoader() const {
@@ -1134,9 +1315,14 @@ void Reader::readFromCache(int sliceNumber) {
 	const auto key = _cacheHelper->key(sliceNumber);
 	const auto cache = std::weak_ptr<CacheHelper>(_cacheHelper);
 	const auto weak = base::make_weak(this);
+	const auto started = crl::now();
 	const auto ready = [=](
 			QByteArray &&result,
 			std::vector<int> &&sizes = {}) {
+		Storage::RecordCacheRead(
+			Storage::kCacheBigFileUsageTag,
+			result.size(),
+			crl::now() - started);
 		crl::async([
 			=,
 			result = std::move(result),
@@ -1159,6 +1345,7 @@ void Reader::readFromCache(int sliceNumber) {
 				} else {
 					crl::on_main(weak, [=] {
 						checkCacheResultsForDownloader();
+						notifyPreloadUpdate();
 					});
 				}
 			}
@@ -1259,7 +1446,7 @@ Reader::FillState Reader::fill(
 Reader::FillState Reader::fillFromSlices(int offset, bytes::span buffer) {
 	using namespace rpl::mappers;
 
-	auto result = _slices.fill(offset, buffer);
+	auto result = _slices.fill(offset, buffer, preloadPartsAhead());
 	if (result.state != FillState::Success && _slices.headerWontBeFilled()) {
 		_streamingError = Error::NotStreamable;
 		return FillState::Failed;
@@ -1356,6 +1543,7 @@ bool Reader::processLoadedParts() {
 		} else if (!_loadingOffsets.remove(part.offset)) {
 			continue;
 		}
+		updateThroughput(part.bytes.size());
 		_slices.processPart(
 			part.offset,
 			std::move(part.bytes));
@@ -1363,6 +1551,64 @@ bool Reader::processLoadedParts() {
 	return !loaded.empty();
 }
 
+void Reader::setBitrate(int bytesPerSecond) {
+	_bitrate = bytesPerSecond;
+}
+
+void Reader::prefetch(int from, int till) {
+	if (_streamingError || from >= till) {
+		return;
+	} else if (!isRemoteLoader() || fullInCache()) {
+		// Local and fully cached files are read right away anyway.
+		return;
+	}
+	auto result = _slices.prefetch(from, till);
+	for (const auto sliceNumber : result.sliceNumbersFromCache.values()) {
+		readFromCache(sliceNumber);
+	}
+	for (const auto offset : result.offsetsFromLoader.values()) {
+		loadAtOffset(offset);
+	}
+}
+
+void Reader::updateThroughput(int received) {
+	const auto now = crl::now();
+	if (!_throughputStarted
+		|| now - _throughputLastPart > kThroughputWindow) {
+		// We were idle, don't count the pause as a slow download.
+		_throughputStarted = _throughputLastPart = now;
+		_throughputBytes = received;
+		return;
+	}
+	_throughputLastPart = now;
+	_throughputBytes += received;
+	if (now - _throughputStarted >= kThroughputWindow) {
+		_throughput = int(_throughputBytes
+			* 1000
+			/ (now - _throughputStarted));
+		_throughputStarted = now;
+		_throughputBytes = 0;
+	}
+}
+
+int Reader::preloadPartsAhead() const {
+	if (_bitrate <= 0) {
+		return kPreloadPartsAhead;
+	}
+	// Request more parts at once if we're loading slower than playing.
+	const auto slowdown = (_throughput > 0 && _throughput < _bitrate)
+		? (float64(_bitrate) / _throughput)
+		: 1.;
+	const auto bytes = float64(_bitrate)
+		* kPreloadDuration
+		/ 1000.
+		* slowdown;
+	return std::clamp(
+		int(std::ceil(bytes / kPartSize)),
+		kMinPreloadPartsAhead,
+		kLoadFromRemoteMax);
+}
+
 bool Reader::checkForSomethingMoreReceived() {
 	const auto result1 = processCacheResults();
 	const auto result2 = processLoadedParts();
@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/bytes.h"
 #include "base/weak_ptr.h"
 #include "base/thread_safe_wrap.h"
+#include "core/memory_stats.h"
 
 namespace Storage {
 class StreamedFileDownloader;
@@ -50,7 +51,8 @@ public:
 	[[nodiscard]] int size() const;
 	[[nodiscard]] bool isRemoteLoader() const;
 
-	// Single thread.
+	// Single thread. Fills at most one cache slice at a time.
+	static constexpr auto kMaxFillSize = 2 * 1024 * 1024;
 	[[nodiscard]] FillState fill(
 		int offset,
 		bytes::span buffer,
@@ -59,6 +61,8 @@ public:
 	void headerDone();
 	[[nodiscard]] int headerSize() const;
 	[[nodiscard]] bool fullInCache() const;
+	void setBitrate(int bytesPerSecond);
+	void prefetch(int from, int till);
 
 	// Thread safe.
 	void startSleep(not_null<crl::semaphore*> wake);
@@ -70,6 +74,17 @@ public:
 	// Main thread.
 	void startStreaming();
 	void stopStreaming(bool stillActive = false);
+
+	// Main thread. Loads the beginning of the file so that a player
+	// started later has it ready. If a player already streams this reader
+	// the request is passed to the streaming thread.
+	// Returns false while it still waits for the cache.
+	[[nodiscard]] bool preload(int till, int priority);
+	void stopPreload();
+
+	// Main thread. Fires while preloading without a player each time the
+	// cache or the loader delivers something, so preload() can be retried.
+	[[nodiscard]] rpl::producer<> preloadUpdates() const;
 	[[nodiscard]] rpl::producer<LoadedPart> partsForDownloader() const;
 	void loadForDownloader(
 		not_null<Storage::StreamedFileDownloader*> downloader,
@@ -81,7 +96,7 @@ public:
 	~Reader();
 
 private:
-	static constexpr auto kLoadFromRemoteMax = 8;
+	static constexpr auto kLoadFromRemoteMax = 16;
 
 	struct CacheHelper;
 
@@ -129,15 +144,20 @@ private:
 
 		void processCacheData(PartsMap &&data);
 		void addPart(int offset, QByteArray bytes);
-		PrepareFillResult prepareFill(int from, int till);
+		PrepareFillResult prepareFill(int from, int till, int preloadParts);
 
 		// Get up to kLoadFromRemoteMax not loaded parts in from-till range.
 		StackIntVector<kLoadFromRemoteMax> offsetsFromLoader(
 			int from,
 			int till) const;
 
+		void partsChanged();
+
 		PartsMap parts;
 		Flags flags;
+		Core::MemoryStats::Counter memory{
+			Core::MemoryStats::Tag::StreamingCache
+		};
 
 	};
 
@@ -160,7 +180,11 @@ private:
 		void processCachedSizes(const std::vector<int> &sizes);
 		void processPart(int offset, QByteArray &&bytes);
 
-		[[nodiscard]] FillResult fill(int offset, bytes::span buffer);
+		[[nodiscard]] FillResult fill(
+			int offset,
+			bytes::span buffer,
+			int preloadParts);
+		[[nodiscard]] FillResult prefetch(int from, int till);
 		[[nodiscard]] SerializedSlice unloadToCache();
 
 		[[nodiscard]] QByteArray partForDownloader(int offset) const;
@@ -187,7 +211,8 @@ private:
 		[[nodiscard]] bool computeIsGoodHeader() const;
 		[[nodiscard]] FillResult fillFromHeader(
 			int offset,
-			bytes::span buffer);
+			bytes::span buffer,
+			int preloadParts);
 		void unloadSlice(Slice &slice) const;
 		void checkSliceFullLoaded(int sliceNumber);
 		[[nodiscard]] bool checkFullInCache() const;
@@ -212,6 +237,8 @@ private:
 	void loadAtOffset(int offset);
 	void checkLoadWillBeFirst(int offset);
 	bool processLoadedParts();
+	void updateThroughput(int received);
+	[[nodiscard]] int preloadPartsAhead() const;
 
 	bool checkForSomethingMoreReceived();
 
@@ -220,6 +247,8 @@ private:
 	void finalizeCache();
 
 	void processDownloaderRequests();
+	bool processPreloadRequests();
+	void notifyPreloadUpdate();
 	void checkCacheResultsForDownloader();
 	void pruneDownloaderCache(int minimalOffset);
 	void pruneDoneDownloaderRequests();
@@ -248,6 +277,13 @@ private:
 
 	Slices _slices;
 
+	// Streaming thread, used to choose how many parts to load ahead.
+	int _bitrate = 0;
+	int _throughput = 0;
+	int64 _throughputBytes = 0;
+	crl::time _throughputStarted = 0;
+	crl::time _throughputLastPart = 0;
+
 	// Even if streaming had failed, the Reader can work for the downloader.
 	std::optional<Error> _streamingError;
 
@@ -257,8 +293,10 @@ private:
 	// Main thread.
 	Storage::StreamedFileDownloader *_attachedDownloader = nullptr;
 	rpl::event_stream<LoadedPart> _partsForDownloader;
+	rpl::event_stream<> _preloadUpdates;
 	int _realPriority = 1;
 	bool _streamingActive = false;
+	bool _preloading = false;
 
 	// Streaming thread.
 	std::deque<int> _offsetsForDownloader;
@@ -269,6 +307,7 @@ private:
 	// Streaming thread to main thread communicates using crl::on_main.
 	base::thread_safe_queue<int> _downloaderOffsetRequests;
 	base::thread_safe_queue<int> _downloaderOffsetAcks;
+	base::thread_safe_queue<int> _preloadRequests;
 
 	rpl::lifetime _lifetime;
 
@@ -11,11 +11,89 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/image/image_prepare.h"
 #include "ffmpeg/ffmpeg_utility.h"
 
+extern "C" {
+#include <libavutil/hwcontext.h>
+#include <libavutil/imgutils.h>
+} // extern "C"
+
 namespace Media {
 namespace Streaming {
 namespace {
 
 constexpr auto kSkipInvalidDataPackets = 10;
+constexpr auto kTransferAlignment = 64;
+
+// Takes the planes of the transferred frame from a pool, so that the
+// buffers return there when the decoded frame is unreferenced later.
+FFmpeg::AvErrorWrap AllocateTransferred(
+		Stream &stream,
+		not_null<AVFrame*> to,
+		not_null<const AVFrame*> from) {
+	const auto frames = reinterpret_cast<AVHWFramesContext*>(
+		from->hw_frames_ctx->data);
+	const auto format = frames->sw_format;
+	const auto size = av_image_get_buffer_size(
+		format,
+		from->width,
+		from->height,
+		kTransferAlignment);
+	if (size <= 0) {
+		return size ? size : AVERROR(EINVAL);
+	} else if (!stream.transferPool || stream.transferPoolSize != size) {
+		stream.transferPool = FFmpeg::MakeBufferPoolPointer(size);
+		stream.transferPoolSize = size;
+		if (!stream.transferPool) {
+			return AVERROR(ENOMEM);
+		}
+	}
+	to->buf[0] = av_buffer_pool_get(stream.transferPool.get());
+	if (!to->buf[0]) {
+		return AVERROR(ENOMEM);
+	}
+	to->format = format;
+	to->width = from->width;
+	to->height = from->height;
+	return av_image_fill_arrays(
+		to->data,
+		to->linesize,
+		to->buf[0]->data,
+		format,
+		from->width,
+		from->height,
+		kTransferAlignment);
+}
+
+FFmpeg::AvErrorWrap TransferHardwareFrame(Stream &stream) {
+	if (!stream.transferred) {
+		stream.transferred = FFmpeg::MakeFramePointer();
+		if (!stream.transferred) {
+			return AVERROR(ENOMEM);
+		}
+	}
+	const auto from = stream.frame.get();
+	const auto to = stream.transferred.get();
+	av_frame_unref(to);
+
+	auto error = AllocateTransferred(stream, to, from);
+	if (error) {
+		av_frame_unref(to);
+		FFmpeg::LogError(qstr("av_buffer_pool_get"), error);
+		return error;
+	}
+
+	// Usually gives NV12 (or P010 for 10 bit streams) in system memory.
+	error = av_hwframe_transfer_data(to, from, 0);
+	if (error) {
+		FFmpeg::LogError(qstr("av_hwframe_transfer_data"), error);
+		return error;
+	} else if ((error = av_frame_copy_props(to, from))) {
+		FFmpeg::LogError(qstr("av_frame_copy_props"), error);
+		return error;
+	}
+	av_frame_unref(from);
+	std::swap(stream.frame, stream.transferred);
+	return error;
+}
 
 } // namespace
 
@@ -74,7 +152,9 @@ FFmpeg::AvErrorWrap ReadNextFrame(Stream &stream) {
 		error = avcodec_receive_frame(
 			stream.codec.get(),
 			stream.frame.get());
-		if (!error
+		if (!error && stream.frame->hw_frames_ctx) {
+			return TransferHardwareFrame(stream);
+		} else if (!error
 			|| error.code() != AVERROR(EAGAIN)
 			|| stream.queue.empty()) {
 			return error;
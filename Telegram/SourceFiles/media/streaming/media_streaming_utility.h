@@ -41,6 +41,9 @@ struct Stream {
 	int rotation = 0;
 	AVRational aspect = FFmpeg::kNormalAspect;
 	FFmpeg::SwscalePointer swscale;
+	FFmpeg::FramePointer transferred; // Hardware decoded frames target.
+	FFmpeg::BufferPoolPointer transferPool;
+	int transferPoolSize = 0;
 };
 
 [[nodiscard]] crl::time FramePosition(const Stream &stream);
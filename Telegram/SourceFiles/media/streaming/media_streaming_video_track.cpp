@@ -21,22 +21,35 @@ constexpr auto kDisplaySkipped = crl::time(-1);
 constexpr auto kFinishedPosition = std::numeric_limits<crl::time>::max();
 static_assert(kDisplaySkipped != kTimeUnknown);
 
-[[nodiscard]] QImage ConvertToARGB32(const FrameYUV420 &data) {
+[[nodiscard]] bool IsPlanarYUV(FrameFormat format) {
+	return (format == FrameFormat::YUV420) || (format == FrameFormat::NV12);
+}
+
+[[nodiscard]] QImage ConvertToARGB32(
+		FrameFormat format,
+		const FrameYUV420 &data,
+		QImage storage,
+		FFmpeg::SwscalePointer &swscale) {
 	Expects(data.y.data != nullptr);
 	Expects(data.u.data != nullptr);
-	Expects(data.v.data != nullptr);
+	Expects(format == FrameFormat::NV12 || data.v.data != nullptr);
 	Expects(!data.size.isEmpty());
 
 	//if (FFmpeg::RotationSwapWidthHeight(stream.rotation)) {
 	//	resize.transpose();
 	//}
 
-	auto result = FFmpeg::CreateFrameStorage(data.size);
-	const auto swscale = FFmpeg::MakeSwscalePointer(
+	auto result = FFmpeg::GoodStorageForFrame(storage, data.size)
+		? std::move(storage)
+		: FFmpeg::CreateFrameStorage(data.size);
+	swscale = FFmpeg::MakeSwscalePointer(
 		data.size,
-		AV_PIX_FMT_YUV420P,
+		(format == FrameFormat::NV12
+			? AV_PIX_FMT_NV12
+			: AV_PIX_FMT_YUV420P),
 		data.size,
-		AV_PIX_FMT_BGRA);
+		AV_PIX_FMT_BGRA,
+		&swscale);
 	if (!swscale) {
 		return QImage();
 	}
@@ -424,27 +437,33 @@ void VideoTrackObject::rasterizeFrame(not_null<Frame*> frame) {
 
 	fillRequests(frame);
 	frame->format = FrameFormat::None;
-	if (frame->decoded->format == AV_PIX_FMT_YUV420P && !requireARGB32()) {
+	const auto nv12 = (frame->decoded->format == AV_PIX_FMT_NV12);
+	if ((frame->decoded->format == AV_PIX_FMT_YUV420P || nv12)
+		&& !requireARGB32()) {
 		frame->alpha = false;
 		frame->yuv420 = ExtractYUV420(_stream, frame->decoded.get());
 		if (frame->yuv420.size.isEmpty()
 			|| frame->yuv420.chromaSize.isEmpty()
 			|| !frame->yuv420.y.data
 			|| !frame->yuv420.u.data
-			|| !frame->yuv420.v.data) {
+			|| (!nv12 && !frame->yuv420.v.data)) {
 			frame->prepared.clear();
 			fail(Error::InvalidData);
 			return;
 		}
 		if (!frame->original.isNull()) {
-			frame->original = QImage();
+			// Keep the pixels for the ARGB32 conversion on demand.
+			frame->storage = base::take(frame->original);
 			for (auto &[_, prepared] : frame->prepared) {
 				prepared.image = QImage();
 			}
 		}
-		frame->format = FrameFormat::YUV420;
+		frame->format = nv12 ? FrameFormat::NV12 : FrameFormat::YUV420;
 	} else {
 		frame->alpha = (frame->decoded->format == AV_PIX_FMT_BGRA);
+		if (frame->original.isNull()) {
+			frame->original = base::take(frame->storage);
+		}
 		frame->yuv420.size = {
 			frame->decoded->width,
 			frame->decoded->height
@@ -1106,9 +1125,12 @@ QImage VideoTrack::frame(
 			unwrapped.updateFrameRequest(instance, useRequest);
 		});
 	}
-	if (frame->original.isNull()
-		&& frame->format == FrameFormat::YUV420) {
-		frame->original = ConvertToARGB32(frame->yuv420);
+	if (frame->original.isNull() && IsPlanarYUV(frame->format)) {
+		frame->original = ConvertToARGB32(
+			frame->format,
+			frame->yuv420,
+			base::take(frame->storage),
+			_argbSwscale);
 	}
 	if (!frame->alpha
 		&& GoodForRequest(frame->original, _streamRotation, useRequest)) {
@@ -1161,8 +1183,12 @@ FrameWithInfo VideoTrack::frameWithInfo(const Instance *instance) {
 
 QImage VideoTrack::currentFrameImage() {
 	const auto frame = _shared->frameForPaint();
-	if (frame->original.isNull() && frame->format == FrameFormat::YUV420) {
-		frame->original = ConvertToARGB32(frame->yuv420);
+	if (frame->original.isNull() && IsPlanarYUV(frame->format)) {
+		frame->original = ConvertToARGB32(
+			frame->format,
+			frame->yuv420,
+			base::take(frame->storage),
+			_argbSwscale);
 	}
 	return frame->original;
 }
@@ -1216,7 +1242,7 @@ bool VideoTrack::IsDecoded(not_null<const Frame*> frame) {
 bool VideoTrack::IsRasterized(not_null<const Frame*> frame) {
 	return IsDecoded(frame)
 		&& (!frame->original.isNull()
-			|| frame->format == FrameFormat::YUV420);
+			|| IsPlanarYUV(frame->format));
 }
 
 bool VideoTrack::IsStale(not_null<const Frame*> frame, crl::time trackTime) {
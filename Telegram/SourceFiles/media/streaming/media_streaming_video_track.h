@@ -80,6 +80,7 @@ private:
 	struct Frame {
 		FFmpeg::FramePointer decoded = FFmpeg::MakeFramePointer();
 		QImage original;
+		QImage storage;
 		FrameYUV420 yuv420;
 		crl::time position = kTimeUnknown;
 		crl::time displayed = kTimeUnknown;
@@ -166,6 +167,7 @@ private:
 	const int _streamRotation = 0;
 	//AVRational _streamAspect = kNormalAspect;
 	std::unique_ptr<Shared> _shared;
+	FFmpeg::SwscalePointer _argbSwscale; // For YUV frames painted as ARGB32.
 
 	using Implementation = VideoTrackObject;
 	crl::object_on_queue<Implementation> _wrapped;
@@ -13,6 +13,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/crash_reports.h"
 #include "styles/style_media_view.h"
 
+#include <QtGui/QOpenGLContext>
+
 namespace Media::View {
 namespace {
 
@@ -28,6 +30,10 @@ constexpr auto kGroupThumbsOffset = kCaptionOffset + 4;
 constexpr auto kControlsOffset = kGroupThumbsOffset + 4;
 constexpr auto kControlValues = 2 * 4 + 4 * 4;
 
+// Larger photos are split into tiles, it keeps every texture below
+// GL_MAX_TEXTURE_SIZE and makes each upload small enough.
+constexpr auto kStaticTileSize = 2048;
+
 [[nodiscard]] ShaderPart FragmentPlaceOnTransparentBackground() {
 	return {
 		.header = R"(
@@ -47,6 +53,27 @@ uniform float transparentSize;
 
 } // namespace
 
+ShaderPart FragmentSampleNV12Texture() {
+	return {
+		.header = R"(
+varying vec2 v_texcoord;
+uniform sampler2D y_texture;
+uniform sampler2D uv_texture;
+)",
+		.body = R"(
+	float y = texture2D(y_texture, v_texcoord).a - 0.0625;
+	vec2 uv = texture2D(uv_texture, v_texcoord).ra - vec2(0.5, 0.5);
+	float u = uv.x;
+	float v = uv.y;
+	result = vec4(
+		1.164 * y + 1.596 * v,
+		1.164 * y - 0.392 * u - 0.813 * v,
+		1.164 * y + 2.17 * u,
+		1.);
+)",
+	};
+}
+
 OverlayWidget::RendererGL::RendererGL(not_null<OverlayWidget*> owner)
 : _owner(owner) {
 	style::PaletteChanged(
@@ -106,6 +133,14 @@ void OverlayWidget::RendererGL::init(
 			FragmentSampleYUV420Texture(),
 		}));
 
+	_nv12Program.emplace();
+	LinkProgram(
+		&*_nv12Program,
+		_texturedVertexShader,
+		FragmentShader({
+			FragmentSampleNV12Texture(),
+		}));
+
 	_fillProgram.emplace();
 	LinkProgram(
 		&*_fillProgram,
@@ -132,10 +167,12 @@ void OverlayWidget::RendererGL::deinit(
 		not_null<QOpenGLWidget*> widget,
 		QOpenGLFunctions *f) {
 	_textures.destroy(f);
+	destroyStaticTiles(f);
 	_imageProgram = std::nullopt;
 	_texturedVertexShader = nullptr;
 	_withTransparencyProgram = std::nullopt;
 	_yuv420Program = std::nullopt;
+	_nv12Program = std::nullopt;
 	_fillProgram = std::nullopt;
 	_controlsProgram = std::nullopt;
 	_contentBuffer = std::nullopt;
@@ -193,10 +230,12 @@ void OverlayWidget::RendererGL::paintTransformedVideoFrame(
 		paintTransformedStaticContent(data.original, geometry, false, false);
 		return;
 	}
-	Assert(data.format == Streaming::FrameFormat::YUV420);
+	const auto nv12 = (data.format == Streaming::FrameFormat::NV12);
+	Assert(nv12 || data.format == Streaming::FrameFormat::YUV420);
 	Assert(!data.yuv420->size.isEmpty());
 	const auto yuv = data.yuv420;
-	_yuv420Program->bind();
+	auto &program = nv12 ? _nv12Program : _yuv420Program;
+	program->bind();
 
 	const auto upload = (_trackFrameIndex != data.index)
 		|| (_streamedIndex != _owner->streamedIndex());
@@ -215,37 +254,57 @@ void OverlayWidget::RendererGL::paintTransformedVideoFrame(
 			yuv->y.stride,
 			yuv->y.data);
 		_lumaSize = yuv->size;
+		if (_chromaNV12 != nv12) {
+			// Chroma textures change their format, allocate them again.
+			_chromaNV12 = nv12;
+			_chromaSize = QSize();
+		}
 	}
 	_f->glActiveTexture(GL_TEXTURE1);
 	_textures.bind(*_f, 2);
-	if (upload) {
+	if (upload && nv12) {
 		uploadTexture(
-			GL_ALPHA,
-			GL_ALPHA,
+			GL_LUMINANCE_ALPHA,
+			GL_LUMINANCE_ALPHA,
 			yuv->chromaSize,
 			_chromaSize,
-			yuv->u.stride,
+			yuv->u.stride / 2,
 			yuv->u.data);
-	}
-	_f->glActiveTexture(GL_TEXTURE2);
-	_textures.bind(*_f, 3);
-	if (upload) {
+		_chromaSize = yuv->chromaSize;
+		_f->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	} else if (upload) {
 		uploadTexture(
 			GL_ALPHA,
 			GL_ALPHA,
 			yuv->chromaSize,
 			_chromaSize,
-			yuv->v.stride,
-			yuv->v.data);
-		_chromaSize = yuv->chromaSize;
-		_f->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+			yuv->u.stride,
+			yuv->u.data);
+	}
+	if (nv12) {
+		program->setUniformValue("y_texture", GLint(0));
+		program->setUniformValue("uv_texture", GLint(1));
+	} else {
+		_f->glActiveTexture(GL_TEXTURE2);
+		_textures.bind(*_f, 3);
+		if (upload) {
+			uploadTexture(
+				GL_ALPHA,
+				GL_ALPHA,
+				yuv->chromaSize,
+				_chromaSize,
+				yuv->v.stride,
+				yuv->v.data);
+			_chromaSize = yuv->chromaSize;
+			_f->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		}
+		program->setUniformValue("y_texture", GLint(0));
+		program->setUniformValue("u_texture", GLint(1));
+		program->setUniformValue("v_texture", GLint(2));
 	}
-	_yuv420Program->setUniformValue("y_texture", GLint(0));
-	_yuv420Program->setUniformValue("u_texture", GLint(1));
-	_yuv420Program->setUniformValue("v_texture", GLint(2));
 
 	toggleBlending(false);
-	paintTransformedContent(&*_yuv420Program, geometry);
+	paintTransformedContent(&*program, geometry);
 }
 
 void OverlayWidget::RendererGL::paintTransformedStaticContent(
@@ -278,6 +337,33 @@ void OverlayWidget::RendererGL::paintTransformedStaticContent(
 	}
 
 	_f->glActiveTexture(GL_TEXTURE0);
+	if (image.width() > kStaticTileSize || image.height() > kStaticTileSize) {
+		validateStaticTiles(image);
+		program->setUniformValue("s_texture", GLint(0));
+		toggleBlending(semiTransparent && !fillTransparentBackground);
+		const auto width = float64(image.width());
+		const auto height = float64(image.height());
+		for (const auto &tile : _staticTiles) {
+			const auto &source = tile.source;
+			const auto &uploaded = tile.uploaded;
+			const auto textureWidth = float64(uploaded.width());
+			const auto textureHeight = float64(uploaded.height());
+			_f->glBindTexture(GL_TEXTURE_2D, tile.texture);
+			paintTransformedContent(&*program, geometry, QRectF(
+				source.x() / width,
+				source.y() / height,
+				source.width() / width,
+				source.height() / height
+			), QRectF(
+				(source.x() - uploaded.x()) / textureWidth,
+				(source.y() - uploaded.y()) / textureHeight,
+				source.width() / textureWidth,
+				source.height() / textureHeight));
+		}
+		return;
+	} else if (!_staticTiles.empty()) {
+		destroyStaticTiles(_f);
+	}
 	_textures.bind(*_f, 0);
 	const auto cacheKey = image.isNull() ? qint64(-1) : image.cacheKey();
 	const auto upload = (_cacheKey != cacheKey);
@@ -313,9 +399,85 @@ void OverlayWidget::RendererGL::paintTransformedStaticContent(
 	paintTransformedContent(&*program, geometry);
 }
 
+void OverlayWidget::RendererGL::validateStaticTiles(const QImage &image) {
+	const auto cacheKey = image.cacheKey();
+	if (_staticTilesCacheKey == cacheKey && !_staticTiles.empty()) {
+		return;
+	}
+	destroyStaticTiles(_f);
+	_staticTilesCacheKey = cacheKey;
+
+	// Non power of two textures can't have mip levels in OpenGL ES 2.0.
+	const auto context = QOpenGLContext::currentContext();
+	const auto mipmaps = context
+		&& (!context->isOpenGLES() || context->format().majorVersion() > 2);
+
+	// Each texture has one more pixel of the neighbour tiles on each side,
+	// so that the linear filtering doesn't show seams between the tiles.
+	constexpr auto kStep = kStaticTileSize - 2;
+	const auto stride = image.bytesPerLine() / 4;
+	const auto bits = reinterpret_cast<const uint32*>(image.constBits());
+	for (auto y = 0; y < image.height(); y += kStep) {
+		for (auto x = 0; x < image.width(); x += kStep) {
+			auto tile = StaticTile{ .source = QRect(
+				x,
+				y,
+				std::min(kStep, image.width() - x),
+				std::min(kStep, image.height() - y)) };
+			tile.uploaded = tile.source.marginsAdded(
+				{ 1, 1, 1, 1 }
+			).intersected(image.rect());
+			_f->glGenTextures(1, &tile.texture);
+			_f->glBindTexture(GL_TEXTURE_2D, tile.texture);
+			_f->glTexParameteri(
+				GL_TEXTURE_2D,
+				GL_TEXTURE_WRAP_S,
+				GL_CLAMP_TO_EDGE);
+			_f->glTexParameteri(
+				GL_TEXTURE_2D,
+				GL_TEXTURE_WRAP_T,
+				GL_CLAMP_TO_EDGE);
+			_f->glTexParameteri(
+				GL_TEXTURE_2D,
+				GL_TEXTURE_MIN_FILTER,
+				mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+			_f->glTexParameteri(
+				GL_TEXTURE_2D,
+				GL_TEXTURE_MAG_FILTER,
+				GL_LINEAR);
+			uploadTexture(
+				Ui::GL::kFormatRGBA,
+				Ui::GL::kFormatRGBA,
+				tile.uploaded.size(),
+				QSize(),
+				stride,
+				bits + tile.uploaded.y() * stride + tile.uploaded.x());
+
+			// Zoomed out photos sample the mip levels instead of
+			// skipping most of the source pixels.
+			if (mipmaps) {
+				_f->glGenerateMipmap(GL_TEXTURE_2D);
+			}
+			_staticTiles.push_back(tile);
+		}
+	}
+}
+
+void OverlayWidget::RendererGL::destroyStaticTiles(QOpenGLFunctions *f) {
+	if (f) {
+		for (const auto &tile : _staticTiles) {
+			f->glDeleteTextures(1, &tile.texture);
+		}
+	}
+	_staticTiles.clear();
+	_staticTilesCacheKey = 0;
+}
+
 void OverlayWidget::RendererGL::paintTransformedContent(
 		not_null<QOpenGLShaderProgram*> program,
-		ContentGeometry geometry) {
+		ContentGeometry geometry,
+		QRectF part,
+		QRectF texture) {
 	const auto rect = transformRect(geometry.rect);
 	const auto centerx = rect.x() + rect.width() / 2;
 	const auto centery = rect.y() + rect.height() / 2;
@@ -329,22 +491,32 @@ void OverlayWidget::RendererGL::paintTransformedContent(
 			centery + (y * rcos - x * rsin)
 		};
 	};
-	const auto topleft = rotated(rect.left(), rect.top());
-	const auto topright = rotated(rect.right(), rect.top());
-	const auto bottomright = rotated(rect.right(), rect.bottom());
-	const auto bottomleft = rotated(rect.left(), rect.bottom());
+
+	// The part is in image coordinates, while the y axis goes up in GL.
+	const auto left = float(rect.left() + part.left() * rect.width());
+	const auto right = float(rect.left() + part.right() * rect.width());
+	const auto top = float(rect.top() + (1. - part.bottom()) * rect.height());
+	const auto bottom = float(rect.top() + (1. - part.top()) * rect.height());
+	const auto topleft = rotated(left, top);
+	const auto topright = rotated(right, top);
+	const auto bottomright = rotated(right, bottom);
+	const auto bottomleft = rotated(left, bottom);
+	const auto textureLeft = float(texture.left());
+	const auto textureRight = float(texture.right());
+	const auto textureTop = float(texture.top());
+	const auto textureBottom = float(texture.bottom());
 	const GLfloat coords[] = {
 		topleft[0], topleft[1],
-		0.f, 1.f,
+		textureLeft, textureBottom,
 
 		topright[0], topright[1],
-		1.f, 1.f,
+		textureRight, textureBottom,
 
 		bottomright[0], bottomright[1],
-		1.f, 0.f,
+		textureRight, textureTop,
 
 		bottomleft[0], bottomleft[1],
-		0.f, 0.f,
+		textureLeft, textureTop,
 	};
 
 	_contentBuffer->write(0, coords, sizeof(coords));
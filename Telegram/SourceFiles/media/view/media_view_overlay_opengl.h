@@ -15,6 +15,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace Media::View {
 
+// Samples the luma from GL_ALPHA "y_texture" and the interleaved
+// chroma from GL_LUMINANCE_ALPHA "uv_texture".
+[[nodiscard]] Ui::GL::ShaderPart FragmentSampleNV12Texture();
+
 class OverlayWidget::RendererGL final : public OverlayWidget::Renderer {
 public:
 	explicit RendererGL(not_null<OverlayWidget*> owner);
@@ -38,6 +42,11 @@ private:
 		int index = -1;
 		not_null<const style::icon*> icon;
 	};
+	struct StaticTile {
+		QRect source;
+		QRect uploaded;
+		GLuint texture = 0;
+	};
 	bool handleHideWorkaround(QOpenGLFunctions &f);
 
 	void paintBackground() override;
@@ -49,7 +58,11 @@ private:
 		bool fillTransparentBackground) override;
 	void paintTransformedContent(
 		not_null<QOpenGLShaderProgram*> program,
-		ContentGeometry geometry);
+		ContentGeometry geometry,
+		QRectF part = QRectF(0., 0., 1., 1.),
+		QRectF texture = QRectF(0., 0., 1., 1.));
+	void validateStaticTiles(const QImage &image);
+	void destroyStaticTiles(QOpenGLFunctions *f);
 	void paintRadialLoading(
 		QRect inner,
 		bool radial,
@@ -107,13 +120,17 @@ private:
 	QOpenGLShader *_texturedVertexShader = nullptr;
 	std::optional<QOpenGLShaderProgram> _withTransparencyProgram;
 	std::optional<QOpenGLShaderProgram> _yuv420Program;
+	std::optional<QOpenGLShaderProgram> _nv12Program;
 	std::optional<QOpenGLShaderProgram> _fillProgram;
 	std::optional<QOpenGLShaderProgram> _controlsProgram;
 	Ui::GL::Textures<4> _textures;
 	QSize _rgbaSize;
 	QSize _lumaSize;
 	QSize _chromaSize;
+	bool _chromaNV12 = false;
 	qint64 _cacheKey = 0;
+	std::vector<StaticTile> _staticTiles;
+	qint64 _staticTilesCacheKey = 0;
 	int _trackFrameIndex = 0;
 	int _streamedIndex = 0;
 
@@ -17,6 +17,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/click_handler_types.h"
 #include "core/file_utilities.h"
 #include "core/mime_type.h"
+#include "core/paint_profiler.h"
 #include "core/ui_integration.h"
 #include "core/crash_reports.h"
 #include "ui/widgets/popup_menu.h"
@@ -39,14 +40,17 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/view/media_view_pip.h"
 #include "media/view/media_view_overlay_raster.h"
 #include "media/view/media_view_overlay_opengl.h"
+#include "media/view/media_view_storyboard.h"
 #include "media/streaming/media_streaming_instance.h"
 #include "media/streaming/media_streaming_player.h"
+#include "media/streaming/media_streaming_reader.h"
 #include "media/player/media_player_instance.h"
 #include "history/history.h"
 #include "history/history_message.h"
 #include "history/view/media/history_view_media.h"
 #include "data/data_media_types.h"
 #include "data/data_session.h"
+#include "data/data_streaming.h"
 #include "data/data_channel.h"
 #include "data/data_chat.h"
 #include "data/data_user.h"
@@ -95,6 +99,12 @@ namespace View {
 namespace {
 
 constexpr auto kPreloadCount = 3;
+
+// The beginning of the neighbour videos is loaded before the user flips
+// to them, so the player finds the header and the first frames ready.
+constexpr auto kPreloadVideoBytes = 512 * 1024;
+constexpr auto kPreloadVideoLoaderPriority = 0;
+
 constexpr auto kMaxZoomLevel = 7; // x8
 constexpr auto kZoomToScreenLevel = 1024;
 constexpr auto kOverlayLoaderPriority = 2;
@@ -228,6 +238,7 @@ struct OverlayWidget::Streamed {
 
 	Streaming::Instance instance;
 	PlaybackControls controls;
+	std::unique_ptr<Storyboard> storyboard;
 
 	bool withSound = false;
 	bool pausedBySeek = false;
@@ -1345,6 +1356,7 @@ void OverlayWidget::clearSession() {
 		_animationOpacities.clear();
 	}
 	clearStreaming();
+	clearPreloadedVideos();
 	setContext(v::null);
 	_from = nullptr;
 	_fromName = QString();
@@ -2782,6 +2794,18 @@ bool OverlayWidget::createStreamingObjects() {
 			|| _document->isVoiceMessage()
 			|| _document->isVideoMessage());
 
+	if (_document && _document->isVideoFile() && _documentMedia) {
+		// Keyframe previews are made only from the data we already have.
+		const auto path = _document->filepath(true);
+		const auto bytes = _documentMedia->bytes();
+		if (!path.isEmpty() || !bytes.isEmpty()) {
+			_streamed->storyboard = std::make_unique<Storyboard>(
+				_document,
+				path,
+				bytes);
+		}
+	}
+
 	// if (videoIsGifOrUserpic()) {
 	// 	_streamed->controls.hide();
 	// } else {
@@ -3001,6 +3025,12 @@ void OverlayWidget::playbackControlsToPictureInPicture() {
 	//}
 }
 
+QImage OverlayWidget::playbackControlsPreview(crl::time position) {
+	return (_streamed && _streamed->storyboard)
+		? _streamed->storyboard->frame(position)
+		: QImage();
+}
+
 void OverlayWidget::playbackControlsRotate() {
 	_oldGeometry = contentGeometry();
 	_geometryAnimation.stop();
@@ -3081,6 +3111,7 @@ void OverlayWidget::restartAtSeekPosition(crl::time position) {
 	}
 	auto options = Streaming::PlaybackOptions();
 	options.position = position;
+	options.hwAllowed = cHardwareVideoDecoding();
 	if (!_streamed->withSound) {
 		options.mode = Streaming::Mode::Video;
 		options.loop = true;
@@ -3107,6 +3138,7 @@ void OverlayWidget::restartAtSeekPosition(crl::time position) {
 void OverlayWidget::playbackControlsSeekProgress(crl::time position) {
 	Expects(_streamed != nullptr);
 
+	_streamed->instance.prefetch(position);
 	if (!_streamed->instance.player().paused()
 		&& !_streamed->instance.player().finished()) {
 		_streamed->pausedBySeek = true;
@@ -3328,6 +3360,7 @@ Ui::GL::ChosenRenderer OverlayWidget::chooseRenderer(
 }
 
 void OverlayWidget::paint(not_null<Renderer*> renderer) {
+	const auto profile = Core::PaintProfiler::Scope("MediaView");
 	renderer->paintBackground();
 	if (contentShown()) {
 		if (videoShown()) {
@@ -4133,6 +4166,10 @@ void OverlayWidget::preloadData(int delta) {
 
 	auto photos = base::flat_set<std::shared_ptr<Data::PhotoMedia>>();
 	auto documents = base::flat_set<std::shared_ptr<Data::DocumentMedia>>();
+	auto videos = std::vector<VideoToPreload>();
+	const auto videoIndices = delta
+		? std::vector<int>{ *_index + delta }
+		: std::vector<int>{ *_index + 1, *_index - 1 };
 	for (auto index = from; index != till + 1; ++index) {
 		auto entity = entityByIndex(index);
 		if (auto photo = std::get_if<not_null<PhotoData*>>(&entity.data)) {
@@ -4146,11 +4183,73 @@ void OverlayWidget::preloadData(int delta) {
 			(*i)->thumbnailWanted(fileOrigin(entity));
 			if (!(*i)->canBePlayed(entity.item)) {
 				(*i)->automaticLoad(fileOrigin(entity), entity.item);
+			} else if ((*document)->supportsStreaming()
+				&& ranges::contains(videoIndices, index)) {
+				videos.emplace_back(*document, fileOrigin(entity));
 			}
 		}
 	}
 	_preloadPhotos = std::move(photos);
 	_preloadDocuments = std::move(documents);
+	preloadVideos(std::move(videos));
+}
+
+void OverlayWidget::preloadVideos(std::vector<VideoToPreload> list) {
+	const auto wanted = [&](not_null<DocumentData*> document) {
+		return ranges::contains(list, document, &VideoToPreload::first);
+	};
+	for (auto i = begin(_preloadVideos); i != end(_preloadVideos);) {
+		if (wanted(i->first)) {
+			++i;
+			continue;
+		}
+		// Does nothing if the player already streams from this reader.
+		i->second.reader->stopPreload();
+		i = _preloadVideos.erase(i);
+	}
+	for (const auto &[document, origin] : list) {
+		if (_preloadVideos.contains(document)) {
+			continue;
+		}
+		auto reader = document->owner().streaming().sharedReader(
+			document,
+			origin);
+		if (!reader) {
+			continue;
+		}
+		auto &video = _preloadVideos.emplace(
+			document,
+			PreloadedVideo{ std::move(reader) }
+		).first->second;
+		if (!video.reader->isRemoteLoader()) {
+			continue;
+		}
+		video.reader->preloadUpdates(
+		) | rpl::start_with_next([=] {
+			continuePreloadVideo(document);
+		}, video.lifetime);
+		continuePreloadVideo(document);
+	}
+}
+
+void OverlayWidget::continuePreloadVideo(not_null<DocumentData*> document) {
+	const auto i = _preloadVideos.find(document);
+	if (i == end(_preloadVideos)) {
+		return;
+	}
+	auto &video = i->second;
+	if (video.reader->preload(
+			kPreloadVideoBytes,
+			kPreloadVideoLoaderPriority)) {
+		// The requests are sent, the loader does the rest by itself.
+		video.lifetime.destroy();
+	}
+}
+
+void OverlayWidget::clearPreloadedVideos() {
+	for (const auto &[document, video] : base::take(_preloadVideos)) {
+		video.reader->stopPreload();
+	}
 }
 
 void OverlayWidget::handleMousePress(
@@ -4678,6 +4777,7 @@ void OverlayWidget::clearBeforeHide() {
 	assignMediaPointer(nullptr);
 	_preloadPhotos.clear();
 	_preloadDocuments.clear();
+	clearPreloadedVideos();
 	if (_menu) {
 		_menu->hideMenu(true);
 	}
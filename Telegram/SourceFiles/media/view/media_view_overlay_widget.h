@@ -46,6 +46,7 @@ namespace Player {
 struct TrackState;
 } // namespace Player
 namespace Streaming {
+class Reader;
 struct Information;
 struct Update;
 struct FrameWithInfo;
@@ -105,6 +106,10 @@ public:
 private:
 	struct Streamed;
 	struct PipWrap;
+	struct PreloadedVideo {
+		std::shared_ptr<Streaming::Reader> reader;
+		rpl::lifetime lifetime; // Until all the requests are sent.
+	};
 	class Renderer;
 	class RendererSW;
 	class RendererGL;
@@ -180,6 +185,7 @@ private:
 	void playbackControlsFromFullScreen() override;
 	void playbackControlsToPictureInPicture() override;
 	void playbackControlsRotate() override;
+	QImage playbackControlsPreview(crl::time position) override;
 	void playbackPauseResume();
 	void playbackToggleFullScreen();
 	void playbackPauseOnCall();
@@ -217,6 +223,12 @@ private:
 	void updateGeometry();
 	bool moveToNext(int delta);
 	void preloadData(int delta);
+	using VideoToPreload = std::pair<
+		not_null<DocumentData*>,
+		Data::FileOrigin>;
+	void preloadVideos(std::vector<VideoToPreload> list);
+	void continuePreloadVideo(not_null<DocumentData*> document);
+	void clearPreloadedVideos();
 
 	void handleScreenChanged(QScreen *screen);
 
@@ -431,6 +443,7 @@ private:
 	std::shared_ptr<Data::DocumentMedia> _documentMedia;
 	base::flat_set<std::shared_ptr<Data::PhotoMedia>> _preloadPhotos;
 	base::flat_set<std::shared_ptr<Data::DocumentMedia>> _preloadDocuments;
+	base::flat_map<not_null<DocumentData*>, PreloadedVideo> _preloadVideos;
 	int _rotation = 0;
 	std::unique_ptr<SharedMedia> _sharedMedia;
 	std::optional<SharedMediaWithLastSlice> _sharedMediaData;
@@ -1587,6 +1587,7 @@ void Pip::restartAtSeekPosition(crl::time position) {
 	auto options = Streaming::PlaybackOptions();
 	options.position = position;
 	options.audioId = _instance.player().prepareLegacyState().id;
+	options.hwAllowed = cHardwareVideoDecoding();
 
 	Assert(8 && _delegate->pipPlaybackSpeed() >= 0.5
 		&& _delegate->pipPlaybackSpeed() <= 2.); // Debugging strange crash.
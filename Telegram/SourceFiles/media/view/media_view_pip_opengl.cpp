@@ -7,6 +7,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "media/view/media_view_pip_opengl.h"
 
+#include "media/view/media_view_overlay_opengl.h" // FragmentSampleNV12Texture
+
 #include "ui/gl/gl_shader.h"
 #include "ui/gl/gl_primitives.h"
 #include "ui/widgets/shadow.h"
@@ -195,6 +197,16 @@ void Pip::RendererGL::init(
 			FragmentRoundToShadow(),
 		}));
 
+	_nv12Program.emplace();
+	LinkProgram(
+		&*_nv12Program,
+		_texturedVertexShader,
+		FragmentShader({
+			FragmentSampleNV12Texture(),
+			FragmentApplyFade(),
+			FragmentRoundToShadow(),
+		}));
+
 	_imageProgram.emplace();
 	LinkProgram(
 		&*_imageProgram,
@@ -231,6 +243,7 @@ void Pip::RendererGL::deinit(
 	_texturedVertexShader = nullptr;
 	_argb32Program = std::nullopt;
 	_yuv420Program = std::nullopt;
+	_nv12Program = std::nullopt;
 	_controlsProgram = std::nullopt;
 	_contentBuffer = std::nullopt;
 }
@@ -289,10 +302,12 @@ void Pip::RendererGL::paintTransformedVideoFrame(
 		paintTransformedStaticContent(data.original, geometry);
 		return;
 	}
-	Assert(data.format == Streaming::FrameFormat::YUV420);
+	const auto nv12 = (data.format == Streaming::FrameFormat::NV12);
+	Assert(nv12 || data.format == Streaming::FrameFormat::YUV420);
 	Assert(!data.yuv420->size.isEmpty());
 	const auto yuv = data.yuv420;
-	_yuv420Program->bind();
+	auto &program = nv12 ? _nv12Program : _yuv420Program;
+	program->bind();
 
 	const auto upload = (_trackFrameIndex != data.index);
 	_trackFrameIndex = data.index;
@@ -309,36 +324,56 @@ void Pip::RendererGL::paintTransformedVideoFrame(
 			yuv->y.stride,
 			yuv->y.data);
 		_lumaSize = yuv->size;
+		if (_chromaNV12 != nv12) {
+			// Chroma textures change their format, allocate them again.
+			_chromaNV12 = nv12;
+			_chromaSize = QSize();
+		}
 	}
 	_f->glActiveTexture(GL_TEXTURE1);
 	_textures.bind(*_f, 2);
-	if (upload) {
+	if (upload && nv12) {
 		uploadTexture(
-			GL_ALPHA,
-			GL_ALPHA,
+			GL_LUMINANCE_ALPHA,
+			GL_LUMINANCE_ALPHA,
 			yuv->chromaSize,
 			_chromaSize,
-			yuv->u.stride,
+			yuv->u.stride / 2,
 			yuv->u.data);
-	}
-	_f->glActiveTexture(GL_TEXTURE2);
-	_textures.bind(*_f, 3);
-	if (upload) {
+		_chromaSize = yuv->chromaSize;
+		_f->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	} else if (upload) {
 		uploadTexture(
 			GL_ALPHA,
 			GL_ALPHA,
 			yuv->chromaSize,
 			_chromaSize,
-			yuv->v.stride,
-			yuv->v.data);
-		_chromaSize = yuv->chromaSize;
-		_f->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+			yuv->u.stride,
+			yuv->u.data);
+	}
+	if (nv12) {
+		program->setUniformValue("y_texture", GLint(0));
+		program->setUniformValue("uv_texture", GLint(1));
+	} else {
+		_f->glActiveTexture(GL_TEXTURE2);
+		_textures.bind(*_f, 3);
+		if (upload) {
+			uploadTexture(
+				GL_ALPHA,
+				GL_ALPHA,
+				yuv->chromaSize,
+				_chromaSize,
+				yuv->v.stride,
+				yuv->v.data);
+			_chromaSize = yuv->chromaSize;
+			_f->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		}
+		program->setUniformValue("y_texture", GLint(0));
+		program->setUniformValue("u_texture", GLint(1));
+		program->setUniformValue("v_texture", GLint(2));
 	}
-	_yuv420Program->setUniformValue("y_texture", GLint(0));
-	_yuv420Program->setUniformValue("u_texture", GLint(1));
-	_yuv420Program->setUniformValue("v_texture", GLint(2));
 
-	paintTransformedContent(&*_yuv420Program, geometry);
+	paintTransformedContent(&*program, geometry);
 }
 
 void Pip::RendererGL::paintTransformedStaticContent(
@@ -101,10 +101,12 @@ private:
 	QOpenGLShader *_texturedVertexShader = nullptr;
 	std::optional<QOpenGLShaderProgram> _argb32Program;
 	std::optional<QOpenGLShaderProgram> _yuv420Program;
+	std::optional<QOpenGLShaderProgram> _nv12Program;
 	Ui::GL::Textures<4> _textures;
 	QSize _rgbaSize;
 	QSize _lumaSize;
 	QSize _chromaSize;
+	bool _chromaNV12 = false;
 	quint64 _cacheKey = 0;
 	int _trackFrameIndex = 0;
 
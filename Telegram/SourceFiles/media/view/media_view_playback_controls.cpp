@@ -17,6 +17,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/widgets/popup_menu.h"
 #include "ui/text/format_values.h"
 #include "ui/cached_round_corners.h"
+#include "base/event_filter.h"
 #include "lang/lang_keys.h"
 #include "styles/style_media_view.h"
 
@@ -278,6 +279,76 @@ PlaybackControls::PlaybackControls(
 		_playbackProgress->setValue(value, false);
 		handleSeekFinished(value);
 	});
+	_playbackSlider->setMouseTracking(true);
+	base::install_event_filter(_playbackSlider.data(), [=](
+			not_null<QEvent*> e) {
+		const auto type = e->type();
+		if (type == QEvent::MouseMove) {
+			const auto position = static_cast<QMouseEvent*>(e.get())->pos();
+			updatePreview(position.x());
+		} else if (type == QEvent::Leave || type == QEvent::Hide) {
+			hidePreview();
+		}
+		return base::EventFilterResult::Continue;
+	});
+}
+
+void PlaybackControls::updatePreview(int sliderLeft) {
+	const auto width = _playbackSlider->width();
+	if (!_lastDurationMs || width <= 0) {
+		hidePreview();
+		return;
+	}
+	const auto progress = std::clamp(
+		float64(sliderLeft) / width,
+		0.,
+		1.);
+	_previewFrame = _delegate->playbackControlsPreview(
+		static_cast<crl::time>(progress * _lastDurationMs));
+	if (_previewFrame.isNull()) {
+		hidePreview();
+		return;
+	}
+	if (!_preview) {
+		_preview = base::make_unique_q<Ui::RpWidget>(parentWidget());
+		_preview->setAttribute(Qt::WA_TransparentForMouseEvents);
+		_preview->paintRequest(
+		) | rpl::start_with_next([=] {
+			auto p = QPainter(_preview.get());
+			auto hq = PainterHighQualityEnabler(p);
+			auto path = QPainterPath();
+			path.addRoundedRect(
+				_preview->rect(),
+				st::mediaviewStoryboardRadius,
+				st::mediaviewStoryboardRadius);
+			p.setClipPath(path);
+			p.drawImage(_preview->rect(), _previewFrame);
+		}, _preview->lifetime());
+	}
+	// Tiles of long videos are smaller, show them at the full width.
+	const auto size = _previewFrame.size().scaled(
+		st::mediaviewStoryboardWidth,
+		st::mediaviewStoryboardWidth,
+		Qt::KeepAspectRatio);
+	const auto center = _playbackSlider->mapTo(
+		parentWidget(),
+		QPoint(std::clamp(sliderLeft, 0, width), 0));
+	const auto left = std::clamp(
+		center.x() - size.width() / 2,
+		0,
+		std::max(parentWidget()->width() - size.width(), 0));
+	const auto top = y() - st::mediaviewStoryboardSkip - size.height();
+	_preview->setGeometry(QRect(QPoint(left, top), size));
+	_preview->show();
+	_preview->raise();
+	_preview->update();
+}
+
+void PlaybackControls::hidePreview() {
+	if (_preview) {
+		_preview->hide();
+	}
+	_previewFrame = QImage();
 }
 
 void PlaybackControls::handleSeekProgress(float64 progress) {
@@ -340,6 +411,7 @@ void PlaybackControls::showAnimated() {
 }
 
 void PlaybackControls::hideAnimated() {
+	hidePreview();
 	startFading([this]() {
 		_fadeAnimation->fadeOut(st::mediaviewHideDuration);
 	});
@@ -47,6 +47,8 @@ public:
 		virtual void playbackControlsFromFullScreen() = 0;
 		virtual void playbackControlsToPictureInPicture() = 0;
 		virtual void playbackControlsRotate() = 0;
+		[[nodiscard]] virtual QImage playbackControlsPreview(
+			crl::time position) = 0;
 	};
 
 	PlaybackControls(QWidget *parent, not_null<Delegate*> delegate);
@@ -69,6 +71,8 @@ protected:
 private:
 	void handleSeekProgress(float64 progress);
 	void handleSeekFinished(float64 progress);
+	void updatePreview(int sliderLeft);
+	void hidePreview();
 
 	template <typename Callback>
 	void startFading(Callback start);
@@ -111,6 +115,8 @@ private:
 	object_ptr<Ui::LabelSimple> _playedAlready;
 	object_ptr<Ui::LabelSimple> _toPlayLeft;
 	object_ptr<Ui::LabelSimple> _downloadProgress = { nullptr };
+	base::unique_qptr<Ui::RpWidget> _preview;
+	QImage _previewFrame;
 
 	const style::PopupMenu &_menuStyle;
 	base::unique_qptr<Ui::PopupMenu> _menu;
@@ -0,0 +1,383 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "media/view/media_view_storyboard.h"
+
+#include "ffmpeg/ffmpeg_utility.h"
+#include "data/data_document.h"
+#include "data/data_session.h"
+#include "storage/cache/storage_cache_database.h"
+#include "styles/style_media_view.h"
+
+#include <QtCore/QBuffer>
+#include <QtCore/QFile>
+
+namespace Media::View {
+namespace {
+
+constexpr auto kVersion = quint32(2);
+constexpr auto kMaxTiles = 100;
+constexpr auto kMaxSheetPixels = 1024 * 1024;
+constexpr auto kMinTileInterval = crl::time(1000);
+constexpr auto kColumns = 10;
+constexpr auto kMaxPacketsForFrame = 256;
+constexpr auto kJpegQuality = 80;
+
+using Sheet = Storyboard::Sheet;
+
+[[nodiscard]] QByteArray Serialize(const Sheet &sheet) {
+	auto image = QByteArray();
+	{
+		auto buffer = QBuffer(&image);
+		sheet.image.save(&buffer, "JPG", kJpegQuality);
+	}
+	auto result = QByteArray();
+	{
+		auto stream = QDataStream(&result, QIODevice::WriteOnly);
+		stream.setVersion(QDataStream::Qt_5_1);
+		stream
+			<< kVersion
+			<< qint32(sheet.tileWidth)
+			<< qint32(sheet.tile.width())
+			<< qint32(sheet.tile.height())
+			<< qint32(sheet.columns)
+			<< qint32(sheet.count)
+			<< qint64(sheet.duration)
+			<< image;
+	}
+	return result;
+}
+
+[[nodiscard]] Sheet Deserialize(const QByteArray &data) {
+	if (data.isEmpty()) {
+		return {};
+	}
+	auto stream = QDataStream(data);
+	stream.setVersion(QDataStream::Qt_5_1);
+	auto version = quint32();
+	auto tileWidth = qint32();
+	auto width = qint32();
+	auto height = qint32();
+	auto columns = qint32();
+	auto count = qint32();
+	auto duration = qint64();
+	auto image = QByteArray();
+	stream
+		>> version
+		>> tileWidth
+		>> width
+		>> height
+		>> columns
+		>> count
+		>> duration
+		>> image;
+	if (stream.status() != QDataStream::Ok
+		|| version != kVersion
+		|| tileWidth <= 0
+		|| width <= 0
+		|| height <= 0
+		|| columns <= 0
+		|| count <= 0
+		|| duration <= 0) {
+		return {};
+	}
+	auto result = Sheet{
+		.tileWidth = tileWidth,
+		.tile = QSize(width, height),
+		.columns = columns,
+		.count = count,
+		.duration = duration,
+	};
+	result.image.loadFromData(image, "JPG");
+	const auto rows = (count + columns - 1) / columns;
+	if (result.image.width() < width * std::min(count, int(columns))
+		|| result.image.height() < height * rows) {
+		return {};
+	}
+	return result;
+}
+
+[[nodiscard]] bool DecodeKeyframe(
+		not_null<AVFormatContext*> format,
+		not_null<AVCodecContext*> codec,
+		not_null<AVFrame*> frame,
+		int streamIndex,
+		int64_t pts) {
+	auto error = FFmpeg::AvErrorWrap(av_seek_frame(
+		format,
+		streamIndex,
+		pts,
+		AVSEEK_FLAG_BACKWARD));
+	if (error) {
+		return false;
+	}
+	avcodec_flush_buffers(codec);
+	for (auto i = 0; i != kMaxPacketsForFrame; ++i) {
+		auto packet = FFmpeg::Packet();
+		error = av_read_frame(format, &packet.fields());
+		if (error) {
+			// Drain the decoder in case it holds the last keyframe.
+			avcodec_send_packet(codec, nullptr);
+			return !FFmpeg::AvErrorWrap(avcodec_receive_frame(codec, frame));
+		} else if (packet.fields().stream_index != streamIndex) {
+			continue;
+		}
+		error = avcodec_send_packet(codec, &packet.fields());
+		if (error && error.code() != AVERROR(EAGAIN)) {
+			return false;
+		}
+		error = avcodec_receive_frame(codec, frame);
+		if (!error) {
+			return true;
+		} else if (error.code() != AVERROR(EAGAIN)) {
+			return false;
+		}
+	}
+	return false;
+}
+
+[[nodiscard]] Sheet Generate(
+		not_null<QIODevice*> device,
+		int tileWidth,
+		const std::atomic<bool> &cancelled) {
+	auto format = FFmpeg::MakeFormatPointer(
+		static_cast<void*>(device.get()),
+		&FFmpeg::ReadIODevice,
+		nullptr,
+		&FFmpeg::SeekIODevice);
+	if (!format) {
+		return {};
+	}
+	auto error = FFmpeg::AvErrorWrap(
+		avformat_find_stream_info(format.get(), nullptr));
+	if (error) {
+		FFmpeg::LogError(qstr("avformat_find_stream_info"), error);
+		return {};
+	}
+	const auto streamIndex = av_find_best_stream(
+		format.get(),
+		AVMEDIA_TYPE_VIDEO,
+		-1,
+		-1,
+		nullptr,
+		0);
+	if (streamIndex < 0) {
+		return {};
+	}
+	const auto stream = format->streams[streamIndex];
+	const auto duration = (stream->duration != AV_NOPTS_VALUE)
+		? FFmpeg::PtsToTime(stream->duration, stream->time_base)
+		: (format->duration != AV_NOPTS_VALUE)
+		? (format->duration / (AV_TIME_BASE / 1000))
+		: crl::time(0);
+	if (duration <= 0) {
+		return {};
+	}
+	auto codec = FFmpeg::MakeCodecPointer({ .stream = stream });
+	if (!codec) {
+		return {};
+	}
+	// Only keyframes are needed, so the rest are not even decoded.
+	codec->skip_frame = AVDISCARD_NONKEY;
+
+	const auto rotation = FFmpeg::ReadRotationFromMetadata(stream);
+	const auto aspect = FFmpeg::ValidateAspectRatio(
+		stream->sample_aspect_ratio);
+	const auto original = FFmpeg::CorrectByAspect(
+		QSize(codec->width, codec->height),
+		aspect);
+	if (original.isEmpty()) {
+		return {};
+	}
+	const auto count = std::clamp(
+		int(duration / kMinTileInterval),
+		1,
+		kMaxTiles);
+
+	// Scale the tiles down, so that the whole sheet fits the limit.
+	auto unrotated = original.scaled(
+		tileWidth,
+		tileWidth,
+		Qt::KeepAspectRatio);
+	const auto pixels = int64(unrotated.width())
+		* unrotated.height()
+		* count;
+	if (pixels > kMaxSheetPixels) {
+		const auto scale = std::sqrt(float64(kMaxSheetPixels) / pixels);
+		unrotated = QSize(
+			int(unrotated.width() * scale),
+			int(unrotated.height() * scale));
+	}
+	unrotated = unrotated.expandedTo(QSize(2, 2));
+	const auto tile = FFmpeg::RotationSwapWidthHeight(rotation)
+		? unrotated.transposed()
+		: unrotated;
+	const auto columns = std::min(count, kColumns);
+	const auto rows = (count + columns - 1) / columns;
+	auto result = Sheet{
+		.image = QImage(
+			tile.width() * columns,
+			tile.height() * rows,
+			QImage::Format_ARGB32_Premultiplied),
+		.tileWidth = tileWidth,
+		.tile = tile,
+		.columns = columns,
+		.count = count,
+		.duration = duration,
+	};
+	result.image.fill(Qt::black);
+
+	auto frame = FFmpeg::MakeFramePointer();
+	auto swscale = FFmpeg::SwscalePointer();
+	auto storage = QImage();
+	auto p = QPainter(&result.image);
+	for (auto i = 0; i != count; ++i) {
+		if (cancelled) {
+			return {};
+		}
+		const auto position = duration * i / count;
+		const auto pts = FFmpeg::TimeToPts(position, stream->time_base)
+			+ ((stream->start_time != AV_NOPTS_VALUE)
+				? stream->start_time
+				: 0);
+		if (!DecodeKeyframe(
+				format.get(),
+				codec.get(),
+				frame.get(),
+				streamIndex,
+				pts)) {
+			continue;
+		}
+		swscale = FFmpeg::MakeSwscalePointer(
+			frame.get(),
+			unrotated,
+			&swscale);
+		if (!swscale) {
+			return {};
+		}
+		if (!FFmpeg::GoodStorageForFrame(storage, unrotated)) {
+			storage = FFmpeg::CreateFrameStorage(unrotated);
+		}
+		uint8_t *data[AV_NUM_DATA_POINTERS] = { storage.bits(), nullptr };
+		int linesize[AV_NUM_DATA_POINTERS] = {
+			int(storage.bytesPerLine()),
+			0
+		};
+		sws_scale(
+			swscale.get(),
+			frame->data,
+			frame->linesize,
+			0,
+			frame->height,
+			data,
+			linesize);
+		FFmpeg::ClearFrameMemory(frame.get());
+
+		const auto topLeft = QPoint(
+			(i % columns) * tile.width(),
+			(i / columns) * tile.height());
+		if (rotation) {
+			p.drawImage(
+				topLeft,
+				storage.transformed(QTransform().rotate(rotation)));
+		} else {
+			p.drawImage(topLeft, storage);
+		}
+	}
+	return result;
+}
+
+} // namespace
+
+Storyboard::Storyboard(
+	not_null<DocumentData*> document,
+	const QString &path,
+	const QByteArray &bytes)
+: _document(document)
+, _tileWidth(st::mediaviewStoryboardWidth * cIntRetinaFactor())
+, _cancelled(std::make_shared<std::atomic<bool>>(false)) {
+	const auto weak = base::make_weak(this);
+	const auto tileWidth = _tileWidth;
+	_document->owner().cache().get(
+		_document->storyboardCacheKey(),
+		[=](QByteArray value) {
+			auto sheet = Deserialize(value);
+			const auto good = !sheet.image.isNull()
+				&& (sheet.tileWidth == tileWidth);
+			crl::on_main(weak, [=, sheet = std::move(sheet)]() mutable {
+				if (good) {
+					apply(std::move(sheet));
+				} else {
+					// Generated for another scale or not generated yet.
+					generate(path, bytes);
+				}
+			});
+		});
+}
+
+Storyboard::~Storyboard() {
+	*_cancelled = true;
+}
+
+void Storyboard::generate(const QString &path, const QByteArray &bytes) {
+	const auto weak = base::make_weak(this);
+	const auto cancelled = _cancelled;
+	const auto tileWidth = _tileWidth;
+	crl::async([=] {
+		auto file = QFile(path);
+		auto buffer = QBuffer();
+		const auto device = [&]() -> QIODevice* {
+			if (!bytes.isEmpty()) {
+				buffer.setData(bytes);
+				return &buffer;
+			} else if (!path.isEmpty()) {
+				return &file;
+			}
+			return nullptr;
+		}();
+		if (!device || !device->open(QIODevice::ReadOnly)) {
+			return;
+		}
+		auto sheet = Generate(device, tileWidth, *cancelled);
+		if (sheet.image.isNull()) {
+			return;
+		}
+		auto serialized = Serialize(sheet);
+		crl::on_main(weak, [=, sheet = std::move(sheet)]() mutable {
+			_document->owner().cache().put(
+				_document->storyboardCacheKey(),
+				Storage::Cache::Database::TaggedValue(
+					std::move(serialized),
+					Data::kImageCacheTag));
+			apply(std::move(sheet));
+		});
+	});
+}
+
+void Storyboard::apply(Sheet &&sheet) {
+	_sheet = std::move(sheet);
+}
+
+bool Storyboard::ready() const {
+	return !_sheet.image.isNull();
+}
+
+QImage Storyboard::frame(crl::time position) const {
+	if (!ready()) {
+		return QImage();
+	}
+	const auto index = std::clamp(
+		int(position * _sheet.count / _sheet.duration),
+		0,
+		_sheet.count - 1);
+	const auto topLeft = QPoint(
+		(index % _sheet.columns) * _sheet.tile.width(),
+		(index / _sheet.columns) * _sheet.tile.height());
+	return _sheet.image.copy(QRect(topLeft, _sheet.tile));
+}
+
+} // namespace Media::View
@@ -0,0 +1,50 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/weak_ptr.h"
+
+class DocumentData;
+
+namespace Media::View {
+
+// Small keyframe previews of a local or already loaded video, shown over
+// the playback slider while seeking. The sprite sheet is generated on a
+// background thread once and is kept in the media cache afterwards.
+class Storyboard final : public base::has_weak_ptr {
+public:
+	Storyboard(
+		not_null<DocumentData*> document,
+		const QString &path,
+		const QByteArray &bytes);
+	~Storyboard();
+
+	[[nodiscard]] bool ready() const;
+	[[nodiscard]] QImage frame(crl::time position) const;
+
+	struct Sheet {
+		QImage image;
+		int tileWidth = 0; // Requested, the tile may be scaled down.
+		QSize tile;
+		int columns = 0;
+		int count = 0;
+		crl::time duration = 0;
+	};
+
+private:
+	void generate(const QString &path, const QByteArray &bytes);
+	void apply(Sheet &&sheet);
+
+	const not_null<DocumentData*> _document;
+	const int _tileWidth = 0;
+	const std::shared_ptr<std::atomic<bool>> _cancelled;
+	Sheet _sheet;
+
+};
+
+} // namespace Media::View
@@ -23,6 +23,7 @@ namespace MTP::details {
 namespace {
 
 constexpr auto kSendNextTimeout = crl::time(800);
+constexpr auto kParallelRequests = 3;
 constexpr auto kMinTimeToLive = 10 * crl::time(1000);
 constexpr auto kMaxTimeToLive = 300 * crl::time(1000);
 
@@ -185,6 +186,11 @@ DomainResolver::DomainResolver(Fn<void(
 	_manager.setProxy(QNetworkProxy::NoProxy);
 }
 
+auto DomainResolver::Cache() -> std::map<AttemptKey, CacheEntry>& {
+	static auto result = std::map<AttemptKey, CacheEntry>();
+	return result;
+}
+
 void DomainResolver::resolve(const QString &domain) {
 	resolve({ domain, false });
 	resolve({ domain, true });
@@ -196,9 +202,10 @@ void DomainResolver::resolve(const AttemptKey &key) {
 	} else if (_requests.find(key) != end(_requests)) {
 		return;
 	}
-	const auto i = _cache.find(key);
+	const auto &cache = Cache();
+	const auto i = cache.find(key);
 	_lastTimestamp = crl::now();
-	if (i != end(_cache) && i->second.expireAt > _lastTimestamp) {
+	if (i != end(cache) && i->second.expireAt > _lastTimestamp) {
 		checkExpireAndPushResult(key.domain);
 		return;
 	}
@@ -233,17 +240,18 @@ void DomainResolver::resolve(const AttemptKey &key) {
 	ranges::reverse(attempts); // We go from last to first.
 
 	_attempts.emplace(key, Attempts{ std::move(attempts) });
-	sendNextRequest(key);
+	sendNextRequest(key, kParallelRequests);
 }
 
 void DomainResolver::checkExpireAndPushResult(const QString &domain) {
-	const auto ipv4 = _cache.find({ domain, false });
-	if (ipv4 == end(_cache) || ipv4->second.expireAt <= _lastTimestamp) {
+	const auto &cache = Cache();
+	const auto ipv4 = cache.find({ domain, false });
+	if (ipv4 == end(cache) || ipv4->second.expireAt <= _lastTimestamp) {
 		return;
 	}
 	auto result = ipv4->second;
-	const auto ipv6 = _cache.find({ domain, true });
-	if (ipv6 != end(_cache) && ipv6->second.expireAt > _lastTimestamp) {
+	const auto ipv6 = cache.find({ domain, true });
+	if (ipv6 != end(cache) && ipv6->second.expireAt > _lastTimestamp) {
 		result.ips.append(ipv6->second.ips);
 		accumulate_min(result.expireAt, ipv6->second.expireAt);
 	}
@@ -252,22 +260,28 @@ void DomainResolver::checkExpireAndPushResult(const QString &domain) {
 	});
 }
 
-void DomainResolver::sendNextRequest(const AttemptKey &key) {
+void DomainResolver::sendNextRequest(const AttemptKey &key, int count) {
 	auto i = _attempts.find(key);
 	if (i == end(_attempts)) {
 		return;
 	}
 	auto &attempts = i->second;
 	auto &list = attempts.list;
-	const auto attempt = list.back();
-	list.pop_back();
+	while (count-- > 0 && !list.empty()) {
+		const auto attempt = list.back();
+		list.pop_back();
+		performRequest(key, attempt);
+	}
 
 	if (!list.empty()) {
+		const auto generation = ++attempts.generation;
 		base::call_delayed(kSendNextTimeout, &attempts.guard, [=] {
-			sendNextRequest(key);
+			const auto i = _attempts.find(key);
+			if (i != end(_attempts) && i->second.generation == generation) {
+				sendNextRequest(key, 1);
+			}
 		});
 	}
-	performRequest(key, attempt);
 }
 
 void DomainResolver::performRequest(
@@ -319,6 +333,16 @@ void DomainResolver::requestFinished(
 	const auto result = finalizeRequest(key, reply);
 	const auto response = ParseDnsResponse(result);
 	if (response.empty()) {
+		if (_requests.find(key) != end(_requests)) {
+			return;
+		}
+		// Nothing else is in flight, don't wait for the timeout.
+		const auto i = _attempts.find(key);
+		if (i != end(_attempts) && !i->second.list.empty()) {
+			sendNextRequest(key, 1);
+		} else {
+			_attempts.erase(key);
+		}
 		return;
 	}
 	_requests.erase(key);
@@ -334,7 +358,7 @@ void DomainResolver::requestFinished(
 	}
 	_lastTimestamp = crl::now();
 	entry.expireAt = _lastTimestamp + ttl;
-	_cache[key] = std::move(entry);
+	Cache()[key] = std::move(entry);
 
 	checkExpireAndPushResult(key.domain);
 }
@@ -76,11 +76,15 @@ private:
 	};
 	struct Attempts {
 		std::vector<Attempt> list;
+		int generation = 0;
 		base::has_weak_ptr guard;
 	};
 
+	// Results are shared by the resolvers of all the accounts.
+	[[nodiscard]] static std::map<AttemptKey, CacheEntry> &Cache();
+
 	void resolve(const AttemptKey &key);
-	void sendNextRequest(const AttemptKey &key);
+	void sendNextRequest(const AttemptKey &key, int count);
 	void performRequest(const AttemptKey &key, const Attempt &attempt);
 	void checkExpireAndPushResult(const QString &domain);
 	void requestFinished(
@@ -98,7 +102,6 @@ private:
 	QNetworkAccessManager _manager;
 	std::map<AttemptKey, Attempts> _attempts;
 	std::map<AttemptKey, std::vector<ServiceWebRequest>> _requests;
-	std::map<AttemptKey, CacheEntry> _cache;
 	crl::time _lastTimestamp = 0;
 
 };
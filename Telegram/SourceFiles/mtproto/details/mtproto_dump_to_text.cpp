@@ -12,6 +12,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "zlib.h"
 
+#include <QtCore/QRegularExpression>
+
 namespace MTP::details {
 
 bool DumpToTextCore(DumpToTextBuffer &to, const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons, uint32 level, mtpPrime vcons) {
@@ -166,4 +168,28 @@ QString DumpToText(const mtpPrime *&from, const mtpPrime *end) {
 	return QString::fromUtf8(to.p, to.size);
 }
 
+QString DumpTypeName(mtpTypeId type) {
+	static auto Mutex = QMutex();
+	static auto Names = base::flat_map<mtpTypeId, QString>();
+
+	QMutexLocker lock(&Mutex);
+	if (const auto i = Names.find(type); i != Names.end()) {
+		return i->second;
+	}
+
+	// Dump just the constructor id, the fields fail to read after its name.
+	const auto buffer = mtpPrime(type);
+	auto from = &buffer;
+	DumpToTextBuffer to;
+	[[maybe_unused]] bool result = DumpToTextType(to, from, from + 1, 0, 0);
+	const auto text = QString::fromUtf8(to.p, to.size);
+	const auto match = QRegularExpression(
+		"^\\{ ([A-Za-z0-9_\\.]+)").match(text);
+	const auto name = match.hasMatch()
+		? match.captured(1)
+		: u"0x"_q + QString::number(uint32(type), 16);
+	Names.emplace(type, name);
+	return name;
+}
+
 } // namespace MTP::details
@@ -15,6 +15,9 @@ namespace MTP::details {
 // Human-readable text serialization
 QString DumpToText(const mtpPrime *&from, const mtpPrime *end);
 
+// Name of the constructor or method, the same as DumpToText() uses.
+[[nodiscard]] QString DumpTypeName(mtpTypeId type);
+
 struct DumpToTextBuffer {
 	static constexpr auto kBufferSize = 1024 * 1024; // 1 mb start size
 
@@ -12,12 +12,20 @@ namespace MTP::details {
 ReceivedIdsManager::Result ReceivedIdsManager::registerMsgId(
 		mtpMsgId msgId,
 		bool needAck) {
-	const auto i = _idsNeedAck.find(msgId);
-	if (i != _idsNeedAck.end()) {
+	if (_idsNeedAck.empty() || msgId > max()) {
+		_idsNeedAck.push_back({ msgId, needAck });
+		return Result::Success;
+	}
+	const auto i = ranges::lower_bound(
+		_idsNeedAck,
+		msgId,
+		ranges::less(),
+		&Entry::msgId);
+	if (i != _idsNeedAck.end() && i->msgId == msgId) {
 		MTP_LOG(-1, ("No need to handle - %1 already is in map").arg(msgId));
 		return Result::Duplicate;
 	} else if (_idsNeedAck.size() < kIdsBufferSize || msgId > min()) {
-		_idsNeedAck.emplace(msgId, needAck);
+		_idsNeedAck.insert(i, { msgId, needAck });
 		return Result::Success;
 	}
 	MTP_LOG(-1, ("Reset on too old - %1 < min = %2").arg(msgId).arg(min()));
@@ -25,26 +33,36 @@ ReceivedIdsManager::Result ReceivedIdsManager::registerMsgId(
 }
 
 mtpMsgId ReceivedIdsManager::min() const {
-	return _idsNeedAck.empty() ? 0 : _idsNeedAck.begin()->first;
+	return _idsNeedAck.empty() ? 0 : _idsNeedAck.front().msgId;
 }
 
 mtpMsgId ReceivedIdsManager::max() const {
-	auto end = _idsNeedAck.end();
-	return _idsNeedAck.empty() ? 0 : (--end)->first;
+	return _idsNeedAck.empty() ? 0 : _idsNeedAck.back().msgId;
+}
+
+auto ReceivedIdsManager::find(mtpMsgId msgId) const
+-> std::deque<Entry>::const_iterator {
+	const auto i = ranges::lower_bound(
+		_idsNeedAck,
+		msgId,
+		ranges::less(),
+		&Entry::msgId);
+	return (i != _idsNeedAck.end() && i->msgId == msgId)
+		? i
+		: _idsNeedAck.end();
 }
 
 ReceivedIdsManager::State ReceivedIdsManager::lookup(mtpMsgId msgId) const {
-	auto i = _idsNeedAck.find(msgId);
+	const auto i = find(msgId);
 	if (i == _idsNeedAck.end()) {
 		return State::NotFound;
 	}
-	return i->second ? State::NeedsAck : State::NoAckNeeded;
+	return i->needAck ? State::NeedsAck : State::NoAckNeeded;
 }
 
 void ReceivedIdsManager::shrink() {
-	auto size = _idsNeedAck.size();
-	while (size-- > kIdsBufferSize) {
-		_idsNeedAck.erase(_idsNeedAck.begin());
+	while (_idsNeedAck.size() > kIdsBufferSize) {
+		_idsNeedAck.pop_front();
 	}
 }
 
@@ -7,7 +7,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #pragma once
 
-#include "base/flat_map.h"
+#include <deque>
 
 namespace MTP::details {
 
@@ -36,7 +36,17 @@ public:
 	void clear();
 
 private:
-	base::flat_map<mtpMsgId, bool> _idsNeedAck;
+	struct Entry {
+		mtpMsgId msgId = 0;
+		bool needAck = false;
+	};
+
+	// Sorted by msgId. New ids are almost always the largest ones and
+	// the oldest ones are dropped from the front, both are O(1) here.
+	[[nodiscard]] std::deque<Entry>::const_iterator find(
+		mtpMsgId msgId) const;
+
+	std::deque<Entry> _idsNeedAck;
 
 };
 
@@ -0,0 +1,162 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "mtproto/details/mtproto_request_stats.h"
+
+#include "mtproto/details/mtproto_dump_to_text.h"
+
+namespace MTP::details {
+namespace {
+
+constexpr auto kSummaryLimit = 5;
+
+} // namespace
+
+mtpTypeId RequestMethod(const SerializedRequest &request) {
+	constexpr auto kPosition = SerializedRequest::kMessageBodyPosition;
+	return (request->size() > kPosition)
+		? mtpTypeId((*request)[kPosition])
+		: mtpTypeId(0);
+}
+
+int RequestBodyBytes(const SerializedRequest &request) {
+	constexpr auto kPosition = SerializedRequest::kMessageLengthPosition;
+	return (request->size() > kPosition) ? int((*request)[kPosition]) : 0;
+}
+
+void RequestStats::Histogram::add(int64 value) {
+	value = std::max(value, int64(0));
+	auto bucket = 0;
+	while (bucket + 1 < kBuckets && (int64(1) << bucket) <= value) {
+		++bucket;
+	}
+	++buckets[bucket];
+	++count;
+	total += value;
+	max = std::max(max, value);
+}
+
+int64 RequestStats::Histogram::percentile(int percent) const {
+	if (!count) {
+		return 0;
+	}
+	const auto till = (int64(count) * percent + 99) / 100;
+	auto passed = int64();
+	for (auto bucket = 0; bucket != kBuckets; ++bucket) {
+		passed += buckets[bucket];
+		if (passed >= till) {
+			// Upper bound of the bucket, but not more than the real max.
+			return std::min(bucket ? (int64(1) << bucket) : 0, max);
+		}
+	}
+	return max;
+}
+
+int64 RequestStats::Histogram::average() const {
+	return count ? (total / count) : 0;
+}
+
+void RequestStats::sent(
+		ShiftedDcId shiftedDcId,
+		mtpTypeId method,
+		int bytes,
+		crl::time queued) {
+	QMutexLocker lock(&_mutex);
+	auto &entry = _entries[Key(method, shiftedDcId)];
+	entry.requestBytes.add(bytes);
+	entry.queued.add(queued);
+}
+
+void RequestStats::resent(ShiftedDcId shiftedDcId, mtpTypeId method) {
+	QMutexLocker lock(&_mutex);
+	++_entries[Key(method, shiftedDcId)].resends;
+}
+
+void RequestStats::received(
+		ShiftedDcId shiftedDcId,
+		mtpTypeId method,
+		int bytes,
+		crl::time roundTrip) {
+	QMutexLocker lock(&_mutex);
+	auto &entry = _entries[Key(method, shiftedDcId)];
+	entry.responseBytes.add(bytes);
+	entry.roundTrip.add(roundTrip);
+}
+
+void RequestStats::floodWait(
+		ShiftedDcId shiftedDcId,
+		mtpTypeId method,
+		int seconds) {
+	QMutexLocker lock(&_mutex);
+	auto &entry = _entries[Key(method, shiftedDcId)];
+	++entry.floodWaits;
+	entry.floodWaitSeconds += seconds;
+}
+
+QString RequestStats::Line(const Key &key, const Entry &entry) {
+	const auto &[method, shiftedDcId] = key;
+	return u"%1 dc%2: %3 sent, %4 resent, %5 received; "
+		"request %6 / %7 bytes, response %8 / %9 bytes; "
+		"queued %10 / %11 ms, rtt %12 / %13 ms; flood waits %14 (%15 s)"_q
+		.arg(DumpTypeName(method))
+		.arg(shiftedDcId)
+		.arg(entry.requestBytes.count)
+		.arg(entry.resends)
+		.arg(entry.responseBytes.count)
+		.arg(entry.requestBytes.average())
+		.arg(entry.requestBytes.max)
+		.arg(entry.responseBytes.average())
+		.arg(entry.responseBytes.max)
+		.arg(entry.queued.percentile(50))
+		.arg(entry.queued.percentile(99))
+		.arg(entry.roundTrip.percentile(50))
+		.arg(entry.roundTrip.percentile(99))
+		.arg(entry.floodWaits)
+		.arg(entry.floodWaitSeconds);
+}
+
+QString RequestStats::table() const {
+	QMutexLocker lock(&_mutex);
+	auto result = QStringList();
+	result.reserve(_entries.size() + 1);
+	result.push_back(u"Sizes are average / max, "
+		"times are p50 / p99 by power of two buckets."_q);
+	for (const auto &[key, entry] : _entries) {
+		result.push_back(Line(key, entry));
+	}
+	return result.join('\n');
+}
+
+QString RequestStats::summary() const {
+	QMutexLocker lock(&_mutex);
+	auto sorted = std::vector<decltype(_entries.cbegin())>();
+	sorted.reserve(_entries.size());
+	for (auto i = _entries.cbegin(); i != _entries.cend(); ++i) {
+		if (i->second.roundTrip.count) {
+			sorted.push_back(i);
+		}
+	}
+	const auto slowness = [](auto i) {
+		return i->second.roundTrip.percentile(99);
+	};
+	ranges::sort(sorted, ranges::greater(), slowness);
+	if (sorted.size() > kSummaryLimit) {
+		sorted.resize(kSummaryLimit);
+	}
+	auto result = QStringList();
+	for (const auto i : sorted) {
+		result.push_back(Line(i->first, i->second));
+	}
+	return result.join('\n');
+}
+
+void RequestStats::clear() {
+	QMutexLocker lock(&_mutex);
+	_entries.clear();
+}
+
+} // namespace MTP::details
@@ -0,0 +1,76 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "mtproto/details/mtproto_serialized_request.h"
+
+#include <QtCore/QMutex>
+
+namespace MTP::details {
+
+[[nodiscard]] mtpTypeId RequestMethod(const SerializedRequest &request);
+[[nodiscard]] int RequestBodyBytes(const SerializedRequest &request);
+
+// Sizes and timings of the requests grouped by method and dc.
+// Thread-safe, filled from the session threads.
+class RequestStats final {
+public:
+	void sent(
+		ShiftedDcId shiftedDcId,
+		mtpTypeId method,
+		int bytes,
+		crl::time queued);
+	void resent(ShiftedDcId shiftedDcId, mtpTypeId method);
+	void received(
+		ShiftedDcId shiftedDcId,
+		mtpTypeId method,
+		int bytes,
+		crl::time roundTrip);
+	void floodWait(ShiftedDcId shiftedDcId, mtpTypeId method, int seconds);
+
+	// Full table, one line per method and dc.
+	[[nodiscard]] QString table() const;
+
+	// The slowest methods only, for the log.
+	[[nodiscard]] QString summary() const;
+
+	void clear();
+
+private:
+	// Values are put to power of two buckets.
+	struct Histogram {
+		static constexpr auto kBuckets = 32;
+
+		void add(int64 value);
+		[[nodiscard]] int64 percentile(int percent) const;
+		[[nodiscard]] int64 average() const;
+
+		std::array<int, kBuckets> buckets = { { 0 } };
+		int count = 0;
+		int64 total = 0;
+		int64 max = 0;
+	};
+	struct Entry {
+		Histogram requestBytes;
+		Histogram responseBytes;
+		Histogram queued;
+		Histogram roundTrip;
+		int resends = 0;
+		int floodWaits = 0;
+		int64 floodWaitSeconds = 0;
+	};
+	using Key = std::pair<mtpTypeId, ShiftedDcId>;
+
+	[[nodiscard]] static QString Line(const Key &key, const Entry &entry);
+
+	mutable QMutex _mutex;
+	base::flat_map<Key, Entry> _entries;
+
+};
+
+} // namespace MTP::details
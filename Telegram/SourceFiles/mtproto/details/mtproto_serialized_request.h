@@ -93,6 +93,12 @@ public:
 	bool needsLayer = false;
 	bool forceSendInContainer = false;
 
+	// Only the first send is counted in RequestStats::sent().
+	bool statsSent = false;
+
+	// Background requests give way to the interactive ones in the queue.
+	bool background = false;
+
 };
 
 template <typename Request, typename>
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/mtp_instance.h"
 
 #include "mtproto/details/mtproto_dcenter.h"
+#include "mtproto/details/mtproto_request_stats.h"
 #include "mtproto/details/mtproto_rsa_public_key.h"
 #include "mtproto/special_config_request.h"
 #include "mtproto/session.h"
@@ -33,6 +34,7 @@ namespace {
 
 constexpr auto kConfigBecomesOldIn = 2 * 60 * crl::time(1000);
 constexpr auto kConfigBecomesOldForBlockedIn = 8 * crl::time(1000);
+constexpr auto kRequestStatsLogTimeout = 10 * 60 * crl::time(1000);
 
 using namespace details;
 
@@ -103,6 +105,8 @@ public:
 	void restart(ShiftedDcId shiftedDcId);
 	[[nodiscard]] int32 dcstate(ShiftedDcId shiftedDcId = 0);
 	[[nodiscard]] QString dctransport(ShiftedDcId shiftedDcId = 0);
+	[[nodiscard]] ConnectionQuality dcquality(
+		ShiftedDcId shiftedDcId = 0);
 	void ping();
 	void cancel(mtpRequestId requestId);
 	[[nodiscard]] int32 state(mtpRequestId requestId); // < 0 means waiting for such count of ms
@@ -176,6 +180,10 @@ public:
 
 	void prepareToDestroy();
 
+	[[nodiscard]] RequestStats &requestStats();
+	void setRequestStatsLogging(bool enabled);
+	[[nodiscard]] bool requestStatsLogging() const;
+
 	[[nodiscard]] rpl::lifetime &lifetime();
 
 private:
@@ -220,6 +228,9 @@ private:
 	const std::unique_ptr<Config> _config;
 	const std::shared_ptr<base::NetworkReachability> _networkReachability;
 
+	// Filled from the session threads, so it should outlive them.
+	RequestStats _requestStats;
+
 	std::unique_ptr<QThread> _mainSessionThread;
 	std::unique_ptr<QThread> _otherSessionsThread;
 	std::vector<std::unique_ptr<QThread>> _fileSessionThreads;
@@ -285,6 +296,8 @@ private:
 
 	base::Timer _checkDelayedTimer;
 
+	std::unique_ptr<base::Timer> _requestStatsLogTimer;
+
 	Core::SettingsProxy &_proxySettings;
 
 	rpl::lifetime _lifetime;
@@ -637,6 +650,22 @@ QString Instance::Private::dctransport(ShiftedDcId shiftedDcId) {
 	return QString();
 }
 
+ConnectionQuality Instance::Private::dcquality(ShiftedDcId shiftedDcId) {
+	if (!shiftedDcId) {
+		Assert(_mainSession != nullptr);
+		return _mainSession->quality();
+	}
+	if (!BareDcId(shiftedDcId)) {
+		Assert(_mainSession != nullptr);
+		shiftedDcId += BareDcId(_mainSession->getDcWithShift());
+	}
+
+	if (const auto session = findSession(shiftedDcId)) {
+		return session->quality();
+	}
+	return ConnectionQuality();
+}
+
 void Instance::Private::ping() {
 	getSession(0)->ping();
 }
@@ -1462,6 +1491,12 @@ bool Instance::Private::onErrorDefault(
 			}
 		} else if (m1.hasMatch()) {
 			secs = m1.captured(1).toInt();
+			if (const auto request = getRequest(requestId)) {
+				_requestStats.floodWait(
+					qAbs(queryRequestByDc(requestId).value_or(0)),
+					RequestMethod(request),
+					secs);
+			}
 //			if (secs >= 60) return false;
 		} else if (m2.hasMatch()) {
 			secs = m2.captured(1).toInt();
@@ -1562,6 +1597,27 @@ not_null<Session*> Instance::Private::getSession(
 	return startSession(shiftedDcId);
 }
 
+RequestStats &Instance::Private::requestStats() {
+	return _requestStats;
+}
+
+void Instance::Private::setRequestStatsLogging(bool enabled) {
+	if (!enabled) {
+		_requestStatsLogTimer = nullptr;
+		return;
+	} else if (_requestStatsLogTimer) {
+		return;
+	}
+	_requestStatsLogTimer = std::make_unique<base::Timer>([=] {
+		LOG(("MTP Stats: %1").arg(_requestStats.summary()));
+	});
+	_requestStatsLogTimer->callEach(kRequestStatsLogTimeout);
+}
+
+bool Instance::Private::requestStatsLogging() const {
+	return (_requestStatsLogTimer != nullptr);
+}
+
 rpl::lifetime &Instance::Private::lifetime() {
 	return _lifetime;
 }
@@ -1888,6 +1944,10 @@ QString Instance::dctransport(ShiftedDcId shiftedDcId) {
 	return _private->dctransport(shiftedDcId);
 }
 
+ConnectionQuality Instance::dcquality(ShiftedDcId shiftedDcId) {
+	return _private->dcquality(shiftedDcId);
+}
+
 void Instance::ping() {
 	_private->ping();
 }
@@ -2050,6 +2110,18 @@ void Instance::sendAnything(ShiftedDcId shiftedDcId, crl::time msCanWait) {
 	_private->getSession(shiftedDcId)->sendAnything(msCanWait);
 }
 
+RequestStats &Instance::requestStats() const {
+	return _private->requestStats();
+}
+
+void Instance::setRequestStatsLogging(bool enabled) {
+	_private->setRequestStatsLogging(enabled);
+}
+
+bool Instance::requestStatsLogging() const {
+	return _private->requestStatsLogging();
+}
+
 rpl::lifetime &Instance::lifetime() {
 	return _private->lifetime();
 }
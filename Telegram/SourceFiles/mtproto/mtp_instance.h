@@ -15,6 +15,7 @@ namespace details {
 
 class Dcenter;
 class Session;
+class RequestStats;
 
 [[nodiscard]] int GetNextRequestId();
 
@@ -28,6 +29,14 @@ using AuthKeyPtr = std::shared_ptr<AuthKey>;
 using AuthKeysList = std::vector<AuthKeyPtr>;
 enum class Environment : uchar;
 
+// Measured by the ping round trips of the current connection.
+struct ConnectionQuality {
+	crl::time smoothedRoundTrip = 0;
+	crl::time roundTripVariance = 0;
+	crl::time connectedPing = 0;
+	int lostPings = 0;
+};
+
 class Instance : public QObject {
 	Q_OBJECT
 
@@ -93,6 +102,7 @@ public:
 	void restart(ShiftedDcId shiftedDcId);
 	int32 dcstate(ShiftedDcId shiftedDcId = 0);
 	QString dctransport(ShiftedDcId shiftedDcId = 0);
+	ConnectionQuality dcquality(ShiftedDcId shiftedDcId = 0);
 	void ping();
 	void cancel(mtpRequestId requestId);
 	int32 state(mtpRequestId requestId); // < 0 means waiting for such count of ms
@@ -212,6 +222,13 @@ public:
 			afterRequestId);
 	}
 
+	// Thread-safe.
+	[[nodiscard]] details::RequestStats &requestStats() const;
+
+	// Main thread.
+	void setRequestStatsLogging(bool enabled);
+	[[nodiscard]] bool requestStatsLogging() const;
+
 	[[nodiscard]] rpl::lifetime &lifetime();
 
 Q_SIGNALS:
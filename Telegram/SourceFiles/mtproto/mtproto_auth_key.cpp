@@ -11,7 +11,85 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <QtCore/QDataStream>
 
+#include <openssl/evp.h>
+
 namespace MTP {
+namespace {
+
+constexpr auto kAesBlockSize = std::size_t(16);
+
+// The EVP interface uses AES-NI or ARMv8 crypto extensions when the CPU
+// supports them, the low level AES_* functions are portable C only.
+// If EVP fails for any reason we fall back to AES_encrypt.
+class EcbEncryptor final {
+public:
+	explicit EcbEncryptor(const void *key)
+	: _key(static_cast<const uchar*>(key))
+	, _context(EVP_CIPHER_CTX_new()) {
+		if (!_context
+			|| EVP_EncryptInit_ex(
+				_context,
+				EVP_aes_256_ecb(),
+				nullptr,
+				_key,
+				nullptr) != 1
+			|| EVP_CIPHER_CTX_set_padding(_context, 0) != 1) {
+			useFallback();
+		}
+	}
+	EcbEncryptor(const EcbEncryptor &other) = delete;
+	EcbEncryptor &operator=(const EcbEncryptor &other) = delete;
+	~EcbEncryptor() {
+		if (_context) {
+			EVP_CIPHER_CTX_free(_context);
+		}
+	}
+
+	void process(uchar *to, const uchar *from, std::size_t size) {
+		Expects(!(size % kAesBlockSize));
+
+		if (_context) {
+			auto written = 0;
+			const auto result = EVP_EncryptUpdate(
+				_context,
+				to,
+				&written,
+				from,
+				int(size));
+			if (result == 1 && written == int(size)) {
+				return;
+			}
+			useFallback();
+		}
+		for (auto i = std::size_t(); i != size; i += kAesBlockSize) {
+			AES_encrypt(from + i, to + i, &_fallback);
+		}
+	}
+
+private:
+	void useFallback() {
+		if (_context) {
+			EVP_CIPHER_CTX_free(base::take(_context));
+		}
+		AES_set_encrypt_key(_key, 256, &_fallback);
+	}
+
+	const uchar *_key = nullptr;
+	EVP_CIPHER_CTX *_context = nullptr;
+	AES_KEY _fallback;
+
+};
+
+// Same as ctr128_inc in OpenSSL: big endian 128 bit increment.
+inline void IncrementCounter(uchar *counter) {
+	for (auto i = kAesBlockSize; i != 0;) {
+		if (++counter[--i]) {
+			return;
+		}
+	}
+}
+
+} // namespace
 
 AuthKey::AuthKey(Type type, DcId dcId, const Data &data)
 : _type(type)
@@ -169,21 +247,54 @@ void aesIgeDecryptRaw(const void *src, void *dst, uint32 len, const void *key, c
 }
 
 void aesCtrEncrypt(bytes::span data, const void *key, CTRState *state) {
-	AES_KEY aes;
-	AES_set_encrypt_key(static_cast<const uchar*>(key), 256, &aes);
-
-	static_assert(CTRState::IvecSize == AES_BLOCK_SIZE, "Wrong size of ctr ivec!");
-	static_assert(CTRState::EcountSize == AES_BLOCK_SIZE, "Wrong size of ctr ecount!");
-
-	CRYPTO_ctr128_encrypt(
-		reinterpret_cast<const uchar*>(data.data()),
-		reinterpret_cast<uchar*>(data.data()),
-		data.size(),
-		&aes,
-		state->ivec,
-		state->ecount,
-		&state->num,
-		(block128_f)AES_encrypt);
+	static_assert(CTRState::IvecSize == kAesBlockSize, "Wrong size of ctr ivec!");
+	static_assert(CTRState::EcountSize == kAesBlockSize, "Wrong size of ctr ecount!");
+
+	auto ptr = reinterpret_cast<uchar*>(data.data());
+	auto left = std::size_t(data.size());
+	auto num = state->num;
+
+	// Finish the keystream block left from the previous call.
+	while (num && left) {
+		*ptr++ ^= state->ecount[num];
+		num = uint32((num + 1) % kAesBlockSize);
+		--left;
+	}
+	if (!left) {
+		state->num = num;
+		return;
+	}
+
+	auto cipher = EcbEncryptor(key);
+
+	// Encrypt counters for many blocks in one call, so that the hardware
+	// implementation can process several blocks in parallel.
+	constexpr auto kBatchBlocks = std::size_t(64);
+	uchar counters[kBatchBlocks * kAesBlockSize];
+	uchar stream[kBatchBlocks * kAesBlockSize];
+	while (left >= kAesBlockSize) {
+		const auto blocks = std::min(left / kAesBlockSize, kBatchBlocks);
+		const auto size = blocks * kAesBlockSize;
+		for (auto i = std::size_t(); i != blocks; ++i) {
+			memcpy(counters + i * kAesBlockSize, state->ivec, kAesBlockSize);
+			IncrementCounter(state->ivec);
+		}
+		cipher.process(stream, counters, size);
+		for (auto i = std::size_t(); i != size; ++i) {
+			ptr[i] ^= stream[i];
+		}
+		ptr += size;
+		left -= size;
+	}
+	if (left) {
+		cipher.process(state->ecount, state->ivec, kAesBlockSize);
+		IncrementCounter(state->ivec);
+		for (auto i = std::size_t(); i != left; ++i) {
+			ptr[i] ^= state->ecount[i];
+		}
+		num = uint32(left);
+	}
+	state->num = num;
 }
 
 } // namespace MTP
@@ -107,6 +107,10 @@ void ConcurrentSender::RequestBuilder::setAfter(
 	_afterRequestId = requestId;
 }
 
+void ConcurrentSender::RequestBuilder::setBackground() noexcept {
+	_serialized->background = true;
+}
+
 mtpRequestId ConcurrentSender::RequestBuilder::send() {
 	const auto requestId = details::GetNextRequestId();
 	const auto dcId = _dcId;
@@ -68,6 +68,7 @@ class ConcurrentSender : public base::has_weak_ptr {
 		void setFailHandler(InvokeFullFail &&invoke) noexcept;
 		void setFailSkipPolicy(FailSkipPolicy policy) noexcept;
 		void setAfter(mtpRequestId requestId) noexcept;
+		void setBackground() noexcept;
 
 	private:
 		not_null<ConcurrentSender*> _sender;
@@ -128,6 +129,7 @@ public:
 		[[nodiscard]] SpecificRequestBuilder &handleAllErrors() noexcept;
 		[[nodiscard]] SpecificRequestBuilder &afterRequest(
 			mtpRequestId requestId) noexcept;
+		[[nodiscard]] SpecificRequestBuilder &inBackground() noexcept;
 
 	private:
 		SpecificRequestBuilder(
@@ -397,6 +399,13 @@ auto ConcurrentSender::SpecificRequestBuilder<Request>::afterRequest(
 	return *this;
 }
 
+template <typename Request>
+auto ConcurrentSender::SpecificRequestBuilder<Request>::inBackground(
+) noexcept -> SpecificRequestBuilder & {
+	setBackground();
+	return *this;
+}
+
 inline void ConcurrentSender::SentRequestWrap::cancel() {
 	_sender->senderRequestCancel(_requestId);
 }
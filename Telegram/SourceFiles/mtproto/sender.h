@@ -146,6 +146,9 @@ class Sender {
 		void setAfter(mtpRequestId requestId) noexcept {
 			_afterRequestId = requestId;
 		}
+		void setBackground() noexcept {
+			_background = true;
+		}
 
 		ShiftedDcId takeDcId() const noexcept {
 			return _dcId;
@@ -167,6 +170,9 @@ class Sender {
 		mtpRequestId takeAfter() const noexcept {
 			return _afterRequestId;
 		}
+		bool takeBackground() const noexcept {
+			return _background;
+		}
 
 		not_null<Sender*> sender() const noexcept {
 			return _sender;
@@ -187,6 +193,7 @@ class Sender {
 			FailFullHandler> _fail;
 		FailSkipPolicy _failSkipPolicy = FailSkipPolicy::Simple;
 		mtpRequestId _afterRequestId = 0;
+		bool _background = false;
 
 	};
 
@@ -287,12 +294,19 @@ public:
 			setAfter(requestId);
 			return *this;
 		}
+		[[nodiscard]] SpecificRequestBuilder &inBackground() noexcept {
+			setBackground();
+			return *this;
+		}
 
 		mtpRequestId send() {
-			const auto id = sender()->_instance->send(
-				_request,
-				takeOnDone(),
-				takeOnFail(),
+			const auto id = details::GetNextRequestId();
+			auto serialized = details::SerializedRequest::Serialize(_request);
+			serialized->background = takeBackground();
+			sender()->_instance->sendSerialized(
+				id,
+				std::move(serialized),
+				ResponseHandler{ takeOnDone(), takeOnFail() },
 				takeDcId(),
 				takeCanWait(),
 				takeAfter());
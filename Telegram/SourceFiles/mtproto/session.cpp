@@ -417,6 +417,10 @@ QString Session::transport() const {
 	return _private ? _private->transport() : QString();
 }
 
+ConnectionQuality Session::quality() const {
+	return _private ? _private->quality() : ConnectionQuality();
+}
+
 void Session::sendPrepared(
 		const SerializedRequest &request,
 		crl::time msCanWait) {
@@ -430,11 +434,20 @@ void Session::sendPrepared(
 	}
 
 	DEBUG_LOG(("MTP Info: added, requestId %1").arg(request->requestId));
-	if (msCanWait >= 0) {
-		InvokeQueued(this, [=] {
-			sendAnything(msCanWait);
-		});
+	if (msCanWait < 0) {
+		return;
+	}
+	// If sendAnything() is already queued it will be called with the
+	// smallest msCanWait of the requests added till then, so all of
+	// them are packed in as few containers as possible.
+	if (_sendPreparedCanWait >= 0) {
+		_sendPreparedCanWait = std::min(_sendPreparedCanWait, msCanWait);
+		return;
 	}
+	_sendPreparedCanWait = msCanWait;
+	InvokeQueued(this, [=] {
+		sendAnything(std::exchange(_sendPreparedCanWait, -1));
+	});
 }
 
 CreatingKeyType Session::acquireKeyCreation(DcType type) {
@@ -20,6 +20,7 @@ class Instance;
 class AuthKey;
 using AuthKeyPtr = std::shared_ptr<AuthKey>;
 enum class DcType;
+struct ConnectionQuality;
 
 namespace details {
 
@@ -175,6 +176,7 @@ public:
 	int requestState(mtpRequestId requestId) const;
 	int getState() const;
 	QString transport() const;
+	ConnectionQuality quality() const;
 
 	void tryToReceive();
 	void needToResumeAndSend();
@@ -209,6 +211,9 @@ private:
 	crl::time _msSendCall = 0;
 	crl::time _msWait = 0;
 
+	// Requests prepared in one event loop pass are sent together.
+	crl::time _sendPreparedCanWait = -1;
+
 	bool _ping = false;
 
 	base::Timer _sender;
@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/details/mtproto_bound_key_creator.h"
 #include "mtproto/details/mtproto_dcenter.h"
 #include "mtproto/details/mtproto_dump_to_text.h"
+#include "mtproto/details/mtproto_request_stats.h"
 #include "mtproto/details/mtproto_rsa_public_key.h"
 #include "mtproto/session.h"
 #include "mtproto/mtproto_response.h"
@@ -45,6 +46,12 @@ constexpr auto kKeyOldEnoughForDestroy = 60 * crl::time(1000);
 constexpr auto kSentContainerLives = 600 * crl::time(1000);
 constexpr auto kFastRequestDuration = crl::time(500);
 
+// If the smoothed ping round trip becomes this much worse than the ping
+// time of the chosen connection we race the connections again.
+constexpr auto kDegradedRoundTripMin = crl::time(1500);
+constexpr auto kDegradedRoundTripFactor = 4;
+constexpr auto kDegradedPongsToReconnect = 3;
+
 // If we can't connect for this time we will ask _instance to update config.
 constexpr auto kRequestConfigTimeout = 8 * crl::time(1000);
 
@@ -61,6 +68,11 @@ constexpr auto kSendStateRequestWaiting = crl::time(1000);
 // How much time to wait for some more requests, when sending msg acks.
 constexpr auto kAckSendWaiting = 10 * crl::time(1000);
 
+// While interactive requests are in flight background requests are sent
+// by small portions, checking the queue again after this timeout.
+constexpr auto kBackgroundSendWaiting = crl::time(100);
+constexpr auto kBackgroundBytesWhileBusy = 16 * 1024;
+
 auto SyncTimeRequestDuration = kFastRequestDuration;
 
 using namespace details;
@@ -368,7 +380,23 @@ QString SessionPrivate::transport() const {
 	}
 
 	Assert(_options != nullptr);
-	return _connection->transport();
+	const auto result = _connection->transport();
+	return (result.isEmpty() || !_smoothedRoundTrip)
+		? result
+		: (result + QString(", %1 ms").arg(_smoothedRoundTrip));
+}
+
+ConnectionQuality SessionPrivate::quality() const {
+	QReadLocker lock(&_stateMutex);
+	if (!_connection || (_state < 0)) {
+		return {};
+	}
+	return {
+		.smoothedRoundTrip = _smoothedRoundTrip,
+		.roundTripVariance = _roundTripVariance,
+		.connectedPing = _connection->pingTime(),
+		.lostPings = _lostPings,
+	};
 }
 
 bool SessionPrivate::setState(int state, int ifState) {
@@ -615,6 +643,7 @@ void SessionPrivate::tryToSend() {
 			_pingSender.callOnce(kPingSendAfterForce);
 		}
 		_pingSendAt = pingRequest->lastSentTime + kPingSendAfter;
+		_pingSentAt = crl::now();
 		_pingId = base::take(_pingIdToSend);
 	} else if (!sendAll) {
 		DEBUG_LOG(("MTP Info: dc %1 sending only service or bind."
@@ -702,16 +731,16 @@ void SessionPrivate::tryToSend() {
 	}
 
 	bool needAnyResponse = false;
+	auto backgroundLeft = false;
 	SerializedRequest toSendRequest;
 	{
 		QWriteLocker locker1(_sessionData->toSendMutex());
 
 		auto scheduleCheckSentRequests = false;
 
-		auto toSendDummy = base::flat_map<mtpRequestId, SerializedRequest>();
-		auto &toSend = sendAll
-			? _sessionData->toSendMap()
-			: toSendDummy;
+		auto toSend = sendAll
+			? takeRequestsToSend(backgroundLeft)
+			: base::flat_map<mtpRequestId, SerializedRequest>();
 		if (!sendAll) {
 			locker1.unlock();
 		}
@@ -768,6 +797,7 @@ void SessionPrivate::tryToSend() {
 
 			if (toSendRequest->requestId) {
 				if (toSendRequest.needAck()) {
+					addSentStats(toSendRequest);
 					toSendRequest->lastSentTime = crl::now();
 
 					QWriteLocker locker2(_sessionData->haveSentMutex());
@@ -875,6 +905,7 @@ void SessionPrivate::tryToSend() {
 				bool added = false;
 				if (request->requestId) {
 					if (request.needAck()) {
+						addSentStats(request);
 						request->lastSentTime = crl::now();
 						int32 reqNeedsLayer = (needsLayer && request->needsLayer) ? toSendRequest->size() : 0;
 						if (request->after) {
@@ -956,6 +987,52 @@ void SessionPrivate::tryToSend() {
 		}
 	}
 	sendSecureRequest(std::move(toSendRequest), needAnyResponse);
+	if (backgroundLeft) {
+		_sessionData->queueSendAnything(kBackgroundSendWaiting);
+	}
+}
+
+auto SessionPrivate::takeRequestsToSend(bool &backgroundLeft)
+-> base::flat_map<mtpRequestId, SerializedRequest> {
+	// toSendMutex() was locked in tryToSend()
+	auto &toSend = _sessionData->toSendMap();
+	const auto background = [](const auto &pair) {
+		return pair.second->background;
+	};
+	if (ranges::none_of(toSend, background)) {
+		return base::take(toSend);
+	}
+	const auto interactiveQueued = !ranges::all_of(toSend, background);
+	const auto interactiveInFlight = [&] {
+		QReadLocker locker(_sessionData->haveSentMutex());
+		return ranges::any_of(_sessionData->haveSentMap(), [](
+				const auto &pair) {
+			return pair.second->requestId && !pair.second->background;
+		});
+	}();
+	if (!interactiveQueued && !interactiveInFlight) {
+		return base::take(toSend);
+	}
+
+	// Interactive requests are sent in their order right away, background
+	// ones wait for them and go by small portions while the link is busy.
+	auto result = base::flat_map<mtpRequestId, SerializedRequest>();
+	auto left = base::flat_map<mtpRequestId, SerializedRequest>();
+	auto backgroundBytes = 0;
+	for (auto &[requestId, request] : toSend) {
+		if (!request->background) {
+			result.emplace(requestId, std::move(request));
+		} else if (!interactiveQueued
+			&& backgroundBytes < kBackgroundBytesWhileBusy) {
+			backgroundBytes += request.messageSize() * kIntSize;
+			result.emplace(requestId, std::move(request));
+		} else {
+			left.emplace(requestId, std::move(request));
+		}
+	}
+	toSend = std::move(left);
+	backgroundLeft = !toSend.empty();
+	return result;
 }
 
 void SessionPrivate::retryByTimer() {
@@ -1074,6 +1151,13 @@ void SessionPrivate::connectToServer(bool afterConfig) {
 
 	_bindMsgId = 0;
 	_pingId = _pingMsgId = _pingIdToSend = _pingSendAt = 0;
+	_pingSentAt = 0;
+	_degradedPongs = 0;
+	{
+		QWriteLocker lock(&_stateMutex);
+		_smoothedRoundTrip = _roundTripVariance = 0;
+		_lostPings = 0;
+	}
 	_pingSender.cancel();
 
 	_waitForConnectedTimer.callOnce(_waitForConnected);
@@ -1152,6 +1236,12 @@ void SessionPrivate::markConnectionOld() {
 
 void SessionPrivate::sendPingByTimer() {
 	if (_pingId) {
+		// The next ping is due, but the previous one wasn't answered yet.
+		{
+			QWriteLocker lock(&_stateMutex);
+			++_lostPings;
+		}
+
 		// _pingSendAt: when to send next ping (lastPingAt + kPingSendAfter)
 		// could be equal to zero.
 		const auto now = crl::now();
@@ -1200,6 +1290,57 @@ void SessionPrivate::waitReceivedFailed() {
 	});
 }
 
+void SessionPrivate::feedPingRoundTrip(crl::time roundTrip) {
+	// Same smoothing as for TCP retransmission timeout in RFC 6298.
+	auto smoothed = _smoothedRoundTrip;
+	auto variance = _roundTripVariance;
+	if (!smoothed) {
+		smoothed = roundTrip;
+		variance = roundTrip / 2;
+	} else {
+		variance = (3 * variance + std::abs(smoothed - roundTrip)) / 4;
+		smoothed = (7 * smoothed + roundTrip) / 8;
+	}
+	{
+		QWriteLocker lock(&_stateMutex);
+		_smoothedRoundTrip = smoothed;
+		_roundTripVariance = variance;
+	}
+	const auto connected = _connection ? _connection->pingTime() : 0;
+	DEBUG_LOG(("MTP Info: dc %1 ping round trip %2 ms, smoothed %3 ms, "
+		"variance %4 ms, lost pings %5, connected with %6 ms."
+		).arg(_shiftedDcId
+		).arg(roundTrip
+		).arg(smoothed
+		).arg(variance
+		).arg(_lostPings
+		).arg(connected));
+
+	const auto degraded = (connected > 0)
+		&& (smoothed > kDegradedRoundTripMin)
+		&& (smoothed > connected * kDegradedRoundTripFactor);
+	_degradedPongs = degraded ? (_degradedPongs + 1) : 0;
+	if (_degradedPongs >= kDegradedPongsToReconnect) {
+		_degradedPongs = 0;
+		InvokeQueued(this, [=] { reconnectDegraded(); });
+	}
+}
+
+void SessionPrivate::reconnectDegraded() {
+	if (!_connection || getState() != ConnectedState) {
+		return;
+	}
+	LOG(("MTP Info: dc %1 connection degraded, smoothed ping %2 ms, "
+		"looking for a better one."
+		).arg(_shiftedDcId
+		).arg(_smoothedRoundTrip));
+
+	// Sent requests are resent in the new connection,
+	// the session itself is not reset.
+	doDisconnect();
+	connectToServer();
+}
+
 void SessionPrivate::waitConnectedFailed() {
 	DEBUG_LOG(("MTP Info: can't connect in %1ms").arg(_waitForConnected));
 	auto maxTimeout = kMaxConnectedTimeout;
@@ -1269,15 +1410,16 @@ void SessionPrivate::handleReceived() {
 		constexpr auto kMinPaddingSize = 12U;
 		constexpr auto kMaxPaddingSize = 1024U;
 
-		auto encryptedInts = ints + kExternalHeaderIntsCount;
 		auto encryptedIntsCount = (intsCount - kExternalHeaderIntsCount) & ~0x03U;
 		auto encryptedBytesCount = encryptedIntsCount * kIntSize;
-		auto decryptedBuffer = QByteArray(encryptedBytesCount, Qt::Uninitialized);
 		auto msgKey = *(MTPint128*)(ints + 2);
 
-		aesIgeDecrypt(encryptedInts, decryptedBuffer.data(), encryptedBytesCount, _encryptionKey, msgKey);
+		// Decrypt in place, the parsing below works with views into
+		// the received buffer and copies only the parts that are kept.
+		const auto decrypted = intsBuffer.data() + kExternalHeaderIntsCount;
+		aesIgeDecrypt(decrypted, decrypted, encryptedBytesCount, _encryptionKey, msgKey);
 
-		auto decryptedInts = reinterpret_cast<const mtpPrime*>(decryptedBuffer.constData());
+		auto decryptedInts = static_cast<const mtpPrime*>(decrypted);
 		auto serverSalt = *(uint64*)&decryptedInts[0];
 		auto session = *(uint64*)&decryptedInts[2];
 		auto msgId = *(uint64*)&decryptedInts[4];
@@ -1300,7 +1442,7 @@ void SessionPrivate::handleReceived() {
 		constexpr auto kMsgKeyShift = 8U;
 		if (ConstTimeIsDifferent(&msgKey, sha256Buffer.data() + kMsgKeyShift, sizeof(msgKey))) {
 			LOG(("TCP Error: bad SHA256 hash after aesDecrypt in message"));
-			TCP_LOG(("TCP Error: bad message %1").arg(Logs::mb(encryptedInts, encryptedBytesCount).str()));
+			TCP_LOG(("TCP Error: bad decrypted message %1").arg(Logs::mb(decryptedInts, encryptedBytesCount).str()));
 
 			return restart();
 		}
@@ -1310,7 +1452,7 @@ void SessionPrivate::handleReceived() {
 			|| (paddingSize < kMinPaddingSize)
 			|| (paddingSize > kMaxPaddingSize)) {
 			LOG(("TCP Error: bad msg_len received %1, data size: %2").arg(messageLength).arg(encryptedBytesCount));
-			TCP_LOG(("TCP Error: bad message %1").arg(Logs::mb(encryptedInts, encryptedBytesCount).str()));
+			TCP_LOG(("TCP Error: bad decrypted message %1").arg(Logs::mb(decryptedInts, encryptedBytesCount).str()));
 
 			return restart();
 		}
@@ -1820,6 +1962,7 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 		} else {
 			_sessionData->notifyConnectionInited(*_options);
 		}
+		addReceivedStats(requestMsgId, response);
 		requestsAcked(ids, true);
 
 		const auto bindResult = handleBindResponse(requestMsgId, response);
@@ -1884,7 +2027,7 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 		// Notify main process about new session - need to get difference.
 		QWriteLocker locker(_sessionData->haveReceivedMutex());
 		_sessionData->haveReceivedMessages().push_back({
-			.reply = update,
+			.reply = std::move(update),
 			.outerMsgId = info.outerMsgId,
 		});
 	} return HandleResult::Success;
@@ -1903,6 +2046,7 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 		}
 		if (data.vping_id().v == _pingId) {
 			_pingId = 0;
+			feedPingRoundTrip(crl::now() - _pingSentAt);
 		} else {
 			DEBUG_LOG(("Message Info: just pong..."));
 		}
@@ -1934,7 +2078,7 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 		// Notify main process about the new updates.
 		QWriteLocker locker(_sessionData->haveReceivedMutex());
 		_sessionData->haveReceivedMessages().push_back({
-			.reply = update,
+			.reply = std::move(update),
 			.outerMsgId = info.outerMsgId,
 		});
 	} else {
@@ -2658,6 +2802,41 @@ bool SessionPrivate::sendSecureRequest(
 	return true;
 }
 
+void SessionPrivate::addSentStats(const SerializedRequest &request) {
+	if (request->statsSent) {
+		_instance->requestStats().resent(
+			_shiftedDcId,
+			RequestMethod(request));
+		return;
+	}
+	request->statsSent = true;
+	_instance->requestStats().sent(
+		_shiftedDcId,
+		RequestMethod(request),
+		RequestBodyBytes(request),
+		crl::now() - request->lastSentTime);
+}
+
+void SessionPrivate::addReceivedStats(
+		mtpMsgId requestMsgId,
+		const mtpBuffer &response) {
+	auto request = SerializedRequest();
+	{
+		QReadLocker locker(_sessionData->haveSentMutex());
+		const auto &haveSent = _sessionData->haveSentMap();
+		const auto i = haveSent.find(requestMsgId);
+		if (i == haveSent.end() || !i->second->requestId) {
+			return;
+		}
+		request = i->second;
+	}
+	_instance->requestStats().received(
+		_shiftedDcId,
+		RequestMethod(request),
+		int(response.size() * sizeof(mtpPrime)),
+		crl::now() - request->lastSentTime);
+}
+
 mtpRequestId SessionPrivate::wasSent(mtpMsgId msgId) const {
 	if (msgId == _pingMsgId || msgId == _bindMsgId) {
 		return mtpRequestId(0xFFFFFFFF);
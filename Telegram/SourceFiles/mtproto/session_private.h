@@ -44,6 +44,7 @@ public:
 
 	[[nodiscard]] int32 getState() const;
 	[[nodiscard]] QString transport() const;
+	[[nodiscard]] ConnectionQuality quality() const;
 
 	void updateAuthKey();
 	void restartNow();
@@ -89,6 +90,8 @@ private:
 	void retryByTimer();
 	void waitConnectedFailed();
 	void waitReceivedFailed();
+	void reconnectDegraded();
+	void feedPingRoundTrip(crl::time roundTrip);
 	void waitBetterFailed();
 	void markConnectionOld();
 	void sendPingByTimer();
@@ -118,6 +121,8 @@ private:
 		SerializedRequest &&request,
 		bool needAnyResponse);
 	mtpRequestId wasSent(mtpMsgId msgId) const;
+	void addSentStats(const SerializedRequest &request);
+	void addReceivedStats(mtpMsgId requestMsgId, const mtpBuffer &response);
 
 	struct OuterInfo {
 		mtpMsgId outerMsgId = 0;
@@ -175,6 +180,8 @@ private:
 	void setCurrentKeyId(uint64 newKeyId);
 	void changeSessionId();
 	[[nodiscard]] bool markSessionAsStarted();
+	[[nodiscard]] auto takeRequestsToSend(bool &backgroundLeft)
+		-> base::flat_map<mtpRequestId, SerializedRequest>;
 	[[nodiscard]] uint32 nextRequestSeqNumber(bool needAck);
 
 	[[nodiscard]] bool realDcTypeChanged();
@@ -213,6 +220,14 @@ private:
 	crl::time _pingSendAt = 0;
 	mtpMsgId _pingMsgId = 0;
 	base::Timer _pingSender;
+
+	// Connection quality, measured by the ping round trips.
+	crl::time _pingSentAt = 0;
+	// Written with _stateMutex locked, read by quality() from main thread.
+	crl::time _smoothedRoundTrip = 0;
+	crl::time _roundTripVariance = 0;
+	int _lostPings = 0;
+	int _degradedPongs = 0;
 	base::Timer _checkSentRequestsTimer;
 	base::Timer _clearOldContainersTimer;
 
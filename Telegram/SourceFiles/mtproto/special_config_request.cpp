@@ -23,6 +23,10 @@ namespace {
 
 constexpr auto kSendNextTimeout = crl::time(800);
 
+// Both Google endpoints are asked at once together with one of Cloudflare
+// and the Firebase remote config, the constructor shuffles those two.
+constexpr auto kParallelRequests = 3;
+
 constexpr auto kPublicKey = "\
 -----BEGIN RSA PUBLIC KEY-----\n\
 MIIBCgKCAQEAyr+18Rex2ohtVy8sroGPBwXD3DOoKCSpjDqYoXgCqB7ioln4eDCF\n\
@@ -243,7 +247,7 @@ SpecialConfigRequest::SpecialConfigRequest(
 	}
 	ranges::reverse(_attempts); // We go from last to first.
 
-	sendNextRequest();
+	sendNextRequest(kParallelRequests);
 }
 
 SpecialConfigRequest::SpecialConfigRequest(
@@ -267,17 +271,19 @@ SpecialConfigRequest::SpecialConfigRequest(
 	QString()) {
 }
 
-void SpecialConfigRequest::sendNextRequest() {
+void SpecialConfigRequest::sendNextRequest(int count) {
 	Expects(!_attempts.empty());
 
-	const auto attempt = _attempts.back();
-	_attempts.pop_back();
+	while (count-- > 0 && !_attempts.empty()) {
+		const auto attempt = _attempts.back();
+		_attempts.pop_back();
+		performRequest(attempt);
+	}
 	if (!_attempts.empty()) {
 		base::call_delayed(kSendNextTimeout, this, [=] {
-			sendNextRequest();
+			sendNextRequest(1);
 		});
 	}
-	performRequest(attempt);
 }
 
 void SpecialConfigRequest::performRequest(const Attempt &attempt) {
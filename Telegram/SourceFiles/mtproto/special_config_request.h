@@ -55,7 +55,7 @@ private:
 		const QString &domainString,
 		const QString &phone);
 
-	void sendNextRequest();
+	void sendNextRequest(int count);
 	void performRequest(const Attempt &attempt);
 	void requestFinished(Type type, not_null<QNetworkReply*> reply);
 	void handleHeaderUnixtime(not_null<QNetworkReply*> reply);
@@ -66,6 +66,95 @@ constexpr auto kMaxInlineArea = 1280 * 720;
 	return dimensions.width() * dimensions.height() <= kMaxInlineArea;
 }
 
+[[nodiscard]] QImage PrepareGridThumbnail(
+		QImage original,
+		int size,
+		bool blur) {
+	auto img = blur ? Images::prepareBlur(std::move(original)) : original;
+	if (img.width() == img.height()) {
+		if (img.width() != size) {
+			img = img.scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+		}
+	} else if (img.width() > img.height()) {
+		img = img.copy((img.width() - img.height()) / 2, 0, img.height(), img.height()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+	} else {
+		img = img.copy(0, (img.height() - img.width()) / 2, img.width(), img.width()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+	}
+	return img;
+}
+
+// Scaling a large thumbnail to the grid cell size takes a while,
+// the cell keeps painting the previous pixmap until it is ready.
+void PrepareGridThumbnailAsync(
+		not_null<ItemBase*> item,
+		QImage original,
+		int size,
+		bool blur,
+		Fn<void(QImage)> done) {
+	const auto weak = base::make_weak(item.get());
+	const auto ratio = cRetinaFactor();
+	crl::async([=] {
+		auto result = PrepareGridThumbnail(original, size, blur);
+		result.setDevicePixelRatio(ratio);
+		crl::on_main(weak, [=] {
+			done(result);
+		});
+	});
+}
+
+void PaintGridThumbnail(
+		Painter &p,
+		const QPixmap &pix,
+		int width,
+		int height) {
+	if (pix.isNull()) {
+		p.fillRect(0, 0, width, height, st::overviewPhotoBg);
+	} else if (pix.width() != width * cIntRetinaFactor()) {
+		PainterHighQualityEnabler hq(p);
+		p.drawPixmap(QRect(0, 0, width, height), pix);
+	} else {
+		p.drawPixmap(0, 0, pix);
+	}
+}
+
+void PaintSongWaveform(
+		Painter &p,
+		const SongData *song,
+		QRect rect,
+		const style::color &color) {
+	if (!song
+		|| song->waveform.isEmpty()
+		|| song->waveform[0] < 0) {
+		return;
+	}
+	const auto &waveform = song->waveform;
+	const auto &barWidth = st::msgWaveformBar;
+	const auto barCount = std::min(
+		rect.width() / (barWidth + st::msgWaveformSkip),
+		int(waveform.size()));
+	if (barCount <= 0) {
+		return;
+	}
+	const auto norm = song->wavemax + 1;
+	const auto maxDelta = rect.height() - st::msgWaveformMin;
+	const auto bottom = rect.y() + rect.height();
+	for (auto i = 0; i != barCount; ++i) {
+		const auto from = i * int(waveform.size()) / barCount;
+		const auto till = (i + 1) * int(waveform.size()) / barCount;
+		const auto value = *std::max_element(
+			waveform.begin() + from,
+			waveform.begin() + std::max(till, from + 1));
+		const auto barValue = ((value * maxDelta) + (norm / 2)) / norm;
+		const auto barHeight = st::msgWaveformMin + barValue;
+		p.fillRect(
+			rect.x() + i * (barWidth + st::msgWaveformSkip),
+			bottom - barHeight,
+			barWidth,
+			barHeight,
+			color);
+	}
+}
+
 
 } // namespace
 
@@ -317,32 +406,31 @@ int32 Photo::resizeGetHeight(int32 width) {
 
 void Photo::paint(Painter &p, const QRect &clip, TextSelection selection, const PaintContext *context) {
 	const auto selected = (selection == FullSelection);
-	const auto widthChanged = _pix.width() != _width * cIntRetinaFactor();
+	const auto widthChanged = (_pixSize != _width * cIntRetinaFactor());
 	if (!_goodLoaded || widthChanged) {
 		ensureDataMediaCreated();
 		const auto good = _dataMedia->loaded()
 			|| (_dataMedia->image(Data::PhotoSize::Thumbnail) != nullptr);
 		if ((good && !_goodLoaded) || widthChanged) {
 			_goodLoaded = good;
-			_pix = QPixmap();
-			if (_goodLoaded) {
-				setPixFrom(_dataMedia->image(Data::PhotoSize::Large)
+			const auto image = _goodLoaded
+				? (_dataMedia->image(Data::PhotoSize::Large)
 					? _dataMedia->image(Data::PhotoSize::Large)
-					: _dataMedia->image(Data::PhotoSize::Thumbnail));
-			} else if (const auto small = _dataMedia->image(
-					Data::PhotoSize::Small)) {
-				setPixFrom(small);
-			} else if (const auto blurred = _dataMedia->thumbnailInline()) {
-				setPixFrom(blurred);
+					: _dataMedia->image(Data::PhotoSize::Thumbnail))
+				: _dataMedia->image(Data::PhotoSize::Small)
+				? _dataMedia->image(Data::PhotoSize::Small)
+				: _dataMedia->thumbnailInline();
+
+			// Without any image try again when painting next time.
+			if (image) {
+				_pixSize = _width * cIntRetinaFactor();
+				++_pixRequest;
+				setPixFrom(image);
 			}
 		}
 	}
 
-	if (_pix.isNull()) {
-		p.fillRect(0, 0, _width, _height, st::overviewPhotoBg);
-	} else {
-		p.drawPixmap(0, 0, _pix);
-	}
+	PaintGridThumbnail(p, _pix, _width, _height);
 
 	if (selected) {
 		p.fillRect(0, 0, _width, _height, st::overviewPhotoSelectOverlay);
@@ -354,21 +442,19 @@ void Photo::paint(Painter &p, const QRect &clip, TextSelection selection, const
 }
 
 void Photo::setPixFrom(not_null<Image*> image) {
-	const auto size = _width * cIntRetinaFactor();
-	auto img = image->original();
-	if (!_goodLoaded) {
-		img = Images::prepareBlur(std::move(img));
-	}
-	if (img.width() == img.height()) {
-		if (img.width() != size) {
-			img = img.scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-		}
-	} else if (img.width() > img.height()) {
-		img = img.copy((img.width() - img.height()) / 2, 0, img.height(), img.height()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-	} else {
-		img = img.copy(0, (img.height() - img.width()) / 2, img.width(), img.width()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-	}
-	img.setDevicePixelRatio(cRetinaFactor());
+	const auto request = _pixRequest;
+	PrepareGridThumbnailAsync(
+		this,
+		image->original(),
+		_pixSize,
+		!_goodLoaded,
+		[=](QImage result) {
+			if (_pixRequest != request) {
+				return;
+			}
+			_pix = Ui::PixmapFromImage(std::move(result));
+			delegate()->repaintItem(this);
+		});
 
 	// In case we have inline thumbnail we can unload all images and we still
 	// won't get a blank image in the media viewer when the photo is opened.
@@ -376,8 +462,6 @@ void Photo::setPixFrom(not_null<Image*> image) {
 		_dataMedia = nullptr;
 		delegate()->unregisterHeavyItem(this);
 	}
-
-	_pix = Ui::PixmapFromImage(std::move(img));
 }
 
 void Photo::ensureDataMediaCreated() const {
@@ -449,34 +533,30 @@ void Video::paint(Painter &p, const QRect &clip, TextSelection selection, const
 	const auto radialOpacity = radial ? _radial->opacity() : 0.;
 
 	if ((blurred || thumbnail || good)
-		&& ((_pix.width() != _width * cIntRetinaFactor())
+		&& ((_pixSize != _width * cIntRetinaFactor())
 			|| (_pixBlurred && (thumbnail || good)))) {
-		auto size = _width * cIntRetinaFactor();
-		auto img = good
-			? good->original()
-			: thumbnail
-			? thumbnail->original()
-			: Images::prepareBlur(blurred->original());
-		if (img.width() == img.height()) {
-			if (img.width() != size) {
-				img = img.scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-			}
-		} else if (img.width() > img.height()) {
-			img = img.copy((img.width() - img.height()) / 2, 0, img.height(), img.height()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-		} else {
-			img = img.copy(0, (img.height() - img.width()) / 2, img.width(), img.width()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-		}
-		img.setDevicePixelRatio(cRetinaFactor());
-
-		_pix = Ui::PixmapFromImage(std::move(img));
+		_pixSize = _width * cIntRetinaFactor();
 		_pixBlurred = !(thumbnail || good);
+		const auto request = ++_pixRequest;
+		PrepareGridThumbnailAsync(
+			this,
+			(good
+				? good->original()
+				: thumbnail
+				? thumbnail->original()
+				: blurred->original()),
+			_pixSize,
+			_pixBlurred,
+			[=](QImage result) {
+				if (_pixRequest != request) {
+					return;
+				}
+				_pix = Ui::PixmapFromImage(std::move(result));
+				delegate()->repaintItem(this);
+			});
 	}
 
-	if (_pix.isNull()) {
-		p.fillRect(0, 0, _width, _height, st::overviewPhotoBg);
-	} else {
-		p.drawPixmap(0, 0, _pix);
-	}
+	PaintGridThumbnail(p, _pix, _width, _height);
 
 	if (selected) {
 		p.fillRect(QRect(0, 0, _width, _height), st::overviewPhotoSelectOverlay);
@@ -1008,6 +1088,12 @@ void Document::paint(Painter &p, const QRect &clip, TextSelection selection, con
 
 	const auto isSong = _data->isSong();
 	if (isSong) {
+		if (const auto song = _data->song()) {
+			// Songs are counted only when played, see Player::Instance.
+			if (song->waveform.isEmpty()) {
+				Local::loadCachedWaveform(_data);
+			}
+		}
 		nameleft = _st.songPadding.left() + _st.songThumbSize + _st.songPadding.right();
 		nameright = _st.songPadding.left();
 		nametop = _st.songNameTop;
@@ -1179,6 +1265,28 @@ void Document::paint(Painter &p, const QRect &clip, TextSelection selection, con
 		p.setFont(st::normalFont);
 		p.setPen((isSong && selected) ? st::mediaInFgSelected : st::mediaInFg);
 		p.drawTextLeft(nameleft, statustop, _width, _status.text());
+
+		if (isSong) {
+			const auto statusWidth = st::normalFont->width(_status.text());
+			const auto waveformLeft = nameleft
+				+ statusWidth
+				+ st::overviewSongWaveformSkip;
+			const auto waveformWidth = std::min(
+				st::overviewSongWaveformWidth,
+				nameleft + availwidth - waveformLeft);
+			if (waveformWidth > 0) {
+				PaintSongWaveform(
+					p,
+					_data->song(),
+					style::rtlrect(
+						waveformLeft,
+						statustop,
+						waveformWidth,
+						st::normalFont->height,
+						_width),
+					selected ? st::mediaInFgSelected : st::mediaInFg);
+			}
+		}
 	}
 	if (datetop >= 0 && clip.intersects(style::rtlrect(nameleft, datetop, _datew, st::normalFont->height, _width))) {
 		p.setFont(ClickHandler::showAsActive(_msgl) ? st::normalFont->underline() : st::normalFont);
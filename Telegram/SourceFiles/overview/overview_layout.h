@@ -194,6 +194,8 @@ private:
 	ClickHandlerPtr _link;
 
 	QPixmap _pix;
+	int _pixSize = 0;
+	int _pixRequest = 0;
 	bool _goodLoaded = false;
 
 };
@@ -289,6 +291,8 @@ private:
 
 	QString _duration;
 	QPixmap _pix;
+	int _pixSize = 0;
+	int _pixRequest = 0;
 	bool _pixBlurred = true;
 
 };
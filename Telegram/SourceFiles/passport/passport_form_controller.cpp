@@ -1819,17 +1819,39 @@ void FormController::loadFile(File &file) {
 }
 
 void FormController::fileLoadDone(FileKey key, const QByteArray &bytes) {
-	if (const auto [value, file] = findFile(key); file != nullptr) {
+	const auto [value, file] = findFile(key);
+	if (!file) {
+		return;
+	}
+	// Several scans are usually loaded together, decrypt them on workers.
+	crl::async([
+		=,
+		weak = base::make_weak(this),
+		hash = file->hash,
+		secret = file->secret
+	] {
 		const auto decrypted = DecryptData(
 			bytes::make_span(bytes),
-			file->hash,
-			file->secret);
-		if (decrypted.empty()) {
-			fileLoadFail(key);
-			return;
-		}
+			hash,
+			secret);
+		const auto failed = decrypted.empty();
+		auto image = failed
+			? QImage()
+			: ReadImage(gsl::make_span(decrypted));
+		crl::on_main(weak, [=, image = std::move(image)]() mutable {
+			if (failed) {
+				fileLoadFail(key);
+			} else {
+				fileDecrypted(key, std::move(image));
+			}
+		});
+	});
+}
+
+void FormController::fileDecrypted(FileKey key, QImage &&image) {
+	if (const auto [value, file] = findFile(key); file != nullptr) {
 		file->downloadStatus.set(LoadStatus::Status::Done);
-		file->image = ReadImage(gsl::make_span(decrypted));
+		file->image = std::move(image);
 		if (const auto fileInEdit = findEditFile(key)) {
 			fileInEdit->fields.image = file->image;
 			fileInEdit->fields.downloadStatus = file->downloadStatus;
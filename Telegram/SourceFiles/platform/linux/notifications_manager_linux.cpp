@@ -35,6 +35,7 @@ constexpr auto kService = "org.freedesktop.Notifications"_cs;
 constexpr auto kObjectPath = "/org/freedesktop/Notifications"_cs;
 constexpr auto kInterface = kService;
 constexpr auto kPropertiesInterface = "org.freedesktop.DBus.Properties"_cs;
+constexpr auto kImageDataCacheSize = 16;
 
 using namespace base::Platform;
 
@@ -394,6 +395,31 @@ Glib::ustring GetImageKey(const QVersionNumber &specificationVersion) {
 	return "icon_data";
 }
 
+Glib::VariantBase PrepareImageData(const QString &imagePath) {
+	if (imagePath.isEmpty()) {
+		return {};
+	}
+
+	const auto image = QImage(imagePath)
+		.convertToFormat(QImage::Format_RGBA8888);
+
+	if (image.isNull()) {
+		return {};
+	}
+
+	return MakeGlibVariant(std::tuple{
+		image.width(),
+		image.height(),
+		int(image.bytesPerLine()),
+		true,
+		8,
+		4,
+		std::vector<uchar>(
+			image.constBits(),
+			image.constBits() + image.sizeInBytes()),
+	});
+}
+
 class NotificationData final : public base::has_weak_ptr {
 public:
 	using NotificationId = Window::Notifications::Manager::NotificationId;
@@ -417,7 +443,7 @@ public:
 
 	void show();
 	void close();
-	void setImage(const QString &imagePath);
+	void setImage(const Glib::VariantBase &imageData);
 
 private:
 	const not_null<Manager*> _manager;
@@ -669,29 +695,12 @@ void NotificationData::close() {
 	_manager->clearNotification(_id);
 }
 
-void NotificationData::setImage(const QString &imagePath) {
-	if (imagePath.isEmpty() || _imageKey.empty()) {
-		return;
-	}
-
-	const auto image = QImage(imagePath)
-		.convertToFormat(QImage::Format_RGBA8888);
-
-	if (image.isNull()) {
+void NotificationData::setImage(const Glib::VariantBase &imageData) {
+	if (!imageData || _imageKey.empty()) {
 		return;
 	}
 
-	_hints[_imageKey] = MakeGlibVariant(std::tuple{
-		image.width(),
-		image.height(),
-		int(image.bytesPerLine()),
-		true,
-		8,
-		4,
-		std::vector<uchar>(
-			image.constBits(),
-			image.constBits() + image.sizeInBytes()),
-	});
+	_hints[_imageKey] = imageData;
 }
 
 void NotificationData::notificationClosed(uint id, uint reason) {
@@ -837,6 +846,10 @@ public:
 	~Private();
 
 private:
+	[[nodiscard]] Glib::VariantBase imageData(
+		not_null<PeerData*> peer,
+		std::shared_ptr<Data::CloudImageView> &userpicView);
+
 	const not_null<Manager*> _manager;
 
 	base::flat_map<
@@ -845,6 +858,9 @@ private:
 
 	Window::Notifications::CachedUserpics _cachedUserpics;
 
+	// Decoded userpics are big, keep them ready for the next notification.
+	base::flat_map<InMemoryKey, Glib::VariantBase> _imageData;
+
 };
 
 Manager::Private::Private(not_null<Manager*> manager, Type type)
@@ -907,9 +923,7 @@ void Manager::Private::showNotification(
 	}
 
 	if (!options.hideNameAndPhoto) {
-		const auto userpicKey = peer->userpicUniqueKey(userpicView);
-		notification->setImage(
-			_cachedUserpics.get(userpicKey, peer, userpicView));
+		notification->setImage(imageData(peer, userpicView));
 	}
 
 	auto i = _notifications.find(key);
@@ -933,6 +947,25 @@ void Manager::Private::showNotification(
 	j->second->show();
 }
 
+Glib::VariantBase Manager::Private::imageData(
+		not_null<PeerData*> peer,
+		std::shared_ptr<Data::CloudImageView> &userpicView) {
+	const auto userpicKey = peer->userpicUniqueKey(userpicView);
+	const auto i = _imageData.find(userpicKey);
+	if (i != end(_imageData)) {
+		return i->second;
+	}
+	auto result = PrepareImageData(
+		_cachedUserpics.get(userpicKey, peer, userpicView));
+	if (result) {
+		if (_imageData.size() >= kImageDataCacheSize) {
+			_imageData.clear();
+		}
+		_imageData.emplace(userpicKey, result);
+	}
+	return result;
+}
+
 void Manager::Private::clearAll() {
 	if (!Supported()) {
 		return;
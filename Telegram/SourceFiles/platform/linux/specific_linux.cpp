@@ -612,6 +612,91 @@ bool SkipTaskbarSupported() {
 	return false;
 }
 
+QString AllocatorStats(bool detailed) {
+	// jemalloc refreshes the statistics only when the epoch is written.
+	auto epoch = uint64(1);
+	auto epochSize = sizeof(epoch);
+	if (mallctl("epoch", &epoch, &epochSize, &epoch, epochSize) != 0) {
+		return QString();
+	}
+	const auto read = [](const QByteArray &name, auto &result) {
+		auto size = sizeof(result);
+		return !mallctl(name.constData(), &result, &size, nullptr, 0);
+	};
+	const auto bytes = [&](const QByteArray &name) {
+		auto result = size_t();
+		return read(name, result) ? int64(result) : int64(-1);
+	};
+	const auto mb = [](int64 value) {
+		return QString::number(value / (1024. * 1024.), 'f', 1) + " MB";
+	};
+
+	auto result = QStringList();
+	result.push_back(u"jemalloc: allocated %1, active %2, resident %3, "
+		"mapped %4, retained %5"_q
+		.arg(mb(bytes("stats.allocated")))
+		.arg(mb(bytes("stats.active")))
+		.arg(mb(bytes("stats.resident")))
+		.arg(mb(bytes("stats.mapped")))
+		.arg(mb(bytes("stats.retained"))));
+	if (!detailed) {
+		return result.join('\n');
+	}
+
+	auto arenas = 0U;
+	if (read("arenas.narenas", arenas)) {
+		for (auto i = 0U; i != arenas; ++i) {
+			const auto index = QByteArray::number(i);
+			auto initialized = false;
+			if (!read("arena." + index + ".initialized", initialized)
+				|| !initialized) {
+				continue;
+			}
+			const auto prefix = "stats.arenas." + index + '.';
+			result.push_back(u"arena %1: small %2, large %3, resident %4"_q
+				.arg(i)
+				.arg(mb(bytes(prefix + "small.allocated")))
+				.arg(mb(bytes(prefix + "large.allocated")))
+				.arg(mb(bytes(prefix + "resident"))));
+		}
+	}
+
+#ifdef MALLCTL_ARENAS_ALL
+	const auto all = "stats.arenas."
+		+ QByteArray::number(MALLCTL_ARENAS_ALL)
+		+ '.';
+	const auto sizeClasses = [&](
+			const QByteArray &count,
+			const QByteArray &sizePrefix,
+			const QByteArray &usedPrefix,
+			const QByteArray &usedSuffix) {
+		auto classes = 0U;
+		if (!read(count, classes)) {
+			return;
+		}
+		for (auto i = 0U; i != classes; ++i) {
+			const auto index = QByteArray::number(i);
+			const auto size = bytes(sizePrefix + index + ".size");
+			const auto used = bytes(all + usedPrefix + index + usedSuffix);
+			if (size > 0 && used > 0) {
+				result.push_back(u"size %1: %2 used, %3"_q
+					.arg(size)
+					.arg(used)
+					.arg(mb(size * used)));
+			}
+		}
+	};
+	sizeClasses("arenas.nbins", "arenas.bin.", "bins.", ".curregs");
+	sizeClasses(
+		"arenas.nlextents",
+		"arenas.lextent.",
+		"lextents.",
+		".curlextents");
+#endif // MALLCTL_ARENAS_ALL
+
+	return result.join('\n');
+}
+
 } // namespace Platform
 
 void psActivateProcess(uint64 pid) {
@@ -706,6 +791,23 @@ void start() {
 	qputenv("PULSE_PROP_application.name", AppName.utf8());
 	qputenv("PULSE_PROP_application.icon_name", GetIconName().toLatin1());
 
+	// The audio servers read these when any stream of the process
+	// connects, so they apply to the media player as well, not only to
+	// calls. They are set once here, because the webrtc audio module opens
+	// its devices on its own thread and changing the environment while
+	// other threads run is not safe.
+	if (const auto latency = cAudioLatency()) {
+		if (!qEnvironmentVariableIsSet("PULSE_LATENCY_MSEC")) {
+			qputenv("PULSE_LATENCY_MSEC", QByteArray::number(latency));
+		}
+		if (!qEnvironmentVariableIsSet("PIPEWIRE_LATENCY")) {
+			qputenv(
+				"PIPEWIRE_LATENCY",
+				QByteArray::number(latency * 48) + "/48000");
+		}
+		LOG(("Audio Info: Requested %1 ms latency.").arg(latency));
+	}
+
 #ifndef DESKTOP_APP_DISABLE_DBUS_INTEGRATION
 	Glib::init();
 	Gio::init();
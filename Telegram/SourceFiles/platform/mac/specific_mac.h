@@ -33,6 +33,10 @@ inline bool SkipTaskbarSupported() {
 	return false;
 }
 
+inline QString AllocatorStats(bool detailed) {
+	return QString();
+}
+
 namespace ThirdParty {
 
 inline void start() {
@@ -42,6 +42,9 @@ bool TrayIconSupported();
 bool SkipTaskbarSupported();
 void WriteCrashDumpDetails();
 
+// Empty if the allocator can't report its statistics.
+[[nodiscard]] QString AllocatorStats(bool detailed);
+
 [[nodiscard]] std::optional<bool> IsDarkMode();
 [[nodiscard]] inline bool IsDarkModeSupported() {
 	return IsDarkMode().has_value();
@@ -27,6 +27,10 @@ inline bool SkipTaskbarSupported() {
 	return true;
 }
 
+inline QString AllocatorStats(bool detailed) {
+	return QString();
+}
+
 namespace ThirdParty {
 
 void start();
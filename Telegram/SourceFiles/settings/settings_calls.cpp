@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "settings/settings_calls.h"
 
 #include "kotato/kotato_lang.h"
+#include "kotato/json_settings.h"
 #include "settings/settings_common.h"
 #include "ui/wrap/vertical_layout.h"
 #include "ui/wrap/slide_wrap.h"
@@ -17,6 +18,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/widgets/buttons.h"
 #include "ui/boxes/single_choice_box.h"
 #include "ui/boxes/confirm_box.h"
+#include "ui/layers/generic_box.h"
 #include "platform/platform_specific.h"
 #include "main/main_session.h"
 #include "lang/lang_keys.h"
@@ -26,6 +28,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/application.h"
 #include "core/core_settings.h"
 #include "calls/calls_call.h"
+#include "calls/calls_call_stats.h"
 #include "calls/calls_instance.h"
 #include "calls/calls_video_bubble.h"
 #include "apiwrap.h"
@@ -286,6 +289,30 @@ void Calls::setupContent() {
 		api->authorizations().toggleCallsDisabledHere(!value);
 	}, content->lifetime());
 
+	AddButton(
+		content,
+		rktr("ktg_settings_call_record_stats"),
+		st::settingsButton
+	)->toggleOn(
+		rpl::single(cRecordCallStats())
+	)->toggledChanges(
+	) | rpl::filter([](bool enabled) {
+		return (enabled != cRecordCallStats());
+	}) | rpl::start_with_next([](bool enabled) {
+		cSetRecordCallStats(enabled);
+		::Kotato::JsonSettings::Write();
+	}, content->lifetime());
+
+	AddButton(
+		content,
+		rktr("ktg_settings_call_show_stats"),
+		st::settingsButton
+	)->addClickHandler([=] {
+		_controller->show(Box(
+			::Calls::CallStatsBox,
+			::Calls::ReadCallStats(::Calls::LastCallStatsPath())));
+	});
+
 	AddButton(
 		content,
 		tr::lng_settings_call_open_system_prefs(),
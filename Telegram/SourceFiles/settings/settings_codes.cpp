@@ -24,14 +24,19 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/application.h"
 #include "mtproto/mtp_instance.h"
 #include "mtproto/mtproto_dc_options.h"
+#include "mtproto/details/mtproto_request_stats.h"
 #include "core/file_utilities.h"
 #include "core/update_checker.h"
+#include "core/memory_stats.h"
+#include "core/paint_profiler.h"
+#include "core/rpl_profiler.h"
 #include "window/themes/window_theme.h"
 #include "window/themes/window_theme_editor.h"
 #include "window/window_session_controller.h"
 #include "media/audio/media_audio_track.h"
 #include "settings/settings_common.h"
 #include "api/api_updates.h"
+#include "api/api_updates_replay.h"
 #include "base/qt_adapters.h"
 
 #include "zlib.h"
@@ -86,6 +91,73 @@ auto GenerateCodes() {
 	codes.emplace(qsl("viewlogs"), [](SessionController *window) {
 		File::ShowInFolder(cWorkingDir() + "log.txt");
 	});
+	codes.emplace(qsl("paintprofiler"), [](SessionController *window) {
+		const auto enabled = !Core::PaintProfiler::Enabled();
+		Core::PaintProfiler::SetEnabled(enabled);
+		if (enabled && window) {
+			Core::PaintProfiler::ShowOverlay(window->widget());
+		}
+		Ui::Toast::Show(enabled
+			? "Paint profiler enabled."
+			: "Paint profiler disabled.");
+	});
+	codes.emplace(qsl("paintprofile"), [](SessionController *window) {
+		const auto path = cWorkingDir() + "paint_profile.txt";
+		if (Core::PaintProfiler::DumpToFile(path)) {
+			File::ShowInFolder(path);
+		} else {
+			Ui::Toast::Show("Could not write paint profile :(");
+		}
+	});
+	codes.emplace(qsl("memorystats"), [](SessionController *window) {
+		const auto path = cWorkingDir() + "memory_stats.txt";
+		if (Core::MemoryStats::DumpToFile(path)) {
+			File::ShowInFolder(path);
+		} else {
+			Ui::Toast::Show("Could not write memory stats :(");
+		}
+	});
+	codes.emplace(qsl("memorylog"), [](SessionController *window) {
+		const auto enabled = !Core::MemoryStats::Logging();
+		Core::MemoryStats::SetLogging(enabled);
+		Ui::Toast::Show(enabled
+			? "Memory stats logging enabled."
+			: "Memory stats logging disabled.");
+	});
+	codes.emplace(qsl("rplstats"), [](SessionController *window) {
+		if (!Core::RplProfiler::Enabled()) {
+			Ui::Toast::Show("Build with rpl profiling to use this.");
+			return;
+		}
+		const auto path = cWorkingDir() + "rpl_stats.txt";
+		if (Core::RplProfiler::DumpToFile(path)) {
+			Core::RplProfiler::Reset();
+			File::ShowInFolder(path);
+		} else {
+			Ui::Toast::Show("Could not write rpl stats :(");
+		}
+	});
+	codes.emplace(qsl("mtpstats"), [](SessionController *window) {
+		const auto path = cWorkingDir() + "mtp_stats.txt";
+		auto file = QFile(path);
+		if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+			Ui::Toast::Show("Could not write request stats :(");
+			return;
+		}
+		const auto &mtp = Core::App().domain().active().mtp();
+		file.write(mtp.requestStats().table().toUtf8());
+		file.write("\n");
+		file.close();
+		File::ShowInFolder(path);
+	});
+	codes.emplace(qsl("mtpstatslog"), [](SessionController *window) {
+		auto &mtp = Core::App().domain().active().mtp();
+		const auto enabled = !mtp.requestStatsLogging();
+		mtp.setRequestStatsLogging(enabled);
+		Ui::Toast::Show(enabled
+			? "Request stats logging enabled."
+			: "Request stats logging disabled.");
+	});
 	if (!Core::UpdaterDisabled()) {
 		codes.emplace(qsl("testupdate"), [](SessionController *window) {
 			Core::UpdateChecker().test();
@@ -110,6 +182,28 @@ auto GenerateCodes() {
 			window->session().updates().getDifference();
 		}
 	});
+	codes.emplace(qsl("recordupdates"), [](SessionController *window) {
+		const auto enabled = !Api::UpdatesReplay::Recording();
+		if (!Api::UpdatesReplay::SetRecording(enabled)) {
+			Ui::Toast::Show("Could not start recording updates :(");
+		} else {
+			Ui::Toast::Show(enabled
+				? "Recording updates."
+				: "Updates recording stopped.");
+		}
+	});
+	codes.emplace(qsl("replayupdates"), [](SessionController *window) {
+		if (!window || Api::UpdatesReplay::Recording()) {
+			return;
+		}
+		const auto session = &window->session();
+		const auto text = qsl("Apply the recorded updates once more? "
+			"Already shown messages may be changed until restart.");
+		Ui::show(Box<Ui::ConfirmBox>(text, [=] {
+			Ui::show(Box<Ui::InformBox>(
+				Api::UpdatesReplay::Replay(session)));
+		}));
+	});
 	codes.emplace(qsl("loadcolors"), [](SessionController *window) {
 		FileDialog::GetOpenPath(Core::App().getFileDialogParent(), "Open palette file", "Palette (*.tdesktop-palette)", [](const FileDialog::OpenResult &result) {
 			if (!result.paths.isEmpty()) {
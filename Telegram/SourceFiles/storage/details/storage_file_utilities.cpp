@@ -25,13 +25,71 @@ constexpr auto TdfMagicLen = int(sizeof(TdfMagic));
 
 constexpr auto kStrongIterationsCount = 100'000;
 
+constexpr auto kJournalPostfix = 'j';
+
 struct WriteEntry {
 	QString basePath;
 	QString base;
+	std::vector<WritePart> parts;
+	bool append = false;
+};
+
+struct SerializedEntry {
 	QByteArray data;
 	QByteArray md5;
 };
 
+[[nodiscard]] QByteArray EncryptLocal(
+		QByteArray toEncrypt,
+		const MTP::AuthKeyPtr &key) {
+	// prepare for encryption
+	uint32 size = toEncrypt.size(), fullSize = size;
+	if (fullSize & 0x0F) {
+		fullSize += 0x10 - (fullSize & 0x0F);
+		toEncrypt.resize(fullSize);
+		base::RandomFill(toEncrypt.data() + size, fullSize - size);
+	}
+	*(uint32*)toEncrypt.data() = size;
+	QByteArray encrypted(0x10 + fullSize, Qt::Uninitialized); // 128bit of sha1 - key128, sizeof(data), data
+	hashSha1(toEncrypt.constData(), toEncrypt.size(), encrypted.data());
+	MTP::aesEncryptLocal(toEncrypt.constData(), encrypted.data() + 0x10, fullSize, key, encrypted.constData());
+
+	return encrypted;
+}
+
+[[nodiscard]] SerializedEntry Serialize(std::vector<WritePart> &&parts) {
+	auto result = SerializedEntry();
+	QBuffer buffer(&result.data);
+	const auto opened = buffer.open(QIODevice::WriteOnly);
+	Assert(opened);
+	QDataStream stream(&buffer);
+
+	auto md5 = HashMd5();
+	auto fullSize = 0;
+	for (auto &part : parts) {
+		const auto data = part.key
+			? EncryptLocal(std::move(part.data), part.key)
+			: std::move(part.data);
+		stream << data;
+		quint32 len = data.isNull() ? 0xffffffff : data.size();
+		if (QSysInfo::ByteOrder != QSysInfo::BigEndian) {
+			len = qbswap(len);
+		}
+		md5.feed(&len, sizeof(len));
+		md5.feed(data.constData(), data.size());
+		fullSize += sizeof(len) + data.size();
+	}
+	stream.setDevice(nullptr);
+	buffer.close();
+
+	md5.feed(&fullSize, sizeof(fullSize));
+	qint32 version = AppVersion;
+	md5.feed(&version, sizeof(version));
+	md5.feed(TdfMagic, TdfMagicLen);
+	result.md5 = QByteArray((const char*)md5.result(), 0x10);
+	return result;
+}
+
 class WriteManager final {
 public:
 	explicit WriteManager(crl::weak_on_thread<WriteManager> weak);
@@ -45,6 +103,7 @@ private:
 	void writeScheduled();
 	bool writeOneScheduledNow();
 	void writeNow(WriteEntry &&entry);
+	void appendNow(WriteEntry &&entry);
 
 	template <typename File>
 	[[nodiscard]] bool open(File &file, const WriteEntry &entry, char postfix);
@@ -77,6 +136,16 @@ WriteManager::WriteManager(crl::weak_on_thread<WriteManager> weak)
 }
 
 void WriteManager::write(WriteEntry &&entry) {
+	if (entry.append) {
+		_scheduled.push_back(std::move(entry));
+		scheduleWrite();
+		return;
+	}
+	// The full file contents supersede the journal records scheduled.
+	_scheduled.erase(ranges::remove_if(_scheduled, [&](const WriteEntry &e) {
+		return e.append && (e.base == entry.base);
+	}), end(_scheduled));
+
 	const auto i = ranges::find(_scheduled, entry.base, &WriteEntry::base);
 	if (i == end(_scheduled)) {
 		_scheduled.push_back(std::move(entry));
@@ -87,33 +156,40 @@ void WriteManager::write(WriteEntry &&entry) {
 }
 
 void WriteManager::writeSync(WriteEntry &&entry) {
-	const auto i = ranges::find(_scheduled, entry.base, &WriteEntry::base);
-	if (i != end(_scheduled)) {
-		_scheduled.erase(i);
-	}
+	_scheduled.erase(ranges::remove(
+		_scheduled,
+		entry.base,
+		&WriteEntry::base), end(_scheduled));
 	writeNow(std::move(entry));
 }
 
 void WriteManager::writeNow(WriteEntry &&entry) {
+	if (entry.append) {
+		appendNow(std::move(entry));
+		return;
+	}
 	const auto path = [&](char postfix) {
 		return this->path(entry, postfix);
 	};
 	const auto open = [&](auto &file, char postfix) {
 		return this->open(file, entry, postfix);
 	};
+	const auto serialized = Serialize(std::move(entry.parts));
 	const auto write = [&](auto &file) {
-		file.write(entry.data);
-		file.write(entry.md5);
+		file.write(serialized.data);
+		file.write(serialized.md5);
 	};
 	const auto safe = path('s');
 	const auto simple = path('0');
 	const auto backup = path('1');
+	const auto journal = path(kJournalPostfix);
 	QSaveFile save;
 	if (open(save, 's')) {
 		write(save);
 		if (save.commit()) {
 			QFile::remove(simple);
 			QFile::remove(backup);
+			QFile::remove(journal);
 			return;
 		}
 		LOG(("Storage Error: Could not commit '%1'.").arg(safe));
@@ -126,6 +202,7 @@ void WriteManager::writeNow(WriteEntry &&entry) {
 
 		QFile::remove(backup);
 		if (base::Platform::RenameWithOverwrite(simple, safe)) {
+			QFile::remove(journal);
 			return;
 		}
 		QFile::remove(safe);
@@ -135,6 +212,20 @@ void WriteManager::writeNow(WriteEntry &&entry) {
 	}
 }
 
+void WriteManager::appendNow(WriteEntry &&entry) {
+	QFile file(path(entry, kJournalPostfix));
+	const auto opened = (file.exists() && file.size() > 0)
+		? file.open(QIODevice::WriteOnly | QIODevice::Append)
+		: writeHeader(entry.basePath, file);
+	if (!opened) {
+		LOG(("Storage Error: Could not open '%1' for appending."
+			).arg(file.fileName()));
+		return;
+	}
+	file.write(Serialize(std::move(entry.parts)).data);
+	base::Platform::FlushFileData(file);
+}
+
 void WriteManager::writeSyncAll() {
 	while (writeOneScheduledNow()) {
 	}
@@ -234,6 +325,123 @@ void AsyncWriteManager::stop() {
 	_finished = true;
 }
 
+template <typename Callback>
+bool ReadVerifiedFile(
+		const QString &name,
+		const QString &basePath,
+		Callback &&callback) {
+	const auto base = basePath + name;
+
+	// detect order of read attempts
+	QString toTry[2];
+	const auto modern = base + 's';
+	if (QFileInfo::exists(modern)) {
+		toTry[0] = modern;
+	} else {
+		// Legacy way.
+		toTry[0] = base + '0';
+		QFileInfo toTry0(toTry[0]);
+		if (toTry0.exists()) {
+			toTry[1] = basePath + name + '1';
+			QFileInfo toTry1(toTry[1]);
+			if (toTry1.exists()) {
+				QDateTime mod0 = toTry0.lastModified();
+				QDateTime mod1 = toTry1.lastModified();
+				if (mod0 < mod1) {
+					qSwap(toTry[0], toTry[1]);
+				}
+			} else {
+				toTry[1] = QString();
+			}
+		} else {
+			toTry[0][toTry[0].size() - 1] = '1';
+		}
+	}
+	for (int32 i = 0; i < 2; ++i) {
+		QString fname(toTry[i]);
+		if (fname.isEmpty()) break;
+
+		QFile f(fname);
+		if (!f.open(QIODevice::ReadOnly)) {
+			DEBUG_LOG(("App Info: failed to open '%1' for reading"
+				).arg(name));
+			continue;
+		}
+
+		// Map the file and verify / decrypt it right from the mapping,
+		// falling back to reading it in memory if it could not be mapped.
+		auto read = QByteArray();
+		const auto size = f.size();
+		auto mapped = (size > 0) ? f.map(0, size) : nullptr;
+		if (!mapped && size > 0) {
+			read = f.readAll();
+			mapped = reinterpret_cast<uchar*>(read.data());
+		}
+		const auto full = bytes::make_span(
+			reinterpret_cast<const bytes::type*>(mapped),
+			mapped ? size : 0);
+		const auto fullSize = int(full.size());
+
+		// check magic
+		if (fullSize < TdfMagicLen) {
+			DEBUG_LOG(("App Info: failed to read magic from '%1'"
+				).arg(name));
+			continue;
+		}
+		const auto magic = reinterpret_cast<const char*>(full.data());
+		if (memcmp(magic, TdfMagic, TdfMagicLen)) {
+			DEBUG_LOG(("App Info: bad magic %1 in '%2'").arg(
+				Logs::mb(magic, TdfMagicLen).str(),
+				name));
+			continue;
+		}
+
+		// read app version
+		qint32 version;
+		if (fullSize < TdfMagicLen + int(sizeof(version))) {
+			DEBUG_LOG(("App Info: failed to read version from '%1'"
+				).arg(name));
+			continue;
+		}
+		memcpy(&version, full.data() + TdfMagicLen, sizeof(version));
+		if (version > AppVersion) {
+			DEBUG_LOG(("App Info: version too big %1 for '%2', my version %3"
+				).arg(version
+				).arg(name
+				).arg(AppVersion));
+			continue;
+		}
+
+		// read data
+		const auto bytes = full.subspan(TdfMagicLen + sizeof(version));
+		int32 dataSize = int(bytes.size()) - 16;
+		if (dataSize < 0) {
+			DEBUG_LOG(("App Info: bad file '%1', could not read sign part"
+				).arg(name));
+			continue;
+		}
+
+		// check signature
+		HashMd5 md5;
+		md5.feed(bytes.data(), dataSize);
+		md5.feed(&dataSize, sizeof(dataSize));
+		md5.feed(&version, sizeof(version));
+		md5.feed(magic, TdfMagicLen);
+		if (memcmp(md5.result(), bytes.data() + dataSize, 16)) {
+			DEBUG_LOG(("App Info: bad file '%1', signature did not match"
+				).arg(name));
+			continue;
+		}
+
+		if ((i == 0 && !toTry[1].isEmpty()) || i == 1) {
+			QFile::remove(toTry[1 - i]);
+		}
+
+		return callback(bytes.subspan(0, dataSize), version);
+	}
+	return false;
+}
+
 AsyncWriteManager Manager;
 
 } // namespace
@@ -288,6 +496,8 @@ void ClearKey(const FileKey &key, const QString &basePath) {
 	QFile::remove(name);
 	name[name.size() - 1] = 's';
 	QFile::remove(name);
+	name[name.size() - 1] = kJournalPostfix;
+	QFile::remove(name);
 }
 
 bool CheckStreamStatus(QDataStream &stream) {
@@ -388,60 +598,41 @@ FileWriteDescriptor::FileWriteDescriptor(
 	const QString &basePath,
 	bool sync)
 : _basePath(basePath)
+, _base(basePath + name)
 , _sync(sync) {
-	init(name);
 }
 
 FileWriteDescriptor::~FileWriteDescriptor() {
 	finish();
 }
 
-void FileWriteDescriptor::init(const QString &name) {
-	_base = _basePath + name;
-	_buffer.setBuffer(&_safeData);
-	const auto opened = _buffer.open(QIODevice::WriteOnly);
-	Assert(opened);
-	_stream.setDevice(&_buffer);
-}
-
 void FileWriteDescriptor::writeData(const QByteArray &data) {
-	if (!_stream.device()) {
+	if (_finished) {
 		return;
 	}
-	_stream << data;
-	quint32 len = data.isNull() ? 0xffffffff : data.size();
-	if (QSysInfo::ByteOrder != QSysInfo::BigEndian) {
-		len = qbswap(len);
-	}
-	_md5.feed(&len, sizeof(len));
-	_md5.feed(data.constData(), data.size());
-	_fullSize += sizeof(len) + data.size();
+	_parts.push_back({ .data = data });
 }
 
 void FileWriteDescriptor::writeEncrypted(
 	EncryptedDescriptor &data,
 	const MTP::AuthKeyPtr &key) {
-	writeData(PrepareEncrypted(data, key));
+	if (_finished) {
+		return;
+	}
+	data.finish();
+	_parts.push_back({ .data = data.data, .key = key });
 }
 
 void FileWriteDescriptor::finish() {
-	if (!_stream.device()) {
+	if (_finished) {
 		return;
 	}
-
-	_stream.setDevice(nullptr);
-	_md5.feed(&_fullSize, sizeof(_fullSize));
-	qint32 version = AppVersion;
-	_md5.feed(&version, sizeof(version));
-	_md5.feed(TdfMagic, TdfMagicLen);
-
-	_buffer.close();
+	_finished = true;
 
 	auto entry = WriteEntry{
 		.basePath = _basePath,
 		.base = _base,
-		.data = _safeData,
-		.md5 = QByteArray((const char*)_md5.result(), 0x10)
+		.parts = std::move(_parts),
 	};
 	if (_sync) {
 		Manager.writeSync(std::move(entry));
@@ -454,137 +645,32 @@ void FileWriteDescriptor::finish() {
 		EncryptedDescriptor &data,
 		const MTP::AuthKeyPtr &key) {
 	data.finish();
-	QByteArray &toEncrypt(data.data);
-
-	// prepare for encryption
-	uint32 size = toEncrypt.size(), fullSize = size;
-	if (fullSize & 0x0F) {
-		fullSize += 0x10 - (fullSize & 0x0F);
-		toEncrypt.resize(fullSize);
-		base::RandomFill(toEncrypt.data() + size, fullSize - size);
-	}
-	*(uint32*)toEncrypt.data() = size;
-	QByteArray encrypted(0x10 + fullSize, Qt::Uninitialized); // 128bit of sha1 - key128, sizeof(data), data
-	hashSha1(toEncrypt.constData(), toEncrypt.size(), encrypted.data());
-	MTP::aesEncryptLocal(toEncrypt.constData(), encrypted.data() + 0x10, fullSize, key, encrypted.constData());
-
-	return encrypted;
+	return EncryptLocal(data.data, key);
 }
 
 bool ReadFile(
 		FileReadDescriptor &result,
 		const QString &name,
 		const QString &basePath) {
-	const auto base = basePath + name;
-
-	// detect order of read attempts
-	QString toTry[2];
-	const auto modern = base + 's';
-	if (QFileInfo::exists(modern)) {
-		toTry[0] = modern;
-	} else {
-		// Legacy way.
-		toTry[0] = base + '0';
-		QFileInfo toTry0(toTry[0]);
-		if (toTry0.exists()) {
-			toTry[1] = basePath + name + '1';
-			QFileInfo toTry1(toTry[1]);
-			if (toTry1.exists()) {
-				QDateTime mod0 = toTry0.lastModified();
-				QDateTime mod1 = toTry1.lastModified();
-				if (mod0 < mod1) {
-					qSwap(toTry[0], toTry[1]);
-				}
-			} else {
-				toTry[1] = QString();
-			}
-		} else {
-			toTry[0][toTry[0].size() - 1] = '1';
-		}
-	}
-	for (int32 i = 0; i < 2; ++i) {
-		QString fname(toTry[i]);
-		if (fname.isEmpty()) break;
-
-		QFile f(fname);
-		if (!f.open(QIODevice::ReadOnly)) {
-			DEBUG_LOG(("App Info: failed to open '%1' for reading"
-				).arg(name));
-			continue;
-		}
-
-		// check magic
-		char magic[TdfMagicLen];
-		if (f.read(magic, TdfMagicLen) != TdfMagicLen) {
-			DEBUG_LOG(("App Info: failed to read magic from '%1'"
-				).arg(name));
-			continue;
-		}
-		if (memcmp(magic, TdfMagic, TdfMagicLen)) {
-			DEBUG_LOG(("App Info: bad magic %1 in '%2'").arg(
-				Logs::mb(magic, TdfMagicLen).str(),
-				name));
-			continue;
-		}
-
-		// read app version
-		qint32 version;
-		if (f.read((char*)&version, sizeof(version)) != sizeof(version)) {
-			DEBUG_LOG(("App Info: failed to read version from '%1'"
-				).arg(name));
-			continue;
-		}
-		if (version > AppVersion) {
-			DEBUG_LOG(("App Info: version too big %1 for '%2', my version %3"
-				).arg(version
-				).arg(name
-				).arg(AppVersion));
-			continue;
-		}
-
-		// read data
-		QByteArray bytes = f.read(f.size());
-		int32 dataSize = bytes.size() - 16;
-		if (dataSize < 0) {
-			DEBUG_LOG(("App Info: bad file '%1', could not read sign part"
-				).arg(name));
-			continue;
-		}
-
-		// check signature
-		HashMd5 md5;
-		md5.feed(bytes.constData(), dataSize);
-		md5.feed(&dataSize, sizeof(dataSize));
-		md5.feed(&version, sizeof(version));
-		md5.feed(magic, TdfMagicLen);
-		if (memcmp(md5.result(), bytes.constData() + dataSize, 16)) {
-			DEBUG_LOG(("App Info: bad file '%1', signature did not match"
-				).arg(name));
-			continue;
-		}
-
-		bytes.resize(dataSize);
-		result.data = bytes;
-		bytes = QByteArray();
+	return ReadVerifiedFile(name, basePath, [&](
+			bytes::const_span data,
+			qint32 version) {
+		result.data = QByteArray(
+			reinterpret_cast<const char*>(data.data()),
+			data.size());
 
 		result.version = version;
 		result.buffer.setBuffer(&result.data);
 		result.buffer.open(QIODevice::ReadOnly);
 		result.stream.setDevice(&result.buffer);
 		result.stream.setVersion(QDataStream::Qt_5_1);
-
-		if ((i == 0 && !toTry[1].isEmpty()) || i == 1) {
-			QFile::remove(toTry[1 - i]);
-		}
-
 		return true;
-	}
-	return false;
+	});
 }
 
-bool DecryptLocal(
-		EncryptedDescriptor &result,
-		const QByteArray &encrypted,
+bool DecryptLocalData(
+		QByteArray &result,
+		bytes::const_span encrypted,
 		const MTP::AuthKeyPtr &key) {
 	if (encrypted.size() <= 16 || (encrypted.size() & 0x0F)) {
 		LOG(("App Error: bad encrypted part size: %1").arg(encrypted.size()));
@@ -594,7 +680,7 @@ bool DecryptLocal(
 
 	QByteArray decrypted;
 	decrypted.resize(fullLen);
-	const char *encryptedKey = encrypted.constData(), *encryptedData = encrypted.constData() + 16;
+	const char *encryptedKey = reinterpret_cast<const char*>(encrypted.data()), *encryptedData = encryptedKey + 16;
 	aesDecryptLocal(encryptedData, decrypted.data(), fullLen, key, encryptedKey);
 	uchar sha1Buffer[20];
 	if (memcmp(hashSha1(decrypted.constData(), decrypted.size(), sha1Buffer), encryptedKey, 16)) {
@@ -609,52 +695,78 @@ bool DecryptLocal(
 	}
 
 	decrypted.resize(dataLen);
-	result.data = decrypted;
-	decrypted = QByteArray();
+	result = std::move(decrypted);
+	return true;
+}
+
+void PrepareDecrypted(EncryptedDescriptor &result, QByteArray &&data) {
+	result.data = std::move(data);
 
 	result.buffer.setBuffer(&result.data);
 	result.buffer.open(QIODevice::ReadOnly);
 	result.buffer.seek(sizeof(uint32)); // skip len
 	result.stream.setDevice(&result.buffer);
 	result.stream.setVersion(QDataStream::Qt_5_1);
+}
 
+bool DecryptLocal(
+		EncryptedDescriptor &result,
+		bytes::const_span encrypted,
+		const MTP::AuthKeyPtr &key) {
+	auto decrypted = QByteArray();
+	if (!DecryptLocalData(decrypted, encrypted, key)) {
+		return false;
+	}
+	PrepareDecrypted(result, std::move(decrypted));
 	return true;
 }
 
+bool DecryptLocal(
+		EncryptedDescriptor &result,
+		const QByteArray &encrypted,
+		const MTP::AuthKeyPtr &key) {
+	return DecryptLocal(result, bytes::make_span(encrypted), key);
+}
+
 bool ReadEncryptedFile(
 		FileReadDescriptor &result,
 		const QString &name,
 		const QString &basePath,
 		const MTP::AuthKeyPtr &key) {
-	if (!ReadFile(result, name, basePath)) {
-		return false;
-	}
-	QByteArray encrypted;
-	result.stream >> encrypted;
-
-	EncryptedDescriptor data;
-	if (!DecryptLocal(data, encrypted, key)) {
-		result.stream.setDevice(nullptr);
-		if (result.buffer.isOpen()) result.buffer.close();
-		result.buffer.setBuffer(nullptr);
-		result.data = QByteArray();
-		result.version = 0;
-		return false;
-	}
+	return ReadVerifiedFile(name, basePath, [&](
+			bytes::const_span data,
+			qint32 version) {
+		// The file holds a single serialized QByteArray: length + bytes.
+		quint32 length = 0;
+		if (data.size() < sizeof(length)) {
+			return false;
+		}
+		memcpy(&length, data.data(), sizeof(length));
+		length = qFromBigEndian(length);
+		if (length > data.size() - sizeof(length)) {
+			LOG(("App Error: bad encrypted file '%1' length: %2"
+				).arg(name
+				).arg(length));
+			return false;
+		}
 
-	result.stream.setDevice(0);
-	if (result.buffer.isOpen()) {
-		result.buffer.close();
-	}
-	result.buffer.setBuffer(0);
-	result.data = data.data;
-	result.buffer.setBuffer(&result.data);
-	result.buffer.open(QIODevice::ReadOnly);
-	result.buffer.seek(data.buffer.pos());
-	result.stream.setDevice(&result.buffer);
-	result.stream.setVersion(QDataStream::Qt_5_1);
+		EncryptedDescriptor decrypted;
+		if (!DecryptLocal(
+				decrypted,
+				data.subspan(sizeof(length), length),
+				key)) {
+			return false;
+		}
 
-	return true;
+		result.data = decrypted.data;
+		result.version = version;
+		result.buffer.setBuffer(&result.data);
+		result.buffer.open(QIODevice::ReadOnly);
+		result.buffer.seek(decrypted.buffer.pos());
+		result.stream.setDevice(&result.buffer);
+		result.stream.setVersion(QDataStream::Qt_5_1);
+		return true;
+	});
 }
 
 bool ReadEncryptedFile(
@@ -665,6 +777,67 @@ bool ReadEncryptedFile(
 	return ReadEncryptedFile(result, ToFilePart(fkey), basePath, key);
 }
 
+void AppendEncryptedJournal(
+		const FileKey &fkey,
+		const QString &basePath,
+		EncryptedDescriptor &data,
+		const MTP::AuthKeyPtr &key) {
+	data.finish();
+	auto parts = std::vector<WritePart>();
+	parts.push_back({ .data = data.data, .key = key });
+	Manager.write({
+		.basePath = basePath,
+		.base = basePath + ToFilePart(fkey),
+		.parts = std::move(parts),
+		.append = true,
+	});
+}
+
+bool ReadEncryptedJournal(
+		const FileKey &fkey,
+		const QString &basePath,
+		const MTP::AuthKeyPtr &key,
+		Fn<bool(EncryptedDescriptor &data)> callback) {
+	const auto name = basePath + ToFilePart(fkey) + kJournalPostfix;
+	QFile f(name);
+	if (!f.exists()) {
+		return true;
+	} else if (!f.open(QIODevice::ReadOnly)) {
+		LOG(("App Error: failed to open journal '%1' for reading"
+			).arg(name));
+		return false;
+	}
+
+	char magic[TdfMagicLen];
+	qint32 version = 0;
+	if (f.read(magic, TdfMagicLen) != TdfMagicLen
+		|| memcmp(magic, TdfMagic, TdfMagicLen)
+		|| f.read((char*)&version, sizeof(version)) != sizeof(version)
+		|| version > AppVersion) {
+		LOG(("App Error: bad journal header in '%1'").arg(name));
+		return false;
+	}
+
+	auto bytes = f.readAll();
+	QBuffer buffer(&bytes);
+	buffer.open(QIODevice::ReadOnly);
+	QDataStream stream(&buffer);
+	stream.setVersion(QDataStream::Qt_5_1);
+	while (!stream.atEnd()) {
+		QByteArray encrypted;
+		stream >> encrypted;
+		if (stream.status() != QDataStream::Ok) {
+			LOG(("App Error: broken journal record in '%1'").arg(name));
+			return false;
+		}
+		EncryptedDescriptor data;
+		if (!DecryptLocal(data, encrypted, key) || !callback(data)) {
+			return false;
+		}
+	}
+	return true;
+}
+
 void Sync() {
 	Manager.sync();
 }
@@ -52,6 +52,12 @@ struct EncryptedDescriptor final {
 	EncryptedDescriptor &data,
 	const MTP::AuthKeyPtr &key);
 
+// If the key is set the data is encrypted on the write thread.
+struct WritePart {
+	QByteArray data;
+	MTP::AuthKeyPtr key;
+};
+
 class FileWriteDescriptor final {
 public:
 	FileWriteDescriptor(
@@ -70,17 +76,13 @@ public:
 		const MTP::AuthKeyPtr &key);
 
 private:
-	void init(const QString &name);
 	void finish();
 
 	const QString _basePath;
-	QBuffer _buffer;
-	QDataStream _stream;
-	QByteArray _safeData;
-	QString _base;
-	HashMd5 _md5;
-	int _fullSize = 0;
+	const QString _base;
+	std::vector<WritePart> _parts;
 	bool _sync = false;
+	bool _finished = false;
 
 };
 
@@ -89,6 +91,18 @@ bool ReadFile(
 	const QString &name,
 	const QString &basePath);
 
+// Decryption doesn't touch any QObject, so it may run on any thread,
+// the result is wrapped in a descriptor after that.
+[[nodiscard]] bool DecryptLocalData(
+	QByteArray &result,
+	bytes::const_span encrypted,
+	const MTP::AuthKeyPtr &key);
+void PrepareDecrypted(EncryptedDescriptor &result, QByteArray &&data);
+
+bool DecryptLocal(
+	EncryptedDescriptor &result,
+	bytes::const_span encrypted,
+	const MTP::AuthKeyPtr &key);
 bool DecryptLocal(
 	EncryptedDescriptor &result,
 	const QByteArray &encrypted,
@@ -106,6 +120,21 @@ bool ReadEncryptedFile(
 	const QString &basePath,
 	const MTP::AuthKeyPtr &key);
 
+// Journal records are appended to a separate file of the same key,
+// a full write of the key supersedes and removes all the records.
+void AppendEncryptedJournal(
+	const FileKey &fkey,
+	const QString &basePath,
+	EncryptedDescriptor &data,
+	const MTP::AuthKeyPtr &key);
+
+// Returns false if some record could not be read or applied.
+bool ReadEncryptedJournal(
+	const FileKey &fkey,
+	const QString &basePath,
+	const MTP::AuthKeyPtr &key,
+	Fn<bool(EncryptedDescriptor &data)> callback);
+
 void Sync();
 void Finish();
 
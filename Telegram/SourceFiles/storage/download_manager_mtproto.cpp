@@ -18,6 +18,7 @@ namespace Storage {
 namespace {
 
 constexpr auto kKillSessionTimeout = 15 * crl::time(1000);
+constexpr auto kWarmUpRepeatTimeout = kKillSessionTimeout / 3;
 constexpr auto kStartWaitedInSession = 4 * kDownloadPartSize;
 constexpr auto kMaxWaitedInSession = 16 * kDownloadPartSize;
 constexpr auto kStartSessionsCount = 1;
@@ -30,12 +31,51 @@ constexpr auto kMaxTrackedSuccesses = kRetryAddSessionSuccesses
 constexpr auto kRemoveSessionAfterTimeouts = 4;
 constexpr auto kResetDownloadPrioritiesTimeout = crl::time(200);
 constexpr auto kBadRequestDurationThreshold = 8 * crl::time(1000);
+constexpr auto kBandwidthSamplePeriod = crl::time(500);
+constexpr auto kMinRoundTripExpireTimeout = 10 * crl::time(1000);
+constexpr auto kTargetInFlightGain = 2;
+constexpr auto kDownloadClasses = std::array{
+	DownloadClass::Streaming,
+	DownloadClass::User,
+	DownloadClass::Auto,
+};
 
 // Each (session remove by timeouts) we wait for time:
 // kRetryAddSessionTimeout * max(removesCount, kMaxTrackedSessionRemoves)
 // and for successes in all remaining sessions:
 // kRetryAddSessionSuccesses * max(removesCount, kMaxTrackedSessionRemoves)
 
+// The throughput estimate keeps the max of the delivery rate samples
+// taken each kBandwidthSamplePeriod and the min of the request durations
+// for the last kMinRoundTripExpireTimeout. Bytes in flight for the dc are
+// targeted at kTargetInFlightGain * (bandwidth * min round trip), split
+// between sessions, and sessions are added only if that target doesn't
+// fit in the ones we already have.
+
+// Speed limits are in kilobytes per second, zero means no limit.
+[[nodiscard]] int64 TotalSpeedLimit() {
+	return int64(cDownloadSpeedLimit()) * 1024;
+}
+
+[[nodiscard]] int64 ClassSpeedLimit(DownloadClass type) {
+	const auto kilobytes = [&] {
+		switch (type) {
+		case DownloadClass::Streaming: return cStreamingDownloadSpeedLimit();
+		case DownloadClass::User: return cUserDownloadSpeedLimit();
+		case DownloadClass::Auto: return cAutoDownloadSpeedLimit();
+		}
+		Unexpected("Type in ClassSpeedLimit.");
+	}();
+	return int64(kilobytes) * 1024;
+}
+
+[[nodiscard]] bool BandwidthLimited() {
+	return (TotalSpeedLimit() > 0)
+		|| ranges::any_of(kDownloadClasses, [](DownloadClass type) {
+			return ClassSpeedLimit(type) > 0;
+		});
+}
+
 } // namespace
 
 void DownloadManagerMtproto::Queue::enqueue(
@@ -80,7 +120,9 @@ bool DownloadManagerMtproto::Queue::empty() const {
 	return _tasks.empty();
 }
 
-auto DownloadManagerMtproto::Queue::nextTask(bool onlyHighestPriority) const
+auto DownloadManagerMtproto::Queue::nextTask(
+	bool onlyHighestPriority,
+	std::optional<DownloadClass> type) const
 -> Task* {
 	if (_tasks.empty()) {
 		return nullptr;
@@ -93,7 +135,8 @@ auto DownloadManagerMtproto::Queue::nextTask(bool onlyHighestPriority) const
 		? ranges::find_if(_tasks, notHighestPriority)
 		: end(_tasks);
 	const auto readyToRequest = [&](const Enqueued &enqueued) {
-		return enqueued.task->readyToRequest();
+		return (!type || enqueued.task->downloadClass() == *type)
+			&& enqueued.task->readyToRequest();
 	};
 	const auto first = ranges::find_if(
 		ranges::make_subrange(begin(_tasks), till),
@@ -118,7 +161,8 @@ DownloadManagerMtproto::DcBalanceData::DcBalanceData()
 DownloadManagerMtproto::DownloadManagerMtproto(not_null<ApiWrap*> api)
 : _api(api)
 , _resetGenerationTimer([=] { resetGeneration(); })
-, _killSessionsTimer([=] { killSessions(); }) {
+, _killSessionsTimer([=] { killSessions(); })
+, _bandwidthTimer([=] { checkSendNext(); }) {
 	_api->instance().restartsByTimeout(
 	) | rpl::filter([](MTP::ShiftedDcId shiftedDcId) {
 		return MTP::isDownloadDcId(shiftedDcId);
@@ -150,6 +194,27 @@ void DownloadManagerMtproto::remove(not_null<Task*> task) {
 	checkSendNext(dcId, queue);
 }
 
+void DownloadManagerMtproto::warmUp(MTP::DcId dcId) {
+	if (!dcId) {
+		return;
+	}
+	const auto now = crl::now();
+	auto &warmedUpAt = _warmedUpAt[dcId];
+	if (warmedUpAt && now - warmedUpAt < kWarmUpRepeatTimeout) {
+		return;
+	}
+	warmedUpAt = now;
+
+	// The entry makes killSessions() stop the warmed up session as well.
+	const auto &dc = _balanceData[dcId];
+	if (dc.totalRequested > 0) {
+		return;
+	}
+	DEBUG_LOG(("Download (%1) warming up the session.").arg(dcId));
+	api().instance().sendAnything(MTP::downloadDcId(dcId, 0));
+	killSessionsSchedule(dcId);
+}
+
 void DownloadManagerMtproto::resetGeneration() {
 	_resetGenerationTimer.cancel();
 	for (auto &[dcId, queue] : _queues) {
@@ -193,13 +258,83 @@ bool DownloadManagerMtproto::trySendNextPart(MTP::DcId dcId, Queue &queue) {
 		return false;
 	}
 	const auto onlyHighestPriority = (balanceData.totalRequested > 0);
-	if (const auto task = queue.nextTask(onlyHighestPriority)) {
+	if (BandwidthLimited()) {
+		return trySendNextPartLimited(queue, bestIndex, onlyHighestPriority);
+	} else if (const auto task = queue.nextTask(onlyHighestPriority)) {
 		task->loadPart(bestIndex);
 		return true;
 	}
 	return false;
 }
 
+bool DownloadManagerMtproto::trySendNextPartLimited(
+		Queue &queue,
+		int sessionIndex,
+		bool onlyHighestPriority) {
+	const auto now = crl::now();
+	const auto totalLimit = TotalSpeedLimit();
+	const auto totalWait = bandwidthWait(_totalBandwidth, totalLimit, now);
+	if (totalWait > 0) {
+		if (queue.nextTask(onlyHighestPriority)) {
+			scheduleBandwidthCheck(totalWait);
+		}
+		return false;
+	}
+
+	// While limited, serve the classes in the order of their priority.
+	for (const auto type : kDownloadClasses) {
+		const auto task = queue.nextTask(onlyHighestPriority, type);
+		if (!task) {
+			continue;
+		}
+		auto &bucket = _classBandwidth[int(type)];
+		const auto limit = ClassSpeedLimit(type);
+		if (const auto wait = bandwidthWait(bucket, limit, now)) {
+			scheduleBandwidthCheck(wait);
+			continue;
+		}
+		if (totalLimit > 0) {
+			_totalBandwidth.tokens -= kDownloadPartSize;
+		}
+		if (limit > 0) {
+			bucket.tokens -= kDownloadPartSize;
+		}
+		task->loadPart(sessionIndex);
+		return true;
+	}
+	return false;
+}
+
+crl::time DownloadManagerMtproto::bandwidthWait(
+		BandwidthBucket &bucket,
+		int64 limit,
+		crl::time now) {
+	if (limit <= 0) {
+		return 0;
+	}
+	// Allow a burst of one second of traffic, but at least one part.
+	const auto burst = std::max(limit, int64(kDownloadPartSize));
+	if (!bucket.updated) {
+		bucket.tokens = burst;
+	} else if (now > bucket.updated) {
+		bucket.tokens = std::min(
+			bucket.tokens + limit * (now - bucket.updated) / 1000,
+			burst);
+	}
+	bucket.updated = now;
+	if (bucket.tokens >= kDownloadPartSize) {
+		return 0;
+	}
+	return (kDownloadPartSize - bucket.tokens) * 1000 / limit + 1;
+}
+
+void DownloadManagerMtproto::scheduleBandwidthCheck(crl::time wait) {
+	if (!_bandwidthTimer.isActive()
+		|| _bandwidthTimer.remainingTime() > wait) {
+		_bandwidthTimer.callOnce(wait);
+	}
+}
+
 int DownloadManagerMtproto::changeRequestedAmount(
 		MTP::DcId dcId,
 		int index,
@@ -219,16 +354,78 @@ int DownloadManagerMtproto::changeRequestedAmount(
 	if (delta > 0) {
 		killSessionsCancel(dcId);
 	} else if (findNonEmptySession(i->second) == end(i->second.sessions)) {
+		// Don't count the idle time in the delivery rate.
+		i->second.samplePeriodStart = 0;
+		i->second.samplePeriodBytes = 0;
 		killSessionsSchedule(dcId);
 	}
 	return result;
 }
 
+void DownloadManagerMtproto::feedThroughput(
+		MTP::DcId dcId,
+		DcBalanceData &dc,
+		int bytes,
+		crl::time duration) {
+	const auto now = crl::now();
+	if (!dc.minRoundTrip
+		|| duration < dc.minRoundTrip
+		|| now - dc.minRoundTripReceived > kMinRoundTripExpireTimeout) {
+		dc.minRoundTrip = std::max(duration, crl::time(1));
+		dc.minRoundTripReceived = now;
+	}
+	if (!dc.samplePeriodStart) {
+		dc.samplePeriodStart = now - duration;
+	}
+	dc.samplePeriodBytes += bytes;
+	const auto elapsed = now - dc.samplePeriodStart;
+	if (elapsed < kBandwidthSamplePeriod) {
+		return;
+	}
+	dc.bandwidthSamples[dc.bandwidthSampleIndex] = dc.samplePeriodBytes
+		* 1000
+		/ elapsed;
+	dc.bandwidthSampleIndex = (dc.bandwidthSampleIndex + 1)
+		% kBandwidthSamplesCount;
+	dc.samplePeriodStart = now;
+	dc.samplePeriodBytes = 0;
+
+	const auto bandwidth = ranges::max(dc.bandwidthSamples);
+	const auto product = bandwidth * dc.minRoundTrip / 1000;
+	dc.targetInFlight = int(std::clamp(
+		product * kTargetInFlightGain,
+		int64(kStartWaitedInSession),
+		int64(kMaxWaitedInSession) * kMaxSessionsCount));
+	DEBUG_LOG(("Download (%1) estimate: bandwidth %2 KB/s, "
+		"min round trip %3 ms, target in flight %4 parts, "
+		"per session %5 parts, sessions: %6"
+		).arg(dcId
+		).arg(bandwidth / 1024
+		).arg(dc.minRoundTrip
+		).arg(dc.targetInFlight / kDownloadPartSize
+		).arg(maxWaitedInSession(dc) / kDownloadPartSize
+		).arg(dc.sessions.size()));
+}
+
+int DownloadManagerMtproto::maxWaitedInSession(const DcBalanceData &dc) const {
+	if (!dc.targetInFlight || dc.sessions.empty()) {
+		return kMaxWaitedInSession;
+	}
+	const auto perSession = dc.targetInFlight / int(dc.sessions.size());
+	const auto parts = (perSession + kDownloadPartSize - 1)
+		/ kDownloadPartSize;
+	return std::clamp(
+		parts * kDownloadPartSize,
+		kStartWaitedInSession,
+		kMaxWaitedInSession);
+}
+
 void DownloadManagerMtproto::requestSucceeded(
 		MTP::DcId dcId,
 		int index,
 		int amountAtRequestStart,
-		crl::time timeAtRequestStart) {
+		crl::time timeAtRequestStart,
+		int receivedBytes) {
 	using namespace rpl::mappers;
 
 	const auto i = _balanceData.find(dcId);
@@ -246,6 +443,7 @@ void DownloadManagerMtproto::requestSucceeded(
 		).arg(duration
 		).arg(parts
 		).arg(overloaded ? " (overloaded)" : ""));
+	feedThroughput(dcId, dc, receivedBytes, duration);
 	if (overloaded) {
 		return;
 	}
@@ -257,11 +455,18 @@ void DownloadManagerMtproto::requestSucceeded(
 		});
 		return;
 	}
-	if (amountAtRequestStart == data.maxWaitedAmount
-		&& data.maxWaitedAmount < kMaxWaitedInSession) {
+	const auto maxWaited = maxWaitedInSession(dc);
+	if (data.maxWaitedAmount > maxWaited) {
+		data.maxWaitedAmount = maxWaited;
+		DEBUG_LOG(("Download (%1,%2) decreased max waited amount %3."
+			).arg(dcId
+			).arg(index
+			).arg(data.maxWaitedAmount));
+	} else if (amountAtRequestStart == data.maxWaitedAmount
+		&& data.maxWaitedAmount < maxWaited) {
 		data.maxWaitedAmount = std::min(
 			data.maxWaitedAmount + kDownloadPartSize,
-			kMaxWaitedInSession);
+			maxWaited);
 		DEBUG_LOG(("Download (%1,%2) increased max waited amount %3."
 			).arg(dcId
 			).arg(index
@@ -283,6 +488,11 @@ void DownloadManagerMtproto::requestSucceeded(
 		return;
 	} else if (dc.sessions.size() == kMaxSessionsCount) {
 		return;
+	} else if (dc.targetInFlight > 0
+		&& (dc.targetInFlight
+			<= int(dc.sessions.size()) * kMaxWaitedInSession)) {
+		// Current sessions are enough for the measured throughput.
+		return;
 	}
 	const auto now = crl::now();
 	const auto delay = (dc.sessionRemoveTimes + 1) * kRetryAddSessionTimeout;
@@ -399,7 +609,15 @@ void DownloadManagerMtproto::killSessions(MTP::DcId dcId) {
 		auto &dc = i->second;
 		Assert(dc.totalRequested == 0);
 		auto sessions = base::take(dc.sessions);
+
+		// The link didn't change, keep the throughput estimate.
+		const auto estimate = dc;
 		dc = DcBalanceData();
+		dc.bandwidthSamples = estimate.bandwidthSamples;
+		dc.bandwidthSampleIndex = estimate.bandwidthSampleIndex;
+		dc.minRoundTrip = estimate.minRoundTrip;
+		dc.minRoundTripReceived = estimate.minRoundTripReceived;
+		dc.targetInFlight = estimate.targetInFlight;
 		for (auto j = 0; j != int(sessions.size()); ++j) {
 			Assert(sessions[j].requested == 0);
 			sessions[j] = DcSessionBalanceData();
@@ -473,6 +691,10 @@ void DownloadMtprotoTask::refreshFileReferenceFrom(
 	}
 }
 
+DownloadClass DownloadMtprotoTask::downloadClass() const {
+	return DownloadClass::User;
+}
+
 void DownloadMtprotoTask::loadPart(int sessionIndex) {
 	makeRequest({ takeNextRequestOffset(), sessionIndex });
 }
@@ -603,9 +825,15 @@ void DownloadMtprotoTask::requestMoreCdnFileHashes() {
 void DownloadMtprotoTask::normalPartLoaded(
 		const MTPupload_File &result,
 		mtpRequestId requestId) {
+	const auto received = result.match([](const MTPDupload_file &data) {
+		return int(data.vbytes().v.size());
+	}, [](const MTPDupload_fileCdnRedirect &) {
+		return 0;
+	});
 	const auto requestData = finishSentRequest(
 		requestId,
-		FinishRequestReason::Success);
+		FinishRequestReason::Success,
+		received);
 	const auto owner = _owner;
 	const auto dcId = this->dcId();
 	result.match([&](const MTPDupload_fileCdnRedirect &data) {
@@ -621,9 +849,13 @@ void DownloadMtprotoTask::normalPartLoaded(
 void DownloadMtprotoTask::webPartLoaded(
 		const MTPupload_WebFile &result,
 		mtpRequestId requestId) {
+	const auto received = result.match([](const MTPDupload_webFile &data) {
+		return int(data.vbytes().v.size());
+	});
 	const auto requestData = finishSentRequest(
 		requestId,
-		FinishRequestReason::Success);
+		FinishRequestReason::Success,
+		received);
 	const auto owner = _owner;
 	const auto dcId = this->dcId();
 	result.match([&](const MTPDupload_webFile &data) {
@@ -656,7 +888,8 @@ void DownloadMtprotoTask::cdnPartLoaded(const MTPupload_CdnFile &result, mtpRequ
 	}, [&](const MTPDupload_cdnFile &data) {
 		const auto requestData = finishSentRequest(
 			requestId,
-			FinishRequestReason::Success);
+			FinishRequestReason::Success,
+			int(data.vbytes().v.size()));
 		const auto owner = _owner;
 		const auto dcId = this->dcId();
 		const auto guard = gsl::finally([=] {
@@ -799,7 +1032,8 @@ void DownloadMtprotoTask::placeSentRequest(
 
 auto DownloadMtprotoTask::finishSentRequest(
 	mtpRequestId requestId,
-	FinishRequestReason reason)
+	FinishRequestReason reason,
+	int receivedBytes)
 -> RequestData {
 	auto it = _sentRequests.find(requestId);
 	Assert(it != _sentRequests.cend());
@@ -820,7 +1054,8 @@ auto DownloadMtprotoTask::finishSentRequest(
 			dcId(),
 			result.sessionIndex,
 			result.requestedInSession,
-			result.sent);
+			result.sent,
+			receivedBytes);
 	}
 
 	Ensures(ok);
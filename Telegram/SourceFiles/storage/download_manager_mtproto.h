@@ -25,6 +25,13 @@ namespace Storage {
 // fixed part size download for hash checking.
 constexpr auto kDownloadPartSize = 128 * 1024;
 
+// Classes of downloads for the bandwidth limits, highest priority first.
+enum class DownloadClass {
+	Streaming,
+	User,
+	Auto,
+};
+
 class DownloadMtprotoTask;
 
 class DownloadManagerMtproto final : public base::has_weak_ptr {
@@ -41,6 +48,10 @@ public:
 	void enqueue(not_null<Task*> task, int priority);
 	void remove(not_null<Task*> task);
 
+	// Connect the first download session in advance, so that it is ready
+	// when the files from this dc are requested. Killed if not used.
+	void warmUp(MTP::DcId dcId);
+
 	void notifyTaskFinished() {
 		_taskFinished.fire({});
 	}
@@ -53,7 +64,8 @@ public:
 		MTP::DcId dcId,
 		int index,
 		int amountAtRequestStart,
-		crl::time timeAtRequestStart);
+		crl::time timeAtRequestStart,
+		int receivedBytes);
 	void checkSendNextAfterSuccess(MTP::DcId dcId);
 	[[nodiscard]] int chooseSessionIndex(MTP::DcId dcId) const;
 
@@ -64,7 +76,9 @@ private:
 		void remove(not_null<Task*> task);
 		void resetGeneration();
 		[[nodiscard]] bool empty() const;
-		[[nodiscard]] Task *nextTask(bool onlyHighestPriority) const;
+		[[nodiscard]] Task *nextTask(
+			bool onlyHighestPriority,
+			std::optional<DownloadClass> type = std::nullopt) const;
 		void removeSession(int index);
 
 	private:
@@ -75,6 +89,9 @@ private:
 		std::vector<Enqueued> _tasks;
 
 	};
+	static constexpr auto kBandwidthSamplesCount = 10;
+	static constexpr auto kDownloadClassesCount = 3;
+
 	struct DcSessionBalanceData {
 		DcSessionBalanceData();
 
@@ -91,11 +108,35 @@ private:
 		int sessionRemoveTimes = 0;
 		int timeouts = 0; // Since all sessions had successes >= required.
 		int totalRequested = 0;
+
+		// Throughput estimate, bandwidth is in bytes per second.
+		std::array<int64, kBandwidthSamplesCount> bandwidthSamples = { 0 };
+		int bandwidthSampleIndex = 0;
+		crl::time samplePeriodStart = 0;
+		int64 samplePeriodBytes = 0;
+		crl::time minRoundTrip = 0;
+		crl::time minRoundTripReceived = 0;
+		int targetInFlight = 0; // Zero until the first bandwidth sample.
+	};
+
+	// Token bucket for the bandwidth limits from the settings.
+	struct BandwidthBucket {
+		int64 tokens = 0;
+		crl::time updated = 0;
 	};
 
 	void checkSendNext();
 	void checkSendNext(MTP::DcId dcId, Queue &queue);
 	bool trySendNextPart(MTP::DcId dcId, Queue &queue);
+	bool trySendNextPartLimited(
+		Queue &queue,
+		int sessionIndex,
+		bool onlyHighestPriority);
+	[[nodiscard]] crl::time bandwidthWait(
+		BandwidthBucket &bucket,
+		int64 limit,
+		crl::time now);
+	void scheduleBandwidthCheck(crl::time wait);
 
 	void killSessionsSchedule(MTP::DcId dcId);
 	void killSessionsCancel(MTP::DcId dcId);
@@ -103,6 +144,12 @@ private:
 	void killSessions(MTP::DcId dcId);
 
 	void resetGeneration();
+	void feedThroughput(
+		MTP::DcId dcId,
+		DcBalanceData &dc,
+		int bytes,
+		crl::time duration);
+	[[nodiscard]] int maxWaitedInSession(const DcBalanceData &dc) const;
 	void sessionTimedOut(MTP::DcId dcId, int index);
 	void removeSession(MTP::DcId dcId);
 
@@ -116,6 +163,12 @@ private:
 	base::flat_map<MTP::DcId, crl::time> _killSessionsWhen;
 	base::Timer _killSessionsTimer;
 
+	base::flat_map<MTP::DcId, crl::time> _warmedUpAt;
+
+	BandwidthBucket _totalBandwidth;
+	std::array<BandwidthBucket, kDownloadClassesCount> _classBandwidth;
+	base::Timer _bandwidthTimer;
+
 	base::flat_map<MTP::DcId, Queue> _queues;
 	rpl::lifetime _lifetime;
 
@@ -146,6 +199,7 @@ public:
 	[[nodiscard]] const Location &location() const;
 
 	[[nodiscard]] virtual bool readyToRequest() const = 0;
+	[[nodiscard]] virtual DownloadClass downloadClass() const;
 	void loadPart(int sessionIndex);
 	void removeSession(int sessionIndex);
 
@@ -235,7 +289,8 @@ private:
 		const RequestData &requestData);
 	[[nodiscard]] RequestData finishSentRequest(
 		mtpRequestId requestId,
-		FinishRequestReason reason);
+		FinishRequestReason reason,
+		int receivedBytes = 0);
 	void switchToCDN(
 		const RequestData &requestData,
 		const MTPDupload_fileCdnRedirect &redirect);
@@ -15,6 +15,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/application.h"
 #include "core/file_location.h"
 #include "storage/storage_account.h"
+#include "storage/storage_cache_usage.h"
 #include "storage/file_download_mtproto.h"
 #include "storage/file_download_web.h"
 #include "platform/platform_file_utilities.h"
@@ -280,7 +281,7 @@ void FileLoader::loadLocal(const Storage::Cache::Key &key) {
 				std::move(image));
 		});
 	};
-	_session->data().cache().get(key, [=, callback = std::move(done)](
+	auto finish = [=, callback = std::move(done)](
 			QByteArray &&value) mutable {
 		if (readImage && !value.startsWith("partial:")) {
 			crl::async([
@@ -300,9 +301,32 @@ void FileLoader::loadLocal(const Storage::Cache::Key &key) {
 		} else {
 			callback(std::move(value), {}, {});
 		}
+	};
+	const auto tag = _cacheTag;
+	const auto started = crl::now();
+	const auto sharedKey = sharedCacheKey();
+	const auto weak = base::make_weak(this);
+	_session->data().cache().get(key, [=, finish = std::move(finish)](
+			QByteArray &&value) mutable {
+		Storage::RecordCacheRead(tag, value.size(), crl::now() - started);
+		if (!value.isEmpty() || !(sharedKey.low || sharedKey.high)) {
+			finish(std::move(value));
+			return;
+		}
+		crl::on_main(weak, [=, finish = std::move(finish)]() mutable {
+			weak->_session->data().sharedCache().get(sharedKey, [
+				finish = std::move(finish)
+			](QByteArray &&value) mutable {
+				finish(std::move(value));
+			});
+		});
 	});
 }
 
+Storage::Cache::Key FileLoader::sharedCacheKey() const {
+	return Storage::Cache::Key();
+}
+
 bool FileLoader::tryLoadLocal() {
 	if (_localStatus == LocalStatus::NotFound
 		|| _localStatus == LocalStatus::Loaded) {
@@ -454,12 +478,17 @@ bool FileLoader::finalizeResult() {
 					Core::FileLocation(_filename));
 			}
 		}
-		const auto key = cacheKey();
+		const auto sharedKey = sharedCacheKey();
+		const auto shared = (sharedKey.low || sharedKey.high);
+		const auto key = shared ? sharedKey : cacheKey();
 		if ((_toCache == LoadToCacheAsWell)
 			&& (_data.size() <= Storage::kMaxFileInMemory)
 			&& (key.low || key.high)) {
-			_session->data().cache().put(
-				cacheKey(),
+			auto &cache = shared
+				? _session->data().sharedCache()
+				: _session->data().cache();
+			cache.put(
+				key,
 				Storage::Cache::Database::TaggedValue(
 					base::duplicate((!_fullSize || _data.size() == _fullSize)
 						? _data
@@ -137,6 +137,7 @@ protected:
 	bool tryLoadLocal();
 	void loadLocal(const Storage::Cache::Key &key);
 	virtual Storage::Cache::Key cacheKey() const = 0;
+	virtual Storage::Cache::Key sharedCacheKey() const;
 	virtual std::optional<MediaKey> fileLocationKey() const = 0;
 	virtual void cancelHook() = 0;
 	virtual void startLoading() = 0;
@@ -9,6 +9,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "data/data_document.h"
 #include "data/data_file_origin.h"
+#include "data/data_session.h"
+#include "data/data_channel.h"
 #include "storage/cache/storage_cache_types.h"
 #include "main/main_session.h"
 #include "apiwrap.h"
@@ -16,6 +18,29 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/mtproto_config.h"
 #include "mtproto/mtproto_auth_key.h"
 
+namespace {
+
+// Files that any account may see are kept once for all of them.
+[[nodiscard]] bool IsPublicOrigin(
+		not_null<Main::Session*> session,
+		const Data::FileOrigin &origin) {
+	return v::match(origin.data, [&](const Data::FileOriginMessage &data) {
+		const auto peer = session->data().peerLoaded(data.peer);
+		const auto channel = peer ? peer->asChannel() : nullptr;
+		return channel && channel->isBroadcast() && channel->isPublic();
+	}, [](const Data::FileOriginStickerSet &data) {
+		return true;
+	}, [](const Data::FileOriginWallpaper &data) {
+		return true;
+	}, [](const Data::FileOriginTheme &data) {
+		return true;
+	}, [](const auto &data) {
+		return false;
+	});
+}
+
+} // namespace
+
 mtpFileLoader::mtpFileLoader(
 	not_null<Main::Session*> session,
 	const StorageFileLocation &location,
@@ -110,6 +135,12 @@ bool mtpFileLoader::readyToRequest() const {
 		&& (!_fullSize || _nextRequestOffset < _loadSize);
 }
 
+Storage::DownloadClass mtpFileLoader::downloadClass() const {
+	return autoLoading()
+		? Storage::DownloadClass::Auto
+		: Storage::DownloadClass::User;
+}
+
 int mtpFileLoader::takeNextRequestOffset() {
 	Expects(readyToRequest());
 
@@ -187,6 +218,13 @@ Storage::Cache::Key mtpFileLoader::cacheKey() const {
 	});
 }
 
+Storage::Cache::Key mtpFileLoader::sharedCacheKey() const {
+	const auto storage = std::get_if<StorageFileLocation>(&location().data);
+	return (storage && IsPublicOrigin(_session, fileOrigin()))
+		? storage->sharedCacheKey()
+		: Storage::Cache::Key();
+}
+
 std::optional<MediaKey> mtpFileLoader::fileLocationKey() const {
 	if (_locationType != UnknownFileLocation) {
 		return mediaKey(_locationType, dcId(), objId());
@@ -49,12 +49,14 @@ public:
 
 private:
 	Storage::Cache::Key cacheKey() const override;
+	Storage::Cache::Key sharedCacheKey() const override;
 	std::optional<MediaKey> fileLocationKey() const override;
 	void startLoading() override;
 	void startLoadingWithPartial(const QByteArray &data) override;
 	void cancelHook() override;
 
 	bool readyToRequest() const override;
+	Storage::DownloadClass downloadClass() const override;
 	int takeNextRequestOffset() override;
 	bool feedPart(int offset, const QByteArray &bytes) override;
 	void cancelOnFail() override;
@@ -21,13 +21,20 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/file_location.h"
 #include "core/mime_type.h"
 #include "main/main_session.h"
+#include "base/random.h"
 #include "apiwrap.h"
 
 namespace Storage {
 namespace {
 
 // max 512kb uploaded at the same time in each session
-constexpr auto kMaxUploadFileParallelSize = MTP::kUploadSessionsCount * 512 * 1024;
+constexpr auto kMaxUploadPartsSizeInSession = 512 * 1024;
+
+// How many document parts are read from disk before they are sent.
+constexpr auto kReadAheadPartsCount = 4;
+
+// How many times a part is sent before the whole file fails.
+constexpr auto kMaxPartAttempts = 3;
 
 constexpr auto kDocumentMaxPartsCount = 4000;
 
@@ -46,6 +53,9 @@ constexpr auto kDocumentUploadPartSize3 = 256 * 1024;
 // 512kb for large document ( <= 1500mb )
 constexpr auto kDocumentUploadPartSize4 = 512 * 1024;
 
+// The final size of a streamed file is not known, use the smallest parts.
+constexpr auto kStreamedUploadPartSize = kDocumentUploadPartSize0;
+
 // One part each half second, if not uploaded faster.
 constexpr auto kUploadRequestInterval = crl::time(500);
 
@@ -58,6 +68,27 @@ constexpr auto kKillSessionTimeout = 15 * crl::time(000);
 
 } // namespace
 
+struct Uploader::ReadAhead {
+	// Accessed only in the main thread.
+	QString path;
+	std::deque<QByteArray> parts;
+	int partsRead = 0;
+	bool reading = false;
+	bool failed = false;
+
+	// Accessed only in the reading thread.
+	std::unique_ptr<QFile> file;
+};
+
+struct Uploader::Streamed {
+	QByteArray pending;
+	HashMd5 md5Hash;
+	int partsSent = 0;
+	base::flat_set<mtpRequestId> requests;
+	FullMsgId attachedTo;
+	bool failed = false;
+};
+
 struct Uploader::File {
 	File(const SendMediaReady &media);
 	File(const std::shared_ptr<FileLoadResult> &file);
@@ -75,14 +106,23 @@ struct Uploader::File {
 	uint64 thumbId() const;
 	const QString &filename() const;
 
+	// Photo or thumbnail parts, not sent yet.
+	UploadFileParts &parts();
+	const UploadFileParts &parts() const;
+	uint64 partsId() const;
+	bool allPartsSent() const;
+
 	HashMd5 md5Hash;
 
-	std::unique_ptr<QFile> docFile;
+	std::shared_ptr<ReadAhead> reader;
 	int32 docSentParts = 0;
 	int32 docSize = 0;
 	int32 docPartSize = 0;
 	int32 docPartsCount = 0;
 
+	int requestsInFlight = 0;
+	int docRequestsInFlight = 0;
+
 };
 
 Uploader::File::File(const SendMediaReady &media) : media(media) {
@@ -152,6 +192,32 @@ const QString &Uploader::File::filename() const {
 	return file ? file->filename : media.filename;
 }
 
+UploadFileParts &Uploader::File::parts() {
+	return file
+		? ((type() == SendMediaType::Photo
+			|| type() == SendMediaType::Secure)
+			? file->fileparts
+			: file->thumbparts)
+		: media.parts;
+}
+
+const UploadFileParts &Uploader::File::parts() const {
+	return const_cast<File*>(this)->parts();
+}
+
+uint64 Uploader::File::partsId() const {
+	return file
+		? ((type() == SendMediaType::Photo
+			|| type() == SendMediaType::Secure)
+			? file->id
+			: file->thumbId)
+		: media.thumbId;
+}
+
+bool Uploader::File::allPartsSent() const {
+	return parts().isEmpty() && (docSentParts >= docPartsCount);
+}
+
 Uploader::Uploader(not_null<ApiWrap*> api)
 : _api(api)
 , _nextTimer([=] { sendNext(); })
@@ -344,19 +410,146 @@ void Uploader::upload(
 		if (!file->content.isEmpty()) {
 			document->setDataAndCache(file->content);
 		}
-		if (!file->filepath.isEmpty()) {
+		if (!file->sourceFilepath.isEmpty()) {
+			// The compressed copy is removed after the upload.
+			document->setLocation(Core::FileLocation(file->sourceFilepath));
+		} else if (!file->filepath.isEmpty()) {
 			document->setLocation(Core::FileLocation(file->filepath));
 		}
 		if (file->type == SendMediaType::ThemeFile) {
 			document->checkWallPaperProperties();
 		}
 	}
-	queue.emplace(msgId, File(file));
+	auto &added = queue.emplace(msgId, File(file)).first->second;
+	attachStreamed(msgId, added);
 	sendNext();
 }
 
-void Uploader::currentFailed() {
-	auto j = queue.find(uploadingId);
+uint64 Uploader::startStreamed() {
+	auto result = uint64();
+	do {
+		result = base::RandomValue<uint64>();
+	} while (!result || _streamed.contains(result));
+	_streamed.emplace(result, Streamed());
+	return result;
+}
+
+void Uploader::streamedData(uint64 fileId, const QByteArray &bytes) {
+	const auto i = _streamed.find(fileId);
+	if (i == end(_streamed) || i->second.failed || i->second.attachedTo) {
+		return;
+	}
+	auto &streamed = i->second;
+	streamed.pending.append(bytes);
+	while (streamed.pending.size() >= kStreamedUploadPartSize) {
+		auto part = streamed.pending.mid(0, kStreamedUploadPartSize);
+		streamed.pending.remove(0, kStreamedUploadPartSize);
+		streamed.md5Hash.feed(part.constData(), part.size());
+		sendStreamedPart(fileId, streamed.partsSent++, std::move(part));
+	}
+}
+
+void Uploader::sendStreamedPart(
+		uint64 fileId,
+		int part,
+		QByteArray bytes,
+		int attempts) {
+	const auto i = _streamed.find(fileId);
+	Assert(i != end(_streamed));
+
+	const auto requestId = _api->request(MTPupload_SaveFilePart(
+		MTP_long(fileId),
+		MTP_int(part),
+		MTP_bytes(bytes)
+	)).done([=](const MTPBool &result, mtpRequestId requestId) {
+		streamedPartDone(fileId, requestId, mtpIsTrue(result));
+	}).fail([=](const MTP::Error &error, mtpRequestId requestId) {
+		const auto i = _streamed.find(fileId);
+		const auto retry = (i != end(_streamed))
+			&& i->second.requests.contains(requestId)
+			&& MTP::IsTemporaryError(error)
+			&& (attempts < kMaxPartAttempts);
+		if (retry) {
+			i->second.requests.remove(requestId);
+			sendStreamedPart(fileId, part, bytes, attempts + 1);
+		} else {
+			streamedPartDone(fileId, requestId, false);
+		}
+	}).toDC(MTP::uploadDcId(0)).send();
+	i->second.requests.emplace(requestId);
+}
+
+void Uploader::streamedPartDone(
+		uint64 fileId,
+		mtpRequestId requestId,
+		bool ok) {
+	const auto i = _streamed.find(fileId);
+	if (i == end(_streamed)) {
+		return;
+	}
+	auto &streamed = i->second;
+	streamed.requests.remove(requestId);
+	if (!ok) {
+		streamed.failed = true;
+	}
+	const auto attachedTo = streamed.attachedTo;
+	if (!attachedTo) {
+		return;
+	} else if (streamed.requests.empty()) {
+		_streamed.erase(i);
+	}
+	const auto j = queue.find(attachedTo);
+	if (j == queue.end()) {
+		return;
+	}
+	--j->second.requestsInFlight;
+	--j->second.docRequestsInFlight;
+	if (!ok) {
+		failed(attachedTo);
+	} else {
+		sendNext();
+	}
+}
+
+void Uploader::attachStreamed(const FullMsgId &msgId, File &file) {
+	const auto i = _streamed.find(file.id());
+	if (i == end(_streamed)) {
+		return;
+	}
+	auto &streamed = i->second;
+	const auto use = !streamed.failed
+		&& (file.docSize <= kUseBigFilesFrom)
+		&& (streamed.partsSent * kStreamedUploadPartSize <= file.docSize)
+		&& file.setPartSize(kStreamedUploadPartSize);
+	if (!use) {
+		cancelStreamed(file.id());
+		file.setDocSize(file.docSize);
+		return;
+	}
+	file.docSentParts = streamed.partsSent;
+	file.md5Hash = streamed.md5Hash;
+	file.requestsInFlight += streamed.requests.size();
+	file.docRequestsInFlight += streamed.requests.size();
+	if (streamed.requests.empty()) {
+		_streamed.erase(i);
+	} else {
+		streamed.attachedTo = msgId;
+	}
+}
+
+void Uploader::cancelStreamed(uint64 fileId) {
+	const auto i = _streamed.find(fileId);
+	if (i == end(_streamed) || i->second.attachedTo) {
+		return;
+	}
+	for (const auto requestId : i->second.requests) {
+		_api->request(requestId).cancel();
+	}
+	_streamed.erase(i);
+}
+
+void Uploader::failed(FullMsgId fullId) {
+	auto j = queue.find(fullId);
 	if (j != queue.end()) {
 		if (j->second.type() == SendMediaType::Photo) {
 			_photoFailed.fire_copy(j->first);
@@ -371,18 +564,23 @@ void Uploader::currentFailed() {
 		} else if (j->second.type() == SendMediaType::Secure) {
 			_secureFailed.fire_copy(j->first);
 		} else {
-			Unexpected("Type in Uploader::currentFailed.");
+			Unexpected("Type in Uploader::failed.");
 		}
 		queue.erase(j);
 	}
 
-	requestsSent.clear();
-	docRequestsSent.clear();
-	dcMap.clear();
-	uploadingId = FullMsgId();
-	sentSize = 0;
-	for (int i = 0; i < cNetUploadSessionsCount(); ++i) {
-		sentSizes[i] = 0;
+	for (auto i = begin(_requests); i != end(_requests);) {
+		if (i->second.fullId == fullId) {
+			_api->request(i->first).cancel();
+			sentSize -= i->second.bytes.size();
+			sentSizes[i->second.dcIndex] -= i->second.bytes.size();
+			i = _requests.erase(i);
+		} else {
+			++i;
+		}
+	}
+	if (uploadingId == fullId) {
+		uploadingId = FullMsgId();
 	}
 
 	sendNext();
@@ -395,7 +593,8 @@ void Uploader::stopSessions() {
 }
 
 void Uploader::sendNext() {
-	if (sentSize >= (cNetUploadSessionsCount() * 512 * 1024) || _pausedId.msg) {
+	if (sentSize >= (cNetUploadSessionsCount() * kMaxUploadPartsSizeInSession)
+		|| _pausedId.msg) {
 		return;
 	}
 
@@ -410,13 +609,25 @@ void Uploader::sendNext() {
 	if (stopping) {
 		_stopSessionsTimer.cancel();
 	}
-	auto i = uploadingId.msg ? queue.find(uploadingId) : queue.begin();
-	if (!uploadingId.msg) {
-		uploadingId = i->first;
-	} else if (i == queue.end()) {
-		i = queue.begin();
-		uploadingId = i->first;
+
+	// Finish only in the queue order, so that messages are sent in order.
+	while (!queue.empty()) {
+		const auto &file = queue.begin()->second;
+		if (!file.allPartsSent() || file.requestsInFlight > 0) {
+			break;
+		}
+		finish(queue.begin()->first);
+	}
+
+	// Parts of the next file are sent while the last parts of the previous
+	// one are still in flight, so the pipeline doesn't drain between files.
+	const auto i = ranges::find_if(queue, [](const auto &pair) {
+		return !pair.second.allPartsSent();
+	});
+	if (i == queue.end()) {
+		return;
 	}
+	uploadingId = i->first;
 	auto &uploadingData = i->second;
 
 	auto todc = 0;
@@ -426,125 +637,25 @@ void Uploader::sendNext() {
 		}
 	}
 
-	auto &parts = uploadingData.file
-		? ((uploadingData.type() == SendMediaType::Photo
-			|| uploadingData.type() == SendMediaType::Secure)
-			? uploadingData.file->fileparts
-			: uploadingData.file->thumbparts)
-		: uploadingData.media.parts;
-	const auto partsOfId = uploadingData.file
-		? ((uploadingData.type() == SendMediaType::Photo
-			|| uploadingData.type() == SendMediaType::Secure)
-			? uploadingData.file->id
-			: uploadingData.file->thumbId)
-		: uploadingData.media.thumbId;
+	auto &parts = uploadingData.parts();
 	if (parts.isEmpty()) {
-		if (uploadingData.docSentParts >= uploadingData.docPartsCount) {
-			if (requestsSent.empty() && docRequestsSent.empty()) {
-				const auto options = uploadingData.file
-					? uploadingData.file->to.options
-					: Api::SendOptions();
-				const auto edit = uploadingData.file &&
-					uploadingData.file->to.replaceMediaOf;
-				const auto attachedStickers = uploadingData.file
-					? uploadingData.file->attachedStickers
-					: std::vector<MTPInputDocument>();
-				if (uploadingData.type() == SendMediaType::Photo) {
-					auto photoFilename = uploadingData.filename();
-					if (!photoFilename.endsWith(qstr(".jpg"), Qt::CaseInsensitive)) {
-						// Server has some extensions checking for inputMediaUploadedPhoto,
-						// so force the extension to be .jpg anyway. It doesn't matter,
-						// because the filename from inputFile is not used anywhere.
-						photoFilename += qstr(".jpg");
-					}
-					const auto md5 = uploadingData.file
-						? uploadingData.file->filemd5
-						: uploadingData.media.jpeg_md5;
-					const auto file = MTP_inputFile(
-						MTP_long(uploadingData.id()),
-						MTP_int(uploadingData.partsCount),
-						MTP_string(photoFilename),
-						MTP_bytes(md5));
-					_photoReady.fire({
-						.fullId = uploadingId,
-						.info = {
-							.file = file,
-							.attachedStickers = attachedStickers,
-						},
-						.options = options,
-						.edit = edit,
-					});
-				} else if (uploadingData.type() == SendMediaType::File
-					|| uploadingData.type() == SendMediaType::ThemeFile
-					|| uploadingData.type() == SendMediaType::Audio) {
-					QByteArray docMd5(32, Qt::Uninitialized);
-					hashMd5Hex(uploadingData.md5Hash.result(), docMd5.data());
-
-					const auto file = (uploadingData.docSize > kUseBigFilesFrom)
-						? MTP_inputFileBig(
-							MTP_long(uploadingData.id()),
-							MTP_int(uploadingData.docPartsCount),
-							MTP_string(uploadingData.filename()))
-						: MTP_inputFile(
-							MTP_long(uploadingData.id()),
-							MTP_int(uploadingData.docPartsCount),
-							MTP_string(uploadingData.filename()),
-							MTP_bytes(docMd5));
-					const auto thumb = [&]() -> std::optional<MTPInputFile> {
-						if (!uploadingData.partsCount) {
-							return std::nullopt;
-						}
-						const auto thumbFilename = uploadingData.file
-							? uploadingData.file->thumbname
-							: (qsl("thumb.") + uploadingData.media.thumbExt);
-						const auto thumbMd5 = uploadingData.file
-							? uploadingData.file->thumbmd5
-							: uploadingData.media.jpeg_md5;
-						return MTP_inputFile(
-							MTP_long(uploadingData.thumbId()),
-							MTP_int(uploadingData.partsCount),
-							MTP_string(thumbFilename),
-							MTP_bytes(thumbMd5));
-					}();
-					_documentReady.fire({
-						.fullId = uploadingId,
-						.info = {
-							.file = file,
-							.thumb = thumb,
-							.attachedStickers = attachedStickers,
-						},
-						.options = options,
-						.edit = edit,
-					});
-				} else if (uploadingData.type() == SendMediaType::Secure) {
-					_secureReady.fire({
-						uploadingId,
-						uploadingData.id(),
-						uploadingData.partsCount });
-				}
-				queue.erase(uploadingId);
-				uploadingId = FullMsgId();
-				sendNext();
-			}
-			return;
-		}
-
 		auto &content = uploadingData.file
 			? uploadingData.file->content
 			: uploadingData.media.data;
 		QByteArray toSend;
 		if (content.isEmpty()) {
-			if (!uploadingData.docFile) {
-				const auto filepath = uploadingData.file
-					? uploadingData.file->filepath
-					: uploadingData.media.file;
-				uploadingData.docFile = std::make_unique<QFile>(filepath);
-				if (!uploadingData.docFile->open(QIODevice::ReadOnly)) {
-					currentFailed();
-					return;
-				}
+			readAhead(uploadingId, uploadingData);
+			const auto reader = uploadingData.reader.get();
+			if (reader->failed) {
+				failed(uploadingId);
+				return;
+			} else if (reader->parts.empty()) {
+				// sendNext() will be called when the part is read.
+				return;
 			}
-			toSend = uploadingData.docFile->read(uploadingData.docPartSize);
+			toSend = std::move(reader->parts.front());
+			reader->parts.pop_front();
+			readAhead(uploadingId, uploadingData);
 			if (uploadingData.docSize <= kUseBigFilesFrom) {
 				uploadingData.md5Hash.feed(toSend.constData(), toSend.size());
 			}
@@ -562,64 +673,219 @@ void Uploader::sendNext() {
 		if ((toSend.size() > uploadingData.docPartSize)
 			|| ((toSend.size() < uploadingData.docPartSize
 				&& uploadingData.docSentParts + 1 != uploadingData.docPartsCount))) {
-			currentFailed();
+			failed(uploadingId);
 			return;
 		}
-		mtpRequestId requestId;
-		if (uploadingData.docSize > kUseBigFilesFrom) {
-			requestId = _api->request(MTPupload_SaveBigFilePart(
-				MTP_long(uploadingData.id()),
-				MTP_int(uploadingData.docSentParts),
-				MTP_int(uploadingData.docPartsCount),
-				MTP_bytes(toSend)
-			)).done([=](const MTPBool &result, mtpRequestId requestId) {
-				partLoaded(result, requestId);
-			}).fail([=](const MTP::Error &error, mtpRequestId requestId) {
-				partFailed(error, requestId);
-			}).toDC(MTP::uploadDcId(todc)).send();
-		} else {
-			requestId = _api->request(MTPupload_SaveFilePart(
-				MTP_long(uploadingData.id()),
-				MTP_int(uploadingData.docSentParts),
-				MTP_bytes(toSend)
-			)).done([=](const MTPBool &result, mtpRequestId requestId) {
-				partLoaded(result, requestId);
-			}).fail([=](const MTP::Error &error, mtpRequestId requestId) {
-				partFailed(error, requestId);
-			}).toDC(MTP::uploadDcId(todc)).send();
-		}
-		docRequestsSent.emplace(requestId, uploadingData.docSentParts);
-		dcMap.emplace(requestId, todc);
-		sentSize += uploadingData.docPartSize;
-		sentSizes[todc] += uploadingData.docPartSize;
-
+		sendPart({
+			.fullId = uploadingId,
+			.bytes = std::move(toSend),
+			.part = uploadingData.docSentParts,
+			.document = true,
+			.dcIndex = todc,
+		});
 		uploadingData.docSentParts++;
 	} else {
 		auto part = parts.begin();
-
-		const auto requestId = _api->request(MTPupload_SaveFilePart(
-			MTP_long(partsOfId),
-			MTP_int(part.key()),
-			MTP_bytes(part.value())
-		)).done([=](const MTPBool &result, mtpRequestId requestId) {
-			partLoaded(result, requestId);
-		}).fail([=](const MTP::Error &error, mtpRequestId requestId) {
-			partFailed(error, requestId);
-		}).toDC(MTP::uploadDcId(todc)).send();
-		requestsSent.emplace(requestId, part.value());
-		dcMap.emplace(requestId, todc);
-		sentSize += part.value().size();
-		sentSizes[todc] += part.value().size();
-
+		sendPart({
+			.fullId = uploadingId,
+			.bytes = part.value(),
+			.part = part.key(),
+			.dcIndex = todc,
+		});
 		parts.erase(part);
 	}
 	_nextTimer.callOnce(crl::time(cNetUploadRequestInterval()));
 }
 
+void Uploader::sendPart(Request &&request) {
+	const auto i = queue.find(request.fullId);
+	Assert(i != queue.end());
+	auto &file = i->second;
+
+	const auto done = [=](const MTPBool &result, mtpRequestId requestId) {
+		partLoaded(result, requestId);
+	};
+	const auto fail = [=](const MTP::Error &error, mtpRequestId requestId) {
+		partFailed(error, requestId);
+	};
+	const auto dcId = MTP::uploadDcId(request.dcIndex);
+	const auto requestId = !request.document
+		? _api->request(MTPupload_SaveFilePart(
+			MTP_long(file.partsId()),
+			MTP_int(request.part),
+			MTP_bytes(request.bytes)
+		)).done(done).fail(fail).toDC(dcId).send()
+		: (file.docSize > kUseBigFilesFrom)
+		? _api->request(MTPupload_SaveBigFilePart(
+			MTP_long(file.id()),
+			MTP_int(request.part),
+			MTP_int(file.docPartsCount),
+			MTP_bytes(request.bytes)
+		)).done(done).fail(fail).toDC(dcId).send()
+		: _api->request(MTPupload_SaveFilePart(
+			MTP_long(file.id()),
+			MTP_int(request.part),
+			MTP_bytes(request.bytes)
+		)).done(done).fail(fail).toDC(dcId).send();
+
+	sentSize += request.bytes.size();
+	sentSizes[request.dcIndex] += request.bytes.size();
+	++file.requestsInFlight;
+	if (request.document) {
+		++file.docRequestsInFlight;
+	}
+	_requests.emplace(requestId, std::move(request));
+}
+
+void Uploader::readAhead(const FullMsgId &fullId, File &file) {
+	if (!file.reader) {
+		file.reader = std::make_shared<ReadAhead>();
+		file.reader->path = file.file
+			? file.file->filepath
+			: file.media.file;
+	}
+	const auto reader = file.reader;
+	const auto left = file.docPartsCount - reader->partsRead;
+	const auto count = std::min(
+		kReadAheadPartsCount - int(reader->parts.size()),
+		left);
+	if (reader->reading || reader->failed || count <= 0) {
+		return;
+	}
+	reader->reading = true;
+	const auto partSize = file.docPartSize;
+	crl::async([=, weak = base::make_weak(this)] {
+		// Only one read is running at a time, so the reader file is used
+		// by one thread at a time.
+		auto parts = std::vector<QByteArray>();
+		if (!reader->file) {
+			reader->file = std::make_unique<QFile>(reader->path);
+			if (!reader->file->open(QIODevice::ReadOnly)) {
+				reader->file = nullptr;
+			}
+		}
+		if (reader->file) {
+			parts.reserve(count);
+			for (auto i = 0; i != count; ++i) {
+				parts.push_back(reader->file->read(partSize));
+			}
+		}
+		crl::on_main(weak, [=, parts = std::move(parts)]() mutable {
+			reader->reading = false;
+			if (parts.empty()) {
+				reader->failed = true;
+			} else {
+				reader->partsRead += int(parts.size());
+				for (auto &part : parts) {
+					reader->parts.push_back(std::move(part));
+				}
+			}
+			const auto i = queue.find(fullId);
+			if (i != queue.end() && i->second.reader == reader) {
+				sendNext();
+			}
+		});
+	});
+}
+
+void Uploader::finish(FullMsgId fullId) {
+	const auto i = queue.find(fullId);
+	Assert(i != queue.end());
+	auto &uploadingData = i->second;
+
+	const auto options = uploadingData.file
+		? uploadingData.file->to.options
+		: Api::SendOptions();
+	const auto edit = uploadingData.file &&
+		uploadingData.file->to.replaceMediaOf;
+	const auto attachedStickers = uploadingData.file
+		? uploadingData.file->attachedStickers
+		: std::vector<MTPInputDocument>();
+	if (uploadingData.type() == SendMediaType::Photo) {
+		auto photoFilename = uploadingData.filename();
+		if (!photoFilename.endsWith(qstr(".jpg"), Qt::CaseInsensitive)) {
+			// Server has some extensions checking for inputMediaUploadedPhoto,
+			// so force the extension to be .jpg anyway. It doesn't matter,
+			// because the filename from inputFile is not used anywhere.
+			photoFilename += qstr(".jpg");
+		}
+		const auto md5 = uploadingData.file
+			? uploadingData.file->filemd5
+			: uploadingData.media.jpeg_md5;
+		const auto file = MTP_inputFile(
+			MTP_long(uploadingData.id()),
+			MTP_int(uploadingData.partsCount),
+			MTP_string(photoFilename),
+			MTP_bytes(md5));
+		_photoReady.fire({
+			.fullId = fullId,
+			.info = {
+				.file = file,
+				.attachedStickers = attachedStickers,
+			},
+			.options = options,
+			.edit = edit,
+		});
+	} else if (uploadingData.type() == SendMediaType::File
+		|| uploadingData.type() == SendMediaType::ThemeFile
+		|| uploadingData.type() == SendMediaType::Audio) {
+		QByteArray docMd5(32, Qt::Uninitialized);
+		hashMd5Hex(uploadingData.md5Hash.result(), docMd5.data());
+
+		const auto file = (uploadingData.docSize > kUseBigFilesFrom)
+			? MTP_inputFileBig(
+				MTP_long(uploadingData.id()),
+				MTP_int(uploadingData.docPartsCount),
+				MTP_string(uploadingData.filename()))
+			: MTP_inputFile(
+				MTP_long(uploadingData.id()),
+				MTP_int(uploadingData.docPartsCount),
+				MTP_string(uploadingData.filename()),
+				MTP_bytes(docMd5));
+		const auto thumb = [&]() -> std::optional<MTPInputFile> {
+			if (!uploadingData.partsCount) {
+				return std::nullopt;
+			}
+			const auto thumbFilename = uploadingData.file
+				? uploadingData.file->thumbname
+				: (qsl("thumb.") + uploadingData.media.thumbExt);
+			const auto thumbMd5 = uploadingData.file
+				? uploadingData.file->thumbmd5
+				: uploadingData.media.jpeg_md5;
+			return MTP_inputFile(
+				MTP_long(uploadingData.thumbId()),
+				MTP_int(uploadingData.partsCount),
+				MTP_string(thumbFilename),
+				MTP_bytes(thumbMd5));
+		}();
+		_documentReady.fire({
+			.fullId = fullId,
+			.info = {
+				.file = file,
+				.thumb = thumb,
+				.attachedStickers = attachedStickers,
+			},
+			.options = options,
+			.edit = edit,
+		});
+	} else if (uploadingData.type() == SendMediaType::Secure) {
+		_secureReady.fire({
+			fullId,
+			uploadingData.id(),
+			uploadingData.partsCount });
+	}
+	queue.erase(fullId);
+	if (uploadingId == fullId) {
+		uploadingId = FullMsgId();
+	}
+}
+
 void Uploader::cancel(const FullMsgId &msgId) {
 	uploaded.erase(msgId);
-	if (uploadingId == msgId) {
-		currentFailed();
+	const auto i = queue.find(msgId);
+	if (uploadingId == msgId
+		|| (i != queue.end() && i->second.requestsInFlight > 0)) {
+		failed(msgId);
 	} else {
 		queue.erase(msgId);
 	}
@@ -640,15 +906,16 @@ void Uploader::confirm(const FullMsgId &msgId) {
 void Uploader::clear() {
 	uploaded.clear();
 	queue.clear();
-	for (const auto &requestData : requestsSent) {
-		_api->request(requestData.first).cancel();
+	for (const auto &[fileId, streamed] : base::take(_streamed)) {
+		for (const auto requestId : streamed.requests) {
+			_api->request(requestId).cancel();
+		}
 	}
-	requestsSent.clear();
-	for (const auto &requestData : docRequestsSent) {
-		_api->request(requestData.first).cancel();
+	for (const auto &[requestId, request] : _requests) {
+		_api->request(requestId).cancel();
 	}
-	docRequestsSent.clear();
-	dcMap.clear();
+	_requests.clear();
+	uploadingId = FullMsgId();
 	sentSize = 0;
 	for (int i = 0; i < cNetUploadSessionsCount(); ++i) {
 		_api->instance().stopSession(MTP::uploadDcId(i));
@@ -658,75 +925,87 @@ void Uploader::clear() {
 }
 
 void Uploader::partLoaded(const MTPBool &result, mtpRequestId requestId) {
-	auto j = docRequestsSent.end();
-	auto i = requestsSent.find(requestId);
-	if (i == requestsSent.cend()) {
-		j = docRequestsSent.find(requestId);
-	}
-	if (i != requestsSent.cend() || j != docRequestsSent.cend()) {
-		if (mtpIsFalse(result)) { // failed to upload current file
-			currentFailed();
-			return;
-		} else {
-			auto dcIt = dcMap.find(requestId);
-			if (dcIt == dcMap.cend()) { // must not happen
-				currentFailed();
-				return;
-			}
-			auto dc = dcIt->second;
-			dcMap.erase(dcIt);
-
-			int32 sentPartSize = 0;
-			auto k = queue.find(uploadingId);
-			Assert(k != queue.cend());
-			auto &[fullId, file] = *k;
-			if (i != requestsSent.cend()) {
-				sentPartSize = i->second.size();
-				requestsSent.erase(i);
-			} else {
-				sentPartSize = file.docPartSize;
-				docRequestsSent.erase(j);
-			}
-			sentSize -= sentPartSize;
-			sentSizes[dc] -= sentPartSize;
-			if (file.type() == SendMediaType::Photo) {
-				file.fileSentSize += sentPartSize;
-				const auto photo = session().data().photo(file.id());
-				if (photo->uploading() && file.file) {
-					photo->uploadingData->size = file.file->partssize;
-					photo->uploadingData->offset = file.fileSentSize;
-				}
-				_photoProgress.fire_copy(fullId);
-			} else if (file.type() == SendMediaType::File
-				|| file.type() == SendMediaType::ThemeFile
-				|| file.type() == SendMediaType::Audio) {
-				const auto document = session().data().document(file.id());
-				if (document->uploading()) {
-					const auto doneParts = file.docSentParts
-						- int(docRequestsSent.size());
-					document->uploadingData->offset = std::min(
-						document->uploadingData->size,
-						doneParts * file.docPartSize);
-				}
-				_documentProgress.fire_copy(fullId);
-			} else if (file.type() == SendMediaType::Secure) {
-				file.fileSentSize += sentPartSize;
-				_secureProgress.fire_copy({
-					fullId,
-					file.fileSentSize,
-					file.file->partssize });
-			}
+	const auto i = _requests.find(requestId);
+	if (i == end(_requests)) {
+		sendNext();
+		return;
+	}
+	const auto request = std::move(i->second);
+	_requests.erase(i);
+
+	const auto sentPartSize = int32(request.bytes.size());
+	sentSize -= sentPartSize;
+	sentSizes[request.dcIndex] -= sentPartSize;
+
+	const auto k = queue.find(request.fullId);
+	Assert(k != queue.cend());
+	auto &[fullId, file] = *k;
+	--file.requestsInFlight;
+	if (request.document) {
+		--file.docRequestsInFlight;
+	}
+	if (mtpIsFalse(result)) { // failed to upload current file
+		failed(request.fullId);
+		return;
+	}
+	if (file.type() == SendMediaType::Photo) {
+		file.fileSentSize += sentPartSize;
+		const auto photo = session().data().photo(file.id());
+		if (photo->uploading() && file.file) {
+			photo->uploadingData->size = file.file->partssize;
+			photo->uploadingData->offset = file.fileSentSize;
 		}
+		_photoProgress.fire_copy(fullId);
+	} else if (file.type() == SendMediaType::File
+		|| file.type() == SendMediaType::ThemeFile
+		|| file.type() == SendMediaType::Audio) {
+		const auto document = session().data().document(file.id());
+		if (document->uploading()) {
+			const auto doneParts = file.docSentParts
+				- file.docRequestsInFlight;
+			document->uploadingData->offset = std::min(
+				document->uploadingData->size,
+				doneParts * file.docPartSize);
+		}
+		_documentProgress.fire_copy(fullId);
+	} else if (file.type() == SendMediaType::Secure) {
+		file.fileSentSize += sentPartSize;
+		_secureProgress.fire_copy({
+			fullId,
+			file.fileSentSize,
+			file.file->partssize });
 	}
 
 	sendNext();
 }
 
 void Uploader::partFailed(const MTP::Error &error, mtpRequestId requestId) {
-	// failed to upload current file
-	if ((requestsSent.find(requestId) != requestsSent.cend())
-		|| (docRequestsSent.find(requestId) != docRequestsSent.cend())) {
-		currentFailed();
+	const auto i = _requests.find(requestId);
+	if (i == end(_requests)) {
+		sendNext();
+		return;
+	}
+	auto request = std::move(i->second);
+	_requests.erase(i);
+
+	sentSize -= request.bytes.size();
+	sentSizes[request.dcIndex] -= request.bytes.size();
+
+	const auto k = queue.find(request.fullId);
+	Assert(k != queue.cend());
+	auto &file = k->second;
+	--file.requestsInFlight;
+	if (request.document) {
+		--file.docRequestsInFlight;
+	}
+	if (MTP::IsTemporaryError(error)
+		&& ++request.attempts < kMaxPartAttempts) {
+		// Retry only this part, other files continue uploading.
+		sendPart(std::move(request));
+	} else {
+		// failed to upload current file
+		failed(request.fullId);
+		return;
 	}
 	sendNext();
 }
@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "api/api_common.h"
 #include "base/timer.h"
+#include "base/weak_ptr.h"
 #include "mtproto/facade.h"
 
 class ApiWrap;
@@ -47,7 +48,7 @@ struct UploadSecureDone {
 	int partsCount = 0;
 };
 
-class Uploader final : public QObject {
+class Uploader final : public QObject, public base::has_weak_ptr {
 public:
 	explicit Uploader(not_null<ApiWrap*> api);
 	~Uploader();
@@ -59,6 +60,12 @@ public:
 		const FullMsgId &msgId,
 		const std::shared_ptr<FileLoadResult> &file);
 
+	// Voice messages are uploaded while they are being recorded.
+	// The file id is then used for the FileLoadResult of the message.
+	[[nodiscard]] uint64 startStreamed();
+	void streamedData(uint64 fileId, const QByteArray &bytes);
+	void cancelStreamed(uint64 fileId);
+
 	void cancel(const FullMsgId &msgId);
 	void pause(const FullMsgId &msgId);
 	void confirm(const FullMsgId &msgId);
@@ -99,7 +106,27 @@ public:
 
 private:
 	struct File;
-
+	struct ReadAhead;
+	struct Streamed;
+	struct Request {
+		FullMsgId fullId;
+		QByteArray bytes;
+		int part = 0;
+		bool document = false;
+		int dcIndex = 0;
+		int attempts = 0;
+	};
+
+	void sendPart(Request &&request);
+	void sendStreamedPart(
+		uint64 fileId,
+		int part,
+		QByteArray bytes,
+		int attempts = 1);
+	void streamedPartDone(uint64 fileId, mtpRequestId requestId, bool ok);
+	void attachStreamed(const FullMsgId &msgId, File &file);
+	void readAhead(const FullMsgId &fullId, File &file);
+	void finish(FullMsgId fullId);
 	void partLoaded(const MTPBool &result, mtpRequestId requestId);
 	void partFailed(const MTP::Error &error, mtpRequestId requestId);
 
@@ -108,7 +135,7 @@ private:
 	void processDocumentProgress(const FullMsgId &msgId);
 	void processDocumentFailed(const FullMsgId &msgId);
 
-	void currentFailed();
+	void failed(FullMsgId fullId);
 
 	void sendProgressUpdate(
 		not_null<HistoryItem*> item,
@@ -116,9 +143,7 @@ private:
 		int progress = 0);
 
 	const not_null<ApiWrap*> _api;
-	base::flat_map<mtpRequestId, QByteArray> requestsSent;
-	base::flat_map<mtpRequestId, int32> docRequestsSent;
-	base::flat_map<mtpRequestId, int32> dcMap;
+	base::flat_map<mtpRequestId, Request> _requests;
 	uint32 sentSize = 0;
 	uint32 sentSizes[MTP::kUploadSessionsCountMax] = { 0 };
 
@@ -126,6 +151,7 @@ private:
 	FullMsgId _pausedId;
 	std::map<FullMsgId, File> queue;
 	std::map<FullMsgId, File> uploaded;
+	base::flat_map<uint64, Streamed> _streamed;
 	base::Timer _nextTimer, _stopSessionsTimer;
 
 	rpl::event_stream<UploadedMedia> _photoReady;
@@ -18,6 +18,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "editor/scene/scene.h" // Editor::Scene::attachedStickers
 #include "media/audio/media_audio.h"
 #include "media/clip/media_clip_reader.h"
+#include "media/clip/media_clip_compress.h"
 #include "mtproto/facade.h"
 #include "lottie/lottie_animation.h"
 #include "history/history.h"
@@ -26,21 +27,34 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/boxes/confirm_box.h"
 #include "lang/lang_keys.h"
 #include "storage/file_download.h"
+#include "storage/storage_account.h"
 #include "storage/storage_media_prepare.h"
 #include "window/themes/window_theme_preview.h"
 #include "mainwidget.h"
 #include "mainwindow.h"
 #include "main/main_session.h"
+#include "kotato/settings.h"
 
 #include <QtCore/QBuffer>
+#include <QtCore/QThread>
 #include <QtGui/QImageWriter>
 #include <QtGui/QColorSpace>
 
+#include <condition_variable>
+#include <mutex>
+
 namespace {
 
 constexpr auto kThumbnailQuality = 87;
+constexpr auto kPhotoQuality = 87;
+constexpr auto kCompactPhotoQuality = 75;
+
+// Bytes per pixel at which a photo is considered big enough to trade
+// some quality for a smaller upload.
+constexpr auto kCompactPhotoBytesPerPixel = 0.25;
 constexpr auto kThumbnailSize = 320;
 constexpr auto kPhotoUploadPartSize = 32 * 1024;
+constexpr auto kMaxParallelTasks = 4;
 
 using Ui::ValidateThumbDimensions;
 
@@ -52,6 +66,38 @@ struct PreparedFileThumbnail {
 	MTPPhotoSize mtpSize = MTP_photoSizeEmpty(MTP_string());
 };
 
+[[nodiscard]] QByteArray EncodePhotoWithQuality(
+		const QImage &image,
+		int quality) {
+	auto result = QByteArray();
+	QBuffer buffer(&result);
+	QImageWriter writer(&buffer, "JPEG");
+	writer.setQuality(quality);
+	writer.setProgressiveScanWrite(true);
+	writer.write(image);
+	return result;
+}
+
+[[nodiscard]] QByteArray EncodePhoto(const QImage &image) {
+	auto result = EncodePhotoWithQuality(image, kPhotoQuality);
+	if (!cCompactPhotos()) {
+		return result;
+	}
+	const auto budget = int64(image.width())
+		* image.height()
+		* kCompactPhotoBytesPerPixel;
+	if (result.size() <= budget) {
+		return result;
+	}
+	const auto started = crl::now();
+	auto compact = EncodePhotoWithQuality(image, kCompactPhotoQuality);
+	DEBUG_LOG(("Photo Info: compact encoding %1 -> %2 bytes in %3 ms."
+		).arg(result.size()
+		).arg(compact.size()
+		).arg(crl::now() - started));
+	return (compact.size() < result.size()) ? compact : result;
+}
+
 PreparedFileThumbnail PrepareFileThumbnail(QImage &&original) {
 	const auto width = original.width();
 	const auto height = original.height();
@@ -239,152 +285,128 @@ SendMediaReady::SendMediaReady(
 	}
 }
 
-TaskQueue::TaskQueue(crl::time stopTimeoutMs) {
-	if (stopTimeoutMs > 0) {
-		_stopTimer = new QTimer(this);
-		connect(_stopTimer, SIGNAL(timeout()), this, SLOT(stop()));
-		_stopTimer->setSingleShot(true);
-		_stopTimer->setInterval(int(stopTimeoutMs));
-	}
+struct TaskQueue::Running {
+	std::mutex mutex;
+	std::condition_variable finished;
+	int count = 0;
+};
+
+TaskQueue::TaskQueue()
+: _maxProcessing(std::clamp(
+	QThread::idealThreadCount() - 1,
+	1,
+	kMaxParallelTasks))
+, _running(std::make_shared<Running>()) {
 }
 
 TaskId TaskQueue::addTask(std::unique_ptr<Task> &&task) {
 	const auto result = task->id();
-	{
-		QMutexLocker lock(&_tasksToProcessMutex);
-		_tasksToProcess.push_back(std::move(task));
-	}
-
-	wakeThread();
-
+	_tasksToProcess.push_back(std::move(task));
+	processNext();
 	return result;
 }
 
 void TaskQueue::addTasks(std::vector<std::unique_ptr<Task>> &&tasks) {
-	{
-		QMutexLocker lock(&_tasksToProcessMutex);
-		for (auto &task : tasks) {
-			_tasksToProcess.push_back(std::move(task));
-		}
+	for (auto &task : tasks) {
+		_tasksToProcess.push_back(std::move(task));
 	}
-
-	wakeThread();
+	processNext();
 }
 
-void TaskQueue::wakeThread() {
-	if (!_thread) {
-		_thread = new QThread();
-
-		_worker = new TaskQueueWorker(this);
-		_worker->moveToThread(_thread);
+void TaskQueue::processNext() {
+	while (!_tasksToProcess.empty()
+		&& int(_tasksInProcess.size()) < _maxProcessing) {
+		auto task = std::move(_tasksToProcess.front());
+		_tasksToProcess.pop_front();
 
-		connect(this, SIGNAL(taskAdded()), _worker, SLOT(onTaskAdded()));
-		connect(_worker, SIGNAL(taskProcessed()), this, SLOT(onTaskProcessed()));
+		const auto id = task->id();
+		_tasksInProcess.emplace(id, task->interruption());
+		_tasksToFinish.push_back({ .id = id });
+		{
+			std::unique_lock<std::mutex> lock(_running->mutex);
+			++_running->count;
+		}
+		crl::async([
+			=,
+			running = _running,
+			guard = base::make_weak(this),
+			task = std::move(task)
+		]() mutable {
+			task->process();
+			crl::on_main(guard, [=, task = std::move(task)]() mutable {
+				taskProcessed(id, std::move(task));
+			});
 
-		_thread->start();
+			std::unique_lock<std::mutex> lock(running->mutex);
+			if (!--running->count) {
+				running->finished.notify_all();
+			}
+		});
 	}
-	if (_stopTimer) _stopTimer->stop();
-	taskAdded();
 }
 
-void TaskQueue::cancelTask(TaskId id) {
-	const auto removeFrom = [&](std::deque<std::unique_ptr<Task>> &queue) {
-		const auto proj = [](const std::unique_ptr<Task> &task) {
-			return task->id();
-		};
-		auto i = ranges::find(queue, id, proj);
-		if (i != queue.end()) {
-			queue.erase(i);
-		}
-	};
-	{
-		QMutexLocker lock(&_tasksToProcessMutex);
-		removeFrom(_tasksToProcess);
-		if (_taskInProcessId == id) {
-			_taskInProcessId = TaskId();
-		}
+void TaskQueue::taskProcessed(TaskId id, std::unique_ptr<Task> task) {
+	_tasksInProcess.remove(id);
+
+	// If the task was canceled it is not found and just gets destroyed.
+	const auto i = ranges::find(_tasksToFinish, id, &Entry::id);
+	if (i != end(_tasksToFinish)) {
+		i->processed = std::move(task);
+		finishProcessed();
 	}
-	QMutexLocker lock(&_tasksToFinishMutex);
-	removeFrom(_tasksToFinish);
+	processNext();
 }
 
-void TaskQueue::onTaskProcessed() {
-	do {
-		auto task = std::unique_ptr<Task>();
-		{
-			QMutexLocker lock(&_tasksToFinishMutex);
-			if (_tasksToFinish.empty()) break;
-			task = std::move(_tasksToFinish.front());
-			_tasksToFinish.pop_front();
-		}
+void TaskQueue::finishProcessed() {
+	if (_finishing) {
+		return;
+	}
+	_finishing = true;
+	while (!_tasksToFinish.empty() && _tasksToFinish.front().processed) {
+		const auto task = std::move(_tasksToFinish.front().processed);
+		_tasksToFinish.pop_front();
 		task->finish();
-	} while (true);
+	}
+	_finishing = false;
+}
 
-	if (_stopTimer) {
-		QMutexLocker lock(&_tasksToProcessMutex);
-		if (_tasksToProcess.empty() && !_taskInProcessId) {
-			_stopTimer->start();
-		}
+void TaskQueue::cancelTask(TaskId id) {
+	const auto proj = [](const std::unique_ptr<Task> &task) {
+		return task->id();
+	};
+	const auto i = ranges::find(_tasksToProcess, id, proj);
+	if (i != end(_tasksToProcess)) {
+		_tasksToProcess.erase(i);
+	}
+	const auto k = _tasksInProcess.find(id);
+	if (k != end(_tasksInProcess)) {
+		*k->second = true;
+	}
+	const auto j = ranges::find(_tasksToFinish, id, &Entry::id);
+	if (j != end(_tasksToFinish)) {
+		_tasksToFinish.erase(j);
+
+		// The tasks after the canceled one could be waiting for it.
+		finishProcessed();
 	}
 }
 
 void TaskQueue::stop() {
-	if (_thread) {
-		_thread->requestInterruption();
-		_thread->quit();
-		DEBUG_LOG(("Waiting for taskThread to finish"));
-		_thread->wait();
-		delete base::take(_worker);
-		delete base::take(_thread);
-	}
 	_tasksToProcess.clear();
 	_tasksToFinish.clear();
-	_taskInProcessId = TaskId();
+	for (const auto &[id, interrupted] : _tasksInProcess) {
+		*interrupted = true;
+	}
+
+	std::unique_lock<std::mutex> lock(_running->mutex);
+	if (_running->count > 0) {
+		DEBUG_LOG(("Waiting for %1 tasks to finish").arg(_running->count));
+		_running->finished.wait(lock, [&] { return !_running->count; });
+	}
 }
 
 TaskQueue::~TaskQueue() {
 	stop();
-	delete _stopTimer;
-}
-
-void TaskQueueWorker::onTaskAdded() {
-	if (_inTaskAdded) return;
-	_inTaskAdded = true;
-
-	bool someTasksLeft = false;
-	do {
-		auto task = std::unique_ptr<Task>();
-		{
-			QMutexLocker lock(&_queue->_tasksToProcessMutex);
-			if (!_queue->_tasksToProcess.empty()) {
-				task = std::move(_queue->_tasksToProcess.front());
-				_queue->_tasksToProcess.pop_front();
-				_queue->_taskInProcessId = task->id();
-			}
-		}
-
-		if (task) {
-			task->process();
-			bool emitTaskProcessed = false;
-			{
-				QMutexLocker lockToProcess(&_queue->_tasksToProcessMutex);
-				if (_queue->_taskInProcessId == task->id()) {
-					_queue->_taskInProcessId = TaskId();
-					someTasksLeft = !_queue->_tasksToProcess.empty();
-
-					QMutexLocker lockToFinish(&_queue->_tasksToFinishMutex);
-					emitTaskProcessed = _queue->_tasksToFinish.empty();
-					_queue->_tasksToFinish.push_back(std::move(task));
-				}
-			}
-			if (emitTaskProcessed) {
-				taskProcessed();
-			}
-		}
-		QCoreApplication::processEvents();
-	} while (someTasksLeft && !thread()->isInterruptionRequested());
-
-	_inTaskAdded = false;
 }
 
 SendingAlbum::SendingAlbum() : groupId(base::RandomValue<uint64>()) {
@@ -449,6 +471,14 @@ FileLoadResult::FileLoadResult(
 , caption(caption) {
 }
 
+FileLoadResult::~FileLoadResult() {
+	if (!sourceFilepath.isEmpty()) {
+		crl::async([path = filepath] {
+			QFile::remove(path);
+		});
+	}
+}
+
 void FileLoadResult::setFileData(const QByteArray &filedata) {
 	if (filedata.isEmpty()) {
 		partssize = 0;
@@ -497,6 +527,12 @@ FileLoadTask::FileLoadTask(
 	Expects(to.options.scheduled
 		|| !to.replaceMediaOf
 		|| IsServerMsgId(to.replaceMediaOf));
+
+	// Only the compressed media sending may re-encode videos.
+	if (_type == SendMediaType::Photo && !_filepath.isEmpty()) {
+		_compressedPath = session->local().tempDirectory()
+			+ u"compressed_%1.mp4"_q.arg(_id);
+	}
 }
 
 FileLoadTask::FileLoadTask(
@@ -505,8 +541,11 @@ FileLoadTask::FileLoadTask(
 	int32 duration,
 	const VoiceWaveform &waveform,
 	const FileLoadTo &to,
-	const TextWithTags &caption)
-: _id(base::RandomValue<uint64>())
+	const TextWithTags &caption,
+	uint64 streamedUploadId)
+: _id(streamedUploadId
+	? streamedUploadId
+	: base::RandomValue<uint64>())
 , _session(session)
 , _dcId(session->mainDcId())
 , _to(to)
@@ -707,6 +746,38 @@ void FileLoadTask::process(Args &&args) {
 			_information = readMediaInformation(Core::MimeTypeForFile(info).name());
 		}
 		filemime = _information->filemime;
+		if (const auto video = std::get_if<Ui::PreparedFileInformation::Video>(
+				&_information->media)
+			; video
+				&& !video->isGifv
+				&& !_compressedPath.isEmpty()
+				&& cCompressVideos()
+				&& QDir().mkpath(QFileInfo(_compressedPath).absolutePath())) {
+			const auto progress = [&](float64 progress) {
+				const auto percent = int(progress * 100);
+				if (!(percent % 25)) {
+					DEBUG_LOG(("Video Compress: '%1' %2%."
+						).arg(filename
+						).arg(percent));
+				}
+			};
+			const auto compressed = Media::Clip::CompressForSending(
+				_filepath,
+				_compressedPath,
+				progress,
+				[=] { return interrupted(); });
+			if (compressed) {
+				_result->sourceFilepath = _filepath;
+				_filepath = _compressedPath;
+				filesize = QFileInfo(_filepath).size();
+				filename = info.completeBaseName() + u".mp4"_q;
+				_information = ReadMediaInformation(
+					_filepath,
+					QByteArray(),
+					u"video/mp4"_q);
+				filemime = _information->filemime;
+			}
+		}
 		if (auto image = std::get_if<Ui::PreparedFileInformation::Image>(
 				&_information->media)) {
 			fullimage = base::take(image->data);
@@ -871,11 +942,7 @@ void FileLoadTask::process(Args &&args) {
 					// removing its color space is displayed fine on tdesktop, but with
 					// a light gray background on mobile apps.
 					full.setColorSpace(QColorSpace());
-					QBuffer buffer(&filedata);
-					QImageWriter writer(&buffer, "JPEG");
-					writer.setQuality(87);
-					writer.setProgressiveScanWrite(true);
-					writer.write(full);
+					filedata = EncodePhoto(full);
 				}
 				photoThumbs.emplace('m', PreparedPhotoThumb{ .image = medium });
 				photoSizes.push_back(MTP_photoSize(MTP_string("m"), MTP_int(medium.width()), MTP_int(medium.height()), MTP_int(0)));
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "base/variant.h"
+#include "base/weak_ptr.h"
 #include "api/api_common.h"
 #include "ui/chat/attach/attach_prepare.h"
 
@@ -103,66 +104,62 @@ using TaskId = void*; // no interface, just id
 class Task {
 public:
 	virtual void process() = 0; // is executed in a separate thread
-	virtual void finish() = 0; // is executed in the same as TaskQueue thread
+	virtual void finish() = 0; // is executed in the main thread
 	virtual ~Task() = default;
 
 	TaskId id() const {
 		return static_cast<TaskId>(const_cast<Task*>(this));
 	}
 
-};
+	// Long processing may check it to stop when the task was canceled.
+	[[nodiscard]] bool interrupted() const {
+		return _interrupted->load();
+	}
+	[[nodiscard]] auto interruption() const
+	-> std::shared_ptr<std::atomic<bool>> {
+		return _interrupted;
+	}
 
-class TaskQueueWorker;
-class TaskQueue : public QObject {
-	Q_OBJECT
+private:
+	const std::shared_ptr<std::atomic<bool>> _interrupted
+		= std::make_shared<std::atomic<bool>>(false);
+
+};
 
+// Tasks are processed in parallel in the shared crl::async() pool,
+// but finish() is called on the main thread in the order they were added.
+class TaskQueue final : public base::has_weak_ptr {
 public:
-	explicit TaskQueue(crl::time stopTimeoutMs = 0); // <= 0 - never stop worker
+	TaskQueue();
 
 	TaskId addTask(std::unique_ptr<Task> &&task);
 	void addTasks(std::vector<std::unique_ptr<Task>> &&tasks);
 	void cancelTask(TaskId id); // this task finish() won't be called
 
-	~TaskQueue();
-
-Q_SIGNALS:
-	void taskAdded();
-
-public Q_SLOTS:
-	void onTaskProcessed();
+	// Drops all the queued tasks, interrupts and waits for the processed.
 	void stop();
 
+	~TaskQueue();
+
 private:
-	friend class TaskQueueWorker;
+	struct Running;
+	struct Entry {
+		TaskId id = TaskId();
+		std::unique_ptr<Task> processed;
+	};
 
-	void wakeThread();
+	void processNext();
+	void taskProcessed(TaskId id, std::unique_ptr<Task> task);
+	void finishProcessed();
 
+	const int _maxProcessing = 1;
+	const std::shared_ptr<Running> _running;
 	std::deque<std::unique_ptr<Task>> _tasksToProcess;
-	std::deque<std::unique_ptr<Task>> _tasksToFinish;
-	TaskId _taskInProcessId = TaskId();
-	QMutex _tasksToProcessMutex, _tasksToFinishMutex;
-	QThread *_thread = nullptr;
-	TaskQueueWorker *_worker = nullptr;
-	QTimer *_stopTimer = nullptr;
-
-};
-
-class TaskQueueWorker : public QObject {
-	Q_OBJECT
-
-public:
-	TaskQueueWorker(TaskQueue *queue) : _queue(queue) {
-	}
-
-Q_SIGNALS:
-	void taskProcessed();
-
-public Q_SLOTS:
-	void onTaskAdded();
-
-private:
-	TaskQueue *_queue;
-	bool _inTaskAdded = false;
+	std::deque<Entry> _tasksToFinish;
+	base::flat_map<
+		TaskId,
+		std::shared_ptr<std::atomic<bool>>> _tasksInProcess;
+	bool _finishing = false;
 
 };
 
@@ -215,6 +212,7 @@ struct FileLoadResult {
 		const FileLoadTo &to,
 		const TextWithTags &caption,
 		std::shared_ptr<SendingAlbum> album);
+	~FileLoadResult();
 
 	TaskId taskId;
 	uint64 id;
@@ -224,6 +222,10 @@ struct FileLoadResult {
 	QString filepath;
 	QByteArray content;
 
+	// The file picked for sending if filepath is its compressed copy.
+	// The copy is removed together with the last reference to the result.
+	QString sourceFilepath;
+
 	QString filename;
 	QString filemime;
 	int32 filesize = 0;
@@ -280,7 +282,8 @@ public:
 		int32 duration,
 		const VoiceWaveform &waveform,
 		const FileLoadTo &to,
-		const TextWithTags &caption);
+		const TextWithTags &caption,
+		uint64 streamedUploadId = 0);
 	~FileLoadTask();
 
 	uint64 fileid() const {
@@ -331,6 +334,7 @@ private:
 	VoiceWaveform _waveform;
 	SendMediaType _type;
 	TextWithTags _caption;
+	QString _compressedPath;
 
 	std::shared_ptr<FileLoadResult> _result;
 
@@ -16,6 +16,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_session.h"
 #include "data/data_document.h"
 #include "data/data_document_media.h"
+#include "storage/cache/storage_cache_database.h"
 #include "base/platform/base_platform_info.h"
 #include "base/random.h"
 #include "ui/effects/animation_value.h"
@@ -45,7 +46,6 @@ namespace Local {
 namespace {
 
 constexpr auto kThemeFileSizeLimit = 5 * 1024 * 1024;
-constexpr auto kFileLoaderQueueStopTimeout = crl::time(5000);
 
 constexpr auto kSavedBackgroundFormat = QImage::Format_ARGB32_Premultiplied;
 constexpr auto kWallPaperLegacySerializeTagId = int32(-111);
@@ -64,6 +64,7 @@ QString _basePath, _userBasePath, _userDbPath;
 TaskQueue *_localLoader = nullptr;
 
 QByteArray _settingsSalt;
+QByteArray _settingsLastWritten;
 
 auto OldKey = MTP::AuthKeyPtr();
 auto SettingsKey = MTP::AuthKeyPtr();
@@ -355,7 +356,7 @@ void readLangPack();
 void start() {
 	Expects(_basePath.isEmpty());
 
-	_localLoader = new TaskQueue(kFileLoaderQueueStopTimeout);
+	_localLoader = new TaskQueue();
 
 	_basePath = cWorkingDir() + qsl("tdata/");
 	if (!QDir().exists(_basePath)) QDir().mkpath(_basePath);
@@ -449,15 +450,16 @@ void writeSettings() {
 	// We dropped old test authorizations when migrated to multi auth.
 	//const auto name = cTestMode() ? qsl("settings_test") : qsl("settings");
 	const auto name = u"settings"_q;
-	FileWriteDescriptor settings(name, _basePath);
 	if (_settingsSalt.isEmpty() || !SettingsKey) {
 		_settingsSalt.resize(LocalEncryptSaltSize);
 		base::RandomFill(_settingsSalt.data(), _settingsSalt.size());
 		SettingsKey = CreateLegacyLocalKey(QByteArray(), _settingsSalt);
+		_settingsLastWritten = QByteArray();
 	}
-	settings.writeData(_settingsSalt);
 
 	if (!_settingsWriteAllowed) {
+		FileWriteDescriptor settings(name, _basePath);
+		settings.writeData(_settingsSalt);
 		EncryptedDescriptor data(0);
 		settings.writeEncrypted(data, SettingsKey);
 		return;
@@ -513,6 +515,15 @@ void writeSettings() {
 		data.stream << quint32(dbiLanguagesKey) << quint64(_languagesKey);
 	}
 
+	// Many delayed saves (window moves, toggling back and forth)
+	// end up with the same content, there is no need to rewrite it.
+	if (data.data == _settingsLastWritten) {
+		return;
+	}
+	_settingsLastWritten = data.data;
+
+	FileWriteDescriptor settings(name, _basePath);
+	settings.writeData(_settingsSalt);
 	settings.writeEncrypted(data, SettingsKey);
 }
 
@@ -809,13 +820,51 @@ int32 oldKotatoVersion() {
 	return _oldKotatoVersion;
 }
 
+struct WaveformFields {
+	VoiceWaveform *waveform = nullptr;
+	char *wavemax = nullptr;
+};
+
+[[nodiscard]] WaveformFields LookupWaveform(not_null<DocumentData*> document) {
+	if (const auto voice = document->voice()) {
+		return { &voice->waveform, &voice->wavemax };
+	} else if (const auto song = document->song()) {
+		return { &song->waveform, &song->wavemax };
+	}
+	return {};
+}
+
+void ApplyWaveform(
+		not_null<DocumentData*> document,
+		const VoiceWaveform &waveform) {
+	const auto fields = LookupWaveform(document);
+	if (!fields.waveform) {
+		return;
+	}
+	if (!waveform.isEmpty()) {
+		*fields.waveform = waveform;
+		*fields.wavemax = *ranges::max_element(waveform);
+	}
+	if (fields.waveform->isEmpty()) {
+		fields.waveform->resize(1);
+		(*fields.waveform)[0] = -2;
+		*fields.wavemax = 0;
+	} else if ((*fields.waveform)[0] < 0) {
+		(*fields.waveform)[0] = -2;
+		*fields.wavemax = 0;
+	}
+	document->owner().requestDocumentViewRepaint(document);
+}
+
 class CountWaveformTask : public Task {
 public:
-	CountWaveformTask(not_null<Data::DocumentMedia*> media)
-	: _doc(media->owner())
-	, _loc(_doc->location(true))
-	, _data(media->bytes())
-	, _wavemax(0) {
+	CountWaveformTask(
+		not_null<DocumentData*> document,
+		const Core::FileLocation &location,
+		const QByteArray &data)
+	: _doc(document)
+	, _loc(location)
+	, _data(data) {
 		if (_data.isEmpty() && !_loc.accessEnable()) {
 			_doc = nullptr;
 		}
@@ -824,26 +873,20 @@ public:
 		if (!_doc) return;
 
 		_waveform = audioCountWaveform(_loc, _data);
-		_wavemax = _waveform.empty()
-			? char(0)
-			: *ranges::max_element(_waveform);
 	}
 	void finish() override {
-		if (const auto voice = _doc ? _doc->voice() : nullptr) {
-			if (!_waveform.isEmpty()) {
-				voice->waveform = _waveform;
-				voice->wavemax = _wavemax;
-			}
-			if (voice->waveform.isEmpty()) {
-				voice->waveform.resize(1);
-				voice->waveform[0] = -2;
-				voice->wavemax = 0;
-			} else if (voice->waveform[0] < 0) {
-				voice->waveform[0] = -2;
-				voice->wavemax = 0;
-			}
-			_doc->owner().requestDocumentViewRepaint(_doc);
+		if (!_doc) return;
+
+		if (!_waveform.isEmpty()) {
+			_doc->owner().cache().putIfEmpty(
+				_doc->waveformCacheKey(),
+				Storage::Cache::Database::TaggedValue(
+					QByteArray(
+						reinterpret_cast<const char*>(_waveform.constData()),
+						_waveform.size()),
+					0));
 		}
+		ApplyWaveform(_doc, _waveform);
 	}
 	~CountWaveformTask() {
 		if (_data.isEmpty() && _doc) {
@@ -856,21 +899,67 @@ protected:
 	Core::FileLocation _loc;
 	QByteArray _data;
 	VoiceWaveform _waveform;
-	char _wavemax;
 
 };
 
-void countVoiceWaveform(not_null<Data::DocumentMedia*> media) {
+// Waveforms of the received files are kept in the cache,
+// so they are counted only once for each document.
+void ReadCachedWaveform(
+		not_null<DocumentData*> document,
+		Fn<void(WaveformFields fields)> missing) {
+	const auto fields = LookupWaveform(document);
+	fields.waveform->resize(1);
+	(*fields.waveform)[0] = -1; // counting
+
+	const auto weak = base::make_weak(&document->session());
+	document->owner().cache().get(
+		document->waveformCacheKey(),
+		[=](QByteArray value) {
+			crl::on_main(weak, [=] {
+				const auto fields = LookupWaveform(document);
+				if (!fields.waveform
+					|| fields.waveform->size() != 1
+					|| (*fields.waveform)[0] != -1) {
+					return;
+				} else if (!value.isEmpty()) {
+					auto waveform = VoiceWaveform(value.size());
+					memcpy(waveform.data(), value.constData(), value.size());
+					ApplyWaveform(document, waveform);
+					return;
+				}
+				missing(fields);
+			});
+		});
+}
+
+void countWaveform(not_null<Data::DocumentMedia*> media) {
 	const auto document = media->owner();
-	if (const auto voice = document->voice()) {
-		if (_localLoader) {
-			voice->waveform.resize(1 + sizeof(TaskId));
-			voice->waveform[0] = -1; // counting
-			TaskId taskId = _localLoader->addTask(
-				std::make_unique<CountWaveformTask>(media));
-			memcpy(voice->waveform.data() + 1, &taskId, sizeof(taskId));
+	if (!LookupWaveform(document).waveform || !_localLoader) {
+		return;
+	}
+	const auto location = document->location(true);
+	const auto data = media->bytes();
+	ReadCachedWaveform(document, [=](WaveformFields fields) {
+		if (!_localLoader) {
+			return;
 		}
+		const auto taskId = _localLoader->addTask(
+			std::make_unique<CountWaveformTask>(
+				document,
+				location,
+				data));
+		fields.waveform->resize(1 + sizeof(TaskId));
+		memcpy(fields.waveform->data() + 1, &taskId, sizeof(taskId));
+	});
+}
+
+void loadCachedWaveform(not_null<DocumentData*> document) {
+	if (!LookupWaveform(document).waveform) {
+		return;
 	}
+	ReadCachedWaveform(document, [](WaveformFields fields) {
+		(*fields.waveform)[0] = -3; // not counted yet
+	});
 }
 
 void cancelTask(TaskId id) {
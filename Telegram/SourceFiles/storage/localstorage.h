@@ -13,6 +13,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include <QtCore/QTimer>
 
 class History;
+class DocumentData;
 
 namespace Data {
 class WallPaper;
@@ -71,7 +72,8 @@ void reset();
 int32 oldSettingsVersion();
 int32 oldKotatoVersion();
 
-void countVoiceWaveform(not_null<Data::DocumentMedia*> media);
+void countWaveform(not_null<Data::DocumentMedia*> media);
+void loadCachedWaveform(not_null<DocumentData*> document);
 
 void cancelTask(TaskId id);
 
@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/storage_domain.h"
 #include "storage/storage_encryption.h"
 #include "storage/storage_clear_legacy.h"
+#include "storage/storage_shared_media.h"
 #include "storage/cache/storage_cache_types.h"
 #include "storage/details/storage_file_utilities.h"
 #include "storage/details/storage_settings_scheme.h"
@@ -25,6 +26,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history.h"
 #include "core/application.h"
 #include "core/file_location.h"
+#include "core/idle_maintenance.h"
+#include "core/startup_timeline.h"
 #include "data/stickers/data_stickers.h"
 #include "data/data_session.h"
 #include "data/data_document.h"
@@ -40,10 +43,16 @@ using namespace details;
 using Database = Cache::Database;
 
 constexpr auto kDelayedWriteTimeout = crl::time(1000);
+constexpr auto kDraftsWritePerTimeout = 16;
+
+// After that many appended records the locations are written in full.
+constexpr auto kLocationsJournalRecordsLimit = 256;
 
 constexpr auto kStickersVersionTag = quint32(-1);
 constexpr auto kStickersSerializeVersion = 2;
 constexpr auto kMaxSavedStickerSetsCount = 1000;
+constexpr auto kMaxSavedSharedMediaCounts = 256;
+constexpr auto kMaxSavedScheduledMessagesLists = 64;
 constexpr auto kDefaultStickerInstallDate = TimeId(1);
 
 constexpr auto kSinglePeerTypeUserOld = qint32(1);
@@ -83,6 +92,8 @@ enum { // Local Storage Keys
 	lskBackgroundOld = 0x14, // no data
 	lskSelfSerialized = 0x15, // serialized self
 	lskMasksKeys = 0x16, // no data
+	lskSharedMediaCounts = 0x17, // no data
+	lskScheduledMessages = 0x18, // no data
 };
 
 auto EmptyMessageDraftSources()
@@ -121,6 +132,13 @@ auto EmptyMessageDraftSources()
 
 } // namespace
 
+struct Account::PrefetchedMap {
+	crl::semaphore ready;
+	QByteArray decrypted;
+	qint32 version = 0;
+	bool success = false;
+};
+
 Account::Account(not_null<Main::Account*> owner, const QString &dataName)
 : _owner(owner)
 , _dataName(dataName)
@@ -133,10 +151,15 @@ Account::Account(not_null<Main::Account*> owner, const QString &dataName)
 , _cacheTotalTimeLimit(Database::Settings().totalTimeLimit)
 , _cacheBigFileTotalTimeLimit(Database::Settings().totalTimeLimit)
 , _writeMapTimer([=] { writeMap(); })
-, _writeLocationsTimer([=] { writeLocations(); }) {
+, _writeLocationsTimer([=] { writeLocations(); })
+, _writeDraftsTimer([=] { writePendingDrafts(kDraftsWritePerTimeout); })
+, _writeSharedMediaCountsTimer([=] { writeSharedMediaCountsFile(); }) {
 }
 
 Account::~Account() {
+	if (_localKey && _writeSharedMediaCountsTimer.isActive()) {
+		writeSharedMediaCountsFile();
+	}
 	if (_localKey && _mapChanged) {
 		writeMap();
 	}
@@ -157,12 +180,42 @@ StartResult Account::legacyStart(const QByteArray &passcode) {
 	return StartResult::Success;
 }
 
+void Account::prefetchMap(MTP::AuthKeyPtr localKey) {
+	Expects(localKey != nullptr);
+	Expects(_prefetchedMap == nullptr);
+
+	_prefetchedMap = std::make_shared<PrefetchedMap>();
+	crl::async([
+		basePath = _basePath,
+		localKey = std::move(localKey),
+		prefetched = _prefetchedMap
+	] {
+		const auto guard = gsl::finally([&] { prefetched->ready.release(); });
+
+		FileReadDescriptor mapData;
+		if (!ReadFile(mapData, qsl("map"), basePath)) {
+			return;
+		}
+		QByteArray legacySalt, legacyKeyEncrypted, mapEncrypted;
+		mapData.stream >> legacySalt >> legacyKeyEncrypted >> mapEncrypted;
+		if (mapData.stream.status() != QDataStream::Ok) {
+			return;
+		}
+		prefetched->version = mapData.version;
+		prefetched->success = DecryptLocalData(
+			prefetched->decrypted,
+			bytes::make_span(mapEncrypted),
+			localKey);
+	});
+}
+
 std::unique_ptr<MTP::Config> Account::start(MTP::AuthKeyPtr localKey) {
 	Expects(localKey != nullptr);
 
 	_localKey = std::move(localKey);
 	readMapWith(_localKey);
 	clearLegacyFiles();
+	clearCompressedVideos();
 	return readMtpConfig();
 }
 
@@ -171,9 +224,31 @@ void Account::startAdded(MTP::AuthKeyPtr localKey) {
 
 	_localKey = std::move(localKey);
 	clearLegacyFiles();
+	clearCompressedVideos();
+}
+
+void Account::clearCompressedVideos() {
+	// Videos compressed for uploads that were left with the last run,
+	// see FileLoadTask. Nothing is being uploaded yet at this point.
+	crl::async([temp = _tempPath] {
+		const auto names = QDir(temp).entryList(
+			{ u"compressed_*.mp4"_q },
+			QDir::Files);
+		for (const auto &name : names) {
+			QFile::remove(temp + name);
+		}
+	});
 }
 
 void Account::clearLegacyFiles() {
+	// Scanning the folder is not urgent, so it waits for an idle moment.
+	Core::App().idleMaintenance().add({
+		.name = u"legacy files"_q,
+		.run = [=] { clearLegacyFilesNow(); },
+	}, _lifetime);
+}
+
+void Account::clearLegacyFilesNow() {
 	const auto weak = base::make_weak(_owner.get());
 	ClearLegacyFiles(_basePath, [weak, this](
 			FnMut<void(base::flat_set<QString>&&)> then) {
@@ -202,6 +277,8 @@ base::flat_set<QString> Account::collectGoodNames() const {
 		_installedMasksKey,
 		_recentMasksKey,
 		_archivedMasksKey,
+		_sharedMediaCountsKey,
+		_scheduledMessagesKey,
 	};
 	auto result = base::flat_set<QString>{
 		"map0",
@@ -219,6 +296,8 @@ base::flat_set<QString> Account::collectGoodNames() const {
 		result.emplace(name);
 		name[name.size() - 1] = 's';
 		result.emplace(name);
+		name[name.size() - 1] = 'j';
+		result.emplace(name);
 	};
 	for (const auto &[key, value] : _draftsMap) {
 		push(value);
@@ -237,41 +316,56 @@ Account::ReadMapResult Account::readMapWith(
 		const QByteArray &legacyPasscode) {
 	auto ms = crl::now();
 
-	FileReadDescriptor mapData;
-	if (!ReadFile(mapData, qsl("map"), _basePath)) {
-		return ReadMapResult::Failed;
+	EncryptedDescriptor map;
+	auto mapVersion = qint32();
+	const auto prefetched = localKey
+		? base::take(_prefetchedMap)
+		: nullptr;
+	if (prefetched) {
+		prefetched->ready.acquire();
 	}
-	LOG(("App Info: reading map..."));
+	if (prefetched && prefetched->success) {
+		LOG(("App Info: reading prefetched map..."));
+		mapVersion = prefetched->version;
+		PrepareDecrypted(map, base::take(prefetched->decrypted));
+	} else {
+		// Failed prefetch is retried here to get the same error reporting.
+		FileReadDescriptor mapData;
+		if (!ReadFile(mapData, qsl("map"), _basePath)) {
+			return ReadMapResult::Failed;
+		}
+		LOG(("App Info: reading map..."));
 
-	QByteArray legacySalt, legacyKeyEncrypted, mapEncrypted;
-	mapData.stream >> legacySalt >> legacyKeyEncrypted >> mapEncrypted;
-	if (!CheckStreamStatus(mapData.stream)) {
-		return ReadMapResult::Failed;
-	}
-	if (!localKey) {
-		if (legacySalt.size() != LocalEncryptSaltSize) {
-			LOG(("App Error: bad salt in map file, size: %1").arg(legacySalt.size()));
+		QByteArray legacySalt, legacyKeyEncrypted, mapEncrypted;
+		mapData.stream >> legacySalt >> legacyKeyEncrypted >> mapEncrypted;
+		if (!CheckStreamStatus(mapData.stream)) {
 			return ReadMapResult::Failed;
 		}
-		auto legacyPasscodeKey = CreateLegacyLocalKey(legacyPasscode, legacySalt);
+		if (!localKey) {
+			if (legacySalt.size() != LocalEncryptSaltSize) {
+				LOG(("App Error: bad salt in map file, size: %1").arg(legacySalt.size()));
+				return ReadMapResult::Failed;
+			}
+			auto legacyPasscodeKey = CreateLegacyLocalKey(legacyPasscode, legacySalt);
 
-		EncryptedDescriptor keyData;
-		if (!DecryptLocal(keyData, legacyKeyEncrypted, legacyPasscodeKey)) {
-			LOG(("App Info: could not decrypt pass-protected key from map file, maybe bad password..."));
-			return ReadMapResult::IncorrectPasscode;
+			EncryptedDescriptor keyData;
+			if (!DecryptLocal(keyData, legacyKeyEncrypted, legacyPasscodeKey)) {
+				LOG(("App Info: could not decrypt pass-protected key from map file, maybe bad password..."));
+				return ReadMapResult::IncorrectPasscode;
+			}
+			auto key = Serialize::read<MTP::AuthKey::Data>(keyData.stream);
+			if (keyData.stream.status() != QDataStream::Ok || !keyData.stream.atEnd()) {
+				LOG(("App Error: could not read pass-protected key from map file"));
+				return ReadMapResult::Failed;
+			}
+			localKey = std::make_shared<MTP::AuthKey>(key);
 		}
-		auto key = Serialize::read<MTP::AuthKey::Data>(keyData.stream);
-		if (keyData.stream.status() != QDataStream::Ok || !keyData.stream.atEnd()) {
-			LOG(("App Error: could not read pass-protected key from map file"));
+
+		if (!DecryptLocal(map, mapEncrypted, localKey)) {
+			LOG(("App Error: could not decrypt map."));
 			return ReadMapResult::Failed;
 		}
-		localKey = std::make_shared<MTP::AuthKey>(key);
-	}
-
-	EncryptedDescriptor map;
-	if (!DecryptLocal(map, mapEncrypted, localKey)) {
-		LOG(("App Error: could not decrypt map."));
-		return ReadMapResult::Failed;
+		mapVersion = mapData.version;
 	}
 	LOG(("App Info: reading encrypted map..."));
 
@@ -286,6 +380,8 @@ Account::ReadMapResult Account::readMapWith(
 	quint64 savedGifsKey = 0;
 	quint64 legacyBackgroundKeyDay = 0, legacyBackgroundKeyNight = 0;
 	quint64 userSettingsKey = 0, recentHashtagsAndBotsKey = 0, exportSettingsKey = 0;
+	quint64 sharedMediaCountsKey = 0;
+	quint64 scheduledMessagesKey = 0;
 	while (!map.stream.atEnd()) {
 		quint32 keyType;
 		map.stream >> keyType;
@@ -385,6 +481,12 @@ Account::ReadMapResult Account::readMapWith(
 				>> recentMasksKey
 				>> archivedMasksKey;
 		} break;
+		case lskSharedMediaCounts: {
+			map.stream >> sharedMediaCountsKey;
+		} break;
+		case lskScheduledMessages: {
+			map.stream >> scheduledMessagesKey;
+		} break;
 		default:
 			LOG(("App Error: unknown key type in encrypted map: %1").arg(keyType));
 			return ReadMapResult::Failed;
@@ -417,7 +519,9 @@ Account::ReadMapResult Account::readMapWith(
 	_settingsKey = userSettingsKey;
 	_recentHashtagsAndBotsKey = recentHashtagsAndBotsKey;
 	_exportSettingsKey = exportSettingsKey;
-	_oldMapVersion = mapData.version;
+	_sharedMediaCountsKey = sharedMediaCountsKey;
+	_scheduledMessagesKey = scheduledMessagesKey;
+	_oldMapVersion = mapVersion;
 
 	if (_oldMapVersion < AppVersion) {
 		writeMapDelayed();
@@ -446,6 +550,7 @@ Account::ReadMapResult Account::readMapWith(
 		_oldMapVersion);
 
 	LOG(("Map read time: %1").arg(crl::now() - ms));
+	Core::StartupTimeline::Mark("map read");
 
 	return ReadMapResult::Success;
 }
@@ -465,6 +570,7 @@ void Account::writeMapQueued() {
 void Account::writeMap() {
 	Expects(_localKey != nullptr);
 
+	const auto task = Logs::TaskScope("Storage::Account::writeMap");
 	_writeMapTimer.cancel();
 	if (!_mapChanged) {
 		return;
@@ -519,6 +625,8 @@ void Account::writeMap() {
 	if (_installedMasksKey || _recentMasksKey || _archivedMasksKey) {
 		mapSize += sizeof(quint32) + 3 * sizeof(quint64);
 	}
+	if (_sharedMediaCountsKey) mapSize += sizeof(quint32) + sizeof(quint64);
+	if (_scheduledMessagesKey) mapSize += sizeof(quint32) + sizeof(quint64);
 
 	EncryptedDescriptor mapData(mapSize);
 	if (!self.isEmpty()) {
@@ -571,6 +679,12 @@ void Account::writeMap() {
 			<< quint64(_recentMasksKey)
 			<< quint64(_archivedMasksKey);
 	}
+	if (_sharedMediaCountsKey) {
+		mapData.stream << quint32(lskSharedMediaCounts) << quint64(_sharedMediaCountsKey);
+	}
+	if (_scheduledMessagesKey) {
+		mapData.stream << quint32(lskScheduledMessages) << quint64(_scheduledMessagesKey);
+	}
 	map.writeEncrypted(mapData, _localKey);
 
 	_mapChanged = false;
@@ -581,6 +695,9 @@ void Account::reset() {
 	_draftsMap.clear();
 	_draftCursorsMap.clear();
 	_draftsNotReadMap.clear();
+	_draftsToWrite.clear();
+	_draftCursorsToWrite.clear();
+	_writeDraftsTimer.cancel();
 	_locationsKey = _trustedBotsKey = 0;
 	_recentStickersKeyOld = 0;
 	_installedStickersKey = 0;
@@ -594,10 +711,22 @@ void Account::reset() {
 	_archivedMasksKey = 0;
 	_legacyBackgroundKeyDay = _legacyBackgroundKeyNight = 0;
 	_settingsKey = _recentHashtagsAndBotsKey = _exportSettingsKey = 0;
+	_sharedMediaCountsKey = 0;
+	_sharedMediaCounts.clear();
+	_sharedMediaCountsUsed = 0;
+	_sharedMediaCountsRead = false;
+	_writeSharedMediaCountsTimer.cancel();
+	_scheduledMessagesKey = 0;
+	_scheduledMessages.clear();
+	_scheduledMessagesUsed = 0;
+	_scheduledMessagesRead = false;
 	_oldMapVersion = 0;
 	_fileLocations.clear();
 	_fileLocationPairs.clear();
 	_fileLocationAliases.clear();
+	_locationsJournalKeys.clear();
+	_locationsJournalAliases.clear();
+	_locationsJournalRecords = 0;
 	_cacheTotalSizeLimit = Database::Settings().totalSizeLimit;
 	_cacheTotalTimeLimit = Database::Settings().totalTimeLimit;
 	_cacheBigFileTotalSizeLimit = Database::Settings().totalSizeLimit;
@@ -623,6 +752,7 @@ void Account::reset() {
 }
 
 void Account::writeLocations() {
+	const auto task = Logs::TaskScope("Storage::Account::writeLocations");
 	_writeLocationsTimer.cancel();
 	if (!_locationsChanged) {
 		return;
@@ -635,6 +765,9 @@ void Account::writeLocations() {
 			_locationsKey = 0;
 			writeMapDelayed();
 		}
+	} else if (_locationsKey
+		&& _locationsJournalRecords < kLocationsJournalRecordsLimit) {
+		appendLocationsJournal();
 	} else {
 		if (!_locationsKey) {
 			_locationsKey = GenerateKey(_basePath);
@@ -688,7 +821,58 @@ void Account::writeLocations() {
 
 		FileWriteDescriptor file(_locationsKey, _basePath);
 		file.writeEncrypted(data, _localKey);
+
+		_locationsJournalKeys.clear();
+		_locationsJournalAliases.clear();
+		_locationsJournalRecords = 0;
+	}
+}
+
+void Account::appendLocationsJournal() {
+	if (_locationsJournalKeys.empty() && _locationsJournalAliases.empty()) {
+		return;
+	}
+
+	// Each record holds all the locations of the changed keys.
+	const auto keys = base::take(_locationsJournalKeys);
+	const auto aliases = base::take(_locationsJournalAliases);
+	auto size = sizeof(quint32) + sizeof(quint32);
+	for (const auto &key : keys) {
+		size += sizeof(quint64) * 2 + sizeof(quint32);
+		for (auto i = _fileLocations.find(key); (i != _fileLocations.end()) && (i.key() == key); ++i) {
+			size += Serialize::stringSize(i.value().name())
+				+ Serialize::bytearraySize(i.value().bookmark())
+				+ Serialize::dateTimeSize()
+				+ sizeof(quint32);
+		}
 	}
+	size += aliases.size() * (sizeof(quint64) * 2 + sizeof(quint64) * 2);
+
+	EncryptedDescriptor data(size);
+	data.stream << quint32(keys.size());
+	for (const auto &key : keys) {
+		data.stream
+			<< quint64(key.first)
+			<< quint64(key.second)
+			<< quint32(_fileLocations.count(key));
+		for (auto i = _fileLocations.find(key); (i != _fileLocations.end()) && (i.key() == key); ++i) {
+			data.stream
+				<< i.value().name()
+				<< i.value().bookmark()
+				<< i.value().modified
+				<< quint32(i.value().size);
+		}
+	}
+	data.stream << quint32(aliases.size());
+	for (const auto &[key, value] : aliases) {
+		data.stream
+			<< quint64(key.first)
+			<< quint64(key.second)
+			<< quint64(value.first)
+			<< quint64(value.second);
+	}
+	AppendEncryptedJournal(_locationsKey, _basePath, data, _localKey);
+	++_locationsJournalRecords;
 }
 
 void Account::writeLocationsQueued() {
@@ -704,6 +888,10 @@ void Account::writeLocationsDelayed() {
 }
 
 void Account::readLocations() {
+	const auto ms = crl::now();
+	const auto timing = gsl::finally([&] {
+		LOG(("Locations read time: %1").arg(crl::now() - ms));
+	});
 	FileReadDescriptor locations;
 	if (!ReadEncryptedFile(locations, _locationsKey, _basePath, _localKey)) {
 		ClearKey(_locationsKey, _basePath);
@@ -759,6 +947,62 @@ void Account::readLocations() {
 			}
 		}
 	}
+
+	const auto complete = ReadEncryptedJournal(
+		_locationsKey,
+		_basePath,
+		_localKey,
+		[&](EncryptedDescriptor &data) {
+			++_locationsJournalRecords;
+			return applyLocationsJournal(data.stream);
+		});
+	if (!complete) {
+		// Write everything we have in full, dropping the broken journal.
+		_locationsJournalRecords = kLocationsJournalRecordsLimit;
+		writeLocationsDelayed();
+	}
+}
+
+bool Account::applyLocationsJournal(QDataStream &stream) {
+	quint32 keysCount = 0;
+	stream >> keysCount;
+	for (quint32 i = 0; i < keysCount; ++i) {
+		quint64 first = 0, second = 0;
+		quint32 count = 0;
+		stream >> first >> second >> count;
+		if (!CheckStreamStatus(stream)) {
+			return false;
+		}
+		const auto key = MediaKey(first, second);
+		for (auto j = _fileLocations.find(key); (j != _fileLocations.end()) && (j.key() == key);) {
+			const auto k = _fileLocationPairs.find(j.value().fname);
+			if (k != _fileLocationPairs.end() && k.value().first == key) {
+				_fileLocationPairs.erase(k);
+			}
+			j = _fileLocations.erase(j);
+		}
+		for (quint32 j = 0; j < count; ++j) {
+			QByteArray bookmark;
+			Core::FileLocation loc;
+			stream >> loc.fname >> bookmark >> loc.modified >> loc.size;
+			if (!CheckStreamStatus(stream)) {
+				return false;
+			}
+			loc.setBookmark(bookmark);
+			_fileLocations.insert(key, loc);
+			if (!loc.inMediaCache()) {
+				_fileLocationPairs.insert(loc.fname, { key, loc });
+			}
+		}
+	}
+	quint32 aliasesCount = 0;
+	stream >> aliasesCount;
+	for (quint32 i = 0; i < aliasesCount; ++i) {
+		quint64 kfirst, ksecond, vfirst, vsecond;
+		stream >> kfirst >> ksecond >> vfirst >> vsecond;
+		_fileLocationAliases.insert(MediaKey(kfirst, ksecond), MediaKey(vfirst, vsecond));
+	}
+	return CheckStreamStatus(stream);
 }
 
 void Account::writeSessionSettings() {
@@ -766,6 +1010,8 @@ void Account::writeSessionSettings() {
 }
 
 void Account::writeSessionSettings(Main::SessionSettings *stored) {
+	const auto task = Logs::TaskScope(
+		"Storage::Account::writeSessionSettings");
 	if (_readingUserSettings) {
 		LOG(("App Error: attempt to write settings while reading them!"));
 		return;
@@ -822,6 +1068,10 @@ ReadSettingsContext Account::prepareReadSettingsContext() const {
 }
 
 std::unique_ptr<Main::SessionSettings> Account::readSessionSettings() {
+	const auto ms = crl::now();
+	const auto timing = gsl::finally([&] {
+		LOG(("Settings read time: %1").arg(crl::now() - ms));
+	});
 	ReadSettingsContext context;
 	FileReadDescriptor userSettings;
 	if (!ReadEncryptedFile(userSettings, _settingsKey, _basePath, _localKey)) {
@@ -952,6 +1202,10 @@ void Account::writeMtpConfig() {
 std::unique_ptr<MTP::Config> Account::readMtpConfig() {
 	Expects(_localKey != nullptr);
 
+	const auto ms = crl::now();
+	const auto timing = gsl::finally([&] {
+		LOG(("Config read time: %1").arg(crl::now() - ms));
+	});
 	FileReadDescriptor file;
 	if (!ReadEncryptedFile(file, "config", _basePath, _localKey)) {
 		return nullptr;
@@ -1027,6 +1281,59 @@ void Account::unregisterDraftSource(
 }
 
 void Account::writeDrafts(not_null<History*> history) {
+	const auto peerId = history->peer->id;
+	_draftsNotReadMap.remove(peerId);
+	_draftsToWrite.emplace(peerId);
+	writeDraftsDelayed();
+}
+
+void Account::writeDraftCursors(not_null<History*> history) {
+	_draftCursorsToWrite.emplace(history->peer->id);
+	writeDraftsDelayed();
+}
+
+void Account::writeDraftsDelayed() {
+	if (!_writeDraftsTimer.isActive()) {
+		_writeDraftsTimer.callOnce(kDelayedWriteTimeout);
+	}
+}
+
+void Account::writePendingDrafts() {
+	writePendingDrafts(std::numeric_limits<int>::max());
+}
+
+void Account::writePendingDrafts(int limit) {
+	_writeDraftsTimer.cancel();
+	if (!_owner->sessionExists()) {
+		_draftsToWrite.clear();
+		_draftCursorsToWrite.clear();
+		return;
+	}
+	const auto owner = &_owner->session().data();
+	const auto take = [&](base::flat_set<PeerId> &from) {
+		const auto result = from.front();
+		from.erase(from.begin());
+		return owner->historyLoaded(result);
+	};
+	while (limit > 0 && !_draftsToWrite.empty()) {
+		if (const auto history = take(_draftsToWrite)) {
+			writeDraftsNow(history);
+			--limit;
+		}
+	}
+	while (limit > 0 && !_draftCursorsToWrite.empty()) {
+		if (const auto history = take(_draftCursorsToWrite)) {
+			writeDraftCursorsNow(history);
+			--limit;
+		}
+	}
+	if (!_draftsToWrite.empty() || !_draftCursorsToWrite.empty()) {
+		writeDraftsDelayed();
+	}
+}
+
+void Account::writeDraftsNow(not_null<History*> history) {
+	const auto task = Logs::TaskScope("Storage::Account::writeDraftsNow");
 	const auto peerId = history->peer->id;
 	const auto &map = history->draftsMap();
 	const auto cloudIt = map.find(Data::DraftKey::Cloud());
@@ -1052,8 +1359,6 @@ void Account::writeDrafts(not_null<History*> history) {
 			_draftsMap.erase(i);
 			writeMapDelayed();
 		}
-
-		_draftsNotReadMap.remove(peerId);
 		return;
 	}
 
@@ -1110,11 +1415,9 @@ void Account::writeDrafts(not_null<History*> history) {
 
 	FileWriteDescriptor file(i->second, _basePath);
 	file.writeEncrypted(data, _localKey);
-
-	_draftsNotReadMap.remove(peerId);
 }
 
-void Account::writeDraftCursors(not_null<History*> history) {
+void Account::writeDraftCursorsNow(not_null<History*> history) {
 	const auto peerId = history->peer->id;
 	const auto &map = history->draftsMap();
 	const auto cloudIt = map.find(Data::DraftKey::Cloud());
@@ -1425,11 +1728,12 @@ void Account::readDraftsWithCursorsLegacy(
 }
 
 bool Account::hasDraftCursors(PeerId peer) {
-	return _draftCursorsMap.contains(peer);
+	return _draftCursorsMap.contains(peer)
+		|| _draftCursorsToWrite.contains(peer);
 }
 
 bool Account::hasDraft(PeerId peer) {
-	return _draftsMap.contains(peer);
+	return _draftsMap.contains(peer) || _draftsToWrite.contains(peer);
 }
 
 void Account::writeFileLocation(MediaKey location, const Core::FileLocation &local) {
@@ -1447,6 +1751,7 @@ void Account::writeFileLocation(MediaKey location, const Core::FileLocation &loc
 			if (i.value().second == local) {
 				if (i.value().first != location) {
 					_fileLocationAliases.insert(location, i.value().first);
+					_locationsJournalAliases[location] = i.value().first;
 					writeLocationsQueued();
 				}
 				return;
@@ -1458,6 +1763,7 @@ void Account::writeFileLocation(MediaKey location, const Core::FileLocation &loc
 						break;
 					}
 				}
+				_locationsJournalKeys.emplace(i.value().first);
 				_fileLocationPairs.erase(i);
 			}
 		}
@@ -1471,6 +1777,7 @@ void Account::writeFileLocation(MediaKey location, const Core::FileLocation &loc
 		}
 	}
 	_fileLocations.insert(location, local);
+	_locationsJournalKeys.emplace(location);
 	writeLocationsQueued();
 }
 
@@ -1482,6 +1789,7 @@ void Account::removeFileLocation(MediaKey location) {
 	while (i != _fileLocations.end() && (i.key() == location)) {
 		i = _fileLocations.erase(i);
 	}
+	_locationsJournalKeys.emplace(location);
 	writeLocationsQueued();
 }
 
@@ -1495,6 +1803,7 @@ Core::FileLocation Account::readFileLocation(MediaKey location) {
 		if (!i.value().inMediaCache() && !i.value().check()) {
 			_fileLocationPairs.remove(i.value().fname);
 			i = _fileLocations.erase(i);
+			_locationsJournalKeys.emplace(location);
 			writeLocationsDelayed();
 			continue;
 		}
@@ -1713,6 +2022,10 @@ void Account::readStickerSets(
 		Data::StickersSetFlags readingFlags) {
 	using SetFlag = Data::StickersSetFlag;
 
+	const auto ms = crl::now();
+	const auto timing = gsl::finally([&] {
+		LOG(("Sticker sets read time: %1").arg(crl::now() - ms));
+	});
 	FileReadDescriptor stickers;
 	if (!ReadEncryptedFile(stickers, stickersKey, _basePath, _localKey)) {
 		ClearKey(stickersKey, _basePath);
@@ -2284,6 +2597,10 @@ void Account::writeSavedGifs() {
 void Account::readSavedGifs() {
 	if (!_savedGifsKey) return;
 
+	const auto ms = crl::now();
+	const auto timing = gsl::finally([&] {
+		LOG(("Saved gifs read time: %1").arg(crl::now() - ms));
+	});
 	FileReadDescriptor gifs;
 	if (!ReadEncryptedFile(gifs, _savedGifsKey, _basePath, _localKey)) {
 		ClearKey(_savedGifsKey, _basePath);
@@ -2499,6 +2816,7 @@ void Account::writeExportSettings(const Export::Settings &settings) {
 		&& settings.path == check.path
 		&& settings.format == check.format
 		&& settings.availableAt == check.availableAt
+		&& settings.incremental == check.incremental
 		&& !settings.onlySinglePeer()) {
 		if (_exportSettingsKey) {
 			ClearKey(_exportSettingsKey, _basePath);
@@ -2513,7 +2831,7 @@ void Account::writeExportSettings(const Export::Settings &settings) {
 	}
 	quint32 size = sizeof(quint32) * 6
 		+ Serialize::stringSize(settings.path)
-		+ sizeof(qint32) * 2 + sizeof(quint64);
+		+ sizeof(qint32) * 3 + sizeof(quint64);
 	EncryptedDescriptor data(size);
 	data.stream
 		<< quint32(settings.types)
@@ -2546,6 +2864,7 @@ void Account::writeExportSettings(const Export::Settings &settings) {
 	});
 	data.stream << qint32(settings.singlePeerFrom);
 	data.stream << qint32(settings.singlePeerTill);
+	data.stream << qint32(settings.incremental ? 1 : 0);
 
 	FileWriteDescriptor file(_exportSettingsKey, _basePath);
 	file.writeEncrypted(data, _localKey);
@@ -2568,6 +2887,7 @@ Export::Settings Account::readExportSettings() {
 	quint64 singlePeerBareId = 0;
 	quint64 singlePeerAccessHash = 0;
 	qint32 singlePeerFrom = 0, singlePeerTill = 0;
+	qint32 incremental = 0;
 	file.stream
 		>> types
 		>> fullChats
@@ -2598,6 +2918,9 @@ Export::Settings Account::readExportSettings() {
 	if (!file.stream.atEnd()) {
 		file.stream >> singlePeerFrom >> singlePeerTill;
 	}
+	if (!file.stream.atEnd()) {
+		file.stream >> incremental;
+	}
 	auto result = Export::Settings();
 	result.types = Export::Settings::Types::from_raw(types);
 	result.fullChats = Export::Settings::Types::from_raw(fullChats);
@@ -2638,6 +2961,7 @@ Export::Settings Account::readExportSettings() {
 	}();
 	result.singlePeerFrom = singlePeerFrom;
 	result.singlePeerTill = singlePeerTill;
+	result.incremental = (incremental == 1);
 	return (file.stream.status() == QDataStream::Ok && result.validate())
 		? result
 		: Export::Settings();
@@ -2723,6 +3047,237 @@ void Account::readTrustedBots() {
 	}
 }
 
+void Account::writeSharedMediaCountsFile() {
+	_writeSharedMediaCountsTimer.cancel();
+	if (_sharedMediaCounts.empty()) {
+		if (_sharedMediaCountsKey) {
+			ClearKey(_sharedMediaCountsKey, _basePath);
+			_sharedMediaCountsKey = 0;
+			writeMapDelayed();
+		}
+		return;
+	}
+	if (!_sharedMediaCountsKey) {
+		_sharedMediaCountsKey = GenerateKey(_basePath);
+		writeMapQueued();
+	}
+	using Saved = std::pair<PeerId, const SavedSharedMediaCounts*>;
+	auto ordered = std::vector<Saved>();
+	ordered.reserve(_sharedMediaCounts.size());
+	quint32 size = sizeof(qint32);
+	for (const auto &[peerId, saved] : _sharedMediaCounts) {
+		ordered.emplace_back(peerId, &saved);
+		size += sizeof(quint64)
+			+ sizeof(qint32)
+			+ saved.counts.size() * sizeof(qint32) * 2;
+	}
+	// Least recently used first, so reading restores the order.
+	ranges::sort(ordered, ranges::less(), [](const Saved &pair) {
+		return pair.second->used;
+	});
+	EncryptedDescriptor data(size);
+	data.stream << qint32(ordered.size());
+	for (const auto &[peerId, saved] : ordered) {
+		data.stream
+			<< SerializePeerId(peerId)
+			<< qint32(saved->counts.size());
+		for (const auto &[type, count] : saved->counts) {
+			data.stream << qint32(type) << qint32(count);
+		}
+	}
+
+	FileWriteDescriptor file(_sharedMediaCountsKey, _basePath);
+	file.writeEncrypted(data, _localKey);
+}
+
+void Account::readSharedMediaCountsFile() {
+	if (!_sharedMediaCountsKey) return;
+
+	FileReadDescriptor saved;
+	if (!ReadEncryptedFile(saved, _sharedMediaCountsKey, _basePath, _localKey)) {
+		ClearKey(_sharedMediaCountsKey, _basePath);
+		_sharedMediaCountsKey = 0;
+		writeMapDelayed();
+		return;
+	}
+
+	qint32 size = 0;
+	saved.stream >> size;
+	for (int i = 0; i < size; ++i) {
+		auto peerIdSerialized = quint64();
+		auto typesCount = qint32();
+		saved.stream >> peerIdSerialized >> typesCount;
+		if (!CheckStreamStatus(saved.stream)) {
+			break;
+		}
+		auto counts = SharedMediaCounts();
+		for (int j = 0; j < typesCount; ++j) {
+			auto type = qint32();
+			auto count = qint32();
+			saved.stream >> type >> count;
+			if (type >= 0 && type < kSharedMediaTypeCount && count >= 0) {
+				counts.emplace(SharedMediaType(type), count);
+			}
+		}
+		if (!CheckStreamStatus(saved.stream)) {
+			break;
+		}
+		_sharedMediaCounts[DeserializePeerId(peerIdSerialized)] = {
+			.counts = std::move(counts),
+			.used = ++_sharedMediaCountsUsed,
+		};
+	}
+}
+
+void Account::writeSharedMediaCounts(
+		PeerId peerId,
+		SharedMediaCounts counts) {
+	if (!_sharedMediaCountsRead) {
+		readSharedMediaCountsFile();
+		_sharedMediaCountsRead = true;
+	}
+	auto &saved = _sharedMediaCounts[peerId];
+	if (saved.counts == counts) {
+		saved.used = ++_sharedMediaCountsUsed;
+		return;
+	}
+	saved = {
+		.counts = std::move(counts),
+		.used = ++_sharedMediaCountsUsed,
+	};
+	while (_sharedMediaCounts.size() > kMaxSavedSharedMediaCounts) {
+		_sharedMediaCounts.erase(ranges::min_element(
+			_sharedMediaCounts,
+			ranges::less(),
+			[](const auto &pair) { return pair.second.used; }));
+	}
+	if (!_writeSharedMediaCountsTimer.isActive()) {
+		_writeSharedMediaCountsTimer.callOnce(kDelayedWriteTimeout);
+	}
+}
+
+auto Account::readSharedMediaCounts(PeerId peerId) -> SharedMediaCounts {
+	if (!_sharedMediaCountsRead) {
+		readSharedMediaCountsFile();
+		_sharedMediaCountsRead = true;
+	}
+	const auto i = _sharedMediaCounts.find(peerId);
+	if (i == end(_sharedMediaCounts)) {
+		return SharedMediaCounts();
+	}
+	i->second.used = ++_sharedMediaCountsUsed;
+	return i->second.counts;
+}
+
+void Account::writeScheduledMessagesFile() {
+	if (_scheduledMessages.empty()) {
+		if (_scheduledMessagesKey) {
+			ClearKey(_scheduledMessagesKey, _basePath);
+			_scheduledMessagesKey = 0;
+			writeMapDelayed();
+		}
+		return;
+	}
+	if (!_scheduledMessagesKey) {
+		_scheduledMessagesKey = GenerateKey(_basePath);
+		writeMapQueued();
+	}
+	using Saved = std::pair<PeerId, const SavedScheduledMessages*>;
+	auto ordered = std::vector<Saved>();
+	ordered.reserve(_scheduledMessages.size());
+	quint32 size = sizeof(qint32);
+	for (const auto &[peerId, saved] : _scheduledMessages) {
+		ordered.emplace_back(peerId, &saved);
+		size += sizeof(quint64)
+			+ Serialize::bytearraySize(saved.serialized);
+	}
+	// Least recently used first, so reading restores the order.
+	ranges::sort(ordered, ranges::less(), [](const Saved &pair) {
+		return pair.second->used;
+	});
+	EncryptedDescriptor data(size);
+	data.stream << qint32(ordered.size());
+	for (const auto &[peerId, saved] : ordered) {
+		data.stream << SerializePeerId(peerId) << saved->serialized;
+	}
+
+	FileWriteDescriptor file(_scheduledMessagesKey, _basePath);
+	file.writeEncrypted(data, _localKey);
+}
+
+void Account::readScheduledMessagesFile() {
+	if (!_scheduledMessagesKey) return;
+
+	FileReadDescriptor saved;
+	if (!ReadEncryptedFile(
+			saved,
+			_scheduledMessagesKey,
+			_basePath,
+			_localKey)) {
+		ClearKey(_scheduledMessagesKey, _basePath);
+		_scheduledMessagesKey = 0;
+		writeMapDelayed();
+		return;
+	}
+
+	qint32 size = 0;
+	saved.stream >> size;
+	for (int i = 0; i < size; ++i) {
+		auto peerIdSerialized = quint64();
+		auto serialized = QByteArray();
+		saved.stream >> peerIdSerialized >> serialized;
+		if (!CheckStreamStatus(saved.stream)) {
+			break;
+		}
+		_scheduledMessages[DeserializePeerId(peerIdSerialized)] = {
+			.serialized = std::move(serialized),
+			.used = ++_scheduledMessagesUsed,
+		};
+	}
+}
+
+void Account::writeScheduledMessages(
+		base::flat_map<PeerId, QByteArray> &&lists) {
+	if (!_scheduledMessagesRead) {
+		readScheduledMessagesFile();
+		_scheduledMessagesRead = true;
+	}
+	auto changed = false;
+	for (auto &[peerId, serialized] : lists) {
+		if (serialized.isEmpty()) {
+			changed |= _scheduledMessages.remove(peerId);
+			continue;
+		}
+		auto &saved = _scheduledMessages[peerId];
+		if (saved.serialized != serialized) {
+			saved.serialized = std::move(serialized);
+			changed = true;
+		}
+		saved.used = ++_scheduledMessagesUsed;
+	}
+	while (_scheduledMessages.size() > kMaxSavedScheduledMessagesLists) {
+		_scheduledMessages.erase(ranges::min_element(
+			_scheduledMessages,
+			ranges::less(),
+			[](const auto &pair) { return pair.second.used; }));
+		changed = true;
+	}
+	if (changed) {
+		writeScheduledMessagesFile();
+	}
+}
+
+QByteArray Account::readScheduledMessages(PeerId peerId) {
+	if (!_scheduledMessagesRead) {
+		readScheduledMessagesFile();
+		_scheduledMessagesRead = true;
+	}
+	const auto i = _scheduledMessages.find(peerId);
+	return (i != end(_scheduledMessages))
+		? i->second.serialized
+		: QByteArray();
+}
+
 void Account::markBotTrustedOpenGame(PeerId botId) {
 	if (isBotTrustedOpenGame(botId)) {
 		return;
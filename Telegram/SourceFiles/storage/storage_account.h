@@ -49,6 +49,7 @@ class EncryptionKey;
 using FileKey = quint64;
 
 enum class StartResult : uchar;
+enum class SharedMediaType : signed char;
 
 struct MessageDraft {
 	MsgId msgId = 0;
@@ -67,6 +68,8 @@ public:
 	~Account();
 
 	[[nodiscard]] StartResult legacyStart(const QByteArray &passcode);
+	// Reads and decrypts the map on a worker thread, start() waits for it.
+	void prefetchMap(MTP::AuthKeyPtr localKey);
 	[[nodiscard]] std::unique_ptr<MTP::Config> start(
 		MTP::AuthKeyPtr localKey);
 	void startAdded(MTP::AuthKeyPtr localKey);
@@ -94,6 +97,7 @@ public:
 	void writeDrafts(not_null<History*> history);
 	void readDraftsWithCursors(not_null<History*> history);
 	void writeDraftCursors(not_null<History*> history);
+	void writePendingDrafts();
 	[[nodiscard]] bool hasDraftCursors(PeerId peerId);
 	[[nodiscard]] bool hasDraft(PeerId peerId);
 
@@ -153,6 +157,14 @@ public:
 	void markBotTrustedPayment(PeerId botId);
 	[[nodiscard]] bool isBotTrustedPayment(PeerId botId);
 
+	using SharedMediaCounts = base::flat_map<SharedMediaType, int>;
+	void writeSharedMediaCounts(PeerId peerId, SharedMediaCounts counts);
+	[[nodiscard]] SharedMediaCounts readSharedMediaCounts(PeerId peerId);
+
+	// Empty serialized list removes the saved one for that peer.
+	void writeScheduledMessages(base::flat_map<PeerId, QByteArray> &&lists);
+	[[nodiscard]] QByteArray readScheduledMessages(PeerId peerId);
+
 	[[nodiscard]] bool encrypt(
 		const void *src,
 		void *dst,
@@ -172,6 +184,7 @@ private:
 		IncorrectPasscode,
 		Failed,
 	};
+	struct PrefetchedMap;
 	enum class BotTrustFlag : uchar {
 		NoOpenGame = (1 << 0),
 		Payment    = (1 << 1),
@@ -185,13 +198,17 @@ private:
 	ReadMapResult readMapWith(
 		MTP::AuthKeyPtr localKey,
 		const QByteArray &legacyPasscode = QByteArray());
+	void clearCompressedVideos();
 	void clearLegacyFiles();
+	void clearLegacyFilesNow();
 	void writeMapDelayed();
 	void writeMapQueued();
 	void writeMap();
 
 	void readLocations();
+	[[nodiscard]] bool applyLocationsJournal(QDataStream &stream);
 	void writeLocations();
+	void appendLocationsJournal();
 	void writeLocationsQueued();
 	void writeLocationsDelayed();
 
@@ -210,6 +227,10 @@ private:
 		quint64 draftPeerSerialized,
 		Data::HistoryDrafts &map);
 	void clearDraftCursors(PeerId peerId);
+	void writeDraftsDelayed();
+	void writePendingDrafts(int limit);
+	void writeDraftsNow(not_null<History*> history);
+	void writeDraftCursorsNow(not_null<History*> history);
 	void readDraftsWithCursorsLegacy(
 		not_null<History*> history,
 		details::FileReadDescriptor &draft,
@@ -232,6 +253,11 @@ private:
 	void readTrustedBots();
 	void writeTrustedBots();
 
+	void readSharedMediaCountsFile();
+	void writeSharedMediaCountsFile();
+	void readScheduledMessagesFile();
+	void writeScheduledMessagesFile();
+
 	std::optional<RecentHashtagPack> saveRecentHashtags(
 		Fn<RecentHashtagPack()> getPack,
 		const QString &text);
@@ -244,10 +270,13 @@ private:
 	const QString _databasePath;
 
 	MTP::AuthKeyPtr _localKey;
+	std::shared_ptr<PrefetchedMap> _prefetchedMap;
 
 	base::flat_map<PeerId, FileKey> _draftsMap;
 	base::flat_map<PeerId, FileKey> _draftCursorsMap;
 	base::flat_map<PeerId, bool> _draftsNotReadMap;
+	base::flat_set<PeerId> _draftsToWrite;
+	base::flat_set<PeerId> _draftCursorsToWrite;
 	base::flat_map<
 		not_null<History*>,
 		base::flat_map<Data::DraftKey, MessageDraftSource>> _draftSources;
@@ -255,6 +284,9 @@ private:
 	QMultiMap<MediaKey, Core::FileLocation> _fileLocations;
 	QMap<QString, QPair<MediaKey, Core::FileLocation>> _fileLocationPairs;
 	QMap<MediaKey, MediaKey> _fileLocationAliases;
+	base::flat_set<MediaKey> _locationsJournalKeys;
+	base::flat_map<MediaKey, MediaKey> _locationsJournalAliases;
+	int _locationsJournalRecords = 0;
 
 	FileKey _locationsKey = 0;
 	FileKey _trustedBotsKey = 0;
@@ -273,6 +305,8 @@ private:
 	FileKey _exportSettingsKey = 0;
 	FileKey _installedMasksKey = 0;
 	FileKey _recentMasksKey = 0;
+	FileKey _sharedMediaCountsKey = 0;
+	FileKey _scheduledMessagesKey = 0;
 
 	qint64 _cacheTotalSizeLimit = 0;
 	qint64 _cacheBigFileTotalSizeLimit = 0;
@@ -281,6 +315,22 @@ private:
 
 	base::flat_map<PeerId, base::flags<BotTrustFlag>> _trustedBots;
 	bool _trustedBotsRead = false;
+
+	struct SavedSharedMediaCounts {
+		SharedMediaCounts counts;
+		int used = 0;
+	};
+	base::flat_map<PeerId, SavedSharedMediaCounts> _sharedMediaCounts;
+	int _sharedMediaCountsUsed = 0;
+	bool _sharedMediaCountsRead = false;
+
+	struct SavedScheduledMessages {
+		QByteArray serialized;
+		int used = 0;
+	};
+	base::flat_map<PeerId, SavedScheduledMessages> _scheduledMessages;
+	int _scheduledMessagesUsed = 0;
+	bool _scheduledMessagesRead = false;
 	bool _readingUserSettings = false;
 	bool _recentHashtagsAndBotsWereRead = false;
 
@@ -288,9 +338,13 @@ private:
 
 	base::Timer _writeMapTimer;
 	base::Timer _writeLocationsTimer;
+	base::Timer _writeDraftsTimer;
+	base::Timer _writeSharedMediaCountsTimer;
 	bool _mapChanged = false;
 	bool _locationsChanged = false;
 
+	rpl::lifetime _lifetime;
+
 };
 
 } // namespace Storage
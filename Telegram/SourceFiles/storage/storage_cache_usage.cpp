@@ -0,0 +1,50 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "storage/storage_cache_usage.h"
+
+#include <QtCore/QMutex>
+
+namespace Storage {
+namespace {
+
+QMutex UsageMutex;
+base::flat_map<uint16, CacheUsage> UsageByTag;
+
+} // namespace
+
+void RecordCacheRead(uint16 tag, int64 size, crl::time duration) {
+	QMutexLocker lock(&UsageMutex);
+	auto &usage = UsageByTag[tag];
+	if (size > 0) {
+		++usage.hits;
+		usage.bytesRead += size;
+	} else {
+		++usage.misses;
+	}
+	usage.readTime += duration;
+}
+
+CacheUsage CacheUsageByTag(uint16 tag) {
+	QMutexLocker lock(&UsageMutex);
+	const auto i = UsageByTag.find(tag);
+	return (i != end(UsageByTag)) ? i->second : CacheUsage();
+}
+
+CacheUsage CacheUsageTotal() {
+	QMutexLocker lock(&UsageMutex);
+	auto result = CacheUsage();
+	for (const auto &[tag, usage] : UsageByTag) {
+		result.hits += usage.hits;
+		result.misses += usage.misses;
+		result.bytesRead += usage.bytesRead;
+		result.readTime += usage.readTime;
+	}
+	return result;
+}
+
+} // namespace Storage
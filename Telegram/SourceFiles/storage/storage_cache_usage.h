@@ -0,0 +1,28 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Storage {
+
+// Reads from Data::Session::cacheBigFile() are counted under this tag.
+constexpr auto kCacheBigFileUsageTag = uint16(0xFFFF);
+
+struct CacheUsage {
+	int64 hits = 0;
+	int64 misses = 0;
+	int64 bytesRead = 0;
+	crl::time readTime = 0;
+};
+
+// May be called from any thread, an empty value is counted as a miss.
+void RecordCacheRead(uint16 tag, int64 size, crl::time duration);
+
+[[nodiscard]] CacheUsage CacheUsageByTag(uint16 tag);
+[[nodiscard]] CacheUsage CacheUsageTotal();
+
+} // namespace Storage
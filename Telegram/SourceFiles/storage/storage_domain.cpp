@@ -9,9 +9,11 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "storage/details/storage_file_utilities.h"
 #include "storage/serialize_common.h"
+#include "storage/cache/storage_cache_database.h"
 #include "mtproto/mtproto_config.h"
 #include "main/main_domain.h"
 #include "main/main_account.h"
+#include "core/application.h"
 #include "base/random.h"
 
 namespace Storage {
@@ -23,6 +25,10 @@ using namespace details;
 	return cWorkingDir() + qsl("tdata/");
 }
 
+[[nodiscard]] QString ComputeSharedCachePath(const QString &dataName) {
+	return BaseGlobalPath() + "shared_" + dataName + "/cache";
+}
+
 [[nodiscard]] QString ComputeKeyName(const QString &dataName) {
 	// We dropped old test authorizations when migrated to multi auth.
 	//return "key_" + dataName + (cTestMode() ? "[test]" : "");
@@ -167,34 +173,46 @@ Domain::StartModernResult Domain::startModern(
 
 	_oldVersion = keyData.version;
 
+	// Map files of all the accounts are read and decrypted in parallel,
+	// the accounts themselves are started one by one on the main thread.
 	auto tried = base::flat_set<int>();
-	auto sessions = base::flat_set<uint64>();
-	auto active = 0;
+	auto accounts = std::vector<Main::Domain::AccountWithIndex>();
+	accounts.reserve(count);
 	for (auto i = 0; i != count; ++i) {
 		auto index = qint32();
 		info.stream >> index;
 		if (index >= 0
 			&& index < Main::Domain::kMaxAccounts
 			&& tried.emplace(index).second) {
-			auto account = std::make_unique<Main::Account>(
-				_owner,
-				_dataName,
-				index);
-			auto config = account->prepareToStart(_localKey);
-			const auto sessionId = account->willHaveSessionUniqueId(
-				config.get());
-			if (!sessions.contains(sessionId)
-				&& (sessionId != 0 || (sessions.empty() && i + 1 == count))) {
-				if (sessions.empty()) {
-					active = index;
-				}
-				account->start(std::move(config));
-				_owner->accountAddedInStorage({
-					.index = index,
-					.account = std::move(account)
-				});
-				sessions.emplace(sessionId);
+			accounts.push_back({
+				.index = index,
+				.account = std::make_unique<Main::Account>(
+					_owner,
+					_dataName,
+					index),
+			});
+			accounts.back().account->local().prefetchMap(_localKey);
+		}
+	}
+
+	auto sessions = base::flat_set<uint64>();
+	auto active = 0;
+	for (auto &[index, account] : accounts) {
+		const auto last = (&account == &accounts.back().account);
+		auto config = account->prepareToStart(_localKey);
+		const auto sessionId = account->willHaveSessionUniqueId(
+			config.get());
+		if (!sessions.contains(sessionId)
+			&& (sessionId != 0 || (sessions.empty() && last))) {
+			if (sessions.empty()) {
+				active = index;
 			}
+			account->start(std::move(config));
+			_owner->accountAddedInStorage({
+				.index = index,
+				.account = std::move(account)
+			});
+			sessions.emplace(sessionId);
 		}
 	}
 	if (sessions.empty()) {
@@ -272,6 +290,28 @@ QString Domain::webviewDataPath() const {
 	return BaseGlobalPath() + "webview";
 }
 
+not_null<Cache::Database*> Domain::acquireSharedCache(
+		const Cache::Database::Settings &settings) {
+	Expects(_localKey != nullptr);
+
+	if (!_sharedCacheUsers++) {
+		_sharedCache.emplace(Core::App().databases().get(
+			ComputeSharedCachePath(_dataName),
+			settings));
+		(*_sharedCache)->open(
+			EncryptionKey(bytes::make_vector(_localKey->data())));
+	}
+	return &**_sharedCache;
+}
+
+void Domain::releaseSharedCache() {
+	Expects(_sharedCacheUsers > 0);
+
+	if (!--_sharedCacheUsers) {
+		_sharedCache = std::nullopt;
+	}
+}
+
 rpl::producer<> Domain::localPasscodeChanged() const {
 	return _passcodeKeyChanged.events();
 }
@@ -7,6 +7,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #pragma once
 
+#include "storage/storage_databases.h"
+
 namespace MTP {
 class Config;
 class AuthKey;
@@ -46,6 +48,13 @@ public:
 
 	[[nodiscard]] QString webviewDataPath() const;
 
+	// Public media cache shared by all accounts, opened while any
+	// account session keeps it acquired. It is opened with the limits of
+	// the first account, the local storage box updates and clears it.
+	[[nodiscard]] not_null<Cache::Database*> acquireSharedCache(
+		const Cache::Database::Settings &settings);
+	void releaseSharedCache();
+
 	[[nodiscard]] rpl::producer<> localPasscodeChanged() const;
 	[[nodiscard]] bool hasLocalPasscode() const;
 
@@ -76,6 +85,9 @@ private:
 	bool _hasLocalPasscode = false;
 	rpl::event_stream<> _passcodeKeyChanged;
 
+	std::optional<DatabasePointer> _sharedCache;
+	int _sharedCacheUsers = 0;
+
 };
 
 } // namespace Storage
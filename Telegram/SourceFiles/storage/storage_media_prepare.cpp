@@ -220,7 +220,7 @@ PreparedList PrepareMediaList(const QStringList &files, int previewWidth) {
 			result.files.back().size = filesize;
 		} else {
 			result.filesToProcess.emplace_back(file);
-			result.files.back().size = filesize;
+			result.filesToProcess.back().size = filesize;
 		}
 	}
 	PrepareDetailsInParallel(result, previewWidth);
@@ -17,6 +17,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include <crl/crl_async.h>
 #include <QtGui/QGuiApplication>
 
+#include <mutex>
+
 namespace Ui {
 namespace {
 
@@ -28,6 +30,15 @@ constexpr auto kMinimumTiledSize = 512;
 constexpr auto kMaxSize = 2960;
 constexpr auto kMaxContrastValue = 21.;
 constexpr auto kMinAcceptableContrast = 1.14;// 4.5;
+constexpr auto kRasterizedPatternsLimit = 4;
+constexpr auto kRasterizedPatternsBytesLimit = 48 * 1024 * 1024;
+
+struct RasterizedPattern {
+	QString path;
+	QByteArray bytes;
+	bool gzipSvg = false;
+	QImage image;
+};
 
 [[nodiscard]] QColor DefaultBackgroundColor() {
 	return QColor(213, 223, 233);
@@ -68,6 +79,26 @@ constexpr auto kMinAcceptableContrast = 1.14;// 4.5;
 	if (request.background.isPattern
 		|| request.background.tile
 		|| request.background.prepared.isNull()) {
+		// Rotations and width-only resizes keep the pattern scale.
+		const auto patternTile = [&] {
+			if (!request.background.isPattern
+				|| request.background.prepared.isNull()) {
+				return QImage();
+			}
+			const auto side = request.area.height()
+				* style::DevicePixelRatio();
+			const auto size = request.background.prepared.size().scaled(
+				side,
+				side,
+				Qt::KeepAspectRatio);
+			return (request.patternTile.size() == size)
+				? request.patternTile
+				: request.background.prepared.scaled(
+					side,
+					side,
+					Qt::KeepAspectRatio,
+					Qt::SmoothTransformation);
+		}();
 		auto result = gradient.isNull()
 			? QImage(
 				request.area * style::DevicePixelRatio(),
@@ -89,11 +120,7 @@ constexpr auto kMinAcceptableContrast = 1.14;// 4.5;
 				}
 			}
 			const auto tiled = request.background.isPattern
-				? request.background.prepared.scaled(
-					request.area.height() * style::DevicePixelRatio(),
-					request.area.height() * style::DevicePixelRatio(),
-					Qt::KeepAspectRatio,
-					Qt::SmoothTransformation)
+				? patternTile
 				: request.background.preparedForTiled;
 			const auto w = tiled.width() / float(style::DevicePixelRatio());
 			const auto h = tiled.height() / float(style::DevicePixelRatio());
@@ -123,6 +150,7 @@ constexpr auto kMinAcceptableContrast = 1.14;// 4.5;
 			.image = std::move(result).convertToFormat(
 				QImage::Format_ARGB32_Premultiplied),
 			.gradient = gradient,
+			.patternTile = patternTile,
 			.area = request.area,
 			.waitingForNegativePattern
 				= request.background.waitingForNegativePattern()
@@ -497,7 +525,10 @@ const BackgroundState &ChatTheme::backgroundState(QSize area) {
 		// We don't support direct painting of patterned gradients.
 		// So we need to sync-generate cache image here.
 		_cacheBackgroundArea = area;
-		setCachedBackground(CacheBackground(cacheBackgroundRequest(area)));
+		const auto request = cacheBackgroundRequest(area);
+		auto result = CacheBackground(request);
+		rememberPatternTile(request, result);
+		setCachedBackground(std::move(result));
 		_cacheBackgroundTimer->cancel();
 	} else if (_backgroundState.now.area != area) {
 		if (_cacheBackgroundArea != area
@@ -564,10 +595,14 @@ auto ChatTheme::cacheBackgroundRequest(QSize area, int addRotation) const
 	if (background().colorForFill) {
 		return {};
 	}
+	const auto &prepared = background().prepared;
 	return {
 		.background = background(),
 		.area = area,
 		.gradientRotationAdd = addRotation,
+		.patternTile = ((_patternTileSource == prepared.cacheKey())
+			? _patternTile
+			: QImage()),
 	};
 }
 
@@ -602,6 +637,7 @@ void ChatTheme::cacheBackgroundAsync(
 			return;
 		}
 		crl::on_main(weak, [=, result = CacheBackground(request)]() mutable {
+			rememberPatternTile(request, result);
 			if (done) {
 				done(std::move(result));
 			} else if (const auto request = cacheBackgroundRequest(
@@ -646,6 +682,15 @@ void ChatTheme::setCachedBackground(CacheBackgroundResult &&cached) {
 		kBackgroundFadeDuration);
 }
 
+void ChatTheme::rememberPatternTile(
+		const CacheBackgroundRequest &request,
+		const CacheBackgroundResult &result) {
+	if (!result.patternTile.isNull()) {
+		_patternTile = result.patternTile;
+		_patternTileSource = request.background.prepared.cacheKey();
+	}
+}
+
 auto ChatTheme::cacheBubblesRequest(QSize area) const
 -> CacheBackgroundRequest {
 	if (_bubblesBackgroundPrepared.isNull()) {
@@ -1010,9 +1055,63 @@ QImage GenerateDitheredGradient(
 	return result;
 }
 
+namespace {
+
+// Several chat themes usually share the same pattern, while its SVG
+// rasterization takes the most time of preparing the background.
+[[nodiscard]] QImage ReadPatternImage(const ChatThemeBackgroundData &data) {
+	static auto Mutex = std::mutex();
+	static auto Cache = std::deque<RasterizedPattern>();
+
+	const auto same = [&](const RasterizedPattern &pattern) {
+		return (pattern.gzipSvg == data.gzipSvg)
+			&& (pattern.path == data.path)
+			&& (pattern.bytes == data.bytes);
+	};
+	{
+		auto lock = std::lock_guard(Mutex);
+		const auto i = ranges::find_if(Cache, same);
+		if (i != end(Cache)) {
+			return i->image;
+		}
+	}
+	auto image = PreprocessBackgroundImage(
+		ReadBackgroundImage(data.path, data.bytes, data.gzipSvg));
+	if (image.isNull()) {
+		return image;
+	}
+	const auto bytes = int64(image.sizeInBytes());
+	if (bytes > kRasterizedPatternsBytesLimit) {
+		return image;
+	}
+	auto lock = std::lock_guard(Mutex);
+	if (ranges::none_of(Cache, same)) {
+		const auto cached = [&] {
+			return ranges::accumulate(
+				Cache,
+				int64(),
+				ranges::plus(),
+				[](const RasterizedPattern &pattern) {
+					return int64(pattern.image.sizeInBytes());
+				});
+		};
+		while (!Cache.empty()
+			&& (int(Cache.size()) >= kRasterizedPatternsLimit
+				|| cached() + bytes > kRasterizedPatternsBytesLimit)) {
+			Cache.pop_front();
+		}
+		Cache.push_back({ data.path, data.bytes, data.gzipSvg, image });
+	}
+	return image;
+}
+
+} // namespace
+
 ChatThemeBackground PrepareBackgroundImage(
 		const ChatThemeBackgroundData &data) {
-	auto prepared = (data.isPattern || data.colors.empty())
+	auto prepared = data.isPattern
+		? ReadPatternImage(data)
+		: data.colors.empty()
 		? PreprocessBackgroundImage(
 			ReadBackgroundImage(data.path, data.bytes, data.gzipSvg))
 		: QImage();
@@ -64,6 +64,9 @@ struct CacheBackgroundRequest {
 	int gradientRotationAdd = 0;
 	float64 gradientProgress = 1.;
 
+	// Pattern scaled for a previous request, reused if the size fits.
+	QImage patternTile;
+
 	explicit operator bool() const {
 		return !background.prepared.isNull()
 			|| !background.gradientForFill.isNull();
@@ -80,6 +83,7 @@ bool operator!=(
 struct CacheBackgroundResult {
 	QImage image;
 	QImage gradient;
+	QImage patternTile;
 	QSize area;
 	int x = 0;
 	int y = 0;
@@ -180,6 +184,9 @@ private:
 		const CacheBackgroundRequest &request,
 		Fn<void(CacheBackgroundResult&&)> done = nullptr);
 	void setCachedBackground(CacheBackgroundResult &&cached);
+	void rememberPatternTile(
+		const CacheBackgroundRequest &request,
+		const CacheBackgroundResult &result);
 	[[nodiscard]] CacheBackgroundRequest cacheBackgroundRequest(
 		QSize area,
 		int addRotation = 0) const;
@@ -208,6 +215,8 @@ private:
 	CacheBackgroundRequest _backgroundCachingRequest;
 	CacheBackgroundResult _backgroundNext;
 	QSize _cacheBackgroundArea;
+	QImage _patternTile;
+	qint64 _patternTileSource = 0;
 	crl::time _lastBackgroundAreaChangeTime = 0;
 	std::optional<base::Timer> _cacheBackgroundTimer;
 
@@ -29,6 +29,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "styles/style_settings.h"
 #include "styles/style_window.h"
 
+#include <crl/crl_async.h>
 #include <QtWidgets/QApplication>
 
 namespace Ui {
@@ -36,11 +37,29 @@ namespace {
 
 constexpr auto kDisableElement = "disable"_cs;
 
-[[nodiscard]] QImage GeneratePreview(not_null<Ui::ChatTheme*> theme) {
-	const auto &background = theme->background();
+struct PreviewKey {
+	ChatThemeKey theme;
+	int factor = 0;
+
+	friend inline bool operator<(PreviewKey a, PreviewKey b) {
+		return (a.theme < b.theme)
+			|| ((a.theme == b.theme) && (a.factor < b.factor));
+	}
+};
+
+// Previews are kept while the app runs, the panel is opened often.
+[[nodiscard]] base::flat_map<PreviewKey, QImage> &PreviewsCache() {
+	static auto result = base::flat_map<PreviewKey, QImage>();
+	return result;
+}
+
+// Called on a worker thread, uses only the prepared background.
+[[nodiscard]] QImage GeneratePreviewBackground(
+		const ChatThemeBackground &background,
+		int factor) {
 	const auto &colors = background.colors;
 	const auto size = st::settingsThemePreviewSize;
-	auto prepared = background.prepared;
+	const auto &prepared = background.prepared;
 	const auto paintPattern = [&](QPainter &p, bool inverted) {
 		if (prepared.isNull()) {
 			return;
@@ -65,11 +84,9 @@ constexpr auto kDisableElement = "disable"_cs;
 		if (inverted) {
 			small = Ui::InvertPatternImage(std::move(small));
 		}
-		p.drawImage(
-			QRect(QPoint(), size * style::DevicePixelRatio()),
-			small);
+		p.drawImage(QRect(QPoint(), size * factor), small);
 	};
-	const auto fullsize = size * style::DevicePixelRatio();
+	const auto fullsize = size * factor;
 	auto result = background.waitingForNegativePattern()
 		? QImage(
 			fullsize,
@@ -83,7 +100,14 @@ constexpr auto kDisableElement = "disable"_cs;
 	if (background.waitingForNegativePattern()) {
 		result.fill(Qt::black);
 	}
-	result.setDevicePixelRatio(style::DevicePixelRatio());
+	result.setDevicePixelRatio(factor);
+	return result;
+}
+
+[[nodiscard]] QImage FinishPreview(
+		QImage result,
+		not_null<Ui::ChatTheme*> theme) {
+	const auto size = st::settingsThemePreviewSize;
 	{
 		auto p = QPainter(&result);
 		const auto sent = QRect(
@@ -122,6 +146,16 @@ constexpr auto kDisableElement = "disable"_cs;
 	return result;
 }
 
+[[nodiscard]] QImage GenerateLoadingPreview() {
+	auto result = QImage(
+		st::settingsThemePreviewSize * style::DevicePixelRatio(),
+		QImage::Format_ARGB32_Premultiplied);
+	result.fill(st::settingsThemeNotSupportedBg->c);
+	result.setDevicePixelRatio(style::DevicePixelRatio());
+	Images::prepareRound(result, ImageRoundRadius::Large);
+	return result;
+}
+
 [[nodiscard]] QImage GenerateEmptyPreview() {
 	auto result = QImage(
 		st::settingsThemePreviewSize * style::DevicePixelRatio(),
@@ -528,8 +562,13 @@ void ChooseThemeController::fill(
 			}
 			const auto key = ChatThemeKey{ theme.id, dark };
 			const auto isChosen = (_chosen == emoji->text());
+			const auto &cache = PreviewsCache();
+			const auto cached = cache.find({ key, style::DevicePixelRatio() });
 			_entries.push_back({
 				.key = key,
+				.preview = ((cached != end(cache))
+					? cached->second
+					: GenerateLoadingPreview()),
 				.emoji = emoji,
 				.geometry = QRect(QPoint(x, skip), single),
 				.chosen = isChosen,
@@ -549,11 +588,10 @@ void ChooseThemeController::fill(
 				}
 				const auto theme = data.get();
 				i->theme = std::move(data);
-				i->preview = GeneratePreview(theme);
+				generatePreview(key);
 				if (_chosen == i->emoji->text()) {
 					_controller->overridePeerTheme(_peer, i->theme);
 				}
-				_inner->update();
 
 				if (!theme->background().isPattern
 					|| !theme->background().prepared.isNull()) {
@@ -576,8 +614,7 @@ void ChooseThemeController::fill(
 					if (i == end(_entries)) {
 						return;
 					}
-					i->preview = GeneratePreview(theme);
-					_inner->update();
+					generatePreview(key);
 				}, _cachingLifetime);
 			}, _cachingLifetime);
 			x += single.width() + skip;
@@ -590,6 +627,44 @@ void ChooseThemeController::fill(
 	_shouldBeShown = true;
 }
 
+void ChooseThemeController::generatePreview(ChatThemeKey key) {
+	const auto i = ranges::find(_entries, key, &Entry::key);
+	if (i == end(_entries) || !i->theme) {
+		return;
+	}
+	const auto theme = i->theme;
+	const auto &background = theme->background();
+	const auto factor = style::DevicePixelRatio();
+	const auto previewKey = PreviewKey{ key, factor };
+
+	// Don't remember previews with the pattern that is still loading.
+	const auto ready = !background.isPattern
+		|| !background.prepared.isNull();
+	if (ready) {
+		const auto &cache = PreviewsCache();
+		const auto cached = cache.find(previewKey);
+		if (cached != end(cache)) {
+			i->preview = cached->second;
+			_inner->update();
+			return;
+		}
+	}
+	crl::async([=, background = background] {
+		auto image = GeneratePreviewBackground(background, factor);
+		crl::on_main(_inner.get(), [=, image = std::move(image)]() mutable {
+			const auto i = ranges::find(_entries, key, &Entry::key);
+			if (i == end(_entries) || i->theme != theme) {
+				return;
+			}
+			i->preview = FinishPreview(std::move(image), theme.get());
+			if (ready) {
+				PreviewsCache()[previewKey] = i->preview;
+			}
+			_inner->update();
+		});
+	});
+}
+
 bool ChooseThemeController::shouldBeShown() const {
 	return _shouldBeShown.current();
 }
@@ -22,6 +22,7 @@ namespace Ui {
 class RpWidget;
 class PlainShadow;
 class VerticalLayout;
+struct ChatThemeKey;
 
 class ChooseThemeController final {
 public:
@@ -52,6 +53,7 @@ private:
 	void close();
 
 	void clearCurrentBackgroundState();
+	void generatePreview(ChatThemeKey key);
 	void paintEntry(QPainter &p, const Entry &entry);
 	void applyInitialInnerLeft();
 	void updateInnerLeft(int now);
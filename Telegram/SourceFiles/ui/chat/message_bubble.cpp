@@ -120,12 +120,14 @@ void PaintPatternBubble(Painter &p, const SimpleBubble &args) {
 			mask,
 			cache);
 	};
+	struct Sprite {
+		int index = 0;
+		QPoint position;
+	};
+	auto sprites = std::array<Sprite, 5>();
+	auto spritesCount = 0;
 	const auto fillCorner = [&](int x, int y, int index) {
-		fillPattern(
-			x,
-			y,
-			pattern->corners[index],
-			(index < 2) ? pattern->cornerTopCache : pattern->cornerBottomCache);
+		sprites[spritesCount++] = { index, QPoint(x, y) };
 	};
 	const auto fillRounded = [&](const QRect &rect, RectParts parts) {
 		const auto x = rect.x();
@@ -208,12 +210,73 @@ void PaintPatternBubble(Painter &p, const SimpleBubble &args) {
 		}
 	};
 	const auto paintTail = [&](QPoint bottomPosition) {
-		const auto position = bottomPosition - tailShift;
-		fillPattern(position.x(), position.y(), tail, pattern->tailCache);
+		const auto index = (args.tailSide == RectPart::Right) ? 5 : 4;
+		sprites[spritesCount++] = { index, bottomPosition - tailShift };
 		return tail.width() / int(tail.devicePixelRatio());
 	};
+	const auto paintSprites = [&] {
+		if (!spritesCount) {
+			return;
+		} else if (pattern->atlas.isNull()) {
+			for (auto i = 0; i != spritesCount; ++i) {
+				const auto [index, position] = sprites[i];
+				if (index < 4) {
+					fillPattern(
+						position.x(),
+						position.y(),
+						pattern->corners[index],
+						(index < 2)
+							? pattern->cornerTopCache
+							: pattern->cornerBottomCache);
+				} else {
+					fillPattern(
+						position.x(),
+						position.y(),
+						tail,
+						pattern->tailCache);
+				}
+			}
+			return;
+		}
+
+		// Mask all the sprites of the bubble in one pass over the atlas.
+		const auto ratio = int(pattern->atlas.devicePixelRatio());
+		auto &cache = pattern->atlasCache;
+		if (cache.size() != pattern->atlas.size()) {
+			cache = QImage(
+				pattern->atlas.size(),
+				QImage::Format_ARGB32_Premultiplied);
+		}
+		cache.setDevicePixelRatio(ratio);
+		memcpy(
+			cache.bits(),
+			pattern->atlas.constBits(),
+			pattern->atlas.sizeInBytes());
+		auto q = QPainter(&cache);
+		q.setCompositionMode(QPainter::CompositionMode_SourceIn);
+		for (auto i = 0; i != spritesCount; ++i) {
+			const auto [index, position] = sprites[i];
+			const auto &part = pattern->atlasParts[index];
+			const auto origin = part.topLeft() / ratio;
+			PaintPatternBubblePart(
+				q,
+				args.patternViewport.translated(origin - position),
+				pattern->pixmap,
+				QRect(origin, part.size() / ratio));
+		}
+		q.end();
+		for (auto i = 0; i != spritesCount; ++i) {
+			const auto [index, position] = sprites[i];
+			const auto &part = pattern->atlasParts[index];
+			p.drawImage(
+				QRect(position, part.size() / ratio),
+				cache,
+				part);
+		}
+	};
 	p.setOpacity(opacity);
 	PaintBubbleGeneric(args, fillBg, fillSh, fillRounded, paintTail);
+	paintSprites();
 	p.setOpacity(1.);
 }
 
@@ -277,6 +340,39 @@ std::unique_ptr<BubblePattern> PrepareBubblePattern(
 	result->cornerBottomCache = QImage(
 		result->corners[2].size(),
 		QImage::Format_ARGB32_Premultiplied);
+
+	const auto sprites = std::array<const QImage*, 6>{
+		&result->corners[0],
+		&result->corners[1],
+		&result->corners[2],
+		&result->corners[3],
+		&result->tailLeft,
+		&result->tailRight,
+	};
+	const auto ratio = style::DevicePixelRatio();
+	auto width = 0;
+	auto height = 0;
+	for (auto i = 0; i != int(sprites.size()); ++i) {
+		const auto size = sprites[i]->size();
+		result->atlasParts[i] = QRect(QPoint(width, 0), size);
+		width += size.width() + ratio;
+		height = std::max(height, size.height());
+	}
+	result->atlas = QImage(
+		QSize(width, height),
+		QImage::Format_ARGB32_Premultiplied);
+	result->atlas.fill(Qt::transparent);
+	{
+		auto p = QPainter(&result->atlas);
+		p.setCompositionMode(QPainter::CompositionMode_Source);
+		for (auto i = 0; i != int(sprites.size()); ++i) {
+			p.drawImage(
+				result->atlasParts[i],
+				*sprites[i],
+				sprites[i]->rect());
+		}
+	}
+	result->atlas.setDevicePixelRatio(ratio);
 	return result;
 }
 
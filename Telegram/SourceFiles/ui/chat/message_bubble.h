@@ -29,6 +29,12 @@ struct BubblePattern {
 	mutable QImage cornerTopCache;
 	mutable QImage cornerBottomCache;
 	mutable QImage tailCache;
+
+	// Corner and tail masks packed in one image, in device pixels:
+	// four corners, then the left and the right tails.
+	QImage atlas;
+	std::array<QRect, 6> atlasParts;
+	mutable QImage atlasCache;
 };
 
 [[nodiscard]] std::unique_ptr<BubblePattern> PrepareBubblePattern(
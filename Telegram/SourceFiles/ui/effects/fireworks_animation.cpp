@@ -15,6 +15,7 @@ namespace {
 constexpr auto kParticlesCount = 60;
 constexpr auto kFallCount = 30;
 constexpr auto kFirstUpdateTime = crl::time(16);
+constexpr auto kMinUpdateDelay = crl::time(12);
 constexpr auto kFireworkWidth = 480;
 constexpr auto kFireworkHeight = 320;
 
@@ -57,6 +58,10 @@ FireworksAnimation::FireworksAnimation(Fn<void()> repaint)
 }
 
 void FireworksAnimation::update(crl::time now) {
+	// Don't go beyond ~60 fps on high refresh rate screens.
+	if (_lastUpdate && now - _lastUpdate < kMinUpdateDelay) {
+		return;
+	}
 	const auto passed = _lastUpdate ? (now - _lastUpdate) : kFirstUpdateTime;
 	_lastUpdate = now;
 	auto allFinished = true;
@@ -67,6 +72,7 @@ void FireworksAnimation::update(crl::time now) {
 		}
 	}
 	if (allFinished) {
+		_finished = true;
 		_animation.stop();
 	} else if (_fallingDown >= kParticlesCount / 2 && _speedCoef > 0.2) {
 		startFall();
@@ -91,7 +97,20 @@ bool FireworksAnimation::paint(QPainter &p, const QRect &rect) {
 		}
 	}
 	p.setClipping(false);
-	return _animation.animating();
+	return !_finished;
+}
+
+void FireworksAnimation::setPaused(bool paused) {
+	if (_paused == paused || _finished) {
+		return;
+	}
+	_paused = paused;
+	if (_paused) {
+		_animation.stop();
+	} else {
+		_lastUpdate = 0;
+		_animation.start();
+	}
 }
 
 void FireworksAnimation::paintParticle(
@@ -16,6 +16,7 @@ public:
 	explicit FireworksAnimation(Fn<void()> repaint);
 
 	bool paint(QPainter &p, const QRect &rect);
+	void setPaused(bool paused);
 
 private:
 	struct Particle {
@@ -57,6 +58,8 @@ private:
 	int _fallingDown = 0;
 	int _smallSide = 0;
 	bool _startedFall = false;
+	bool _finished = false;
+	bool _paused = false;
 
 };
 
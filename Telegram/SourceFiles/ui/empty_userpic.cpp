@@ -19,6 +19,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace Ui {
 namespace {
 
+// Total size of the frames cached by all empty userpics.
+constexpr auto kCachedFramesLimit = int64(32 * 1024 * 1024);
+int64 CachedFramesBytes = 0;
+
 [[nodiscard]] bool IsExternal(const QString &name) {
 	return !name.isEmpty()
 		&& (name.front() == QChar(0))
@@ -174,6 +178,17 @@ template <typename Callback>
 	return Ui::PixmapFromImage(std::move(result));
 }
 
+// No emoji starts with a plain ASCII character, except for the keycaps,
+// so most names can be scanned without looking up the emoji tables.
+[[nodiscard]] bool MayStartEmoji(const QChar *ch, const QChar *end) {
+	if (ch->unicode() >= 0x80) {
+		return true;
+	}
+	const auto next = ch + 1;
+	return (next != end)
+		&& (next->unicode() == 0xFE0F || next->unicode() == 0x20E3);
+}
+
 } // namespace
 
 EmptyUserpic::EmptyUserpic(const style::color &color, const QString &name)
@@ -181,6 +196,20 @@ EmptyUserpic::EmptyUserpic(const style::color &color, const QString &name)
 	fillString(name);
 }
 
+EmptyUserpic::EmptyUserpic(const EmptyUserpic &other)
+: _color(other._color)
+, _string(other._string) {
+}
+
+EmptyUserpic &EmptyUserpic::operator=(const EmptyUserpic &other) {
+	if (this != &other) {
+		clearCache();
+		_color = other._color;
+		_string = other._string;
+	}
+	return *this;
+}
+
 QString EmptyUserpic::ExternalName() {
 	return QChar(0) + u"external"_q;
 }
@@ -192,16 +221,31 @@ void EmptyUserpic::paint(
 		int y,
 		int outerWidth,
 		int size,
+		Shape shape,
 		Callback paintBackground) const {
 	x = rtl() ? (outerWidth - x - size) : x;
 
+	if (const auto cached = cachedFrame(size, shape, paintBackground)) {
+		p.drawPixmap(x, y, *cached);
+	} else {
+		paintFrame(p, x, y, size, paintBackground);
+	}
+}
+
+template <typename Callback>
+void EmptyUserpic::paintFrame(
+		Painter &p,
+		int x,
+		int y,
+		int size,
+		Callback paintBackground) const {
 	const auto fontsize = (size * 13) / 33;
 	auto font = style::font(fontsize, st::historyPeerUserpicFont->flags(), st::historyPeerUserpicFont->family());
 
 	PainterHighQualityEnabler hq(p);
 	p.setBrush(_color);
 	p.setPen(Qt::NoPen);
-	paintBackground();
+	paintBackground(p, x, y, size);
 
 	if (IsExternal(_string)) {
 		PaintExternalMessagesInner(p, x, y, size, st::historyPeerUserpicFg);
@@ -216,6 +260,52 @@ void EmptyUserpic::paint(
 	}
 }
 
+template <typename Callback>
+const QPixmap *EmptyUserpic::cachedFrame(
+		int size,
+		Shape shape,
+		Callback paintBackground) const {
+	if (_cacheBg != _color->c || _cacheFg != st::historyPeerUserpicFg->c) {
+		clearCache();
+		_cacheBg = _color->c;
+		_cacheFg = st::historyPeerUserpicFg->c;
+	}
+	// Cache only from the second paint, so that temporary userpics
+	// painted just once don't render their frames twice.
+	const auto key = (size << 2) | int(shape);
+	const auto i = _cache.find(key);
+	if (i == end(_cache)) {
+		_cache.emplace(key, QPixmap());
+		return nullptr;
+	} else if (!i->second.isNull()) {
+		return &i->second;
+	}
+	const auto bytes = int64(size) * size * 4
+		* cIntRetinaFactor() * cIntRetinaFactor();
+	if (CachedFramesBytes + bytes > kCachedFramesLimit) {
+		return nullptr;
+	}
+	auto image = QImage(
+		QSize(size, size) * cIntRetinaFactor(),
+		QImage::Format_ARGB32_Premultiplied);
+	image.setDevicePixelRatio(cRetinaFactor());
+	image.fill(Qt::transparent);
+	{
+		Painter q(&image);
+		paintFrame(q, 0, 0, size, paintBackground);
+	}
+	CachedFramesBytes += bytes;
+	i->second = Ui::PixmapFromImage(std::move(image));
+	return &i->second;
+}
+
+void EmptyUserpic::clearCache() const {
+	for (const auto &[key, pixmap] : _cache) {
+		CachedFramesBytes -= int64(pixmap.width()) * pixmap.height() * 4;
+	}
+	_cache.clear();
+}
+
 void EmptyUserpic::paint(
 		Painter &p,
 		int x,
@@ -236,26 +326,42 @@ void EmptyUserpic::paint(
 			break;
 
 		default:
-			paint(p, x, y, outerWidth, size, [&p, x, y, size] {
+			paint(p, x, y, outerWidth, size, Shape::Circle, [](
+					Painter &p,
+					int x,
+					int y,
+					int size) {
 				p.drawEllipse(x, y, size, size);
 			});
 	}
 }
 
 void EmptyUserpic::paintRoundedLarge(Painter &p, int x, int y, int outerWidth, int size) const {
-	paint(p, x, y, outerWidth, size, [&p, x, y, size] {
+	paint(p, x, y, outerWidth, size, Shape::RoundedLarge, [](
+			Painter &p,
+			int x,
+			int y,
+			int size) {
 		p.drawRoundedRect(x, y, size, size, st::dateRadius, st::dateRadius);
 	});
 }
 
 void EmptyUserpic::paintRounded(Painter &p, int x, int y, int outerWidth, int size) const {
-	paint(p, x, y, outerWidth, size, [&p, x, y, size] {
+	paint(p, x, y, outerWidth, size, Shape::Rounded, [](
+			Painter &p,
+			int x,
+			int y,
+			int size) {
 		p.drawRoundedRect(x, y, size, size, st::roundRadiusSmall, st::roundRadiusSmall);
 	});
 }
 
 void EmptyUserpic::paintSquare(Painter &p, int x, int y, int outerWidth, int size) const {
-	paint(p, x, y, outerWidth, size, [&p, x, y, size] {
+	paint(p, x, y, outerWidth, size, Shape::Square, [](
+			Painter &p,
+			int x,
+			int y,
+			int size) {
 		p.fillRect(x, y, size, size, p.brush());
 	});
 }
@@ -593,7 +699,8 @@ void EmptyUserpic::fillString(const QString &name) {
 	auto ch = name.constData(), end = ch + name.size();
 	while (ch != end) {
 		auto emojiLength = 0;
-		if (Ui::Emoji::Find(ch, end, &emojiLength)) {
+		if (MayStartEmoji(ch, end)
+			&& Ui::Emoji::Find(ch, end, &emojiLength)) {
 			ch += emojiLength;
 		} else if (ch->isHighSurrogate()) {
 			++ch;
@@ -642,6 +749,8 @@ void EmptyUserpic::fillString(const QString &name) {
 	_string = _string.toUpper();
 }
 
-EmptyUserpic::~EmptyUserpic() = default;
+EmptyUserpic::~EmptyUserpic() {
+	clearCache();
+}
 
 } // namespace Ui
@@ -14,6 +14,8 @@ public:
 	[[nodiscard]] static QString ExternalName();
 
 	EmptyUserpic(const style::color &color, const QString &name);
+	EmptyUserpic(const EmptyUserpic &other);
+	EmptyUserpic &operator=(const EmptyUserpic &other);
 
 	void paint(
 		Painter &p,
@@ -163,6 +165,13 @@ public:
 	~EmptyUserpic();
 
 private:
+	enum class Shape : uchar {
+		Circle,
+		RoundedLarge,
+		Rounded,
+		Square,
+	};
+
 	template <typename Callback>
 	void paint(
 		Painter &p,
@@ -170,13 +179,32 @@ private:
 		int y,
 		int outerWidth,
 		int size,
+		Shape shape,
 		Callback paintBackground) const;
+	template <typename Callback>
+	void paintFrame(
+		Painter &p,
+		int x,
+		int y,
+		int size,
+		Callback paintBackground) const;
+	template <typename Callback>
+	[[nodiscard]] const QPixmap *cachedFrame(
+		int size,
+		Shape shape,
+		Callback paintBackground) const;
+	void clearCache() const;
 
 	void fillString(const QString &name);
 
 	style::color _color;
 	QString _string;
 
+	// Rendered frames by size and shape, shared by all the widgets.
+	mutable base::flat_map<int, QPixmap> _cache;
+	mutable QColor _cacheBg;
+	mutable QColor _cacheFg;
+
 };
 
 } // namespace Ui
@@ -10,6 +10,18 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace Ui {
 namespace {
 
+// Albums are laid out again on every initDimensions() of their views,
+// the same inputs come repeatedly while scrolling and resizing.
+constexpr auto kLayoutCacheSize = 64;
+
+struct LayoutCacheEntry {
+	std::vector<QSize> sizes;
+	int maxWidth = 0;
+	int minWidth = 0;
+	int spacing = 0;
+	std::vector<GroupMediaLayout> layout;
+};
+
 int Round(float64 value) {
 	return int(base::SafeRound(value));
 }
@@ -571,7 +583,32 @@ std::vector<GroupMediaLayout> LayoutMediaGroup(
 		int maxWidth,
 		int minWidth,
 		int spacing) {
-	return Layouter(sizes, maxWidth, minWidth, spacing).layout();
+	// Used only from the main thread.
+	static auto Cache = std::vector<LayoutCacheEntry>();
+
+	const auto i = ranges::find_if(Cache, [&](const LayoutCacheEntry &entry) {
+		return (entry.maxWidth == maxWidth)
+			&& (entry.minWidth == minWidth)
+			&& (entry.spacing == spacing)
+			&& (entry.sizes == sizes);
+	});
+	if (i != end(Cache)) {
+		auto result = i->layout;
+		std::rotate(i, i + 1, end(Cache));
+		return result;
+	}
+	auto result = Layouter(sizes, maxWidth, minWidth, spacing).layout();
+	if (Cache.size() >= kLayoutCacheSize) {
+		Cache.erase(begin(Cache));
+	}
+	Cache.push_back({
+		.sizes = sizes,
+		.maxWidth = maxWidth,
+		.minWidth = minWidth,
+		.spacing = spacing,
+		.layout = result,
+	});
+	return result;
 }
 
 RectParts GetCornersFromSides(RectParts sides) {
@@ -27,6 +27,20 @@ namespace {
 	return PixKey(0, 0, options);
 }
 
+// Blurred placeholders of one image are often painted at several sizes
+// at once, for example in the chat, in the shared media and in the viewer.
+constexpr auto kBlurredSingleCacheSize = 4;
+
+[[nodiscard]] uint64 BlurredSinglePixKey(
+		int outerw,
+		int outerh,
+		Options options) {
+	// Keep those apart from the PixKey(w, h, options) of pixBlurred().
+	return PixKey(outerw, outerh, options) | (uint64(1) << 23);
+}
+
+std::atomic<int64> ResidentBytesCounter = 0;
+
 } // namespace
 
 QByteArray ExpandInlineBytes(const QByteArray &bytes) {
@@ -296,6 +310,21 @@ Image::Image(const QByteArray &content)
 Image::Image(QImage &&data)
 : _data(data.isNull() ? Empty()->original() : std::move(data)) {
 	Expects(!_data.isNull());
+
+	ResidentBytesCounter += _data.sizeInBytes();
+}
+
+Image::Image(const Image &other)
+: _data(other._data) {
+	ResidentBytesCounter += _data.sizeInBytes();
+}
+
+Image::~Image() {
+	ResidentBytesCounter -= _data.sizeInBytes();
+}
+
+int64 Image::ResidentBytes() {
+	return ResidentBytesCounter.load();
 }
 
 not_null<Image*> Image::Empty() {
@@ -552,12 +581,20 @@ const QPixmap &Image::pixBlurredSingle(
 		options |= Option::Colored;
 	}
 
-	auto k = SinglePixKey(options);
+	auto k = BlurredSinglePixKey(outerw, outerh, options);
 	auto i = _cache.find(k);
-	if (i == _cache.cend() || i->second.width() != (outerw * cIntRetinaFactor()) || i->second.height() != (outerh * cIntRetinaFactor())) {
+	if (i == _cache.cend()) {
 		auto p = pixNoCache(w, h, options, outerw, outerh, colored);
 		p.setDevicePixelRatio(cRetinaFactor());
+		if (_blurredSingleKeys.size() >= kBlurredSingleCacheSize) {
+			_cache.remove(_blurredSingleKeys.front());
+			_blurredSingleKeys.erase(begin(_blurredSingleKeys));
+		}
+		_blurredSingleKeys.push_back(k);
 		i = _cache.emplace_or_assign(k, p).first;
+	} else if (_blurredSingleKeys.back() != k) {
+		const auto j = ranges::find(_blurredSingleKeys, k);
+		std::rotate(j, j + 1, end(_blurredSingleKeys));
 	}
 	return i->second;
 }
@@ -24,10 +24,15 @@ public:
 	explicit Image(const QString &path);
 	explicit Image(const QByteArray &content);
 	explicit Image(QImage &&data);
+	Image(const Image &other);
+	~Image();
 
 	[[nodiscard]] static not_null<Image*> Empty(); // 1x1 transparent
 	[[nodiscard]] static not_null<Image*> BlankMedia(); // 1x1 black
 
+	// Size of all decoded images that are currently alive.
+	[[nodiscard]] static int64 ResidentBytes();
+
 	[[nodiscard]] int width() const {
 		return _data.width();
 	}
@@ -94,5 +99,6 @@ public:
 private:
 	const QImage _data;
 	mutable base::flat_map<uint64, QPixmap> _cache;
+	mutable std::vector<uint64> _blurredSingleKeys;
 
 };
@@ -494,6 +494,14 @@ Storage::Cache::Key StorageFileLocation::cacheKey() const {
 	return Key();
 }
 
+Storage::Cache::Key StorageFileLocation::sharedCacheKey() const {
+	if (_type != Type::Document && _type != Type::Photo) {
+		return Storage::Cache::Key();
+	}
+	const auto key = cacheKey();
+	return Storage::Cache::Key{ key.high ^ _accessHash, key.low };
+}
+
 Storage::Cache::Key StorageFileLocation::bigFileBaseCacheKey() const {
 	switch (_type) {
 	case Type::Document: {
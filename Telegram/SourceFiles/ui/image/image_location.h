@@ -90,6 +90,9 @@ public:
 	[[nodiscard]] Storage::Cache::Key cacheKey() const;
 	[[nodiscard]] Storage::Cache::Key bigFileBaseCacheKey() const;
 
+	// Key in the cache shared by all accounts, requires the access hash.
+	[[nodiscard]] Storage::Cache::Key sharedCacheKey() const;
+
 	// We have to allow checking this because of a serialization bug.
 	[[nodiscard]] bool isDocumentThumbnail() const;
 
@@ -41,6 +41,11 @@ namespace Notifications {
 namespace Default {
 namespace {
 
+constexpr auto kMergeNotificationsDelay = crl::time(3000);
+constexpr auto kShowNotificationsLimit = 3;
+constexpr auto kShowNotificationsInterval = crl::time(1000);
+constexpr auto kUserpicsCacheSize = 16;
+
 QPoint notificationStartPosition() {
 	const auto corner = Core::App().settings().notificationsCorner();
 	const auto window = Core::App().activeWindow();
@@ -67,11 +72,17 @@ std::unique_ptr<Manager> Create(System *system) {
 
 Manager::Manager(System *system)
 : Notifications::Manager(system)
-, _inputCheckTimer([=] { checkLastInput(); }) {
+, _inputCheckTimer([=] { checkLastInput(); })
+, _showNextTimer([=] { showNextFromQueue(); }) {
 	system->settingsChanged(
 	) | rpl::start_with_next([=](ChangeType change) {
 		settingsChanged(change);
 	}, _lifetime);
+
+	style::PaletteChanged(
+	) | rpl::start_with_next([=] {
+		_userpics.clear();
+	}, _lifetime);
 }
 
 Manager::QueuedNotification::QueuedNotification(
@@ -82,7 +93,8 @@ Manager::QueuedNotification::QueuedNotification(
 , author(item->notificationHeader())
 , item((forwardedCount < 2) ? item.get() : nullptr)
 , forwardedCount(forwardedCount)
-, fromScheduled((item->out() || peer->isSelf()) && item->isFromScheduled()) {
+, fromScheduled((item->out() || peer->isSelf()) && item->isFromScheduled())
+, when(crl::now()) {
 }
 
 QPixmap Manager::hiddenUserpicPlaceholder() const {
@@ -98,6 +110,29 @@ QPixmap Manager::hiddenUserpicPlaceholder() const {
 	return _hiddenUserpicPlaceholder;
 }
 
+QPixmap Manager::userpic(
+		not_null<PeerData*> peer,
+		std::shared_ptr<Data::CloudImageView> &view) {
+	const auto key = peer->userpicUniqueKey(view);
+	const auto cornersType = cUserpicCornersType();
+	const auto i = _userpics.find(peer);
+	if (i != end(_userpics)
+		&& i->second.key == key
+		&& i->second.cornersType == cornersType) {
+		return i->second.pixmap;
+	}
+	auto result = peer->genUserpic(view, st::notifyPhotoSize);
+	if (i != end(_userpics)) {
+		i->second = { key, cornersType, result };
+	} else {
+		if (_userpics.size() >= kUserpicsCacheSize) {
+			_userpics.clear();
+		}
+		_userpics.emplace(peer, CachedUserpic{ key, cornersType, result });
+	}
+	return result;
+}
+
 bool Manager::hasReplyingNotification() const {
 	for (const auto &notification : _notifications) {
 		if (notification->isReplying()) {
@@ -219,6 +254,17 @@ void Manager::showNextFromQueue() {
 	auto startShift = 0;
 	auto shiftDirection = notificationShiftDirection();
 	do {
+		const auto now = crl::now();
+		if (now - _shownIntervalStart >= kShowNotificationsInterval) {
+			_shownIntervalStart = now;
+			_shownInInterval = 0;
+		} else if (_shownInInterval >= kShowNotificationsLimit) {
+			_showNextTimer.callOnce(
+				_shownIntervalStart + kShowNotificationsInterval - now);
+			break;
+		}
+		++_shownInInterval;
+
 		auto queued = _queuedNotifications.front();
 		_queuedNotifications.pop_front();
 
@@ -345,7 +391,29 @@ void Manager::removeWidget(internal::Widget *remove) {
 void Manager::doShowNotification(
 		not_null<HistoryItem*> item,
 		int forwardedCount) {
-	_queuedNotifications.emplace_back(item, forwardedCount);
+	auto queued = QueuedNotification(item, forwardedCount);
+	if (queued.item) {
+		for (const auto &notification : _notifications) {
+			if (notification->mergeWith(
+					item,
+					queued.author,
+					queued.fromScheduled)) {
+				return;
+			}
+		}
+		const auto i = ranges::find_if(_queuedNotifications, [&](
+				const QueuedNotification &already) {
+			return (already.history == queued.history)
+				&& (already.item != nullptr)
+				&& (already.fromScheduled == queued.fromScheduled)
+				&& (queued.when - already.when < kMergeNotificationsDelay);
+		});
+		if (i != end(_queuedNotifications)) {
+			*i = std::move(queued);
+			return;
+		}
+	}
+	_queuedNotifications.push_back(std::move(queued));
 	showNextFromQueue();
 }
 
@@ -359,6 +427,7 @@ void Manager::doClearAll() {
 
 void Manager::doClearAllFast() {
 	_queuedNotifications.clear();
+	_userpics.clear();
 	base::take(_notifications);
 	base::take(_hideAll);
 }
@@ -392,6 +461,13 @@ void Manager::doClearFromSession(not_null<Main::Session*> session) {
 			_positionsOutdated = true;
 		}
 	}
+	for (auto i = _userpics.begin(); i != _userpics.end();) {
+		if (&i->first->session() == session) {
+			i = _userpics.erase(i);
+		} else {
+			++i;
+		}
+	}
 	showNextFromQueue();
 }
 
@@ -770,7 +846,10 @@ void Notification::updateNotifyDisplay() {
 			} else {
 				_userpicView = _history->peer->createUserpicView();
 				_history->peer->loadUserpic();
-				_history->peer->paintUserpicLeft(p, _userpicView, st::notifyPhotoPos.x(), st::notifyPhotoPos.y(), width(), st::notifyPhotoSize);
+				p.drawPixmapLeft(
+					st::notifyPhotoPos,
+					width(),
+					manager()->userpic(_history->peer, _userpicView));
 			}
 		} else {
 			p.drawPixmap(st::notifyPhotoPos.x(), st::notifyPhotoPos.y(), manager()->hiddenUserpicPlaceholder());
@@ -879,19 +958,39 @@ void Notification::updatePeerPhoto() {
 	auto img = _cache.toImage();
 	{
 		Painter p(&img);
-		_peer->paintUserpicLeft(
-			p,
-			_userpicView,
-			st::notifyPhotoPos.x(),
-			st::notifyPhotoPos.y(),
+		p.drawPixmapLeft(
+			st::notifyPhotoPos,
 			width(),
-			st::notifyPhotoSize);
+			manager()->userpic(_peer, _userpicView));
 	}
 	_cache = Ui::PixmapFromImage(std::move(img));
 	_userpicView = nullptr;
 	update();
 }
 
+bool Notification::mergeWith(
+		not_null<HistoryItem*> item,
+		const QString &author,
+		bool fromScheduled) {
+	if (!_history
+		|| !_item
+		|| (_history != item->history())
+		|| (_fromScheduled != fromScheduled)
+		|| isReplying()
+		|| isHiding()
+		|| (crl::now() - _started >= kMergeNotificationsDelay)) {
+		return false;
+	}
+	_item = item;
+	_author = author;
+	_started = crl::now();
+	if (_hideTimer.isActive()) {
+		_hideTimer.start(st::notifyWaitLongHide);
+	}
+	updateNotifyDisplay();
+	return true;
+}
+
 bool Notification::unlinkItem(HistoryItem *deleted) {
 	auto unlink = (_item && _item == deleted);
 	if (unlink) {
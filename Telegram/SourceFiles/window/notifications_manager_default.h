@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "window/notifications_manager.h"
 #include "ui/effects/animations.h"
 #include "ui/rp_widget.h"
+#include "ui/image/image_location.h"
 #include "base/timer.h"
 #include "base/binary_guard.h"
 #include "base/object_ptr.h"
@@ -66,6 +67,9 @@ private:
 	};
 
 	[[nodiscard]] QPixmap hiddenUserpicPlaceholder() const;
+	[[nodiscard]] QPixmap userpic(
+		not_null<PeerData*> peer,
+		std::shared_ptr<Data::CloudImageView> &view);
 
 	void doUpdateAll() override;
 	void doShowNotification(
@@ -118,9 +122,23 @@ private:
 		HistoryItem *item = nullptr;
 		int forwardedCount = 0;
 		bool fromScheduled = false;
+		crl::time when = 0;
 	};
 	std::deque<QueuedNotification> _queuedNotifications;
 
+	// Limits how many new widgets appear during message storms,
+	// the rest wait in the queue and get merged per chat there.
+	base::Timer _showNextTimer;
+	crl::time _shownIntervalStart = 0;
+	int _shownInInterval = 0;
+
+	struct CachedUserpic {
+		InMemoryKey key;
+		int cornersType = 0;
+		QPixmap pixmap;
+	};
+	base::flat_map<not_null<PeerData*>, CachedUserpic> _userpics;
+
 	Ui::Animations::Simple _demoMasterOpacity;
 	bool _demoIsShown = false;
 
@@ -147,6 +165,9 @@ public:
 	bool isShowing() const {
 		return _a_opacity.animating() && !_hiding;
 	}
+	bool isHiding() const {
+		return _hiding;
+	}
 
 	void updateOpacity();
 	void changeShift(int top);
@@ -220,6 +241,12 @@ public:
 	void updateNotifyDisplay();
 	void updatePeerPhoto();
 
+	// Shows a newer message from the same chat in this widget.
+	bool mergeWith(
+		not_null<HistoryItem*> item,
+		const QString &author,
+		bool fromScheduled);
+
 	bool isUnlinked() const {
 		return !_history;
 	}
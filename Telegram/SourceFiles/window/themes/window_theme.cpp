@@ -369,24 +369,56 @@ bool LoadTheme(
 	return true;
 }
 
-bool InitializeFromCache(
+[[nodiscard]] bool CacheIsValid(
 		const QByteArray &content,
 		const Cached &cache) {
-	if (cache.paletteChecksum != style::palette::Checksum()) {
+	return (cache.paletteChecksum == style::palette::Checksum())
+		&& (cache.contentChecksum
+			== base::crc32(content.constData(), content.size()));
+}
+
+[[nodiscard]] bool ReadCachedBackground(
+		const Cached &cache,
+		QImage &background) {
+	if (cache.background.isEmpty()) {
+		return true;
+	}
+	QDataStream stream(cache.background);
+	QImageReader reader(stream.device());
+	reader.setAutoTransform(true);
+	return reader.read(&background) && !background.isNull();
+}
+
+// The cache holds the resolved (colorized) palette and the background
+// as a BMP, so applying it skips unpacking, parsing and JPEG decoding.
+bool LoadFromCache(
+		const QByteArray &content,
+		const Cached &cache,
+		not_null<Instance*> out) {
+	if (!CacheIsValid(content, cache)) {
 		return false;
 	}
-	if (cache.contentChecksum != base::crc32(content.constData(), content.size())) {
+	auto background = QImage();
+	if (!ReadCachedBackground(cache, background)
+		|| !out->palette.load(cache.colors)) {
+		return false;
+	}
+	out->background = std::move(background);
+	out->tiled = cache.tiled;
+	out->cached = cache;
+	return true;
+}
+
+bool InitializeFromCache(
+		const QByteArray &content,
+		const Cached &cache) {
+	if (!CacheIsValid(content, cache)) {
 		return false;
 	}
 
 	QImage background;
-	if (!cache.background.isEmpty()) {
-		QDataStream stream(cache.background);
-		QImageReader reader(stream.device());
-		reader.setAutoTransform(true);
-		if (!reader.read(&background) || background.isNull()) {
-			return false;
-		}
+	if (!ReadCachedBackground(cache, background)) {
+		return false;
 	}
 
 	if (!style::main_palette::load(cache.colors)) {
@@ -1166,13 +1198,16 @@ void ChatBackground::reapplyWithNightMode(
 		}
 		auto preview = std::make_unique<Preview>();
 		preview->object = std::move(read.object);
-		preview->instance.cached = std::move(read.cache);
-		const auto loaded = LoadTheme(
+		const auto loaded = LoadFromCache(
 			preview->object.content,
-			ColorizerForTheme(path),
-			std::nullopt,
-			&preview->instance.cached,
-			&preview->instance);
+			read.cache,
+			&preview->instance)
+			|| LoadTheme(
+				preview->object.content,
+				ColorizerForTheme(path),
+				std::nullopt,
+				&preview->instance.cached,
+				&preview->instance);
 		if (!loaded) {
 			return false;
 		}
@@ -97,6 +97,13 @@ void Controller::showAccount(not_null<Main::Account*> account) {
 		if (session) {
 			setupMain();
 
+			// Only the first account shown after the start restores
+			// its chat, switching accounts later keeps the usual flow.
+			if (!_restoreChatChecked) {
+				_restoreChatChecked = true;
+				_sessionController->restoreChatAfterRestart();
+			}
+
 			session->updates().isIdleValue(
 			) | rpl::filter([=](bool idle) {
 				return !idle;
@@ -115,6 +115,7 @@ private:
 	std::unique_ptr<SessionController> _sessionController;
 	base::Timer _isActiveTimer;
 	QPointer<Ui::BoxContent> _termsBox;
+	bool _restoreChatChecked = false;
 
 	rpl::event_stream<Media::View::OpenRequest> _openInMediaViewRequests;
 
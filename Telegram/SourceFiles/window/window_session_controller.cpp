@@ -26,6 +26,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_document_resolver.h"
 #include "data/data_media_types.h"
 #include "data/data_session.h"
+#include "data/stickers/data_stickers.h"
 #include "data/data_folder.h"
 #include "data/data_channel.h"
 #include "data/data_chat.h"
@@ -44,6 +45,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/core_settings.h"
 #include "core/click_handler_types.h"
 #include "base/unixtime.h"
+#include "base/call_delayed.h"
 #include "ui/layers/generic_box.h"
 #include "ui/text/text_utilities.h"
 #include "ui/delayed_activation.h"
@@ -80,6 +82,7 @@ namespace {
 
 constexpr auto kCustomThemesInMemory = 5;
 constexpr auto kMaxChatEntryHistorySize = 50;
+constexpr auto kPreloadLocalStickersDelay = crl::time(1000);
 constexpr auto kDayBaseFile = ":/gui/day-custom-base.tdesktop-theme"_cs;
 constexpr auto kNightBaseFile = ":/gui/night-custom-base.tdesktop-theme"_cs;
 
@@ -613,6 +616,10 @@ SessionController::SessionController(
 		}));
 	}, _lifetime);
 
+	base::call_delayed(kPreloadLocalStickersDelay, this, [=] {
+		session->data().stickers().ensureLocalLoaded();
+	});
+
 	session->addWindow(this);
 }
 
@@ -1386,6 +1393,34 @@ void SessionController::showPeerHistoryAtItem(
 		});
 }
 
+void SessionController::restoreChatAfterRestart() {
+	auto &settings = session().settings();
+	const auto peerId = settings.restoreChatPeer();
+	const auto msgId = settings.restoreChatMsgId();
+	if (!peerId) {
+		return;
+	}
+	settings.setRestoreChat(PeerId(), MsgId());
+	session().saveSettingsDelayed();
+
+	const auto show = [=](not_null<PeerData*> peer) {
+		if (!activeChatCurrent()) {
+			showPeerHistory(peer, SectionShow::Way::ClearStack, msgId);
+		}
+	};
+	if (const auto peer = session().data().peerLoaded(peerId)) {
+		show(peer);
+		return;
+	}
+	// Peers are not cached locally, wait for the chats list to load.
+	session().data().chatsListLoadedEvents(
+	) | rpl::filter([=](Data::Folder *folder) {
+		return session().data().peerLoaded(peerId) != nullptr;
+	}) | rpl::take(1) | rpl::start_with_next([=] {
+		show(session().data().peer(peerId));
+	}, lifetime());
+}
+
 void SessionController::cancelUploadLayer(not_null<HistoryItem*> item) {
 	const auto itemId = item->fullId();
 	session().uploader().pause(itemId);
@@ -348,6 +348,7 @@ public:
 		MsgId msgId = ShowAtUnreadMsgId) override;
 
 	void showPeerHistoryAtItem(not_null<const HistoryItem*> item);
+	void restoreChatAfterRestart();
 	void cancelUploadLayer(not_null<HistoryItem*> item);
 
 	void showLayer(
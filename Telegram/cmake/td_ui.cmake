@@ -74,6 +74,8 @@ PRIVATE
 
     media/clip/media_clip_check_streaming.cpp
     media/clip/media_clip_check_streaming.h
+    media/clip/media_clip_compress.cpp
+    media/clip/media_clip_compress.h
     media/clip/media_clip_ffmpeg.cpp
     media/clip/media_clip_ffmpeg.h
     media/clip/media_clip_implementation.cpp
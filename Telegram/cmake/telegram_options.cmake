@@ -6,6 +6,8 @@
 
 option(TDESKTOP_API_TEST "Use test API credentials." OFF)
 option(KTGDESKTOP_ENABLE_PACKER "Enable building update packer on non-special targets." OFF)
+option(KTGDESKTOP_ENABLE_BENCH "Enable building td_bench serialization benchmark." OFF)
+option(KTGDESKTOP_ENABLE_RPL_PROFILING "Count rpl events per named subscription site." OFF)
 set(TDESKTOP_API_ID "0" CACHE STRING "Provide 'api_id' for the Telegram API access.")
 set(TDESKTOP_API_HASH "" CACHE STRING "Provide 'api_hash' for the Telegram API access.")
 set(TDESKTOP_LAUNCHER_BASENAME "" CACHE STRING "Desktop file base name (Linux only).")
@@ -25,6 +27,10 @@ if (DESKTOP_APP_DISABLE_AUTOUPDATE)
     target_compile_definitions(Telegram PRIVATE TDESKTOP_DISABLE_AUTOUPDATE)
 endif()
 
+if (KTGDESKTOP_ENABLE_RPL_PROFILING)
+    target_compile_definitions(Telegram PRIVATE TDESKTOP_RPL_PROFILING)
+endif()
+
 # if (DESKTOP_APP_SPECIAL_TARGET)
 #     target_compile_definitions(Telegram PRIVATE TDESKTOP_ALLOW_CLOSED_ALPHA)
 # endif()